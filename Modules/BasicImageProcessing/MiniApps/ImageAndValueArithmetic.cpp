@@ -19,7 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommandLineParser.h"
 #include "mitkIOUtil.h"
 
-#include <mitkArithmeticOperation.h>
+#include <mitkImageExpression.h>
 
 static bool ConvertToBool(std::map<std::string, us::Any> &data, std::string name)
 {
@@ -53,7 +53,7 @@ int main(int argc, char* argv[])
   parser.addArgument("value", "v", mitkCommandLineParser::Float, "Input Value:", "Input Value", us::Any(), false);
   parser.addArgument("output", "o", mitkCommandLineParser::OutputFile, "Output file:", "Output file", us::Any(), false);
 
-  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type", false, true);
+  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type. Otherwise the result of every operation is converted to the pixel type of the input image", false, true);
   parser.addArgument("image-right", "right", mitkCommandLineParser::Bool, "Image right (for example Value - Image)", "Image right (for example Value - Image)", false, true);
 
   parser.addArgument("add", "add", mitkCommandLineParser::Bool, "Add Left Image and Right Image", "Add Left Image and Right Image", us::Any(false), true);
@@ -94,54 +94,61 @@ int main(int argc, char* argv[])
   bool resultAsDouble = ConvertToBool(parsedArgs, "as-double");
   MITK_INFO << "Output image as double: " << resultAsDouble;
 
-  mitk::Image::Pointer tmpImage = image->Clone();
+  // without --as-double, every operation converts its result to the input pixel type
+  auto convertResult = [&](const mitk::ImageExpression &result) {
+    return resultAsDouble ? result : result.CastTo(image->GetPixelType());
+  };
+
+  // the operations are only collected here and computed in one pass by Evaluate()
+  mitk::ImageExpression expression(image);
   if (ConvertToBool(parsedArgs, "image-right"))
   {
     if (ConvertToBool(parsedArgs, "add"))
     {
       MITK_INFO << " Start Doing Operation: ADD()";
-      tmpImage = mitk::ArithmeticOperation::Add(value, tmpImage, resultAsDouble);
+      expression = convertResult(value + expression);
     }
     if (ConvertToBool(parsedArgs, "subtract"))
     {
       MITK_INFO << " Start Doing Operation: SUB()";
-      tmpImage = mitk::ArithmeticOperation::Subtract(value, tmpImage, resultAsDouble);
+      expression = convertResult(value - expression);
     }
     if (ConvertToBool(parsedArgs, "multiply"))
     {
       MITK_INFO << " Start Doing Operation: MULT()";
-      tmpImage = mitk::ArithmeticOperation::Multiply(value, tmpImage, resultAsDouble);
+      expression = convertResult(value * expression);
     }
     if (ConvertToBool(parsedArgs, "divide"))
     {
       MITK_INFO << " Start Doing Operation: DIV()";
-      tmpImage = mitk::ArithmeticOperation::Divide(value, tmpImage, resultAsDouble);
+      expression = convertResult(value / expression);
     }
   }
   else {
     if (ConvertToBool(parsedArgs, "add"))
     {
       MITK_INFO << " Start Doing Operation: ADD()";
-      tmpImage = mitk::ArithmeticOperation::Add(tmpImage, value, resultAsDouble);
+      expression = convertResult(expression + value);
     }
     if (ConvertToBool(parsedArgs, "subtract"))
     {
       MITK_INFO << " Start Doing Operation: SUB()";
-      tmpImage = mitk::ArithmeticOperation::Subtract(tmpImage, value, resultAsDouble);
+      expression = convertResult(expression - value);
     }
     if (ConvertToBool(parsedArgs, "multiply"))
     {
       MITK_INFO << " Start Doing Operation: MULT()";
-      tmpImage = mitk::ArithmeticOperation::Multiply(tmpImage, value, resultAsDouble);
+      expression = convertResult(expression * value);
     }
     if (ConvertToBool(parsedArgs, "divide"))
     {
       MITK_INFO << " Start Doing Operation: DIV()";
-      tmpImage = mitk::ArithmeticOperation::Divide(tmpImage, value, resultAsDouble);
+      expression = convertResult(expression / value);
     }
 
   }
 
+  mitk::Image::Pointer tmpImage = expression.Evaluate(resultAsDouble);
   mitk::IOUtil::Save(tmpImage, outputFilename);
 
   return EXIT_SUCCESS;
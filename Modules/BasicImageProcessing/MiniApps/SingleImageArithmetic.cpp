@@ -19,7 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommandLineParser.h"
 #include "mitkIOUtil.h"
 
-#include <mitkArithmeticOperation.h>
+#include <mitkImageExpression.h>
 
 static bool ConvertToBool(std::map<std::string, us::Any> &data, std::string name)
 {
@@ -52,7 +52,7 @@ int main(int argc, char* argv[])
   parser.addArgument("input", "i", mitkCommandLineParser::InputFile, "Input file:", "Input File",us::Any(),false);
   parser.addArgument("output", "o", mitkCommandLineParser::OutputFile, "Output file:", "Output file", us::Any(), false);
 
-  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type", false, true);
+  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type. Otherwise the result of every operation is converted to the pixel type of the input image", false, true);
 
   parser.addArgument("tan", "tan", mitkCommandLineParser::Bool, "Calculate tan operation", "Calculate tan operation", us::Any(false), true);
   parser.addArgument("atan", "atan", mitkCommandLineParser::Bool, "Calculate atan operation", "Calculate atan operation", us::Any(false), true);
@@ -99,69 +99,76 @@ int main(int argc, char* argv[])
   bool resultAsDouble = ConvertToBool(parsedArgs, "as-double");
   MITK_INFO << "Output image as double: " << resultAsDouble;
 
-  mitk::Image::Pointer tmpImage = image->Clone();
+  // without --as-double, every operation converts its result to the input pixel type
+  auto convertResult = [&](const mitk::ImageExpression &result) {
+    return resultAsDouble ? result : result.CastTo(image->GetPixelType());
+  };
+
+  // the operations are only collected here and computed in one pass by Evaluate()
+  mitk::ImageExpression expression(image);
 
   if (ConvertToBool(parsedArgs, "tan"))
   {
     MITK_INFO << " Start Doing Operation: TAN()";
-    tmpImage = mitk::ArithmeticOperation::Tan(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Tan());
   }
   if (ConvertToBool(parsedArgs, "atan"))
   {
     MITK_INFO << " Start Doing Operation: ATAN()";
-    tmpImage = mitk::ArithmeticOperation::Atan(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Atan());
   }
   if (ConvertToBool(parsedArgs, "cos"))
   {
     MITK_INFO << " Start Doing Operation: COS()";
-    tmpImage = mitk::ArithmeticOperation::Cos(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Cos());
   }
   if (ConvertToBool(parsedArgs, "acos"))
   {
     MITK_INFO << " Start Doing Operation: ACOS()";
-    tmpImage = mitk::ArithmeticOperation::Acos(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Acos());
   }
   if (ConvertToBool(parsedArgs, "sin"))
   {
     MITK_INFO << " Start Doing Operation: SIN()";
-    tmpImage = mitk::ArithmeticOperation::Sin(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Sin());
   }
   if (ConvertToBool(parsedArgs, "asin"))
   {
     MITK_INFO << " Start Doing Operation: ASIN()";
-    tmpImage = mitk::ArithmeticOperation::Asin(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Asin());
   }
   if (ConvertToBool(parsedArgs, "square"))
   {
     MITK_INFO << " Start Doing Operation: SQUARE()";
-    tmpImage = mitk::ArithmeticOperation::Square(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Square());
   }
   if (ConvertToBool(parsedArgs, "sqrt"))
   {
     MITK_INFO << " Start Doing Operation: SQRT()";
-    tmpImage = mitk::ArithmeticOperation::Sqrt(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Sqrt());
   }
   if (ConvertToBool(parsedArgs, "abs"))
   {
     MITK_INFO << " Start Doing Operation: ABS()";
-    tmpImage = mitk::ArithmeticOperation::Abs(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Abs());
   }
   if (ConvertToBool(parsedArgs, "exp"))
   {
     MITK_INFO << " Start Doing Operation: EXP()";
-    tmpImage = mitk::ArithmeticOperation::Exp(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Exp());
   }
   if (ConvertToBool(parsedArgs, "expneg"))
   {
     MITK_INFO << " Start Doing Operation: EXPNEG()";
-    tmpImage = mitk::ArithmeticOperation::ExpNeg(tmpImage, resultAsDouble);
+    expression = convertResult(expression.ExpNeg());
   }
   if (ConvertToBool(parsedArgs, "log10"))
   {
     MITK_INFO << " Start Doing Operation: LOG10()";
-    tmpImage = mitk::ArithmeticOperation::Log10(tmpImage, resultAsDouble);
+    expression = convertResult(expression.Log10());
   }
 
+  mitk::Image::Pointer tmpImage = expression.Evaluate(resultAsDouble);
   mitk::IOUtil::Save(tmpImage, outputFilename);
 
   return EXIT_SUCCESS;
@@ -19,7 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommandLineParser.h"
 #include "mitkIOUtil.h"
 
-#include <mitkArithmeticOperation.h>
+#include <mitkImageExpression.h>
 
 static bool ConvertToBool(std::map<std::string, us::Any> &data, std::string name)
 {
@@ -53,7 +53,7 @@ int main(int argc, char* argv[])
   parser.addArgument("input-right", "i2", mitkCommandLineParser::InputFile, "Input file:", "Input File", us::Any(), false);
   parser.addArgument("output", "o", mitkCommandLineParser::OutputFile, "Output file:", "Output file", us::Any(), false);
 
-  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type", false, true);
+  parser.addArgument("as-double", "double", mitkCommandLineParser::Bool, "Result as double", "Result as double image type. Otherwise the result of every operation is converted to the pixel type of the input image", false, true);
 
   parser.addArgument("add", "add", mitkCommandLineParser::Bool, "Add Left Image and Right Image", "Add Left Image and Right Image", us::Any(false), true);
   parser.addArgument("subtract", "sub", mitkCommandLineParser::Bool, "Subtract right image from left image", "Subtract right image from left image", us::Any(false), true);
@@ -105,29 +105,37 @@ int main(int argc, char* argv[])
   bool resultAsDouble = ConvertToBool(parsedArgs, "as-double");
   MITK_INFO << "Output image as double: " << resultAsDouble;
 
-  mitk::Image::Pointer tmpImage = image1->Clone();
+  // without --as-double, every operation converts its result to the input pixel type
+  auto convertResult = [&](const mitk::ImageExpression &result) {
+    return resultAsDouble ? result : result.CastTo(image1->GetPixelType());
+  };
+
+  // the operations are only collected here and computed in one pass by Evaluate()
+  mitk::ImageExpression expression(image1);
+  const mitk::ImageExpression right(image2);
 
   if (ConvertToBool(parsedArgs, "add"))
   {
     MITK_INFO << " Start Doing Operation: ADD()";
-    tmpImage = mitk::ArithmeticOperation::Add(tmpImage, image2, resultAsDouble);
+    expression = convertResult(expression + right);
   }
   if (ConvertToBool(parsedArgs, "subtract"))
   {
     MITK_INFO << " Start Doing Operation: SUB()";
-    tmpImage = mitk::ArithmeticOperation::Subtract(tmpImage, image2, resultAsDouble);
+    expression = convertResult(expression - right);
   }
   if (ConvertToBool(parsedArgs, "multiply"))
   {
     MITK_INFO << " Start Doing Operation: MULT()";
-    tmpImage = mitk::ArithmeticOperation::Multiply(tmpImage, image2, resultAsDouble);
+    expression = convertResult(expression * right);
   }
   if (ConvertToBool(parsedArgs, "divide"))
   {
     MITK_INFO << " Start Doing Operation: DIV()";
-    tmpImage = mitk::ArithmeticOperation::Divide(tmpImage, image2, resultAsDouble);
+    expression = convertResult(expression / right);
   }
 
+  mitk::Image::Pointer tmpImage = expression.Evaluate(resultAsDouble);
   mitk::IOUtil::Save(tmpImage, outputFilename);
 
   return EXIT_SUCCESS;
@@ -4,6 +4,7 @@ set(CPP_FILES
    mitkArithmeticOperation.cpp
    mitkTransformationOperation.cpp
    mitkMaskCleaningOperation.cpp
+   mitkImageExpression.cpp
 )
 
 set(RESOURCE_FILES
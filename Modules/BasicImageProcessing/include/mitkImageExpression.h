@@ -0,0 +1,169 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkImageExpression_h
+#define mitkImageExpression_h
+
+#include <mitkImage.h>
+#include <MitkBasicImageProcessingExports.h>
+
+#include <memory>
+#include <vector>
+
+namespace mitk
+{
+  /** \brief Voxel wise arithmetic on images which is evaluated lazily in one pass
+  *
+  * Combining expressions does not compute anything, it only builds a graph of operations whose leaves are images
+  * and constants. Evaluate() computes the whole graph in a single multi-threaded pass over the voxels and allocates
+  * only the output image, while a chain of mitk::ArithmeticOperation calls creates one temporary image per operation.
+  *
+  * \code
+  * mitk::ImageExpression normalized = ((mitk::ImageExpression(image) - background) / scale).Log().Clamp(0, 10);
+  * mitk::Image::Pointer result = normalized.Mask(mask).Evaluate();
+  * \endcode
+  *
+  * The voxels are processed in blocks, every operation runs over a contiguous block of values at a time, which
+  * allows the compiler to vectorize the arithmetic. Subexpressions used several times are computed only once per
+  * voxel and every image is read only once per voxel.
+  *
+  * All values are computed in double precision. All images of an expression must have one component per pixel
+  * and the same size (including the number of time steps), the output has the geometry of the first image.
+  */
+  class MITKBASICIMAGEPROCESSING_EXPORT ImageExpression
+  {
+  public:
+    explicit ImageExpression(const Image *image);
+    explicit ImageExpression(double value);
+
+    ImageExpression Pow(double exponent) const;
+    ImageExpression Abs() const;
+    ImageExpression Square() const;
+    ImageExpression Sqrt() const;
+    ImageExpression Exp() const;
+    ImageExpression ExpNeg() const;
+    ImageExpression Log() const;
+    ImageExpression Log10() const;
+    ImageExpression Sin() const;
+    ImageExpression Cos() const;
+    ImageExpression Tan() const;
+    ImageExpression Asin() const;
+    ImageExpression Acos() const;
+    ImageExpression Atan() const;
+
+    /** \brief Values below lower are set to lower, values above upper to upper */
+    ImageExpression Clamp(double lower, double upper) const;
+
+    /** \brief Converts the values to the component type of pixelType and back, like storing them in such an image
+    *
+    * Conversions to integer types truncate towards zero. This allows to reproduce the rounding of a chain of
+    * operations which each create an image of the input pixel type.
+    */
+    ImageExpression CastTo(const PixelType &pixelType) const;
+
+    /** \brief Keeps the values where mask is not zero and sets all other values to outsideValue */
+    ImageExpression Mask(const ImageExpression &mask, double outsideValue = 0.0) const;
+
+    static ImageExpression Min(const ImageExpression &a, const ImageExpression &b);
+    static ImageExpression Max(const ImageExpression &a, const ImageExpression &b);
+    static ImageExpression Pow(const ImageExpression &base, const ImageExpression &exponent);
+
+    /** \brief condition != 0 ? a : b */
+    static ImageExpression Select(const ImageExpression &condition,
+                                  const ImageExpression &a,
+                                  const ImageExpression &b);
+
+    /** \brief Number of distinct operations, images and constants in the expression */
+    unsigned int GetNumberOfNodes() const;
+
+    /**
+    * \brief Computes the expression for all voxels.
+    *
+    * If outputAsDouble is false, the result has the pixel type of the first image of the expression. Only the
+    * final values are converted, intermediate results are only rounded by CastTo().
+    */
+    Image::Pointer Evaluate(bool outputAsDouble = true) const;
+
+    friend MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator+(const ImageExpression &a, const ImageExpression &b);
+    friend MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(const ImageExpression &a, const ImageExpression &b);
+    friend MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator*(const ImageExpression &a, const ImageExpression &b);
+    friend MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator/(const ImageExpression &a, const ImageExpression &b);
+    friend MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(const ImageExpression &a);
+
+  private:
+    enum OperationsEnum
+    {
+      InputOperation,
+      ConstantOperation,
+      AddOperation,
+      SubtractOperation,
+      MultiplyOperation,
+      DivideOperation,
+      PowerOperation,
+      MinimumOperation,
+      MaximumOperation,
+      NegateOperation,
+      AbsOperation,
+      SquareOperation,
+      SqrtOperation,
+      ExpOperation,
+      ExpNegOperation,
+      LogOperation,
+      Log10Operation,
+      SinOperation,
+      CosOperation,
+      TanOperation,
+      AsinOperation,
+      AcosOperation,
+      AtanOperation,
+      SelectOperation,
+      CastOperation
+    };
+
+    struct Node
+    {
+      OperationsEnum Operation;
+      Image::ConstPointer InputImage;
+      double Value;
+      int ComponentType;
+      std::vector<std::shared_ptr<const Node>> Arguments;
+    };
+
+    class Program;
+
+    explicit ImageExpression(const std::shared_ptr<const Node> &node);
+
+    static ImageExpression Create(OperationsEnum operation, const std::vector<ImageExpression> &arguments);
+
+    std::shared_ptr<const Node> m_Node;
+  };
+
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator+(const ImageExpression &a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(const ImageExpression &a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator*(const ImageExpression &a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator/(const ImageExpression &a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(const ImageExpression &a);
+
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator+(const ImageExpression &a, double b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(const ImageExpression &a, double b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator*(const ImageExpression &a, double b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator/(const ImageExpression &a, double b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator+(double a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator-(double a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator*(double a, const ImageExpression &b);
+  MITKBASICIMAGEPROCESSING_EXPORT ImageExpression operator/(double a, const ImageExpression &b);
+}
+#endif // mitkImageExpression_h
@@ -226,122 +226,126 @@ static void ExecuteOneImageFilter(itk::Image<TPixel, VImageDimension>* imageA, d
   case mitk::NonStaticArithmeticOperation::OperationsEnum::AddValue:
     ExecuteOneImageFilterWithFunctor<mitk::Functor::AddValue<TPixel, TPixel>,
                                      mitk::Functor::AddValue<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::SubValue:
     ExecuteOneImageFilterWithFunctor<mitk::Functor::SubValue<TPixel, TPixel>,
                                      mitk::Functor::SubValue<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::MultValue:
       ExecuteOneImageFilterWithFunctor<mitk::Functor::MultValue<TPixel, TPixel>,
                                        mitk::Functor::MultValue<TPixel, double>,
-                                       ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                       ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::DivValue:
     ExecuteOneImageFilterWithFunctor<mitk::Functor::DivValue<TPixel, TPixel>,
                                      mitk::Functor::DivValue<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::PowValue:
     ExecuteOneImageFilterWithFunctor<mitk::Functor::PowValue<TPixel, TPixel>,
                                      mitk::Functor::PowValue<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
 
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Tan:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Tan<TPixel, TPixel>,
                                      itk::Functor::Tan<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::ATan:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Atan<TPixel, TPixel>,
                                      itk::Functor::Atan<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Cos:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Cos<TPixel, TPixel>,
                                      itk::Functor::Cos<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::ACos:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Acos<TPixel, TPixel>,
                                      itk::Functor::Acos<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Sin:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Sin<TPixel, TPixel>,
                                      itk::Functor::Sin<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::ASin:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Asin<TPixel, TPixel>,
                                      itk::Functor::Asin<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Square:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Square<TPixel, TPixel>,
                                      itk::Functor::Square<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Sqrt:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Sqrt<TPixel, TPixel>,
                                      itk::Functor::Sqrt<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Abs:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Abs<TPixel, TPixel>,
                                      itk::Functor::Abs<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Exp:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Exp<TPixel, TPixel>,
                                      itk::Functor::Exp<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::ExpNeg:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::ExpNegative<TPixel, TPixel>,
                                      itk::Functor::ExpNegative<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   case mitk::NonStaticArithmeticOperation::OperationsEnum::Log10:
     ExecuteOneImageFilterWithFunctorNonParameter<itk::Functor::Log10<TPixel, TPixel>,
                                      itk::Functor::Log10<TPixel, double>,
-                                     ImageType, DoubleOutputType>(imageA, value, valueLeft, returnDoubleImage, parameterFree, outputImage);
+                                     ImageType, DoubleOutputType>(imageA, value, returnDoubleImage, valueLeft, parameterFree, outputImage);
     break;
   default:
     break;
   }
 }
 
-mitk::Image::Pointer mitk::ArithmeticOperation::Add(Image::Pointer & imageA, Image::Pointer & imageB, bool)
+mitk::Image::Pointer mitk::ArithmeticOperation::Add(Image::Pointer & imageA, Image::Pointer & imageB, bool outputAsDouble)
 {
   NonStaticArithmeticOperation helper;
   helper.m_Algorithm = NonStaticArithmeticOperation::OperationsEnum::Add2;
+  helper.m_GenerateDoubleOutput = outputAsDouble;
   helper.CallExecuteTwoImageFilter(imageA, imageB);
   return helper.m_ResultImage;
 }
 
-mitk::Image::Pointer mitk::ArithmeticOperation::Subtract(Image::Pointer & imageA, Image::Pointer & imageB, bool)
+mitk::Image::Pointer mitk::ArithmeticOperation::Subtract(Image::Pointer & imageA, Image::Pointer & imageB, bool outputAsDouble)
 {
   NonStaticArithmeticOperation helper;
   helper.m_Algorithm = NonStaticArithmeticOperation::OperationsEnum::Sub2;
+  helper.m_GenerateDoubleOutput = outputAsDouble;
   helper.CallExecuteTwoImageFilter(imageA, imageB);
   return helper.m_ResultImage;
 }
 
-mitk::Image::Pointer mitk::ArithmeticOperation::Multiply(Image::Pointer & imageA, Image::Pointer & imageB, bool)
+mitk::Image::Pointer mitk::ArithmeticOperation::Multiply(Image::Pointer & imageA, Image::Pointer & imageB, bool outputAsDouble)
 {
   NonStaticArithmeticOperation helper;
   helper.m_Algorithm = NonStaticArithmeticOperation::OperationsEnum::Mult;
+  helper.m_GenerateDoubleOutput = outputAsDouble;
   helper.CallExecuteTwoImageFilter(imageA, imageB);
   return helper.m_ResultImage;
 }
 
-mitk::Image::Pointer mitk::ArithmeticOperation::Divide(Image::Pointer & imageA, Image::Pointer & imageB, bool)
+mitk::Image::Pointer mitk::ArithmeticOperation::Divide(Image::Pointer & imageA, Image::Pointer & imageB, bool outputAsDouble)
 {
   NonStaticArithmeticOperation helper;
   helper.m_Algorithm = NonStaticArithmeticOperation::OperationsEnum::Div;
+  helper.m_GenerateDoubleOutput = outputAsDouble;
   helper.CallExecuteTwoImageFilter(imageA, imageB);
   return helper.m_ResultImage;
 }
@@ -516,19 +520,19 @@ void mitk::NonStaticArithmeticOperation::ExecuteTwoImageFilter(itk::Image<TPixel
 
   case OperationsEnum::Sub2:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Sub2<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Sub2<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
 
   case OperationsEnum::Mult:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Mult<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Mult<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
 
   case OperationsEnum::Div:
     ExecuteTwoImageFilterWithFunctor<itk::Functor::Div<TPixel1, TPixel2, TPixel1>,
-      itk::Functor::Add2<TPixel1, TPixel2, double>,
+      itk::Functor::Div<TPixel1, TPixel2, double>,
       Image1Type, Image2Type, DoubleOutputType>(imageA, imageB);
     break;
   default:
@@ -0,0 +1,658 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkImageExpression.h"
+
+#include <mitkExceptionMacro.h>
+#include <mitkImageReadAccessor.h>
+#include <mitkImageWriteAccessor.h>
+
+#include <itkImageIOBase.h>
+#include <itkMultiThreader.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace
+{
+  // number of voxels every operation processes at a time, small enough to keep the values of all nodes in the cache
+  const std::size_t BlockSize = 1024;
+
+  template <typename TPixel>
+  void LoadBlock(const void *data, std::size_t offset, std::size_t count, double *values)
+  {
+    const TPixel *pixels = static_cast<const TPixel *>(data) + offset;
+    for (std::size_t i = 0; i < count; ++i)
+      values[i] = static_cast<double>(pixels[i]);
+  }
+
+  template <typename TPixel>
+  void StoreBlock(const double *values, std::size_t offset, std::size_t count, void *data)
+  {
+    TPixel *pixels = static_cast<TPixel *>(data) + offset;
+    for (std::size_t i = 0; i < count; ++i)
+      pixels[i] = static_cast<TPixel>(values[i]);
+  }
+
+  template <typename TPixel>
+  void CastBlock(const double *values, std::size_t count, double *result)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      result[i] = static_cast<double>(static_cast<TPixel>(values[i]));
+  }
+
+  typedef void (*LoadFunctionType)(const void *, std::size_t, std::size_t, double *);
+  typedef void (*StoreFunctionType)(const double *, std::size_t, std::size_t, void *);
+  typedef void (*CastFunctionType)(const double *, std::size_t, double *);
+
+  LoadFunctionType GetLoadFunction(int componentType)
+  {
+    switch (componentType)
+    {
+      case itk::ImageIOBase::UCHAR: return &LoadBlock<unsigned char>;
+      case itk::ImageIOBase::CHAR: return &LoadBlock<char>;
+      case itk::ImageIOBase::USHORT: return &LoadBlock<unsigned short>;
+      case itk::ImageIOBase::SHORT: return &LoadBlock<short>;
+      case itk::ImageIOBase::UINT: return &LoadBlock<unsigned int>;
+      case itk::ImageIOBase::INT: return &LoadBlock<int>;
+      case itk::ImageIOBase::ULONG: return &LoadBlock<unsigned long>;
+      case itk::ImageIOBase::LONG: return &LoadBlock<long>;
+      case itk::ImageIOBase::FLOAT: return &LoadBlock<float>;
+      case itk::ImageIOBase::DOUBLE: return &LoadBlock<double>;
+      default: return nullptr;
+    }
+  }
+
+  StoreFunctionType GetStoreFunction(int componentType)
+  {
+    switch (componentType)
+    {
+      case itk::ImageIOBase::UCHAR: return &StoreBlock<unsigned char>;
+      case itk::ImageIOBase::CHAR: return &StoreBlock<char>;
+      case itk::ImageIOBase::USHORT: return &StoreBlock<unsigned short>;
+      case itk::ImageIOBase::SHORT: return &StoreBlock<short>;
+      case itk::ImageIOBase::UINT: return &StoreBlock<unsigned int>;
+      case itk::ImageIOBase::INT: return &StoreBlock<int>;
+      case itk::ImageIOBase::ULONG: return &StoreBlock<unsigned long>;
+      case itk::ImageIOBase::LONG: return &StoreBlock<long>;
+      case itk::ImageIOBase::FLOAT: return &StoreBlock<float>;
+      case itk::ImageIOBase::DOUBLE: return &StoreBlock<double>;
+      default: return nullptr;
+    }
+  }
+
+  CastFunctionType GetCastFunction(int componentType)
+  {
+    switch (componentType)
+    {
+      case itk::ImageIOBase::UCHAR: return &CastBlock<unsigned char>;
+      case itk::ImageIOBase::CHAR: return &CastBlock<char>;
+      case itk::ImageIOBase::USHORT: return &CastBlock<unsigned short>;
+      case itk::ImageIOBase::SHORT: return &CastBlock<short>;
+      case itk::ImageIOBase::UINT: return &CastBlock<unsigned int>;
+      case itk::ImageIOBase::INT: return &CastBlock<int>;
+      case itk::ImageIOBase::ULONG: return &CastBlock<unsigned long>;
+      case itk::ImageIOBase::LONG: return &CastBlock<long>;
+      case itk::ImageIOBase::FLOAT: return &CastBlock<float>;
+      case itk::ImageIOBase::DOUBLE: return &CastBlock<double>;
+      default: return nullptr;
+    }
+  }
+
+  template <typename TFunctor>
+  void ApplyUnary(const double *a, std::size_t count, double *result, TFunctor functor)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      result[i] = functor(a[i]);
+  }
+
+  template <typename TFunctor>
+  void ApplyBinary(const double *a, const double *b, std::size_t count, double *result, TFunctor functor)
+  {
+    for (std::size_t i = 0; i < count; ++i)
+      result[i] = functor(a[i], b[i]);
+  }
+}
+
+/** Topologically sorted list of the nodes of an expression, every node writes the values of one block to a slot */
+class mitk::ImageExpression::Program
+{
+public:
+  struct Instruction
+  {
+    OperationsEnum Operation;
+    unsigned int Slot;
+    unsigned int Arguments[3];
+    CastFunctionType Cast;
+  };
+
+  struct InputImage
+  {
+    Image::ConstPointer Source;
+    unsigned int Slot;
+    LoadFunctionType Load;
+    const void *Data;
+  };
+
+  struct ConstantValue
+  {
+    unsigned int Slot;
+    double Value;
+  };
+
+  explicit Program(const std::shared_ptr<const Node> &root) : m_NumberOfSlots(0)
+  {
+    std::map<const Image *, unsigned int> imageSlots;
+    std::map<const Node *, unsigned int> nodeSlots;
+    m_ResultSlot = this->Add(root.get(), imageSlots, nodeSlots);
+  }
+
+  unsigned int GetNumberOfSlots() const { return m_NumberOfSlots; }
+
+  std::vector<InputImage> &GetInputs() { return m_Inputs; }
+
+  /** Computes the voxels begin ... end - 1, slots needs room for GetNumberOfSlots() blocks */
+  void Execute(std::size_t begin, std::size_t end, std::vector<double> &slots, void *output, StoreFunctionType store) const
+  {
+    for (const auto &constant : m_Constants)
+    {
+      std::fill_n(&slots[constant.Slot * BlockSize], BlockSize, constant.Value);
+    }
+
+    for (std::size_t offset = begin; offset < end; offset += BlockSize)
+    {
+      const std::size_t count = std::min(BlockSize, end - offset);
+
+      for (const auto &input : m_Inputs)
+      {
+        input.Load(input.Data, offset, count, &slots[input.Slot * BlockSize]);
+      }
+
+      for (const auto &instruction : m_Instructions)
+      {
+        double *result = &slots[instruction.Slot * BlockSize];
+        const double *a = &slots[instruction.Arguments[0] * BlockSize];
+        const double *b = &slots[instruction.Arguments[1] * BlockSize];
+        const double *c = &slots[instruction.Arguments[2] * BlockSize];
+        if (instruction.Operation == ImageExpression::CastOperation)
+          instruction.Cast(a, count, result);
+        else
+          this->ExecuteInstruction(instruction.Operation, a, b, c, count, result);
+      }
+
+      store(&slots[m_ResultSlot * BlockSize], offset, count, output);
+    }
+  }
+
+  /** Computes all voxels with the default number of ITK threads */
+  void ExecuteThreaded(std::size_t numberOfVoxels, void *output, StoreFunctionType store) const
+  {
+    ThreadData data = {this, numberOfVoxels, output, store};
+
+    const std::size_t numberOfBlocks = (numberOfVoxels + BlockSize - 1) / BlockSize;
+    itk::MultiThreader::Pointer threader = itk::MultiThreader::New();
+    threader->SetNumberOfThreads(static_cast<itk::ThreadIdType>(
+      std::max<std::size_t>(1, std::min<std::size_t>(threader->GetNumberOfThreads(), numberOfBlocks))));
+    threader->SetSingleMethod(&Program::ThreadCallback, &data);
+    threader->SingleMethodExecute();
+  }
+
+private:
+  struct ThreadData
+  {
+    const Program *Self;
+    std::size_t NumberOfVoxels;
+    void *Output;
+    StoreFunctionType Store;
+  };
+
+  static ITK_THREAD_RETURN_TYPE ThreadCallback(void *arg)
+  {
+    auto *info = static_cast<itk::MultiThreader::ThreadInfoStruct *>(arg);
+    const auto *data = static_cast<const ThreadData *>(info->UserData);
+
+    // whole blocks per thread, so no two threads write to the same cache line
+    const std::size_t numberOfBlocks = (data->NumberOfVoxels + BlockSize - 1) / BlockSize;
+    const std::size_t blocksPerThread = (numberOfBlocks + info->NumberOfThreads - 1) / info->NumberOfThreads;
+    const std::size_t begin = std::min(data->NumberOfVoxels, info->ThreadID * blocksPerThread * BlockSize);
+    const std::size_t end = std::min(data->NumberOfVoxels, begin + blocksPerThread * BlockSize);
+
+    if (begin < end)
+    {
+      std::vector<double> slots(data->Self->GetNumberOfSlots() * BlockSize);
+      data->Self->Execute(begin, end, slots, data->Output, data->Store);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  unsigned int Add(const Node *node,
+                   std::map<const Image *, unsigned int> &imageSlots,
+                   std::map<const Node *, unsigned int> &nodeSlots)
+  {
+    auto nodeSlot = nodeSlots.find(node);
+    if (nodeSlot != nodeSlots.end())
+      return nodeSlot->second;
+
+    unsigned int slot = 0;
+    if (node->Operation == ImageExpression::InputOperation)
+    {
+      auto imageSlot = imageSlots.find(node->InputImage.GetPointer());
+      if (imageSlot == imageSlots.end())
+      {
+        slot = m_NumberOfSlots++;
+        imageSlots[node->InputImage.GetPointer()] = slot;
+        InputImage input = {node->InputImage, slot, nullptr, nullptr};
+        m_Inputs.push_back(input);
+      }
+      else
+      {
+        slot = imageSlot->second;
+      }
+    }
+    else if (node->Operation == ImageExpression::ConstantOperation)
+    {
+      slot = m_NumberOfSlots++;
+      ConstantValue constant = {slot, node->Value};
+      m_Constants.push_back(constant);
+    }
+    else
+    {
+      Instruction instruction = {node->Operation, 0, {0, 0, 0}, nullptr};
+      if (node->Operation == ImageExpression::CastOperation)
+        instruction.Cast = GetCastFunction(node->ComponentType);
+      for (std::size_t i = 0; i < node->Arguments.size(); ++i)
+      {
+        instruction.Arguments[i] = this->Add(node->Arguments[i].get(), imageSlots, nodeSlots);
+      }
+      slot = m_NumberOfSlots++;
+      instruction.Slot = slot;
+      m_Instructions.push_back(instruction);
+    }
+
+    nodeSlots[node] = slot;
+    return slot;
+  }
+
+  static void ExecuteInstruction(
+    OperationsEnum operation, const double *a, const double *b, const double *c, std::size_t count, double *result)
+  {
+    switch (operation)
+    {
+      case ImageExpression::AddOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return x + y; });
+        break;
+      case ImageExpression::SubtractOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return x - y; });
+        break;
+      case ImageExpression::MultiplyOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return x * y; });
+        break;
+      case ImageExpression::DivideOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return x / y; });
+        break;
+      case ImageExpression::PowerOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return std::pow(x, y); });
+        break;
+      case ImageExpression::MinimumOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return y < x ? y : x; });
+        break;
+      case ImageExpression::MaximumOperation:
+        ApplyBinary(a, b, count, result, [](double x, double y) { return x < y ? y : x; });
+        break;
+      case ImageExpression::NegateOperation:
+        ApplyUnary(a, count, result, [](double x) { return -x; });
+        break;
+      case ImageExpression::AbsOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::abs(x); });
+        break;
+      case ImageExpression::SquareOperation:
+        ApplyUnary(a, count, result, [](double x) { return x * x; });
+        break;
+      case ImageExpression::SqrtOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::sqrt(x); });
+        break;
+      case ImageExpression::ExpOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::exp(x); });
+        break;
+      case ImageExpression::ExpNegOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::exp(-x); });
+        break;
+      case ImageExpression::LogOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::log(x); });
+        break;
+      case ImageExpression::Log10Operation:
+        ApplyUnary(a, count, result, [](double x) { return std::log10(x); });
+        break;
+      case ImageExpression::SinOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::sin(x); });
+        break;
+      case ImageExpression::CosOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::cos(x); });
+        break;
+      case ImageExpression::TanOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::tan(x); });
+        break;
+      case ImageExpression::AsinOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::asin(x); });
+        break;
+      case ImageExpression::AcosOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::acos(x); });
+        break;
+      case ImageExpression::AtanOperation:
+        ApplyUnary(a, count, result, [](double x) { return std::atan(x); });
+        break;
+      case ImageExpression::SelectOperation:
+        for (std::size_t i = 0; i < count; ++i)
+          result[i] = a[i] != 0.0 ? b[i] : c[i];
+        break;
+      default:
+        mitkThrow() << "Unknown image expression operation " << operation;
+    }
+  }
+
+  std::vector<InputImage> m_Inputs;
+  std::vector<ConstantValue> m_Constants;
+  std::vector<Instruction> m_Instructions;
+  unsigned int m_NumberOfSlots;
+  unsigned int m_ResultSlot;
+};
+
+mitk::ImageExpression::ImageExpression(const Image *image)
+{
+  if (image == nullptr)
+  {
+    mitkThrow() << "Image expression created from a null image";
+  }
+
+  auto node = std::make_shared<Node>();
+  node->Operation = InputOperation;
+  node->InputImage = image;
+  node->Value = 0.0;
+  node->ComponentType = 0;
+  m_Node = node;
+}
+
+mitk::ImageExpression::ImageExpression(double value)
+{
+  auto node = std::make_shared<Node>();
+  node->Operation = ConstantOperation;
+  node->Value = value;
+  node->ComponentType = 0;
+  m_Node = node;
+}
+
+mitk::ImageExpression::ImageExpression(const std::shared_ptr<const Node> &node) : m_Node(node)
+{
+}
+
+mitk::ImageExpression mitk::ImageExpression::Create(OperationsEnum operation,
+                                                    const std::vector<ImageExpression> &arguments)
+{
+  auto node = std::make_shared<Node>();
+  node->Operation = operation;
+  node->Value = 0.0;
+  node->ComponentType = 0;
+  for (const auto &argument : arguments)
+  {
+    node->Arguments.push_back(argument.m_Node);
+  }
+  return ImageExpression(std::shared_ptr<const Node>(node));
+}
+
+mitk::ImageExpression mitk::ImageExpression::Pow(double exponent) const
+{
+  return Create(PowerOperation, {*this, ImageExpression(exponent)});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Abs() const
+{
+  return Create(AbsOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Square() const
+{
+  return Create(SquareOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Sqrt() const
+{
+  return Create(SqrtOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Exp() const
+{
+  return Create(ExpOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::ExpNeg() const
+{
+  return Create(ExpNegOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Log() const
+{
+  return Create(LogOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Log10() const
+{
+  return Create(Log10Operation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Sin() const
+{
+  return Create(SinOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Cos() const
+{
+  return Create(CosOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Tan() const
+{
+  return Create(TanOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Asin() const
+{
+  return Create(AsinOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Acos() const
+{
+  return Create(AcosOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Atan() const
+{
+  return Create(AtanOperation, {*this});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Clamp(double lower, double upper) const
+{
+  return Min(Max(*this, ImageExpression(lower)), ImageExpression(upper));
+}
+
+mitk::ImageExpression mitk::ImageExpression::CastTo(const PixelType &pixelType) const
+{
+  const int componentType = pixelType.GetComponentType();
+  if (GetCastFunction(componentType) == nullptr)
+  {
+    mitkThrow() << "Pixel type " << pixelType.GetComponentTypeAsString() << " is not supported by image expressions.";
+  }
+
+  auto node = std::make_shared<Node>();
+  node->Operation = CastOperation;
+  node->Value = 0.0;
+  node->ComponentType = componentType;
+  node->Arguments.push_back(m_Node);
+  return ImageExpression(std::shared_ptr<const Node>(node));
+}
+
+mitk::ImageExpression mitk::ImageExpression::Mask(const ImageExpression &mask, double outsideValue) const
+{
+  return Select(mask, *this, ImageExpression(outsideValue));
+}
+
+mitk::ImageExpression mitk::ImageExpression::Min(const ImageExpression &a, const ImageExpression &b)
+{
+  return Create(MinimumOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Max(const ImageExpression &a, const ImageExpression &b)
+{
+  return Create(MaximumOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Pow(const ImageExpression &base, const ImageExpression &exponent)
+{
+  return Create(PowerOperation, {base, exponent});
+}
+
+mitk::ImageExpression mitk::ImageExpression::Select(const ImageExpression &condition,
+                                                    const ImageExpression &a,
+                                                    const ImageExpression &b)
+{
+  return Create(SelectOperation, {condition, a, b});
+}
+
+unsigned int mitk::ImageExpression::GetNumberOfNodes() const
+{
+  return Program(m_Node).GetNumberOfSlots();
+}
+
+mitk::Image::Pointer mitk::ImageExpression::Evaluate(bool outputAsDouble) const
+{
+  Program program(m_Node);
+  auto &inputs = program.GetInputs();
+  if (inputs.empty())
+  {
+    mitkThrow() << "Image expression does not contain an image";
+  }
+
+  // the first image in the order of the expression defines the output
+  const Image *reference = inputs.front().Source;
+  const unsigned int dimension = reference->GetDimension();
+  std::size_t numberOfVoxels = 1;
+  for (unsigned int i = 0; i < dimension; ++i)
+  {
+    numberOfVoxels *= reference->GetDimension(i);
+  }
+
+  std::vector<std::unique_ptr<ImageReadAccessor>> accessors;
+  for (auto &input : inputs)
+  {
+    const Image *image = input.Source;
+    if (image->GetDimension() != dimension ||
+        !std::equal(reference->GetDimensions(), reference->GetDimensions() + dimension, image->GetDimensions()))
+    {
+      mitkThrow() << "Images of an image expression have different sizes. This is not supported.";
+    }
+    if (image->GetPixelType().GetNumberOfComponents() != 1)
+    {
+      mitkThrow() << "Images of an image expression must have one component per pixel.";
+    }
+
+    input.Load = GetLoadFunction(image->GetPixelType().GetComponentType());
+    if (input.Load == nullptr)
+    {
+      mitkThrow() << "Pixel type " << image->GetPixelType().GetComponentTypeAsString()
+                  << " is not supported by image expressions.";
+    }
+
+    accessors.emplace_back(new ImageReadAccessor(image));
+    input.Data = accessors.back()->GetData();
+  }
+
+  PixelType outputPixelType = outputAsDouble ? MakeScalarPixelType<double>() : reference->GetPixelType();
+  Image::Pointer output = Image::New();
+  output->Initialize(outputPixelType, dimension, reference->GetDimensions());
+  output->SetClonedTimeGeometry(reference->GetTimeGeometry());
+
+  {
+    ImageWriteAccessor outputAccessor(output);
+    program.ExecuteThreaded(numberOfVoxels, outputAccessor.GetData(), GetStoreFunction(outputPixelType.GetComponentType()));
+  }
+
+  return output;
+}
+
+mitk::ImageExpression mitk::operator+(const ImageExpression &a, const ImageExpression &b)
+{
+  return ImageExpression::Create(ImageExpression::AddOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::operator-(const ImageExpression &a, const ImageExpression &b)
+{
+  return ImageExpression::Create(ImageExpression::SubtractOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::operator*(const ImageExpression &a, const ImageExpression &b)
+{
+  return ImageExpression::Create(ImageExpression::MultiplyOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::operator/(const ImageExpression &a, const ImageExpression &b)
+{
+  return ImageExpression::Create(ImageExpression::DivideOperation, {a, b});
+}
+
+mitk::ImageExpression mitk::operator-(const ImageExpression &a)
+{
+  return ImageExpression::Create(ImageExpression::NegateOperation, {a});
+}
+
+mitk::ImageExpression mitk::operator+(const ImageExpression &a, double b)
+{
+  return a + ImageExpression(b);
+}
+
+mitk::ImageExpression mitk::operator-(const ImageExpression &a, double b)
+{
+  return a - ImageExpression(b);
+}
+
+mitk::ImageExpression mitk::operator*(const ImageExpression &a, double b)
+{
+  return a * ImageExpression(b);
+}
+
+mitk::ImageExpression mitk::operator/(const ImageExpression &a, double b)
+{
+  return a / ImageExpression(b);
+}
+
+mitk::ImageExpression mitk::operator+(double a, const ImageExpression &b)
+{
+  return ImageExpression(a) + b;
+}
+
+mitk::ImageExpression mitk::operator-(double a, const ImageExpression &b)
+{
+  return ImageExpression(a) - b;
+}
+
+mitk::ImageExpression mitk::operator*(double a, const ImageExpression &b)
+{
+  return ImageExpression(a) * b;
+}
+
+mitk::ImageExpression mitk::operator/(double a, const ImageExpression &b)
+{
+  return ImageExpression(a) / b;
+}
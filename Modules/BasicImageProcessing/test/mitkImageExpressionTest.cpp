@@ -0,0 +1,243 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkArithmeticOperation.h>
+#include <mitkImageCast.h>
+#include <mitkImageExpression.h>
+
+#include <itkImageRegionIterator.h>
+#include <itkMultiThreader.h>
+
+#include <random>
+
+/**
+ * @brief mitkImageExpressionTestSuite
+ *
+ * Compares the results of image expressions to the same operations done with mitk::ArithmeticOperation. The image
+ * sizes are no multiples of the block size of the expressions (1024 voxels).
+ */
+class mitkImageExpressionTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkImageExpressionTestSuite);
+  MITK_TEST(TestUnaryOperations);
+  MITK_TEST(TestValueOperations);
+  MITK_TEST(TestTwoImageOperations);
+  MITK_TEST(TestSharedSubexpressions);
+  MITK_TEST(TestIntegerOutput);
+  MITK_TEST(TestCastAfterEveryOperation);
+  MITK_TEST(TestSmallImage);
+  MITK_TEST(TestMultiThreaded);
+  MITK_TEST(TestDifferentSizes);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::Image::Pointer m_DoubleImage;
+  mitk::Image::Pointer m_DoubleImage2;
+  mitk::Image::Pointer m_ShortImage;
+  mitk::Image::Pointer m_ShortImage2;
+  itk::ThreadIdType m_NumberOfThreads;
+
+  template <typename TPixel>
+  static mitk::Image::Pointer CreateImage(unsigned int x, unsigned int y, unsigned int z, double minimum, double maximum, unsigned int seed)
+  {
+    typedef itk::Image<TPixel, 3> ItkImageType;
+    typename ItkImageType::SizeType size = {{x, y, z}};
+    typename ItkImageType::Pointer itkImage = ItkImageType::New();
+    itkImage->SetRegions(size);
+    itkImage->Allocate();
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> values(minimum, maximum);
+    itk::ImageRegionIterator<ItkImageType> it(itkImage, itkImage->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      it.Set(static_cast<TPixel>(values(generator)));
+    }
+
+    mitk::Image::Pointer image;
+    mitk::CastToMitkImage(itkImage, image);
+    return image;
+  }
+
+public:
+  void setUp() override
+  {
+    // 37 * 29 * 3 = 3219 voxels, the last block is only partially filled
+    m_DoubleImage = CreateImage<double>(37, 29, 3, 0.1, 2.0, 1);
+    m_DoubleImage2 = CreateImage<double>(37, 29, 3, 0.5, 3.0, 2);
+    m_ShortImage = CreateImage<short>(37, 29, 3, -1000.0, 1000.0, 3);
+    m_ShortImage2 = CreateImage<short>(37, 29, 3, 1.0, 100.0, 4);
+    m_NumberOfThreads = itk::MultiThreader::GetGlobalDefaultNumberOfThreads();
+  }
+
+  void tearDown() override
+  {
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(m_NumberOfThreads);
+    m_DoubleImage = nullptr;
+    m_DoubleImage2 = nullptr;
+    m_ShortImage = nullptr;
+    m_ShortImage2 = nullptr;
+  }
+
+  void TestUnaryOperations()
+  {
+    mitk::ImageExpression image(m_DoubleImage);
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Sqrt(m_DoubleImage), image.Sqrt().Evaluate(), "Sqrt");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Square(m_DoubleImage), image.Square().Evaluate(), "Square");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Exp(m_DoubleImage), image.Exp().Evaluate(), "Exp");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::ExpNeg(m_DoubleImage), image.ExpNeg().Evaluate(), "ExpNeg");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Log10(m_DoubleImage), image.Log10().Evaluate(), "Log10");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Sin(m_DoubleImage), image.Sin().Evaluate(), "Sin");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Atan(m_DoubleImage), image.Atan().Evaluate(), "Atan");
+
+    // integer input, double output
+    mitk::ImageExpression shortImage(m_ShortImage);
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Abs(m_ShortImage), shortImage.Abs().Evaluate(), "Abs");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Cos(m_ShortImage), shortImage.Cos().Evaluate(), "Cos");
+  }
+
+  void TestValueOperations()
+  {
+    mitk::ImageExpression image(m_DoubleImage);
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Add(m_DoubleImage, 2.5), (image + 2.5).Evaluate(), "Image + value");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Multiply(m_DoubleImage, -1.5), (image * -1.5).Evaluate(), "Image * value");
+
+    // double output of an integer image
+    mitk::ImageExpression shortImage(m_ShortImage);
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Add(0.25, m_ShortImage, true), (0.25 + shortImage).Evaluate(), "Value + image");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Multiply(0.3, m_ShortImage, true), (0.3 * shortImage).Evaluate(), "Value * image");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Subtract(m_ShortImage, 0.25, true), (shortImage - 0.25).Evaluate(), "Image - value");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Subtract(0.25, m_ShortImage, true), (0.25 - shortImage).Evaluate(), "Value - image");
+  }
+
+  void TestTwoImageOperations()
+  {
+    mitk::ImageExpression a(m_DoubleImage);
+    mitk::ImageExpression b(m_DoubleImage2);
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Add(m_DoubleImage, m_DoubleImage2), (a + b).Evaluate(), "Add");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Subtract(m_DoubleImage, m_DoubleImage2), (a - b).Evaluate(), "Subtract");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Multiply(m_DoubleImage, m_DoubleImage2), (a * b).Evaluate(), "Multiply");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Divide(m_DoubleImage, m_DoubleImage2), (a / b).Evaluate(), "Divide");
+  }
+
+  void TestSharedSubexpressions()
+  {
+    // (a + 1) * (a + 1) + (a + 1), the sum is computed once
+    mitk::ImageExpression sum = mitk::ImageExpression(m_DoubleImage) + 1.0;
+    mitk::ImageExpression expression = sum * sum + sum;
+    CPPUNIT_ASSERT_EQUAL(5u, expression.GetNumberOfNodes());
+
+    mitk::Image::Pointer expected = mitk::ArithmeticOperation::Add(m_DoubleImage, 1.0);
+    mitk::Image::Pointer product = mitk::ArithmeticOperation::Multiply(expected, expected);
+    expected = mitk::ArithmeticOperation::Add(product, expected);
+    MITK_ASSERT_EQUAL(expected, expression.Evaluate(), "Shared subexpression");
+
+    // an image used several times is read once
+    mitk::ImageExpression image(m_DoubleImage);
+    CPPUNIT_ASSERT_EQUAL(2u, (image * image).GetNumberOfNodes());
+    mitk::Image::Pointer square = mitk::ArithmeticOperation::Multiply(m_DoubleImage, m_DoubleImage);
+    MITK_ASSERT_EQUAL(square, (image * mitk::ImageExpression(m_DoubleImage)).Evaluate(), "Same image twice");
+  }
+
+  void TestIntegerOutput()
+  {
+    mitk::ImageExpression a(m_ShortImage);
+    mitk::ImageExpression b(m_ShortImage2);
+
+    // conversion to the pixel type of the first image truncates towards zero
+    mitk::Image::Pointer result = (a * 2.7).Evaluate(false);
+    CPPUNIT_ASSERT(result->GetPixelType() == m_ShortImage->GetPixelType());
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Multiply(m_ShortImage, 2.7, false), result, "Short * value");
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Add(m_ShortImage, 0.6, false), (a + 0.6).Evaluate(false), "Short + value");
+
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Add(m_ShortImage, m_ShortImage2, false), (a + b).Evaluate(false), "Add");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Subtract(m_ShortImage, m_ShortImage2, false), (a - b).Evaluate(false), "Subtract");
+    MITK_ASSERT_EQUAL(
+      mitk::ArithmeticOperation::Divide(m_ShortImage, m_ShortImage2, false), (a / b).Evaluate(false), "Integer division");
+
+    mitk::Image::Pointer ucharImage = CreateImage<unsigned char>(37, 29, 3, 0.0, 255.0, 5);
+    MITK_ASSERT_EQUAL(mitk::ArithmeticOperation::Multiply(ucharImage, 0.45, false),
+                      (mitk::ImageExpression(ucharImage) * 0.45).Evaluate(false),
+                      "Unsigned char * value");
+  }
+
+  void TestCastAfterEveryOperation()
+  {
+    // rounding after every operation, as a chain of mitk::ArithmeticOperation calls without double output does
+    mitk::Image::Pointer expected = mitk::ArithmeticOperation::Multiply(m_ShortImage, 0.7, false);
+    expected = mitk::ArithmeticOperation::Add(expected, 0.6, false);
+    expected = mitk::ArithmeticOperation::Divide(expected, m_ShortImage2, false);
+
+    const mitk::PixelType pixelType = m_ShortImage->GetPixelType();
+    mitk::ImageExpression expression = (mitk::ImageExpression(m_ShortImage) * 0.7).CastTo(pixelType);
+    expression = (expression + 0.6).CastTo(pixelType);
+    expression = (expression / mitk::ImageExpression(m_ShortImage2)).CastTo(pixelType);
+    MITK_ASSERT_EQUAL(expected, expression.Evaluate(false), "Rounded after every operation");
+
+    // without the casts only the final result is rounded
+    mitk::ImageExpression unrounded =
+      (mitk::ImageExpression(m_ShortImage) * 0.7 + 0.6) / mitk::ImageExpression(m_ShortImage2);
+    CPPUNIT_ASSERT(!mitk::Equal(*expected, *unrounded.Evaluate(false), mitk::eps, false));
+  }
+
+  void TestSmallImage()
+  {
+    // less voxels than one block
+    mitk::Image::Pointer image = CreateImage<float>(5, 3, 1, -2.0, 2.0, 6);
+    mitk::Image::Pointer expected = mitk::ArithmeticOperation::Abs(image);
+    MITK_ASSERT_EQUAL(expected, mitk::ImageExpression(image).Abs().Evaluate(), "Image smaller than a block");
+  }
+
+  void TestMultiThreaded()
+  {
+    // 65 * 63 * 9 voxels in 36 blocks, the threads get different numbers of blocks
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(8);
+    mitk::Image::Pointer image = CreateImage<double>(65, 63, 9, 0.1, 10.0, 7);
+    mitk::Image::Pointer image2 = CreateImage<double>(65, 63, 9, 0.1, 10.0, 8);
+
+    mitk::Image::Pointer expected = mitk::ArithmeticOperation::Sqrt(image);
+    expected = mitk::ArithmeticOperation::Multiply(expected, image2);
+    expected = mitk::ArithmeticOperation::Add(expected, -3.0);
+
+    mitk::ImageExpression expression = mitk::ImageExpression(image).Sqrt() * mitk::ImageExpression(image2) - 3.0;
+    MITK_ASSERT_EQUAL(expected, expression.Evaluate(), "Multi-threaded evaluation");
+
+    itk::MultiThreader::SetGlobalDefaultNumberOfThreads(1);
+    MITK_ASSERT_EQUAL(expected, expression.Evaluate(), "Single-threaded evaluation");
+  }
+
+  void TestDifferentSizes()
+  {
+    mitk::Image::Pointer other = CreateImage<double>(37, 29, 4, 0.0, 1.0, 9);
+    mitk::ImageExpression expression = mitk::ImageExpression(m_DoubleImage) + mitk::ImageExpression(other);
+    CPPUNIT_ASSERT_THROW(expression.Evaluate(), mitk::Exception);
+
+    CPPUNIT_ASSERT_THROW(mitk::ImageExpression(2.0).Evaluate(), mitk::Exception);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkImageExpression)
@@ -16,9 +16,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkContourModelToSurfaceFilter.h>
 #include <mitkSurface.h>
 #include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkPoints.h>
 #include <vtkPolyData.h>
-#include <vtkPolygon.h>
 #include <vtkSmartPointer.h>
 
 mitk::ContourModelToSurfaceFilter::ContourModelToSurfaceFilter()
@@ -76,65 +76,55 @@ void mitk::ContourModelToSurfaceFilter::GenerateData()
 
   for (unsigned int currentTimeStep = 0; currentTimeStep < numberOfTimeSteps; currentTimeStep++)
   {
-    /* First of all convert the control points of the contourModel to vtk points
-    * and add lines in between them
-    */
-    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New(); // the points to draw
-    vtkSmartPointer<vtkCellArray> polygons = vtkSmartPointer<vtkCellArray>::New();
-    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New(); // the lines to connect the points
-
     // if the contour has less than 3 points, set empty PolyData for current timestep
     // polygon needs at least 3 points
-    if (inputContour->GetNumberOfVertices(currentTimeStep) <= 2)
+    const int numberOfVertices = inputContour->GetNumberOfVertices(currentTimeStep);
+    if (numberOfVertices <= 2)
     {
       vtkSmartPointer<vtkPolyData> emptyPolyData = vtkSmartPointer<vtkPolyData>::New();
       surface->SetVtkPolyData(emptyPolyData, currentTimeStep);
       continue;
     }
 
-    // iterate over all control points
-    auto current = inputContour->IteratorBegin(currentTimeStep);
-
-    auto end = inputContour->IteratorEnd(currentTimeStep);
+    /* First of all convert the vertices of the contourModel to vtk points
+    * and add lines in between them. Points and cells are written as blocks.
+    */
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New(); // the points to draw
+    inputContour->ExportVertices(points, currentTimeStep);
 
-    vtkSmartPointer<vtkPolygon> polygon = vtkSmartPointer<vtkPolygon>::New();
-    polygon->GetPointIds()->SetNumberOfIds(inputContour->GetNumberOfVertices(currentTimeStep));
+    // If the contour is closed an additional line has to be created between the first point
+    // and the last point
+    const bool closed = inputContour->IsClosed(currentTimeStep);
+    const vtkIdType numberOfLines = closed ? numberOfVertices : numberOfVertices - 1;
 
-    int j(0);
-    while (current != end)
+    // cell arrays in the legacy layout (number of ids, ids...)
+    vtkSmartPointer<vtkIdTypeArray> lineIds = vtkSmartPointer<vtkIdTypeArray>::New();
+    vtkIdType *lineId = lineIds->WritePointer(0, 3 * numberOfLines);
+    for (vtkIdType id = 1; id < numberOfVertices; ++id)
     {
-      mitk::ContourModel::VertexType *currentPoint = *current;
-
-      vtkIdType id = points->InsertNextPoint(
-        currentPoint->Coordinates[0], currentPoint->Coordinates[1], currentPoint->Coordinates[2]);
-
-      polygon->GetPointIds()->SetId(j, id);
-
-      // create connections between the points
-      // no previous point for first point available (ingnore id=0)
-      if (id > 0)
-      {
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(id - 1);
-        lines->InsertCellPoint(id);
-      }
-
-      current++;
-      j++;
+      *lineId++ = 2;
+      *lineId++ = id - 1;
+      *lineId++ = id;
+    }
+    if (closed)
+    {
+      *lineId++ = 2;
+      *lineId++ = 0;
+      *lineId++ = numberOfVertices - 1;
     }
 
-    /*
-    * If the contour is closed an additional line has to be created between the first point
-    * and the last point
-    */
-    if (inputContour->IsClosed(currentTimeStep))
+    vtkSmartPointer<vtkIdTypeArray> polygonIds = vtkSmartPointer<vtkIdTypeArray>::New();
+    vtkIdType *polygonId = polygonIds->WritePointer(0, numberOfVertices + 1);
+    *polygonId++ = numberOfVertices;
+    for (vtkIdType id = 0; id < numberOfVertices; ++id)
     {
-      lines->InsertNextCell(2);
-      lines->InsertCellPoint(0);
-      lines->InsertCellPoint((inputContour->GetNumberOfVertices(currentTimeStep) - 1));
+      *polygonId++ = id;
     }
 
-    polygons->InsertNextCell(polygon);
+    vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New(); // the lines to connect the points
+    lines->SetCells(numberOfLines, lineIds);
+    vtkSmartPointer<vtkCellArray> polygons = vtkSmartPointer<vtkCellArray>::New();
+    polygons->SetCells(1, polygonIds);
 
     // Create a polydata to store everything in
     vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
@@ -14,18 +14,48 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 ===================================================================*/
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <mitkContourElement.h>
 #include <vtkMath.h>
+#include <vtkPoints.h>
+
+namespace
+{
+  // smallest number of vertices allocated at once
+  const std::size_t MinimumVertexChunkSize = 256;
+
+  // contours with less vertices are always searched by brute force
+  const int MinimumVerticesForSpatialIndex = 32;
+
+  // segments whose bounding box covers more cells are not put into the grid
+  const unsigned long long MaximumCellsPerSegment = 64;
+
+  // number of cells per dimension is limited to 2^20, so a cell key fits into 60 bits
+  const double MaximumCellsPerDimension = 1048576.0;
+}
 
 mitk::ContourElement::ContourElement()
+  : m_VertexBufferValid(false), m_SpatialIndexValid(false), m_QueriesSinceModification(0)
 {
   this->m_Vertices = new VertexListType();
   this->m_IsClosed = false;
 }
 
 mitk::ContourElement::ContourElement(const mitk::ContourElement &other)
-  : itk::LightObject(), m_Vertices(other.m_Vertices), m_IsClosed(other.m_IsClosed)
+  : itk::LightObject(),
+    m_Vertices(new VertexListType()),
+    m_IsClosed(other.m_IsClosed),
+    m_VertexBufferValid(false),
+    m_SpatialIndexValid(false),
+    m_QueriesSinceModification(0)
 {
+  // the vertices are owned by the element, so they have to be copied
+  this->ReserveVertices(other.m_Vertices->size());
+  for (const VertexType *vertex : *other.m_Vertices)
+  {
+    this->m_Vertices->push_back(this->CreateVertex(vertex->Coordinates, vertex->IsControlPoint));
+  }
 }
 
 mitk::ContourElement::~ContourElement()
@@ -33,24 +63,110 @@ mitk::ContourElement::~ContourElement()
   delete this->m_Vertices;
 }
 
+void mitk::ContourElement::ReserveVertices(std::size_t numberOfVertices)
+{
+  if (!m_VertexChunks.empty() && m_VertexChunks.back().capacity() - m_VertexChunks.back().size() >= numberOfVertices)
+    return;
+
+  // grow geometrically, so the number of chunks stays logarithmic in the number of vertices
+  std::size_t chunkSize = std::max(MinimumVertexChunkSize, numberOfVertices);
+  if (!m_VertexChunks.empty())
+    chunkSize = std::max(chunkSize, m_VertexChunks.back().capacity() * 2);
+
+  m_VertexChunks.emplace_back();
+  m_VertexChunks.back().reserve(chunkSize);
+}
+
+mitk::ContourElement::VertexType *mitk::ContourElement::CreateVertex(const mitk::Point3D &point, bool isControlPoint)
+{
+  this->ReserveVertices(1);
+
+  // the chunk has enough capacity, emplace_back does not reallocate
+  m_VertexChunks.back().emplace_back(point, isControlPoint);
+  return &m_VertexChunks.back().back();
+}
+
+void mitk::ContourElement::VerticesModified()
+{
+  m_VertexBufferValid = false;
+  m_SpatialIndexValid = false;
+  m_QueriesSinceModification = 0;
+}
+
+const mitk::ContourElement::VertexBuffer &mitk::ContourElement::GetVertexBuffer()
+{
+  if (!m_VertexBufferValid)
+  {
+    const std::size_t numberOfVertices = m_Vertices->size();
+    m_VertexBuffer.Positions.resize(3 * numberOfVertices);
+    m_VertexBuffer.ControlPointFlags.resize(numberOfVertices);
+
+    double *position = m_VertexBuffer.Positions.data();
+    unsigned char *flag = m_VertexBuffer.ControlPointFlags.data();
+    for (const VertexType *vertex : *m_Vertices)
+    {
+      *position++ = vertex->Coordinates[0];
+      *position++ = vertex->Coordinates[1];
+      *position++ = vertex->Coordinates[2];
+      *flag++ = vertex->IsControlPoint ? 1 : 0;
+    }
+    m_VertexBufferValid = true;
+  }
+  return m_VertexBuffer;
+}
+
 void mitk::ContourElement::AddVertex(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_back(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_back(this->CreateVertex(vertex, isControlPoint));
+  this->VerticesModified();
 }
 
 void mitk::ContourElement::AddVertex(VertexType &vertex)
 {
-  this->m_Vertices->push_back(&vertex);
+  this->m_Vertices->push_back(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->VerticesModified();
 }
 
 void mitk::ContourElement::AddVertexAtFront(mitk::Point3D &vertex, bool isControlPoint)
 {
-  this->m_Vertices->push_front(new VertexType(vertex, isControlPoint));
+  this->m_Vertices->push_front(this->CreateVertex(vertex, isControlPoint));
+  this->VerticesModified();
 }
 
 void mitk::ContourElement::AddVertexAtFront(VertexType &vertex)
 {
-  this->m_Vertices->push_front(&vertex);
+  this->m_Vertices->push_front(this->CreateVertex(vertex.Coordinates, vertex.IsControlPoint));
+  this->VerticesModified();
+}
+
+void mitk::ContourElement::AddVertices(vtkPoints *points, bool isControlPoint)
+{
+  if (points == nullptr || points->GetNumberOfPoints() == 0)
+    return;
+
+  const vtkIdType numberOfPoints = points->GetNumberOfPoints();
+  this->ReserveVertices(numberOfPoints);
+
+  mitk::Point3D point;
+  for (vtkIdType i = 0; i < numberOfPoints; ++i)
+  {
+    points->GetPoint(i, point.GetDataPointer());
+    this->m_Vertices->push_back(this->CreateVertex(point, isControlPoint));
+  }
+  this->VerticesModified();
+}
+
+void mitk::ContourElement::ExportVertices(vtkPoints *points)
+{
+  const VertexBuffer &buffer = this->GetVertexBuffer();
+
+  points->SetDataTypeToDouble();
+  points->SetNumberOfPoints(m_Vertices->size());
+  if (!m_Vertices->empty())
+  {
+    std::memcpy(points->GetData()->GetVoidPointer(0), buffer.Positions.data(), buffer.Positions.size() * sizeof(double));
+  }
+  points->Modified();
 }
 
 void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isControlPoint, int index)
@@ -59,7 +175,8 @@ void mitk::ContourElement::InsertVertexAtIndex(mitk::Point3D &vertex, bool isCon
   {
     auto _where = this->m_Vertices->begin();
     _where += index;
-    this->m_Vertices->insert(_where, new VertexType(vertex, isControlPoint));
+    this->m_Vertices->insert(_where, this->CreateVertex(vertex, isControlPoint));
+    this->VerticesModified();
   }
 }
 
@@ -68,6 +185,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const Point3D &point)
   if (pointId >= 0 && this->GetSize() > pointId)
   {
     this->m_Vertices->at(pointId)->Coordinates = point;
+    this->VerticesModified();
   }
 }
 
@@ -77,6 +195,7 @@ void mitk::ContourElement::SetVertexAt(int pointId, const VertexType *vertex)
   {
     this->m_Vertices->at(pointId)->Coordinates = vertex->Coordinates;
     this->m_Vertices->at(pointId)->IsControlPoint = vertex->IsControlPoint;
+    this->VerticesModified();
   }
 }
 
@@ -92,12 +211,15 @@ bool mitk::ContourElement::IsEmpty()
 
 mitk::ContourElement::VertexType *mitk::ContourElement::GetVertexAt(const mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    // currently no method with better performance is available
-    return BruteForceGetVertexAt(point, eps);
+    std::vector<int> candidates;
+    if (this->UseSpatialIndex() && this->GetCandidates(m_SpatialIndex.VertexCells, point, eps, candidates))
+    {
+      std::sort(candidates.begin(), candidates.end());
+      return this->PickVertex(point, eps, &candidates);
+    }
+    return this->PickVertex(point, eps, nullptr);
   } // if eps < 0
   return nullptr;
 }
@@ -106,54 +228,181 @@ mitk::ContourElement::VertexType *mitk::ContourElement::BruteForceGetVertexAt(co
 {
   if (eps > 0)
   {
-    std::deque<std::pair<double, VertexType *>> nearestlist;
+    return this->PickVertex(point, eps, nullptr);
+  }
+  return nullptr;
+}
+
+mitk::ContourElement::VertexType *mitk::ContourElement::PickVertex(const mitk::Point3D &point,
+                                                                  float eps,
+                                                                  const std::vector<int> *candidates)
+{
+  // Walking the vertices in contour order, every vertex within eps that is closer than all vertices found
+  // before is a new record. The latest record that is a control point wins, otherwise the latest record.
+  // Skipping vertices farther than eps does not change the records, so a sorted candidate list gives the
+  // same result as iterating over all vertices.
+  VertexType *nearest = nullptr;
+  VertexType *nearestControlPoint = nullptr;
+  double nearestDistance = 0.0;
+
+  const std::size_t numberOfCandidates = candidates != nullptr ? candidates->size() : m_Vertices->size();
+  for (std::size_t i = 0; i < numberOfCandidates; ++i)
+  {
+    VertexType *vertex = (*m_Vertices)[candidates != nullptr ? (*candidates)[i] : i];
+
+    double distance = vertex->Coordinates.EuclideanDistanceTo(point);
+    if (distance < eps && (nearest == nullptr || distance < nearestDistance))
+    {
+      nearest = vertex;
+      nearestDistance = distance;
+      if (vertex->IsControlPoint)
+      {
+        nearestControlPoint = vertex;
+      }
+    }
+  }
+
+  return nearestControlPoint != nullptr ? nearestControlPoint : nearest;
+}
+
+bool mitk::ContourElement::UseSpatialIndex()
+{
+  if (m_SpatialIndexValid)
+    return true;
 
-    ConstVertexIterator it = this->m_Vertices->begin();
+  if (this->GetSize() < MinimumVerticesForSpatialIndex || ++m_QueriesSinceModification < 2)
+    return false;
+
+  this->BuildSpatialIndex();
+  return true;
+}
 
-    ConstVertexIterator end = this->m_Vertices->end();
+void mitk::ContourElement::BuildSpatialIndex()
+{
+  const std::vector<double> &positions = this->GetVertexBuffer().Positions;
+  const int numberOfVertices = this->GetSize();
 
-    while (it != end)
+  double minimum[3] = {positions[0], positions[1], positions[2]};
+  double maximum[3] = {positions[0], positions[1], positions[2]};
+  double length = 0.0;
+  for (int i = 0; i < numberOfVertices; ++i)
+  {
+    const double *v1 = &positions[3 * i];
+    const double *v2 = &positions[3 * ((i + 1) % numberOfVertices)];
+    for (int d = 0; d < 3; ++d)
     {
-      mitk::Point3D currentPoint = (*it)->Coordinates;
+      minimum[d] = std::min(minimum[d], v1[d]);
+      maximum[d] = std::max(maximum[d], v1[d]);
+    }
+    length += std::sqrt(vtkMath::Distance2BetweenPoints(v1, v2));
+  }
 
-      double distance = currentPoint.EuclideanDistanceTo(point);
-      if (distance < eps)
-      {
-        // if list is emtpy, add point to list
-        if (nearestlist.size() < 1)
-        {
-          nearestlist.push_front(std::pair<double, VertexType *>((*it)->Coordinates.EuclideanDistanceTo(point), (*it)));
-        }
-        // found an approximate point - check if current is closer then first in nearestlist
-        else if (distance < nearestlist.front().first)
-        {
-          // found even closer vertex
-          nearestlist.push_front(std::pair<double, VertexType *>((*it)->Coordinates.EuclideanDistanceTo(point), (*it)));
-        }
-      } // if distance > eps
+  // cells of about two segment lengths keep the number of entries per segment and per cell small
+  const double maximumExtent = std::max(maximum[0] - minimum[0], std::max(maximum[1] - minimum[1], maximum[2] - minimum[2]));
+  double cellSize = std::max(2.0 * length / numberOfVertices, maximumExtent / (MaximumCellsPerDimension - 1.0));
+  if (!(cellSize > 0.0))
+    cellSize = 1.0;
+
+  SpatialIndex &index = m_SpatialIndex;
+  index.CellSize = cellSize;
+  for (int d = 0; d < 3; ++d)
+  {
+    index.Origin[d] = minimum[d];
+    index.Dimensions[d] = static_cast<unsigned long long>((maximum[d] - minimum[d]) / cellSize) + 1;
+  }
+
+  auto cellIndex = [&index](double coordinate, int d) {
+    const double c = std::floor((coordinate - index.Origin[d]) / index.CellSize);
+    return static_cast<unsigned long long>(std::min(std::max(c, 0.0), static_cast<double>(index.Dimensions[d] - 1)));
+  };
+  auto cellKey = [&index](unsigned long long x, unsigned long long y, unsigned long long z) {
+    return (x * index.Dimensions[1] + y) * index.Dimensions[2] + z;
+  };
+
+  index.VertexCells.clear();
+  index.SegmentCells.clear();
+  index.LongSegments.clear();
+  index.VertexCells.reserve(numberOfVertices);
+  index.SegmentCells.reserve(2 * numberOfVertices);
+
+  for (int i = 0; i < numberOfVertices; ++i)
+  {
+    const double *v1 = &positions[3 * i];
+    const double *v2 = &positions[3 * ((i + 1) % numberOfVertices)];
+
+    index.VertexCells.emplace_back(cellKey(cellIndex(v1[0], 0), cellIndex(v1[1], 1), cellIndex(v1[2], 2)), i);
+
+    unsigned long long first[3], last[3];
+    unsigned long long numberOfCells = 1;
+    for (int d = 0; d < 3; ++d)
+    {
+      first[d] = cellIndex(std::min(v1[d], v2[d]), d);
+      last[d] = cellIndex(std::max(v1[d], v2[d]), d);
+      numberOfCells *= last[d] - first[d] + 1;
+    }
+
+    if (numberOfCells > MaximumCellsPerSegment)
+    {
+      index.LongSegments.push_back(i);
+      continue;
+    }
+
+    for (unsigned long long x = first[0]; x <= last[0]; ++x)
+      for (unsigned long long y = first[1]; y <= last[1]; ++y)
+        for (unsigned long long z = first[2]; z <= last[2]; ++z)
+          index.SegmentCells.emplace_back(cellKey(x, y, z), i);
+  }
+
+  std::sort(index.VertexCells.begin(), index.VertexCells.end());
+  std::sort(index.SegmentCells.begin(), index.SegmentCells.end());
+
+  m_SpatialIndexValid = true;
+}
+
+bool mitk::ContourElement::GetCandidates(const SpatialIndex::CellListType &cells,
+                                         const mitk::Point3D &point,
+                                         double radius,
+                                         std::vector<int> &candidates) const
+{
+  const SpatialIndex &index = m_SpatialIndex;
+
+  // a small margin makes up for rounding in the distance computations of the callers
+  radius = radius * (1.0 + 1e-6) + index.CellSize * 1e-6;
+
+  unsigned long long first[3], last[3];
+  unsigned long long numberOfCells = 1;
+  for (int d = 0; d < 3; ++d)
+  {
+    const double lower = std::floor((point[d] - radius - index.Origin[d]) / index.CellSize);
+    const double upper = std::floor((point[d] + radius - index.Origin[d]) / index.CellSize);
+    if (!(upper >= 0.0) || !(lower <= static_cast<double>(index.Dimensions[d] - 1)))
+      return true; // the query does not touch the grid
+
+    first[d] = static_cast<unsigned long long>(std::max(lower, 0.0));
+    last[d] = static_cast<unsigned long long>(std::min(upper, static_cast<double>(index.Dimensions[d] - 1)));
+    numberOfCells *= last[d] - first[d] + 1;
+  }
+
+  // visiting more cells than there are entries is slower than testing all of them
+  if (numberOfCells > cells.size())
+    return false;
 
-      it++;
-    } // while
-    if (nearestlist.size() > 0)
+  for (unsigned long long x = first[0]; x <= last[0]; ++x)
+  {
+    for (unsigned long long y = first[1]; y <= last[1]; ++y)
     {
-      /*++++++++++++++++++++ return the nearest active point if one was found++++++++++++++++++*/
-      auto it = nearestlist.begin();
-      auto end = nearestlist.end();
-      while (it != end)
+      // cells with consecutive z are consecutive keys
+      const unsigned long long firstKey = (x * index.Dimensions[1] + y) * index.Dimensions[2] + first[2];
+      const unsigned long long lastKey = firstKey + (last[2] - first[2]);
+
+      auto it = std::lower_bound(cells.begin(), cells.end(), std::make_pair(firstKey, -1));
+      for (; it != cells.end() && it->first <= lastKey; ++it)
       {
-        if ((*it).second->IsControlPoint)
-        {
-          return (*it).second;
-        }
-        it++;
+        candidates.push_back(it->second);
       }
-      /*---------------------------------------------------------------------------------------*/
-
-      // return closest point
-      return nearestlist.front().second;
     }
   }
-  return nullptr;
+  return true;
 }
 
 /*mitk::ContourElement::VertexType* mitk::ContourElement::OptimizedGetVertexAt(const mitk::Point3D &point, float eps)
@@ -231,45 +480,52 @@ bool mitk::ContourElement::IsClosed()
   return this->m_IsClosed;
 }
 
-bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
+double mitk::ContourElement::SquaredDistanceToSegment(const mitk::Point3D &point, int index) const
 {
-  ConstVertexIterator it1 = this->m_Vertices->begin();
-  ConstVertexIterator it2 = this->m_Vertices->begin();
-  it2++; // it2 runs one position ahead
+  mitk::Point3D v1 = (*m_Vertices)[index]->Coordinates;
+  mitk::Point3D v2 = (*m_Vertices)[(index + 1) % m_Vertices->size()]->Coordinates;
 
-  ConstVertexIterator end = this->m_Vertices->end();
+  const float l2 = v1.SquaredEuclideanDistanceTo(v2);
 
-  int counter = 0;
-
-  for (; it1 != end; it1++, it2++, counter++)
-  {
-    if (it2 == end)
-      it2 = this->m_Vertices->begin();
-
-    mitk::Point3D v1 = (*it1)->Coordinates;
-    mitk::Point3D v2 = (*it2)->Coordinates;
+  mitk::Vector3D p_v1 = point - v1;
+  mitk::Vector3D v2_v1 = v2 - v1;
 
-    const float l2 = v1.SquaredEuclideanDistanceTo(v2);
+  double tc = (p_v1 * v2_v1) / l2;
 
-    mitk::Vector3D p_v1 = point - v1;
-    mitk::Vector3D v2_v1 = v2 - v1;
+  // take into account we have line segments and not (infinite) lines
+  if (tc < 0.0)
+    tc = 0.0;
+  if (tc > 1.0)
+    tc = 1.0;
 
-    double tc = (p_v1 * v2_v1) / l2;
+  mitk::Point3D crossPoint = v1 + v2_v1 * tc;
 
-    // take into account we have line segments and not (infinite) lines
-    if (tc < 0.0)
-      tc = 0.0;
-    if (tc > 1.0)
-      tc = 1.0;
-
-    mitk::Point3D crossPoint = v1 + v2_v1 * tc;
+  return point.SquaredEuclideanDistanceTo(crossPoint);
+}
 
-    double distance = point.SquaredEuclideanDistanceTo(crossPoint);
+bool mitk::ContourElement::IsNearContour(const mitk::Point3D &point, float eps)
+{
+  // eps is compared to the squared distance
+  if (!(eps > 0) || m_Vertices->empty())
+    return false;
 
-    if (distance < eps)
+  std::vector<int> candidates;
+  if (this->UseSpatialIndex() && this->GetCandidates(m_SpatialIndex.SegmentCells, point, std::sqrt(eps), candidates))
+  {
+    candidates.insert(candidates.end(), m_SpatialIndex.LongSegments.begin(), m_SpatialIndex.LongSegments.end());
+    for (const int segment : candidates)
     {
-      return true;
+      if (this->SquaredDistanceToSegment(point, segment) < eps)
+        return true;
     }
+    return false;
+  }
+
+  const int numberOfSegments = this->GetSize();
+  for (int segment = 0; segment < numberOfSegments; ++segment)
+  {
+    if (this->SquaredDistanceToSegment(point, segment) < eps)
+      return true;
   }
 
   return false;
@@ -334,14 +590,15 @@ void mitk::ContourElement::Concatenate(mitk::ContourElement *other, bool check)
           thisIt++;
         }
         if (!found)
-          this->m_Vertices->push_back(*otherIt);
+          this->m_Vertices->push_back(this->CreateVertex((*otherIt)->Coordinates, (*otherIt)->IsControlPoint));
       }
       else
       {
-        this->m_Vertices->push_back(*otherIt);
+        this->m_Vertices->push_back(this->CreateVertex((*otherIt)->Coordinates, (*otherIt)->IsControlPoint));
       }
       otherIt++;
     }
+    this->VerticesModified();
   }
 }
 
@@ -357,6 +614,7 @@ bool mitk::ContourElement::RemoveVertex(const VertexType *vertex)
     if ((*it) == vertex)
     {
       this->m_Vertices->erase(it);
+      this->VerticesModified();
       return true;
     }
 
@@ -394,6 +652,7 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
   if (index >= 0 && static_cast<VertexListType::size_type>(index) < this->m_Vertices->size())
   {
     this->m_Vertices->erase(this->m_Vertices->begin() + index);
+    this->VerticesModified();
     return true;
   }
   else
@@ -404,27 +663,27 @@ bool mitk::ContourElement::RemoveVertexAt(int index)
 
 bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 {
-  /* current version iterates over the whole deque - should be some kind of an octree with spatial query*/
-
   if (eps > 0)
   {
-    auto it = this->m_Vertices->begin();
-
-    auto end = this->m_Vertices->end();
-
-    while (it != end)
+    std::vector<int> candidates;
+    const bool indexed =
+      this->UseSpatialIndex() && this->GetCandidates(m_SpatialIndex.VertexCells, point, eps, candidates);
+    if (indexed)
     {
-      mitk::Point3D currentPoint = (*it)->Coordinates;
+      std::sort(candidates.begin(), candidates.end());
+    }
 
-      if (currentPoint.EuclideanDistanceTo(point) < eps)
+    // remove the first vertex within eps
+    const std::size_t numberOfCandidates = indexed ? candidates.size() : m_Vertices->size();
+    for (std::size_t i = 0; i < numberOfCandidates; ++i)
+    {
+      const std::size_t index = indexed ? candidates[i] : i;
+      if ((*m_Vertices)[index]->Coordinates.EuclideanDistanceTo(point) < eps)
       {
-        // approximate point found
-        // now erase it
-        this->m_Vertices->erase(it);
+        this->m_Vertices->erase(this->m_Vertices->begin() + index);
+        this->VerticesModified();
         return true;
       }
-
-      it++;
     }
   }
   return false;
@@ -433,6 +692,8 @@ bool mitk::ContourElement::RemoveVertexAt(mitk::Point3D &point, float eps)
 void mitk::ContourElement::Clear()
 {
   this->m_Vertices->clear();
+  this->m_VertexChunks.clear();
+  this->VerticesModified();
 }
 //----------------------------------------------------------------------
 void mitk::ContourElement::RedistributeControlVertices(const VertexType *selected, int period)
@@ -472,4 +733,6 @@ void mitk::ContourElement::RedistributeControlVertices(const VertexType *selecte
     counter++;
     _iter--;
   }
+
+  this->VerticesModified();
 }
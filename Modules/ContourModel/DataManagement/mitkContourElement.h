@@ -23,6 +23,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 //#include <ANN/ANN.h>
 
 #include <deque>
+#include <utility>
+#include <vector>
+
+class vtkPoints;
 
 namespace mitk
 {
@@ -32,6 +36,13 @@ namespace mitk
   end of the contour and to iterate in both directions.
   To mark a vertex as a special one it can be set as a control point.
 
+  The vertices themselves are allocated in chunks owned by the element, so the vertex pointers
+  stay valid until the vertex is removed or the element is cleared. For bulk access a contiguous
+  copy of the positions and control point flags is kept (see GetVertexBuffer()), which is also
+  used to build a uniform grid for IsNearContour() and GetVertexAt(point, eps) when a contour is
+  queried repeatedly. Code that changes vertices through the vertex pointers has to call
+  VerticesModified() afterwards.
+
   \Note It is highly not recommend to use this class directly as no secure mechanism is used here.
   Use mitk::ContourModel instead providing some additional features.
   */
@@ -48,7 +59,7 @@ namespace mitk
       */
       struct ContourModelVertex
     {
-      ContourModelVertex(mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point) {}
+      ContourModelVertex(const mitk::Point3D &point, bool active = false) : IsControlPoint(active), Coordinates(point) {}
       ContourModelVertex(const ContourModelVertex &other)
         : IsControlPoint(other.IsControlPoint), Coordinates(other.Coordinates)
       {
@@ -67,6 +78,15 @@ namespace mitk
     typedef VertexListType::iterator VertexIterator;
     typedef VertexListType::const_iterator ConstVertexIterator;
 
+    /** \brief Contiguous copy of the vertex data in contour order.
+    Positions holds x, y and z of every vertex, ControlPointFlags is 1 for control points.
+    */
+    struct VertexBuffer
+    {
+      std::vector<double> Positions;
+      std::vector<unsigned char> ControlPointFlags;
+    };
+
     //  start of inline methods
 
     /** \brief Return a const iterator a the front.
@@ -108,6 +128,26 @@ namespace mitk
     */
     virtual void AddVertexAtFront(VertexType &vertex);
 
+    /** \brief Add all points at the end of the contour.
+    The vertices are allocated at once, not one by one.
+    \param points - coordinates in 3D space.
+    \param isControlPoint - are the vertices control points.
+    */
+    virtual void AddVertices(vtkPoints *points, bool isControlPoint);
+
+    /** \brief Replaces the content of points by the coordinates of all vertices in contour order.
+    */
+    void ExportVertices(vtkPoints *points);
+
+    /** \brief Returns the contiguous copy of the vertex data, it is rebuilt if the vertices were modified.
+    */
+    const VertexBuffer &GetVertexBuffer();
+
+    /** \brief Invalidates the vertex buffer and the spatial index.
+    Has to be called after vertices were changed through their pointers.
+    */
+    void VerticesModified();
+
     /** \brief Add a vertex at a given index of the contour
     \param point - coordinates in 3D space.
     \param isControlPoint - is the vertex a special control point.
@@ -231,8 +271,60 @@ namespace mitk
     ContourElement(const mitk::ContourElement &other);
     ~ContourElement() override;
 
+    /** \brief Uniform grid over the vertices and the segments of the vertex buffer.
+    Cells are stored as (cell, index) pairs sorted by cell. Segment i connects vertex i
+    with vertex i + 1 (the last one with the first one, like IsNearContour() does).
+    */
+    struct SpatialIndex
+    {
+      typedef std::vector<std::pair<unsigned long long, int>> CellListType;
+
+      double Origin[3];
+      double CellSize;
+      unsigned long long Dimensions[3];
+      CellListType VertexCells;
+      CellListType SegmentCells;
+      std::vector<int> LongSegments; // segments covering too many cells, tested by every query
+    };
+
+    /** \brief Allocates a vertex in the vertex chunks of the element */
+    VertexType *CreateVertex(const mitk::Point3D &point, bool isControlPoint);
+
+    /** \brief Makes sure the next numberOfVertices vertices are allocated in one chunk */
+    void ReserveVertices(std::size_t numberOfVertices);
+
+    /** \brief Returns whether queries should use the spatial index and builds it if necessary.
+    The index is built for the second query after a modification, single queries are answered by brute force.
+    */
+    bool UseSpatialIndex();
+    void BuildSpatialIndex();
+
+    /** \brief Collects the indices of all vertices / segments in the grid cells within radius of point.
+    \return false if the query covers too many cells and should be answered by brute force.
+    */
+    bool GetCandidates(const SpatialIndex::CellListType &cells,
+                       const mitk::Point3D &point,
+                       double radius,
+                       std::vector<int> &candidates) const;
+
+    /** \brief Implements the vertex picking of GetVertexAt(), candidates have to be sorted (nullptr for all vertices) */
+    VertexType *PickVertex(const mitk::Point3D &point, float eps, const std::vector<int> *candidates);
+
+    /** \brief Squared distance of point to the segment from vertex index to its successor */
+    double SquaredDistanceToSegment(const mitk::Point3D &point, int index) const;
+
     VertexListType *m_Vertices; // double ended queue with vertices
     bool m_IsClosed;
+
+    // vertex storage, a chunk is never reallocated, so vertex pointers stay valid
+    std::vector<std::vector<VertexType>> m_VertexChunks;
+
+    VertexBuffer m_VertexBuffer;
+    bool m_VertexBufferValid;
+
+    SpatialIndex m_SpatialIndex;
+    bool m_SpatialIndexValid;
+    unsigned int m_QueriesSinceModification;
   };
 } // namespace mitk
 
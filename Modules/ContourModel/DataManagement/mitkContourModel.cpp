@@ -15,6 +15,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include <mitkContourModel.h>
 #include <mitkPlaneGeometry.h>
+#include <vtkPoints.h>
 
 mitk::ContourModel::ContourModel() : m_UpdateBoundingBox(true)
 {
@@ -72,6 +73,25 @@ void mitk::ContourModel::AddVertex(const VertexType *vertex, int timestep)
   }
 }
 
+void mitk::ContourModel::AddVertices(vtkPoints *points, bool isControlPoint, int timestep)
+{
+  if (!this->IsEmptyTimeStep(timestep) && points != nullptr)
+  {
+    this->m_ContourSeries[timestep]->AddVertices(points, isControlPoint);
+    this->InvokeEvent(ContourModelSizeChangeEvent());
+    this->Modified();
+    this->m_UpdateBoundingBox = true;
+  }
+}
+
+void mitk::ContourModel::ExportVertices(vtkPoints *points, int timestep) const
+{
+  if (!this->IsEmptyTimeStep(timestep) && points != nullptr)
+  {
+    this->m_ContourSeries[timestep]->ExportVertices(points);
+  }
+}
+
 void mitk::ContourModel::AddVertexAtFront(mitk::Point3D &vertex, int timestep)
 {
   if (!this->IsEmptyTimeStep(timestep))
@@ -324,6 +344,7 @@ bool mitk::ContourModel::SetControlVertexAt(mitk::Point3D &point, float eps, int
     if (vertex != nullptr)
     {
       vertex->IsControlPoint = true;
+      this->m_ContourSeries[timestep]->VerticesModified();
       return true;
     }
   }
@@ -338,6 +359,7 @@ bool mitk::ContourModel::SetControlVertexAt(int index, int timestep)
     if (vertex != nullptr)
     {
       vertex->IsControlPoint = true;
+      this->m_ContourSeries[timestep]->VerticesModified();
       return true;
     }
   }
@@ -394,6 +416,7 @@ void mitk::ContourModel::ShiftSelectedVertex(mitk::Vector3D &translate)
   if (this->m_SelectedVertex)
   {
     this->ShiftVertex(this->m_SelectedVertex, translate);
+    this->SelectedVertexModified();
     this->Modified();
     this->m_UpdateBoundingBox = true;
   }
@@ -413,6 +436,7 @@ void mitk::ContourModel::ShiftContour(mitk::Vector3D &translate, int timestep)
       this->ShiftVertex((*it), translate);
       it++;
     }
+    this->m_ContourSeries[timestep]->VerticesModified();
 
     this->Modified();
     this->m_UpdateBoundingBox = true;
@@ -427,6 +451,15 @@ void mitk::ContourModel::ShiftVertex(VertexType *vertex, mitk::Vector3D &vector)
   vertex->Coordinates[2] += vector[2];
 }
 
+void mitk::ContourModel::SelectedVertexModified()
+{
+  // the timestep of the selected vertex is not known, the invalidation is cheap for all of them
+  for (auto &element : this->m_ContourSeries)
+  {
+    element->VerticesModified();
+  }
+}
+
 void mitk::ContourModel::Clear(int timestep)
 {
   if (!this->IsEmptyTimeStep(timestep))
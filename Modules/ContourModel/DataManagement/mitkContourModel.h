@@ -85,6 +85,7 @@ namespace mitk
       if (this->m_SelectedVertex)
       {
         m_SelectedVertex->IsControlPoint = isControlPoint;
+        this->SelectedVertexModified();
         this->Modified();
       }
     }
@@ -148,6 +149,20 @@ namespace mitk
     */
     void AddVertex(mitk::Point3D &vertex, bool isControlPoint, int timestep = 0);
 
+    /** \brief Add all points to the end of the contour at given timestep.
+    The vertices are allocated at once, which is much faster than adding them one by one.
+
+    \param points - coordinates of the vertices
+    \param isControlPoint - specifies the vertices to be handled in a special way
+    \param timestep - the timestep at which the vertices will be added ( default 0)
+    */
+    void AddVertices(vtkPoints *points, bool isControlPoint = false, int timestep = 0);
+
+    /** \brief Replaces the content of points by the coordinates of all vertices at given timestep.
+    The coordinates are copied as one block, points is left unchanged for an invalid timestep.
+    */
+    void ExportVertices(vtkPoints *points, int timestep = 0) const;
+
     /** \brief Add a vertex to the contour at given timestep AT THE FRONT of the contour.
     The vertex is added at the FRONT of contour.
 
@@ -430,6 +445,9 @@ namespace mitk
     // Shift a vertex
     void ShiftVertex(VertexType *vertex, mitk::Vector3D &vector);
 
+    // Notify the contour elements that the selected vertex was changed through its pointer
+    void SelectedVertexModified();
+
     // Storage with time resolved support.
     ContourModelSeries m_ContourSeries;
 
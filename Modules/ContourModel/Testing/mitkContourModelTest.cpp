@@ -16,6 +16,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkContourModel.h>
 #include <mitkTestingMacros.h>
 
+#include <vtkPoints.h>
+#include <vtkSmartPointer.h>
+
+#include <algorithm>
+#include <cmath>
+
 // Add a vertex to the contour and see if size changed
 static void TestAddVertex()
 {
@@ -400,6 +406,137 @@ static void TestContourModelAPI()
   MITK_TEST_CONDITION(contour2->GetNumberOfVertices() == 1, "Add call with another contour");
 }
 
+// Squared distance of p to the closest contour segment, the last vertex is connected to the first one
+static double SquaredDistanceToContour(mitk::ContourElement *element, const mitk::Point3D &p)
+{
+  double minimum = -1;
+  const int size = element->GetSize();
+  for (int i = 0; i < size; ++i)
+  {
+    const mitk::Point3D &a = element->GetVertexAt(i)->Coordinates;
+    const mitk::Point3D &b = element->GetVertexAt((i + 1) % size)->Coordinates;
+    const mitk::Vector3D ab = b - a;
+    double t = ((p - a) * ab) / ab.GetSquaredNorm();
+    t = std::max(0.0, std::min(1.0, t));
+    const double distance = p.SquaredEuclideanDistanceTo(a + ab * t);
+    if (minimum < 0 || distance < minimum)
+      minimum = distance;
+  }
+  return minimum;
+}
+
+// Repeated queries use a spatial index, compare them to the brute force search
+static void TestSpatialQueries()
+{
+  mitk::ContourElement::Pointer element = mitk::ContourElement::New();
+
+  // a spiral with varying segment lengths and some control points
+  for (int i = 0; i < 600; ++i)
+  {
+    mitk::Point3D p;
+    const double angle = 0.05 * i;
+    p[0] = (10 + 0.1 * i) * std::cos(angle);
+    p[1] = (10 + 0.1 * i) * std::sin(angle);
+    p[2] = 0.01 * i;
+    element->AddVertex(p, i % 7 == 0);
+  }
+
+  bool samePick = true;
+  bool sameNear = true;
+  for (int run = 0; run < 2; ++run)
+  {
+    for (int x = -80; x <= 80; x += 3)
+    {
+      for (int y = -80; y <= 80; y += 3)
+      {
+        mitk::Point3D q;
+        q[0] = x + 0.3;
+        q[1] = y - 0.2;
+        q[2] = 3.0;
+
+        samePick &= element->GetVertexAt(q, 3.5) == element->BruteForceGetVertexAt(q, 3.5);
+
+        const double distance = SquaredDistanceToContour(element, q);
+        // skip points where rounding could decide
+        if (std::abs(distance - 4.0) > 1e-6)
+          sameNear &= element->IsNearContour(q, 4.0) == (distance < 4.0);
+      }
+    }
+  }
+
+  MITK_TEST_CONDITION(samePick, "Vertex picking matches brute force search");
+  MITK_TEST_CONDITION(sameNear, "IsNearContour matches distance to the segments");
+
+  // modifications have to invalidate the index
+  mitk::Point3D far;
+  far[0] = 500;
+  far[1] = far[2] = 0;
+  MITK_TEST_CONDITION(!element->IsNearContour(far, 1.0) && !element->IsNearContour(far, 1.0), "far point not near");
+  element->SetVertexAt(100, far);
+  MITK_TEST_CONDITION(element->IsNearContour(far, 1.0), "moved vertex is found");
+  MITK_TEST_CONDITION(element->GetVertexAt(far, 1.0) == element->GetVertexAt(100), "moved vertex is picked");
+}
+
+// Vertices shifted through the model are found at their new position
+static void TestSpatialQueriesAfterShift()
+{
+  mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+  for (int i = 0; i < 100; ++i)
+  {
+    mitk::Point3D p;
+    p[0] = i;
+    p[1] = p[2] = 0;
+    contour->AddVertex(p);
+  }
+
+  mitk::Point3D q;
+  q[0] = 50;
+  q[1] = 10;
+  q[2] = 0;
+  MITK_TEST_CONDITION(!contour->IsNearContour(q, 1.0, 0) && !contour->IsNearContour(q, 1.0, 0), "not near before shift");
+
+  mitk::Vector3D translation;
+  translation[0] = 0;
+  translation[1] = 10;
+  translation[2] = 0;
+  contour->ShiftContour(translation);
+
+  MITK_TEST_CONDITION(contour->IsNearContour(q, 1.0, 0), "near after shift");
+}
+
+// Bulk conversion from and to vtkPoints
+static void TestVtkPointsConversion()
+{
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int i = 0; i < 1000; ++i)
+  {
+    points->InsertNextPoint(i, 2.0 * i, -0.5 * i);
+  }
+
+  mitk::ContourModel::Pointer contour = mitk::ContourModel::New();
+  mitk::Point3D p;
+  p[0] = p[1] = p[2] = -1;
+  contour->AddVertex(p);
+  contour->AddVertices(points, true);
+
+  MITK_TEST_CONDITION(contour->GetNumberOfVertices() == 1001, "vertices added");
+  MITK_TEST_CONDITION(contour->GetVertexAt(1000)->IsControlPoint && !contour->GetVertexAt(0)->IsControlPoint,
+                      "control point flags");
+
+  vtkSmartPointer<vtkPoints> exported = vtkSmartPointer<vtkPoints>::New();
+  contour->ExportVertices(exported);
+
+  bool equal = exported->GetNumberOfPoints() == 1001;
+  for (vtkIdType i = 0; equal && i < exported->GetNumberOfPoints(); ++i)
+  {
+    double point[3];
+    exported->GetPoint(i, point);
+    const mitk::Point3D &vertex = contour->GetVertexAt(i)->Coordinates;
+    equal = point[0] == vertex[0] && point[1] == vertex[1] && point[2] == vertex[2];
+  }
+  MITK_TEST_CONDITION(equal, "exported points equal the vertices");
+}
+
 int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("mitkContourModelTest")
@@ -418,6 +555,9 @@ int mitkContourModelTest(int /*argc*/, char * /*argv*/ [])
   TestSetVertices();
   TestSelectVertexAtWrongPosition();
   TestContourModelAPI();
+  TestSpatialQueries();
+  TestSpatialQueriesAfterShift();
+  TestVtkPointsConversion();
 
   MITK_TEST_END()
 }
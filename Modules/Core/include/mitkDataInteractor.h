@@ -20,6 +20,7 @@
 #include <MitkCoreExports.h>
 #include <mitkCommon.h>
 #include <mitkEventStateMachine.h>
+#include <mitkNumericConstants.h>
 #include <mitkWeakPointer.h>
 #include <string>
 
@@ -66,6 +67,16 @@ namespace mitk
 
     ProcessEventMode GetMode() const;
 
+    /**
+     * \brief Distance (in mm) from the bounding box of the data within which position events can be handled.
+     *
+     * The Dispatcher does not offer position events of 2D render windows to this interactor if they are farther away
+     * from the bounding box of the data of its DataNode. Subclasses return a distance for states in which positions
+     * far from the data cannot trigger any transition. The default of -1 means that position events can be handled
+     * anywhere.
+     */
+    virtual ScalarType GetInteractionDistance() const;
+
   protected:
     DataInteractor();
     ~DataInteractor() override;
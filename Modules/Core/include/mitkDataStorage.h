@@ -18,13 +18,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define MITKDATASTORAGE_H
 
 #include "itkObject.h"
+#include "itkCommand.h"
 #include "itkSimpleFastMutexLock.h"
 #include "itkVectorContainer.h"
 #include "mitkDataNode.h"
 #include "mitkGeometry3D.h"
 #include "mitkMessage.h"
 #include <MitkCoreExports.h>
+#include <atomic>
 #include <map>
+#include <memory>
+#include <vector>
 
 namespace mitk
 {
@@ -278,6 +282,11 @@ namespace mitk
     //## and is set to @a false, the node is ignored for the bounding-box calculation.
     //## @param renderer see @a boolPropertyKey
     //## @param boolPropertyKey2 a second condition that is applied additionally to @a boolPropertyKey
+    //##
+    //## The corner points, spacings and time steps of the nodes of the DataStorage are cached and only
+    //## collected again for nodes whose data geometry changed, so the cost of a call does not depend on the
+    //## number of time steps of unchanged nodes. If none of the considered nodes changed since the last call,
+    //## the same geometry is returned again.
     TimeGeometry::ConstPointer ComputeBoundingGeometry3D(const SetOfObjects *input,
                                                          const char *boolPropertyKey = nullptr,
                                                          const BaseRenderer *renderer = nullptr,
@@ -420,6 +429,70 @@ namespace mitk
     //## to suppress NodeChangedEvent to be emitted.
     bool m_BlockNodeModifiedEvents;
 
+    //##Documentation
+    //## @brief Bounding information of the data of one node, as collected by ComputeBoundingGeometry3D()
+    struct NodeBoundingGeometry
+    {
+      //## data, time geometry, modification time and bounds the information was collected for
+      const BaseData *Data;
+      const TimeGeometry *Geometry;
+      unsigned long Time;
+      BoundingBox::BoundsArrayType Bounds;
+      //## unique number of this collection, 0 if it is not cached
+      unsigned long Revision;
+      //## false for zero bounding boxes, which are ignored
+      bool HasBounds;
+      std::vector<Point3D> CornerPoints;
+      Vector3D MinSpacing;
+      //## sorted start times of all time steps
+      std::vector<ScalarType> TimePoints;
+      ScalarType MaximalTime;
+    };
+
+    //##Documentation
+    //## @brief Cached bounding information of a node of the DataStorage
+    //##
+    //## The entry observes the data of the node, its time geometry and the geometries of all time steps.
+    //## Modified events of these objects and of the node itself mark the entry as dirty.
+    struct CachedNodeBoundingGeometry
+    {
+      CachedNodeBoundingGeometry() : Dirty(true) {}
+      ~CachedNodeBoundingGeometry() { this->RemoveObservers(); }
+
+      void MarkDirty() { Dirty = true; }
+      void AddObserver(itk::Object *object);
+      void RemoveObservers();
+
+      //## nullptr if the data of the node is empty or has no time geometry
+      std::shared_ptr<const NodeBoundingGeometry> Geometry;
+      std::atomic<bool> Dirty;
+      std::vector<std::pair<itk::Object::Pointer, unsigned long>> ObserverTags;
+    };
+
+    //##Documentation
+    //## @brief Returns the bounding information of the data of a node, nullptr if the data is empty
+    //##
+    //## For nodes of this DataStorage the information is collected again only if the entry is marked as dirty or if
+    //## the data is the output of a pipeline. Clean entries do not touch the data or its geometries.
+    std::shared_ptr<const NodeBoundingGeometry> GetNodeBoundingGeometry(const DataNode *node) const;
+
+    //##Documentation
+    //## @brief Collects the bounding information of the data of a node over all time steps
+    std::shared_ptr<NodeBoundingGeometry> CollectNodeBoundingGeometry(const DataNode *node,
+                                                                      const TimeGeometry *timeGeometry) const;
+
+    //##Documentation
+    //## @brief Bounding information of the nodes of the DataStorage, dropped when a node is removed
+    mutable std::map<const DataNode *, std::unique_ptr<CachedNodeBoundingGeometry>> m_BoundingGeometryCache;
+
+    //##Documentation
+    //## @brief Nodes and revisions of their bounding information the last bounding geometry was computed from
+    mutable std::vector<std::pair<const DataNode *, unsigned long>> m_LastBoundingGeometryNodes;
+    mutable TimeGeometry::ConstPointer m_LastBoundingGeometry;
+    mutable bool m_LastBoundingGeometryValid;
+    mutable unsigned long m_BoundingGeometryRevision;
+    mutable itk::SimpleFastMutexLock m_BoundingGeometryMutex;
+
     //##Documentation
     //## @brief Standard Constructor for ::New() instantiation
     DataStorage();
@@ -25,10 +25,14 @@
 #include "usServiceTracker.h"
 #include <MitkCoreExports.h>
 #include <list>
+#include <memory>
 #include <mitkWeakPointer.h>
+#include <utility>
+#include <vector>
 
 namespace mitk
 {
+  class BaseRenderer;
   class InternalEvent;
   class InteractionEvent;
   struct InteractionEventObserver;
@@ -42,6 +46,13 @@ namespace mitk
   * DataNode.
   * Higher layers are preferred.
   *
+  * The DataInteractors are kept sorted by layer when they are added. The layer properties of their DataNodes are
+  * observed, so the order is only updated after a layer has changed instead of for every event.
+  * Position events of 2D render windows are not offered to DataInteractors that restrict their current state to
+  * the surroundings of their data (see DataInteractor::GetInteractionDistance()) if the position is outside of the
+  * (cached) bounding box of the data.
+  * The list of InteractionEventObservers is cached until the service tracker reports a change.
+  *
   * \ingroup Interaction
   */
 
@@ -96,9 +107,34 @@ namespace mitk
     ~Dispatcher() override;
 
   private:
-    ListInteractorType m_Interactors;
+    /** DataInteractor with its cached layer and the cached world bounds of its data */
+    struct InteractorEntry;
+    typedef std::vector<std::shared_ptr<InteractorEntry>> InteractorEntryVectorType;
+
+    typedef std::vector<std::pair<us::ServiceReference<InteractionEventObserver>, InteractionEventObserver *>>
+      EventObserverVectorType;
+
+    /** DataInteractors sorted by layer (descending), DataInteractors with the same layer in the order of adding */
+    InteractorEntryVectorType m_Interactors;
     ListEventsType m_QueuedEvents;
 
+    /** Set by the observers of the layer properties, the order of m_Interactors is checked before the next event */
+    bool m_InteractorOrderModified;
+
+    void OnLayerModified();
+
+    /** (Re)attaches the observers of the layer property of the DataNode of an entry */
+    void ObserveLayer(InteractorEntry &entry, const DataNode *dataNode);
+
+    /** Updates the cached layers and restores the order of m_Interactors if a layer has changed */
+    void UpdateInteractorOrder();
+
+    /**
+     * Checks if a position event at the given world position can be handled by a DataInteractor with regard to the
+     * bounds of its data, see DataInteractor::GetInteractionDistance()
+     */
+    bool IsInInteractionRange(InteractorEntry &entry, const BaseRenderer *renderer, const Point3D &position) const;
+
     /**
      * Removes all Interactors without a DataNode pointing to them, this is necessary especially when a DataNode is
      * assigned to a new Interactor
@@ -125,6 +161,12 @@ namespace mitk
      * InteractionEvents
      */
     us::ServiceTracker<InteractionEventObserver> *m_EventObserverTracker;
+
+    /** InteractionEventObservers of the tracker, valid as long as its tracking count is m_EventObserverTrackingCount */
+    EventObserverVectorType m_EventObservers;
+    int m_EventObserverTrackingCount;
+
+    void UpdateEventObservers();
   };
 
 } /* namespace mitk */
@@ -132,7 +132,7 @@ namespace mitk
     * SetVtkOutputRequest(true) has to be called at least once before
     * GetVtkOutput(). Otherwise the output is empty for the first update step.
     */
-    vtkImageData *GetVtkOutput()
+    virtual vtkImageData *GetVtkOutput()
     {
       m_VtkOutputRequested = true;
       return m_Reslicer->GetOutput();
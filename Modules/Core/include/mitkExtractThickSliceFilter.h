@@ -0,0 +1,130 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkExtractThickSliceFilter_h_Included
+#define mitkExtractThickSliceFilter_h_Included
+
+#include "MitkCoreExports.h"
+#include "mitkExtractSliceFilter.h"
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  \brief ExtractThickSliceFilter extracts a thick slice (slab) of a 3D volume and projects it to a 2D image.
+
+  The slab consists of 2 * ThickSliceNumber + 1 planes parallel to the world geometry, with the distance
+  set by SetOutputSpacingZDirection(). They are combined like vtkMitkThickSlicesFilter does it
+  (MIP, SUM, WEIGHTED, MINIP or MEAN) and give the same result as extracting the slab with
+  ExtractSliceFilter::SetOutputDimensionality(3) followed by vtkMitkThickSlicesFilter.
+
+  The planes are resliced one after another and folded into the projection right away, so the slab
+  itself is never held in memory. Folding a plane is split among threads by rows of the slice.
+
+  For SUM and MEAN the running sum of the slab is kept. If the world geometry was moved along its normal by
+  exactly one plane distance since the last update (scrolling through the volume) and nothing else changed, only
+  the plane entering the slab and the plane leaving it are resliced. For floating point images the running sum
+  is recomputed from scratch from time to time, to keep rounding errors from adding up.
+
+  The projection is only available as vtkImageData (GetVtkOutput()).
+  With a ThickSliceNumber of 0 the filter behaves exactly like ExtractSliceFilter.
+  */
+  class MITKCORE_EXPORT ExtractThickSliceFilter : public ExtractSliceFilter
+  {
+  public:
+    mitkClassMacro(ExtractThickSliceFilter, ExtractSliceFilter);
+    itkFactorylessNewMacro(Self)
+
+    /** \brief Set how the planes are combined, one of the modes of vtkMitkThickSlicesFilter (MIP, SUM, ...) */
+    void SetThickSliceMode(int mode) { m_ThickSliceMode = mode; }
+    int GetThickSliceMode() const { return m_ThickSliceMode; }
+
+    /** \brief Set the number of planes on each side of the world geometry. 0 extracts a plain slice. */
+    void SetThickSliceNumber(int number) { m_ThickSliceNumber = number < 0 ? 0 : number; }
+    int GetThickSliceNumber() const { return m_ThickSliceNumber; }
+
+    /** \brief Get the projected thick slice, or the plain slice if ThickSliceNumber is 0 */
+    vtkImageData *GetVtkOutput() override;
+
+    /** \brief Get the number of planes resliced in the last update */
+    int GetNumberOfReslicedPlanes() const { return m_NumberOfReslicedPlanes; }
+
+  protected:
+    ExtractThickSliceFilter();
+    ~ExtractThickSliceFilter() override;
+
+    void GenerateData() override;
+
+    /** \brief Everything besides the position of the slab which determines the projection */
+    struct SlabKey
+    {
+      const Image *Input;
+      itk::ModifiedTimeType InputTime;
+      unsigned int TimeStep;
+      int Mode;
+      int Number;
+      double ZSpacing;
+      ResliceInterpolation Interpolation;
+      double BackgroundLevel;
+      const BaseGeometry *ResliceTransform;
+      itk::ModifiedTimeType ResliceTransformTime;
+      int Extent[4];
+      double Spacing[2];
+      double Cosines[9];
+      int ScalarType;
+      int NumberOfComponents;
+
+      bool operator==(const SlabKey &other) const;
+    };
+
+    /** \brief Reslices the plane at z (in plane distances) of the slab, returns nullptr on failure */
+    vtkImageData *ExtractPlane(int z);
+
+    /** \brief Describes the slab of the plane just resliced */
+    SlabKey GetSlabKey(vtkImageData *plane, double origin[3]);
+
+    /** \brief Checks whether the slab is the last one moved along its normal by step (-1, 0 or 1) planes */
+    bool IsShiftOfLastSlab(const SlabKey &key, const double origin[3], int &step) const;
+
+    /** \brief Computes the projection from scratch, firstPlane is the already extracted plane at firstZ */
+    bool ComputeProjection(vtkImageData *firstPlane, int firstZ);
+
+    /** \brief Adds the plane times factor to the running sum */
+    bool UpdateRunningSum(vtkImageData *plane, double factor);
+
+    void WriteRunningSumToOutput();
+
+    int m_ThickSliceMode;
+    int m_ThickSliceNumber;
+    int m_NumberOfReslicedPlanes;
+
+    /** \brief Direction of the last move of the slab, the plane entering the slab in this direction is resliced first */
+    int m_LastStep;
+    /** \brief Number of updates of the running sum since it was computed from scratch */
+    int m_IncrementalUpdates;
+
+    bool m_SlabValid;
+    SlabKey m_SlabKey;
+    double m_SlabOrigin[3];
+
+    vtkSmartPointer<vtkImageData> m_ThickSliceOutput;
+    vtkSmartPointer<vtkImageData> m_FirstPlane;
+    std::vector<double> m_RunningSum;
+  };
+}
+
+#endif // mitkExtractThickSliceFilter_h_Included
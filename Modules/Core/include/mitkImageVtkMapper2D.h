@@ -22,7 +22,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // MITK Rendering
 #include "mitkBaseRenderer.h"
-#include "mitkExtractSliceFilter.h"
+#include "mitkExtractThickSliceFilter.h"
 #include "mitkVtkMapper.h"
 
 // VTK
@@ -38,7 +38,6 @@ class vtkImageExtractComponents;
 class vtkImageReslice;
 class vtkImageChangeInformation;
 class vtkPoints;
-class vtkMitkThickSlicesFilter;
 class vtkPolyData;
 class vtkMitkApplyLevelWindowToRGBFilter;
 class vtkMitkLevelWindowFilter;
@@ -172,10 +171,8 @@ namespace mitk
       vtkSmartPointer<vtkLookupTable> m_DefaultLookupTable;
       vtkSmartPointer<vtkLookupTable> m_BinaryLookupTable;
       vtkSmartPointer<vtkLookupTable> m_ColorLookupTable;
-      /** \brief The actual reslicer (one per renderer) */
-      mitk::ExtractSliceFilter::Pointer m_Reslicer;
-      /** \brief Filter for thick slices */
-      vtkSmartPointer<vtkMitkThickSlicesFilter> m_TSFilter;
+      /** \brief The actual reslicer (one per renderer), also projects thick slices */
+      mitk::ExtractThickSliceFilter::Pointer m_Reslicer;
       /** \brief PolyData object containg all lines/points needed for outlining the contour.
             This container is used to save a computed contour for the next rendering execution.
             For instance, if you zoom or pann, there is no need to recompute the contour. */
@@ -0,0 +1,122 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkLazyFileIORegistration_h
+#define mitkLazyFileIORegistration_h
+
+#include <MitkCoreExports.h>
+#include <mitkCustomMimeType.h>
+
+#include <functional>
+#include <set>
+#include <string>
+
+namespace us
+{
+  class ModuleContext;
+}
+
+namespace mitk
+{
+  /**
+   * @ingroup IO
+   *
+   * @brief Defers the creation of file reader and writer services until a lookup needs them.
+   *
+   * Module activators usually create all of their readers and writers on load, and each of them
+   * registers itself as a micro service. For modules with many or expensive IO objects (the core module
+   * creates one mitk::ItkImageIO per ITK image IO factory) this dominates the application startup time,
+   * although most of the objects are never used in a session.
+   *
+   * Instead, an activator can pass the code which creates its IO objects as load function to a
+   * LazyFileIORegistration and declare in the \c manifest.json resource of its module when the objects
+   * are needed:
+   *
+   * \code
+   * {
+   *   "mitk.io" : {
+   *     "<name>" : {
+   *       "extensions" : [ "nrrd", "nhdr" ],
+   *       "mimetypes" : [ "application/vnd.mitk.image.nrrd" ],
+   *       "datatypes" : [ "Image" ]
+   *     }
+   *   }
+   * }
+   * \endcode
+   *
+   * \c extensions are the file extensions of the mime types the load function registers, \c mimetypes the names
+   * of the mime types its readers and writers are registered for and \c datatypes the base data types of its writers.
+   * The mime type provider and the file reader and writer registries load the pending registrations matching a file,
+   * mime type or data type before they look for services. The declarations are a hint: lookups which find nothing and
+   * requests for all mime types load all pending registrations, so an incomplete declaration only costs time.
+   *
+   * Mime types which decide about the file content (and are therefore needed before a reader can be found)
+   * should still be registered by the activator directly.
+   *
+   * The IO objects created by the load function are owned by the caller. Destroying a registration which
+   * was not loaded yet withdraws it.
+   */
+  class MITKCORE_EXPORT LazyFileIORegistration
+  {
+  public:
+    typedef std::function<void()> LoadFunctionType;
+
+    /**
+     * @brief Reads the declarations of the entry \c name below "mitk.io" in the manifest of the module of \c context.
+     */
+    LazyFileIORegistration(us::ModuleContext *context, const std::string &name, const LoadFunctionType &load);
+    ~LazyFileIORegistration();
+
+    std::string GetName() const;
+
+    bool IsLoaded() const;
+
+    /** @brief Runs the load function, unless it was run before */
+    void Load();
+
+    /** @brief Loads the pending registrations declaring an extension of \c path, returns true if any was loaded */
+    static bool LoadForFile(const std::string &path);
+
+    /** @brief Loads the pending registrations declaring the mime type, returns true if any was loaded */
+    static bool LoadForMimeType(const std::string &mimeTypeName);
+
+    /** @brief Loads the pending registrations declaring the base data type, returns true if any was loaded */
+    static bool LoadForDataType(const std::string &dataType);
+
+    /** @brief Loads all pending registrations, returns true if any was loaded */
+    static bool LoadAll();
+
+    static std::size_t GetNumberOfPendingRegistrations();
+
+  private:
+    // purposely not implemented
+    LazyFileIORegistration(const LazyFileIORegistration &);
+    LazyFileIORegistration &operator=(const LazyFileIORegistration &);
+
+    static bool LoadMatching(const std::function<bool(const LazyFileIORegistration *)> &predicate);
+
+    std::string m_Name;
+    LoadFunctionType m_Load;
+    bool m_Loaded;
+
+    // only used to match file extensions
+    CustomMimeType m_Extensions;
+    std::set<std::string> m_MimeTypeNames;
+    std::set<std::string> m_DataTypes;
+  };
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkPolyDataPlaneCutter_h
+#define mitkPolyDataPlaneCutter_h
+
+#include <MitkCoreExports.h>
+
+#include <vtkSmartPointer.h>
+#include <vtkType.h>
+
+#include <vector>
+
+class vtkPolyData;
+
+namespace mitk
+{
+  /**
+   * \brief Cuts the triangles of a vtkPolyData with planes, visiting only triangles close to the plane.
+   *
+   * SetInput() builds a bounding volume hierarchy over the triangles of the polygons and triangle strips of the
+   * input once per input and input MTime. Cut() traverses only the boxes that intersect the plane, so scrolling
+   * through a large surface costs time proportional to the size of the contour instead of the size of the surface.
+   * Planes of any orientation are supported.
+   *
+   * The output is the same as the one of vtkCutter with a vtkPlane: line segments whose points are shared between
+   * neighboring triangles, with point data interpolated along the cut edges and the cell data of the cut cells.
+   * Inputs with vertices or lines are not handled, see CanCut().
+   *
+   * The hierarchy does not depend on the plane, so one instance can serve several render windows.
+   */
+  class MITKCORE_EXPORT PolyDataPlaneCutter
+  {
+  public:
+    PolyDataPlaneCutter();
+    ~PolyDataPlaneCutter();
+
+    /** \brief Sets the input and (re)builds the hierarchy if the input or its MTime changed since the last call */
+    void SetInput(vtkPolyData *input);
+    vtkPolyData *GetInput() const;
+
+    /** \brief MTime of the input the hierarchy was built for */
+    vtkMTimeType GetInputMTime() const;
+
+    /** \brief False if there is no input or the input contains vertices or lines */
+    bool CanCut() const;
+
+    /** \brief Intersection of the input with the plane normal * x = offset, in the coordinates of the input */
+    void Cut(const double normal[3], double offset, vtkPolyData *output) const;
+
+    /** \brief Number of triangles tested by the last call of Cut() */
+    vtkIdType GetNumberOfTestedTriangles() const;
+
+  private:
+    struct Triangle
+    {
+      vtkIdType Points[3];
+      vtkIdType Cell;
+    };
+
+    // leaves have Count > 0 and point to Count triangles starting at First,
+    // inner nodes have Count == 0, their children are the next node and the node at First
+    struct Node
+    {
+      double Bounds[6];
+      vtkIdType First;
+      vtkIdType Count;
+    };
+
+    // triangle with its center and bounds while the hierarchy is built
+    struct BuildItem;
+
+    void Build();
+    vtkIdType BuildNode(std::vector<BuildItem> &items, vtkIdType begin, vtkIdType end);
+
+    vtkSmartPointer<vtkPolyData> m_Input;
+    vtkMTimeType m_InputMTime;
+    bool m_CanCut;
+    std::vector<Triangle> m_Triangles;
+    std::vector<Node> m_Nodes;
+    mutable vtkIdType m_NumberOfTestedTriangles;
+  };
+}
+
+#endif
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkBaseRenderer.h"
 #include "mitkLocalStorageHandler.h"
+#include "mitkPolyDataPlaneCutter.h"
 #include "mitkVtkMapper.h"
 #include <MitkCoreExports.h>
 
@@ -31,6 +32,8 @@ class vtkLookupTable;
 class vtkGlyph3D;
 class vtkArrowSource;
 class vtkReverseSense;
+class vtkPolyData;
+class vtkTransformPolyDataFilter;
 
 namespace mitk
 {
@@ -39,10 +42,14 @@ namespace mitk
   /**
     * @brief Vtk-based mapper for cutting 2D slices out of Surfaces.
     *
-    * The mapper uses a vtkCutter filter to cut out slices (contours) of the 3D
-    * volume and render these slices as vtkPolyData. The data is transformed
-    * according to its geometry before cutting, to support the geometry concept
-    * of MITK.
+    * The mapper cuts out slices (contours) of the 3D volume and renders these
+    * slices as vtkPolyData. Surfaces made of polygons and triangle strips are cut
+    * with a mitk::PolyDataPlaneCutter, whose hierarchy is built once per surface
+    * and shared by all render windows: the plane is transformed into the
+    * coordinates of the surface and only the contour is transformed according to
+    * the geometry of the data. The contour of each render window is kept until
+    * its plane or the surface changes. Other surfaces are transformed according to
+    * their geometry and cut with a vtkCutter.
     *
     * Properties:
     * \b Surface.2D.Line Width: Thickness of the rendered lines in 2D.
@@ -142,6 +149,24 @@ namespace mitk
        */
       vtkSmartPointer<vtkReverseSense> m_ReverseSense;
 
+      /**
+       * @brief m_PlaneCut Contour in the coordinates of the surface, from the shared mitk::PolyDataPlaneCutter.
+       */
+      vtkSmartPointer<vtkPolyData> m_PlaneCut;
+
+      /**
+       * @brief m_PlaneCutTransform Transforms m_PlaneCut according to the geometry of the data.
+       */
+      vtkSmartPointer<vtkTransformPolyDataFilter> m_PlaneCutTransform;
+
+      /**
+       * @brief Plane (in the coordinates of the surface) and surface of m_PlaneCut, to cut again only if one of them changed.
+       */
+      double m_PlaneCutNormal[3];
+      double m_PlaneCutOffset;
+      vtkPolyData *m_PlaneCutInput;
+      vtkMTimeType m_PlaneCutInputMTime;
+
       /** \brief Default constructor of the local storage. */
       LocalStorage();
       /** \brief Default deconstructor of the local storage. */
@@ -212,6 +237,11 @@ namespace mitk
        * @param renderer The respective renderer of the mitkRenderWindow.
        */
     void Update(BaseRenderer *renderer) override;
+
+    /**
+     * @brief Cutting hierarchy of the current surface, shared by the local storages of all render windows.
+     */
+    PolyDataPlaneCutter m_PlaneCutter;
   };
 } // namespace mitk
 #endif /* mitkSurfaceVtkMapper2D_h */
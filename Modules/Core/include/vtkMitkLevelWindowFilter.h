@@ -22,6 +22,8 @@ class vtkPiecewiseFunction;
 #include <vtkImageData.h>
 #include <vtkThreadedImageAlgorithm.h>
 
+#include <vector>
+
 #include <MitkCoreExports.h>
 /** Documentation
 * \brief Applies the grayvalue or color/opacity level window to scalar or RGB(A) images.
@@ -33,6 +35,13 @@ class vtkPiecewiseFunction;
 *
 * The filter is also able to apply an opacity level window to RGBA images.
 *
+* Scalar images are mapped through a color table which holds the RGBA color of every pixel value
+* (integer images) or of 4096 equally spaced values over the range of the lookup table, limited to the
+* minimum and maximum of the input (floating point images). If these are coarser than the colors of the
+* lookup table, each pixel is mapped separately. The table is computed once per update, before the threads are started, and
+* reused as long as the lookup table does not change and the pixel values stay within its range. This
+* saves calling the lookup table or transfer function for every pixel.
+*
 * \ingroup Renderer
 */
 class MITKCORE_EXPORT vtkMitkLevelWindowFilter : public vtkThreadedImageAlgorithm
@@ -84,6 +93,11 @@ protected:
   int RequestInformation(vtkInformation *request,
                          vtkInformationVector **inputVector,
                          vtkInformationVector *outputVector) override;
+  /** \brief Computes the color table for scalar images before the threads are started. */
+  int RequestData(vtkInformation *request,
+                  vtkInformationVector **inputVector,
+                  vtkInformationVector *outputVector) override;
+
   //  /** Standard VTK filter method to apply the filter. See VTK documentation. Not used at the moment.*/
   //  void ExecuteInformation(vtkImageData *vtkNotUsed(inData), vtkImageData *vtkNotUsed(outData));
 
@@ -98,5 +112,26 @@ private:
   double m_MaxOpacity;
 
   double m_ClippingBounds[4];
+
+  /** \brief Updates m_ColorTable for the pixel values of the input, returns false if it cannot be used */
+  bool UpdateColorTable(vtkImageData *input);
+  /** \brief Maps a value like the per pixel methods would, the color is returned as the 4 (RGBA) chars of an int */
+  int MapScalarToColor(double value, bool integerInput);
+
+  /** m_ColorTable contains the RGBA color of the pixel value m_ColorTableOrigin + index / m_ColorTableScale */
+  std::vector<int> m_ColorTable;
+  /** Range of pixel values the color table is valid for */
+  double m_ColorTableMinimum;
+  double m_ColorTableMaximum;
+  double m_ColorTableOrigin;
+  double m_ColorTableScale;
+  int m_ColorTableNanColor;
+  /** What the color table was computed for */
+  vtkScalarsToColors *m_ColorTableLookupTable;
+  vtkPiecewiseFunction *m_ColorTableOpacityFunction;
+  vtkMTimeType m_ColorTableTime;
+  int m_ColorTableScalarType;
+  /** Whether the color table is used in the current update */
+  bool m_UseColorTable;
 };
 #endif
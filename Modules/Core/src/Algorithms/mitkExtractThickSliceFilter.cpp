@@ -0,0 +1,505 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkExtractThickSliceFilter.h"
+
+#include "vtkMitkThickSlicesFilter.h"
+
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkMultiThreader.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+  // running sums of floating point images are recomputed after this number of incremental updates
+  const int MaximumIncrementalUpdates = 64;
+
+  // smaller slices are not worth starting threads
+  const vtkIdType MinimumPixelsPerThread = 16384;
+
+  enum FoldOperation
+  {
+    CopyToOutput,
+    MaximumToOutput,
+    MinimumToOutput,
+    AddToSum,
+    ScaleSumToOutput,
+    DivideSumToOutput
+  };
+
+  struct FoldJob
+  {
+    FoldOperation Operation;
+    int ScalarType;
+    const void *Plane;
+    void *Output;
+    double *Sum;
+    double Factor;
+    vtkIdType NumberOfRows;
+    vtkIdType RowLength;
+  };
+
+  // the loops run over contiguous pixels without dependencies, so that they are vectorized by the compiler
+  template <typename T>
+  void FoldPixels(const FoldJob &job, vtkIdType begin, vtkIdType end)
+  {
+    const T *plane = job.Plane != nullptr ? static_cast<const T *>(job.Plane) + begin : nullptr;
+    T *output = static_cast<T *>(job.Output) + begin;
+    double *sum = job.Sum != nullptr ? job.Sum + begin : nullptr;
+    const double factor = job.Factor;
+    const vtkIdType count = end - begin;
+
+    switch (job.Operation)
+    {
+      case CopyToOutput:
+        std::copy(plane, plane + count, output);
+        break;
+      case MaximumToOutput:
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          output[i] = plane[i] > output[i] ? plane[i] : output[i];
+        }
+        break;
+      case MinimumToOutput:
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          output[i] = plane[i] < output[i] ? plane[i] : output[i];
+        }
+        break;
+      case AddToSum:
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          sum[i] += static_cast<double>(plane[i]) * factor;
+        }
+        break;
+      case ScaleSumToOutput:
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          output[i] = static_cast<T>(factor * sum[i]);
+        }
+        break;
+      case DivideSumToOutput:
+        for (vtkIdType i = 0; i < count; ++i)
+        {
+          output[i] = static_cast<T>(sum[i] / factor);
+        }
+        break;
+    }
+  }
+
+  VTK_THREAD_RETURN_TYPE FoldThread(void *arg)
+  {
+    auto *info = static_cast<vtkMultiThreader::ThreadInfo *>(arg);
+    const auto *job = static_cast<const FoldJob *>(info->UserData);
+
+    // every thread folds its own rows of the slice
+    const vtkIdType beginRow = job->NumberOfRows * info->ThreadID / info->NumberOfThreads;
+    const vtkIdType endRow = job->NumberOfRows * (info->ThreadID + 1) / info->NumberOfThreads;
+
+    switch (job->ScalarType)
+    {
+      vtkTemplateMacro(FoldPixels<VTK_TT>(*job, beginRow * job->RowLength, endRow * job->RowLength));
+    }
+    return VTK_THREAD_RETURN_VALUE;
+  }
+
+  void RunFoldJob(FoldJob &job)
+  {
+    const vtkIdType numberOfPixels = job.NumberOfRows * job.RowLength;
+    const int numberOfThreads = static_cast<int>(
+      std::min<vtkIdType>(std::min<vtkIdType>(vtkMultiThreader::GetGlobalDefaultNumberOfThreads(), job.NumberOfRows),
+                          numberOfPixels / MinimumPixelsPerThread));
+
+    if (numberOfThreads <= 1)
+    {
+      vtkMultiThreader::ThreadInfo info;
+      info.ThreadID = 0;
+      info.NumberOfThreads = 1;
+      info.UserData = &job;
+      FoldThread(&info);
+      return;
+    }
+
+    vtkSmartPointer<vtkMultiThreader> threader = vtkSmartPointer<vtkMultiThreader>::New();
+    threader->SetNumberOfThreads(numberOfThreads);
+    threader->SetSingleMethod(FoldThread, &job);
+    threader->SingleMethodExecute();
+  }
+
+  /** Folds the plane into the output or the running sum of a thick slice, the plane may be nullptr for the
+  operations writing the sum to the output */
+  void Fold(vtkImageData *output, std::vector<double> &sum, vtkImageData *plane, FoldOperation operation,
+            double factor = 1.0)
+  {
+    const int *extent = output->GetExtent();
+
+    FoldJob job;
+    job.Operation = operation;
+    job.ScalarType = output->GetScalarType();
+    job.Plane = plane != nullptr ? plane->GetScalarPointer() : nullptr;
+    job.Output = output->GetScalarPointer();
+    job.Sum = sum.empty() ? nullptr : sum.data();
+    job.Factor = factor;
+    job.NumberOfRows = extent[3] - extent[2] + 1;
+    job.RowLength = vtkIdType(extent[1] - extent[0] + 1) * output->GetNumberOfScalarComponents();
+    RunFoldJob(job);
+  }
+
+  bool IsFloatingPoint(int scalarType) { return scalarType == VTK_FLOAT || scalarType == VTK_DOUBLE; }
+}
+
+bool mitk::ExtractThickSliceFilter::SlabKey::operator==(const SlabKey &other) const
+{
+  if (Input != other.Input || InputTime != other.InputTime || TimeStep != other.TimeStep || Mode != other.Mode ||
+      Number != other.Number || ZSpacing != other.ZSpacing || Interpolation != other.Interpolation ||
+      BackgroundLevel != other.BackgroundLevel || ResliceTransform != other.ResliceTransform ||
+      ResliceTransformTime != other.ResliceTransformTime || ScalarType != other.ScalarType ||
+      NumberOfComponents != other.NumberOfComponents)
+  {
+    return false;
+  }
+  for (int i = 0; i < 4; ++i)
+  {
+    if (Extent[i] != other.Extent[i])
+      return false;
+  }
+  for (int i = 0; i < 2; ++i)
+  {
+    if (std::abs(Spacing[i] - other.Spacing[i]) > mitk::eps)
+      return false;
+  }
+  for (int i = 0; i < 9; ++i)
+  {
+    if (std::abs(Cosines[i] - other.Cosines[i]) > mitk::eps)
+      return false;
+  }
+  return true;
+}
+
+mitk::ExtractThickSliceFilter::ExtractThickSliceFilter()
+  : m_ThickSliceMode(vtkMitkThickSlicesFilter::MIP),
+    m_ThickSliceNumber(0),
+    m_NumberOfReslicedPlanes(0),
+    m_LastStep(1),
+    m_IncrementalUpdates(0),
+    m_SlabValid(false),
+    m_SlabKey(),
+    m_ThickSliceOutput(vtkSmartPointer<vtkImageData>::New()),
+    m_FirstPlane(vtkSmartPointer<vtkImageData>::New())
+{
+  m_SlabOrigin[0] = m_SlabOrigin[1] = m_SlabOrigin[2] = 0.0;
+}
+
+mitk::ExtractThickSliceFilter::~ExtractThickSliceFilter()
+{
+}
+
+vtkImageData *mitk::ExtractThickSliceFilter::GetVtkOutput()
+{
+  if (m_ThickSliceNumber < 1)
+  {
+    return Superclass::GetVtkOutput();
+  }
+
+  m_VtkOutputRequested = true;
+  return m_ThickSliceOutput;
+}
+
+void mitk::ExtractThickSliceFilter::GenerateData()
+{
+  m_NumberOfReslicedPlanes = 0;
+
+  if (m_ThickSliceNumber < 1)
+  {
+    m_SlabValid = false;
+    Superclass::GenerateData();
+    m_NumberOfReslicedPlanes = 1;
+    return;
+  }
+
+  // the planes are extracted by the base class one after another, each as a 3D image with one slice
+  const unsigned int outputDimension = m_OutputDimension;
+  const int zMin = m_ZMin;
+  const int zMax = m_ZMax;
+  const bool vtkOutputRequested = m_VtkOutputRequested;
+  m_OutputDimension = 3;
+  m_VtkOutputRequested = true;
+
+  // a slab which is scrolled most likely moves in the same direction as before,
+  // so the plane entering the slab in this direction is extracted first
+  const int guessedZ = m_LastStep * m_ThickSliceNumber;
+  vtkImageData *plane = this->ExtractPlane(guessedZ);
+  bool valid = plane != nullptr;
+
+  if (valid)
+  {
+    double origin[3];
+    const SlabKey key = this->GetSlabKey(plane, origin);
+
+    int step = 0;
+    const bool shifted = this->IsShiftOfLastSlab(key, origin, step);
+    const bool runningSum =
+      m_ThickSliceMode == vtkMitkThickSlicesFilter::SUM || m_ThickSliceMode == vtkMitkThickSlicesFilter::MEAN;
+
+    if (shifted && step == 0)
+    {
+      // same slab as before, the projection is still up to date
+    }
+    else if (shifted && runningSum &&
+             (!IsFloatingPoint(key.ScalarType) || m_IncrementalUpdates < MaximumIncrementalUpdates))
+    {
+      if (step != m_LastStep)
+      {
+        plane = this->ExtractPlane(step * m_ThickSliceNumber);
+      }
+      valid = this->UpdateRunningSum(plane, 1.0);
+
+      vtkImageData *leavingPlane = valid ? this->ExtractPlane(-step * (m_ThickSliceNumber + 1)) : nullptr;
+      valid = valid && this->UpdateRunningSum(leavingPlane, -1.0);
+      if (valid)
+      {
+        this->WriteRunningSumToOutput();
+      }
+
+      m_LastStep = step;
+      ++m_IncrementalUpdates;
+    }
+    else
+    {
+      valid = this->ComputeProjection(plane, guessedZ);
+      if (shifted)
+      {
+        m_LastStep = step;
+      }
+      m_IncrementalUpdates = 0;
+    }
+
+    m_SlabKey = key;
+    std::copy(origin, origin + 3, m_SlabOrigin);
+  }
+
+  m_SlabValid = valid;
+  if (!valid)
+  {
+    itkWarningMacro(<< "Thick slice could not be extracted");
+  }
+
+  m_OutputDimension = outputDimension;
+  m_ZMin = zMin;
+  m_ZMax = zMax;
+  m_VtkOutputRequested = vtkOutputRequested;
+}
+
+vtkImageData *mitk::ExtractThickSliceFilter::ExtractPlane(int z)
+{
+  m_ZMin = z;
+  m_ZMax = z;
+  Superclass::GenerateData();
+  ++m_NumberOfReslicedPlanes;
+
+  // the base class leaves the last output in place if it cannot reslice
+  vtkImageData *plane = m_Reslicer->GetOutput();
+  const int *extent = plane->GetExtent();
+  if (extent[4] != z || extent[5] != z || plane->GetScalarPointer() == nullptr)
+  {
+    return nullptr;
+  }
+  return plane;
+}
+
+mitk::ExtractThickSliceFilter::SlabKey mitk::ExtractThickSliceFilter::GetSlabKey(vtkImageData *plane,
+                                                                                 double origin[3])
+{
+  const Image *input = this->GetInput();
+
+  SlabKey key;
+  key.Input = input;
+  key.InputTime = std::max<itk::ModifiedTimeType>(input->GetMTime(), input->GetGeometry(m_TimeStep)->GetMTime());
+  key.TimeStep = m_TimeStep;
+  key.Mode = m_ThickSliceMode;
+  key.Number = m_ThickSliceNumber;
+  key.ZSpacing = m_ZSpacing;
+  key.Interpolation = m_InterpolationMode;
+  key.BackgroundLevel = m_BackgroundLevel;
+  key.ResliceTransform = m_ResliceTransform.GetPointer();
+  key.ResliceTransformTime = m_ResliceTransform.IsNotNull() ? m_ResliceTransform->GetMTime() : 0;
+  std::copy(plane->GetExtent(), plane->GetExtent() + 4, key.Extent);
+  key.Spacing[0] = m_OutPutSpacing[0];
+  key.Spacing[1] = m_OutPutSpacing[1];
+  key.ScalarType = plane->GetScalarType();
+  key.NumberOfComponents = plane->GetNumberOfScalarComponents();
+
+  // the columns of the reslice axes are the axes of the slice and its origin
+  vtkMatrix4x4 *axes = m_Reslicer->GetResliceAxes();
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      key.Cosines[3 * j + i] = axes->GetElement(i, j);
+    }
+    origin[i] = axes->GetElement(i, 3);
+  }
+  return key;
+}
+
+bool mitk::ExtractThickSliceFilter::IsShiftOfLastSlab(const SlabKey &key, const double origin[3], int &step) const
+{
+  if (!m_SlabValid || !(key == m_SlabKey))
+  {
+    return false;
+  }
+
+  const double *normal = key.Cosines + 6;
+  double delta[3];
+  double offset = 0.0;
+  for (int i = 0; i < 3; ++i)
+  {
+    delta[i] = origin[i] - m_SlabOrigin[i];
+    offset += delta[i] * normal[i];
+  }
+
+  const double planes = offset / key.ZSpacing;
+  step = static_cast<int>(std::floor(planes + 0.5));
+  if (step < -1 || step > 1 || std::abs(planes - step) > mitk::eps)
+  {
+    return false;
+  }
+
+  // the slab must not move within its plane
+  for (int i = 0; i < 3; ++i)
+  {
+    if (std::abs(delta[i] - step * key.ZSpacing * normal[i]) > mitk::eps)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool mitk::ExtractThickSliceFilter::ComputeProjection(vtkImageData *firstPlane, int firstZ)
+{
+  // later planes are extracted into the same vtkImageData
+  m_FirstPlane->DeepCopy(firstPlane);
+
+  int extent[6];
+  m_FirstPlane->GetExtent(extent);
+  extent[4] = extent[5] = 0;
+  m_ThickSliceOutput->SetExtent(extent);
+  m_ThickSliceOutput->SetOrigin(m_FirstPlane->GetOrigin());
+  m_ThickSliceOutput->SetSpacing(m_FirstPlane->GetSpacing());
+  m_ThickSliceOutput->AllocateScalars(m_FirstPlane->GetScalarType(), m_FirstPlane->GetNumberOfScalarComponents());
+
+  // the maximum and minimum are folded into the output directly
+  const bool runningSum =
+    m_ThickSliceMode == vtkMitkThickSlicesFilter::SUM || m_ThickSliceMode == vtkMitkThickSlicesFilter::MEAN ||
+    m_ThickSliceMode == vtkMitkThickSlicesFilter::WEIGHTED;
+  m_RunningSum.assign(
+    runningSum ? m_ThickSliceOutput->GetNumberOfPoints() * m_ThickSliceOutput->GetNumberOfScalarComponents() : 0,
+    0.0);
+
+  const int minZ = -m_ThickSliceNumber;
+  const int maxZ = m_ThickSliceNumber;
+
+  // weights as used by vtkMitkThickSlicesFilter, the first plane of the slab is not weighted
+  std::vector<double> weights;
+  if (m_ThickSliceMode == vtkMitkThickSlicesFilter::WEIGHTED)
+  {
+    const int size = maxZ - minZ;
+    const double mean = 0.5 * double(minZ + maxZ);
+    double sigma_sq = double(size) / 6.0;
+    sigma_sq *= sigma_sq;
+    double sum = 0;
+    for (int z = minZ + 1; z <= maxZ; z++)
+    {
+      double val = std::exp(-(((double)z - mean) / sigma_sq));
+      weights.push_back(val);
+      sum += val;
+    }
+    for (auto &weight : weights)
+    {
+      weight /= sum;
+    }
+  }
+
+  // the planes are folded in the order of the slab to sum them up like vtkMitkThickSlicesFilter
+  for (int z = minZ; z <= maxZ; ++z)
+  {
+    if (m_ThickSliceMode == vtkMitkThickSlicesFilter::WEIGHTED && z == minZ)
+    {
+      continue;
+    }
+
+    vtkImageData *plane = z == firstZ ? m_FirstPlane.GetPointer() : this->ExtractPlane(z);
+    if (plane == nullptr || plane->GetNumberOfPoints() != m_ThickSliceOutput->GetNumberOfPoints())
+    {
+      return false;
+    }
+
+    switch (m_ThickSliceMode)
+    {
+      case vtkMitkThickSlicesFilter::SUM:
+      case vtkMitkThickSlicesFilter::MEAN:
+        this->UpdateRunningSum(plane, 1.0);
+        break;
+      case vtkMitkThickSlicesFilter::WEIGHTED:
+        this->UpdateRunningSum(plane, weights[z - minZ - 1]);
+        break;
+      case vtkMitkThickSlicesFilter::MINIP:
+        Fold(m_ThickSliceOutput, m_RunningSum, plane, z == minZ ? CopyToOutput : MinimumToOutput);
+        break;
+      default:
+        Fold(m_ThickSliceOutput, m_RunningSum, plane, z == minZ ? CopyToOutput : MaximumToOutput);
+        break;
+    }
+  }
+
+  this->WriteRunningSumToOutput();
+  return true;
+}
+
+bool mitk::ExtractThickSliceFilter::UpdateRunningSum(vtkImageData *plane, double factor)
+{
+  if (plane == nullptr || plane->GetNumberOfPoints() != m_ThickSliceOutput->GetNumberOfPoints())
+  {
+    return false;
+  }
+  Fold(m_ThickSliceOutput, m_RunningSum, plane, AddToSum, factor);
+  return true;
+}
+
+void mitk::ExtractThickSliceFilter::WriteRunningSumToOutput()
+{
+  const int numberOfPlanes = 2 * m_ThickSliceNumber + 1;
+  switch (m_ThickSliceMode)
+  {
+    case vtkMitkThickSlicesFilter::SUM:
+      Fold(m_ThickSliceOutput, m_RunningSum, nullptr, ScaleSumToOutput, 1.0 / numberOfPlanes);
+      break;
+    case vtkMitkThickSlicesFilter::WEIGHTED:
+      Fold(m_ThickSliceOutput, m_RunningSum, nullptr, ScaleSumToOutput, 1.0);
+      break;
+    case vtkMitkThickSlicesFilter::MEAN:
+      // vtkMitkThickSlicesFilter divides by the number of planes minus one
+      Fold(m_ThickSliceOutput, m_RunningSum, nullptr, DivideSumToOutput, numberOfPlanes - 1);
+      break;
+    default:
+      break;
+  }
+  m_ThickSliceOutput->Modified();
+}
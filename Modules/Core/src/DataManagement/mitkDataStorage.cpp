@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkCommand.h"
 #include "itkMutexLockHolder.h"
+#include "mitkBaseDataSource.h"
 #include "mitkDataNode.h"
 #include "mitkGroupTagProperty.h"
 #include "mitkImage.h"
@@ -26,7 +27,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkProperties.h"
 #include "mitkArbitraryTimeGeometry.h"
 
-mitk::DataStorage::DataStorage() : itk::Object(), m_BlockNodeModifiedEvents(false)
+#include <algorithm>
+#include <iterator>
+#include <set>
+
+mitk::DataStorage::DataStorage()
+  : itk::Object(),
+    m_BlockNodeModifiedEvents(false),
+    m_LastBoundingGeometryValid(false),
+    m_BoundingGeometryRevision(0)
 {
 }
 
@@ -198,10 +207,19 @@ void mitk::DataStorage::OnNodeInteractorChanged(itk::Object *caller, const itk::
 
 void mitk::DataStorage::OnNodeModifiedOrDeleted(const itk::Object *caller, const itk::EventObject &event)
 {
+  const auto *_Node = dynamic_cast<const DataNode *>(caller);
+  if (_Node && dynamic_cast<const itk::ModifiedEvent *>(&event))
+  {
+    // the data of the node could have been replaced
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BoundingGeometryMutex);
+    auto cached = m_BoundingGeometryCache.find(_Node);
+    if (cached != m_BoundingGeometryCache.end())
+      cached->second->MarkDirty();
+  }
+
   if (m_BlockNodeModifiedEvents)
     return;
 
-  const auto *_Node = dynamic_cast<const DataNode *>(caller);
   if (_Node)
   {
     const auto *modEvent = dynamic_cast<const itk::ModifiedEvent *>(&event);
@@ -253,103 +271,257 @@ void mitk::DataStorage::RemoveListeners(const DataNode *_Node)
     m_NodeModifiedObserverTags.erase(NonConstNode);
     m_NodeDeleteObserverTags.erase(NonConstNode);
     m_NodeInteractorChangedObserverTags.erase(NonConstNode);
+
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lockedCache(m_BoundingGeometryMutex);
+    m_BoundingGeometryCache.erase(_Node);
   }
 }
 
-mitk::TimeGeometry::ConstPointer mitk::DataStorage::ComputeBoundingGeometry3D(const SetOfObjects *input,
-                                                                              const char *boolPropertyKey,
-                                                                              const BaseRenderer *renderer,
-                                                                              const char *boolPropertyKey2) const
+void mitk::DataStorage::CachedNodeBoundingGeometry::AddObserver(itk::Object *object)
 {
-  if (input == nullptr)
-    throw std::invalid_argument("DataStorage: input is invalid");
+  itk::SimpleMemberCommand<CachedNodeBoundingGeometry>::Pointer command =
+    itk::SimpleMemberCommand<CachedNodeBoundingGeometry>::New();
+  command->SetCallbackFunction(this, &CachedNodeBoundingGeometry::MarkDirty);
+  ObserverTags.emplace_back(object, object->AddObserver(itk::ModifiedEvent(), command));
+}
 
-  BoundingBox::PointsContainer::Pointer pointscontainer = BoundingBox::PointsContainer::New();
+void mitk::DataStorage::CachedNodeBoundingGeometry::RemoveObservers()
+{
+  for (const auto &observer : ObserverTags)
+    observer.first->RemoveObserver(observer.second);
+  ObserverTags.clear();
+}
 
-  BoundingBox::PointIdentifier pointid = 0;
-  Point3D point;
+std::shared_ptr<const mitk::DataStorage::NodeBoundingGeometry> mitk::DataStorage::GetNodeBoundingGeometry(
+  const DataNode *node) const
+{
+  BaseData *data = node->GetData();
+  // the output of a pipeline can change in UpdateOutputInformation() without a modified event
+  const bool isPipelineOutput = data->GetSource().IsNotNull();
 
-  Vector3D minSpacing;
-  minSpacing.Fill(itk::NumericTraits<ScalarType>::max());
+  std::shared_ptr<const NodeBoundingGeometry> previous;
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BoundingGeometryMutex);
+    auto cached = m_BoundingGeometryCache.find(node);
+    if (cached != m_BoundingGeometryCache.end())
+    {
+      if (!cached->second->Dirty && !isPipelineOutput)
+        return cached->second->Geometry;
+      previous = cached->second->Geometry;
+    }
+  }
 
-  ScalarType stmax = itk::NumericTraits<ScalarType>::max();
-  ScalarType stmin = itk::NumericTraits<ScalarType>::NonpositiveMin();
+  std::shared_ptr<const NodeBoundingGeometry> result;
+  std::shared_ptr<NodeBoundingGeometry> collected;
+  if (data->IsEmpty() == false)
+  {
+    const TimeGeometry *timeGeometry = data->GetUpdatedTimeGeometry();
+    if (timeGeometry != nullptr)
+    {
+      // keep the information (and its revision) if only the node or unrelated properties of the data changed
+      if (previous != nullptr && previous->Data == data && previous->Geometry == timeGeometry &&
+          previous->Time == data->GetMTime() &&
+          previous->Bounds == timeGeometry->GetBoundingBoxInWorld()->GetBounds())
+      {
+        result = previous;
+      }
+      else
+      {
+        collected = this->CollectNodeBoundingGeometry(node, timeGeometry);
+        result = collected;
+      }
+    }
+  }
 
-  std::set<ScalarType> existingTimePoints;
-  ScalarType maximalTime = 0;
+  // only nodes of this DataStorage are cached, others could be deleted without notice
+  itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_MutexOne);
+  if (m_NodeModifiedObserverTags.find(node) != m_NodeModifiedObserverTags.end())
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> lockedCache(m_BoundingGeometryMutex);
+    std::unique_ptr<CachedNodeBoundingGeometry> &cached = m_BoundingGeometryCache[node];
+    if (cached == nullptr)
+      cached.reset(new CachedNodeBoundingGeometry);
+
+    if (collected != nullptr)
+      collected->Revision = ++m_BoundingGeometryRevision;
+
+    // observe the current data and geometries, the data may have been replaced or have new time steps
+    cached->RemoveObservers();
+    cached->AddObserver(data);
+    TimeGeometry *timeGeometry = data->GetTimeGeometry();
+    if (timeGeometry != nullptr)
+    {
+      cached->AddObserver(timeGeometry);
+      std::set<BaseGeometry *> stepGeometries;
+      for (TimeStepType i = 0; i < timeGeometry->CountTimeSteps(); ++i)
+      {
+        BaseGeometry::Pointer stepGeometry = timeGeometry->GetGeometryForTimeStep(i);
+        if (stepGeometry.IsNotNull() && stepGeometries.insert(stepGeometry.GetPointer()).second)
+          cached->AddObserver(stepGeometry);
+      }
+    }
+
+    cached->Geometry = result;
+    cached->Dirty = false;
+  }
+  return result;
+}
+
+std::shared_ptr<mitk::DataStorage::NodeBoundingGeometry> mitk::DataStorage::CollectNodeBoundingGeometry(
+  const DataNode *node, const TimeGeometry *timeGeometry) const
+{
+  const BaseData *data = node->GetData();
+  // the bounding box is updated with the data, also for changes which do not modify the geometry
+  const BoundingBox::BoundsArrayType itkBounds = timeGeometry->GetBoundingBoxInWorld()->GetBounds();
+
+  auto result = std::make_shared<NodeBoundingGeometry>();
+  result->Data = data;
+  result->Geometry = timeGeometry;
+  result->Time = data->GetMTime();
+  result->Bounds = itkBounds;
+  result->Revision = 0;
+  result->MinSpacing.Fill(itk::NumericTraits<ScalarType>::max());
+  result->MaximalTime = 0;
 
   // Needed for check of zero bounding boxes
   ScalarType nullpoint[] = {0, 0, 0, 0, 0, 0};
   BoundingBox::BoundsArrayType itkBoundsZero(nullpoint);
 
-  for (SetOfObjects::ConstIterator it = input->Begin(); it != input->End(); ++it)
+  // bounding box (only if non-zero)
+  result->HasBounds = itkBounds != itkBoundsZero;
+  if (result->HasBounds)
   {
-    DataNode::Pointer node = it->Value();
-    if ((node.IsNotNull()) && (node->GetData() != nullptr) && (node->GetData()->IsEmpty() == false) &&
-        node->IsOn(boolPropertyKey, renderer) && node->IsOn(boolPropertyKey2, renderer))
+    for (unsigned char i = 0; i < 8; ++i)
     {
-      const TimeGeometry *timeGeometry = node->GetData()->GetUpdatedTimeGeometry();
-
-      if (timeGeometry != nullptr)
+      Point3D point = timeGeometry->GetCornerPointInWorld(i);
+      if (point[0] * point[0] + point[1] * point[1] + point[2] * point[2] < large)
+        result->CornerPoints.push_back(point);
+      else
       {
-        // bounding box (only if non-zero)
-        BoundingBox::BoundsArrayType itkBounds = timeGeometry->GetBoundingBoxInWorld()->GetBounds();
-        if (itkBounds == itkBoundsZero)
-        {
-          continue;
-        }
+        itkGenericOutputMacro(<< "Unrealistically distant corner point encountered. Ignored. Node: " << node);
+      }
+    }
 
-        unsigned char i;
-        for (i = 0; i < 8; ++i)
+    ScalarType stmax = itk::NumericTraits<ScalarType>::max();
+    ScalarType stmin = itk::NumericTraits<ScalarType>::NonpositiveMin();
+    std::set<ScalarType> existingTimePoints;
+    try
+    {
+      // time bounds
+      // iterate over all time steps
+      // Attention: Objects with zero bounding box are not respected in time bound calculation
+      for (TimeStepType i = 0; i < timeGeometry->CountTimeSteps(); i++)
+      {
+        // We must not use 'node->GetData()->GetGeometry(i)->GetSpacing()' here, as it returns the spacing
+        // in its original space, which, in case of an image geometry, can have the values in different
+        // order than in world space. For the further calculations, we need to have the spacing values
+        // in world coordinate order (sag-cor-ax).
+        Vector3D spacing;
+        spacing.Fill(1.0);
+        data->GetGeometry(i)->IndexToWorld(spacing, spacing);
+        for (int axis = 0; axis < 3; ++ axis)
         {
-          point = timeGeometry->GetCornerPointInWorld(i);
-          if (point[0] * point[0] + point[1] * point[1] + point[2] * point[2] < large)
-            pointscontainer->InsertElement(pointid++, point);
-          else
+          ScalarType space = std::abs(spacing[axis]);
+          if (space < result->MinSpacing[axis])
           {
-            itkGenericOutputMacro(<< "Unrealistically distant corner point encountered. Ignored. Node: " << node);
+            result->MinSpacing[axis] = space;
           }
         }
-        try
+
+        const auto curTimeBounds = timeGeometry->GetTimeBounds(i);
+        if ((curTimeBounds[0] > stmin) && (curTimeBounds[0] < stmax))
         {
-          // time bounds
-          // iterate over all time steps
-          // Attention: Objects with zero bounding box are not respected in time bound calculation
-          for (TimeStepType i = 0; i < timeGeometry->CountTimeSteps(); i++)
-          {
-            // We must not use 'node->GetData()->GetGeometry(i)->GetSpacing()' here, as it returns the spacing
-            // in its original space, which, in case of an image geometry, can have the values in different
-            // order than in world space. For the further calculations, we need to have the spacing values
-            // in world coordinate order (sag-cor-ax).
-            Vector3D spacing;
-            spacing.Fill(1.0);
-            node->GetData()->GetGeometry(i)->IndexToWorld(spacing, spacing);
-            for (int axis = 0; axis < 3; ++ axis)
-            {
-              ScalarType space = std::abs(spacing[axis]);
-              if (space < minSpacing[axis])
-              {
-                minSpacing[axis] = space;
-              }
-            }
-
-            const auto curTimeBounds = timeGeometry->GetTimeBounds(i);
-            if ((curTimeBounds[0] > stmin) && (curTimeBounds[0] < stmax))
-            {
-              existingTimePoints.insert(curTimeBounds[0]);
-            }
-            if ((curTimeBounds[1] > maximalTime) && (curTimeBounds[1] < stmax))
-            {
-               maximalTime = curTimeBounds[1];
-            }
-          }
+          existingTimePoints.insert(curTimeBounds[0]);
         }
-        catch (itk::ExceptionObject &e)
+        if ((curTimeBounds[1] > result->MaximalTime) && (curTimeBounds[1] < stmax))
         {
-          MITK_ERROR << e << std::endl;
+           result->MaximalTime = curTimeBounds[1];
         }
       }
     }
+    catch (itk::ExceptionObject &e)
+    {
+      MITK_ERROR << e << std::endl;
+    }
+    result->TimePoints.assign(existingTimePoints.begin(), existingTimePoints.end());
+  }
+
+  return result;
+}
+
+mitk::TimeGeometry::ConstPointer mitk::DataStorage::ComputeBoundingGeometry3D(const SetOfObjects *input,
+                                                                              const char *boolPropertyKey,
+                                                                              const BaseRenderer *renderer,
+                                                                              const char *boolPropertyKey2) const
+{
+  if (input == nullptr)
+    throw std::invalid_argument("DataStorage: input is invalid");
+
+  std::vector<std::shared_ptr<const NodeBoundingGeometry>> nodeGeometries;
+  std::vector<std::pair<const DataNode *, unsigned long>> revisions;
+  bool allCached = true;
+
+  for (SetOfObjects::ConstIterator it = input->Begin(); it != input->End(); ++it)
+  {
+    DataNode::Pointer node = it->Value();
+    if ((node.IsNotNull()) && (node->GetData() != nullptr) && node->IsOn(boolPropertyKey, renderer) &&
+        node->IsOn(boolPropertyKey2, renderer))
+    {
+      auto nodeGeometry = this->GetNodeBoundingGeometry(node);
+      if (nodeGeometry != nullptr && nodeGeometry->HasBounds)
+      {
+        nodeGeometries.push_back(nodeGeometry);
+        revisions.emplace_back(node.GetPointer(), nodeGeometry->Revision);
+        allCached = allCached && nodeGeometry->Revision != 0;
+      }
+    }
+  }
+
+  // nothing changed since the last call
+  if (allCached)
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BoundingGeometryMutex);
+    if (m_LastBoundingGeometryValid && revisions == m_LastBoundingGeometryNodes)
+    {
+      // a new object, callers like SliceNavigationController only react to a geometry they have not seen before
+      if (m_LastBoundingGeometry.IsNull())
+        return nullptr;
+      return m_LastBoundingGeometry->Clone().GetPointer();
+    }
+  }
+
+  BoundingBox::PointsContainer::Pointer pointscontainer = BoundingBox::PointsContainer::New();
+  BoundingBox::PointIdentifier pointid = 0;
+
+  Vector3D minSpacing;
+  minSpacing.Fill(itk::NumericTraits<ScalarType>::max());
+
+  // sorted, nodes mostly share their time steps
+  std::vector<ScalarType> existingTimePoints;
+  std::vector<ScalarType> mergedTimePoints;
+  ScalarType maximalTime = 0;
+
+  for (const auto &nodeGeometry : nodeGeometries)
+  {
+    for (const auto &point : nodeGeometry->CornerPoints)
+    {
+      pointscontainer->InsertElement(pointid++, point);
+    }
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      minSpacing[axis] = std::min(minSpacing[axis], nodeGeometry->MinSpacing[axis]);
+    }
+    if (nodeGeometry->TimePoints != existingTimePoints)
+    {
+      mergedTimePoints.clear();
+      std::set_union(existingTimePoints.begin(),
+                     existingTimePoints.end(),
+                     nodeGeometry->TimePoints.begin(),
+                     nodeGeometry->TimePoints.end(),
+                     std::back_inserter(mergedTimePoints));
+      existingTimePoints.swap(mergedTimePoints);
+    }
+    maximalTime = std::max(maximalTime, nodeGeometry->MaximalTime);
   }
 
   BoundingBox::Pointer result = BoundingBox::New();
@@ -359,7 +531,7 @@ mitk::TimeGeometry::ConstPointer mitk::DataStorage::ComputeBoundingGeometry3D(co
   // compute the number of time steps
   if (existingTimePoints.empty()) // make sure that there is at least one time sliced geometry in the data storage
   {
-    existingTimePoints.insert(0.0);
+    existingTimePoints.push_back(0.0);
     maximalTime = 1.0;
   }
 
@@ -396,6 +568,14 @@ mitk::TimeGeometry::ConstPointer mitk::DataStorage::ComputeBoundingGeometry3D(co
 
     timeGeometry->Update();
   }
+
+  if (allCached)
+  {
+    itk::MutexLockHolder<itk::SimpleFastMutexLock> locked(m_BoundingGeometryMutex);
+    m_LastBoundingGeometryNodes.swap(revisions);
+    m_LastBoundingGeometry = timeGeometry.GetPointer();
+    m_LastBoundingGeometryValid = true;
+  }
   return timeGeometry.GetPointer();
 }
 
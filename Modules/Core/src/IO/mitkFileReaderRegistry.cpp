@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkCoreServices.h"
 #include "mitkIMimeTypeProvider.h"
+#include "mitkLazyFileIORegistration.h"
 
 // Microservices
 #include <usGetModuleContext.h>
@@ -65,9 +66,17 @@ std::vector<mitk::FileReaderRegistry::ReaderReference> mitk::FileReaderRegistry:
   if (context == nullptr)
     context = us::GetModuleContext();
 
+  LazyFileIORegistration::LoadForMimeType(mimeType.GetName());
+
   std::string filter = us::LDAPProp(us::ServiceConstants::OBJECTCLASS()) == us_service_interface_iid<IFileReader>() &&
                        us::LDAPProp(IFileReader::PROP_MIMETYPE()) == mimeType.GetName();
-  return context->GetServiceReferences<IFileReader>(filter);
+  std::vector<ReaderReference> result = context->GetServiceReferences<IFileReader>(filter);
+  if (result.empty() && LazyFileIORegistration::LoadAll())
+  {
+    // the file IO declarations are incomplete, retry with all readers
+    return GetReferences(mimeType, context);
+  }
+  return result;
 }
 
 mitk::IFileReader *mitk::FileReaderRegistry::GetReader(const mitk::FileReaderRegistry::ReaderReference &ref,
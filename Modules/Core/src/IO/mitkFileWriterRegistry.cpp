@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseData.h"
 #include "mitkCoreServices.h"
 #include "mitkIMimeTypeProvider.h"
+#include "mitkLazyFileIORegistration.h"
 
 // Microservices
 #include <usGetModuleContext.h>
@@ -63,6 +64,11 @@ std::vector<mitk::FileWriterRegistry::WriterReference> mitk::FileWriterRegistry:
   // loop over the class hierarchy of baseData and get all writers
   // claiming to support the actual baseData class or any of its super classes
   std::vector<std::string> classHierarchy = baseData->GetClassHierarchy();
+  for (const auto &className : classHierarchy)
+  {
+    LazyFileIORegistration::LoadForDataType(className);
+  }
+
   for (std::vector<std::string>::const_iterator clIter = classHierarchy.begin(), clIterEnd = classHierarchy.end();
        clIter != clIterEnd;
        ++clIter)
@@ -74,6 +80,12 @@ std::vector<mitk::FileWriterRegistry::WriterReference> mitk::FileWriterRegistry:
     std::vector<WriterReference> refs = context->GetServiceReferences<IFileWriter>(filter);
     result.insert(result.end(), refs.begin(), refs.end());
   }
+
+  if (result.empty() && LazyFileIORegistration::LoadAll())
+  {
+    // the file IO declarations are incomplete, retry with all writers
+    return GetReferences(baseData, mimeType, context);
+  }
   return result;
 }
 
@@ -0,0 +1,208 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkLazyFileIORegistration.h"
+
+#include "mitkExceptionMacro.h"
+#include "mitkLogMacros.h"
+
+#include <usAny.h>
+#include <usModule.h>
+#include <usModuleContext.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+  typedef std::map<std::string, us::Any> AnyMap;
+  typedef std::vector<us::Any> AnyVector;
+
+  struct PendingRegistrations
+  {
+    // recursive, load functions register services and these may look up mime types
+    std::recursive_mutex Mutex;
+    std::vector<mitk::LazyFileIORegistration *> Registrations;
+  };
+
+  PendingRegistrations &GetPendingRegistrations()
+  {
+    // never deleted, activators withdraw their registrations while static objects are destroyed
+    static auto *pending = new PendingRegistrations;
+    return *pending;
+  }
+
+  std::vector<std::string> GetStrings(const AnyMap &declaration, const std::string &key)
+  {
+    std::vector<std::string> result;
+    auto iter = declaration.find(key);
+    if (iter != declaration.end())
+    {
+      for (const auto &value : us::any_cast<AnyVector>(iter->second))
+      {
+        result.push_back(us::any_cast<std::string>(value));
+      }
+    }
+    return result;
+  }
+}
+
+mitk::LazyFileIORegistration::LazyFileIORegistration(us::ModuleContext *context,
+                                                     const std::string &name,
+                                                     const LoadFunctionType &load)
+  : m_Name(name), m_Load(load), m_Loaded(false)
+{
+  if (context == nullptr)
+  {
+    mitkThrow() << "LazyFileIORegistration " << name << " was created without module context.";
+  }
+
+  // an undeclared registration is still loaded by the lookups which find nothing
+  us::Module *module = context->GetModule();
+  try
+  {
+    us::Any io = module->GetProperty("mitk.io");
+    if (io.Empty())
+    {
+      MITK_WARN << "Module " << module->GetName() << " does not declare its file IO in manifest.json";
+    }
+    else
+    {
+      const auto &declarations = us::ref_any_cast<AnyMap>(io);
+      auto declaration = declarations.find(name);
+      if (declaration == declarations.end())
+      {
+        MITK_WARN << "Module " << module->GetName() << " does not declare the file IO " << name;
+      }
+      else
+      {
+        const auto &properties = us::ref_any_cast<AnyMap>(declaration->second);
+        for (const auto &extension : GetStrings(properties, "extensions"))
+        {
+          m_Extensions.AddExtension(extension);
+        }
+        for (const auto &mimeTypeName : GetStrings(properties, "mimetypes"))
+        {
+          m_MimeTypeNames.insert(mimeTypeName);
+        }
+        for (const auto &dataType : GetStrings(properties, "datatypes"))
+        {
+          m_DataTypes.insert(dataType);
+        }
+      }
+    }
+  }
+  catch (const us::BadAnyCastException &e)
+  {
+    MITK_WARN << "Invalid file IO declaration " << name << " in the manifest of module " << module->GetName() << ": "
+              << e.what();
+  }
+
+  PendingRegistrations &pending = GetPendingRegistrations();
+  std::lock_guard<std::recursive_mutex> lock(pending.Mutex);
+  pending.Registrations.push_back(this);
+}
+
+mitk::LazyFileIORegistration::~LazyFileIORegistration()
+{
+  PendingRegistrations &pending = GetPendingRegistrations();
+  std::lock_guard<std::recursive_mutex> lock(pending.Mutex);
+  pending.Registrations.erase(std::remove(pending.Registrations.begin(), pending.Registrations.end(), this),
+                              pending.Registrations.end());
+}
+
+std::string mitk::LazyFileIORegistration::GetName() const
+{
+  return m_Name;
+}
+
+bool mitk::LazyFileIORegistration::IsLoaded() const
+{
+  std::lock_guard<std::recursive_mutex> lock(GetPendingRegistrations().Mutex);
+  return m_Loaded;
+}
+
+void mitk::LazyFileIORegistration::Load()
+{
+  PendingRegistrations &pending = GetPendingRegistrations();
+
+  // keep the lock while loading, concurrent lookups have to wait for the services
+  std::lock_guard<std::recursive_mutex> lock(pending.Mutex);
+  if (m_Loaded)
+    return;
+
+  // mark as loaded first, lookups done by the load function must not run it again
+  m_Loaded = true;
+  pending.Registrations.erase(std::remove(pending.Registrations.begin(), pending.Registrations.end(), this),
+                              pending.Registrations.end());
+
+  MITK_DEBUG << "Loading file IO " << m_Name;
+  m_Load();
+}
+
+bool mitk::LazyFileIORegistration::LoadForFile(const std::string &path)
+{
+  return LoadMatching([&path](const LazyFileIORegistration *registration) {
+    return registration->m_Extensions.MatchesExtension(path);
+  });
+}
+
+bool mitk::LazyFileIORegistration::LoadForMimeType(const std::string &mimeTypeName)
+{
+  return LoadMatching([&mimeTypeName](const LazyFileIORegistration *registration) {
+    return registration->m_MimeTypeNames.count(mimeTypeName) != 0;
+  });
+}
+
+bool mitk::LazyFileIORegistration::LoadForDataType(const std::string &dataType)
+{
+  return LoadMatching([&dataType](const LazyFileIORegistration *registration) {
+    return registration->m_DataTypes.count(dataType) != 0;
+  });
+}
+
+bool mitk::LazyFileIORegistration::LoadAll()
+{
+  return LoadMatching([](const LazyFileIORegistration *) { return true; });
+}
+
+std::size_t mitk::LazyFileIORegistration::GetNumberOfPendingRegistrations()
+{
+  PendingRegistrations &pending = GetPendingRegistrations();
+  std::lock_guard<std::recursive_mutex> lock(pending.Mutex);
+  return pending.Registrations.size();
+}
+
+bool mitk::LazyFileIORegistration::LoadMatching(const std::function<bool(const LazyFileIORegistration *)> &predicate)
+{
+  PendingRegistrations &pending = GetPendingRegistrations();
+  std::lock_guard<std::recursive_mutex> lock(pending.Mutex);
+  if (pending.Registrations.empty())
+    return false;
+
+  // loading changes the pending list
+  std::vector<LazyFileIORegistration *> matching;
+  std::copy_if(pending.Registrations.begin(), pending.Registrations.end(), std::back_inserter(matching), predicate);
+
+  for (auto registration : matching)
+  {
+    registration->Load();
+  }
+  return !matching.empty();
+}
@@ -16,6 +16,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkMimeTypeProvider.h"
 
+#include "mitkLazyFileIORegistration.h"
 #include "mitkLogMacros.h"
 
 #include <usGetModuleContext.h>
@@ -44,6 +45,8 @@ namespace mitk
   void MimeTypeProvider::Stop() { m_Tracker->Close(); }
   std::vector<MimeType> MimeTypeProvider::GetMimeTypes() const
   {
+    LazyFileIORegistration::LoadAll();
+
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -54,6 +57,8 @@ namespace mitk
 
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForFile(const std::string &filePath) const
   {
+    LazyFileIORegistration::LoadForFile(filePath);
+
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -62,6 +67,11 @@ namespace mitk
         result.push_back(elem.second);
       }
     }
+    if (result.empty() && LazyFileIORegistration::LoadAll())
+    {
+      // the file IO declarations are incomplete, retry with all mime types
+      return this->GetMimeTypesForFile(filePath);
+    }
     std::sort(result.begin(), result.end());
     std::reverse(result.begin(), result.end());
     return result;
@@ -69,6 +79,8 @@ namespace mitk
 
   std::vector<MimeType> MimeTypeProvider::GetMimeTypesForCategory(const std::string &category) const
   {
+    LazyFileIORegistration::LoadAll();
+
     std::vector<MimeType> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -82,14 +94,20 @@ namespace mitk
 
   MimeType MimeTypeProvider::GetMimeTypeForName(const std::string &name) const
   {
+    LazyFileIORegistration::LoadForMimeType(name);
+
     auto iter = m_NameToMimeType.find(name);
     if (iter != m_NameToMimeType.end())
       return iter->second;
+    if (LazyFileIORegistration::LoadAll())
+      return this->GetMimeTypeForName(name);
     return MimeType();
   }
 
   std::vector<std::string> MimeTypeProvider::GetCategories() const
   {
+    LazyFileIORegistration::LoadAll();
+
     std::vector<std::string> result;
     for (const auto &elem : m_NameToMimeType)
     {
@@ -87,6 +87,11 @@ mitk::ProcessEventMode mitk::DataInteractor::GetMode() const
   return REGULAR;
 }
 
+mitk::ScalarType mitk::DataInteractor::GetInteractionDistance() const
+{
+  return -1.0;
+}
+
 void mitk::DataInteractor::NotifyStart()
 {
   this->GetDataNode()->InvokeEvent(StartInteraction());
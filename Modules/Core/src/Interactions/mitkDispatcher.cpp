@@ -15,23 +15,58 @@
  ===================================================================*/
 
 #include "mitkDispatcher.h"
+#include "mitkBaseRenderer.h"
 #include "mitkInteractionEvent.h"
 #include "mitkInteractionEventObserver.h"
+#include "mitkInteractionPositionEvent.h"
 #include "mitkInternalEvent.h"
 #include "usGetModuleContext.h"
 
-namespace
+#include <algorithm>
+
+struct mitk::Dispatcher::InteractorEntry
 {
-  struct cmp
+  InteractorEntry()
+    : Layer(-1),
+      PropertiesTag(0),
+      LayerPropertyTag(0),
+      BoundsData(nullptr),
+      BoundsDataMTime(0),
+      BoundsGeometry(nullptr),
+      BoundsGeometryMTime(0),
+      BoundsTimeStep(-1)
   {
-    bool operator()(mitk::WeakPointer<mitk::DataInteractor> d1, mitk::WeakPointer<mitk::DataInteractor> d2)
-    {
-      return (d1.Lock()->GetLayer() > d2.Lock()->GetLayer());
-    }
-  };
-}
+  }
 
-mitk::Dispatcher::Dispatcher(const std::string &rendererName) : m_ProcessingMode(REGULAR)
+  ~InteractorEntry()
+  {
+    if (auto propertyList = Properties.Lock())
+      propertyList->RemoveObserver(PropertiesTag);
+
+    if (auto layerProperty = LayerProperty.Lock())
+      layerProperty->RemoveObserver(LayerPropertyTag);
+  }
+
+  WeakPointer<DataInteractor> Interactor;
+  int Layer;
+
+  // the property list notifies about added and replaced layer properties, the layer property about new values
+  WeakPointer<PropertyList> Properties;
+  unsigned long PropertiesTag;
+  WeakPointer<BaseProperty> LayerProperty;
+  unsigned long LayerPropertyTag;
+
+  // world bounds of the data, valid as long as data, geometry and time step do not change
+  const BaseData *BoundsData;
+  unsigned long BoundsDataMTime;
+  const BaseGeometry *BoundsGeometry;
+  unsigned long BoundsGeometryMTime;
+  int BoundsTimeStep;
+  BoundingBox::BoundsArrayType Bounds;
+};
+
+mitk::Dispatcher::Dispatcher(const std::string &rendererName)
+  : m_InteractorOrderModified(false), m_ProcessingMode(REGULAR), m_EventObserverTrackingCount(-1)
 {
   // LDAP filter string to find all listeners specific for the renderer
   // corresponding to this dispatcher
@@ -62,7 +97,24 @@ void mitk::Dispatcher::AddDataInteractor(const DataNode *dataNode)
   auto dataInteractor = dataNode->GetDataInteractor().GetPointer();
 
   if (dataInteractor != nullptr)
-    m_Interactors.push_back(dataInteractor);
+  {
+    // the position is searched among the current layers
+    this->UpdateInteractorOrder();
+
+    auto entry = std::make_shared<InteractorEntry>();
+    entry->Interactor = dataInteractor;
+    entry->Layer = dataInteractor->GetLayer();
+    this->ObserveLayer(*entry, dataNode);
+
+    // behind all interactors with the same layer, like sorting a list after appending
+    auto position = std::upper_bound(m_Interactors.begin(),
+                                     m_Interactors.end(),
+                                     entry->Layer,
+                                     [](int layer, const std::shared_ptr<InteractorEntry> &other) {
+                                       return layer > other->Layer;
+                                     });
+    m_Interactors.insert(position, entry);
+  }
 }
 
 /*
@@ -77,7 +129,9 @@ void mitk::Dispatcher::RemoveDataInteractor(const DataNode *dataNode)
 {
   for (auto it = m_Interactors.begin(); it != m_Interactors.end();)
   {
-    if ((*it).IsExpired() || (*it).Lock()->GetDataNode() == nullptr || (*it).Lock()->GetDataNode() == dataNode)
+    const auto &interactor = (*it)->Interactor;
+    if (interactor.IsExpired() || interactor.Lock()->GetDataNode() == nullptr ||
+        interactor.Lock()->GetDataNode() == dataNode)
     {
       it = m_Interactors.erase(it);
     }
@@ -101,6 +155,136 @@ mitk::Dispatcher::~Dispatcher()
   m_Interactors.clear();
 }
 
+void mitk::Dispatcher::OnLayerModified()
+{
+  m_InteractorOrderModified = true;
+}
+
+void mitk::Dispatcher::ObserveLayer(InteractorEntry &entry, const DataNode *dataNode)
+{
+  PropertyList *propertyList = dataNode != nullptr ? dataNode->GetPropertyList() : nullptr;
+  if (entry.Properties.Lock() != propertyList)
+  {
+    if (auto oldPropertyList = entry.Properties.Lock())
+      oldPropertyList->RemoveObserver(entry.PropertiesTag);
+
+    entry.Properties = propertyList;
+    if (propertyList != nullptr)
+    {
+      auto command = itk::SimpleMemberCommand<Dispatcher>::New();
+      command->SetCallbackFunction(this, &Dispatcher::OnLayerModified);
+      entry.PropertiesTag = propertyList->AddObserver(itk::ModifiedEvent(), command);
+    }
+  }
+
+  BaseProperty *layerProperty = propertyList != nullptr ? propertyList->GetProperty("layer") : nullptr;
+  if (entry.LayerProperty.Lock() != layerProperty)
+  {
+    if (auto oldLayerProperty = entry.LayerProperty.Lock())
+      oldLayerProperty->RemoveObserver(entry.LayerPropertyTag);
+
+    entry.LayerProperty = layerProperty;
+    if (layerProperty != nullptr)
+    {
+      auto command = itk::SimpleMemberCommand<Dispatcher>::New();
+      command->SetCallbackFunction(this, &Dispatcher::OnLayerModified);
+      entry.LayerPropertyTag = layerProperty->AddObserver(itk::ModifiedEvent(), command);
+    }
+  }
+}
+
+void mitk::Dispatcher::UpdateInteractorOrder()
+{
+  if (!m_InteractorOrderModified)
+    return;
+
+  m_InteractorOrderModified = false;
+
+  bool isSorted = true;
+  for (auto it = m_Interactors.begin(); it != m_Interactors.end(); ++it)
+  {
+    auto interactor = (*it)->Interactor.Lock();
+    if (interactor.IsNotNull())
+    {
+      this->ObserveLayer(**it, interactor->GetDataNode());
+      (*it)->Layer = interactor->GetLayer();
+    }
+
+    if (it != m_Interactors.begin() && (*(it - 1))->Layer < (*it)->Layer)
+      isSorted = false;
+  }
+
+  // stable, so interactors with the same layer keep their order
+  if (!isSorted)
+  {
+    std::stable_sort(m_Interactors.begin(),
+                     m_Interactors.end(),
+                     [](const std::shared_ptr<InteractorEntry> &a, const std::shared_ptr<InteractorEntry> &b) {
+                       return a->Layer > b->Layer;
+                     });
+  }
+}
+
+bool mitk::Dispatcher::IsInInteractionRange(InteractorEntry &entry,
+                                            const BaseRenderer *renderer,
+                                            const Point3D &position) const
+{
+  auto interactor = entry.Interactor.Lock();
+  if (interactor.IsNull())
+    return true;
+
+  const ScalarType distance = interactor->GetInteractionDistance();
+  if (distance < 0)
+    return true;
+
+  const DataNode *dataNode = interactor->GetDataNode();
+  BaseData *data = dataNode != nullptr ? dataNode->GetData() : nullptr;
+  if (data == nullptr)
+    return true;
+
+  const int timeStep = renderer->GetTimeStep(data);
+  const BaseGeometry *geometry = data->GetGeometry(timeStep);
+
+  if (data != entry.BoundsData || data->GetMTime() != entry.BoundsDataMTime || timeStep != entry.BoundsTimeStep ||
+      geometry != entry.BoundsGeometry || (geometry != nullptr && geometry->GetMTime() != entry.BoundsGeometryMTime))
+  {
+    geometry = data->GetUpdatedGeometry(timeStep);
+    if (geometry == nullptr)
+      return true;
+
+    entry.Bounds = geometry->CalculateBoundingBoxRelativeToTransform(nullptr)->GetBounds();
+    entry.BoundsData = data;
+    entry.BoundsDataMTime = data->GetMTime();
+    entry.BoundsGeometry = geometry;
+    entry.BoundsGeometryMTime = geometry->GetMTime();
+    entry.BoundsTimeStep = timeStep;
+  }
+
+  for (int i = 0; i < 3; ++i)
+  {
+    if (position[i] < entry.Bounds[2 * i] - distance || position[i] > entry.Bounds[2 * i + 1] + distance)
+      return false;
+  }
+  return true;
+}
+
+void mitk::Dispatcher::UpdateEventObservers()
+{
+  const int trackingCount = m_EventObserverTracker->GetTrackingCount();
+  if (trackingCount == m_EventObserverTrackingCount)
+    return;
+
+  m_EventObserverTrackingCount = trackingCount;
+  m_EventObservers.clear();
+
+  const std::vector<us::ServiceReference<InteractionEventObserver>> references =
+    m_EventObserverTracker->GetServiceReferences();
+  for (auto it = references.cbegin(); it != references.cend(); ++it)
+  {
+    m_EventObservers.push_back(std::make_pair(*it, m_EventObserverTracker->GetService(*it)));
+  }
+}
+
 bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
 {
   InteractionEvent::Pointer p = event;
@@ -163,26 +347,40 @@ bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
   {
     if (std::strcmp(p->GetNameOfClass(), "MousePressEvent") == 0)
       event->GetSender()->GetRenderingManager()->SetRenderWindowFocus(event->GetSender()->GetRenderWindow());
-    m_Interactors.sort(cmp()); // sorts interactors by layer (descending);
 
-    // copy the list to prevent iterator invalidation as executing actions
+    this->UpdateInteractorOrder();
+
+    // only interactors that can handle the position of the event
+    const auto *positionEvent = dynamic_cast<const InteractionPositionEvent *>(event);
+    const bool checkRange = positionEvent != nullptr && event->GetSender() != nullptr &&
+                            event->GetSender()->GetMapperID() == BaseRenderer::Standard2D;
+    const Point3D position = checkRange ? positionEvent->GetPositionInWorld() : Point3D();
+
+    // copy the candidates to prevent iterator invalidation as executing actions
     // in HandleEvent() can cause the m_Interactors list to be updated
-    const ListInteractorType tmpInteractorList(m_Interactors);
-    ListInteractorType::const_iterator it;
-    for (it = tmpInteractorList.cbegin(); it != tmpInteractorList.cend(); ++it)
+    InteractorEntryVectorType candidates;
+    candidates.reserve(m_Interactors.size());
+    for (auto it = m_Interactors.cbegin(); it != m_Interactors.cend(); ++it)
+    {
+      if (!checkRange || this->IsInInteractionRange(**it, event->GetSender(), position))
+        candidates.push_back(*it);
+    }
+
+    for (auto it = candidates.cbegin(); it != candidates.cend(); ++it)
     {
-      if (!(*it).IsExpired() && (*it).Lock()->HandleEvent(event, (*it).Lock()->GetDataNode()))
+      const WeakPointer<DataInteractor> &interactor = (*it)->Interactor;
+      if (!interactor.IsExpired() && interactor.Lock()->HandleEvent(event, interactor.Lock()->GetDataNode()))
       {
         // Interactor can be deleted during HandleEvent(), so check it again
-        if (!(*it).IsExpired())
+        if (!interactor.IsExpired())
         {
           // if an event is handled several properties are checked, in order to determine the processing mode of the
           // dispatcher
-          SetEventProcessingMode((*it).Lock());
+          SetEventProcessingMode(interactor.Lock());
         }
         if (std::strcmp(p->GetNameOfClass(), "MousePressEvent") == 0 && m_ProcessingMode == REGULAR)
         {
-          m_SelectedInteractor = *it;
+          m_SelectedInteractor = interactor;
           m_ProcessingMode = CONNECTEDMOUSEACTION;
         }
         eventIsHandled = true;
@@ -192,13 +390,19 @@ bool mitk::Dispatcher::ProcessEvent(InteractionEvent *event)
   }
 
   /* Notify InteractionEventObserver  */
-  const std::vector<us::ServiceReference<InteractionEventObserver>> listEventObserver =
-    m_EventObserverTracker->GetServiceReferences();
-  for (auto it = listEventObserver.cbegin();
-       it != listEventObserver.cend();
-       ++it)
+  this->UpdateEventObservers();
+
+  // copy the list, observers can be registered or unregistered in Notify()
+  const EventObserverVectorType eventObservers(m_EventObservers);
+  const int trackingCount = m_EventObserverTrackingCount;
+  for (auto it = eventObservers.cbegin(); it != eventObservers.cend(); ++it)
   {
-    InteractionEventObserver *interactionEventObserver = m_EventObserverTracker->GetService(*it);
+    InteractionEventObserver *interactionEventObserver = it->second;
+
+    // look the observer up again if the tracked services have changed meanwhile
+    if (m_EventObserverTracker->GetTrackingCount() != trackingCount)
+      interactionEventObserver = m_EventObserverTracker->GetService(it->first);
+
     if (interactionEventObserver != nullptr)
     {
       if (interactionEventObserver->IsEnabled())
@@ -226,13 +430,13 @@ void mitk::Dispatcher::RemoveOrphanedInteractors()
 {
   for (auto it = m_Interactors.begin(); it != m_Interactors.end();)
   {
-    if ((*it).IsExpired())
+    if ((*it)->Interactor.IsExpired())
     {
       it = m_Interactors.erase(it);
     }
     else
     {
-      DataNode::Pointer node = (*it).Lock()->GetDataNode();
+      DataNode::Pointer node = (*it)->Interactor.Lock()->GetDataNode();
 
       if (node.IsNull())
       {
@@ -242,7 +446,7 @@ void mitk::Dispatcher::RemoveOrphanedInteractors()
       {
         DataInteractor::Pointer interactor = node->GetDataInteractor();
 
-        if (interactor != it->Lock().GetPointer())
+        if (interactor != (*it)->Interactor.Lock().GetPointer())
         {
           it = m_Interactors.erase(it);
         }
@@ -35,7 +35,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK Rendering
 #include "mitkImageVtkMapper2D.h"
 #include "vtkMitkLevelWindowFilter.h"
-#include "vtkMitkThickSlicesFilter.h"
 #include "vtkNeverTranslucentTexture.h"
 
 // VTK
@@ -252,27 +251,23 @@ void mitk::ImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rendere
 
     dataZSpacing = 1.0 / normInIndex.GetNorm();
 
-    localStorage->m_Reslicer->SetOutputDimensionality(3);
+    // the planes of the slab are projected while they are resliced, see ExtractThickSliceFilter
     localStorage->m_Reslicer->SetOutputSpacingZDirection(dataZSpacing);
-    localStorage->m_Reslicer->SetOutputExtentZDirection(-thickSlicesNum, 0 + thickSlicesNum);
+    localStorage->m_Reslicer->SetThickSliceMode(thickSlicesMode - 1);
+    localStorage->m_Reslicer->SetThickSliceNumber(thickSlicesNum);
 
     // Do the reslicing. Modified() is called to make sure that the reslicer is
     // executed even though the input geometry information did not change; this
     // is necessary when the input /em data, but not the /em geometry changes.
-    localStorage->m_TSFilter->SetThickSliceMode(thickSlicesMode - 1);
-    localStorage->m_TSFilter->SetInputData(localStorage->m_Reslicer->GetVtkOutput());
-
-    // vtkFilter=>mitkFilter=>vtkFilter update mechanism will fail without calling manually
+    // The reslicer only extracts the planes that changed if the slab was just scrolled.
     localStorage->m_Reslicer->Modified();
     localStorage->m_Reslicer->Update();
-
-    localStorage->m_TSFilter->Modified();
-    localStorage->m_TSFilter->Update();
-    localStorage->m_ReslicedImage = localStorage->m_TSFilter->GetOutput();
+    localStorage->m_ReslicedImage = localStorage->m_Reslicer->GetVtkOutput();
   }
   else
   {
     // this is needed when thick mode was enable bevore. These variable have to be reset to default values
+    localStorage->m_Reslicer->SetThickSliceNumber(0);
     localStorage->m_Reslicer->SetOutputDimensionality(2);
     localStorage->m_Reslicer->SetOutputSpacingZDirection(1.0);
     localStorage->m_Reslicer->SetOutputExtentZDirection(0, 0);
@@ -1089,16 +1084,11 @@ mitk::ImageVtkMapper2D::LocalStorage::LocalStorage()
   m_Mapper = vtkSmartPointer<vtkPolyDataMapper>::New();
   m_Actor = vtkSmartPointer<vtkActor>::New();
   m_Actors = vtkSmartPointer<vtkPropAssembly>::New();
-  m_Reslicer = mitk::ExtractSliceFilter::New();
-  m_TSFilter = vtkSmartPointer<vtkMitkThickSlicesFilter>::New();
+  m_Reslicer = mitk::ExtractThickSliceFilter::New();
   m_OutlinePolyData = vtkSmartPointer<vtkPolyData>::New();
   m_ReslicedImage = vtkSmartPointer<vtkImageData>::New();
   m_EmptyPolyData = vtkSmartPointer<vtkPolyData>::New();
 
-  // the following actions are always the same and thus can be performed
-  // in the constructor for each image (i.e. the image-corresponding local storage)
-  m_TSFilter->ReleaseDataFlagOn();
-
   mitk::LookupTable::Pointer mitkLUT = mitk::LookupTable::New();
   // built a default lookuptable
   mitkLUT->SetType(mitk::LookupTable::GRAYSCALE);
@@ -0,0 +1,322 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPolyDataPlaneCutter.h"
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace
+{
+  // triangles per leaf of the hierarchy
+  const vtkIdType LeafSize = 8;
+}
+
+struct mitk::PolyDataPlaneCutter::BuildItem
+{
+  Triangle Tri;
+  double Center[3];
+  double Bounds[6];
+};
+
+mitk::PolyDataPlaneCutter::PolyDataPlaneCutter() : m_InputMTime(0), m_CanCut(false), m_NumberOfTestedTriangles(0)
+{
+}
+
+mitk::PolyDataPlaneCutter::~PolyDataPlaneCutter()
+{
+}
+
+void mitk::PolyDataPlaneCutter::SetInput(vtkPolyData *input)
+{
+  if (input == m_Input && (input == nullptr || input->GetMTime() == m_InputMTime))
+    return;
+
+  m_Input = input;
+  m_InputMTime = input != nullptr ? input->GetMTime() : 0;
+  this->Build();
+}
+
+vtkPolyData *mitk::PolyDataPlaneCutter::GetInput() const
+{
+  return m_Input;
+}
+
+vtkMTimeType mitk::PolyDataPlaneCutter::GetInputMTime() const
+{
+  return m_InputMTime;
+}
+
+bool mitk::PolyDataPlaneCutter::CanCut() const
+{
+  return m_CanCut;
+}
+
+vtkIdType mitk::PolyDataPlaneCutter::GetNumberOfTestedTriangles() const
+{
+  return m_NumberOfTestedTriangles;
+}
+
+void mitk::PolyDataPlaneCutter::Build()
+{
+  m_Triangles.clear();
+  m_Nodes.clear();
+
+  m_CanCut = m_Input != nullptr && m_Input->GetNumberOfVerts() == 0 && m_Input->GetNumberOfLines() == 0;
+  if (!m_CanCut || m_Input->GetPoints() == nullptr)
+    return;
+
+  std::vector<BuildItem> items;
+  items.reserve(m_Input->GetNumberOfPolys() + m_Input->GetNumberOfStrips());
+
+  vtkPoints *points = m_Input->GetPoints();
+  auto addTriangle = [&items, points](vtkIdType a, vtkIdType b, vtkIdType c, vtkIdType cell) {
+    BuildItem item;
+    item.Tri.Points[0] = a;
+    item.Tri.Points[1] = b;
+    item.Tri.Points[2] = c;
+    item.Tri.Cell = cell;
+    for (int i = 0; i < 3; ++i)
+    {
+      item.Bounds[2 * i] = VTK_DOUBLE_MAX;
+      item.Bounds[2 * i + 1] = VTK_DOUBLE_MIN;
+    }
+    for (int k = 0; k < 3; ++k)
+    {
+      double p[3];
+      points->GetPoint(item.Tri.Points[k], p);
+      for (int i = 0; i < 3; ++i)
+      {
+        item.Bounds[2 * i] = std::min(item.Bounds[2 * i], p[i]);
+        item.Bounds[2 * i + 1] = std::max(item.Bounds[2 * i + 1], p[i]);
+      }
+    }
+    for (int i = 0; i < 3; ++i)
+      item.Center[i] = 0.5 * (item.Bounds[2 * i] + item.Bounds[2 * i + 1]);
+    items.push_back(item);
+  };
+
+  // without vertices and lines the polygons are the first cells, followed by the strips
+  vtkIdType cellId = 0;
+  vtkIdType numberOfPoints;
+  vtkIdType *ids(nullptr);
+
+  vtkCellArray *polys = m_Input->GetPolys();
+  for (polys->InitTraversal(); polys->GetNextCell(numberOfPoints, ids); ++cellId)
+  {
+    // fan triangulation, the cut of a convex polygon is the same as the one of vtkCutter
+    for (vtkIdType i = 1; i + 1 < numberOfPoints; ++i)
+      addTriangle(ids[0], ids[i], ids[i + 1], cellId);
+  }
+
+  vtkCellArray *strips = m_Input->GetStrips();
+  for (strips->InitTraversal(); strips->GetNextCell(numberOfPoints, ids); ++cellId)
+  {
+    for (vtkIdType i = 0; i + 2 < numberOfPoints; ++i)
+      addTriangle(ids[i], ids[i + 1], ids[i + 2], cellId);
+  }
+
+  if (items.empty())
+    return;
+
+  m_Nodes.reserve(2 * (items.size() / LeafSize + 1));
+  this->BuildNode(items, 0, static_cast<vtkIdType>(items.size()));
+
+  m_Triangles.resize(items.size());
+  for (std::size_t i = 0; i < items.size(); ++i)
+    m_Triangles[i] = items[i].Tri;
+}
+
+vtkIdType mitk::PolyDataPlaneCutter::BuildNode(std::vector<BuildItem> &items, vtkIdType begin, vtkIdType end)
+{
+  const vtkIdType index = static_cast<vtkIdType>(m_Nodes.size());
+  m_Nodes.push_back(Node());
+
+  double bounds[6];
+  double centerBounds[6];
+  for (int i = 0; i < 3; ++i)
+  {
+    bounds[2 * i] = centerBounds[2 * i] = VTK_DOUBLE_MAX;
+    bounds[2 * i + 1] = centerBounds[2 * i + 1] = VTK_DOUBLE_MIN;
+  }
+  for (vtkIdType t = begin; t < end; ++t)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      bounds[2 * i] = std::min(bounds[2 * i], items[t].Bounds[2 * i]);
+      bounds[2 * i + 1] = std::max(bounds[2 * i + 1], items[t].Bounds[2 * i + 1]);
+      centerBounds[2 * i] = std::min(centerBounds[2 * i], items[t].Center[i]);
+      centerBounds[2 * i + 1] = std::max(centerBounds[2 * i + 1], items[t].Center[i]);
+    }
+  }
+  std::copy(bounds, bounds + 6, m_Nodes[index].Bounds);
+
+  if (end - begin <= LeafSize)
+  {
+    m_Nodes[index].First = begin;
+    m_Nodes[index].Count = end - begin;
+    return index;
+  }
+
+  // median split along the axis in which the triangle centers spread most
+  int axis = 0;
+  for (int i = 1; i < 3; ++i)
+  {
+    if (centerBounds[2 * i + 1] - centerBounds[2 * i] > centerBounds[2 * axis + 1] - centerBounds[2 * axis])
+      axis = i;
+  }
+  const vtkIdType middle = begin + (end - begin) / 2;
+  std::nth_element(items.begin() + begin,
+                   items.begin() + middle,
+                   items.begin() + end,
+                   [axis](const BuildItem &a, const BuildItem &b) { return a.Center[axis] < b.Center[axis]; });
+
+  this->BuildNode(items, begin, middle); // is node index + 1
+  const vtkIdType right = this->BuildNode(items, middle, end);
+  m_Nodes[index].First = right;
+  m_Nodes[index].Count = 0;
+  return index;
+}
+
+void mitk::PolyDataPlaneCutter::Cut(const double normal[3], double offset, vtkPolyData *output) const
+{
+  m_NumberOfTestedTriangles = 0;
+
+  auto points = vtkSmartPointer<vtkPoints>::New();
+  auto lines = vtkSmartPointer<vtkCellArray>::New();
+  output->Initialize();
+
+  if (m_Input == nullptr || !m_CanCut)
+  {
+    output->SetPoints(points);
+    output->SetLines(lines);
+    return;
+  }
+
+  vtkPoints *inPoints = m_Input->GetPoints();
+  if (inPoints != nullptr)
+    points->SetDataType(inPoints->GetDataType());
+
+  vtkPointData *inPD = m_Input->GetPointData();
+  vtkCellData *inCD = m_Input->GetCellData();
+  vtkPointData *outPD = output->GetPointData();
+  vtkCellData *outCD = output->GetCellData();
+  outPD->InterpolateAllocate(inPD);
+  outCD->CopyAllocate(inCD);
+
+  // points of the contour by the cut edge (lower point id * number of points + higher point id),
+  // or by the vertex (id * number of points + id) if the plane passes through a vertex
+  const vtkIdType numberOfInputPoints = m_Input->GetNumberOfPoints();
+  std::unordered_map<vtkIdType, vtkIdType> contourPoints;
+
+  auto getContourPoint = [&](vtkIdType a, vtkIdType b, double sa, double sb, const double *pa, const double *pb) {
+    if (a > b)
+    {
+      std::swap(a, b);
+      std::swap(sa, sb);
+      std::swap(pa, pb);
+    }
+    const double t = sa / (sa - sb);
+    const vtkIdType key = t == 0.0 ? a * numberOfInputPoints + a
+                                   : (t == 1.0 ? b * numberOfInputPoints + b : a * numberOfInputPoints + b);
+    auto found = contourPoints.find(key);
+    if (found != contourPoints.end())
+      return found->second;
+
+    double x[3];
+    for (int i = 0; i < 3; ++i)
+      x[i] = pa[i] + t * (pb[i] - pa[i]);
+    const vtkIdType id = points->InsertNextPoint(x);
+    outPD->InterpolateEdge(inPD, id, a, b, t);
+    contourPoints.insert(std::make_pair(key, id));
+    return id;
+  };
+
+  const double absoluteNormal[3] = {std::fabs(normal[0]), std::fabs(normal[1]), std::fabs(normal[2])};
+  static const int edges[3][2] = {{0, 1}, {1, 2}, {2, 0}};
+
+  std::vector<vtkIdType> stack;
+  if (!m_Nodes.empty())
+    stack.push_back(0);
+
+  while (!stack.empty())
+  {
+    const vtkIdType index = stack.back();
+    stack.pop_back();
+    const Node &node = m_Nodes[index];
+
+    // the box is cut if the distance of its center to the plane is not larger than its extent along the normal
+    double distance = -offset;
+    double radius = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      distance += normal[i] * 0.5 * (node.Bounds[2 * i] + node.Bounds[2 * i + 1]);
+      radius += absoluteNormal[i] * 0.5 * (node.Bounds[2 * i + 1] - node.Bounds[2 * i]);
+    }
+    if (std::fabs(distance) > radius)
+      continue;
+
+    if (node.Count == 0)
+    {
+      stack.push_back(node.First);
+      stack.push_back(index + 1);
+      continue;
+    }
+
+    for (vtkIdType t = node.First; t < node.First + node.Count; ++t)
+    {
+      const Triangle &triangle = m_Triangles[t];
+      ++m_NumberOfTestedTriangles;
+
+      double p[3][3];
+      double s[3];
+      for (int k = 0; k < 3; ++k)
+      {
+        inPoints->GetPoint(triangle.Points[k], p[k]);
+        s[k] = normal[0] * p[k][0] + normal[1] * p[k][1] + normal[2] * p[k][2] - offset;
+      }
+
+      // like the contour value 0 of vtkCutter, points on the plane count as above it
+      vtkIdType ids[2];
+      int numberOfIds = 0;
+      for (int e = 0; e < 3; ++e)
+      {
+        const int a = edges[e][0];
+        const int b = edges[e][1];
+        if ((s[a] >= 0.0) != (s[b] >= 0.0))
+          ids[numberOfIds++] = getContourPoint(triangle.Points[a], triangle.Points[b], s[a], s[b], p[a], p[b]);
+      }
+
+      if (numberOfIds == 2 && ids[0] != ids[1])
+      {
+        const vtkIdType line = lines->InsertNextCell(2, ids);
+        outCD->CopyData(inCD, triangle.Cell, line);
+      }
+    }
+  }
+
+  output->SetPoints(points);
+  output->SetLines(lines);
+  outPD->Squeeze();
+  outCD->Squeeze();
+}
@@ -35,12 +35,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkCutter.h>
 #include <vtkGlyph3D.h>
 #include <vtkLookupTable.h>
+#include <vtkMatrix4x4.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
 #include <vtkReverseSense.h>
 #include <vtkTransformPolyDataFilter.h>
 
+#include <algorithm>
+
 // constructor LocalStorage
 mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
 {
@@ -90,6 +93,14 @@ mitk::SurfaceVtkMapper2D::LocalStorage::LocalStorage()
   m_InverseNormalActor->SetMapper(m_InverseNormalMapper);
 
   m_ReverseSense = vtkSmartPointer<vtkReverseSense>::New();
+
+  m_PlaneCut = vtkSmartPointer<vtkPolyData>::New();
+  m_PlaneCutTransform = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+  m_PlaneCutTransform->SetInputData(m_PlaneCut);
+  m_PlaneCutNormal[0] = m_PlaneCutNormal[1] = m_PlaneCutNormal[2] = 0.0;
+  m_PlaneCutOffset = 0.0;
+  m_PlaneCutInput = nullptr;
+  m_PlaneCutInputMTime = 0;
 }
 
 // destructor LocalStorage
@@ -212,22 +223,64 @@ void mitk::SurfaceVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rende
   normal[1] = planeGeometry->GetNormal()[1];
   normal[2] = planeGeometry->GetNormal()[2];
 
-  localStorage->m_CuttingPlane->SetOrigin(origin);
-  localStorage->m_CuttingPlane->SetNormal(normal);
   // Transform the data according to its geometry.
   // See UpdateVtkTransform documentation for details.
   vtkSmartPointer<vtkLinearTransform> vtktransform = GetDataNode()->GetVtkTransform(this->GetTimestep());
-  vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-  filter->SetTransform(vtktransform);
-  filter->SetInputData(inputPolyData);
-  localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
-  localStorage->m_Cutter->Update();
+
+  vtkAlgorithmOutput *contourPort = nullptr;
+  m_PlaneCutter.SetInput(inputPolyData);
+  if (m_PlaneCutter.CanCut())
+  {
+    // The plane n * (x - o) = 0 in world coordinates is (A^T n) * y = n * (o - b) for the surface coordinates y,
+    // with x = A y + b. Cutting commutes with the transform, so only the contour has to be transformed.
+    vtkMatrix4x4 *matrix = vtktransform->GetMatrix();
+    double localNormal[3] = {0.0, 0.0, 0.0};
+    double localOffset = 0.0;
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int j = 0; j < 3; ++j)
+        localNormal[j] += matrix->GetElement(i, j) * normal[i];
+      localOffset += normal[i] * (origin[i] - matrix->GetElement(i, 3));
+    }
+
+    if (localStorage->m_PlaneCutInput != inputPolyData.GetPointer() ||
+        localStorage->m_PlaneCutInputMTime != m_PlaneCutter.GetInputMTime() ||
+        localStorage->m_PlaneCutOffset != localOffset || localStorage->m_PlaneCutNormal[0] != localNormal[0] ||
+        localStorage->m_PlaneCutNormal[1] != localNormal[1] || localStorage->m_PlaneCutNormal[2] != localNormal[2])
+    {
+      m_PlaneCutter.Cut(localNormal, localOffset, localStorage->m_PlaneCut);
+      localStorage->m_PlaneCut->Modified();
+
+      localStorage->m_PlaneCutInput = inputPolyData.GetPointer();
+      localStorage->m_PlaneCutInputMTime = m_PlaneCutter.GetInputMTime();
+      localStorage->m_PlaneCutOffset = localOffset;
+      std::copy(localNormal, localNormal + 3, localStorage->m_PlaneCutNormal);
+    }
+
+    localStorage->m_PlaneCutTransform->SetTransform(vtktransform);
+    localStorage->m_PlaneCutTransform->Update();
+    localStorage->m_Cutter->RemoveAllInputConnections(0);
+    contourPort = localStorage->m_PlaneCutTransform->GetOutputPort();
+  }
+  else
+  {
+    localStorage->m_CuttingPlane->SetOrigin(origin);
+    localStorage->m_CuttingPlane->SetNormal(normal);
+    vtkSmartPointer<vtkTransformPolyDataFilter> filter = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
+    filter->SetTransform(vtktransform);
+    filter->SetInputData(inputPolyData);
+    localStorage->m_Cutter->SetInputConnection(filter->GetOutputPort());
+    localStorage->m_Cutter->Update();
+    localStorage->m_PlaneCutInput = nullptr;
+    contourPort = localStorage->m_Cutter->GetOutputPort();
+  }
+  localStorage->m_Mapper->SetInputConnection(contourPort);
 
   bool generateNormals = false;
   node->GetBoolProperty("draw normals 2D", generateNormals);
   if (generateNormals)
   {
-    localStorage->m_NormalGlyph->SetInputConnection(localStorage->m_Cutter->GetOutputPort());
+    localStorage->m_NormalGlyph->SetInputConnection(contourPort);
     localStorage->m_NormalGlyph->Update();
 
     localStorage->m_NormalMapper->SetInputConnection(localStorage->m_NormalGlyph->GetOutputPort());
@@ -244,7 +297,7 @@ void mitk::SurfaceVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *rende
   node->GetBoolProperty("invert normals", generateInverseNormals);
   if (generateInverseNormals)
   {
-    localStorage->m_ReverseSense->SetInputConnection(localStorage->m_Cutter->GetOutputPort());
+    localStorage->m_ReverseSense->SetInputConnection(contourPort);
     localStorage->m_ReverseSense->ReverseCellsOff();
     localStorage->m_ReverseSense->ReverseNormalsOn();
 
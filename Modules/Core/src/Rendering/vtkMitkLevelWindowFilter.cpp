@@ -29,6 +29,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 // used for acos etc.
 #include <cmath>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 // used for PI
 #include <itkMath.h>
 
@@ -36,10 +40,28 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 static const double PI = itk::Math::pi;
 
+// number of entries of the color table for floating point images
+static const int QuantizedColorTableSize = 4096;
+// color tables of integer images with a larger range of pixel values are not used
+static const double MaximumColorTableSize = 65536;
+
 vtkStandardNewMacro(vtkMitkLevelWindowFilter);
 
 vtkMitkLevelWindowFilter::vtkMitkLevelWindowFilter()
-  : m_LookupTable(nullptr), m_OpacityFunction(nullptr), m_MinOpacity(0.0), m_MaxOpacity(255.0)
+  : m_LookupTable(nullptr),
+    m_OpacityFunction(nullptr),
+    m_MinOpacity(0.0),
+    m_MaxOpacity(255.0),
+    m_ColorTableMinimum(0.0),
+    m_ColorTableMaximum(0.0),
+    m_ColorTableOrigin(0.0),
+    m_ColorTableScale(1.0),
+    m_ColorTableNanColor(0),
+    m_ColorTableLookupTable(nullptr),
+    m_ColorTableOpacityFunction(nullptr),
+    m_ColorTableTime(0),
+    m_ColorTableScalarType(-1),
+    m_UseColorTable(false)
 {
   // MITK_INFO << "mitk level/window filter uses " << GetNumberOfThreads() << " thread(s)";
 }
@@ -478,6 +500,99 @@ void vtkApplyLookupTableOnScalarsCTF(vtkMitkLevelWindowFilter *self,
   }
 }
 
+// Internal method which should never be used anywhere else and should not be in th header.
+//----------------------------------------------------------------------------
+// This templated function determines the range of the pixel values, ignoring NaN.
+template <class T>
+void vtkComputeScalarRange(const T *scalars, vtkIdType numberOfScalars, double range[2])
+{
+  T minimum = std::numeric_limits<T>::max();
+  T maximum = std::numeric_limits<T>::lowest();
+  for (vtkIdType i = 0; i < numberOfScalars; ++i)
+  {
+    // comparisons with NaN are false
+    minimum = scalars[i] < minimum ? scalars[i] : minimum;
+    maximum = scalars[i] > maximum ? scalars[i] : maximum;
+  }
+  range[0] = static_cast<double>(minimum);
+  range[1] = static_cast<double>(maximum);
+}
+
+// Internal method which should never be used anywhere else and should not be in th header.
+//----------------------------------------------------------------------------
+// This templated function maps the pixels through the precomputed color table.
+template <class T>
+void vtkApplyColorTableOnScalars(vtkImageData *inData,
+                                 vtkImageData *outData,
+                                 int outExt[6],
+                                 double *clippingBounds,
+                                 const std::vector<int> &colorTable,
+                                 double origin,
+                                 double scale,
+                                 int nanColor,
+                                 T *)
+{
+  vtkImageIterator<T> inputIt(inData, outExt);
+  vtkImageIterator<unsigned char> outputIt(outData, outExt);
+
+  const int *table = colorTable.data();
+  const int maxIndex = static_cast<int>(colorTable.size()) - 1;
+  const bool integerInput = std::numeric_limits<T>::is_integer;
+  const auto offset = static_cast<long long>(origin);
+
+  // pixels within the horizontal clipping bounds
+  const int clippedBegin = std::max(outExt[0], static_cast<int>(std::ceil(clippingBounds[0])));
+  const int clippedEnd = std::min(outExt[1] + 1, static_cast<int>(std::ceil(clippingBounds[1])));
+
+  int y = outExt[2];
+
+  // Loop through ouput pixels
+  while (!outputIt.IsAtEnd())
+  {
+    auto *outputSI = reinterpret_cast<int *>(outputIt.BeginSpan());
+    auto *outputSIEnd = reinterpret_cast<int *>(outputIt.EndSpan());
+    const T *inputSI = inputIt.BeginSpan();
+
+    // do we iterate over the inner vertical clipping bounds
+    if (y >= clippingBounds[2] && y < clippingBounds[3] && clippedBegin < clippedEnd)
+    {
+      const int begin = clippedBegin - outExt[0];
+      const int end = clippedEnd - outExt[0];
+
+      // outer horizontal clipping bounds - write transparent RGBA pixels as single ints
+      std::fill(outputSI, outputSI + begin, 0);
+      std::fill(outputSI + end, outputSIEnd, 0);
+
+      // the pixel values are within the range of the table, it was computed for this input
+      if (integerInput)
+      {
+        for (int x = begin; x < end; ++x)
+        {
+          outputSI[x] = table[static_cast<long long>(inputSI[x]) - offset];
+        }
+      }
+      else
+      {
+        for (int x = begin; x < end; ++x)
+        {
+          const double value = static_cast<double>(inputSI[x]);
+          const int idx = std::min(maxIndex, std::max(0, static_cast<int>((value - origin) * scale + 0.5)));
+          outputSI[x] = value == value ? table[idx] : nanColor;
+        }
+      }
+    }
+    else
+    {
+      // outer vertical clipping bounds - write a transparent RGBA line as ints
+      std::fill(outputSI, outputSIEnd, 0);
+    }
+
+    inputIt.NextSpan();
+    outputIt.NextSpan();
+    y++;
+  }
+}
+
 int vtkMitkLevelWindowFilter::RequestInformation(vtkInformation *request,
                                                  vtkInformationVector **inputVector,
                                                  vtkInformationVector *outputVector)
@@ -506,6 +621,24 @@ void vtkMitkLevelWindowFilter::ThreadedExecute(vtkImageData *inData, vtkImageDat
         return;
     }
   }
+  else if (m_UseColorTable)
+  {
+    switch (inData->GetScalarType())
+    {
+      vtkTemplateMacro(vtkApplyColorTableOnScalars(inData,
+                                                   outData,
+                                                   extent,
+                                                   m_ClippingBounds,
+                                                   m_ColorTable,
+                                                   m_ColorTableOrigin,
+                                                   m_ColorTableScale,
+                                                   m_ColorTableNanColor,
+                                                   static_cast<VTK_TT *>(nullptr)));
+      default:
+        vtkErrorMacro(<< "Execute: Unknown ScalarType");
+        return;
+    }
+  }
   else
   {
     bool dontClip = extent[2] >= m_ClippingBounds[2] && extent[3] <= m_ClippingBounds[3] &&
@@ -557,6 +690,190 @@ void vtkMitkLevelWindowFilter::ThreadedExecute(vtkImageData *inData, vtkImageDat
   }
 }
 
+int vtkMitkLevelWindowFilter::RequestData(vtkInformation *request,
+                                          vtkInformationVector **inputVector,
+                                          vtkInformationVector *outputVector)
+{
+  vtkImageData *input = vtkImageData::GetData(inputVector[0]);
+  m_UseColorTable = input != nullptr && input->GetNumberOfScalarComponents() == 1 && this->UpdateColorTable(input);
+
+  return this->Superclass::RequestData(request, inputVector, outputVector);
+}
+
+bool vtkMitkLevelWindowFilter::UpdateColorTable(vtkImageData *input)
+{
+  if (m_LookupTable == nullptr)
+  {
+    return false;
+  }
+
+  m_LookupTable->Build();
+  auto *vlt = dynamic_cast<vtkLookupTable *>(m_LookupTable);
+  auto *ctf = dynamic_cast<vtkColorTransferFunction *>(m_LookupTable);
+  if (vlt == nullptr && ctf == nullptr)
+  {
+    return false;
+  }
+
+  const int scalarType = input->GetScalarType();
+  const bool integerInput = scalarType != VTK_FLOAT && scalarType != VTK_DOUBLE;
+
+  double range[2];
+  switch (scalarType)
+  {
+    vtkTemplateMacro(vtkComputeScalarRange(
+      static_cast<VTK_TT *>(input->GetScalarPointer()), input->GetNumberOfPoints(), range));
+    default:
+      return false;
+  }
+  if (!(range[0] <= range[1]) || std::isinf(range[0]) || std::isinf(range[1]))
+  {
+    // no pixels or only NaN or infinite values
+    return false;
+  }
+
+  vtkMTimeType time = m_LookupTable->GetMTime();
+  if (m_OpacityFunction != nullptr)
+  {
+    time = std::max(time, m_OpacityFunction->GetMTime());
+  }
+
+  // the table of the last update is reused or extended while scrolling through an image
+  const bool sameMapping = !m_ColorTable.empty() && m_ColorTableLookupTable == m_LookupTable &&
+                           m_ColorTableOpacityFunction == m_OpacityFunction && m_ColorTableTime == time &&
+                           m_ColorTableScalarType == scalarType;
+  if (sameMapping)
+  {
+    if (range[0] >= m_ColorTableMinimum && range[1] <= m_ColorTableMaximum)
+    {
+      return true;
+    }
+    range[0] = std::min(range[0], m_ColorTableMinimum);
+    range[1] = std::max(range[1], m_ColorTableMaximum);
+  }
+
+  if (integerInput && range[1] - range[0] + 1 > MaximumColorTableSize)
+  {
+    m_ColorTable.clear();
+    return false;
+  }
+
+  const int size = integerInput ? static_cast<int>(range[1] - range[0]) + 1 : QuantizedColorTableSize;
+  m_ColorTableMinimum = range[0];
+  m_ColorTableMaximum = range[1];
+
+  // Floating point values are quantized over the part of the data range in which the colors change. The lookup
+  // table and the opacity function are constant outside of their range, there one entry on each side suffices, so
+  // outliers in the data do not coarsen the quantization of the level window.
+  double quantizedRange[2] = {range[0], range[1]};
+  if (!integerInput)
+  {
+    double mappingRange[2];
+    if (vlt != nullptr)
+    {
+      vlt->GetTableRange(mappingRange);
+    }
+    else
+    {
+      ctf->GetRange(mappingRange);
+      if (m_OpacityFunction != nullptr)
+      {
+        const double *opacityRange = m_OpacityFunction->GetRange();
+        mappingRange[0] = std::min(mappingRange[0], opacityRange[0]);
+        mappingRange[1] = std::max(mappingRange[1], opacityRange[1]);
+      }
+    }
+
+    const double binWidth = (mappingRange[1] - mappingRange[0]) / (QuantizedColorTableSize - 3);
+    quantizedRange[0] = std::max(range[0], mappingRange[0] - binWidth);
+    quantizedRange[1] = std::min(range[1], mappingRange[1] + binWidth);
+    if (quantizedRange[0] > quantizedRange[1])
+    {
+      // all pixel values are on the same side of the mapping range and have the same color
+      quantizedRange[0] = quantizedRange[1] = range[0] > mappingRange[1] ? range[0] : range[1];
+    }
+
+    // the quantization has to be finer than the colors of the lookup table, otherwise map each pixel
+    if (vlt != nullptr &&
+        (quantizedRange[1] - quantizedRange[0]) / (size - 1) >
+          (mappingRange[1] - mappingRange[0]) / vlt->GetNumberOfColors())
+    {
+      m_ColorTable.clear();
+      return false;
+    }
+  }
+
+  m_ColorTableOrigin = quantizedRange[0];
+  m_ColorTableScale = integerInput ? 1.0
+                                   : (quantizedRange[1] > quantizedRange[0]
+                                        ? (size - 1) / (quantizedRange[1] - quantizedRange[0])
+                                        : 0.0);
+
+  m_ColorTable.resize(size);
+  for (int i = 0; i < size; ++i)
+  {
+    const double value = m_ColorTableScale > 0.0 ? m_ColorTableOrigin + i / m_ColorTableScale : m_ColorTableOrigin;
+    m_ColorTable[i] = this->MapScalarToColor(value, integerInput);
+  }
+  m_ColorTableNanColor = this->MapScalarToColor(std::numeric_limits<double>::quiet_NaN(), integerInput);
+
+  m_ColorTableLookupTable = m_LookupTable;
+  m_ColorTableOpacityFunction = m_OpacityFunction;
+  m_ColorTableTime = time;
+  m_ColorTableScalarType = scalarType;
+  return true;
+}
+
+int vtkMitkLevelWindowFilter::MapScalarToColor(double value, bool integerInput)
+{
+  int color = 0;
+  auto *rgba = reinterpret_cast<unsigned char *>(&color);
+
+  // same as vtkApplyLookupTableOnScalarsCTF
+  if (auto *ctf = dynamic_cast<vtkColorTransferFunction *>(m_LookupTable))
+  {
+    double ctfColor[4];
+    ctf->GetColor(value, ctfColor);
+    ctfColor[3] = 1.0;
+    if (m_OpacityFunction)
+      ctfColor[3] = m_OpacityFunction->GetValue(value);
+
+    for (int i = 0; i < 4; ++i)
+    {
+      rgba[i] = static_cast<unsigned char>(255.0 * ctfColor[i] + 0.5);
+    }
+    return color;
+  }
+
+  auto *lookupTable = static_cast<vtkLookupTable *>(m_LookupTable);
+  if (lookupTable->GetScale() == VTK_SCALE_LINEAR && value == value)
+  {
+    // same as vtkApplyLookupTableOnScalarsFast
+    double tableRange[2];
+    lookupTable->GetTableRange(tableRange);
+    const int *realLookupTable = reinterpret_cast<int *>(lookupTable->GetTable()->GetPointer(0));
+    int maxIndex = lookupTable->GetNumberOfColors() - 1;
+
+    const float scale = (tableRange[1] - tableRange[0] > 0 ? (maxIndex + 1) / (tableRange[1] - tableRange[0]) : 0.0);
+    float bias = -tableRange[0] * scale;
+    bias += 0.5f;
+
+    // integer pixels are multiplied as float there
+    auto idx = integerInput ? static_cast<int>(static_cast<float>(value) * scale + bias)
+                            : static_cast<int>(value * scale + bias);
+    if (idx < 0)
+      idx = 0;
+    else if (idx > maxIndex)
+      idx = maxIndex;
+
+    return realLookupTable[idx];
+  }
+
+  // same as vtkApplyLookupTableOnScalars
+  std::memcpy(rgba, lookupTable->MapValue(value), 4);
+  return color;
+}
+
 // void vtkMitkLevelWindowFilter::ExecuteInformation(
 //    vtkImageData *vtkNotUsed(inData), vtkImageData *vtkNotUsed(outData))
 //{
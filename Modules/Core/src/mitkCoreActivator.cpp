@@ -172,8 +172,10 @@ void MitkCoreActivator::Load(us::ModuleContext *context)
   m_MimeTypeProviderReg = context->RegisterService<mitk::IMimeTypeProvider>(m_MimeTypeProvider.get());
 
   this->RegisterDefaultMimeTypes();
-  this->RegisterItkReaderWriter();
-  this->RegisterVtkReaderWriter();
+  m_ItkFileIORegistration.reset(
+    new mitk::LazyFileIORegistration(context, "itk", [this]() { this->RegisterItkReaderWriter(); }));
+  m_VtkFileIORegistration.reset(
+    new mitk::LazyFileIORegistration(context, "vtk", [this]() { this->RegisterVtkReaderWriter(); }));
 
   // Add custom Reader / Writer Services
   m_FileReaders.push_back(new mitk::PointSetReaderService());
@@ -196,6 +198,9 @@ void MitkCoreActivator::Load(us::ModuleContext *context)
 
 void MitkCoreActivator::Unload(us::ModuleContext *)
 {
+  m_ItkFileIORegistration.reset();
+  m_VtkFileIORegistration.reset();
+
   for (auto &elem : m_FileReaders)
   {
     delete elem;
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkAbstractFileIO.h>
 #include <mitkIFileReader.h>
 #include <mitkIFileWriter.h>
+#include <mitkLazyFileIORegistration.h>
 
 #include <mitkMimeTypeProvider.h>
 #include <mitkPlanePositionManager.h>
@@ -74,6 +75,10 @@ private:
   std::vector<mitk::AbstractFileIO *> m_FileIOs;
   std::vector<mitk::IFileWriter *> m_LegacyWriters;
 
+  // create the ITK and VTK based readers and writers on first use, see resource/manifest.json
+  std::unique_ptr<mitk::LazyFileIORegistration> m_ItkFileIORegistration;
+  std::unique_ptr<mitk::LazyFileIORegistration> m_VtkFileIORegistration;
+
   std::vector<mitk::CustomMimeType *> m_DefaultMimeTypes;
 
   us::ServiceRegistration<mitk::IMimeTypeProvider> m_MimeTypeProviderReg;
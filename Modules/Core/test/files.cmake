@@ -23,6 +23,7 @@ set(MODULE_TESTS
   mitkAccessByItkTest.cpp
   mitkCoreObjectFactoryTest.cpp
   mitkDataNodeTest.cpp
+  mitkDataStorageBoundingGeometryTest.cpp
   mitkMaterialTest.cpp
   mitkActionTest.cpp
   mitkDispatcherTest.cpp
@@ -79,6 +80,8 @@ set(MODULE_TESTS
   mitkRenderingManagerTest.cpp
   mitkCompositePixelValueToStringTest.cpp
   vtkMitkThickSlicesFilterTest.cpp
+  mitkExtractThickSliceFilterTest.cpp
+  vtkMitkLevelWindowFilterTest.cpp
   mitkNodePredicateSourceTest.cpp
   mitkNodePredicateDataPropertyTest.cpp
   mitkNodePredicateFunctionTest.cpp
@@ -121,6 +124,8 @@ set(MODULE_TESTS
   mitkNodePredicateGeometryTest.cpp
   mitkPreferenceListReaderOptionsFunctorTest.cpp
   mitkGenericIDRelationRuleTest.cpp
+  mitkPolyDataPlaneCutterTest.cpp
+  mitkLazyFileIORegistrationTest.cpp
 )
 
 if(MITK_ENABLE_RENDERING_TESTING)
@@ -193,6 +198,7 @@ if(NOT WIN32)
 endif()
 
 set(RESOURCE_FILES
+  manifest.json
   Interactions/AddAndRemovePoints.xml
   Interactions/globalConfig.xml
   Interactions/StatemachineTest.xml
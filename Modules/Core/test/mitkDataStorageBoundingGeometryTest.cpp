@@ -0,0 +1,217 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkImage.h>
+#include <mitkStandaloneDataStorage.h>
+
+class mitkDataStorageBoundingGeometryTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkDataStorageBoundingGeometryTestSuite);
+  MITK_TEST(TestSingleImage);
+  MITK_TEST(TestAddAndRemove);
+  MITK_TEST(TestGeometryChange);
+  MITK_TEST(TestTimeStepGeometryChange);
+  MITK_TEST(TestVisibility);
+  MITK_TEST(TestNodesNotInDataStorage);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  mitk::StandaloneDataStorage::Pointer m_DataStorage;
+  mitk::DataNode::Pointer m_Node;
+  mitk::Image::Pointer m_Image;
+
+  static mitk::Image::Pointer CreateImage(unsigned int timeSteps, mitk::ScalarType spacing)
+  {
+    unsigned int dimensions[] = {10, 20, 30, timeSteps};
+    auto image = mitk::Image::New();
+    image->Initialize(mitk::MakeScalarPixelType<unsigned char>(), 4, dimensions);
+    mitk::Vector3D imageSpacing;
+    imageSpacing.Fill(spacing);
+    image->SetSpacing(imageSpacing);
+    return image;
+  }
+
+  static mitk::DataNode::Pointer CreateNode(mitk::BaseData *data)
+  {
+    auto node = mitk::DataNode::New();
+    node->SetData(data);
+    return node;
+  }
+
+  static void AssertBounds(const mitk::TimeGeometry *expected, const mitk::TimeGeometry *actual)
+  {
+    CPPUNIT_ASSERT(actual != nullptr);
+    for (int i = 0; i < 6; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(expected->GetBoundsInWorld()[i], actual->GetBoundsInWorld()[i], mitk::eps);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    m_DataStorage = mitk::StandaloneDataStorage::New();
+    m_Image = CreateImage(50, 1.0);
+    m_Node = CreateNode(m_Image);
+    m_DataStorage->Add(m_Node);
+  }
+
+  void tearDown() override
+  {
+    m_DataStorage = nullptr;
+    m_Node = nullptr;
+    m_Image = nullptr;
+  }
+
+  void TestSingleImage()
+  {
+    auto geometry = m_DataStorage->ComputeBoundingGeometry3D();
+    AssertBounds(m_Image->GetTimeGeometry(), geometry);
+    CPPUNIT_ASSERT_EQUAL(mitk::TimeStepType(50), geometry->CountTimeSteps());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(
+      m_Image->GetTimeGeometry()->GetMinimumTimePoint(), geometry->GetMinimumTimePoint(), mitk::eps);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(
+      m_Image->GetTimeGeometry()->GetMaximumTimePoint(), geometry->GetMaximumTimePoint(), mitk::eps);
+  }
+
+  void TestAddAndRemove()
+  {
+    auto geometry = m_DataStorage->ComputeBoundingGeometry3D();
+    auto unchangedGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    CPPUNIT_ASSERT_MESSAGE("Each call gives a new geometry object", unchangedGeometry != geometry);
+    AssertBounds(geometry, unchangedGeometry);
+    CPPUNIT_ASSERT_EQUAL(geometry->CountTimeSteps(), unchangedGeometry->CountTimeSteps());
+
+    // larger and with finer spacing
+    auto image = CreateImage(3, 0.5);
+    mitk::Point3D origin;
+    origin.Fill(-20.0);
+    image->SetOrigin(origin);
+    auto node = CreateNode(image);
+    m_DataStorage->Add(node);
+
+    auto combinedGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    CPPUNIT_ASSERT(combinedGeometry != geometry);
+    CPPUNIT_ASSERT_EQUAL(mitk::TimeStepType(50), combinedGeometry->CountTimeSteps());
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(image->GetTimeGeometry()->GetBoundsInWorld()[2 * axis],
+                                   combinedGeometry->GetBoundsInWorld()[2 * axis],
+                                   mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(m_Image->GetTimeGeometry()->GetBoundsInWorld()[2 * axis + 1],
+                                   combinedGeometry->GetBoundsInWorld()[2 * axis + 1],
+                                   mitk::eps);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL(0.5, combinedGeometry->GetGeometryForTimeStep(0)->GetSpacing()[axis], mitk::eps);
+    }
+
+    m_DataStorage->Remove(node);
+    auto remainingGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    AssertBounds(m_Image->GetTimeGeometry(), remainingGeometry);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.0, remainingGeometry->GetGeometryForTimeStep(0)->GetSpacing()[0], mitk::eps);
+  }
+
+  void TestGeometryChange()
+  {
+    auto geometry = m_DataStorage->ComputeBoundingGeometry3D();
+
+    mitk::Point3D origin;
+    origin[0] = 100.0;
+    origin[1] = -30.0;
+    origin[2] = 7.0;
+    m_Image->SetOrigin(origin);
+
+    auto movedGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    CPPUNIT_ASSERT(movedGeometry != geometry);
+    AssertBounds(m_Image->GetUpdatedTimeGeometry(), movedGeometry);
+
+    mitk::Vector3D spacing;
+    spacing.Fill(2.0);
+    m_Image->SetSpacing(spacing);
+    auto scaledGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    AssertBounds(m_Image->GetUpdatedTimeGeometry(), scaledGeometry);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, scaledGeometry->GetGeometryForTimeStep(0)->GetSpacing()[0], mitk::eps);
+
+    // new data of the node
+    auto image = CreateImage(7, 1.0);
+    m_Node->SetData(image);
+    auto replacedGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    AssertBounds(image->GetTimeGeometry(), replacedGeometry);
+    CPPUNIT_ASSERT_EQUAL(mitk::TimeStepType(7), replacedGeometry->CountTimeSteps());
+  }
+
+  void TestTimeStepGeometryChange()
+  {
+    auto geometry = m_DataStorage->ComputeBoundingGeometry3D();
+
+    // only the geometry of the last time step moves
+    mitk::Point3D origin;
+    origin.Fill(200.0);
+    m_Image->GetTimeGeometry()->GetGeometryForTimeStep(49)->SetOrigin(origin);
+
+    auto movedGeometry = m_DataStorage->ComputeBoundingGeometry3D();
+    AssertBounds(m_Image->GetUpdatedTimeGeometry(), movedGeometry);
+    CPPUNIT_ASSERT(movedGeometry->GetBoundsInWorld()[1] > geometry->GetBoundsInWorld()[1]);
+  }
+
+  void TestVisibility()
+  {
+    auto image = CreateImage(1, 1.0);
+    mitk::Point3D origin;
+    origin.Fill(500.0);
+    image->SetOrigin(origin);
+    auto node = CreateNode(image);
+    m_DataStorage->Add(node);
+
+    auto geometry = m_DataStorage->ComputeVisibleBoundingGeometry3D();
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(
+      image->GetTimeGeometry()->GetBoundsInWorld()[1], geometry->GetBoundsInWorld()[1], mitk::eps);
+
+    node->SetVisibility(false);
+    AssertBounds(m_Image->GetTimeGeometry(), m_DataStorage->ComputeVisibleBoundingGeometry3D());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(image->GetTimeGeometry()->GetBoundsInWorld()[1],
+                                 m_DataStorage->ComputeBoundingGeometry3D()->GetBoundsInWorld()[1],
+                                 mitk::eps);
+
+    node->SetVisibility(true);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(image->GetTimeGeometry()->GetBoundsInWorld()[1],
+                                 m_DataStorage->ComputeVisibleBoundingGeometry3D()->GetBoundsInWorld()[1],
+                                 mitk::eps);
+  }
+
+  void TestNodesNotInDataStorage()
+  {
+    auto image = CreateImage(2, 1.0);
+    auto nodes = mitk::DataStorage::SetOfObjects::New();
+    nodes->InsertElement(0, CreateNode(image));
+
+    for (int run = 0; run < 2; ++run)
+    {
+      auto geometry = m_DataStorage->ComputeBoundingGeometry3D(nodes);
+      AssertBounds(image->GetTimeGeometry(), geometry);
+      CPPUNIT_ASSERT_EQUAL(mitk::TimeStepType(2), geometry->CountTimeSteps());
+
+      mitk::Point3D origin;
+      origin.Fill(-3.0);
+      image->SetOrigin(origin);
+      image->GetUpdatedTimeGeometry();
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkDataStorageBoundingGeometry)
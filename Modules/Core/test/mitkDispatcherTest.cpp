@@ -19,10 +19,91 @@
 #include "mitkDataInteractor.h"
 #include "mitkDataNode.h"
 #include "mitkDispatcher.h"
+#include "mitkInteractionEventObserver.h"
+#include "mitkInternalEvent.h"
+#include "mitkMouseMoveEvent.h"
+#include "mitkPointSet.h"
+#include "mitkProperties.h"
 #include "mitkStandaloneDataStorage.h"
 #include "mitkTestingMacros.h"
 #include "mitkVtkPropRenderer.h"
 
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  /** Records the layers of the interactors in the order they are offered an event, and handles none */
+  class LayerRecordingInteractor : public mitk::DataInteractor
+  {
+  public:
+    mitkClassMacro(LayerRecordingInteractor, mitk::DataInteractor);
+    itkFactorylessNewMacro(Self);
+
+    static std::vector<int> s_Layers;
+
+  protected:
+    bool FilterEvents(mitk::InteractionEvent *, mitk::DataNode *) override
+    {
+      s_Layers.push_back(this->GetLayer());
+      return false;
+    }
+  };
+
+  std::vector<int> LayerRecordingInteractor::s_Layers;
+
+  /** Records the interactors that are offered an event, and handles none */
+  class RangeInteractor : public mitk::DataInteractor
+  {
+  public:
+    mitkClassMacro(RangeInteractor, mitk::DataInteractor);
+    itkFactorylessNewMacro(Self);
+
+    static std::vector<const RangeInteractor *> s_Offered;
+
+    mitk::ScalarType GetInteractionDistance() const override { return m_Distance; }
+    void SetInteractionDistance(mitk::ScalarType distance) { m_Distance = distance; }
+
+  protected:
+    RangeInteractor() : m_Distance(-1.0) {}
+
+    bool FilterEvents(mitk::InteractionEvent *, mitk::DataNode *) override
+    {
+      s_Offered.push_back(this);
+      return false;
+    }
+
+  private:
+    mitk::ScalarType m_Distance;
+  };
+
+  std::vector<const RangeInteractor *> RangeInteractor::s_Offered;
+
+  bool WasOffered(const RangeInteractor *interactor)
+  {
+    return std::find(RangeInteractor::s_Offered.begin(), RangeInteractor::s_Offered.end(), interactor) !=
+           RangeInteractor::s_Offered.end();
+  }
+
+  /** Counts the events it is notified about */
+  struct CountingEventObserver : public mitk::InteractionEventObserver
+  {
+    CountingEventObserver() : m_Count(0) {}
+    void Notify(mitk::InteractionEvent *, bool) override { ++m_Count; }
+    int m_Count;
+  };
+
+  std::vector<int> DispatchAndRecordLayers(mitk::BaseRenderer *renderer)
+  {
+    LayerRecordingInteractor::s_Layers.clear();
+    renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+    return LayerRecordingInteractor::s_Layers;
+  }
+}
+
 int mitkDispatcherTest(int /*argc*/, char * /*argv*/ [])
 {
   MITK_TEST_BEGIN("Dispatcher")
@@ -117,6 +198,140 @@ int mitkDispatcherTest(int /*argc*/, char * /*argv*/ [])
   MITK_TEST_CONDITION_REQUIRED(ei->GetReferenceCount() == 1,
                                "11 Number of references of Interactors " << num << " , expected 1");
 
+  /*
+   * Interactors are offered events in the order of their layers (descending), also after layers have changed.
+   */
+  std::vector<mitk::DataNode::Pointer> nodes;
+  std::vector<mitk::DataInteractor::Pointer> interactors;
+  const int layers[] = {1, 5, 3, 5};
+  for (int layer : layers)
+  {
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetIntProperty("layer", layer);
+    mitk::DataInteractor::Pointer interactor = LayerRecordingInteractor::New();
+    interactor->SetDataNode(node);
+    ds->Add(node);
+    nodes.push_back(node);
+    interactors.push_back(interactor);
+  }
+
+  std::vector<int> expectedLayers = {5, 5, 3, 1};
+  MITK_TEST_CONDITION_REQUIRED(DispatchAndRecordLayers(renderer) == expectedLayers,
+                               "12 Interactors are offered events sorted by layer");
+
+  nodes[0]->SetIntProperty("layer", 4);
+  expectedLayers = {5, 5, 4, 3};
+  MITK_TEST_CONDITION_REQUIRED(DispatchAndRecordLayers(renderer) == expectedLayers,
+                               "13 Order is updated after setting a layer");
+
+  dynamic_cast<mitk::IntProperty *>(nodes[2]->GetProperty("layer"))->SetValue(7);
+  expectedLayers = {7, 5, 5, 4};
+  MITK_TEST_CONDITION_REQUIRED(DispatchAndRecordLayers(renderer) == expectedLayers,
+                               "14 Order is updated after changing the value of a layer property");
+
+  nodes[1]->GetPropertyList()->ReplaceProperty("layer", mitk::IntProperty::New(0));
+  nodes[1]->SetIntProperty("layer", 2);
+  expectedLayers = {7, 5, 4, 2};
+  MITK_TEST_CONDITION_REQUIRED(DispatchAndRecordLayers(renderer) == expectedLayers,
+                               "15 Order is updated after replacing a layer property");
+
+  ds->Remove(nodes[3]);
+  expectedLayers = {7, 4, 2};
+  MITK_TEST_CONDITION_REQUIRED(DispatchAndRecordLayers(renderer) == expectedLayers,
+                               "16 Removed interactors are not offered events");
+
+  for (auto node : nodes)
+  {
+    if (ds->Exists(node))
+      ds->Remove(node);
+  }
+
+  /*
+   * Position events in 2D are only offered to interactors whose data is within their interaction distance.
+   */
+  renWin->SetSize(200, 200);
+  mitk::Point2D displayPosition;
+  displayPosition[0] = 100.0;
+  displayPosition[1] = 100.0;
+  mitk::MouseMoveEvent::Pointer moveEvent = mitk::MouseMoveEvent::New(
+    renderer, displayPosition, mitk::InteractionEvent::NoButton, mitk::InteractionEvent::NoKey);
+  const mitk::Point3D position = moveEvent->GetPositionInWorld();
+
+  mitk::Vector3D offset;
+  offset.Fill(0.0);
+  offset[0] = 3.0;
+  const std::vector<mitk::Point3D> nearPoints = {position + offset, position - offset};
+  offset[0] = 100.0;
+  const std::vector<mitk::Point3D> farPoints = {position + offset, position + offset};
+
+  std::vector<mitk::DataNode::Pointer> rangeNodes;
+  std::vector<RangeInteractor::Pointer> rangeInteractors;
+  for (int i = 0; i < 3; ++i)
+  {
+    mitk::PointSet::Pointer pointSet = mitk::PointSet::New();
+    for (const auto &point : (i == 0 ? nearPoints : farPoints))
+      pointSet->InsertPoint(point);
+    mitk::DataNode::Pointer node = mitk::DataNode::New();
+    node->SetData(pointSet);
+    RangeInteractor::Pointer interactor = RangeInteractor::New();
+    interactor->SetInteractionDistance(i < 2 ? 5.0 : -1.0);
+    interactor->SetDataNode(node);
+    ds->Add(node);
+    rangeNodes.push_back(node);
+    rangeInteractors.push_back(interactor);
+  }
+
+  RangeInteractor::s_Offered.clear();
+  renderer->GetDispatcher()->ProcessEvent(moveEvent);
+  MITK_TEST_CONDITION_REQUIRED(WasOffered(rangeInteractors[0]),
+                               "17 Interactor within its interaction distance is offered the event");
+  MITK_TEST_CONDITION_REQUIRED(!WasOffered(rangeInteractors[1]),
+                               "18 Interactor outside of its interaction distance is skipped");
+  MITK_TEST_CONDITION_REQUIRED(WasOffered(rangeInteractors[2]),
+                               "19 Interactor without interaction distance is offered the event");
+
+  // moving the data invalidates the cached bounds
+  dynamic_cast<mitk::PointSet *>(rangeNodes[1]->GetData())->SetPoint(1, position);
+  RangeInteractor::s_Offered.clear();
+  renderer->GetDispatcher()->ProcessEvent(moveEvent);
+  MITK_TEST_CONDITION_REQUIRED(WasOffered(rangeInteractors[1]),
+                               "20 Interactor is offered the event after its data moved into range");
+
+  // events without position are offered to all interactors
+  RangeInteractor::s_Offered.clear();
+  dynamic_cast<mitk::PointSet *>(rangeNodes[1]->GetData())->SetPoint(1, farPoints[1]);
+  renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+  MITK_TEST_CONDITION_REQUIRED(RangeInteractor::s_Offered.size() == 3,
+                               "21 Events without position are offered to all interactors");
+
+  for (auto node : rangeNodes)
+    ds->Remove(node);
+
+  /*
+   * The cached list of InteractionEventObservers follows registrations and unregistrations.
+   */
+  CountingEventObserver observer;
+  CountingEventObserver observer2;
+  us::ServiceRegistration<mitk::InteractionEventObserver> registration =
+    us::GetModuleContext()->RegisterService<mitk::InteractionEventObserver>(&observer);
+  renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+  MITK_TEST_CONDITION_REQUIRED(observer.m_Count == 1, "22 Registered observer is notified");
+
+  us::ServiceRegistration<mitk::InteractionEventObserver> registration2 =
+    us::GetModuleContext()->RegisterService<mitk::InteractionEventObserver>(&observer2);
+  renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+  MITK_TEST_CONDITION_REQUIRED(observer.m_Count == 2 && observer2.m_Count == 1,
+                               "23 Observer registered after the first event is notified");
+
+  registration.Unregister();
+  renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+  MITK_TEST_CONDITION_REQUIRED(observer.m_Count == 2 && observer2.m_Count == 2,
+                               "24 Unregistered observer is no longer notified");
+
+  registration2.Unregister();
+  renderer->GetDispatcher()->ProcessEvent(mitk::InternalEvent::New(renderer, nullptr, "Test"));
+  MITK_TEST_CONDITION_REQUIRED(observer2.m_Count == 2, "25 No observer is notified after unregistering all");
+
   renWin->Delete();
   // always end with this!
   MITK_TEST_END()
@@ -0,0 +1,233 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkExtractThickSliceFilter.h>
+#include <mitkITKImageImport.h>
+#include <mitkPlaneGeometry.h>
+#include <vtkMitkThickSlicesFilter.h>
+
+#include <itkImage.h>
+#include <itkImageRegionIterator.h>
+
+#include <vtkImageData.h>
+#include <vtkSmartPointer.h>
+
+#include <random>
+
+class mitkExtractThickSliceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkExtractThickSliceFilterTestSuite);
+  MITK_TEST(TestAllModesMatchThickSlicesFilter);
+  MITK_TEST(TestScrollingUpdatesRunningSum);
+  MITK_TEST(TestScrollingRecomputesMaximum);
+  MITK_TEST(TestThinSlice);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<short, 3> ItkImageType;
+
+  static const int NumberOfPlanes = 3;
+  mitk::Image::Pointer m_Image;
+
+  mitk::PlaneGeometry::Pointer CreatePlane(int slice)
+  {
+    // through the centers of the voxels, so that no sample lies on the border between two voxels
+    auto plane = mitk::PlaneGeometry::New();
+    plane->InitializeStandardPlane(m_Image->GetGeometry(), mitk::PlaneGeometry::Axial, slice + 0.5, true, false);
+    return plane;
+  }
+
+  // thick slice as extracted by the image mapper before, a 3D slab reduced by vtkMitkThickSlicesFilter
+  vtkSmartPointer<vtkImageData> ExtractReference(const mitk::PlaneGeometry *plane, int mode)
+  {
+    auto slicer = mitk::ExtractSliceFilter::New();
+    slicer->SetInput(m_Image);
+    slicer->SetWorldGeometry(plane);
+    slicer->SetVtkOutputRequest(true);
+    slicer->SetOutputDimensionality(3);
+    slicer->SetOutputSpacingZDirection(m_Image->GetGeometry()->GetSpacing()[2]);
+    slicer->SetOutputExtentZDirection(-NumberOfPlanes, NumberOfPlanes);
+    slicer->Update();
+
+    auto thickSlicesFilter = vtkSmartPointer<vtkMitkThickSlicesFilter>::New();
+    thickSlicesFilter->SetThickSliceMode(mode);
+    thickSlicesFilter->SetInputData(slicer->GetVtkOutput());
+    thickSlicesFilter->Update();
+
+    auto result = vtkSmartPointer<vtkImageData>::New();
+    result->DeepCopy(thickSlicesFilter->GetOutput());
+    return result;
+  }
+
+  void ExtractThickSlice(mitk::ExtractThickSliceFilter *filter, const mitk::PlaneGeometry *plane)
+  {
+    filter->SetWorldGeometry(plane);
+    filter->Modified();
+    filter->Update();
+  }
+
+  static void AssertEqual(vtkImageData *expected, vtkImageData *actual, const std::string &message)
+  {
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expected->GetNumberOfPoints(), actual->GetNumberOfPoints());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expected->GetScalarType(), actual->GetScalarType());
+    for (int i = 0; i < 6; i += 2)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expected->GetExtent()[i], actual->GetExtent()[i]);
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expected->GetExtent()[i + 1], actual->GetExtent()[i + 1]);
+    }
+
+    const auto *expectedPixels = static_cast<const short *>(expected->GetScalarPointer());
+    const auto *actualPixels = static_cast<const short *>(actual->GetScalarPointer());
+    for (vtkIdType i = 0; i < expected->GetNumberOfPoints(); ++i)
+    {
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(message, expectedPixels[i], actualPixels[i]);
+    }
+  }
+
+  mitk::ExtractThickSliceFilter::Pointer CreateFilter(int mode)
+  {
+    auto filter = mitk::ExtractThickSliceFilter::New();
+    filter->SetInput(m_Image);
+    filter->SetVtkOutputRequest(true);
+    filter->SetOutputSpacingZDirection(m_Image->GetGeometry()->GetSpacing()[2]);
+    filter->SetThickSliceMode(mode);
+    filter->SetThickSliceNumber(NumberOfPlanes);
+    return filter;
+  }
+
+public:
+  void setUp() override
+  {
+    auto itkImage = ItkImageType::New();
+    ItkImageType::SizeType size;
+    size[0] = 23;
+    size[1] = 17;
+    size[2] = 20;
+    ItkImageType::SpacingType spacing;
+    spacing[0] = 1.0;
+    spacing[1] = 1.0;
+    spacing[2] = 2.5;
+    itkImage->SetRegions(size);
+    itkImage->SetSpacing(spacing);
+    itkImage->Allocate();
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> values(-1000, 3000);
+    for (itk::ImageRegionIterator<ItkImageType> it(itkImage, itkImage->GetLargestPossibleRegion()); !it.IsAtEnd(); ++it)
+    {
+      it.Set(static_cast<short>(values(generator)));
+    }
+
+    m_Image = mitk::GrabItkImageMemory(itkImage);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestAllModesMatchThickSlicesFilter()
+  {
+    const int modes[] = {vtkMitkThickSlicesFilter::MIP,
+                         vtkMitkThickSlicesFilter::SUM,
+                         vtkMitkThickSlicesFilter::WEIGHTED,
+                         vtkMitkThickSlicesFilter::MINIP,
+                         vtkMitkThickSlicesFilter::MEAN};
+
+    // the slab of the first and last slices reaches out of the image
+    for (int slice : {0, 9, 19})
+    {
+      auto plane = this->CreatePlane(slice);
+      for (int mode : modes)
+      {
+        auto filter = this->CreateFilter(mode);
+        this->ExtractThickSlice(filter, plane);
+        AssertEqual(this->ExtractReference(plane, mode),
+                    filter->GetVtkOutput(),
+                    "Mode " + std::to_string(mode) + " at slice " + std::to_string(slice));
+      }
+    }
+  }
+
+  void TestScrollingUpdatesRunningSum()
+  {
+    for (int mode : {vtkMitkThickSlicesFilter::SUM, vtkMitkThickSlicesFilter::MEAN})
+    {
+      auto filter = this->CreateFilter(mode);
+      this->ExtractThickSlice(filter, this->CreatePlane(5));
+      CPPUNIT_ASSERT_EQUAL(2 * NumberOfPlanes + 1, filter->GetNumberOfReslicedPlanes());
+
+      // one direction, then back
+      const int slices[] = {6, 7, 8, 7, 6, 5, 4};
+      for (int slice : slices)
+      {
+        auto plane = this->CreatePlane(slice);
+        this->ExtractThickSlice(filter, plane);
+        CPPUNIT_ASSERT_MESSAGE("Scrolling by one slice extracts the entering and leaving plane only",
+                               filter->GetNumberOfReslicedPlanes() <= 3);
+        AssertEqual(this->ExtractReference(plane, mode),
+                    filter->GetVtkOutput(),
+                    "Mode " + std::to_string(mode) + " scrolled to slice " + std::to_string(slice));
+      }
+
+      // the direction of scrolling is anticipated
+      this->ExtractThickSlice(filter, this->CreatePlane(3));
+      CPPUNIT_ASSERT_EQUAL(2, filter->GetNumberOfReslicedPlanes());
+
+      // jumps are computed from scratch
+      auto plane = this->CreatePlane(12);
+      this->ExtractThickSlice(filter, plane);
+      CPPUNIT_ASSERT(filter->GetNumberOfReslicedPlanes() > 2 * NumberOfPlanes);
+      AssertEqual(this->ExtractReference(plane, mode), filter->GetVtkOutput(), "Jump to slice 12");
+    }
+  }
+
+  void TestScrollingRecomputesMaximum()
+  {
+    auto filter = this->CreateFilter(vtkMitkThickSlicesFilter::MIP);
+    this->ExtractThickSlice(filter, this->CreatePlane(8));
+    auto plane = this->CreatePlane(9);
+    this->ExtractThickSlice(filter, plane);
+    AssertEqual(this->ExtractReference(plane, vtkMitkThickSlicesFilter::MIP), filter->GetVtkOutput(), "MIP");
+
+    // same slab again
+    this->ExtractThickSlice(filter, plane);
+    CPPUNIT_ASSERT_EQUAL(1, filter->GetNumberOfReslicedPlanes());
+
+    // modified data
+    m_Image->Modified();
+    this->ExtractThickSlice(filter, plane);
+    CPPUNIT_ASSERT(filter->GetNumberOfReslicedPlanes() > 2 * NumberOfPlanes);
+  }
+
+  void TestThinSlice()
+  {
+    auto plane = this->CreatePlane(7);
+
+    auto slicer = mitk::ExtractSliceFilter::New();
+    slicer->SetInput(m_Image);
+    slicer->SetWorldGeometry(plane);
+    slicer->SetVtkOutputRequest(true);
+    slicer->Update();
+
+    auto filter = this->CreateFilter(vtkMitkThickSlicesFilter::MIP);
+    filter->SetThickSliceNumber(0);
+    this->ExtractThickSlice(filter, plane);
+    AssertEqual(slicer->GetVtkOutput(), filter->GetVtkOutput(), "Thin slice");
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkExtractThickSliceFilter)
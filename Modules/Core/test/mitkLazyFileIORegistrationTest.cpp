@@ -0,0 +1,182 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <mitkCoreServices.h>
+#include <mitkCustomMimeType.h>
+#include <mitkIMimeTypeProvider.h>
+#include <mitkItkImageIO.h>
+#include <mitkLazyFileIORegistration.h>
+
+#include <usGetModuleContext.h>
+#include <usModuleContext.h>
+
+#include <itkImageIOBase.h>
+#include <itkObjectFactoryBase.h>
+
+#include <chrono>
+#include <memory>
+
+class mitkLazyFileIORegistrationTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLazyFileIORegistrationTestSuite);
+  MITK_TEST(TestLoadForFile);
+  MITK_TEST(TestLoadForMimeTypeAndDataType);
+  MITK_TEST(TestMimeTypeProviderLoadsRegistration);
+  MITK_TEST(TestDestructionWithdrawsRegistration);
+  MITK_TEST(TestStartupTime);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef std::chrono::steady_clock ClockType;
+
+  static double GetMilliseconds(const ClockType::time_point &start)
+  {
+    return std::chrono::duration<double, std::milli>(ClockType::now() - start).count();
+  }
+
+  // what the core module activator created on load before the registration was deferred
+  static std::vector<mitk::ItkImageIO *> CreateItkImageIOs()
+  {
+    std::vector<mitk::ItkImageIO *> result;
+    for (auto &object : itk::ObjectFactoryBase::CreateAllInstance("itkImageIOBase"))
+    {
+      auto *io = dynamic_cast<itk::ImageIOBase *>(object.GetPointer());
+      if (io != nullptr)
+      {
+        result.push_back(new mitk::ItkImageIO(io));
+      }
+    }
+    return result;
+  }
+
+  static void Delete(std::vector<mitk::ItkImageIO *> &ios)
+  {
+    for (auto io : ios)
+    {
+      delete io;
+    }
+    ios.clear();
+  }
+
+public:
+  void TestLoadForFile()
+  {
+    int numberOfLoads = 0;
+    mitk::LazyFileIORegistration registration(us::GetModuleContext(), "test", [&numberOfLoads]() { ++numberOfLoads; });
+    CPPUNIT_ASSERT_MESSAGE("Registration loaded on creation", !registration.IsLoaded());
+
+    mitk::LazyFileIORegistration::LoadForFile("/tmp/file.txt");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registration loaded for an undeclared extension", 0, numberOfLoads);
+
+    CPPUNIT_ASSERT_MESSAGE("Registration not loaded for a declared extension",
+                           mitk::LazyFileIORegistration::LoadForFile("/tmp/file.LazyTest"));
+    CPPUNIT_ASSERT_EQUAL(1, numberOfLoads);
+    CPPUNIT_ASSERT(registration.IsLoaded());
+
+    mitk::LazyFileIORegistration::LoadForFile("/tmp/file.lazytest");
+    registration.Load();
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registration loaded twice", 1, numberOfLoads);
+  }
+
+  void TestLoadForMimeTypeAndDataType()
+  {
+    int numberOfLoads = 0;
+    mitk::LazyFileIORegistration mimeTypeRegistration(
+      us::GetModuleContext(), "test", [&numberOfLoads]() { ++numberOfLoads; });
+    mitk::LazyFileIORegistration::LoadForDataType("Image");
+    mitk::LazyFileIORegistration::LoadForMimeType("application/vnd.mitk.image.nrrd");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registration loaded for undeclared types", 0, numberOfLoads);
+
+    mitk::LazyFileIORegistration::LoadForMimeType("application/vnd.mitk.lazytest");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registration not loaded for a declared mime type", 1, numberOfLoads);
+
+    mitk::LazyFileIORegistration dataTypeRegistration(
+      us::GetModuleContext(), "test", [&numberOfLoads]() { ++numberOfLoads; });
+    mitk::LazyFileIORegistration::LoadForDataType("LazyTestData");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Registration not loaded for a declared data type", 2, numberOfLoads);
+  }
+
+  void TestMimeTypeProviderLoadsRegistration()
+  {
+    mitk::CustomMimeType mimeType("application/vnd.mitk.lazytest");
+    mimeType.AddExtension("lazytest");
+    us::ServiceRegistration<mitk::CustomMimeType> mimeTypeRegistration;
+
+    mitk::LazyFileIORegistration registration(us::GetModuleContext(), "test", [&]() {
+      mimeTypeRegistration = us::GetModuleContext()->RegisterService(&mimeType);
+    });
+
+    mitk::CoreServicePointer<mitk::IMimeTypeProvider> mimeTypeProvider(mitk::CoreServices::GetMimeTypeProvider());
+    std::vector<mitk::MimeType> mimeTypes = mimeTypeProvider->GetMimeTypesForFile("/tmp/file.lazytest");
+    CPPUNIT_ASSERT_MESSAGE("Lookup did not load the registration", registration.IsLoaded());
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), mimeTypes.size());
+    CPPUNIT_ASSERT_EQUAL(mimeType.GetName(), mimeTypes.front().GetName());
+
+    mimeTypeRegistration.Unregister();
+  }
+
+  void TestDestructionWithdrawsRegistration()
+  {
+    int numberOfLoads = 0;
+    const std::size_t numberOfPendingRegistrations = mitk::LazyFileIORegistration::GetNumberOfPendingRegistrations();
+    {
+      mitk::LazyFileIORegistration registration(us::GetModuleContext(), "test", [&numberOfLoads]() { ++numberOfLoads; });
+      CPPUNIT_ASSERT_EQUAL(numberOfPendingRegistrations + 1,
+                           mitk::LazyFileIORegistration::GetNumberOfPendingRegistrations());
+    }
+    CPPUNIT_ASSERT_EQUAL(numberOfPendingRegistrations, mitk::LazyFileIORegistration::GetNumberOfPendingRegistrations());
+
+    mitk::LazyFileIORegistration::LoadForFile("/tmp/file.lazytest");
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Destroyed registration was loaded", 0, numberOfLoads);
+  }
+
+  void TestStartupTime()
+  {
+    // pending registrations of the core module would be loaded by the lookup below, too
+    mitk::LazyFileIORegistration::LoadAll();
+
+    // startup before: all ITK image IOs are created and registered while the core module loads
+    auto start = ClockType::now();
+    std::vector<mitk::ItkImageIO *> ios = CreateItkImageIOs();
+    const double eagerTime = GetMilliseconds(start);
+    const std::size_t numberOfImageIOs = ios.size();
+    Delete(ios);
+
+    // startup now: only the declarations are read, the IOs are created by the first lookup of a matching file
+    start = ClockType::now();
+    std::unique_ptr<mitk::LazyFileIORegistration> registration(
+      new mitk::LazyFileIORegistration(us::GetModuleContext(), "itk", [&ios]() { ios = CreateItkImageIOs(); }));
+    const double lazyTime = GetMilliseconds(start);
+
+    start = ClockType::now();
+    mitk::LazyFileIORegistration::LoadForFile("/tmp/image.nrrd");
+    const double firstUseTime = GetMilliseconds(start);
+
+    MITK_INFO << "Registration of " << numberOfImageIOs << " ITK image IOs: " << eagerTime << " ms on startup, "
+              << "deferred: " << lazyTime << " ms on startup and " << firstUseTime << " ms on first use";
+
+    CPPUNIT_ASSERT_MESSAGE("Lookup did not create the image IOs", registration->IsLoaded());
+    CPPUNIT_ASSERT_EQUAL(numberOfImageIOs, ios.size());
+
+    registration.reset();
+    Delete(ios);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLazyFileIORegistration)
@@ -0,0 +1,185 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+// Testing
+#include "mitkTestFixture.h"
+#include <mitkTestingMacros.h>
+
+// MITK includes
+#include <mitkPolyDataPlaneCutter.h>
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCutter.h>
+#include <vtkMath.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkStripper.h>
+
+#include <cmath>
+
+class mitkPolyDataPlaneCutterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPolyDataPlaneCutterTestSuite);
+  MITK_TEST(Cut_Sphere_EqualsVtkCutter);
+  MITK_TEST(Cut_TriangleStrips_EqualsVtkCutter);
+  MITK_TEST(Cut_AxisAlignedPlane_TestsFewTriangles);
+  MITK_TEST(SetInput_ModifiedInput_Rebuilds);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  vtkSmartPointer<vtkPolyData> m_Sphere;
+
+  static double GetLength(vtkPolyData *polyData)
+  {
+    double length = 0.0;
+    vtkIdType numberOfPoints;
+    vtkIdType *ids(nullptr);
+    vtkCellArray *lines = polyData->GetLines();
+    for (lines->InitTraversal(); lines->GetNextCell(numberOfPoints, ids);)
+    {
+      for (vtkIdType i = 0; i + 1 < numberOfPoints; ++i)
+      {
+        double a[3], b[3];
+        polyData->GetPoint(ids[i], a);
+        polyData->GetPoint(ids[i + 1], b);
+        length += std::sqrt(vtkMath::Distance2BetweenPoints(a, b));
+      }
+    }
+    return length;
+  }
+
+  static vtkSmartPointer<vtkPolyData> CutWithVtkCutter(vtkPolyData *input, const double normal[3], double offset)
+  {
+    auto plane = vtkSmartPointer<vtkPlane>::New();
+    plane->SetNormal(normal[0], normal[1], normal[2]);
+    plane->SetOrigin(offset * normal[0], offset * normal[1], offset * normal[2]);
+
+    auto cutter = vtkSmartPointer<vtkCutter>::New();
+    cutter->SetCutFunction(plane);
+    cutter->SetInputData(input);
+    cutter->Update();
+    return cutter->GetOutput();
+  }
+
+  void AssertEqualsVtkCutter(vtkPolyData *input, const double normal[3], double offset)
+  {
+    mitk::PolyDataPlaneCutter planeCutter;
+    planeCutter.SetInput(input);
+    CPPUNIT_ASSERT_MESSAGE("Surface can be cut", planeCutter.CanCut());
+
+    auto cut = vtkSmartPointer<vtkPolyData>::New();
+    planeCutter.Cut(normal, offset, cut);
+    vtkSmartPointer<vtkPolyData> expected = CutWithVtkCutter(input, normal, offset);
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of contour segments", expected->GetNumberOfLines(), cut->GetNumberOfLines());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of contour points", expected->GetNumberOfPoints(), cut->GetNumberOfPoints());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Length of the contour", GetLength(expected), GetLength(cut), 1e-6);
+    CPPUNIT_ASSERT_MESSAGE("Normals are interpolated",
+                           cut->GetPointData()->GetNormals() != nullptr || input->GetPointData()->GetNormals() == nullptr);
+
+    // all contour points lie on the plane
+    for (vtkIdType i = 0; i < cut->GetNumberOfPoints(); ++i)
+    {
+      double x[3];
+      cut->GetPoint(i, x);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Contour point on the plane", offset, vtkMath::Dot(normal, x), 1e-9);
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    auto sphereSource = vtkSmartPointer<vtkSphereSource>::New();
+    sphereSource->SetRadius(10.0);
+    sphereSource->SetThetaResolution(60);
+    sphereSource->SetPhiResolution(60);
+    sphereSource->Update();
+    m_Sphere = sphereSource->GetOutput();
+  }
+
+  void tearDown() override { m_Sphere = nullptr; }
+
+  void Cut_Sphere_EqualsVtkCutter()
+  {
+    double normal[3] = {0.3, -0.5, 0.8};
+    vtkMath::Normalize(normal);
+    AssertEqualsVtkCutter(m_Sphere, normal, 2.71);
+
+    const double axial[3] = {0.0, 0.0, 1.0};
+    AssertEqualsVtkCutter(m_Sphere, axial, -4.2);
+  }
+
+  void Cut_TriangleStrips_EqualsVtkCutter()
+  {
+    auto stripper = vtkSmartPointer<vtkStripper>::New();
+    stripper->SetInputData(m_Sphere);
+    stripper->Update();
+    CPPUNIT_ASSERT_MESSAGE("Test surface has triangle strips", stripper->GetOutput()->GetNumberOfStrips() > 0);
+
+    double normal[3] = {-0.2, 0.9, 0.1};
+    vtkMath::Normalize(normal);
+    AssertEqualsVtkCutter(stripper->GetOutput(), normal, 1.3);
+  }
+
+  void Cut_AxisAlignedPlane_TestsFewTriangles()
+  {
+    mitk::PolyDataPlaneCutter planeCutter;
+    planeCutter.SetInput(m_Sphere);
+
+    const double normal[3] = {1.0, 0.0, 0.0};
+    auto cut = vtkSmartPointer<vtkPolyData>::New();
+    planeCutter.Cut(normal, 0.5, cut);
+
+    CPPUNIT_ASSERT_MESSAGE("Contour found", cut->GetNumberOfLines() > 0);
+    CPPUNIT_ASSERT_MESSAGE("Cutting tests only triangles close to the plane",
+                           planeCutter.GetNumberOfTestedTriangles() < m_Sphere->GetNumberOfPolys() / 4);
+
+    planeCutter.Cut(normal, 20.0, cut);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Plane outside of the surface", vtkIdType(0), cut->GetNumberOfLines());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Plane outside of the surface", vtkIdType(0), planeCutter.GetNumberOfTestedTriangles());
+  }
+
+  void SetInput_ModifiedInput_Rebuilds()
+  {
+    auto surface = vtkSmartPointer<vtkPolyData>::New();
+    surface->DeepCopy(m_Sphere);
+
+    mitk::PolyDataPlaneCutter planeCutter;
+    planeCutter.SetInput(surface);
+
+    // move the sphere by 5 along x
+    for (vtkIdType i = 0; i < surface->GetNumberOfPoints(); ++i)
+    {
+      double x[3];
+      surface->GetPoint(i, x);
+      x[0] += 5.0;
+      surface->GetPoints()->SetPoint(i, x);
+    }
+    surface->GetPoints()->Modified();
+    surface->Modified();
+    planeCutter.SetInput(surface);
+
+    const double normal[3] = {1.0, 0.0, 0.0};
+    auto cut = vtkSmartPointer<vtkPolyData>::New();
+    planeCutter.Cut(normal, 12.0, cut);
+    CPPUNIT_ASSERT_MESSAGE("Contour of the moved surface", cut->GetNumberOfLines() > 0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPolyDataPlaneCutter)
@@ -0,0 +1,242 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <vtkMitkLevelWindowFilter.h>
+
+#include <vtkColorTransferFunction.h>
+#include <vtkImageData.h>
+#include <vtkLookupTable.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkSmartPointer.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+class vtkMitkLevelWindowFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(vtkMitkLevelWindowFilterTestSuite);
+  MITK_TEST(TestLookupTableOnShortImage);
+  MITK_TEST(TestTransferFunctionOnShortImage);
+  MITK_TEST(TestLookupTableOnFloatImage);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static const int Width = 40;
+  static const int Height = 30;
+
+  vtkSmartPointer<vtkLookupTable> m_LookupTable;
+  double m_ClippingBounds[4];
+
+  template <class T>
+  static vtkSmartPointer<vtkImageData> CreateImage(int scalarType)
+  {
+    auto image = vtkSmartPointer<vtkImageData>::New();
+    image->SetDimensions(Width, Height, 1);
+    image->AllocateScalars(scalarType, 1);
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> values(-1000, 3000);
+    auto *pixels = static_cast<T *>(image->GetScalarPointer());
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+    {
+      pixels[i] = static_cast<T>(values(generator));
+    }
+    return image;
+  }
+
+  vtkImageData *ApplyLevelWindow(vtkMitkLevelWindowFilter *filter, vtkImageData *image)
+  {
+    filter->SetInputData(image);
+    filter->SetClippingBounds(m_ClippingBounds);
+    filter->Update();
+    return filter->GetOutput();
+  }
+
+  bool IsClipped(int x, int y) const
+  {
+    return x < m_ClippingBounds[0] || x >= m_ClippingBounds[1] || y < m_ClippingBounds[2] ||
+           y >= m_ClippingBounds[3];
+  }
+
+  // color of vtkMitkLevelWindowFilter for a vtkLookupTable with linear scale
+  const unsigned char *MapValue(double value)
+  {
+    double tableRange[2];
+    m_LookupTable->GetTableRange(tableRange);
+    const int maxIndex = m_LookupTable->GetNumberOfColors() - 1;
+    const float scale = (maxIndex + 1) / (tableRange[1] - tableRange[0]);
+    const float bias = -tableRange[0] * scale + 0.5f;
+    int idx = static_cast<int>(static_cast<float>(value) * scale + bias);
+    idx = std::max(0, std::min(maxIndex, idx));
+    return m_LookupTable->GetPointer(idx);
+  }
+
+public:
+  void setUp() override
+  {
+    m_LookupTable = vtkSmartPointer<vtkLookupTable>::New();
+    m_LookupTable->SetTableRange(0.0, 1000.0);
+    m_LookupTable->SetSaturationRange(0.0, 0.0);
+    m_LookupTable->SetValueRange(0.0, 1.0);
+    m_LookupTable->Build();
+
+    // clip a border of the slice
+    m_ClippingBounds[0] = 3;
+    m_ClippingBounds[1] = Width - 5;
+    m_ClippingBounds[2] = 2;
+    m_ClippingBounds[3] = Height - 4;
+  }
+
+  void tearDown() override { m_LookupTable = nullptr; }
+
+  void TestLookupTableOnShortImage()
+  {
+    auto image = CreateImage<short>(VTK_SHORT);
+    auto filter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
+    filter->SetLookupTable(m_LookupTable);
+
+    // the second update reuses the color table, the third one is after a change of the level window
+    for (int run = 0; run < 3; ++run)
+    {
+      if (run == 2)
+      {
+        m_LookupTable->SetTableRange(-200.0, 2500.0);
+        m_LookupTable->Build();
+      }
+
+      vtkImageData *output = this->ApplyLevelWindow(filter, image);
+      const auto *pixels = static_cast<const short *>(image->GetScalarPointer());
+      const auto *colors = static_cast<const unsigned char *>(output->GetScalarPointer());
+      for (int y = 0; y < Height; ++y)
+      {
+        for (int x = 0; x < Width; ++x, ++pixels, colors += 4)
+        {
+          const unsigned char transparent[4] = {0, 0, 0, 0};
+          const unsigned char *expected = this->IsClipped(x, y) ? transparent : this->MapValue(*pixels);
+          for (int c = 0; c < 4; ++c)
+          {
+            CPPUNIT_ASSERT_EQUAL(static_cast<int>(expected[c]), static_cast<int>(colors[c]));
+          }
+        }
+      }
+    }
+  }
+
+  void TestTransferFunctionOnShortImage()
+  {
+    auto transferFunction = vtkSmartPointer<vtkColorTransferFunction>::New();
+    transferFunction->AddRGBPoint(-500.0, 0.0, 0.0, 1.0);
+    transferFunction->AddRGBPoint(500.0, 1.0, 0.0, 0.0);
+    transferFunction->AddRGBPoint(2000.0, 1.0, 1.0, 0.5);
+    auto opacityFunction = vtkSmartPointer<vtkPiecewiseFunction>::New();
+    opacityFunction->AddPoint(-1000.0, 0.0);
+    opacityFunction->AddPoint(3000.0, 1.0);
+
+    auto image = CreateImage<short>(VTK_SHORT);
+    auto filter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
+    filter->SetLookupTable(transferFunction);
+    filter->SetOpacityPiecewiseFunction(opacityFunction);
+
+    vtkImageData *output = this->ApplyLevelWindow(filter, image);
+    const auto *pixels = static_cast<const short *>(image->GetScalarPointer());
+    const auto *colors = static_cast<const unsigned char *>(output->GetScalarPointer());
+    for (int y = 0; y < Height; ++y)
+    {
+      for (int x = 0; x < Width; ++x, ++pixels, colors += 4)
+      {
+        double rgba[4] = {0, 0, 0, 0};
+        if (!this->IsClipped(x, y))
+        {
+          transferFunction->GetColor(*pixels, rgba);
+          rgba[3] = opacityFunction->GetValue(*pixels);
+        }
+        for (int c = 0; c < 4; ++c)
+        {
+          const int expected = this->IsClipped(x, y) ? 0 : static_cast<unsigned char>(255.0 * rgba[c] + 0.5);
+          CPPUNIT_ASSERT_EQUAL(expected, static_cast<int>(colors[c]));
+        }
+      }
+    }
+  }
+
+  void TestLookupTableOnFloatImage()
+  {
+    auto image = CreateImage<float>(VTK_FLOAT);
+    auto *pixels = static_cast<float *>(image->GetScalarPointer());
+    pixels[Width * 10 + 10] = std::nanf("");
+    for (vtkIdType i = 0; i < image->GetNumberOfPoints(); ++i)
+    {
+      pixels[i] += 0.25f;
+    }
+
+    auto filter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
+    filter->SetLookupTable(m_LookupTable);
+    this->AssertFloatColors(image, this->ApplyLevelWindow(filter, image));
+
+    // a narrow window (CT soft tissue like) must not be quantized coarser because of an outlier
+    pixels[Width * 12 + 20] = 1.0e6f;
+    pixels[Width * 13 + 20] = -1.0e6f;
+    m_LookupTable->SetTableRange(1000.0, 1080.0);
+    m_LookupTable->Build();
+    this->AssertFloatColors(image, this->ApplyLevelWindow(filter, image));
+
+    // more colors than quantization steps are mapped per pixel
+    m_LookupTable->SetNumberOfColors(8192);
+    m_LookupTable->SetTableRange(0.0, 3000.0);
+    m_LookupTable->Build();
+    this->AssertFloatColors(image, this->ApplyLevelWindow(filter, image));
+  }
+
+private:
+  // the colors of floating point images are quantized, they may differ by one from the exact color
+  void AssertFloatColors(vtkImageData *image, vtkImageData *output)
+  {
+    const auto *pixels = static_cast<const float *>(image->GetScalarPointer());
+    const auto *colors = static_cast<const unsigned char *>(output->GetScalarPointer());
+    for (int y = 0; y < Height; ++y)
+    {
+      for (int x = 0; x < Width; ++x, ++pixels, colors += 4)
+      {
+        if (this->IsClipped(x, y))
+        {
+          CPPUNIT_ASSERT_EQUAL(0, colors[0] + colors[1] + colors[2] + colors[3]);
+        }
+        else if (std::isnan(*pixels))
+        {
+          const unsigned char *expected = m_LookupTable->MapValue(*pixels);
+          for (int c = 0; c < 4; ++c)
+          {
+            CPPUNIT_ASSERT_EQUAL(static_cast<int>(expected[c]), static_cast<int>(colors[c]));
+          }
+        }
+        else
+        {
+          const unsigned char *expected = this->MapValue(*pixels);
+          for (int c = 0; c < 4; ++c)
+          {
+            CPPUNIT_ASSERT(std::abs(static_cast<int>(expected[c]) - static_cast<int>(colors[c])) <= 1);
+          }
+        }
+      }
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(vtkMitkLevelWindowFilter)
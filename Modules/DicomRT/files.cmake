@@ -7,6 +7,7 @@ SET(CPP_FILES
   mitkIsoDoseLevelSetProperty.cpp
   mitkIsoDoseLevelVectorProperty.cpp
   mitkDoseImageVtkMapper2D.cpp
+  mitkIsoDoseLineExtraction.cpp
   mitkIsoLevelsGenerator.cpp
   mitkDoseNodeHelper.cpp
 )
@@ -25,12 +25,17 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkBaseRenderer.h"
 #include "mitkVtkMapper.h"
 #include "mitkExtractSliceFilter.h"
+#include "mitkIsoDoseLineExtraction.h"
 
 //VTK
 #include <vtkSmartPointer.h>
 #include <vtkPropAssembly.h>
 #include <vtkCellArray.h>
 
+#include <future>
+#include <list>
+#include <memory>
+
 class vtkActor;
 class vtkPolyDataMapper;
 class vtkPlaneSource;
@@ -114,6 +119,12 @@ namespace mitk {
   * If the modality-property is set for an image, the mapper uses modality-specific default properties,
   * e.g. color maps, if they are defined.
 
+  * The iso dose lines of all visible iso dose levels and free iso values are extracted in a single pass over
+  * the resliced dose slice (see ExtractIsoDoseLines()). The extraction runs on a worker thread, the lines of
+  * the previous slice are shown until it is done. The lines are cached per slice geometry and dose values and
+  * shared by all render windows, so going back to a slice shows its lines immediately. While iso dose lines
+  * are pending the mapper is LOD enabled: the high resolution rendering after the interaction waits for them.
+
   * \ingroup Mapper
   */
   class MITKDICOMRT_EXPORT DoseImageVtkMapper2D : public VtkMapper
@@ -139,6 +150,24 @@ namespace mitk {
     //### end of methods of MITK-VTK rendering pipeline
 
 
+    /** \brief Iso dose lines of one slice, one segment vector per dose value */
+    typedef std::vector<IsoDoseLineSegmentVector> IsoDoseLines;
+    typedef std::shared_ptr<const IsoDoseLines> IsoDoseLinesConstPointer;
+
+    /** \brief Identifies the geometry, data and reslicing parameters of a slice and the dose values of its iso
+    * dose lines. */
+    typedef std::vector<double> IsoDoseLinesKey;
+
+    /** \brief Copy of a dose slice whose iso dose lines are extracted on a worker thread */
+    struct IsoDoseLinesRequest
+    {
+      IsoDoseLinesKey Key;
+      std::vector<float> Slice;
+      int Width;
+      int Height;
+      std::vector<double> DoseValues;
+    };
+
     /** \brief Internal class holding the mapper, actor, etc. for each of the 3 2D render windows */
     /**
     * To render transveral, coronal, and sagittal, the mapper is called three times.
@@ -183,6 +212,18 @@ namespace mitk {
       For instance, if you zoom or pann, there is no need to recompute the contour. */
       vtkSmartPointer<vtkPolyData> m_OutlinePolyData;
 
+      /** \brief Key, colors (3 per dose value) and pixel index of the first pixel of the iso dose lines which
+      belong to the current slice. */
+      IsoDoseLinesKey m_IsoDoseLinesKey;
+      std::vector<unsigned char> m_IsoDoseLineColors;
+      int m_IsoDoseLinesOrigin[2];
+      /** \brief Extraction of iso dose lines running on a worker thread */
+      std::future<IsoDoseLinesConstPointer> m_IsoDoseLinesJob;
+      IsoDoseLinesKey m_IsoDoseLinesJobKey;
+      /** \brief Latest slice whose iso dose lines are requested while a job is running. Replaced by newer
+      requests, so scrolling through many slices does not queue up jobs. */
+      std::unique_ptr<IsoDoseLinesRequest> m_QueuedIsoDoseLinesRequest;
+
       /** \brief Timestamp of last update of stored data. */
       itk::TimeStamp m_LastUpdateTime;
 
@@ -196,6 +237,9 @@ namespace mitk {
       LocalStorage();
       /** \brief Default deconstructor of the local storage. */
       ~LocalStorage() override;
+
+      LocalStorage(const LocalStorage &) = delete;
+      LocalStorage &operator=(const LocalStorage &) = delete;
     };
 
     /** \brief The LocalStorageHandler holds all (three) LocalStorages for the three 2D render windows. */
@@ -212,6 +256,10 @@ namespace mitk {
     */
     void ApplyRenderingMode(mitk::BaseRenderer *renderer);
 
+    /** \brief Returns true while iso dose lines are extracted for the renderer, so that the high resolution
+    * rendering pass shows them. */
+    bool IsLODEnabled(mitk::BaseRenderer *renderer) const override;
+
   protected:
     /** \brief Transforms the actor to the actual position in 3D.
     *   \param renderer The current renderer corresponding to the render window.
@@ -235,11 +283,11 @@ namespace mitk {
     */
     void GeneratePlane(mitk::BaseRenderer* renderer, double planeBounds[6]);
 
-    /** \brief Generates a vtkPolyData object containing the outline of a given binary slice.
+    /** \brief Generates a vtkPolyData object containing the iso dose lines of the current slice.
     \param renderer: Pointer to the renderer containing the needed information
-    \note This code is based on code from the iil library.
+    \param isoDoseLines: Lines of the dose values of the current slice, see LocalStorage::m_IsoDoseLinesKey
     */
-    vtkSmartPointer<vtkPolyData> CreateOutlinePolyData(mitk::BaseRenderer* renderer);
+    vtkSmartPointer<vtkPolyData> CreateOutlinePolyData(mitk::BaseRenderer* renderer, const IsoDoseLines& isoDoseLines);
 
     /** Default constructor */
     DoseImageVtkMapper2D();
@@ -304,7 +352,24 @@ namespace mitk {
     bool RenderingGeometryIntersectsImage( const PlaneGeometry* renderingGeometry, SlicedGeometry3D* imageGeometry );
 
   private:
-    void CreateLevelOutline(mitk::BaseRenderer* renderer, const mitk::IsoDoseLevel* level, float pref, vtkSmartPointer<vtkPoints> points, vtkSmartPointer<vtkCellArray> lines,  vtkSmartPointer<vtkUnsignedCharArray> colors);
+    /** \brief Shows the iso dose lines of the current slice, from the cache or extracted on a worker thread.
+    \param sliceKey: Identifies the geometry, data and reslicing parameters of the current slice
+    \param wait: Extract the lines right away instead of on a worker thread */
+    void UpdateIsoDoseLines(mitk::BaseRenderer* renderer, const IsoDoseLinesKey& sliceKey, bool wait);
+
+    /** \brief Caches the lines of a finished job and shows them if they belong to the current slice. Starts the
+    queued request afterwards. If wait is true, all pending lines are extracted before returning. */
+    void CollectIsoDoseLines(mitk::BaseRenderer* renderer, bool wait);
+
+    void StartIsoDoseLinesJob(LocalStorage* localStorage, std::unique_ptr<IsoDoseLinesRequest> request);
+
+    void ShowIsoDoseLines(mitk::BaseRenderer* renderer, const IsoDoseLines& isoDoseLines);
+
+    IsoDoseLinesConstPointer GetCachedIsoDoseLines(const IsoDoseLinesKey& key);
+    void CacheIsoDoseLines(const IsoDoseLinesKey& key, const IsoDoseLinesConstPointer& isoDoseLines);
+
+    /** \brief Iso dose lines of recently shown slices, most recently used first */
+    std::list<std::pair<IsoDoseLinesKey, IsoDoseLinesConstPointer>> m_IsoDoseLinesCache;
 
   };
 
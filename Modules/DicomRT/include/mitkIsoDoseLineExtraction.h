@@ -0,0 +1,50 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#ifndef __ISO_DOSE_LINE_EXTRACTION_H
+#define __ISO_DOSE_LINE_EXTRACTION_H
+
+#include "MitkDicomRTExports.h"
+
+#include <vector>
+
+namespace mitk
+{
+  /** Edge of a pixel, from the pixel corner (X, Y) to (X + 1, Y) if it is horizontal, else to (X, Y + 1).
+  The corner (0, 0) is the lower left corner of the first pixel of the slice.*/
+  struct IsoDoseLineSegment
+  {
+    int X;
+    int Y;
+    bool Horizontal;
+  };
+
+  typedef std::vector<IsoDoseLineSegment> IsoDoseLineSegmentVector;
+
+  /**Extracts the iso dose lines of all given dose values from a 2D dose slice in a single pass.
+  The iso dose line of a dose value runs along the pixel edges between a pixel with at least this dose and a
+  pixel with a lower dose or the border of the slice. Each pixel edge is visited once; the dose values crossed by
+  it are looked up in the sorted dose values, instead of one pass over the slice per dose value.
+  @param slice Dose values of the slice, row by row
+  @return The segments of each dose value, in the order of doseValues.*/
+  std::vector<IsoDoseLineSegmentVector> MITKDICOMRT_EXPORT ExtractIsoDoseLines(const float* slice,
+    int width,
+    int height,
+    const std::vector<double>& doseValues);
+}
+
+#endif
@@ -29,6 +29,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPlaneGeometry.h>
 #include <mitkProperties.h>
 #include <mitkRTConstants.h>
+#include <mitkRenderingManager.h>
 #include <mitkRenderingModeProperty.h>
 #include <mitkResliceMethodProperty.h>
 #include <mitkTransferFunctionProperty.h>
@@ -62,6 +63,15 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include <itkRGBAPixel.h>
 
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+  // number of slices whose iso dose lines are kept, e.g. for scrolling back and forth
+  const std::size_t MaximumNumberOfCachedIsoDoseLines = 64;
+}
+
 mitk::DoseImageVtkMapper2D::DoseImageVtkMapper2D()
 {
 }
@@ -149,6 +159,8 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
     // see bug-13275
     localStorage->m_ReslicedImage = nullptr;
     localStorage->m_Mapper->SetInputData(localStorage->m_EmptyPolyData);
+    localStorage->m_IsoDoseLinesKey.clear();
+    localStorage->m_QueuedIsoDoseLinesRequest.reset();
     return;
   }
 
@@ -168,6 +180,7 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
 
   // Initialize the interpolation mode for resampling; switch to nearest
   // neighbor if the input image is too small.
+  ExtractSliceFilter::ResliceInterpolation resliceInterpolation = ExtractSliceFilter::RESLICE_NEAREST;
   if ((input->GetDimension() >= 3) && (input->GetDimension(2) > 1))
   {
     VtkResliceInterpolationProperty *resliceInterpolationProperty;
@@ -182,20 +195,17 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
     switch (interpolationMode)
     {
       case VTK_RESLICE_NEAREST:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_NEAREST;
         break;
       case VTK_RESLICE_LINEAR:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_LINEAR);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_LINEAR;
         break;
       case VTK_RESLICE_CUBIC:
-        localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_CUBIC);
+        resliceInterpolation = ExtractSliceFilter::RESLICE_CUBIC;
         break;
     }
   }
-  else
-  {
-    localStorage->m_Reslicer->SetInterpolationMode(ExtractSliceFilter::RESLICE_NEAREST);
-  }
+  localStorage->m_Reslicer->SetInterpolationMode(resliceInterpolation);
 
   // set the vtk output property to true, makes sure that no unneeded mitk image convertion
   // is done.
@@ -331,8 +341,30 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
 
   if (showIsoLines) // contour rendering
   {
+    // everything the resliced slice depends on, to find its iso dose lines in the cache
+    IsoDoseLinesKey sliceKey;
+    vtkMatrix4x4 *resliceAxes = localStorage->m_Reslicer->GetResliceAxes();
+    for (int i = 0; i < 4; ++i)
+    {
+      for (int j = 0; j < 4; ++j)
+      {
+        sliceKey.push_back(resliceAxes->GetElement(i, j));
+      }
+    }
+    sliceKey.push_back(localStorage->m_mmPerPixel[0]);
+    sliceKey.push_back(localStorage->m_mmPerPixel[1]);
+    int *extent = localStorage->m_ReslicedImage->GetExtent();
+    sliceKey.insert(sliceKey.end(), extent, extent + 6);
+    sliceKey.push_back(input->GetPipelineMTime());
+    sliceKey.push_back(input->GetTimeGeometry()->GetGeometryForTimeStep(this->GetTimestep())->GetMTime());
+    sliceKey.push_back(this->GetTimestep());
+    sliceKey.push_back(resliceInterpolation);
+    sliceKey.push_back(thickSlicesMode);
+    sliceKey.push_back(thickSlicesNum);
+
     // generate contours/outlines
-    localStorage->m_OutlinePolyData = CreateOutlinePolyData(renderer);
+    bool isHighResolutionPass = renderer->GetRenderingManager()->GetNextLOD(renderer) > 0;
+    this->UpdateIsoDoseLines(renderer, sliceKey, isHighResolutionPass);
 
     float binaryOutlineWidth(1.0);
     if (datanode->GetFloatProperty("outline width", binaryOutlineWidth, renderer))
@@ -354,6 +386,8 @@ void mitk::DoseImageVtkMapper2D::GenerateDataForRenderer(mitk::BaseRenderer *ren
   {
     localStorage->m_ReslicedImage = nullptr;
     localStorage->m_Mapper->SetInputData(localStorage->m_EmptyPolyData);
+    localStorage->m_IsoDoseLinesKey.clear();
+    localStorage->m_QueuedIsoDoseLinesRequest.reset();
     return;
   }
 
@@ -646,6 +680,10 @@ void mitk::DoseImageVtkMapper2D::Update(mitk::BaseRenderer *renderer)
   data->UpdateOutputInformation();
   LocalStorage *localStorage = m_LSH.GetLocalStorage(renderer);
 
+  // show iso dose lines which were extracted since the last rendering; the high resolution pass after an
+  // interaction waits for them
+  this->CollectIsoDoseLines(renderer, renderer->GetRenderingManager()->GetNextLOD(renderer) > 0);
+
   // check if something important has changed and we need to rerender
   if ((localStorage->m_LastUpdateTime < node->GetMTime()) // was the node modified?
       ||
@@ -846,17 +884,76 @@ mitk::DoseImageVtkMapper2D::LocalStorage *mitk::DoseImageVtkMapper2D::GetLocalSt
   return m_LSH.GetLocalStorage(renderer);
 }
 
-vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(mitk::BaseRenderer *renderer)
+vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(mitk::BaseRenderer *renderer,
+                                                                              const IsoDoseLines &isoDoseLines)
 {
+  LocalStorage *localStorage = this->GetLocalStorage(renderer);
+
   vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();      // the points to draw
   vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New(); // the lines to connect the points
   vtkSmartPointer<vtkUnsignedCharArray> colors = vtkSmartPointer<vtkUnsignedCharArray>::New();
   colors->SetNumberOfComponents(3);
   colors->SetName("Colors");
 
+  // get the depth for each contour
+  float depth = CalculateLayerDepth(renderer);
+
+  // the lines of the dose values are added one after the other, so that the lines of later dose values are drawn on
+  // top of coinciding lines of earlier ones
+  for (std::size_t level = 0; level < isoDoseLines.size(); ++level)
+  {
+    const unsigned char *colorLine = &localStorage->m_IsoDoseLineColors[3 * level];
+
+    for (const IsoDoseLineSegment &segment : isoDoseLines[level])
+    {
+      int x = localStorage->m_IsoDoseLinesOrigin[0] + segment.X; // pixel index x
+      int y = localStorage->m_IsoDoseLinesOrigin[1] + segment.Y; // pixel index y
+
+      // add the 2 points
+      vtkIdType p1 =
+        points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
+      vtkIdType p2 =
+        segment.Horizontal
+          ? points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth)
+          : points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
+      // add the line between both points
+      lines->InsertNextCell(2);
+      lines->InsertCellPoint(p1);
+      lines->InsertCellPoint(p2);
+      colors->InsertNextTypedTuple(colorLine);
+    }
+  }
+
+  // Create a polydata to store everything in
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  // Add the points to the dataset
+  polyData->SetPoints(points);
+  // Add the lines to the dataset
+  polyData->SetLines(lines);
+  polyData->GetCellData()->SetScalars(colors);
+  return polyData;
+}
+
+void mitk::DoseImageVtkMapper2D::UpdateIsoDoseLines(mitk::BaseRenderer *renderer,
+                                                    const IsoDoseLinesKey &sliceKey,
+                                                    bool wait)
+{
+  LocalStorage *localStorage = this->GetLocalStorage(renderer);
+
   float pref;
   this->GetDataNode()->GetFloatProperty(mitk::RTConstants::REFERENCE_DOSE_PROPERTY_NAME.c_str(), pref);
 
+  // dose values and colors of all visible levels, in the order in which their lines are drawn
+  std::vector<double> doseValues;
+  std::vector<unsigned char> colors;
+  auto addLevel = [&](const mitk::IsoDoseLevel *level) {
+    doseValues.push_back(level->GetDoseValue() * pref);
+    mitk::IsoDoseLevel::ColorType isoColor = level->GetColor();
+    colors.push_back(static_cast<unsigned char>(isoColor.GetRed() * 255));
+    colors.push_back(static_cast<unsigned char>(isoColor.GetGreen() * 255));
+    colors.push_back(static_cast<unsigned char>(isoColor.GetBlue() * 255));
+  };
+
   mitk::IsoDoseLevelSetProperty::Pointer propIsoSet = dynamic_cast<mitk::IsoDoseLevelSetProperty *>(
     GetDataNode()->GetProperty(mitk::RTConstants::DOSE_ISO_LEVELS_PROPERTY_NAME.c_str()));
   mitk::IsoDoseLevelSet::Pointer isoDoseLevelSet = propIsoSet->GetValue();
@@ -866,7 +963,7 @@ vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(m
   {
     if (doseIT->GetVisibleIsoLine())
     {
-      this->CreateLevelOutline(renderer, &(doseIT.Value()), pref, points, lines, colors);
+      addLevel(&(doseIT.Value()));
     } // end of if visible dose value
   }   // end of loop over all does values
 
@@ -880,189 +977,162 @@ vtkSmartPointer<vtkPolyData> mitk::DoseImageVtkMapper2D::CreateOutlinePolyData(m
   {
     if (freeDoseIT->Value()->GetVisibleIsoLine())
     {
-      this->CreateLevelOutline(renderer, freeDoseIT->Value(), pref, points, lines, colors);
+      addLevel(freeDoseIT->Value());
     } // end of if visible dose value
   }   // end of loop over all does values
 
-  // Create a polydata to store everything in
-  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
-  // Add the points to the dataset
-  polyData->SetPoints(points);
-  // Add the lines to the dataset
-  polyData->SetLines(lines);
-  polyData->GetCellData()->SetScalars(colors);
-  return polyData;
-}
-
-void mitk::DoseImageVtkMapper2D::CreateLevelOutline(mitk::BaseRenderer *renderer,
-                                                    const mitk::IsoDoseLevel *level,
-                                                    float pref,
-                                                    vtkSmartPointer<vtkPoints> points,
-                                                    vtkSmartPointer<vtkCellArray> lines,
-                                                    vtkSmartPointer<vtkUnsignedCharArray> colors)
-{
-  LocalStorage *localStorage = this->GetLocalStorage(renderer);
+  IsoDoseLinesKey key = sliceKey;
+  key.insert(key.end(), doseValues.begin(), doseValues.end());
 
-  // get the min and max index values of each direction
   int *extent = localStorage->m_ReslicedImage->GetExtent();
-  int xMin = extent[0];
-  int xMax = extent[1];
-  int yMin = extent[2];
-  int yMax = extent[3];
+  localStorage->m_IsoDoseLinesKey = key;
+  localStorage->m_IsoDoseLineColors = colors;
+  localStorage->m_IsoDoseLinesOrigin[0] = extent[0];
+  localStorage->m_IsoDoseLinesOrigin[1] = extent[2];
 
-  int *dims = localStorage->m_ReslicedImage->GetDimensions(); // dimensions of the image
-  int line = dims[0];                                         // how many pixels per line?
-  // get the depth for each contour
-  float depth = CalculateLayerDepth(renderer);
-
-  double doseValue = level->GetDoseValue() * pref;
-  mitk::IsoDoseLevel::ColorType isoColor = level->GetColor();
-  unsigned char colorLine[3] = {static_cast<unsigned char>(isoColor.GetRed() * 255),
-                                static_cast<unsigned char>(isoColor.GetGreen() * 255),
-                                static_cast<unsigned char>(isoColor.GetBlue() * 255)};
+  IsoDoseLinesConstPointer isoDoseLines = this->GetCachedIsoDoseLines(key);
+  if (isoDoseLines)
+  {
+    localStorage->m_QueuedIsoDoseLinesRequest.reset();
+    this->ShowIsoDoseLines(renderer, *isoDoseLines);
+    return;
+  }
 
-  int x = xMin; // pixel index x
-  int y = yMin; // pixel index y
-  float *currentPixel;
+  if (localStorage->m_IsoDoseLinesJob.valid() && localStorage->m_IsoDoseLinesJobKey == key)
+  {
+    // the lines of this slice are extracted already
+    localStorage->m_QueuedIsoDoseLinesRequest.reset();
+    if (wait)
+    {
+      this->CollectIsoDoseLines(renderer, true);
+    }
+    return;
+  }
 
-  // We take the pointer to the first pixel of the image
-  currentPixel = static_cast<float *>(localStorage->m_ReslicedImage->GetScalarPointer());
+  // the resliced image is reused for the next slice, the worker thread gets a copy
+  const float *slice = static_cast<const float *>(localStorage->m_ReslicedImage->GetScalarPointer());
+  if (!slice)
+  {
+    mitkThrow() << "resliced dose image has no scalars";
+  }
 
-  if (!currentPixel){
-    mitkThrow() << "currentPixel invalid";
+  int *dims = localStorage->m_ReslicedImage->GetDimensions(); // dimensions of the image
+  std::unique_ptr<IsoDoseLinesRequest> request(new IsoDoseLinesRequest);
+  request->Key = key;
+  request->Width = dims[0];
+  request->Height = dims[1];
+  request->Slice.assign(slice, slice + dims[0] * dims[1]);
+  request->DoseValues = doseValues;
+
+  if (wait)
+  {
+    localStorage->m_QueuedIsoDoseLinesRequest.reset();
+    isoDoseLines = std::make_shared<IsoDoseLines>(
+      ExtractIsoDoseLines(request->Slice.data(), request->Width, request->Height, request->DoseValues));
+    this->CacheIsoDoseLines(key, isoDoseLines);
+    this->ShowIsoDoseLines(renderer, *isoDoseLines);
+  }
+  else if (localStorage->m_IsoDoseLinesJob.valid())
+  {
+    // the lines of the previous slice stay visible until the running job and this one are done
+    localStorage->m_QueuedIsoDoseLinesRequest = std::move(request);
+  }
+  else
+  {
+    this->StartIsoDoseLinesJob(localStorage, std::move(request));
   }
+}
+
+void mitk::DoseImageVtkMapper2D::CollectIsoDoseLines(mitk::BaseRenderer *renderer, bool wait)
+{
+  LocalStorage *localStorage = this->GetLocalStorage(renderer);
 
-  while (y <= yMax)
+  while (localStorage->m_IsoDoseLinesJob.valid())
   {
-    // if the current pixel value is set to something
-    if ((currentPixel) && (*currentPixel >= doseValue))
+    if (!wait && localStorage->m_IsoDoseLinesJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
     {
-      // check in which direction a line is necessary
-      // a line is added if the neighbor of the current pixel has the value 0
-      // and if the pixel is located at the edge of the image
-
-      // if   vvvvv  not the first line vvvvv
-      if (y > yMin && *(currentPixel - line) < doseValue)
-      { // x direction - bottom edge of the pixel
-        // add the 2 points
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        // add the line between both points
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
-
-      // if   vvvvv  not the last line vvvvv
-      if (y < yMax && *(currentPixel + line) < doseValue)
-      { // x direction - top edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+      return;
+    }
 
-      // if   vvvvv  not the first pixel vvvvv
-      if ((x > xMin || y > yMin) && *(currentPixel - 1) < doseValue)
-      { // y direction - left edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+    IsoDoseLinesConstPointer isoDoseLines = localStorage->m_IsoDoseLinesJob.get();
+    this->CacheIsoDoseLines(localStorage->m_IsoDoseLinesJobKey, isoDoseLines);
+    if (localStorage->m_IsoDoseLinesJobKey == localStorage->m_IsoDoseLinesKey)
+    {
+      this->ShowIsoDoseLines(renderer, *isoDoseLines);
+    }
 
-      // if   vvvvv  not the last pixel vvvvv
-      if ((y < yMax || (x < xMax)) && *(currentPixel + 1) < doseValue)
-      { // y direction - right edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
+    if (localStorage->m_QueuedIsoDoseLinesRequest)
+    {
+      std::unique_ptr<IsoDoseLinesRequest> request = std::move(localStorage->m_QueuedIsoDoseLinesRequest);
+      isoDoseLines = this->GetCachedIsoDoseLines(request->Key);
+      if (!isoDoseLines)
+      {
+        this->StartIsoDoseLinesJob(localStorage, std::move(request));
       }
-
-      /*  now consider pixels at the edge of the image  */
-
-      // if   vvvvv  left edge of image vvvvv
-      if (x == xMin)
-      { // draw left edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
+      else if (request->Key == localStorage->m_IsoDoseLinesKey)
+      {
+        this->ShowIsoDoseLines(renderer, *isoDoseLines);
       }
+    }
+  }
+}
 
-      // if   vvvvv  right edge of image vvvvv
-      if (x == xMax)
-      { // draw right edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+void mitk::DoseImageVtkMapper2D::StartIsoDoseLinesJob(LocalStorage *localStorage,
+                                                      std::unique_ptr<IsoDoseLinesRequest> request)
+{
+  localStorage->m_IsoDoseLinesJobKey = request->Key;
+
+  // the job only uses its copy of the slice, it never touches the mapper
+  std::shared_ptr<const IsoDoseLinesRequest> job(std::move(request));
+  localStorage->m_IsoDoseLinesJob = std::async(std::launch::async, [job]() {
+    return IsoDoseLinesConstPointer(std::make_shared<IsoDoseLines>(
+      ExtractIsoDoseLines(job->Slice.data(), job->Width, job->Height, job->DoseValues)));
+  });
+}
 
-      // if   vvvvv  bottom edge of image vvvvv
-      if (y == yMin)
-      { // draw bottom edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 =
-          points->InsertNextPoint((x + 1) * localStorage->m_mmPerPixel[0], y * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
+void mitk::DoseImageVtkMapper2D::ShowIsoDoseLines(mitk::BaseRenderer *renderer, const IsoDoseLines &isoDoseLines)
+{
+  LocalStorage *localStorage = this->GetLocalStorage(renderer);
+  localStorage->m_OutlinePolyData = this->CreateOutlinePolyData(renderer, isoDoseLines);
+  localStorage->m_Mapper->SetInputData(localStorage->m_OutlinePolyData);
+}
 
-      // if   vvvvv  top edge of image vvvvv
-      if (y == yMax)
-      { // draw top edge of the pixel
-        vtkIdType p1 =
-          points->InsertNextPoint(x * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        vtkIdType p2 = points->InsertNextPoint(
-          (x + 1) * localStorage->m_mmPerPixel[0], (y + 1) * localStorage->m_mmPerPixel[1], depth);
-        lines->InsertNextCell(2);
-        lines->InsertCellPoint(p1);
-        lines->InsertCellPoint(p2);
-        colors->InsertNextTypedTuple(colorLine);
-      }
-    } // end if currentpixel is set
+mitk::DoseImageVtkMapper2D::IsoDoseLinesConstPointer mitk::DoseImageVtkMapper2D::GetCachedIsoDoseLines(
+  const IsoDoseLinesKey &key)
+{
+  for (auto it = m_IsoDoseLinesCache.begin(); it != m_IsoDoseLinesCache.end(); ++it)
+  {
+    if (it->first == key)
+    {
+      // most recently used first
+      m_IsoDoseLinesCache.splice(m_IsoDoseLinesCache.begin(), m_IsoDoseLinesCache, it);
+      return it->second;
+    }
+  }
+  return nullptr;
+}
 
-    x++;
+void mitk::DoseImageVtkMapper2D::CacheIsoDoseLines(const IsoDoseLinesKey &key,
+                                                   const IsoDoseLinesConstPointer &isoDoseLines)
+{
+  if (this->GetCachedIsoDoseLines(key))
+  {
+    m_IsoDoseLinesCache.front().second = isoDoseLines;
+    return;
+  }
 
-    if (x > xMax)
-    { // reached end of line
-      x = xMin;
-      y++;
-    }
+  m_IsoDoseLinesCache.emplace_front(key, isoDoseLines);
+  if (m_IsoDoseLinesCache.size() > MaximumNumberOfCachedIsoDoseLines)
+  {
+    m_IsoDoseLinesCache.pop_back();
+  }
+}
 
-    // Increase the pointer-position to the next pixel.
-    // This is safe, as the while-loop and the x-reset logic above makes
-    // sure we do not exceed the bounds of the image
-    currentPixel++;
-  } // end of while
+bool mitk::DoseImageVtkMapper2D::IsLODEnabled(mitk::BaseRenderer *renderer) const
+{
+  // the local storage is created on demand, which does not change the state of the mapper
+  LocalStorage *localStorage = const_cast<Self *>(this)->m_LSH.GetLocalStorage(renderer);
+  return localStorage->m_IsoDoseLinesJob.valid() || localStorage->m_QueuedIsoDoseLinesRequest != nullptr;
 }
 
 void mitk::DoseImageVtkMapper2D::TransformActor(mitk::BaseRenderer *renderer)
@@ -1121,6 +1191,9 @@ mitk::DoseImageVtkMapper2D::LocalStorage::~LocalStorage()
 mitk::DoseImageVtkMapper2D::LocalStorage::LocalStorage()
   : m_VectorComponentExtractor(vtkSmartPointer<vtkImageExtractComponents>::New())
 {
+  m_IsoDoseLinesOrigin[0] = 0;
+  m_IsoDoseLinesOrigin[1] = 0;
+
   m_LevelWindowFilter = vtkSmartPointer<vtkMitkLevelWindowFilter>::New();
 
   // Do as much actions as possible in here to avoid double executions.
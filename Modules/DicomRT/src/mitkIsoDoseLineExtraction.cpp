@@ -0,0 +1,116 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+
+#include "mitkIsoDoseLineExtraction.h"
+
+#include <algorithm>
+#include <cmath>
+
+std::vector<mitk::IsoDoseLineSegmentVector> mitk::ExtractIsoDoseLines(const float* slice,
+  int width,
+  int height,
+  const std::vector<double>& doseValues)
+{
+  std::vector<IsoDoseLineSegmentVector> result(doseValues.size());
+  if (slice == nullptr || width <= 0 || height <= 0 || doseValues.empty())
+  {
+    return result;
+  }
+
+  std::vector<std::size_t> order(doseValues.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(),
+    [&doseValues](std::size_t a, std::size_t b) { return doseValues[a] < doseValues[b]; });
+
+  std::vector<double> sortedValues(doseValues.size());
+  for (std::size_t i = 0; i < order.size(); ++i)
+  {
+    sortedValues[i] = doseValues[order[i]];
+  }
+
+  // adds the segment to the lines of all dose values in [first, last)
+  auto addSegment = [&](std::vector<double>::const_iterator first, std::vector<double>::const_iterator last,
+    int x, int y, bool horizontal)
+  {
+    const IsoDoseLineSegment segment = { x, y, horizontal };
+    for (auto it = first; it != last; ++it)
+    {
+      result[order[it - sortedValues.cbegin()]].push_back(segment);
+    }
+  };
+
+  // an edge between two pixels belongs to the lines of all dose values in (lower value, higher value]
+  auto addInnerSegment = [&](double value, double neighborValue, int x, int y, bool horizontal)
+  {
+    if (std::isnan(neighborValue) || value == neighborValue)
+    {
+      return;
+    }
+    auto first = std::upper_bound(sortedValues.cbegin(), sortedValues.cend(), std::min(value, neighborValue));
+    auto last = std::upper_bound(first, sortedValues.cend(), std::max(value, neighborValue));
+    addSegment(first, last, x, y, horizontal);
+  };
+
+  const float* pixel = slice;
+  for (int y = 0; y < height; ++y)
+  {
+    for (int x = 0; x < width; ++x, ++pixel)
+    {
+      const double value = *pixel;
+      if (std::isnan(value))
+      {
+        continue;
+      }
+
+      if (x + 1 < width)
+      { // right edge of the pixel
+        addInnerSegment(value, *(pixel + 1), x + 1, y, false);
+      }
+      if (y + 1 < height)
+      { // top edge of the pixel
+        addInnerSegment(value, *(pixel + width), x, y + 1, true);
+      }
+
+      // at the border of the slice the lines of all dose values up to the value of the pixel are closed
+      if (x == 0 || x + 1 == width || y == 0 || y + 1 == height)
+      {
+        auto last = std::upper_bound(sortedValues.cbegin(), sortedValues.cend(), value);
+        if (x == 0)
+        {
+          addSegment(sortedValues.cbegin(), last, x, y, false);
+        }
+        if (x + 1 == width)
+        {
+          addSegment(sortedValues.cbegin(), last, x + 1, y, false);
+        }
+        if (y == 0)
+        {
+          addSegment(sortedValues.cbegin(), last, x, y, true);
+        }
+        if (y + 1 == height)
+        {
+          addSegment(sortedValues.cbegin(), last, x, y + 1, true);
+        }
+      }
+    }
+  }
+
+  return result;
+}
@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include "mitkIsoDoseLineExtraction.h"
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <set>
+#include <tuple>
+
+class mitkIsoDoseLineExtractionTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkIsoDoseLineExtractionTestSuite);
+  MITK_TEST(TestSinglePixel);
+  MITK_TEST(TestLevelsAreIndependent);
+  MITK_TEST(TestRandomSlices);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef std::set<std::tuple<int, int, bool>> SegmentSet;
+
+  static SegmentSet ToSet(const mitk::IsoDoseLineSegmentVector& segments)
+  {
+    SegmentSet result;
+    for (const auto& segment : segments)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Segment extracted twice",
+        result.insert(std::make_tuple(segment.X, segment.Y, segment.Horizontal)).second);
+    }
+    return result;
+  }
+
+  // outline of one dose value, pixel by pixel as the mapper did it before
+  static SegmentSet ExtractReference(const std::vector<float>& slice, int width, int height, double doseValue)
+  {
+    SegmentSet result;
+    for (int y = 0; y < height; ++y)
+    {
+      for (int x = 0; x < width; ++x)
+      {
+        const float* pixel = &slice[y * width + x];
+        if (!(*pixel >= doseValue))
+        {
+          continue;
+        }
+        if (y == 0 || *(pixel - width) < doseValue)
+        { // bottom edge of the pixel
+          result.insert(std::make_tuple(x, y, true));
+        }
+        if (y == height - 1 || *(pixel + width) < doseValue)
+        { // top edge of the pixel
+          result.insert(std::make_tuple(x, y + 1, true));
+        }
+        if (x == 0 || *(pixel - 1) < doseValue)
+        { // left edge of the pixel
+          result.insert(std::make_tuple(x, y, false));
+        }
+        if (x == width - 1 || *(pixel + 1) < doseValue)
+        { // right edge of the pixel
+          result.insert(std::make_tuple(x + 1, y, false));
+        }
+      }
+    }
+    return result;
+  }
+
+public:
+  void TestSinglePixel()
+  {
+    const float slice[] = { 0.f, 0.f, 0.f,
+                            0.f, 5.f, 0.f,
+                            0.f, 0.f, 0.f };
+    std::vector<double> doseValues = { 1.0 };
+    auto lines = mitk::ExtractIsoDoseLines(slice, 3, 3, doseValues);
+
+    CPPUNIT_ASSERT_EQUAL(std::size_t(1), lines.size());
+    SegmentSet expected = { std::make_tuple(1, 1, true), std::make_tuple(1, 2, true),
+                            std::make_tuple(1, 1, false), std::make_tuple(2, 1, false) };
+    CPPUNIT_ASSERT(expected == ToSet(lines[0]));
+  }
+
+  void TestLevelsAreIndependent()
+  {
+    const float slice[] = { 1.f, 2.f, 3.f, 4.f };
+    // unsorted, with a duplicate and a value above all doses
+    std::vector<double> doseValues = { 3.0, 1.5, 3.0, 10.0, 1.0 };
+    auto lines = mitk::ExtractIsoDoseLines(slice, 4, 1, doseValues);
+
+    CPPUNIT_ASSERT_EQUAL(doseValues.size(), lines.size());
+    std::vector<float> sliceVector(slice, slice + 4);
+    for (std::size_t i = 0; i < doseValues.size(); ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Wrong lines for dose value " + std::to_string(doseValues[i]),
+        ExtractReference(sliceVector, 4, 1, doseValues[i]) == ToSet(lines[i]));
+    }
+    CPPUNIT_ASSERT(lines[3].empty());
+  }
+
+  void TestRandomSlices()
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<float> dose(0.f, 70.f);
+    std::uniform_int_distribution<int> size(1, 40);
+
+    std::vector<double> doseValues;
+    for (int i = 1; i <= 15; ++i)
+    {
+      doseValues.push_back(70.0 * i / 16);
+    }
+
+    for (int run = 0; run < 20; ++run)
+    {
+      const int width = size(generator);
+      const int height = size(generator);
+      std::vector<float> slice(width * height);
+      for (auto& value : slice)
+      {
+        // plateaus with exactly the dose of a level and missing values
+        value = run % 2 == 0 ? dose(generator) : static_cast<float>(doseValues[static_cast<int>(dose(generator)) % 15]);
+        if (dose(generator) < 2.f)
+        {
+          value = std::numeric_limits<float>::quiet_NaN();
+        }
+      }
+
+      auto lines = mitk::ExtractIsoDoseLines(slice.data(), width, height, doseValues);
+      CPPUNIT_ASSERT_EQUAL(doseValues.size(), lines.size());
+      for (std::size_t i = 0; i < doseValues.size(); ++i)
+      {
+        CPPUNIT_ASSERT(ExtractReference(slice, width, height, doseValues[i]) == ToSet(lines[i]));
+      }
+    }
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIsoDoseLineExtraction)
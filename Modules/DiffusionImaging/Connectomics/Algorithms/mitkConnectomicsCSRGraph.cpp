@@ -0,0 +1,442 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkConnectomicsCSRGraph.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+#include <omp.h>
+
+mitk::ConnectomicsCSRGraph::ConnectomicsCSRGraph( const NetworkType& network )
+  : m_NumberOfVertices( boost::num_vertices( network ) )
+  , m_NumberOfEdges( boost::num_edges( network ) )
+{
+  // edges are identified by the address of their bundled property, which is shared by the
+  // descriptors returned from boost::edges and boost::out_edges
+  std::unordered_map< const mitk::ConnectomicsNetwork::NetworkEdge*, unsigned int > edgeIndex;
+  edgeIndex.reserve( m_NumberOfEdges );
+
+  boost::graph_traits<NetworkType>::edge_iterator edgeIter, edgeEnd;
+  unsigned int index( 0 );
+  for( boost::tie( edgeIter, edgeEnd ) = boost::edges( network ); edgeIter != edgeEnd; ++edgeIter, ++index )
+  {
+    edgeIndex[ &network[ *edgeIter ] ] = index;
+  }
+
+  m_RowStart.resize( m_NumberOfVertices + 1, 0 );
+  for( unsigned int vertex( 0 ); vertex < m_NumberOfVertices; ++vertex )
+  {
+    m_RowStart[ vertex + 1 ] = m_RowStart[ vertex ] + boost::out_degree( vertex, network );
+  }
+
+  const unsigned int numberOfEntries = m_RowStart[ m_NumberOfVertices ];
+  m_Neighbors.resize( numberOfEntries );
+  m_EdgeIndices.resize( numberOfEntries );
+  m_EdgeWeights.resize( numberOfEntries );
+
+  for( unsigned int vertex( 0 ); vertex < m_NumberOfVertices; ++vertex )
+  {
+    unsigned int entry = m_RowStart[ vertex ];
+
+    boost::graph_traits<NetworkType>::out_edge_iterator outIter, outEnd;
+    for( boost::tie( outIter, outEnd ) = boost::out_edges( vertex, network ); outIter != outEnd; ++outIter, ++entry )
+    {
+      const mitk::ConnectomicsNetwork::NetworkEdge& edge = network[ *outIter ];
+      m_Neighbors[ entry ] = boost::target( *outIter, network );
+      m_EdgeIndices[ entry ] = edgeIndex[ &edge ];
+      m_EdgeWeights[ entry ] = edge.edge_weight;
+    }
+  }
+}
+
+void mitk::ConnectomicsCSRGraph::BreadthFirstSearch( unsigned int source, std::vector< int >& distances, std::vector< unsigned int >& order ) const
+{
+  order.clear();
+  order.push_back( source );
+  distances[ source ] = 0;
+
+  // order doubles as the queue, head marks the next vertex to expand
+  for( std::size_t head( 0 ); head < order.size(); ++head )
+  {
+    const unsigned int vertex = order[ head ];
+    const int nextDistance = distances[ vertex ] + 1;
+
+    for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+    {
+      const unsigned int neighbor = m_Neighbors[ entry ];
+      if( distances[ neighbor ] < 0 )
+      {
+        distances[ neighbor ] = nextDistance;
+        order.push_back( neighbor );
+      }
+    }
+  }
+}
+
+void mitk::ConnectomicsCSRGraph::ResetDistances( std::vector< int >& distances, const std::vector< unsigned int >& order )
+{
+  for( unsigned int vertex : order )
+  {
+    distances[ vertex ] = -1;
+  }
+}
+
+void mitk::ConnectomicsCSRGraph::DijkstraDistances( unsigned int source, std::vector< double >& distances ) const
+{
+  typedef std::pair< double, unsigned int > QueueEntryType;
+  std::priority_queue< QueueEntryType, std::vector< QueueEntryType >, std::greater< QueueEntryType > > queue;
+
+  distances.assign( m_NumberOfVertices, std::numeric_limits< double >::max() );
+  distances[ source ] = 0.0;
+  queue.push( QueueEntryType( 0.0, source ) );
+
+  while( !queue.empty() )
+  {
+    const QueueEntryType current = queue.top();
+    queue.pop();
+
+    // stale entry, the vertex has been reached on a shorter path in the meantime
+    if( current.first > distances[ current.second ] )
+    {
+      continue;
+    }
+
+    for( unsigned int entry = m_RowStart[ current.second ]; entry < m_RowStart[ current.second + 1 ]; ++entry )
+    {
+      const unsigned int neighbor = m_Neighbors[ entry ];
+      const double candidate = current.first + m_EdgeWeights[ entry ];
+      if( candidate < distances[ neighbor ] )
+      {
+        distances[ neighbor ] = candidate;
+        queue.push( QueueEntryType( candidate, neighbor ) );
+      }
+    }
+  }
+}
+
+std::vector< double > mitk::ConnectomicsCSRGraph::AllPairsShortestDistances() const
+{
+  const int numberOfVertices = static_cast< int >( m_NumberOfVertices );
+  std::vector< double > result( static_cast< std::size_t >( m_NumberOfVertices ) * m_NumberOfVertices );
+
+#pragma omp parallel
+  {
+    std::vector< double > distances;
+
+#pragma omp for schedule(dynamic, 16)
+    for( int source = 0; source < numberOfVertices; ++source )
+    {
+      DijkstraDistances( source, distances );
+      std::copy( distances.begin(), distances.end(), result.begin() + static_cast< std::size_t >( source ) * m_NumberOfVertices );
+    }
+  }
+
+  return result;
+}
+
+void mitk::ConnectomicsCSRGraph::ComputeBetweennessCentrality( std::vector< double >& vertexCentrality, std::vector< double >* edgeCentrality, bool weighted ) const
+{
+  const int numberOfVertices = static_cast< int >( m_NumberOfVertices );
+  const int numberOfThreads = omp_get_max_threads();
+
+  std::vector< std::vector< double > > threadVertexCentrality( numberOfThreads );
+  std::vector< std::vector< double > > threadEdgeCentrality( numberOfThreads );
+
+#pragma omp parallel
+  {
+    const int thread = omp_get_thread_num();
+    std::vector< double >& localVertex = threadVertexCentrality[ thread ];
+    std::vector< double >& localEdge = threadEdgeCentrality[ thread ];
+    localVertex.assign( m_NumberOfVertices, 0.0 );
+    if( edgeCentrality != nullptr )
+    {
+      localEdge.assign( m_NumberOfEdges, 0.0 );
+    }
+
+    // per source work arrays, only the entries of reached vertices are reset after each source
+    std::vector< int > hops( m_NumberOfVertices, -1 );
+    std::vector< double > distances( m_NumberOfVertices, std::numeric_limits< double >::max() );
+    std::vector< int > rank( m_NumberOfVertices, -1 );
+    std::vector< double > sigma( m_NumberOfVertices, 0.0 );
+    std::vector< double > delta( m_NumberOfVertices, 0.0 );
+    std::vector< unsigned int > order;
+    order.reserve( m_NumberOfVertices );
+
+    typedef std::pair< double, unsigned int > QueueEntryType;
+
+#pragma omp for schedule(dynamic, 8)
+    for( int source = 0; source < numberOfVertices; ++source )
+    {
+      sigma[ source ] = 1.0;
+
+      if( !weighted )
+      {
+        BreadthFirstSearch( source, hops, order );
+        for( unsigned int vertex : order )
+        {
+          const int nextHop = hops[ vertex ] + 1;
+          for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+          {
+            if( hops[ m_Neighbors[ entry ] ] == nextHop )
+            {
+              sigma[ m_Neighbors[ entry ] ] += sigma[ vertex ];
+            }
+          }
+        }
+      }
+      else
+      {
+        // settled vertices are appended to order, rank stores their position
+        std::priority_queue< QueueEntryType, std::vector< QueueEntryType >, std::greater< QueueEntryType > > queue;
+        order.clear();
+        distances[ source ] = 0.0;
+        queue.push( QueueEntryType( 0.0, source ) );
+
+        while( !queue.empty() )
+        {
+          const QueueEntryType current = queue.top();
+          queue.pop();
+          const unsigned int vertex = current.second;
+          if( rank[ vertex ] >= 0 || current.first > distances[ vertex ] )
+          {
+            continue;
+          }
+          rank[ vertex ] = static_cast< int >( order.size() );
+          order.push_back( vertex );
+
+          for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+          {
+            const unsigned int neighbor = m_Neighbors[ entry ];
+            if( rank[ neighbor ] >= 0 )
+            {
+              continue;
+            }
+            const double candidate = distances[ vertex ] + m_EdgeWeights[ entry ];
+            if( candidate < distances[ neighbor ] )
+            {
+              distances[ neighbor ] = candidate;
+              sigma[ neighbor ] = sigma[ vertex ];
+              queue.push( QueueEntryType( candidate, neighbor ) );
+            }
+            else if( candidate == distances[ neighbor ] )
+            {
+              sigma[ neighbor ] += sigma[ vertex ];
+            }
+          }
+        }
+      }
+
+      // accumulate dependencies in order of non-increasing distance from the source
+      for( std::size_t position = order.size(); position-- > 1; )
+      {
+        const unsigned int vertex = order[ position ];
+        const double factorBase = 1.0 + delta[ vertex ];
+
+        for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+        {
+          const unsigned int predecessor = m_Neighbors[ entry ];
+          bool isPredecessor( false );
+          if( !weighted )
+          {
+            isPredecessor = hops[ predecessor ] >= 0 && hops[ predecessor ] + 1 == hops[ vertex ];
+          }
+          else
+          {
+            isPredecessor = rank[ predecessor ] >= 0 && rank[ predecessor ] < rank[ vertex ]
+              && distances[ predecessor ] + m_EdgeWeights[ entry ] == distances[ vertex ];
+          }
+
+          if( isPredecessor )
+          {
+            const double factor = ( sigma[ predecessor ] / sigma[ vertex ] ) * factorBase;
+            delta[ predecessor ] += factor;
+            if( edgeCentrality != nullptr )
+            {
+              localEdge[ m_EdgeIndices[ entry ] ] += factor;
+            }
+          }
+        }
+        localVertex[ vertex ] += delta[ vertex ];
+      }
+
+      for( unsigned int vertex : order )
+      {
+        hops[ vertex ] = -1;
+        distances[ vertex ] = std::numeric_limits< double >::max();
+        rank[ vertex ] = -1;
+        sigma[ vertex ] = 0.0;
+        delta[ vertex ] = 0.0;
+      }
+    }
+  }
+
+  // undirected graph, every path has been counted from both of its ends
+  vertexCentrality.assign( m_NumberOfVertices, 0.0 );
+  for( int thread( 0 ); thread < numberOfThreads; ++thread )
+  {
+    if( threadVertexCentrality[ thread ].empty() )
+    {
+      continue;
+    }
+    for( unsigned int vertex( 0 ); vertex < m_NumberOfVertices; ++vertex )
+    {
+      vertexCentrality[ vertex ] += threadVertexCentrality[ thread ][ vertex ];
+    }
+  }
+  for( double& value : vertexCentrality )
+  {
+    value /= 2.0;
+  }
+
+  if( edgeCentrality != nullptr )
+  {
+    edgeCentrality->assign( m_NumberOfEdges, 0.0 );
+    for( int thread( 0 ); thread < numberOfThreads; ++thread )
+    {
+      if( threadEdgeCentrality[ thread ].empty() )
+      {
+        continue;
+      }
+      for( unsigned int edge( 0 ); edge < m_NumberOfEdges; ++edge )
+      {
+        ( *edgeCentrality )[ edge ] += threadEdgeCentrality[ thread ][ edge ];
+      }
+    }
+    for( double& value : *edgeCentrality )
+    {
+      value /= 2.0;
+    }
+  }
+}
+
+std::vector< double > mitk::ConnectomicsCSRGraph::ComputeLocalClusteringCoefficients() const
+{
+  const int numberOfVertices = static_cast< int >( m_NumberOfVertices );
+  std::vector< double > coefficients( m_NumberOfVertices, 0.0 );
+
+#pragma omp parallel
+  {
+    // multiplicity[n] is valid while member[n] == vertex + 1, seen[] deduplicates the neighbours of a neighbour
+    std::vector< unsigned int > member( m_NumberOfVertices, 0 );
+    std::vector< unsigned int > multiplicity( m_NumberOfVertices, 0 );
+    std::vector< unsigned long long > seen( m_NumberOfVertices, 0 );
+    std::vector< unsigned int > distinct;
+    unsigned long long stamp( 0 );
+
+#pragma omp for schedule(dynamic, 64)
+    for( int vertex = 0; vertex < numberOfVertices; ++vertex )
+    {
+      const unsigned long long degree = GetDegree( vertex );
+      const unsigned long long routes = degree > 1 ? degree * ( degree - 1 ) / 2 : 0;
+      if( routes == 0 )
+      {
+        continue;
+      }
+
+      const unsigned int tag = static_cast< unsigned int >( vertex ) + 1;
+      distinct.clear();
+      for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+      {
+        const unsigned int neighbor = m_Neighbors[ entry ];
+        if( member[ neighbor ] != tag )
+        {
+          member[ neighbor ] = tag;
+          multiplicity[ neighbor ] = 0;
+          distinct.push_back( neighbor );
+        }
+        ++multiplicity[ neighbor ];
+      }
+
+      // boost counts every pair of adjacency entries whose targets are connected
+      unsigned long long triangles( 0 );
+      for( unsigned int first : distinct )
+      {
+        ++stamp;
+        for( unsigned int entry = m_RowStart[ first ]; entry < m_RowStart[ first + 1 ]; ++entry )
+        {
+          const unsigned int second = m_Neighbors[ entry ];
+          if( member[ second ] != tag || seen[ second ] == stamp )
+          {
+            continue;
+          }
+          seen[ second ] = stamp;
+
+          if( first < second )
+          {
+            triangles += static_cast< unsigned long long >( multiplicity[ first ] ) * multiplicity[ second ];
+          }
+          else if( first == second )
+          {
+            triangles += static_cast< unsigned long long >( multiplicity[ first ] ) * ( multiplicity[ first ] - 1 ) / 2;
+          }
+        }
+      }
+
+      coefficients[ vertex ] = static_cast< double >( triangles ) / routes;
+    }
+  }
+
+  return coefficients;
+}
+
+void mitk::ConnectomicsCSRGraph::ComputeNeighborhoodEdgeCounts( std::vector< unsigned int >& numberOfNeighbors, std::vector< unsigned int >& neighborhoodEdges ) const
+{
+  const int numberOfVertices = static_cast< int >( m_NumberOfVertices );
+  numberOfNeighbors.assign( m_NumberOfVertices, 0 );
+  neighborhoodEdges.assign( m_NumberOfVertices, 0 );
+
+#pragma omp parallel
+  {
+    std::vector< unsigned int > member( m_NumberOfVertices, 0 );
+    std::vector< unsigned int > distinct;
+
+#pragma omp for schedule(dynamic, 64)
+    for( int vertex = 0; vertex < numberOfVertices; ++vertex )
+    {
+      const unsigned int tag = static_cast< unsigned int >( vertex ) + 1;
+      distinct.clear();
+      for( unsigned int entry = m_RowStart[ vertex ]; entry < m_RowStart[ vertex + 1 ]; ++entry )
+      {
+        const unsigned int neighbor = m_Neighbors[ entry ];
+        if( member[ neighbor ] != tag )
+        {
+          member[ neighbor ] = tag;
+          distinct.push_back( neighbor );
+        }
+      }
+
+      unsigned int count( 0 );
+      for( unsigned int neighbor : distinct )
+      {
+        for( unsigned int entry = m_RowStart[ neighbor ]; entry < m_RowStart[ neighbor + 1 ]; ++entry )
+        {
+          if( member[ m_Neighbors[ entry ] ] == tag )
+          {
+            ++count;
+          }
+        }
+      }
+
+      numberOfNeighbors[ vertex ] = static_cast< unsigned int >( distinct.size() );
+      neighborhoodEdges[ vertex ] = count / 2;
+    }
+  }
+}
@@ -0,0 +1,110 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkConnectomicsCSRGraph_h
+#define mitkConnectomicsCSRGraph_h
+
+#include <MitkConnectomicsExports.h>
+
+#include <mitkConnectomicsNetwork.h>
+
+#include <vector>
+
+namespace mitk
+{
+  /**
+  * \brief Compressed sparse row snapshot of a connectomics network
+  *
+  * The adjacency of the boost graph is flattened into three contiguous arrays: the neighbours of vertex v are
+  * stored at positions RowStart[v] ... RowStart[v+1]-1 of the neighbour array, in the order of boost::out_edges.
+  * For every entry the index of the corresponding edge (in the order of boost::edges) and its edge_weight are
+  * stored alongside, so edge based results can be reported in the order used by the boost based code.
+  *
+  * Vertices are addressed by their vertex descriptor, which for the vecS based network type is 0 ... N-1.
+  * The snapshot does not follow later changes of the network, see ConnectomicsNetwork::GetCSRGraph().
+  *
+  * All per source computations (breadth first searches, Dijkstra, Brandes) are distributed over OpenMP threads,
+  * each thread using its own work arrays. Only the final summation of the per thread betweenness accumulators
+  * depends on the number of threads, up to floating point rounding.
+  */
+  class MITKCONNECTOMICS_EXPORT ConnectomicsCSRGraph
+  {
+  public:
+
+    typedef mitk::ConnectomicsNetwork::NetworkType NetworkType;
+
+    explicit ConnectomicsCSRGraph( const NetworkType& network );
+
+    unsigned int GetNumberOfVertices() const { return m_NumberOfVertices; }
+    unsigned int GetNumberOfEdges() const { return m_NumberOfEdges; }
+
+    /** Number of adjacency entries of a vertex, equals boost::out_degree */
+    unsigned int GetDegree( unsigned int vertex ) const { return m_RowStart[ vertex + 1 ] - m_RowStart[ vertex ]; }
+
+    const std::vector< unsigned int >& GetRowStart() const { return m_RowStart; }
+    const std::vector< unsigned int >& GetNeighbors() const { return m_Neighbors; }
+    const std::vector< unsigned int >& GetEdgeIndices() const { return m_EdgeIndices; }
+    const std::vector< double >& GetEdgeWeights() const { return m_EdgeWeights; }
+
+    /** \brief Unweighted breadth first search from source
+    *
+    * distances has to be of size N and filled with -1 on entry; on return it holds the hop distance of every
+    * reached vertex. order receives the reached vertices in visiting order, starting with the source. Call
+    * ResetDistances() to prepare distances for the next search in O(reached) instead of O(N).
+    */
+    void BreadthFirstSearch( unsigned int source, std::vector< int >& distances, std::vector< unsigned int >& order ) const;
+
+    /** Set the distances of all vertices in order back to -1 */
+    static void ResetDistances( std::vector< int >& distances, const std::vector< unsigned int >& order );
+
+    /** Weighted shortest path distances (edge_weight) from source, unreachable vertices get std::numeric_limits<double>::max() */
+    void DijkstraDistances( unsigned int source, std::vector< double >& distances ) const;
+
+    /** Weighted shortest path distances between all pairs, row major N x N */
+    std::vector< double > AllPairsShortestDistances() const;
+
+    /** \brief Brandes betweenness centrality
+    *
+    * Matches boost::brandes_betweenness_centrality for the undirected network type, including the division by two
+    * and the handling of parallel edges. If weighted is true, edge_weight is used as edge length. edgeCentrality may
+    * be nullptr if only vertex centralities are needed.
+    */
+    void ComputeBetweennessCentrality( std::vector< double >& vertexCentrality, std::vector< double >* edgeCentrality, bool weighted = false ) const;
+
+    /** Local clustering coefficients per vertex descriptor, matching boost::clustering_coefficient */
+    std::vector< double > ComputeLocalClusteringCoefficients() const;
+
+    /** \brief Neighbourhood terms used by the statistics calculator
+    *
+    * numberOfNeighbors[v] is the number of distinct adjacent vertices, neighborhoodEdges[v] the number of edges between
+    * them (adjacency entries among the neighbours, halved).
+    */
+    void ComputeNeighborhoodEdgeCounts( std::vector< unsigned int >& numberOfNeighbors, std::vector< unsigned int >& neighborhoodEdges ) const;
+
+  protected:
+
+    unsigned int m_NumberOfVertices;
+    unsigned int m_NumberOfEdges;
+
+    std::vector< unsigned int > m_RowStart;
+    std::vector< unsigned int > m_Neighbors;
+    std::vector< unsigned int > m_EdgeIndices;
+    std::vector< double > m_EdgeWeights;
+  };
+
+}// end namespace mitk
+
+#endif // mitkConnectomicsCSRGraph_h
@@ -15,7 +15,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkConnectomicsNetworkThresholder.h"
-#include <mitkConnectomicsStatisticsCalculator.h>
 #include "vnl/vnl_random.h"
 
 mitk::ConnectomicsNetworkThresholder::ConnectomicsNetworkThresholder()
@@ -118,15 +117,11 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
   mitk::ConnectomicsNetwork::Pointer result = mitk::ConnectomicsNetwork::New();
   result->ImportNetwort( input );
 
-  mitk::ConnectomicsStatisticsCalculator::Pointer calculator = mitk::ConnectomicsStatisticsCalculator::New();
-
-  calculator->SetNetwork( result );
-  calculator->Update();
-
   //the random number generator
   vnl_random rng( (unsigned int) rand() );
 
-  bool notBelow( targetDensity < calculator->GetConnectionDensity() );
+  // Only edges are removed, so the density can be tracked without recalculating any network statistics
+  bool notBelow( targetDensity < result->GetConnectionDensity() );
 
   double minWeight( result->GetMaximumWeight() );
   int count( 0 );
@@ -170,11 +165,10 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
 
     boost::remove_edge( candidateVector.at( deleteNumber ), *boostGraph );
 
-    calculator->SetNetwork( result );
-    calculator->Update();
-    notBelow = targetDensity < calculator->GetConnectionDensity();
+    notBelow = targetDensity < result->GetConnectionDensity();
   }
 
+  // drops the cached snapshot and graph measures of the network
   result->UpdateIDs();
   return result;
 }
@@ -184,19 +178,12 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
   mitk::ConnectomicsNetwork::Pointer result = mitk::ConnectomicsNetwork::New();
   result->ImportNetwort( input );
 
-  mitk::ConnectomicsStatisticsCalculator::Pointer calculator = mitk::ConnectomicsStatisticsCalculator::New();
-
-  calculator->SetNetwork( result );
-  calculator->Update();
-
-  bool notBelow( targetDensity < calculator->GetConnectionDensity() );
+  bool notBelow( targetDensity < result->GetConnectionDensity() );
 
   for( int loop( 1 ); notBelow; loop++ )
   {
     result = Threshold( result, loop );
-    calculator->SetNetwork( result );
-    calculator->Update();
-    notBelow = targetDensity < calculator->GetConnectionDensity();
+    notBelow = targetDensity < result->GetConnectionDensity();
   }
 
   return result;
@@ -209,41 +196,10 @@ mitk::ConnectomicsNetwork::Pointer mitk::ConnectomicsNetworkThresholder::Thresho
 
   NetworkType* boostGraph = result->GetBoostGraph();
 
-  EdgeIteratorType iterator, end;
-
-  // set to true if iterators are invalidated by deleting an edge
-  bool edgeHasBeenRemoved( true );
-
-  // if no edge has been removed in the last loop, we are done
-  while( edgeHasBeenRemoved )
-  {
-    edgeHasBeenRemoved = false;
-    // sets iterator to start and end to end
-    boost::tie(iterator, end) = boost::edges( *boostGraph );
-
-    bool endReached( false );
-    while( !edgeHasBeenRemoved && !endReached )
-    {
-      if( iterator != end )
-      {
-        // If the edge is below the target threshold it is deleted
-        if( (*boostGraph)[ *iterator ].fiber_count < targetThreshold )
-        {
-          edgeHasBeenRemoved = true;
-          // this invalidates all iterators
-          boost::remove_edge( *iterator, *boostGraph );
-        }
-        else
-        {
-          ++iterator;
-        }
-      }
-      else
-      {
-        endReached = true;
-      }
-    }
-  }
+  // remove all edges below the target threshold in a single pass over the edge list
+  boost::remove_edge_if(
+    [ boostGraph, targetThreshold ]( EdgeDescriptorType edge ) { return (*boostGraph)[ edge ].fiber_count < targetThreshold; },
+    *boostGraph );
 
   result->UpdateIDs();
 
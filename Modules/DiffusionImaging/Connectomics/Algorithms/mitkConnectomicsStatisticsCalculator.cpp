@@ -19,49 +19,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <numeric>
 
-#include <boost/graph/clustering_coefficient.hpp>
-
 #ifdef _MSC_VER
 # pragma warning(push)
 # pragma warning(disable: 4172)
 #endif
 #include <boost/graph/connected_components.hpp>
-#include <boost/graph/betweenness_centrality.hpp>
 
 #ifdef _MSC_VER
 # pragma warning(pop)
 #endif
 
-#include <boost/graph/visitors.hpp>
-
 #include "vnl/algo/vnl_symmetric_eigensystem.h"
 
-template<typename GraphType>
-class all_pairs_shortest_recorder : public boost::default_bfs_visitor
-{
-public:
-  typedef typename boost::graph_traits<GraphType>::vertex_descriptor VertexType;
-  typedef typename boost::graph_traits<GraphType>::edge_descriptor EdgeType;
-
-  all_pairs_shortest_recorder(int* dist, int &max, unsigned int &size)
-  {
-    d = dist;
-    ecc = &max;
-    component_size = &size;
-  }
-
-  void tree_edge(EdgeType edge, const GraphType& graph) {
-    VertexType u = boost::source(edge, graph);
-    VertexType v = boost::target(edge, graph);
-    d[v] = d[u] + 1;
-    *ecc = d[v];
-    *component_size = *component_size + 1;
-  }
-private:
-  int* d;
-  int* ecc;
-  unsigned int* component_size;
-};
+#include <omp.h>
 
 mitk::ConnectomicsStatisticsCalculator::ConnectomicsStatisticsCalculator()
   : m_Network( nullptr )
@@ -130,6 +100,14 @@ mitk::ConnectomicsStatisticsCalculator::~ConnectomicsStatisticsCalculator()
 
 void mitk::ConnectomicsStatisticsCalculator::Update()
 {
+  std::shared_ptr< const mitk::ConnectomicsCSRGraph > graph = m_Network->GetCSRGraph();
+  if( graph == m_CSRGraph )
+  {
+    // the network has not been modified since the last update
+    return;
+  }
+  m_CSRGraph = graph;
+
   CalculateNumberOfVertices();
   CalculateNumberOfEdges();
   CalculateAverageDegree();
@@ -209,27 +187,33 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateRatioOfNodesInLargestCompo
 void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 {
   std::vector<int> bins( m_NumberOfVertices );
-
-  VertexIteratorType vi, vi_end;
   unsigned int index( 0 );
 
-  for( boost::tie( vi, vi_end ) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi != vi_end; ++vi)
+  const int numberOfVertices = m_NumberOfVertices;
+
+#pragma omp parallel
   {
-    std::vector<int> distances(m_NumberOfVertices, 0);
-    int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
+    // bins[d] counts the ordered vertex pairs at hop distance d
+    std::vector<int> localBins( m_NumberOfVertices, 0 );
+    std::vector<int> distances( m_NumberOfVertices, -1 );
+    std::vector<unsigned int> order;
 
-    boost::breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder< NetworkType >
-      (&distances[0], max_distance, size)));
+#pragma omp for schedule(dynamic, 16)
+    for( int src = 0; src < numberOfVertices; src++ )
+    {
+      m_CSRGraph->BreadthFirstSearch( src, distances, order );
+      for( std::size_t i = 1; i < order.size(); i++ )
+      {
+        localBins[ distances[ order[i] ] ]++;
+      }
+      mitk::ConnectomicsCSRGraph::ResetDistances( distances, order );
+    }
 
-    for(index=0; index < distances.size(); index++)
+#pragma omp critical
     {
-      if(distances[index] > 0)
+      for( std::size_t i = 0; i < localBins.size(); i++ )
       {
-        bins[distances[index]]++;
+        bins[i] += localBins[i];
       }
     }
   }
@@ -271,49 +255,25 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateHopPlotValues()
 
 void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
 {
-  VertexIteratorType vi, vi_end;
-  std::vector<double> m_VectorOfClusteringCoefficientsC;
-  std::vector<double> m_VectorOfClusteringCoefficientsD;
-  std::vector<double> m_VectorOfClusteringCoefficientsE;
-  typedef std::set<VertexDescriptorType> NeighborSetType;
-  typedef NetworkType::out_edge_iterator OutEdgeIterType;
+  m_VectorOfClusteringCoefficientsC.clear();
+  m_VectorOfClusteringCoefficientsD.clear();
+  m_VectorOfClusteringCoefficientsE.clear();
 
-  for(boost::tie(vi,vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
-  {
-    // Get the list of vertices which are in the neighborhood of vi.
-    std::pair<AdjacencyIteratorType, AdjacencyIteratorType> adjacent =
-      boost::adjacent_vertices(*vi, *(m_Network->GetBoostGraph()) );
+  // number of distinct neighbors of each vertex and number of edges between those neighbors
+  std::vector<unsigned int> numberOfNeighbors;
+  std::vector<unsigned int> neighborhoodEdgeCounts;
+  m_CSRGraph->ComputeNeighborhoodEdgeCounts( numberOfNeighbors, neighborhoodEdgeCounts );
 
-    //Populate a set with the neighbors of vi
-    NeighborSetType neighbors;
-    for(; adjacent.first!=adjacent.second; ++adjacent.first)
-    {
-      neighbors.insert(*adjacent.first);
-    }
+  for( unsigned int vertex = 0; vertex < numberOfNeighbors.size(); vertex++ )
+  {
+    const std::size_t neighbors = numberOfNeighbors[ vertex ];
+    const unsigned int neighborhood_edge_count = neighborhoodEdgeCounts[ vertex ];
 
-    // Now, count the edges between vertices in the neighborhood.
-    unsigned int neighborhood_edge_count = 0;
-    if(neighbors.size() > 0)
-    {
-      NeighborSetType::iterator iter;
-      for(iter = neighbors.begin(); iter != neighbors.end(); ++iter)
-      {
-        std::pair<OutEdgeIterType, OutEdgeIterType> oe = out_edges(*iter, *(m_Network->GetBoostGraph()) );
-        for(; oe.first != oe.second; ++oe.first)
-        {
-          if(neighbors.find(target(*oe.first, *(m_Network->GetBoostGraph()) )) != neighbors.end())
-          {
-            ++neighborhood_edge_count;
-          }
-        }
-      }
-      neighborhood_edge_count /= 2;
-    }
     //Clustering Coefficienct C,E
-    if(neighbors.size() > 1)
+    if(neighbors > 1)
     {
       double num   = neighborhood_edge_count;
-      double denum = neighbors.size() * (neighbors.size()-1)/2;
+      double denum = neighbors * (neighbors-1)/2;
       m_VectorOfClusteringCoefficientsC.push_back( num / denum);
       m_VectorOfClusteringCoefficientsE.push_back( num / denum);
     }
@@ -323,10 +283,10 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
     }
 
     //Clustering Coefficienct D
-    if(neighbors.size() > 0)
+    if(neighbors > 0)
     {
-      double num   = neighbors.size() + neighborhood_edge_count;
-      double denum = ( (neighbors.size()+1) * neighbors.size()) / 2;
+      double num   = neighbors + neighborhood_edge_count;
+      double denum = ( (neighbors+1) * neighbors) / 2;
       m_VectorOfClusteringCoefficientsD.push_back( num / denum);
     }
     else
@@ -351,10 +311,10 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateClusteringCoefficients()
 
 void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
 {
-  // std::map used for convenient initialization
-  EdgeIndexStdMapType stdEdgeIndex;
-  // associative property map needed for iterator property map-wrapper
-  EdgeIndexMapType edgeIndex(stdEdgeIndex);
+  m_CSRGraph->ComputeBetweennessCentrality( m_VectorOfVertexBetweennessCentralities, &m_VectorOfEdgeBetweennessCentralities );
+
+  // the property maps index the vectors by edge descriptor and vertex index
+  m_EdgeIndexStdMap.clear();
 
   EdgeIteratorType iterator, end;
 
@@ -364,23 +324,15 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateBetweennessCentrality()
   int i(0);
   for ( ; iterator != end; ++iterator, ++i)
   {
-    stdEdgeIndex.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
+    m_EdgeIndexStdMap.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
   }
 
-  // Define EdgeCentralityMap
-  m_VectorOfEdgeBetweennessCentralities.resize( m_NumberOfEdges, 0.0);
-  // Create the external property map
+  EdgeIndexMapType edgeIndex(m_EdgeIndexStdMap);
   m_PropertyMapOfEdgeBetweennessCentralities = EdgeIteratorPropertyMapType(m_VectorOfEdgeBetweennessCentralities.begin(), edgeIndex);
 
-  // Define VertexCentralityMap
   VertexIndexMapType vertexIndex = get(boost::vertex_index, *(m_Network->GetBoostGraph()) );
-  m_VectorOfVertexBetweennessCentralities.resize( m_NumberOfVertices, 0.0);
-  // Create the external property map
   m_PropertyMapOfVertexBetweennessCentralities = VertexIteratorPropertyMapType(m_VectorOfVertexBetweennessCentralities.begin(), vertexIndex);
 
-  boost::brandes_betweenness_centrality( *(m_Network->GetBoostGraph()),
-    m_PropertyMapOfVertexBetweennessCentralities, m_PropertyMapOfEdgeBetweennessCentralities );
-
   m_AverageVertexBetweennessCentrality = std::accumulate(m_VectorOfVertexBetweennessCentralities.begin(),
     m_VectorOfVertexBetweennessCentralities.end(),
     0.0) / (double) m_NumberOfVertices;
@@ -446,28 +398,65 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
   unsigned int giant_component_size = 0;
   VertexDescriptorType radius_src(0);
 
-  //Loop over the vertices
-  for( boost::tie(vi, vi_end) = boost::vertices( *(m_Network->GetBoostGraph()) ); vi!=vi_end; ++vi)
+  //Number of nodes discovered by the BFS starting at each node
+  std::vector<unsigned int> componentSizes( m_NumberOfVertices );
+
+  const int numberOfVertices = m_NumberOfVertices;
+
+  //Run a BFS from every vertex, the searches are independent and
+  //distributed over the threads. Every thread keeps its own distance
+  //vector, which is reset for the reached nodes only.
+#pragma omp parallel
   {
-    //We are going to start a BFS, initialize the neccessary
-    //structures for that.  Store the distances of nodes from the
-    //source in distance vector. The maximum distance is stored in
-    //max. The BFS will start from the node that vi is pointing, that
-    //is the src is *vi. We also init the distance of the src node to
-    //itself to 0. size gives the number of nodes discovered during
-    //this BFS.
-    std::vector<int> distances( m_NumberOfVertices );
-    int max_distance = 0;
-    VertexDescriptorType src = *vi;
-    distances[src] = 0;
-    unsigned int size = 0;
-
-    breadth_first_search(*(m_Network->GetBoostGraph()), src,
-      visitor(all_pairs_shortest_recorder<NetworkType>
-      (&distances[0], max_distance, size)));
-    // vertex vi has eccentricity equal to max_distance
-    m_VectorOfEccentrities[src] = max_distance;
+    std::vector<int> distances( m_NumberOfVertices, -1 );
+    std::vector<unsigned int> order;
+    std::vector<int> bucket;
+
+#pragma omp for schedule(dynamic, 16)
+    for( int src = 0; src < numberOfVertices; src++ )
+    {
+      m_CSRGraph->BreadthFirstSearch( src, distances, order );
+
+      //size gives the number of nodes discovered during this BFS, the
+      //last node discovered has the maximum distance, which is the
+      //eccentricity of src.
+      unsigned int size = order.size() - 1;
+      int max_distance = distances[ order.back() ];
+      m_VectorOfEccentrities[src] = max_distance;
+      componentSizes[src] = size;
+
+      //Calculate in how many hops we can reach 90 percent of the
+      //nodes. We store the number of hops we can reach in h hops in the
+      //bucket vector. That is bucket[h] gives the number of nodes
+      //reachable in exactly h hops. sum of bucket[i<h] gives the number
+      //of nodes that are reachable in less than h hops. We also
+      //calculate sum of the distances from this node to every single
+      //other node in the graph.
+      int reachable90 = std::ceil((double)size * 0.9);
+      bucket.assign( max_distance+1, 0 );
+      double sumOfDistances = 0.0;
+      for( std::size_t i = 1; i < order.size(); i++ )
+      {
+        bucket[ distances[ order[i] ] ]++;
+        sumOfDistances += distances[ order[i] ];
+      }
+      m_VectorOfAveragePathLengths[src] = size > 0 ? sumOfDistances / size : 0.0;
+
+      int eccentricity90 = 0;
+      while(reachable90 > 0)
+      {
+        eccentricity90 ++;
+        reachable90 = reachable90 - bucket[eccentricity90];
+      }
+      // vertex src has eccentricity90 equal to eccentricity90
+      m_VectorOfEccentrities90[src] = eccentricity90;
 
+      mitk::ConnectomicsCSRGraph::ResetDistances( distances, order );
+    }
+  }
+
+  for( unsigned int src = 0; src < m_NumberOfVertices; src++ )
+  {
     //check whether there is any change in the diameter or the radius.
     //note that the diameter we are calculating here is also the
     //diameter of the giant connected component!
@@ -475,6 +464,10 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     {
       m_Diameter = m_VectorOfEccentrities[src];
     }
+    if(m_VectorOfEccentrities90[src] > m_Diameter90)
+    {
+      m_Diameter90 = m_VectorOfEccentrities90[src];
+    }
 
     //The radius should be calculated on the largest connected
     //component, otherwise it is very likely that radius will be 1.
@@ -483,48 +476,11 @@ void mitk::ConnectomicsStatisticsCalculator::CalculateShortestPathMetrics()
     //found we should loop over this connected component and find the
     //minimum eccentricity which is the radius. So we keep the src
     //node, so that we can find the connected component later on.
-    if(size > giant_component_size)
+    if(componentSizes[src] > giant_component_size)
     {
-      giant_component_size = size;
+      giant_component_size = componentSizes[src];
       radius_src = src;
     }
-
-    //Calculate in how many hops we can reach 90 percent of the
-    //nodes. We store the number of hops we can reach in h hops in the
-    //bucket vector. That is bucket[h] gives the number of nodes
-    //reachable in exactly h hops. sum of bucket[i<h] gives the number
-    //of nodes that are reachable in less than h hops. We also
-    //calculate sum of the distances from this node to every single
-    //other node in the graph.
-    int reachable90 = std::ceil((double)size * 0.9);
-    std::vector <int> bucket (max_distance+1);
-    int counter = 0;
-    for(unsigned int i=0; i<distances.size(); i++)
-    {
-      if(distances[i]>0)
-      {
-        bucket[distances[i]]++;
-        m_VectorOfAveragePathLengths[src] += distances[i];
-        counter ++;
-      }
-    }
-    if(counter > 0)
-    {
-      m_VectorOfAveragePathLengths[src] = m_VectorOfAveragePathLengths[src] / counter;
-    }
-
-    int eccentricity90 = 0;
-    while(reachable90 > 0)
-    {
-      eccentricity90 ++;
-      reachable90 = reachable90 - bucket[eccentricity90];
-    }
-    // vertex vi has eccentricity90 equal to eccentricity90
-    m_VectorOfEccentrities90[src] = eccentricity90;
-    if(m_VectorOfEccentrities90[src] > m_Diameter90)
-    {
-      m_Diameter90 = m_VectorOfEccentrities90[src];
-    }
   }
 
   //We are going to calculate the radius now. We stored the src node
@@ -26,11 +26,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <MitkConnectomicsExports.h>
 
 #include <mitkConnectomicsNetwork.h>
+#include <mitkConnectomicsCSRGraph.h>
+
+#include <memory>
 
 namespace mitk
 {
   /**
-  * \brief A class giving functions for calculating a variety of network indices */
+  * \brief A class giving functions for calculating a variety of network indices
+  *
+  * The path based indices (hop plot, shortest paths, betweenness) and the clustering coefficients are computed
+  * in parallel on the compressed sparse row snapshot of the network. Update() does nothing if the snapshot has not
+  * changed since the last call, i.e. the network has not been modified.
+  */
   class MITKCONNECTOMICS_EXPORT ConnectomicsStatisticsCalculator : public itk::Object
   {
   public:
@@ -178,6 +186,12 @@ namespace mitk
     // The connectomics network, which is used for statistics calculation
     mitk::ConnectomicsNetwork::Pointer m_Network;
 
+    // The snapshot of the network the current values have been calculated on
+    std::shared_ptr< const mitk::ConnectomicsCSRGraph > m_CSRGraph;
+
+    // Edge index backing m_PropertyMapOfEdgeBetweennessCentralities
+    EdgeIndexStdMapType m_EdgeIndexStdMap;
+
     // Statistics
     unsigned int m_NumberOfVertices;
     unsigned int m_NumberOfEdges;
@@ -17,19 +17,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkConnectomicsNetwork.h"
 #include <mitkConnectomicsStatisticsCalculator.h>
-
-#include <boost/graph/clustering_coefficient.hpp>
-
-#ifdef _MSC_VER
-# pragma warning(push)
-# pragma warning(disable: 4172)
-#endif
-
-#include <boost/graph/betweenness_centrality.hpp>
-
-#ifdef _MSC_VER
-# pragma warning(pop)
-#endif
+#include <mitkConnectomicsCSRGraph.h>
 
 /* Constructor and Destructor */
 mitk::ConnectomicsNetwork::ConnectomicsNetwork()
@@ -352,31 +340,31 @@ int mitk::ConnectomicsNetwork::GetMaximumDegree() const
 
 std::vector< double > mitk::ConnectomicsNetwork::GetLocalClusteringCoefficients( ) const
 {
-  std::vector< double > vectorOfClusteringCoefficients;
+  std::shared_ptr< const ConnectomicsCSRGraph > graph = this->GetCSRGraph();
 
-  typedef boost::graph_traits<NetworkType>::vertex_iterator vertexIter;
+  if( m_ClusteringCoefficientCache.size() != graph->GetNumberOfVertices() )
+  {
+    std::vector< double > coefficientsByDescriptor = graph->ComputeLocalClusteringCoefficients();
 
-  vectorOfClusteringCoefficients.resize( this->GetNumberOfVertices() );
+    m_ClusteringCoefficientCache.assign( coefficientsByDescriptor.size(), 0.0 );
+    int size = m_ClusteringCoefficientCache.size();
 
-  std::pair<vertexIter, vertexIter> vertexPair;
+    // the result is indexed by node id
+    for( unsigned int vertex( 0 ); vertex < coefficientsByDescriptor.size(); ++vertex )
+    {
+      int index = m_Network[ vertex ].id;
 
-  //for every vertex calculate the clustering coefficient
-  int size = vectorOfClusteringCoefficients.size();
-  for (vertexPair = vertices(m_Network); vertexPair.first != vertexPair.second; ++vertexPair.first)
-  {
-    int index = m_Network[ *vertexPair.first ].id;
+      if( index < 0 || index >= size )
+      {
+        MITK_ERROR << "Trying to access out of bounds clustering coefficient";
+        continue;
+      }
 
-    if( index > size )
-    {
-      MITK_ERROR << "Trying to access out of bounds clustering coefficient";
-      continue;
+      m_ClusteringCoefficientCache[ index ] = coefficientsByDescriptor[ vertex ];
     }
-
-    vectorOfClusteringCoefficients[ index ] =
-      boost::clustering_coefficient(m_Network,*vertexPair.first) ;
   }
 
-  return vectorOfClusteringCoefficients;
+  return m_ClusteringCoefficientCache;
 }
 
 std::vector< double > mitk::ConnectomicsNetwork::GetClusteringCoefficientsByDegree( )
@@ -501,6 +489,35 @@ bool mitk::ConnectomicsNetwork::GetIsModified() const
 void mitk::ConnectomicsNetwork::SetIsModified( bool value)
 {
   m_IsModified = value;
+
+  if( value )
+  {
+    m_CSRGraph.reset();
+    m_NodeBetweennessCache.clear();
+    m_EdgeBetweennessCache.clear();
+    m_ClusteringCoefficientCache.clear();
+  }
+}
+
+std::shared_ptr< const mitk::ConnectomicsCSRGraph > mitk::ConnectomicsNetwork::GetCSRGraph() const
+{
+  // guard against changes made through GetBoostGraph() without SetIsModified
+  if( m_CSRGraph != nullptr
+    && ( m_CSRGraph->GetNumberOfVertices() != boost::num_vertices( m_Network )
+      || m_CSRGraph->GetNumberOfEdges() != boost::num_edges( m_Network ) ) )
+  {
+    m_CSRGraph.reset();
+    m_NodeBetweennessCache.clear();
+    m_EdgeBetweennessCache.clear();
+    m_ClusteringCoefficientCache.clear();
+  }
+
+  if( m_CSRGraph == nullptr )
+  {
+    m_CSRGraph = std::make_shared< const ConnectomicsCSRGraph >( m_Network );
+  }
+
+  return m_CSRGraph;
 }
 
 
@@ -626,65 +643,52 @@ void mitk::ConnectomicsNetwork::UpdateIDs()
   this->SetIsModified( true );
 }
 
-std::vector< double > mitk::ConnectomicsNetwork::GetNodeBetweennessVector() const
+void mitk::ConnectomicsNetwork::UpdateBetweennessCache() const
 {
-  std::vector< double > betweennessVector;
-
-  betweennessVector.clear();
-  betweennessVector.resize( this->GetNumberOfVertices() );
+  std::shared_ptr< const ConnectomicsCSRGraph > graph = this->GetCSRGraph();
 
-  boost::brandes_betweenness_centrality(
-    m_Network,
-    boost::centrality_map(
-    boost::make_iterator_property_map( betweennessVector.begin(), boost::get( &NetworkNode::id, m_Network ), double() )
-    ).vertex_index_map( boost::get( &NetworkNode::id, m_Network ) )
-    );
-
-  return betweennessVector;
-}
+  if( m_NodeBetweennessCache.size() == graph->GetNumberOfVertices()
+    && m_EdgeBetweennessCache.size() == graph->GetNumberOfEdges() )
+  {
+    return;
+  }
 
-std::vector< double > mitk::ConnectomicsNetwork::GetEdgeBetweennessVector() const
-{
-  // std::map used for convenient initialization
-  typedef std::map<EdgeDescriptorType, int> EdgeIndexStdMap;
-  EdgeIndexStdMap stdEdgeIndex;
-  // associative property map needed for iterator property map-wrapper
-  typedef boost::associative_property_map< EdgeIndexStdMap > EdgeIndexMap;
-  EdgeIndexMap edgeIndex(stdEdgeIndex);
+  std::vector< double > betweennessByDescriptor;
+  graph->ComputeBetweennessCentrality( betweennessByDescriptor, &m_EdgeBetweennessCache );
 
-  boost::graph_traits<NetworkType>::edge_iterator iterator, end;
+  // node betweenness is indexed by node id
+  m_NodeBetweennessCache.assign( betweennessByDescriptor.size(), 0.0 );
+  int size = m_NodeBetweennessCache.size();
+  for( unsigned int vertex( 0 ); vertex < betweennessByDescriptor.size(); ++vertex )
+  {
+    int index = m_Network[ vertex ].id;
 
-  // sets iterator to start end end to end
-  boost::tie(iterator, end) = boost::edges( m_Network );
+    if( index < 0 || index >= size )
+    {
+      MITK_ERROR << "Trying to access out of bounds betweenness centrality";
+      continue;
+    }
 
-  int i(0);
-  for ( ; iterator != end; ++iterator, ++i)
-  {
-    stdEdgeIndex.insert(std::pair< EdgeDescriptorType, int >( *iterator, i));
+    m_NodeBetweennessCache[ index ] = betweennessByDescriptor[ vertex ];
   }
+}
 
-  // Define EdgeCentralityMap
-  std::vector< double > edgeBetweennessVector(boost::num_edges( m_Network ), 0.0);
-  // Create the external property map
-  boost::iterator_property_map< std::vector< double >::iterator, EdgeIndexMap >
-    e_centrality_map(edgeBetweennessVector.begin(), edgeIndex);
+std::vector< double > mitk::ConnectomicsNetwork::GetNodeBetweennessVector() const
+{
+  this->UpdateBetweennessCache();
 
-  // Define VertexCentralityMap
-  typedef boost::property_map< NetworkType, boost::vertex_index_t>::type VertexIndexMap;
-  VertexIndexMap vertexIndex = get(boost::vertex_index, m_Network );
-  std::vector< double > betweennessVector(boost::num_vertices( m_Network ), 0.0);
-  // Create the external property map
-  boost::iterator_property_map< std::vector< double >::iterator, VertexIndexMap >
-    v_centrality_map(betweennessVector.begin(), vertexIndex);
+  return m_NodeBetweennessCache;
+}
 
-  boost::brandes_betweenness_centrality( m_Network, v_centrality_map, e_centrality_map );
+std::vector< double > mitk::ConnectomicsNetwork::GetEdgeBetweennessVector() const
+{
+  this->UpdateBetweennessCache();
 
-  return edgeBetweennessVector;
+  return m_EdgeBetweennessCache;
 }
 
 std::vector< double > mitk::ConnectomicsNetwork::GetShortestDistanceVectorFromLabel( std::string targetLabel ) const
 {
-  std::vector< VertexDescriptorType > predecessorMap( boost::num_vertices( m_Network ) );
   int numberOfNodes( boost::num_vertices( m_Network ) );
 
   std::vector< double > distanceMatrix;
@@ -704,7 +708,7 @@ std::vector< double > mitk::ConnectomicsNetwork::GetShortestDistanceVectorFromLa
     return distanceMatrix;
   }
 
-  boost::dijkstra_shortest_paths(m_Network, *iterator, boost::predecessor_map(&predecessorMap[ 0 ]).distance_map(&distanceMatrix[ 0 ]).weight_map( boost::get( &NetworkEdge::edge_weight ,m_Network ) ) ) ;
+  this->GetCSRGraph()->DijkstraDistances( *iterator, distanceMatrix );
 
   return distanceMatrix;
 }
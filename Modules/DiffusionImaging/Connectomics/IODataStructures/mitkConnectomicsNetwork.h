@@ -23,12 +23,16 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkBaseData.h"
 
+#include <memory>
+
 #ifndef Q_MOC_RUN
 #include <boost/graph/adjacency_list.hpp>
 #endif
 
 namespace mitk {
 
+  class ConnectomicsCSRGraph;
+
   /**
   * \brief Connectomics Network Class
   *
@@ -49,6 +53,11 @@ namespace mitk {
   *  <li> int weight - Weight of the edge as int (used for counting fibers)
   *  <li> double edge_weight - Used for boost and algorithms, should be between 0 and 1
   * </ul>
+  *
+  * Graph measures (betweenness, clustering, shortest paths) are computed on a compressed sparse row snapshot of the
+  * graph, see GetCSRGraph(). The snapshot and the measures derived from it are cached and dropped by
+  * SetIsModified( true ), which all modifying methods call. Code changing the graph through GetBoostGraph() has to
+  * call SetIsModified( true ) as well.
   */
   class MITKCONNECTOMICS_EXPORT ConnectomicsNetwork : public BaseData
   {
@@ -179,9 +188,12 @@ namespace mitk {
     /** Get the shortest distance from a specified vertex to all other vertices in form of a vector of length (number vertices)*/
     std::vector< double > GetShortestDistanceVectorFromLabel( std::string targetLabel ) const;
 
-    /** Access boost graph directly */
+    /** Access boost graph directly, call SetIsModified( true ) after changing it */
     NetworkType* GetBoostGraph();
 
+    /** Get the compressed sparse row snapshot of the current graph, built on first use after a modification */
+    std::shared_ptr< const ConnectomicsCSRGraph > GetCSRGraph() const;
+
     /** Set the boost graph directly */
     void SetBoostGraph( NetworkType* newGraph );
 
@@ -190,7 +202,7 @@ namespace mitk {
     /** Get the modified flag */
     bool GetIsModified() const;
 
-    /** Set the modified flag */
+    /** Set the modified flag, setting it drops the cached snapshot and graph measures */
     void SetIsModified( bool );
 
     /** Update the bounds of the geometry to fit the network */
@@ -220,6 +232,14 @@ namespace mitk {
 
   private:
 
+    /** Compute node and edge betweenness of the current snapshot if they are not cached */
+    void UpdateBetweennessCache() const;
+
+    mutable std::shared_ptr< const ConnectomicsCSRGraph > m_CSRGraph;
+    mutable std::vector< double > m_NodeBetweennessCache;
+    mutable std::vector< double > m_EdgeBetweennessCache;
+    mutable std::vector< double > m_ClusteringCoefficientCache;
+
   };
 
   /**
@@ -25,6 +25,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 // MITK includes
 #include <mitkIOUtil.h>
 #include <mitkConnectomicsStatisticsCalculator.h>
+#include <mitkConnectomicsCSRGraph.h>
+
+// boost includes
+#include <boost/graph/clustering_coefficient.hpp>
+#include <boost/graph/dijkstra_shortest_paths.hpp>
+#ifdef _MSC_VER
+# pragma warning(push)
+# pragma warning(disable: 4172)
+#endif
+#include <boost/graph/betweenness_centrality.hpp>
+#ifdef _MSC_VER
+# pragma warning(pop)
+#endif
 
 // VTK includes
 #include <vtkDebugLeaks.h>
@@ -38,6 +51,8 @@ class mitkConnectomicsStatisticsCalculatorTestSuite : public mitk::TestFixture
   vtkDebugLeaks::SetExitError(0);
 
   MITK_TEST(StatisticsCalculatorUpdate);
+  MITK_TEST(CSRGraphMatchesBoost);
+  MITK_TEST(ModifiedNetworkInvalidatesCache);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -76,6 +91,37 @@ public:
     m_Network = network;
   }
 
+  /**
+  * @brief Generates a deterministic sparse network with a self loop and varying edge weights
+  */
+  mitk::ConnectomicsNetwork::Pointer CreateTestNetwork( unsigned int numberOfNodes )
+  {
+    mitk::ConnectomicsNetwork::Pointer network = mitk::ConnectomicsNetwork::New();
+
+    std::vector< mitk::ConnectomicsNetwork::VertexDescriptorType > vertices;
+    for( unsigned int i = 0; i < numberOfNodes; ++i )
+    {
+      vertices.push_back( network->AddVertex( i ) );
+    }
+
+    unsigned int state( 12345 );
+    for( unsigned int i = 0; i < numberOfNodes; ++i )
+    {
+      for( unsigned int j = i + 1; j < numberOfNodes; ++j )
+      {
+        state = state * 1103515245 + 12345;
+        if( ( state >> 16 ) % 100 < 8 )
+        {
+          double weight = 1.0 + ( ( state >> 8 ) % 4 );
+          network->AddEdge( vertices[i], vertices[j], i, j, 1, weight );
+        }
+      }
+    }
+    network->AddEdge( vertices[0], vertices[0], 0, 0, 1, 1.0 );
+
+    return network;
+  }
+
   void tearDown() override
   {
     m_Network = nullptr;
@@ -136,6 +182,119 @@ public:
     CPPUNIT_ASSERT_MESSAGE( "GetSmallWorldness", mitk::Equal( statisticsCalculator->GetSmallWorldness( ), 1.72908 , eps, true ) );
 
   }
+
+  void CSRGraphMatchesBoost()
+  {
+    typedef mitk::ConnectomicsNetwork::NetworkType NetworkType;
+    typedef mitk::ConnectomicsNetwork::EdgeDescriptorType EdgeDescriptorType;
+
+    mitk::ConnectomicsNetwork::Pointer network = CreateTestNetwork( 60 );
+    NetworkType& graph = *network->GetBoostGraph();
+    mitk::ConnectomicsCSRGraph csrGraph( graph );
+
+    const unsigned int numberOfVertices = boost::num_vertices( graph );
+    const unsigned int numberOfEdges = boost::num_edges( graph );
+    double eps( 0.000001 );
+
+    // edge index in the order of boost::edges
+    std::map< EdgeDescriptorType, int > stdEdgeIndex;
+    boost::graph_traits<NetworkType>::edge_iterator iterator, end;
+    int index( 0 );
+    for( boost::tie( iterator, end ) = boost::edges( graph ); iterator != end; ++iterator, ++index )
+    {
+      stdEdgeIndex.insert( std::pair< EdgeDescriptorType, int >( *iterator, index ) );
+    }
+    boost::associative_property_map< std::map< EdgeDescriptorType, int > > edgeIndex( stdEdgeIndex );
+
+    for( int weighted = 0; weighted < 2; ++weighted )
+    {
+      std::vector< double > boostVertexCentrality( numberOfVertices, 0.0 );
+      std::vector< double > boostEdgeCentrality( numberOfEdges, 0.0 );
+      auto vertexMap = boost::make_iterator_property_map( boostVertexCentrality.begin(), boost::get( boost::vertex_index, graph ) );
+      auto edgeMap = boost::make_iterator_property_map( boostEdgeCentrality.begin(), edgeIndex );
+      if( weighted )
+      {
+        boost::brandes_betweenness_centrality( graph, boost::centrality_map( vertexMap ).edge_centrality_map( edgeMap )
+          .weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight, graph ) ) );
+      }
+      else
+      {
+        boost::brandes_betweenness_centrality( graph, vertexMap, edgeMap );
+      }
+
+      std::vector< double > vertexCentrality;
+      std::vector< double > edgeCentrality;
+      csrGraph.ComputeBetweennessCentrality( vertexCentrality, &edgeCentrality, weighted != 0 );
+
+      CPPUNIT_ASSERT_EQUAL( numberOfVertices, (unsigned int) vertexCentrality.size() );
+      CPPUNIT_ASSERT_EQUAL( numberOfEdges, (unsigned int) edgeCentrality.size() );
+      for( unsigned int i = 0; i < numberOfVertices; ++i )
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( boostVertexCentrality[i], vertexCentrality[i], eps );
+      }
+      for( unsigned int i = 0; i < numberOfEdges; ++i )
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( boostEdgeCentrality[i], edgeCentrality[i], eps );
+      }
+    }
+
+    std::vector< double > clustering = network->GetLocalClusteringCoefficients();
+    for( unsigned int i = 0; i < numberOfVertices; ++i )
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( boost::clustering_coefficient( graph, i ), clustering[i], eps );
+    }
+
+    std::vector< double > allDistances = csrGraph.AllPairsShortestDistances();
+    for( unsigned int source = 0; source < numberOfVertices; ++source )
+    {
+      std::vector< double > distances( numberOfVertices );
+      boost::dijkstra_shortest_paths( graph, source, boost::distance_map( &distances[0] )
+        .weight_map( boost::get( &mitk::ConnectomicsNetwork::NetworkEdge::edge_weight, graph ) ) );
+      for( unsigned int target = 0; target < numberOfVertices; ++target )
+      {
+        CPPUNIT_ASSERT_DOUBLES_EQUAL( distances[target], allDistances[ source * numberOfVertices + target ], eps );
+      }
+    }
+  }
+
+  void ModifiedNetworkInvalidatesCache()
+  {
+    mitk::ConnectomicsNetwork::Pointer network = CreateTestNetwork( 30 );
+
+    mitk::ConnectomicsStatisticsCalculator::Pointer statisticsCalculator = mitk::ConnectomicsStatisticsCalculator::New();
+    statisticsCalculator->SetNetwork( network );
+    statisticsCalculator->Update();
+
+    std::vector< double > betweenness = network->GetNodeBetweennessVector();
+    unsigned int edges = statisticsCalculator->GetNumberOfEdges();
+
+    // connect the first pair of vertices which is not connected yet
+    int added( 0 );
+    for( unsigned int i = 1; i < 30 && added == 0; ++i )
+    {
+      for( unsigned int j = 29; j > i && added == 0; --j )
+      {
+        if( !network->EdgeExists( i, j ) )
+        {
+          network->AddEdge( i, j, i, j, 1 );
+          added++;
+        }
+      }
+    }
+    statisticsCalculator->Update();
+
+    CPPUNIT_ASSERT_EQUAL( edges + 1, statisticsCalculator->GetNumberOfEdges() );
+
+    // the cached betweenness has to be recomputed and match a fresh computation
+    std::vector< double > updatedBetweenness = network->GetNodeBetweennessVector();
+    std::vector< double > expected;
+    mitk::ConnectomicsCSRGraph( *network->GetBoostGraph() ).ComputeBetweennessCentrality( expected, nullptr );
+    CPPUNIT_ASSERT( updatedBetweenness != betweenness );
+    for( unsigned int i = 0; i < expected.size(); ++i )
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL( expected[i], updatedBetweenness[i], 0.000001 );
+    }
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkConnectomicsStatisticsCalculator)
@@ -33,6 +33,7 @@ set(CPP_FILES
   Algorithms/mitkConnectomicsStatisticsCalculator.cpp
   Algorithms/mitkConnectomicsNetworkConverter.cpp
   Algorithms/mitkConnectomicsNetworkThresholder.cpp
+  Algorithms/mitkConnectomicsCSRGraph.cpp
   Algorithms/mitkFreeSurferParcellationTranslator.cpp
 )
 
@@ -72,6 +73,7 @@ set(H_FILES
   Algorithms/itkConnectomicsNetworkToConnectivityMatrixImageFilter.h
   Algorithms/mitkConnectomicsStatisticsCalculator.h
   Algorithms/mitkConnectomicsNetworkConverter.h
+  Algorithms/mitkConnectomicsCSRGraph.h
   Algorithms/BrainParcellation/mitkCostFunctionBase.h
   Algorithms/BrainParcellation/mitkRandomParcellationGenerator.h
   Algorithms/BrainParcellation/mitkRegionVoxelCounter.h
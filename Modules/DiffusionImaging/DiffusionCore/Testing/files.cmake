@@ -1,6 +1,8 @@
 set(MODULE_TESTS
   mitkNonLocalMeansDenoisingTest.cpp
   mitkDiffusionPropertySerializerTest.cpp
+  mitkVoxelBlockReconstructionTest.cpp
+  mitkB0ImageExtractionImageFilterTest.cpp
 )
 
 set(MODULE_CUSTOM_TESTS
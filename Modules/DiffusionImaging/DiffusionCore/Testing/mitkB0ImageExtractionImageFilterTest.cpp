@@ -0,0 +1,120 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+#include "itkB0ImageExtractionImageFilter.h"
+
+#include <itkImageRegionConstIteratorWithIndex.h>
+#include <itkImageRegionIterator.h>
+#include <itkStreamingImageFilter.h>
+#include <itkVectorImage.h>
+
+class mitkB0ImageExtractionImageFilterTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkB0ImageExtractionImageFilterTestSuite);
+  MITK_TEST(Extract_AveragesBaselineChannels);
+  MITK_TEST(Extract_Streamed_EqualsUnstreamed);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::VectorImage<short, 3> DwiImageType;
+  typedef itk::B0ImageExtractionImageFilter<short, short> FilterType;
+  typedef FilterType::OutputImageType B0ImageType;
+
+  DwiImageType::Pointer m_Dwi;
+  FilterType::GradientDirectionContainerType::Pointer m_Directions;
+
+  /** Baseline channels 0 and 2 hold 10*(x+y+z) and 10*(x+y+z)+4, the diffusion weighted channels something else */
+  static short ExpectedB0(const DwiImageType::IndexType& index)
+  {
+    return static_cast<short>(10*(index[0]+index[1]+index[2]) + 2);
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_Dwi = DwiImageType::New();
+    DwiImageType::SizeType size;
+    size[0] = 9; size[1] = 7; size[2] = 6;
+    m_Dwi->SetRegions(size);
+    m_Dwi->SetVectorLength(4);
+    m_Dwi->Allocate();
+
+    itk::ImageRegionIterator<DwiImageType> it(m_Dwi, m_Dwi->GetLargestPossibleRegion());
+    DwiImageType::PixelType pix;
+    pix.SetSize(4);
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+    {
+      DwiImageType::IndexType index = it.GetIndex();
+      short base = 10*(index[0]+index[1]+index[2]);
+      pix[0] = base;
+      pix[1] = 3;
+      pix[2] = base + 4;
+      pix[3] = 5;
+      it.Set(pix);
+    }
+
+    m_Directions = FilterType::GradientDirectionContainerType::New();
+    FilterType::GradientDirectionType b0; b0.fill(0);
+    FilterType::GradientDirectionType g1; g1.fill(0); g1[0] = 1;
+    FilterType::GradientDirectionType g2; g2.fill(0); g2[1] = 1;
+    m_Directions->InsertElement(0, b0);
+    m_Directions->InsertElement(1, g1);
+    m_Directions->InsertElement(2, b0);
+    m_Directions->InsertElement(3, g2);
+  }
+
+  void tearDown() override
+  {
+    m_Dwi = nullptr;
+    m_Directions = nullptr;
+  }
+
+  void Extract_AveragesBaselineChannels()
+  {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(m_Dwi);
+    filter->SetDirections(m_Directions);
+    filter->Update();
+
+    itk::ImageRegionConstIteratorWithIndex<B0ImageType> it(filter->GetOutput(), filter->GetOutput()->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("b0 is the average of the baseline channels", ExpectedB0(it.GetIndex()), it.Get());
+  }
+
+  void Extract_Streamed_EqualsUnstreamed()
+  {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInput(m_Dwi);
+    filter->SetDirections(m_Directions);
+
+    typedef itk::StreamingImageFilter<B0ImageType, B0ImageType> StreamerType;
+    StreamerType::Pointer streamer = StreamerType::New();
+    streamer->SetInput(filter->GetOutput());
+    streamer->SetNumberOfStreamDivisions(4);
+    streamer->Update();
+
+    itk::ImageRegionConstIteratorWithIndex<B0ImageType> it(streamer->GetOutput(), streamer->GetOutput()->GetLargestPossibleRegion());
+    for (it.GoToBegin(); !it.IsAtEnd(); ++it)
+      CPPUNIT_ASSERT_EQUAL_MESSAGE("Streamed b0 differs", ExpectedB0(it.GetIndex()), it.Get());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkB0ImageExtractionImageFilter)
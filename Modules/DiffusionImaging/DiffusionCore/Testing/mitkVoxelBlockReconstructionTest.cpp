@@ -0,0 +1,119 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+#include "itkVoxelBlockReconstruction.h"
+
+#include <vnl/vnl_vector.h>
+#include <cmath>
+
+class mitkVoxelBlockReconstructionTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkVoxelBlockReconstructionTestSuite);
+  MITK_TEST(Apply_BlockOfVoxels_EqualsMatrixTimesVector);
+  MITK_TEST(Apply_FloatMatrix_EqualsMatrixTimesVector);
+  MITK_TEST(Apply_NoVoxels_KeepsOutput);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  typedef itk::VoxelBlockReconstruction<double> BlockReconstructionType;
+
+  /** Deterministic, not too regular values */
+  static double Value(unsigned int i, unsigned int j)
+  {
+    return std::sin(0.37*i + 1.3*j) + 0.01*j;
+  }
+
+  static vnl_matrix<double> CreateMatrix(unsigned int rows, unsigned int columns)
+  {
+    vnl_matrix<double> matrix(rows, columns);
+    for (unsigned int r=0; r<rows; r++)
+      for (unsigned int c=0; c<columns; c++)
+        matrix(r, c) = Value(r, c+rows);
+    return matrix;
+  }
+
+public:
+
+  void Apply_BlockOfVoxels_EqualsMatrixTimesVector()
+  {
+    // 28 coefficients from 61 gradient directions, a number of voxels that is not a multiple of the unrolling
+    vnl_matrix<double> matrix = CreateMatrix(28, 61);
+    BlockReconstructionType reconstruction(matrix);
+    CPPUNIT_ASSERT_EQUAL(61u, reconstruction.GetNumberOfInputs());
+    CPPUNIT_ASSERT_EQUAL(28u, reconstruction.GetNumberOfOutputs());
+
+    const unsigned int numberOfVoxels = 103;
+    BlockReconstructionType::BlockType signals = BlockReconstructionType::CreateBlock(61);
+    for (unsigned int v=0; v<numberOfVoxels; v++)
+      for (unsigned int i=0; i<61; i++)
+        signals(v, i) = Value(v, i);
+
+    BlockReconstructionType::BlockType result;
+    reconstruction.Apply(signals, numberOfVoxels, result);
+    CPPUNIT_ASSERT_EQUAL(28u, result.columns());
+
+    for (unsigned int v=0; v<numberOfVoxels; v++)
+    {
+      vnl_vector<double> expected = matrix * signals.get_row(v);
+      for (unsigned int k=0; k<28; k++)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Reconstruction of a voxel differs from matrix times signal", expected[k], result(v, k), 1e-12);
+    }
+  }
+
+  void Apply_FloatMatrix_EqualsMatrixTimesVector()
+  {
+    vnl_matrix<double> doubleMatrix = CreateMatrix(15, 30);
+    vnl_matrix<float> matrix(15, 30);
+    for (unsigned int r=0; r<15; r++)
+      for (unsigned int c=0; c<30; c++)
+        matrix(r, c) = static_cast<float>(doubleMatrix(r, c));
+
+    itk::VoxelBlockReconstruction<float> reconstruction(matrix);
+    itk::VoxelBlockReconstruction<float>::BlockType signals = itk::VoxelBlockReconstruction<float>::CreateBlock(30);
+    itk::VoxelBlockReconstruction<float>::BlockType result = reconstruction.CreateOutputBlock();
+    for (unsigned int v=0; v<7; v++)
+      for (unsigned int i=0; i<30; i++)
+        signals(v, i) = static_cast<float>(Value(v, i));
+
+    reconstruction.Apply(signals, 7, result);
+
+    for (unsigned int v=0; v<7; v++)
+    {
+      vnl_vector<float> expected = matrix * signals.get_row(v);
+      for (unsigned int k=0; k<15; k++)
+        CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Reconstruction of a voxel differs from matrix times signal", expected[k], result(v, k), 1e-5);
+    }
+  }
+
+  void Apply_NoVoxels_KeepsOutput()
+  {
+    BlockReconstructionType reconstruction(CreateMatrix(6, 12));
+    BlockReconstructionType::BlockType signals = BlockReconstructionType::CreateBlock(12);
+    BlockReconstructionType::BlockType result = reconstruction.CreateOutputBlock();
+    result.fill(3.0);
+
+    reconstruction.Apply(signals, 0, result);
+
+    CPPUNIT_ASSERT_EQUAL(256u, result.rows());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, result(0, 0), 0.0);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkVoxelBlockReconstruction)
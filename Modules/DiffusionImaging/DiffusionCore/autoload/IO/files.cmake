@@ -26,3 +26,7 @@ set(CPP_FILES
   mitkCompositeMapper.cpp
 )
 
+
+set(RESOURCE_FILES
+  manifest.json
+)
@@ -33,11 +33,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkDiffusionPropertyHelper.h>
 
 #include <mitkCoreServices.h>
+#include <mitkLazyFileIORegistration.h>
 #include <mitkIPropertyDescriptions.h>
 #include <mitkIPropertyPersistence.h>
 
 #include "mitkDiffusionCoreIOMimeTypes.h"
 
+#include <memory>
+
 namespace mitk
 {
   /**
@@ -61,27 +64,16 @@ namespace mitk
         context->RegisterService(*mimeTypeIter, props);
       }
 
-      m_DiffusionImageNrrdReaderService = new DiffusionImageNrrdReaderService();
-      m_DiffusionImageNiftiReaderService = new DiffusionImageNiftiReaderService( CustomMimeType( mitk::DiffusionCoreIOMimeTypes::DWI_NIFTI_MIMETYPE() ), mitk::DiffusionCoreIOMimeTypes::DWI_NIFTI_MIMETYPE_DESCRIPTION() );
-      m_DiffusionImageFslNiftiReaderService = new DiffusionImageNiftiReaderService( CustomMimeType( mitk::DiffusionCoreIOMimeTypes::DWI_FSL_MIMETYPE() ), mitk::DiffusionCoreIOMimeTypes::DWI_FSL_MIMETYPE_DESCRIPTION() );
-      m_DiffusionImageDicomReaderService = new DiffusionImageDicomReaderService();
-
-      m_NrrdTensorImageReader = new NrrdTensorImageReader();
-      m_NrrdOdfImageReader = new NrrdOdfImageReader();
-      m_PeakImageReader = new PeakImageReader();
-      m_ShImageReader = new ShImageReader();
-
-      m_DiffusionImageNrrdWriterService = new DiffusionImageNrrdWriterService();
-      m_DiffusionImageNiftiWriterService = new DiffusionImageNiftiWriterService();
-      m_NrrdTensorImageWriter = new NrrdTensorImageWriter();
-      m_NrrdOdfImageWriter = new NrrdOdfImageWriter();
-      m_ShImageWriter = new ShImageWriter();
+      // the readers and writers are created when the first lookup needs them, see resource/manifest.json
+      m_FileIORegistration.reset(new LazyFileIORegistration(context, "diffusion", [this]() { this->RegisterReaderWriter(); }));
 
       mitk::DiffusionPropertyHelper::SetupProperties();
     }
 
     void Unload(us::ModuleContext*) override
     {
+      m_FileIORegistration.reset();
+
       for (unsigned int loop(0); loop < m_MimeTypes.size(); ++loop)
       {
         delete m_MimeTypes.at(loop);
@@ -105,23 +97,44 @@ namespace mitk
 
   private:
 
-    DiffusionImageNrrdReaderService * m_DiffusionImageNrrdReaderService;
-    DiffusionImageNiftiReaderService * m_DiffusionImageNiftiReaderService;
-    DiffusionImageNiftiReaderService * m_DiffusionImageFslNiftiReaderService;
-    DiffusionImageDicomReaderService * m_DiffusionImageDicomReaderService;
-    NrrdTensorImageReader * m_NrrdTensorImageReader;
-    NrrdOdfImageReader * m_NrrdOdfImageReader;
-    PeakImageReader * m_PeakImageReader;
-    ShImageReader * m_ShImageReader;
-
-    DiffusionImageNrrdWriterService * m_DiffusionImageNrrdWriterService;
-    DiffusionImageNiftiWriterService * m_DiffusionImageNiftiWriterService;
-    NrrdTensorImageWriter * m_NrrdTensorImageWriter;
-    NrrdOdfImageWriter * m_NrrdOdfImageWriter;
-    ShImageWriter * m_ShImageWriter;
+    void RegisterReaderWriter()
+    {
+      m_DiffusionImageNrrdReaderService = new DiffusionImageNrrdReaderService();
+      m_DiffusionImageNiftiReaderService = new DiffusionImageNiftiReaderService( CustomMimeType( mitk::DiffusionCoreIOMimeTypes::DWI_NIFTI_MIMETYPE() ), mitk::DiffusionCoreIOMimeTypes::DWI_NIFTI_MIMETYPE_DESCRIPTION() );
+      m_DiffusionImageFslNiftiReaderService = new DiffusionImageNiftiReaderService( CustomMimeType( mitk::DiffusionCoreIOMimeTypes::DWI_FSL_MIMETYPE() ), mitk::DiffusionCoreIOMimeTypes::DWI_FSL_MIMETYPE_DESCRIPTION() );
+      m_DiffusionImageDicomReaderService = new DiffusionImageDicomReaderService();
+
+      m_NrrdTensorImageReader = new NrrdTensorImageReader();
+      m_NrrdOdfImageReader = new NrrdOdfImageReader();
+      m_PeakImageReader = new PeakImageReader();
+      m_ShImageReader = new ShImageReader();
+
+      m_DiffusionImageNrrdWriterService = new DiffusionImageNrrdWriterService();
+      m_DiffusionImageNiftiWriterService = new DiffusionImageNiftiWriterService();
+      m_NrrdTensorImageWriter = new NrrdTensorImageWriter();
+      m_NrrdOdfImageWriter = new NrrdOdfImageWriter();
+      m_ShImageWriter = new ShImageWriter();
+    }
+
+    DiffusionImageNrrdReaderService * m_DiffusionImageNrrdReaderService = nullptr;
+    DiffusionImageNiftiReaderService * m_DiffusionImageNiftiReaderService = nullptr;
+    DiffusionImageNiftiReaderService * m_DiffusionImageFslNiftiReaderService = nullptr;
+    DiffusionImageDicomReaderService * m_DiffusionImageDicomReaderService = nullptr;
+    NrrdTensorImageReader * m_NrrdTensorImageReader = nullptr;
+    NrrdOdfImageReader * m_NrrdOdfImageReader = nullptr;
+    PeakImageReader * m_PeakImageReader = nullptr;
+    ShImageReader * m_ShImageReader = nullptr;
+
+    DiffusionImageNrrdWriterService * m_DiffusionImageNrrdWriterService = nullptr;
+    DiffusionImageNiftiWriterService * m_DiffusionImageNiftiWriterService = nullptr;
+    NrrdTensorImageWriter * m_NrrdTensorImageWriter = nullptr;
+    NrrdOdfImageWriter * m_NrrdOdfImageWriter = nullptr;
+    ShImageWriter * m_ShImageWriter = nullptr;
 
     std::vector<mitk::CustomMimeType*> m_MimeTypes;
 
+    std::unique_ptr<LazyFileIORegistration> m_FileIORegistration;
+
   };
 }
 
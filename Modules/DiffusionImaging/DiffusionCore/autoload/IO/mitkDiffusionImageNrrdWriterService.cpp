@@ -34,6 +34,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 mitk::DiffusionImageNrrdWriterService::DiffusionImageNrrdWriterService()
   : AbstractFileWriter(mitk::Image::GetStaticNameOfClass(), CustomMimeType( mitk::DiffusionCoreIOMimeTypes::DWI_NRRD_MIMETYPE() ), mitk::DiffusionCoreIOMimeTypes::DWI_NRRD_MIMETYPE_DESCRIPTION())
 {
+  Options defaultOptions;
+  defaultOptions["Use compression"] = true;
+  this->SetDefaultOptions(defaultOptions);
   RegisterService();
 }
 
@@ -128,9 +131,11 @@ void mitk::DiffusionImageNrrdWriterService::Write()
 
   if (ext == ".hdwi" || ext == ".nrrd" || ext == ".dwi")
   {
+    bool useCompression = us::any_cast<bool>(this->GetOption("Use compression"));
+
     itk::NrrdImageIO::Pointer io = itk::NrrdImageIO::New();
     io->SetFileType( itk::ImageIOBase::Binary );
-    io->UseCompressionOn();
+    io->SetUseCompression(useCompression);
 
     typedef itk::ImageFileWriter<ImageType> WriterType;
     WriterType::Pointer nrrdWriter = WriterType::New();
@@ -138,7 +143,7 @@ void mitk::DiffusionImageNrrdWriterService::Write()
     nrrdWriter->SetInput( itkImg );
     nrrdWriter->SetImageIO(io);
     nrrdWriter->SetFileName(this->GetOutputLocation());
-    nrrdWriter->UseCompressionOn();
+    nrrdWriter->SetUseCompression(useCompression);
     nrrdWriter->SetImageIO(io);
     try
     {
@@ -92,6 +92,7 @@ set(H_FILES
   include/Algorithms/Reconstruction/itkDiffusionKurtosisReconstructionImageFilter.h
   include/Algorithms/Reconstruction/itkBallAndSticksImageFilter.h
   include/Algorithms/Reconstruction/itkMultiTensorImageFilter.h
+  include/Algorithms/Reconstruction/itkVoxelBlockReconstruction.h
 
   # Fitting functions
   include/Algorithms/Reconstruction/FittingFunctions/mitkAbstractFitter.h
@@ -241,6 +241,12 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,ShOrder,NrOdfDire
 
   this->ComputeReconstructionMatrix();
 
+  m_CoeffBlockReconstruction.SetMatrix(m_CoeffReconstructionMatrix);
+  if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+    m_OdfBlockReconstruction.SetMatrix(m_SphericalHarmonicBasisMatrix);
+  else
+    m_OdfBlockReconstruction.SetMatrix(m_ReconstructionMatrix);
+
   typename GradientImagesType::Pointer img = static_cast< GradientImagesType * >( this->ProcessObject::GetInput(0) );
 
   m_BZeroImage = BZeroImageType::New();
@@ -325,74 +331,96 @@ void AnalyticalDiffusionQballReconstructionImageFilter<T,TG,TO,ShOrder,NrOdfDire
       gradientind.push_back(gradientind[i]);
   }
 
+  // The voxels are reconstructed in blocks: the signals of the voxels above the threshold are gathered as rows of
+  // one matrix, the reconstruction matrices are applied to all of them at once and the results are written back
+  // in the order the voxels were visited.
+  typedef VoxelBlockReconstruction< TO > BlockReconstructionType;
+  const unsigned int blockSize = BlockReconstructionType::BlockSize;
+  typename BlockReconstructionType::BlockType signals = BlockReconstructionType::CreateBlock(m_NumberOfGradientDirections);
+  typename BlockReconstructionType::BlockType coeffs = m_CoeffBlockReconstruction.CreateOutputBlock();
+  typename BlockReconstructionType::BlockType odfs = m_OdfBlockReconstruction.CreateOutputBlock();
+  std::vector< typename NumericTraits<ReferencePixelType>::AccumulateType > b0s(blockSize);
+  std::vector< int > signalRows(blockSize); // row of the voxel in the signal block, -1 if it is below the threshold
+  vnl_vector<TO> B(m_NumberOfGradientDirections);
+
   while( !git.IsAtEnd() )
   {
-    GradientVectorType b = git.Get();
-
-    typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
-
-    // Average the baseline image pixels
-    for(unsigned int i = 0; i < baselineind.size(); ++i)
+    unsigned int numberOfVoxels = 0;
+    unsigned int numberOfSignals = 0;
+    for( ; numberOfVoxels<blockSize && !git.IsAtEnd(); ++numberOfVoxels, ++git )
     {
-      b0 += b[baselineind[i]];
-    }
-    b0 /= this->m_NumberOfBaselineImages;
-
-    OdfPixelType odf(0.0);
+      GradientVectorType b = git.Get();
 
-    typename CoefficientImageType::PixelType coeffPixel(0.0);
-    vnl_vector<TO> B(m_NumberOfGradientDirections);
+      typename NumericTraits<ReferencePixelType>::AccumulateType b0 = NumericTraits<ReferencePixelType>::Zero;
 
-    if( (b0 != 0) && (b0 >= m_Threshold) )
-    {
-      for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+      // Average the baseline image pixels
+      for(unsigned int i = 0; i < baselineind.size(); ++i)
       {
-        B[i] = static_cast<TO>(b[gradientind[i]]);
+        b0 += b[baselineind[i]];
       }
+      b0 /= this->m_NumberOfBaselineImages;
 
-      B = PreNormalize(B, b0);
-      if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
-      {
-        vnl_vector<TO> coeffs(m_NumberCoefficients);
-        coeffs = ( m_CoeffReconstructionMatrix * B );
-        coeffs[0] += 1.0/(2.0*sqrt(itk::Math::pi));
-        odf = ( m_SphericalHarmonicBasisMatrix * coeffs ).data_block();
-        coeffPixel = coeffs.data_block();
-      }
-      else if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
+      b0s[numberOfVoxels] = b0;
+      signalRows[numberOfVoxels] = -1;
+
+      if( (b0 != 0) && (b0 >= m_Threshold) )
       {
-        /** this would be the place to implement a non-negative
-              * solver for quadratic programming problem:
-              * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
-              * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
-              * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
-              */
-
-        itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+        if(m_NormalizationMethod == QBAR_NONNEG_SOLID_ANGLE)
+        {
+          /** this would be the place to implement a non-negative
+                * solver for quadratic programming problem:
+                * min .5*|| Bc-s ||^2 subject to -CLPc <= 4*pi*ones
+                * (refer to MICCAI 2009 Goh et al. "Estimating ODFs with PDF constraints")
+                * .5*|| Bc-s ||^2 == .5*c'B'Bc - x'B's + .5*s's
+                */
+
+          itkExceptionMacro( << "Nonnegative Solid Angle not yet implemented");
+        }
+
+        for( unsigned int i = 0; i< m_NumberOfGradientDirections; i++ )
+        {
+          B[i] = static_cast<TO>(b[gradientind[i]]);
+        }
+
+        B = PreNormalize(B, b0);
+        signals.set_row(numberOfSignals, B);
+        signalRows[numberOfVoxels] = numberOfSignals++;
       }
-      else
+    }
+
+    m_CoeffBlockReconstruction.Apply(signals, numberOfSignals, coeffs);
+    for( unsigned int i = 0; i < numberOfSignals; i++ )
+      coeffs[i][0] += 1.0/(2.0*sqrt(itk::Math::pi));
+
+    if(m_NormalizationMethod == QBAR_SOLID_ANGLE)
+      m_OdfBlockReconstruction.Apply(coeffs, numberOfSignals, odfs);
+    else
+      m_OdfBlockReconstruction.Apply(signals, numberOfSignals, odfs);
+
+    for( unsigned int v = 0; v < numberOfVoxels; v++ )
+    {
+      OdfPixelType odf(0.0);
+      typename CoefficientImageType::PixelType coeffPixel(0.0);
+
+      if( signalRows[v] >= 0 )
       {
-        vnl_vector<TO> coeffs(m_NumberCoefficients);
-        coeffs = ( m_CoeffReconstructionMatrix * B );
-        coeffs[0] += 1.0/(2.0*sqrt(itk::Math::pi));
-        coeffPixel = coeffs.data_block();
-        odf = ( m_ReconstructionMatrix * B ).data_block();
+        coeffPixel = coeffs[signalRows[v]];
+        odf = odfs[signalRows[v]];
+        odf = Normalize(odf, b0s[v]);
       }
-      odf = Normalize(odf, b0);
-    }
 
-    oit.Set( odf );
-    oit2.Set( b0 );
-    float sum = 0;
-    for (unsigned int k=0; k<odf.Size(); k++)
-      sum += (float) odf[k];
-    oit3.Set( sum-1 );
-    oit4.Set(coeffPixel);
-    ++oit;  // odf image iterator
-    ++oit3; // odf sum image iterator
-    ++oit2; // b0 image iterator
-    ++oit4; // coefficient image iterator
-    ++git;  // Gradient  image iterator
+      oit.Set( odf );
+      oit2.Set( b0s[v] );
+      float sum = 0;
+      for (unsigned int k=0; k<odf.Size(); k++)
+        sum += (float) odf[k];
+      oit3.Set( sum-1 );
+      oit4.Set(coeffPixel);
+      ++oit;  // odf image iterator
+      ++oit3; // odf sum image iterator
+      ++oit2; // b0 image iterator
+      ++oit4; // coefficient image iterator
+    }
   }
 
   std::cout << "One Thread finished reconstruction" << std::endl;
@@ -23,6 +23,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vnl/algo/vnl_svd.h"
 #include "itkVectorContainer.h"
 #include "itkVectorImage.h"
+#include "itkVoxelBlockReconstruction.h"
 
 
 namespace itk{
@@ -233,6 +234,9 @@ private:
     vnl_matrix< float >                       m_ReconstructionMatrix;
     vnl_matrix< float >                       m_CoeffReconstructionMatrix;
     vnl_matrix< float >                       m_SphericalHarmonicBasisMatrix;
+    /** coefficient and ODF reconstruction applied to blocks of voxels, the ODF is computed from the coefficients for QBAR_SOLID_ANGLE */
+    VoxelBlockReconstruction< TOdfPixelType >         m_CoeffBlockReconstruction;
+    VoxelBlockReconstruction< TOdfPixelType >         m_OdfBlockReconstruction;
     /** container to hold gradient directions */
     GradientDirectionContainerType::Pointer           m_GradientDirectionContainer;
     /** Number of gradient measurements */
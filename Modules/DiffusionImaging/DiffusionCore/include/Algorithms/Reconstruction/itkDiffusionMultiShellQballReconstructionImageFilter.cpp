@@ -638,52 +638,79 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
 
   typedef typename GradientImagesType::PixelType         GradientVectorType;
 
+  // The voxels are reconstructed in blocks, see AnalyticalThreeShellReconstruction
+  typedef VoxelBlockReconstruction< double > BlockReconstructionType;
+  const unsigned int blockSize = BlockReconstructionType::BlockSize;
+  typename BlockReconstructionType::BlockType signals = BlockReconstructionType::CreateBlock(NumbersOfGradientIndicies);
+  typename BlockReconstructionType::BlockType coeffs = m_CoeffBlockReconstruction.CreateOutputBlock();
+  typename BlockReconstructionType::BlockType odfs = m_OdfBlockReconstruction.CreateOutputBlock();
+  std::vector< int > signalRows(blockSize); // row of the voxel in the signal block, -1 if it is below the threshold
+
+  // Create the Signal Vector
+  vnl_vector<double> SignalVector(NumbersOfGradientIndicies);
+
   // iterate overall voxels of the gradient image region
   while( ! git.IsAtEnd() )
   {
-    GradientVectorType b = git.Get();
-    // ODF Vector
-    OdfPixelType odf(0.0);
-
-    double b0average = 0;
-    const unsigned int b0size = BZeroIndicies.size();
-    for(unsigned int i = 0; i < b0size ; ++i)
-    {
-      b0average += b[BZeroIndicies[i]];
-    }
-    b0average /= b0size;
-    bzeroIterator.Set(b0average);
-    ++bzeroIterator;
-
-    // Create the Signal Vector
-    vnl_vector<double> SignalVector(NumbersOfGradientIndicies);
-    if( (b0average != 0) && (b0average >= m_Threshold) )
+    unsigned int numberOfVoxels = 0;
+    unsigned int numberOfSignals = 0;
+    for( ; numberOfVoxels < blockSize && ! git.IsAtEnd(); ++numberOfVoxels, ++git )
     {
+      GradientVectorType b = git.Get();
 
-      for( unsigned int i = 0; i< SignalIndicies.size(); i++ )
+      double b0average = 0;
+      const unsigned int b0size = BZeroIndicies.size();
+      for(unsigned int i = 0; i < b0size ; ++i)
       {
-        SignalVector[i] = static_cast<double>(b[SignalIndicies[i]]);
+        b0average += b[BZeroIndicies[i]];
       }
+      b0average /= b0size;
+      bzeroIterator.Set(b0average);
+      ++bzeroIterator;
 
-      // apply threashold an generate ln(-ln(E)) signal
-      // Replace SignalVector with PreNormalized SignalVector
-      S_S0Normalization(SignalVector, b0average);
-      Projection1(SignalVector);
+      signalRows[numberOfVoxels] = -1;
+      if( (b0average != 0) && (b0average >= m_Threshold) )
+      {
 
-      DoubleLogarithm(SignalVector);
+        for( unsigned int i = 0; i< SignalIndicies.size(); i++ )
+        {
+          SignalVector[i] = static_cast<double>(b[SignalIndicies[i]]);
+        }
 
-      // approximate ODF coeffs
-      vnl_vector<double>  coeffs = ( (*m_CoeffReconstructionMatrix) * SignalVector );
-      coeffs[0] = 1.0/(2.0*sqrt(itk::Math::pi));
+        // apply threashold an generate ln(-ln(E)) signal
+        // Replace SignalVector with PreNormalized SignalVector
+        S_S0Normalization(SignalVector, b0average);
+        Projection1(SignalVector);
 
-      odf = element_cast<double, TO>(( (*m_ODFSphericalHarmonicBasisMatrix) * coeffs )).data_block();
-      odf *= (itk::Math::pi*4/NODF);
+        DoubleLogarithm(SignalVector);
+
+        signals.set_row(numberOfSignals, SignalVector);
+        signalRows[numberOfVoxels] = numberOfSignals++;
+      }
     }
-    // set ODF to ODF-Image
-    oit.Set( odf );
-    ++oit;
-    ++git;
 
+    // approximate ODF coeffs
+    m_CoeffBlockReconstruction.Apply(signals, numberOfSignals, coeffs);
+    for( unsigned int i = 0; i < numberOfSignals; i++ )
+      coeffs[i][0] = 1.0/(2.0*sqrt(itk::Math::pi));
+
+    m_OdfBlockReconstruction.Apply(coeffs, numberOfSignals, odfs);
+
+    for( unsigned int v = 0; v < numberOfVoxels; v++ )
+    {
+      // ODF Vector
+      OdfPixelType odf(0.0);
+      if( signalRows[v] >= 0 )
+      {
+        const double* odfRow = odfs[signalRows[v]];
+        for( unsigned int k = 0; k < NODF; k++ )
+          odf[k] = static_cast<TO>(odfRow[k]);
+        odf *= (itk::Math::pi*4/NODF);
+      }
+      // set ODF to ODF-Image
+      oit.Set( odf );
+      ++oit;
+    }
   }
 }
 
@@ -768,15 +795,30 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
   vnl_vector<double> DataShell2(Shell2Indiecies.size());
   vnl_vector<double> DataShell3(Shell3Indiecies.size());
 
-  vnl_matrix<double> tempInterpolationMatrixShell1,tempInterpolationMatrixShell2,tempInterpolationMatrixShell3;
+  // The voxels are reconstructed in blocks: the normalized signals of the voxels above the threshold are gathered as
+  // rows of one matrix per shell, the linear steps (interpolation and SH fit) are applied to all of them at once and
+  // the results are written back in the order the voxels were visited. Only the projections run per voxel.
+  typedef VoxelBlockReconstruction< double > BlockReconstructionType;
+  typedef typename BlockReconstructionType::BlockType BlockType;
+  const unsigned int blockSize = BlockReconstructionType::BlockSize;
 
+  BlockReconstructionType interpolationShell1, interpolationShell2, interpolationShell3;
   if(m_Interpolation_Flag)
   {
-    tempInterpolationMatrixShell1 = (*m_TARGET_SH_shell1) * (*m_Interpolation_SHT1_inv);
-    tempInterpolationMatrixShell2 = (*m_TARGET_SH_shell2) * (*m_Interpolation_SHT2_inv);
-    tempInterpolationMatrixShell3 = (*m_TARGET_SH_shell3) * (*m_Interpolation_SHT3_inv);
+    interpolationShell1.SetMatrix( (*m_TARGET_SH_shell1) * (*m_Interpolation_SHT1_inv) );
+    interpolationShell2.SetMatrix( (*m_TARGET_SH_shell2) * (*m_Interpolation_SHT2_inv) );
+    interpolationShell3.SetMatrix( (*m_TARGET_SH_shell3) * (*m_Interpolation_SHT3_inv) );
   }
 
+  BlockType dataShell1 = BlockReconstructionType::CreateBlock(Shell1Indiecies.size());
+  BlockType dataShell2 = BlockReconstructionType::CreateBlock(Shell2Indiecies.size());
+  BlockType dataShell3 = BlockReconstructionType::CreateBlock(Shell3Indiecies.size());
+  BlockType interpolatedShell1, interpolatedShell2, interpolatedShell3;
+  BlockType signals = BlockReconstructionType::CreateBlock(m_MaxDirections);
+  BlockType coeffs = m_CoeffBlockReconstruction.CreateOutputBlock();
+  BlockType odfs = m_OdfBlockReconstruction.CreateOutputBlock();
+  std::vector< int > signalRows(blockSize); // row of the voxel in the signal blocks, -1 if it is below the threshold
+
   OdfPixelType odf(0.0);
   typename CoefficientImageType::PixelType coeffPixel(0.0);
 
@@ -787,96 +829,112 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
   // iterate overall voxels of the gradient image region
   while( ! gradientInputImageIterator.IsAtEnd() )
   {
+    unsigned int numberOfVoxels = 0;
+    unsigned int numberOfSignals = 0;
+    for( ; numberOfVoxels < blockSize && ! gradientInputImageIterator.IsAtEnd(); ++numberOfVoxels, ++gradientInputImageIterator )
+    {
+      GradientVectorType b = gradientInputImageIterator.Get();
 
-    odf = 0.0;
-    coeffPixel = 0.0;
-
-    GradientVectorType b = gradientInputImageIterator.Get();
-
-    // calculate for each shell the corresponding b0-averages
-    double shell1b0Norm =0;
-    double shell2b0Norm =0;
-    double shell3b0Norm =0;
-    double b0average = 0;
-    const unsigned int b0size = BZeroIndicies.size();
+      // calculate for each shell the corresponding b0-averages
+      double shell1b0Norm =0;
+      double shell2b0Norm =0;
+      double shell3b0Norm =0;
+      double b0average = 0;
+      const unsigned int b0size = BZeroIndicies.size();
 
-    if(b0size == 1)
-    {
-      shell1b0Norm = b[BZeroIndicies[0]];
-      shell2b0Norm = b[BZeroIndicies[0]];
-      shell3b0Norm = b[BZeroIndicies[0]];
-      b0average = b[BZeroIndicies[0]];
-    }else if(b0size % 3 ==0)
-    {
-      for(unsigned int i = 0; i < b0size ; ++i)
+      if(b0size == 1)
+      {
+        shell1b0Norm = b[BZeroIndicies[0]];
+        shell2b0Norm = b[BZeroIndicies[0]];
+        shell3b0Norm = b[BZeroIndicies[0]];
+        b0average = b[BZeroIndicies[0]];
+      }else if(b0size % 3 ==0)
       {
-        if(i < b0size / 3)                          shell1b0Norm += b[BZeroIndicies[i]];
-        if(i >= b0size / 3 && i < (b0size / 3)*2)   shell2b0Norm += b[BZeroIndicies[i]];
-        if(i >= (b0size / 3) * 2)                   shell3b0Norm += b[BZeroIndicies[i]];
+        for(unsigned int i = 0; i < b0size ; ++i)
+        {
+          if(i < b0size / 3)                          shell1b0Norm += b[BZeroIndicies[i]];
+          if(i >= b0size / 3 && i < (b0size / 3)*2)   shell2b0Norm += b[BZeroIndicies[i]];
+          if(i >= (b0size / 3) * 2)                   shell3b0Norm += b[BZeroIndicies[i]];
+        }
+        shell1b0Norm /= (b0size/3);
+        shell2b0Norm /= (b0size/3);
+        shell3b0Norm /= (b0size/3);
+        b0average = (shell1b0Norm + shell2b0Norm+ shell3b0Norm)/3;
+      }else
+      {
+        for(unsigned int i = 0; i <b0size ; ++i)
+        {
+          shell1b0Norm += b[BZeroIndicies[i]];
+        }
+        shell1b0Norm /= b0size;
+        shell2b0Norm = shell1b0Norm;
+        shell3b0Norm = shell1b0Norm;
+        b0average = shell1b0Norm;
       }
-      shell1b0Norm /= (b0size/3);
-      shell2b0Norm /= (b0size/3);
-      shell3b0Norm /= (b0size/3);
-      b0average = (shell1b0Norm + shell2b0Norm+ shell3b0Norm)/3;
-    }else
-    {
-      for(unsigned int i = 0; i <b0size ; ++i)
+
+      bzeroIterator.Set(b0average);
+      ++bzeroIterator;
+
+      signalRows[numberOfVoxels] = -1;
+      if( (b0average != 0) && ( b0average >= m_Threshold) )
       {
-        shell1b0Norm += b[BZeroIndicies[i]];
+        // Get the Signal-Value for each Shell at each direction (specified in the ShellIndicies Vector .. this direction corresponse to this shell...)
+
+        /*//fsl fix ---------------------------------------------------
+        for(int i = 0 ; i < Shell1Indiecies.size(); i++)
+          DataShell1[i] = static_cast<double>(b[Shell1Indiecies[i]]);
+        for(int i = 0 ; i < Shell2Indiecies.size(); i++)
+          DataShell2[i] = static_cast<double>(b[Shell2Indiecies[i]]);
+        for(int i = 0 ; i < Shell3Indiecies.size(); i++)
+          DataShell3[i] = static_cast<double>(b[Shell2Indiecies[i]]);
+
+        // Normalize the Signal: Si/S0
+        S_S0Normalization(DataShell1, shell1b0Norm);
+        S_S0Normalization(DataShell2, shell2b0Norm);
+        S_S0Normalization(DataShell3, shell2b0Norm);
+        *///fsl fix -------------------------------------------ende--
+
+        ///correct version
+        for(unsigned int i = 0 ; i < Shell1Indiecies.size(); i++)
+          DataShell1[i] = static_cast<double>(b[Shell1Indiecies[i]]);
+        for(unsigned int i = 0 ; i < Shell2Indiecies.size(); i++)
+          DataShell2[i] = static_cast<double>(b[Shell2Indiecies[i]]);
+        for(unsigned int i = 0 ; i < Shell3Indiecies.size(); i++)
+          DataShell3[i] = static_cast<double>(b[Shell3Indiecies[i]]);
+
+
+
+        // Normalize the Signal: Si/S0
+        S_S0Normalization(DataShell1, shell1b0Norm);
+        S_S0Normalization(DataShell2, shell2b0Norm);
+        S_S0Normalization(DataShell3, shell3b0Norm);
+
+
+        dataShell1.set_row(numberOfSignals, DataShell1);
+        dataShell2.set_row(numberOfSignals, DataShell2);
+        dataShell3.set_row(numberOfSignals, DataShell3);
+        signalRows[numberOfVoxels] = numberOfSignals++;
       }
-      shell1b0Norm /= b0size;
-      shell2b0Norm = shell1b0Norm;
-      shell3b0Norm = shell1b0Norm;
-      b0average = shell1b0Norm;
     }
 
-    bzeroIterator.Set(b0average);
-    ++bzeroIterator;
-
-    if( (b0average != 0) && ( b0average >= m_Threshold) )
+    const BlockType* shell1 = &dataShell1;
+    const BlockType* shell2 = &dataShell2;
+    const BlockType* shell3 = &dataShell3;
+    if(m_Interpolation_Flag)
     {
-      // Get the Signal-Value for each Shell at each direction (specified in the ShellIndicies Vector .. this direction corresponse to this shell...)
-
-      /*//fsl fix ---------------------------------------------------
-      for(int i = 0 ; i < Shell1Indiecies.size(); i++)
-        DataShell1[i] = static_cast<double>(b[Shell1Indiecies[i]]);
-      for(int i = 0 ; i < Shell2Indiecies.size(); i++)
-        DataShell2[i] = static_cast<double>(b[Shell2Indiecies[i]]);
-      for(int i = 0 ; i < Shell3Indiecies.size(); i++)
-        DataShell3[i] = static_cast<double>(b[Shell2Indiecies[i]]);
-
-      // Normalize the Signal: Si/S0
-      S_S0Normalization(DataShell1, shell1b0Norm);
-      S_S0Normalization(DataShell2, shell2b0Norm);
-      S_S0Normalization(DataShell3, shell2b0Norm);
-      *///fsl fix -------------------------------------------ende--
-
-      ///correct version
-      for(unsigned int i = 0 ; i < Shell1Indiecies.size(); i++)
-        DataShell1[i] = static_cast<double>(b[Shell1Indiecies[i]]);
-      for(unsigned int i = 0 ; i < Shell2Indiecies.size(); i++)
-        DataShell2[i] = static_cast<double>(b[Shell2Indiecies[i]]);
-      for(unsigned int i = 0 ; i < Shell3Indiecies.size(); i++)
-        DataShell3[i] = static_cast<double>(b[Shell3Indiecies[i]]);
-
-
-
-      // Normalize the Signal: Si/S0
-      S_S0Normalization(DataShell1, shell1b0Norm);
-      S_S0Normalization(DataShell2, shell2b0Norm);
-      S_S0Normalization(DataShell3, shell3b0Norm);
-
+      interpolationShell1.Apply(dataShell1, numberOfSignals, interpolatedShell1);
+      interpolationShell2.Apply(dataShell2, numberOfSignals, interpolatedShell2);
+      interpolationShell3.Apply(dataShell3, numberOfSignals, interpolatedShell3);
+      shell1 = &interpolatedShell1;
+      shell2 = &interpolatedShell2;
+      shell3 = &interpolatedShell3;
+    }
 
-      if(m_Interpolation_Flag)
-      {
-        E1 = tempInterpolationMatrixShell1 * DataShell1;
-        E2 = tempInterpolationMatrixShell2 * DataShell2;
-        E3 = tempInterpolationMatrixShell3 * DataShell3;
-      }else{
-        E1 = (DataShell1);
-        E2 = (DataShell2);
-        E3 = (DataShell3);
-      }
+    for( unsigned int s = 0; s < numberOfSignals; s++ )
+    {
+      E1 = shell1->get_row(s);
+      E2 = shell2->get_row(s);
+      E3 = shell3->get_row(s);
 
       //Implements Eq. [19] and Fig. 4.
       Projection1(E1);
@@ -932,24 +990,40 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NODF>
       DoubleLogarithm(BetaValues);
 
       vnl_vector<double> SignalVector(element_product((LAValues) , (AlphaValues)-(BetaValues)) + (BetaValues));
+      signals.set_row(s, SignalVector);
+    }
 
-      vnl_vector<double> coeffs((*m_CoeffReconstructionMatrix) *SignalVector );
+    m_CoeffBlockReconstruction.Apply(signals, numberOfSignals, coeffs);
 
-      // the first coeff is a fix value
-      coeffs[0] = 1.0/(2.0*sqrt(itk::Math::pi));
-      coeffPixel = element_cast<double, TO>(coeffs).data_block();
+    // the first coeff is a fix value
+    for( unsigned int s = 0; s < numberOfSignals; s++ )
+      coeffs[s][0] = 1.0/(2.0*sqrt(itk::Math::pi));
 
-      // Cast the Signal-Type from double to float for the ODF-Image
-      odf = element_cast<double, TO>( (*m_ODFSphericalHarmonicBasisMatrix) * coeffs ).data_block();
-      odf *= ((itk::Math::pi*4)/NODF);
-    }
+    m_OdfBlockReconstruction.Apply(coeffs, numberOfSignals, odfs);
 
-    // set ODF to ODF-Image
-    coefficientImageIterator.Set(coeffPixel);
-    odfOutputImageIterator.Set( odf );
-    ++odfOutputImageIterator;
-    ++coefficientImageIterator;
-    ++gradientInputImageIterator;
+    for( unsigned int v = 0; v < numberOfVoxels; v++ )
+    {
+      odf = 0.0;
+      coeffPixel = 0.0;
+
+      if( signalRows[v] >= 0 )
+      {
+        // Cast the Signal-Type from double to float for the ODF-Image
+        const double* coeffRow = coeffs[signalRows[v]];
+        for( unsigned int k = 0; k < coeffPixel.Size(); k++ )
+          coeffPixel[k] = static_cast<TO>(coeffRow[k]);
+        const double* odfRow = odfs[signalRows[v]];
+        for( unsigned int k = 0; k < NODF; k++ )
+          odf[k] = static_cast<TO>(odfRow[k]);
+        odf *= ((itk::Math::pi*4)/NODF);
+      }
+
+      // set ODF to ODF-Image
+      coefficientImageIterator.Set(coeffPixel);
+      odfOutputImageIterator.Set( odf );
+      ++odfOutputImageIterator;
+      ++coefficientImageIterator;
+    }
   }
 
 }
@@ -1065,6 +1139,9 @@ void DiffusionMultiShellQballReconstructionImageFilter<T,TG,TO,L,NOdfDirections>
   MatrixDoublePtr tempPtr (new vnl_matrix<double>( U->as_matrix() ));
   m_ODFSphericalHarmonicBasisMatrix  = new vnl_matrix<double>(NOdfDirections,NumberOfCoeffs);
   ComputeSphericalHarmonicsBasis(tempPtr.get(), m_ODFSphericalHarmonicBasisMatrix, LOrder);
+
+  m_CoeffBlockReconstruction.SetMatrix(*m_CoeffReconstructionMatrix);
+  m_OdfBlockReconstruction.SetMatrix(*m_ODFSphericalHarmonicBasisMatrix);
 }
 
 template< class T, class TG, class TO, int L, int NOdfDirections>
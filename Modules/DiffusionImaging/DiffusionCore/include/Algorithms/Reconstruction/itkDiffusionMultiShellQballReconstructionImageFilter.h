@@ -18,6 +18,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define __itkDiffusionMultiShellQballReconstructionImageFilter_h_
 
 #include <itkImageToImageFilter.h>
+#include <itkVoxelBlockReconstruction.h>
 
 namespace itk{
 /** \class DiffusionMultiShellQballReconstructionImageFilter
@@ -139,6 +140,9 @@ private:
 
     vnl_matrix< double > * m_CoeffReconstructionMatrix;
     vnl_matrix< double > * m_ODFSphericalHarmonicBasisMatrix;
+    /** the two matrices above, applied to blocks of voxels */
+    VoxelBlockReconstruction< double > m_CoeffBlockReconstruction;
+    VoxelBlockReconstruction< double > m_OdfBlockReconstruction;
 
     /** container to hold gradient directions */
     GradientDirectionContainerType::Pointer m_GradientDirectionContainer;
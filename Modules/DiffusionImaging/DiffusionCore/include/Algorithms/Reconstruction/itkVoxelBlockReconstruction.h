@@ -0,0 +1,148 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __itkVoxelBlockReconstruction_h_
+#define __itkVoxelBlockReconstruction_h_
+
+#include <vnl/vnl_matrix.h>
+#include <algorithm>
+
+namespace itk{
+/** \class VoxelBlockReconstruction
+ * \brief Applies a linear reconstruction matrix to the signals of a block of voxels at once.
+ *
+ * The reconstruction filters gather the (pre-normalized) signals of up to BlockSize voxels as rows of one
+ * contiguous BlockType and compute the reconstruction of all of them with Apply(), which is a matrix-matrix
+ * product instead of one matrix-vector product and a few temporary vectors per voxel. The matrix is stored
+ * transposed and is traversed once for every four voxels, the inner loop runs over contiguous memory.
+ *
+ * The products are accumulated in the same order as vnl_matrix * vnl_vector does, so the results are the same
+ * as with the per voxel reconstruction. Instances are not modified by Apply() and can be shared by threads.
+ */
+template< class TValue >
+class VoxelBlockReconstruction
+{
+public:
+
+    /** One row per voxel */
+    typedef vnl_matrix< TValue >                      BlockType;
+
+    /** Number of voxels the filters gather before reconstructing them */
+    static const unsigned int BlockSize = 256;
+
+    VoxelBlockReconstruction() : m_NumberOfOutputs(0), m_NumberOfInputs(0) {}
+
+    template< class TMatrixValue >
+    explicit VoxelBlockReconstruction( const vnl_matrix< TMatrixValue >& matrix )
+    {
+        SetMatrix(matrix);
+    }
+
+    /** Reconstruction matrix, one row per output value and one column per signal value */
+    template< class TMatrixValue >
+    void SetMatrix( const vnl_matrix< TMatrixValue >& matrix )
+    {
+        m_NumberOfOutputs = matrix.rows();
+        m_NumberOfInputs = matrix.columns();
+        m_TransposedMatrix.set_size(m_NumberOfInputs, m_NumberOfOutputs);
+        for (unsigned int r=0; r<m_NumberOfOutputs; r++)
+            for (unsigned int c=0; c<m_NumberOfInputs; c++)
+                m_TransposedMatrix(c, r) = static_cast< TValue >( matrix(r, c) );
+    }
+
+    unsigned int GetNumberOfInputs() const { return m_NumberOfInputs; }
+    unsigned int GetNumberOfOutputs() const { return m_NumberOfOutputs; }
+
+    /** Block for BlockSize voxels with signals of the given length */
+    static BlockType CreateBlock( unsigned int length ) { return BlockType(BlockSize, length, TValue(0)); }
+
+    /** Block for BlockSize voxels that takes the results of Apply() */
+    BlockType CreateOutputBlock() const { return CreateBlock(m_NumberOfOutputs); }
+
+    /**
+     * \brief Row v of output is the matrix times row v of input, for the first numberOfVoxels rows.
+     *
+     * input needs GetNumberOfInputs() columns, output is resized if it does not fit.
+     */
+    void Apply( const BlockType& input, unsigned int numberOfVoxels, BlockType& output ) const
+    {
+        if (output.rows() < numberOfVoxels || output.columns() != m_NumberOfOutputs)
+            output.set_size(std::max(numberOfVoxels, input.rows()), m_NumberOfOutputs);
+
+        unsigned int v = 0;
+        for (; v+4 <= numberOfVoxels; v += 4)
+        {
+            const TValue* s0 = input[v];
+            const TValue* s1 = input[v+1];
+            const TValue* s2 = input[v+2];
+            const TValue* s3 = input[v+3];
+            TValue* o0 = output[v];
+            TValue* o1 = output[v+1];
+            TValue* o2 = output[v+2];
+            TValue* o3 = output[v+3];
+
+            for (unsigned int k=0; k<m_NumberOfOutputs; k++)
+            {
+                o0[k] = 0; o1[k] = 0; o2[k] = 0; o3[k] = 0;
+            }
+
+            for (unsigned int i=0; i<m_NumberOfInputs; i++)
+            {
+                const TValue* m = m_TransposedMatrix[i];
+                const TValue a0 = s0[i];
+                const TValue a1 = s1[i];
+                const TValue a2 = s2[i];
+                const TValue a3 = s3[i];
+                for (unsigned int k=0; k<m_NumberOfOutputs; k++)
+                {
+                    const TValue mk = m[k];
+                    o0[k] += mk*a0;
+                    o1[k] += mk*a1;
+                    o2[k] += mk*a2;
+                    o3[k] += mk*a3;
+                }
+            }
+        }
+
+        for (; v<numberOfVoxels; v++)
+        {
+            const TValue* s = input[v];
+            TValue* o = output[v];
+            for (unsigned int k=0; k<m_NumberOfOutputs; k++)
+                o[k] = 0;
+
+            for (unsigned int i=0; i<m_NumberOfInputs; i++)
+            {
+                const TValue* m = m_TransposedMatrix[i];
+                const TValue a = s[i];
+                for (unsigned int k=0; k<m_NumberOfOutputs; k++)
+                    o[k] += m[k]*a;
+            }
+        }
+    }
+
+private:
+
+    unsigned int                                      m_NumberOfOutputs;
+    unsigned int                                      m_NumberOfInputs;
+    vnl_matrix< TValue >                              m_TransposedMatrix;
+};
+
+template< class TValue >
+const unsigned int VoxelBlockReconstruction< TValue >::BlockSize;
+
+}
+
+#endif //__itkVoxelBlockReconstruction_h_
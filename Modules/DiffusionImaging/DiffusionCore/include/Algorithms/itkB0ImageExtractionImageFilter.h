@@ -18,6 +18,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #define __itkB0ImageExtractionImageFilter_h_
 
 #include "itkImageToImageFilter.h"
+#include "itkVectorImage.h"
+#include "itkVectorContainer.h"
+#include <vector>
 
 namespace itk{
   /** \class B0ImageExtractionImageFilter
@@ -74,9 +77,11 @@ namespace itk{
     B0ImageExtractionImageFilter();
     ~B0ImageExtractionImageFilter() override {};
 
-    void GenerateData() override;
+    void BeforeThreadedGenerateData() override;
+    void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType ) override;
 
     GradientDirectionContainerType::Pointer   m_Directions;
+    std::vector< unsigned int >               m_B0Indices;
 
   };
 
@@ -25,6 +25,7 @@ This file is based heavily on a corresponding ITK filter.
 #include "itkB0ImageExtractionImageFilter.h"
 
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
 
 namespace itk {
 
@@ -43,81 +44,50 @@ namespace itk {
   class TOutputImagePixelType >
     void B0ImageExtractionImageFilter< TInputImagePixelType,
     TOutputImagePixelType >
-    ::GenerateData()
+    ::BeforeThreadedGenerateData()
   {
-
     typename GradientDirectionContainerType::Iterator begin = m_Directions->Begin();
     typename GradientDirectionContainerType::Iterator end = m_Directions->End();
 
     // Find the index of the b0 image
-    std::vector<int> indices;
-    int index = 0;
+    m_B0Indices.clear();
+    unsigned int index = 0;
     while(begin!=end)
     {
       GradientDirectionType grad = begin->Value();
 
       if(grad[0] == 0 && grad[1] == 0 && grad[2] == 0)
       {
-        indices.push_back(index);
+        m_B0Indices.push_back(index);
       }
       ++index;
       ++begin;
     }
+  }
 
-    typedef itk::Image<float,3> TempImageType;
-    TempImageType::Pointer tmp = TempImageType::New();
-    typename TempImageType::RegionType region = this->GetInput()->GetLargestPossibleRegion();
-
-    tmp->SetSpacing(this->GetInput()->GetSpacing());
-    tmp->SetOrigin(this->GetInput()->GetOrigin());
-    tmp->SetDirection(this->GetInput()->GetDirection());
-    tmp->SetRegions(region);
-    tmp->Allocate();
-
-    itk::ImageRegionIterator<TempImageType> it(tmp.GetPointer(), tmp->GetLargestPossibleRegion() );
-    itk::ImageRegionConstIterator<InputImageType> vectorIt(this->GetInput(), this->GetInput()->GetLargestPossibleRegion() );
-
-    it.GoToBegin();
-    while(!it.IsAtEnd())
-    {
-      it.Set(0);
-      ++it;
-    }
+  template< class TInputImagePixelType,
+  class TOutputImagePixelType >
+    void B0ImageExtractionImageFilter< TInputImagePixelType,
+    TOutputImagePixelType >
+    ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
+  {
+    // Only the requested region of the input is read, so the filter can be streamed.
+    itk::ImageRegionConstIterator<InputImageType> vectorIt(this->GetInput(), outputRegionForThread );
+    itk::ImageRegionIterator<OutputImageType> itOut(this->GetOutput(), outputRegionForThread );
 
-    //Sum all images that have zero diffusion weighting (indices stored in vector index)
-    for(std::vector<int>::iterator indexIt = indices.begin();
-      indexIt != indices.end();
-      indexIt++)
+    const double numberOfB0Images = m_B0Indices.size();
+    while(!itOut.IsAtEnd())
     {
-      it.GoToBegin();
-      vectorIt.GoToBegin();
+      typename InputImageType::PixelType vec = vectorIt.Get();
 
-      while(!it.IsAtEnd() && !vectorIt.IsAtEnd())
-      {
-        typename InputImageType::PixelType vec = vectorIt.Get();
-        it.Set((1.0 * it.Get()) + (1.0 * vec[*indexIt]) / (1.0 * indices.size()));
-        ++it;
-        ++vectorIt;
-      }
-    }
+      //Sum all images that have zero diffusion weighting, in float precision like the whole b0 image before
+      float b0 = 0;
+      for(unsigned int i = 0; i < m_B0Indices.size(); i++)
+        b0 = (1.0 * b0) + (1.0 * vec[m_B0Indices[i]]) / numberOfB0Images;
 
-    typename OutputImageType::Pointer b0Image =
-      static_cast< OutputImageType * >(this->ProcessObject::GetPrimaryOutput());
-    typename OutputImageType::RegionType outregion = this->GetInput()->GetLargestPossibleRegion();
-    b0Image->SetSpacing(this->GetInput()->GetSpacing());
-    b0Image->SetOrigin(this->GetInput()->GetOrigin());
-    b0Image->SetDirection(this->GetInput()->GetDirection());
-    b0Image->SetRegions(outregion);
-    b0Image->Allocate();
-    itk::ImageRegionIterator<TempImageType> itIn(tmp, tmp->GetLargestPossibleRegion() );
-    itk::ImageRegionIterator<OutputImageType> itOut(b0Image, b0Image->GetLargestPossibleRegion() );
-    itIn.GoToBegin();
-    itOut.GoToBegin();
-    while(!itIn.IsAtEnd())
-    {
-      itOut.Set(itIn.Get());
-      ++itIn;
+      itOut.Set(b0);
       ++itOut;
+      ++vectorIt;
     }
   }
 
@@ -78,9 +78,14 @@ public:
     ~DwiNormilzationFilter() {}
     void PrintSelf(std::ostream& os, Indent indent) const;
 
+    /** The mean and standard deviation are taken over the whole input, the output can be generated region by region */
+    void GenerateInputRequestedRegion() override;
     void BeforeThreadedGenerateData();
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType);
 
+    /** Mean and standard deviation of the diffusion weighted values inside of the mask, in one pass over the input */
+    void ComputeStatistics();
+
     UcharImageType::Pointer m_MaskImage;
     GradientContainerType   m_GradientDirections;
     int                     m_B0Index;
@@ -89,6 +94,8 @@ public:
     double                  m_Stdev;
     double                  m_NewMean;
     double                  m_NewStdev;
+    /** the statistics are only computed again if the input, the mask or the filter changed (e.g. for every streamed region) */
+    ModifiedTimeType        m_StatisticsMTime;
 };
 
 }
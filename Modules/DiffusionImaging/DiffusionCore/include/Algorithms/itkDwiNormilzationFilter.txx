@@ -28,6 +28,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "itkImageRegionConstIteratorWithIndex.h"
 #include "itkImageRegionIterator.h"
 #include <itkNumericTraits.h>
+#include <algorithm>
 
 namespace itk {
 
@@ -37,6 +38,7 @@ DwiNormilzationFilter< TInPixelType>::DwiNormilzationFilter()
     : m_B0Index(-1)
     , m_NewMean(1000)
     , m_NewStdev(500)
+    , m_StatisticsMTime(0)
 {
     this->SetNumberOfRequiredInputs( 1 );
 }
@@ -70,51 +72,69 @@ void DwiNormilzationFilter< TInPixelType>::BeforeThreadedGenerateData()
     else
       std::cout << "DwiNormilzationFilter: using mask image" << std::endl;
 
+    ModifiedTimeType mtime = std::max(inputImagePointer->GetMTime(), m_MaskImage->GetMTime());
+    mtime = std::max(mtime, this->GetMTime());
+    if (mtime > m_StatisticsMTime)
+    {
+      ComputeStatistics();
+      m_StatisticsMTime = mtime;
+    }
+}
+
+template< class TInPixelType >
+void DwiNormilzationFilter< TInPixelType>::GenerateInputRequestedRegion()
+{
+    Superclass::GenerateInputRequestedRegion();
+
+    InputImageType* inputImagePointer = const_cast< InputImageType * >( this->GetInput() );
+    if ( inputImagePointer )
+      inputImagePointer->SetRequestedRegionToLargestPossibleRegion();
+}
+
+template< class TInPixelType >
+void DwiNormilzationFilter< TInPixelType>::ComputeStatistics()
+{
+    typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
     InputIteratorType git( inputImagePointer, inputImagePointer->GetLargestPossibleRegion() );
     MaskIteratorType mit( m_MaskImage, m_MaskImage->GetLargestPossibleRegion() );
     git.GoToBegin();
     mit.GoToBegin();
 
+    // sums of the values shifted by the first value inside of the mask, which avoids the cancellation of the
+    // plain sum of squares without a second pass over the input
+    const unsigned int vectorLength = inputImagePointer->GetVectorLength();
+    bool shiftSet = false;
+    double shift = 0;
+    double sum = 0;
+    double sumOfSquares = 0;
     int n = 0;
-    m_Mean = 0;
-    m_Stdev = 0;
     while( !git.IsAtEnd() )
     {
       if (mit.Get()>0)
       {
-        for (unsigned int i=0; i<inputImagePointer->GetVectorLength(); i++)
+        const typename InputImageType::PixelType pix = git.Get();
+        for (unsigned int i=0; i<vectorLength; i++)
         {
           if ((int)i==m_B0Index)
             continue;
-          m_Mean += git.Get()[i];
+          if (!shiftSet)
+          {
+            shift = pix[i];
+            shiftSet = true;
+          }
+          double diff = (double)(pix[i]) - shift;
+          sum += diff;
+          sumOfSquares += diff*diff;
           n++;
         }
       }
       ++git;
       ++mit;
     }
-    m_Mean /= n;
-
-    git.GoToBegin();
-    mit.GoToBegin();
-
-    while( !git.IsAtEnd() )
-    {
-      if (mit.Get()>0)
-      {
-        for (unsigned int i=0; i<inputImagePointer->GetVectorLength(); i++)
-        {
-          if ((int)i==m_B0Index)
-            continue;
-          double diff = (double)(git.Get()[i]) - m_Mean;
-          m_Stdev += diff*diff;
-        }
-      }
-      ++git;
-      ++mit;
-    }
 
-    m_Stdev = std::sqrt(m_Stdev/(n-1));
+    m_Mean = shift + sum/n;
+    m_Stdev = std::sqrt((sumOfSquares - sum*sum/n)/(n-1));
 
     MITK_INFO << "Mean: " << m_Mean;
     MITK_INFO << "Stdev: " << m_Stdev;
@@ -135,11 +155,12 @@ void DwiNormilzationFilter< TInPixelType>::ThreadedGenerateData(const OutputImag
     InputIteratorType git( inputImagePointer, outputRegionForThread );
     git.GoToBegin();
 
+    typename OutputImageType::PixelType outPix;
+    outPix.SetSize(inputImagePointer->GetVectorLength());
+
     while( !git.IsAtEnd() )
     {
         typename InputImageType::PixelType pix = git.Get();
-        typename OutputImageType::PixelType outPix;
-        outPix.SetSize(inputImagePointer->GetVectorLength());
 
         for (unsigned int i=0; i<inputImagePointer->GetVectorLength(); i++)
         {
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "itkImageToImageFilter.h"
 #include "itkVectorImage.h"
+#include <vector>
 
 
 namespace itk{
@@ -27,6 +28,11 @@ namespace itk{
    *
    * This Filter needs as an input a diffusion weigthed image, which will be denoised unsing the non-local means principle.
    * An input mask is optional to denoise only inside the mask range. All other voxels will be set to 0.
+   *
+   * In the fast mode the image is processed in blocks. For every offset inside the search window the squared
+   * differences of the whole block are box filtered with running sums, which yields the patch distances of all
+   * voxels of the block at once, independent of the comparison radius. All gradient channels are handled in the
+   * same pass. Optionally, patches are preselected by their local mean and variance (Coupe et al., 2008).
   */
 
   template< class TPixelType >
@@ -83,6 +89,37 @@ namespace itk{
      * If this flag is true the filter uses a method which is optimized for Rician distributed noise.
      */
     itkSetMacro(UseRicianAdaption, bool)
+    /**
+     * @brief Set flag to use the fast blockwise implementation
+     *
+     * Without preselection the result equals the one of the standard implementation up to floating point rounding.
+     * In the fast mode the rician adaption is also applied to the joint information.
+     * Default is false.
+     */
+    itkSetMacro(UseFastMode, bool)
+    itkGetMacro(UseFastMode, bool)
+    /**
+     * @brief Set the edge length of the blocks processed at once in the fast mode
+     *
+     * Default is 16.
+     */
+    itkSetMacro(BlockSize, int)
+    /**
+     * @brief Set the threshold of the preselection by local mean
+     *
+     * Fast mode only. A voxel of the search window only contributes if the ratio of the local means of both patches
+     * lies in [threshold, 1/threshold]. A typical value is 0.95, 0 disables the preselection.
+     * Default is 0.
+     */
+    itkSetMacro(PreselectionMeanThreshold, double)
+    /**
+     * @brief Set the threshold of the preselection by local variance
+     *
+     * Fast mode only. A voxel of the search window only contributes if the ratio of the local variances of both patches
+     * lies in [threshold, 1/threshold]. A typical value is 0.5, 0 disables the preselection.
+     * Default is 0.
+     */
+    itkSetMacro(PreselectionVarianceThreshold, double)
     /**
      * @brief Get the amount of calculated Voxels
      *
@@ -124,6 +161,21 @@ namespace itk{
      */
     void ThreadedGenerateData( const OutputImageRegionType &outputRegionForThread, ThreadIdType) override;
 
+    /**
+     * @brief Blockwise denoising procedure of the fast mode
+     *
+     * @param outputRegionForThread Region to denoise for each thread.
+     */
+    void ThreadedGenerateDataFast( const OutputImageRegionType &outputRegionForThread );
+
+    /**
+     * @brief Replace every element of a block by the sum over the (2 * radius + 1)³ neighborhood inside the block
+     *
+     * The block is stored x-fastest with the given number of components per voxel. Each axis is processed with running
+     * sums, so the costs do not depend on the radius.
+     */
+    static void BoxSum( std::vector<double>& data, const int size[3], int components, int radius );
+
 
 
   private:
@@ -132,6 +184,10 @@ namespace itk{
     int m_ComparisonRadius;                           ///< Radius of the comparisonblock.
     bool m_UseJointInformation;                       ///< Flag to use joint information.
     bool m_UseRicianAdaption;                         ///< Flag to use rician adaption.
+    bool m_UseFastMode;                               ///< Flag to use the fast blockwise implementation.
+    int m_BlockSize;                                  ///< Edge length of the blocks in fast mode.
+    double m_PreselectionMeanThreshold;               ///< Threshold of the preselection by local mean.
+    double m_PreselectionVarianceThreshold;           ///< Threshold of the preselection by local variance.
     unsigned int m_CurrentVoxelCount;                 ///< Amount of processed voxels.
     double m_Variance;                                ///< Estimated noise variance.
     typename MaskImageType::Pointer m_Mask;           ///< Pointer to the mask image.
@@ -25,9 +25,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cmath>
 
 #include "itkImageRegionIterator.h"
+#include "itkImageRegionConstIterator.h"
 #include "itkNeighborhoodIterator.h"
 #include <itkImageRegionIteratorWithIndex.h>
 #include <vector>
+#include <algorithm>
 
 namespace itk {
 
@@ -39,6 +41,10 @@ NonLocalMeansDenoisingFilter< TPixelType >
     m_ComparisonRadius(1),
     m_UseJointInformation(false),
     m_UseRicianAdaption(false),
+    m_UseFastMode(false),
+    m_BlockSize(16),
+    m_PreselectionMeanThreshold(0),
+    m_PreselectionVarianceThreshold(0),
     m_Variance(1),
     m_Mask(nullptr)
 {
@@ -56,6 +62,7 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "Noisevariance: " << m_Variance;
   MITK_INFO << "Use Rician Adaption: " << std::boolalpha << m_UseRicianAdaption;
   MITK_INFO << "Use Joint Information: " << std::boolalpha << m_UseJointInformation;
+  MITK_INFO << "Use Fast Mode: " << std::boolalpha << m_UseFastMode;
 
 
   typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
@@ -127,6 +134,12 @@ void
 NonLocalMeansDenoisingFilter< TPixelType >
 ::ThreadedGenerateData(const OutputImageRegionType& outputRegionForThread, ThreadIdType )
 {
+  if (m_UseFastMode)
+  {
+    ThreadedGenerateDataFast(outputRegionForThread);
+    MITK_INFO << "One Thread finished calculation";
+    return;
+  }
 
 
   // initialize iterators
@@ -372,6 +385,380 @@ NonLocalMeansDenoisingFilter< TPixelType >
   MITK_INFO << "One Thread finished calculation";
 }
 
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::BoxSum(std::vector<double>& data, const int size[3], int components, int radius)
+{
+  std::vector<double> prefix;
+  const int strides[3] = { components, components * size[0], components * size[0] * size[1] };
+
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    const int n = size[axis];
+    const int stride = strides[axis];
+    const int a1 = axis == 0 ? 1 : 0;
+    const int a2 = axis == 2 ? 1 : 2;
+    prefix.assign((n + 1) * components, 0.0);
+
+    // every line along the axis is replaced by the difference of its prefix sums
+    for (int u = 0; u < size[a1]; ++u)
+    {
+      for (int v = 0; v < size[a2]; ++v)
+      {
+        double* line = &data[u * strides[a1] + v * strides[a2]];
+
+        for (int i = 0; i < n; ++i)
+        {
+          const double* in = line + i * stride;
+          const double* previous = &prefix[i * components];
+          double* current = &prefix[(i + 1) * components];
+          for (int c = 0; c < components; ++c)
+          {
+            current[c] = previous[c] + in[c];
+          }
+        }
+
+        for (int i = 0; i < n; ++i)
+        {
+          const double* upper = &prefix[std::min(i + radius + 1, n) * components];
+          const double* lower = &prefix[std::max(i - radius, 0) * components];
+          double* out = line + i * stride;
+          for (int c = 0; c < components; ++c)
+          {
+            out[c] = upper[c] - lower[c];
+          }
+        }
+      }
+    }
+  }
+}
+
+template< class TPixelType >
+void
+NonLocalMeansDenoisingFilter< TPixelType >
+::ThreadedGenerateDataFast(const OutputImageRegionType& outputRegionForThread)
+{
+  typename OutputImageType::Pointer outputImage =
+          static_cast< OutputImageType * >(this->ProcessObject::GetOutput(0));
+  typename InputImageType::Pointer inputImagePointer = static_cast< InputImageType * >( this->ProcessObject::GetInput(0) );
+
+  const int numberOfChannels = inputImagePointer->GetVectorLength();
+  // joint information shares one weight between all channels
+  const int weightComponents = m_UseJointInformation ? 1 : numberOfChannels;
+  const int r = m_ComparisonRadius;
+  const int s = m_SearchRadius;
+  const int blockSize = m_BlockSize > 0 ? m_BlockSize : 16;
+  const bool usePreselection = m_PreselectionMeanThreshold > 0 || m_PreselectionVarianceThreshold > 0;
+
+  // image extent (end exclusive) and buffer layout
+  int imageStart[3], imageEnd[3], bufferStart[3];
+  long bufferStride[3];
+  const typename InputImageType::RegionType imageRegion = inputImagePointer->GetLargestPossibleRegion();
+  const typename InputImageType::RegionType bufferedRegion = inputImagePointer->GetBufferedRegion();
+  for (int d = 0; d < 3; ++d)
+  {
+    imageStart[d] = imageRegion.GetIndex()[d];
+    imageEnd[d] = imageStart[d] + imageRegion.GetSize()[d];
+    bufferStart[d] = bufferedRegion.GetIndex()[d];
+  }
+  bufferStride[0] = numberOfChannels;
+  bufferStride[1] = bufferStride[0] * bufferedRegion.GetSize()[0];
+  bufferStride[2] = bufferStride[1] * bufferedRegion.GetSize()[1];
+  const TPixelType* buffer = inputImagePointer->GetBufferPointer();
+
+  auto pixel = [&](int x, int y, int z) -> const TPixelType*
+  {
+    return buffer + (x - bufferStart[0]) * bufferStride[0] + (y - bufferStart[1]) * bufferStride[1] + (z - bufferStart[2]) * bufferStride[2];
+  };
+
+  // ratio test of the preselection
+  auto similar = [](double a, double b, double threshold) -> bool
+  {
+    if (threshold <= 0 || a == b)
+      return true;
+    if (a <= 0 || b <= 0)
+      return false;
+    double ratio = a / b;
+    return ratio >= threshold && ratio <= 1.0 / threshold;
+  };
+
+  std::vector<double> distances, weightSums, valueSums, statistics, statisticsSquared;
+  std::vector<char> blockMask;
+  std::vector<int> overlap[3];
+
+  const typename OutputImageRegionType::IndexType regionIndex = outputRegionForThread.GetIndex();
+  const typename OutputImageRegionType::SizeType regionSize = outputRegionForThread.GetSize();
+
+  for (int bz = regionIndex[2]; bz < regionIndex[2] + (int)regionSize[2]; bz += blockSize)
+  for (int by = regionIndex[1]; by < regionIndex[1] + (int)regionSize[1]; by += blockSize)
+  for (int bx = regionIndex[0]; bx < regionIndex[0] + (int)regionSize[0]; bx += blockSize)
+  {
+    if (this->GetAbortGenerateData())
+    {
+      return;
+    }
+
+    // block T of output voxels
+    const int t0[3] = { bx, by, bz };
+    int t1[3], tn[3];
+    t1[0] = std::min(bx + blockSize, (int)(regionIndex[0] + regionSize[0]));
+    t1[1] = std::min(by + blockSize, (int)(regionIndex[1] + regionSize[1]));
+    t1[2] = std::min(bz + blockSize, (int)(regionIndex[2] + regionSize[2]));
+    for (int d = 0; d < 3; ++d)
+    {
+      tn[d] = t1[d] - t0[d];
+    }
+    const int blockVoxels = tn[0] * tn[1] * tn[2];
+
+    typename OutputImageRegionType::IndexType blockIndex;
+    typename OutputImageRegionType::SizeType blockRegionSize;
+    for (int d = 0; d < 3; ++d)
+    {
+      blockIndex[d] = t0[d];
+      blockRegionSize[d] = tn[d];
+    }
+    OutputImageRegionType blockRegion(blockIndex, blockRegionSize);
+
+    blockMask.assign(blockVoxels, 0);
+    bool anyMasked = false;
+    ImageRegionConstIterator< MaskImageType > mit(m_Mask, blockRegion);
+    for (int i = 0; !mit.IsAtEnd(); ++mit, ++i)
+    {
+      blockMask[i] = mit.Get() != 0;
+      anyMasked = anyMasked || blockMask[i];
+    }
+
+    weightSums.assign(blockVoxels * weightComponents, 0.0);
+    valueSums.assign(blockVoxels * numberOfChannels, 0.0);
+
+    // patch domain Q: the block extended by the comparison radius, clipped to the image
+    int q0[3], qn[3];
+    for (int d = 0; d < 3; ++d)
+    {
+      q0[d] = std::max(t0[d] - r, imageStart[d]);
+      qn[d] = std::min(t1[d] + r, imageEnd[d]) - q0[d];
+    }
+
+    // local mean and variance of the patches around all voxels of the block and its search window
+    int p0[3], pn[3];
+    if (anyMasked && usePreselection)
+    {
+      for (int d = 0; d < 3; ++d)
+      {
+        p0[d] = std::max(t0[d] - s - r, imageStart[d]);
+        pn[d] = std::min(t1[d] + s + r, imageEnd[d]) - p0[d];
+      }
+      statistics.assign(pn[0] * pn[1] * pn[2] * weightComponents, 0.0);
+      statisticsSquared.assign(statistics.size(), 0.0);
+      std::vector<double> counts(pn[0] * pn[1] * pn[2], 1.0);
+      for (int z = 0, n = 0; z < pn[2]; ++z)
+        for (int y = 0; y < pn[1]; ++y)
+          for (int x = 0; x < pn[0]; ++x, ++n)
+          {
+            const TPixelType* value = pixel(p0[0] + x, p0[1] + y, p0[2] + z);
+            for (int c = 0; c < numberOfChannels; ++c)
+            {
+              const double v = value[c];
+              statistics[n * weightComponents + c % weightComponents] += v;
+              statisticsSquared[n * weightComponents + c % weightComponents] += v * v;
+            }
+          }
+      BoxSum(statistics, pn, weightComponents, r);
+      BoxSum(statisticsSquared, pn, weightComponents, r);
+      BoxSum(counts, pn, 1, r);
+
+      const double channelsPerComponent = numberOfChannels / weightComponents;
+      for (std::size_t n = 0; n < counts.size(); ++n)
+      {
+        const double samples = counts[n] * channelsPerComponent;
+        for (int c = 0; c < weightComponents; ++c)
+        {
+          const double mean = statistics[n * weightComponents + c] / samples;
+          statistics[n * weightComponents + c] = mean;
+          statisticsSquared[n * weightComponents + c] = std::max(statisticsSquared[n * weightComponents + c] / samples - mean * mean, 0.0);
+        }
+      }
+    }
+
+    for (int dz = -s; dz <= s && anyMasked; ++dz)
+    for (int dy = -s; dy <= s; ++dy)
+    for (int dx = -s; dx <= s; ++dx)
+    {
+      const int shift[3] = { dx, dy, dz };
+
+      // block voxels whose shifted voxel lies inside the image
+      int v0[3], v1[3];
+      bool empty = false;
+      for (int d = 0; d < 3; ++d)
+      {
+        v0[d] = std::max(t0[d], imageStart[d] - shift[d]);
+        v1[d] = std::min(t1[d], imageEnd[d] - shift[d]);
+        empty = empty || v0[d] >= v1[d];
+      }
+      if (empty)
+      {
+        continue;
+      }
+
+      // number of compared voxel pairs per axis, both patches are clipped to the image
+      for (int d = 0; d < 3; ++d)
+      {
+        overlap[d].resize(tn[d]);
+        for (int i = v0[d]; i < v1[d]; ++i)
+        {
+          const int lower = std::max(std::max(i - r, imageStart[d]), imageStart[d] - shift[d]);
+          const int upper = std::min(std::min(i + r + 1, imageEnd[d]), imageEnd[d] - shift[d]);
+          overlap[d][i - t0[d]] = upper - lower;
+        }
+      }
+
+      // squared differences on Q, zero where the shifted voxel is outside of the image
+      distances.assign(qn[0] * qn[1] * qn[2] * weightComponents, 0.0);
+      for (int z = 0; z < qn[2]; ++z)
+      {
+        const int zi = q0[2] + z;
+        if (zi + dz < imageStart[2] || zi + dz >= imageEnd[2])
+          continue;
+        for (int y = 0; y < qn[1]; ++y)
+        {
+          const int yi = q0[1] + y;
+          if (yi + dy < imageStart[1] || yi + dy >= imageEnd[1])
+            continue;
+          const int xBegin = std::max(q0[0], imageStart[0] - dx);
+          const int xEnd = std::min(q0[0] + qn[0], imageEnd[0] - dx);
+          double* row = &distances[((z * qn[1] + y) * qn[0]) * weightComponents];
+          for (int xi = xBegin; xi < xEnd; ++xi)
+          {
+            const TPixelType* a = pixel(xi, yi, zi);
+            const TPixelType* b = pixel(xi + dx, yi + dy, zi + dz);
+            double* out = row + (xi - q0[0]) * weightComponents;
+            if (weightComponents == 1)
+            {
+              double sum = 0;
+              for (int c = 0; c < numberOfChannels; ++c)
+              {
+                const double diff = (double)a[c] - (double)b[c];
+                sum += diff * diff;
+              }
+              out[0] = sum;
+            }
+            else
+            {
+              for (int c = 0; c < numberOfChannels; ++c)
+              {
+                const double diff = (double)a[c] - (double)b[c];
+                out[c] = diff * diff;
+              }
+            }
+          }
+        }
+      }
+      BoxSum(distances, qn, weightComponents, r);
+
+      // weight the shifted voxels of all block voxels
+      for (int z = v0[2]; z < v1[2]; ++z)
+      for (int y = v0[1]; y < v1[1]; ++y)
+      for (int x = v0[0]; x < v1[0]; ++x)
+      {
+        const int i = ((z - t0[2]) * tn[1] + (y - t0[1])) * tn[0] + (x - t0[0]);
+        if (!blockMask[i])
+        {
+          continue;
+        }
+
+        double size = overlap[0][x - t0[0]] * overlap[1][y - t0[1]] * overlap[2][z - t0[2]];
+        if (m_UseJointInformation)
+        {
+          size *= numberOfChannels + 1;
+        }
+
+        const double* distance = &distances[(((z - q0[2]) * qn[1] + (y - q0[1])) * qn[0] + (x - q0[0])) * weightComponents];
+        const TPixelType* value = pixel(x + dx, y + dy, z + dz);
+        double* weightSum = &weightSums[i * weightComponents];
+        double* valueSum = &valueSums[i * numberOfChannels];
+
+        const double* meanI = nullptr;
+        const double* meanJ = nullptr;
+        const double* varianceI = nullptr;
+        const double* varianceJ = nullptr;
+        if (usePreselection)
+        {
+          const int ni = ((z - p0[2]) * pn[1] + (y - p0[1])) * pn[0] + (x - p0[0]);
+          const int nj = ((z + dz - p0[2]) * pn[1] + (y + dy - p0[1])) * pn[0] + (x + dx - p0[0]);
+          meanI = &statistics[ni * weightComponents];
+          meanJ = &statistics[nj * weightComponents];
+          varianceI = &statisticsSquared[ni * weightComponents];
+          varianceJ = &statisticsSquared[nj * weightComponents];
+        }
+
+        for (int c = 0; c < weightComponents; ++c)
+        {
+          if (usePreselection && (!similar(meanI[c], meanJ[c], m_PreselectionMeanThreshold) || !similar(varianceI[c], varianceJ[c], m_PreselectionVarianceThreshold)))
+          {
+            continue;
+          }
+
+          const double w = std::exp( - (distance[c] / size) / m_Variance);
+          weightSum[c] += w;
+
+          if (weightComponents == 1)
+          {
+            for (int ch = 0; ch < numberOfChannels; ++ch)
+            {
+              const double v = value[ch];
+              valueSum[ch] += w * (m_UseRicianAdaption ? v * v : v);
+            }
+          }
+          else
+          {
+            const double v = value[c];
+            valueSum[c] += w * (m_UseRicianAdaption ? v * v : v);
+          }
+        }
+      }
+    }
+
+    // write the weighted averages of the block
+    typename OutputImageType::PixelType outpix;
+    outpix.SetSize(numberOfChannels);
+    ImageRegionIterator< OutputImageType > oit(outputImage, blockRegion);
+    for (int i = 0; !oit.IsAtEnd(); ++oit, ++i)
+    {
+      outpix.Fill(0);
+      if (blockMask[i])
+      {
+        for (int c = 0; c < numberOfChannels; ++c)
+        {
+          const double weightSum = weightSums[i * weightComponents + c % weightComponents];
+          double a = weightSum > 0 ? valueSums[i * numberOfChannels + c] / weightSum : 0;
+          if (m_UseRicianAdaption)
+          {
+            a -= 2 * m_Variance;
+          }
+          if (a < 0)
+          {
+            a = 0;
+          }
+          TPixelType outval;
+          if (m_UseRicianAdaption)
+          {
+            outval = std::floor(std::sqrt(a) + 0.5);
+          }
+          else
+          {
+            outval = std::floor(a + 0.5);
+          }
+          outpix.SetElement(c, outval);
+        }
+      }
+      oit.Set(outpix);
+    }
+
+    m_CurrentVoxelCount += blockVoxels;
+  }
+}
+
 template< class TPixelType >
 void NonLocalMeansDenoisingFilter< TPixelType >::SetInputImage(const InputImageType* image)
 {
@@ -125,37 +125,37 @@ ResampleDwiImageFilter<TScalarType>
     }
     }
 
-    for (unsigned int i=0; i<this->GetInput()->GetVectorLength(); i++)
+    // The channels are resampled one after the other. The interleaved input and output buffers are copied
+    // to/from one contiguous channel image with a stride of the vector length, only one channel of the input
+    // and of the output is allocated besides the two DWIs.
+    typename DwiChannelType::Pointer channel = DwiChannelType::New();
+    channel->SetSpacing( this->GetInput()->GetSpacing() );
+    channel->SetOrigin( this->GetInput()->GetOrigin() );
+    channel->SetDirection( this->GetInput()->GetDirection() );
+    channel->SetLargestPossibleRegion( this->GetInput()->GetBufferedRegion() );
+    channel->SetBufferedRegion( this->GetInput()->GetBufferedRegion() );
+    channel->SetRequestedRegion( this->GetInput()->GetBufferedRegion() );
+    channel->Allocate();
+    resampler->SetInput(channel);
+
+    const unsigned int vectorLength = this->GetInput()->GetVectorLength();
+    const SizeValueType numberOfInputPixels = this->GetInput()->GetBufferedRegion().GetNumberOfPixels();
+    const SizeValueType numberOfOutputPixels = m_NewImageRegion.GetNumberOfPixels();
+    const TScalarType* inBuffer = this->GetInput()->GetBufferPointer();
+    TScalarType* outBuffer = outImage->GetBufferPointer();
+
+    for (unsigned int i=0; i<vectorLength; i++)
     {
-        typename DwiChannelType::Pointer channel = DwiChannelType::New();
-        channel->SetSpacing( this->GetInput()->GetSpacing() );
-        channel->SetOrigin( this->GetInput()->GetOrigin() );
-        channel->SetDirection( this->GetInput()->GetDirection() );
-        channel->SetLargestPossibleRegion( this->GetInput()->GetLargestPossibleRegion() );
-        channel->SetBufferedRegion( this->GetInput()->GetLargestPossibleRegion() );
-        channel->SetRequestedRegion( this->GetInput()->GetLargestPossibleRegion() );
-        channel->Allocate();
-
-        ImageRegionIterator<DwiChannelType> it(channel, channel->GetLargestPossibleRegion());
-        while(!it.IsAtEnd())
-        {
-            typename DwiImageType::PixelType pix = this->GetInput()->GetPixel(it.GetIndex());
-            it.Set(pix[i]);
-            ++it;
-        }
-
-        resampler->SetInput(channel);
+        TScalarType* channelBuffer = channel->GetBufferPointer();
+        for (SizeValueType p=0; p<numberOfInputPixels; p++)
+            channelBuffer[p] = inBuffer[p*vectorLength + i];
+        channel->Modified();
+
         resampler->Update();
-        channel = resampler->GetOutput();
-
-        ImageRegionIterator<DwiImageType> it2(outImage, outImage->GetLargestPossibleRegion());
-        while(!it2.IsAtEnd())
-        {
-            typename DwiImageType::PixelType pix = it2.Get();
-            pix[i] = channel->GetPixel(it2.GetIndex());
-            it2.Set(pix);
-            ++it2;
-        }
+
+        const TScalarType* resampledBuffer = resampler->GetOutput()->GetBufferPointer();
+        for (SizeValueType p=0; p<numberOfOutputPixels; p++)
+            outBuffer[p*vectorLength + i] = resampledBuffer[p];
     }
 
     this->SetNthOutput(0, outImage);
@@ -20,6 +20,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkDiffusionTensor3D.h>
 #include <itkVectorImage.h>
 #include <vnl/algo/vnl_symmetric_eigensystem.h>
+#include <itkVoxelBlockReconstruction.h>
 
 #include <math.h>
 
@@ -196,6 +197,7 @@ private:
 
   /** Pseudoinverse calculated in the process of calculating a tensor */
   vnl_matrix<double> m_PseudoInverse;
+  VoxelBlockReconstruction<double> m_PseudoInverseBlockReconstruction;
 
   /** design matrix */
   vnl_matrix<double> m_H;
@@ -270,6 +270,7 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
   }
 
   m_PseudoInverse = pseudoInverse;
+  m_PseudoInverseBlockReconstruction.SetMatrix(m_PseudoInverse);
   m_H = H_org;
   m_BVec=b_vec;
 
@@ -726,99 +727,118 @@ TensorReconstructionWithEigenvalueCorrectionFilter<TDiffusionPixelType, TTensorP
 ::GenerateTensorImage(int nof,int numberb0,itk::Size<3> size,itk::VectorImage<short, 3>::Pointer corrected_diffusion,itk::Image<short, 3>::Pointer mask,double , typename itk::Image< itk::DiffusionTensor3D<TTensorPixelType>, 3 >::Pointer tensorImg)
 {
   // in this method the whole tensor image is updated with a tensors for defined voxels ( defined by a value of mask);
+  // The attenuations of the defined voxels of an image row are gathered in one block and the pseudoinverse is applied
+  // to all of them at once. Every thread writes its own rows, so the pixels are set without synchronization.
+
+  typedef VoxelBlockReconstruction<double> BlockReconstructionType;
+  const int blockSize = BlockReconstructionType::BlockSize;
 
 #ifdef WIN32
 #pragma omp parallel for
 #else
-#pragma omp parallel for collapse(3)
+#pragma omp parallel for collapse(2)
 #endif
-  for (int x=0;x<(int)size[0];x++)
+  for (int z=0;z<(int)size[2];z++)
     for (int y=0;y<(int)size[1];y++)
-      for (int z=0;z<(int)size[2];z++)
-      {
-        itk::Index<3> ix;
-
-        vnl_vector<double> org_data(nof);
-        vnl_vector<double> atten(nof-numberb0);
-        vnl_vector<double> tensor(6);
-        itk::DiffusionTensor3D<double> ten;
-        double mask_val=0;
+    {
+      itk::Index<3> ix;
+      ix[1] = y; ix[2] = z;
 
-        ix[0] = x; ix[1] = y; ix[2] = z;
+      vnl_vector<double> org_data(nof);
+      BlockReconstructionType::BlockType atten = BlockReconstructionType::CreateBlock(nof-numberb0);
+      BlockReconstructionType::BlockType tensor = m_PseudoInverseBlockReconstruction.CreateOutputBlock();
+      std::vector<int> block_x(blockSize);
+      itk::DiffusionTensor3D<double> ten;
 
-        mask_val= mask->GetPixel(ix);
+      for (int x_begin=0;x_begin<(int)size[0];x_begin+=blockSize)
+      {
+        const int x_end = std::min(x_begin+blockSize, (int)size[0]);
+        unsigned int nof_voxels=0;
 
-        //Tensors are calculated only for voxels above theshold for B0 image.
-        if( mask_val > 0.0 )
+        for (int x=x_begin;x<x_end;x++)
         {
+          ix[0] = x;
+          double mask_val= mask->GetPixel(ix);
 
-          // calculation of attenuation with use of gradient image and  and mean B0 image
-          GradientVectorType pt = corrected_diffusion->GetPixel(ix);
-
-          for (int i=0;i<nof;i++)
+          //Tensors are calculated only for voxels above theshold for B0 image.
+          if( mask_val > 0.0 )
           {
-            org_data[i]=pt[i];
-          }
 
-          double mean_b=0.0;
+            // calculation of attenuation with use of gradient image and  and mean B0 image
+            GradientVectorType pt = corrected_diffusion->GetPixel(ix);
 
-          for (int i=0;i<nof;i++)
-          {
-            if(m_B0Mask[i]>0)
+            for (int i=0;i<nof;i++)
             {
-              mean_b=mean_b+org_data[i];
+              org_data[i]=pt[i];
             }
 
-          }
-          mean_b=mean_b/numberb0;
-          int cnt=0;
-          for (int i=0;i<nof;i++)
-          {
-            if (org_data[i]<= 0)
+            double mean_b=0.0;
 
+            for (int i=0;i<nof;i++)
             {
-              org_data[i]=0.1;
+              if(m_B0Mask[i]>0)
+              {
+                mean_b=mean_b+org_data[i];
+              }
+
             }
-            if(m_B0Mask[i]==0)
+            mean_b=mean_b/numberb0;
+            double* voxel_atten = atten[nof_voxels];
+            int cnt=0;
+            for (int i=0;i<nof;i++)
             {
-              atten[cnt]=org_data[i]/mean_b;
-              cnt++;
+              if (org_data[i]<= 0)
+
+              {
+                org_data[i]=0.1;
+              }
+              if(m_B0Mask[i]==0)
+              {
+                voxel_atten[cnt]=org_data[i]/mean_b;
+                cnt++;
+              }
             }
-          }
 
-          for (int i=0;i<nof-numberb0;i++)
-          {
+            for (int i=0;i<nof-numberb0;i++)
+            {
 
-            atten[i]=log((double)atten[i]);
-          }
+              voxel_atten[i]=log((double)voxel_atten[i]);
+            }
 
-          // Calculation of tensor with use of previously calculated inverse of design matrix and attenuation
-          tensor = m_PseudoInverse*atten;
+            block_x[nof_voxels++] = x;
+          }
+          // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
+          else if (mask_val < 1.0)
+          {
+            ten(0,0) = 0;
+            ten(0,1) = 0;
+            ten(0,2) = 0;
+            ten(1,1) = 0;
+            ten(1,2) = 0;
+            ten(2,2) = 0;
+
+            tensorImg->SetPixel(ix, ten);
+          }
+        }
 
-          ten(0,0) = tensor[0];
-          ten(0,1) = tensor[3];
-          ten(0,2) = tensor[5];
-          ten(1,1) = tensor[1];
-          ten(1,2) = tensor[4];
-          ten(2,2) = tensor[2];
+        // Calculation of tensor with use of previously calculated inverse of design matrix and attenuation
+        m_PseudoInverseBlockReconstruction.Apply(atten, nof_voxels, tensor);
 
-#pragma omp critical
-          tensorImg->SetPixel(ix, ten);
-        }
-        // for voxels with mask value 0 - tensor is simply 0 ( outside brain value)
-        else if (mask_val < 1.0)
+        for (unsigned int v=0;v<nof_voxels;v++)
         {
-          ten(0,0) = 0;
-          ten(0,1) = 0;
-          ten(0,2) = 0;
-          ten(1,1) = 0;
-          ten(1,2) = 0;
-          ten(2,2) = 0;
-
-#pragma omp critical
+          const double* voxel_tensor = tensor[v];
+          ten(0,0) = voxel_tensor[0];
+          ten(0,1) = voxel_tensor[3];
+          ten(0,2) = voxel_tensor[5];
+          ten(1,1) = voxel_tensor[1];
+          ten(1,2) = voxel_tensor[4];
+          ten(2,2) = voxel_tensor[2];
+
+          ix[0] = block_x[v];
           tensorImg->SetPixel(ix, ten);
         }
       }
+    }
 
 }// end of Generate Tensor
 
@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkVtkMapper.h"
 #include "vtkPropAssembly.h"
 #include "vtkAppendPolyData.h"
+#include "vtkPolyDataNormals.h"
 #include "vtkActor.h"
 #include "vtkPolyDataMapper.h"
 #include "vtkPlane.h"
@@ -31,13 +32,22 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkSmartPointer.h"
 #include "vtkOdfSource.h"
 #include "vtkThickPlane.h"
+#include "vtkCellArray.h"
 #include <mitkDiffusionFunctionCollection.h>
 
+#include <unordered_map>
+
 namespace mitk {
 
 //##Documentation
 //## @brief Mapper for spherical object densitiy function representations
 //##
+//## Glyphs are evaluated once per voxel and kept in a cache until the image or one of the properties that change
+//## the glyph shape (normalization, scaling, ...) is modified. Panning, zooming and browsing through slices only
+//## copies the cached glyphs of the visible voxels into one poly data object that shares the glyph connectivity.
+//## If the glyphs are smaller than "DiffusionCore.Rendering.OdfVtkMapper.LowDetailGlyphSize" display units,
+//## a decimated version of the glyph base mesh is used.
+//##
 template<class TPixelType, int NrOdfDirections>
 class OdfVtkMapper2D : public VtkMapper
 {
@@ -93,11 +103,16 @@ public:
     public:
 
         std::vector< vtkSmartPointer<vtkPropAssembly> >       m_PropAssemblies;
-        std::vector< vtkSmartPointer<vtkAppendPolyData> >     m_OdfsPlanes;
+        std::vector< vtkSmartPointer<vtkPolyData> >           m_OdfsPlanes;
         std::vector< vtkSmartPointer<vtkActor> >              m_OdfsActors;
         std::vector< vtkSmartPointer<vtkPolyDataMapper> >     m_OdfsMappers;
         vtkSmartPointer< vtkPolyData >                        m_TemplateOdf;
 
+        /** \brief Connectivity of the glyphs in m_OdfsPlanes, reused while level of detail and glyph count are the same */
+        std::vector< vtkSmartPointer<vtkCellArray> >          m_GlyphPolys;
+        std::vector< bool >                                   m_GlyphPolysLowDetail;
+        std::vector< vtkIdType >                              m_GlyphPolysCount;
+
         itk::TimeStamp                      m_LastUpdateTime;
 
         /** \brief Default constructor of the local storage. */
@@ -113,7 +128,7 @@ protected:
     OdfVtkMapper2D();
     ~OdfVtkMapper2D() override;
 
-    static void GlyphMethod(void *arg);
+    static void SetOdfSourceToVoxel(vtkDataArray* imageValues, vtkIdType id);
     bool IsPlaneRotated(mitk::BaseRenderer* renderer);
     static bool m_ToggleTensorEllipsoidView;
     static bool m_ToggleColourisationMode;
@@ -122,12 +137,50 @@ protected:
 
     typedef vnl_matrix_fixed<double, 3, 3> DirectionsType;
 
+    /** \brief Glyph of one voxel in full resolution, relative to the voxel center and without the spacing dependent scale */
+    struct CachedGlyph
+    {
+      std::vector<float>          Points;
+      std::vector<float>          Normals;
+      std::vector<unsigned char>  Colors;
+    };
+
+    /** \brief Everything a cached glyph depends on besides the voxel */
+    struct GlyphCacheKey
+    {
+      itk::ModifiedTimeType ImageTime;
+      float                 Scaling;
+      int                   Normalization;
+      int                   ScaleBy;
+      float                 IndexParam1;
+      float                 IndexParam2;
+      bool                  TensorEllipsoidView;
+      bool                  ColourisationMode;
+
+      bool operator==(const GlyphCacheKey& other) const
+      {
+        return ImageTime == other.ImageTime && Scaling == other.Scaling && Normalization == other.Normalization &&
+            ScaleBy == other.ScaleBy && IndexParam1 == other.IndexParam1 && IndexParam2 == other.IndexParam2 &&
+            TensorEllipsoidView == other.TensorEllipsoidView && ColourisationMode == other.ColourisationMode;
+      }
+    };
+
+    /** \brief Connectivity of one glyph with the base mesh points it uses */
+    struct GlyphMesh
+    {
+      vtkSmartPointer<vtkCellArray> Polys;
+      std::vector<vtkIdType>        PointIds;
+    };
+
+    static const GlyphMesh& GetGlyphMesh(bool lowDetail);
+    const CachedGlyph& GetCachedGlyph(vtkIdType voxel);
+    void UpdateGlyphCacheKey();
+
 
 private:
 
     mitk::Image* GetInput();
 
-    static vtkSmartPointer<vtkTransform>              m_OdfTransform;
     static vtkSmartPointer<vtkOdfSource>              m_OdfSource;
     static float                                      m_Scaling;
     static int                                        m_Normalization;
@@ -145,6 +198,10 @@ private:
     vtkImageData*                                     m_VtkImage ;
     std::vector< OdfDisplayGeometry >                 m_LastDisplayGeometry;
     mitk::LocalStorageHandler<LocalStorage>           m_LSH;
+    int                                               m_LowDetailGlyphSize;
+    std::unordered_map<vtkIdType, CachedGlyph>        m_GlyphCache;
+    GlyphCacheKey                                     m_GlyphCacheKey;
+    vtkSmartPointer<vtkPolyDataNormals>               m_GlyphNormals;
 
     static vnl_matrix<float>                          m_Sh2Basis;
     static vnl_matrix<float>                          m_Sh4Basis;
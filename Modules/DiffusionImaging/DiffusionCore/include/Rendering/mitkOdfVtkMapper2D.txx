@@ -35,7 +35,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "vtkMaskedGlyph3D.h"
 #include "vtkGlyph2D.h"
 #include "vtkGlyph3D.h"
-#include "vtkMaskedProgrammableGlyphFilter.h"
+#include "vtkMaskPoints.h"
+#include "vtkDecimatePro.h"
+#include "vtkPointLocator.h"
+#include "vtkUnsignedCharArray.h"
 #include "vtkImageData.h"
 #include "vtkLinearTransform.h"
 #include "vtkCamera.h"
@@ -68,11 +71,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <cmath>
 
 #include <ciso646>
+#include <map>
+#include <numeric>
 
 
-template<class T, int N>
-vtkSmartPointer<vtkTransform> mitk::OdfVtkMapper2D<T,N>::m_OdfTransform = vtkSmartPointer<vtkTransform>::New();
-
 template<class T, int N>
 vtkSmartPointer<vtkOdfSource> mitk::OdfVtkMapper2D<T,N>::m_OdfSource = vtkSmartPointer<vtkOdfSource>::New();
 
@@ -125,13 +127,13 @@ mitk::OdfVtkMapper2D<T,N>::LocalStorage::LocalStorage()
   m_PropAssemblies.push_back(vtkSmartPointer<vtkPropAssembly>::New());
   m_PropAssemblies.push_back(vtkSmartPointer<vtkPropAssembly>::New());
 
-  m_OdfsPlanes.push_back(vtkSmartPointer<vtkAppendPolyData>::New());
-  m_OdfsPlanes.push_back(vtkSmartPointer<vtkAppendPolyData>::New());
-  m_OdfsPlanes.push_back(vtkSmartPointer<vtkAppendPolyData>::New());
+  m_OdfsPlanes.push_back(vtkSmartPointer<vtkPolyData>::New());
+  m_OdfsPlanes.push_back(vtkSmartPointer<vtkPolyData>::New());
+  m_OdfsPlanes.push_back(vtkSmartPointer<vtkPolyData>::New());
 
-  m_OdfsPlanes[0]->AddInputData(vtkSmartPointer<vtkPolyData>::New());
-  m_OdfsPlanes[1]->AddInputData(vtkSmartPointer<vtkPolyData>::New());
-  m_OdfsPlanes[2]->AddInputData(vtkSmartPointer<vtkPolyData>::New());
+  m_GlyphPolys.resize(3);
+  m_GlyphPolysLowDetail.resize(3, false);
+  m_GlyphPolysCount.resize(3, 0);
 
   m_OdfsActors.push_back(vtkSmartPointer<vtkActor>::New());
   m_OdfsActors.push_back(vtkSmartPointer<vtkActor>::New());
@@ -208,6 +210,19 @@ mitk::OdfVtkMapper2D<T,N>
   m_Clippers2[2]->SetClipFunction( m_ThickPlanes2[2] );
 
   m_ShowMaxNumber = 500;
+  m_LowDetailGlyphSize = 20;
+
+  m_GlyphCacheKey = GlyphCacheKey();
+
+  m_GlyphNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
+  m_GlyphNormals->SetInputConnection( m_OdfSource->GetOutputPort() );
+  m_GlyphNormals->SplittingOff();
+  m_GlyphNormals->ConsistencyOff();
+  m_GlyphNormals->AutoOrientNormalsOff();
+  m_GlyphNormals->ComputePointNormalsOn();
+  m_GlyphNormals->ComputeCellNormalsOff();
+  m_GlyphNormals->FlipNormalsOff();
+  m_GlyphNormals->NonManifoldTraversalOff();
 }
 
 template<class T, int N>
@@ -250,33 +265,8 @@ int  mitk::OdfVtkMapper2D<T,N>
 
 template<class T, int N>
 void  mitk::OdfVtkMapper2D<T,N>
-::GlyphMethod(void *arg)
+::SetOdfSourceToVoxel(vtkDataArray* image_vals, vtkIdType id)
 {
-  vtkMaskedProgrammableGlyphFilter* pfilter=(vtkMaskedProgrammableGlyphFilter*)arg;
-
-  double point[3];
-  double debugpoint[3];
-  pfilter->GetPoint(point);
-  pfilter->GetPoint(debugpoint);
-
-  itk::Point<double,3> p(point);
-  Vector3D spacing = pfilter->GetGeometry()->GetSpacing();
-  p[0] /= spacing[0];
-  p[1] /= spacing[1];
-  p[2] /= spacing[2];
-
-  mitk::Point3D p2;
-  pfilter->GetGeometry()->IndexToWorld( p, p2 );
-  point[0] = p2[0];
-  point[1] = p2[1];
-  point[2] = p2[2];
-
-  vtkPointData* data = pfilter->GetPointData();
-  vtkDataArray* image_vals = data->GetArray("vector");
-  vtkIdType id = pfilter->GetPointId();
-  m_OdfTransform->Identity();
-  m_OdfTransform->Translate(point[0],point[1],point[2]);
-
   typedef itk::OrientationDistributionFunction<float,N> OdfType;
   OdfType odf;
 
@@ -376,6 +366,150 @@ void  mitk::OdfVtkMapper2D<T,N>
   m_OdfSource->Modified();
 }
 
+template<class T, int N>
+const typename mitk::OdfVtkMapper2D<T,N>::GlyphMesh& mitk::OdfVtkMapper2D<T,N>
+::GetGlyphMesh(bool lowDetail)
+{
+  static GlyphMesh fullMesh;
+  static GlyphMesh lowDetailMesh;
+
+  GlyphMesh& mesh = lowDetail ? lowDetailMesh : fullMesh;
+  if (mesh.Polys.GetPointer() != nullptr)
+    return mesh;
+
+  typedef itk::OrientationDistributionFunction<float,N> OdfType;
+  vtkPolyData* baseMesh = OdfType::GetBaseMesh();
+
+  if (lowDetail)
+  {
+    // vtkDecimatePro removes vertices without moving the remaining ones,
+    // so every point of the decimated mesh is still one of the ODF directions
+    vtkSmartPointer<vtkPolyData> triangles = vtkSmartPointer<vtkPolyData>::New();
+    triangles->SetPoints(baseMesh->GetPoints());
+    triangles->SetPolys(baseMesh->GetPolys());
+
+    vtkSmartPointer<vtkDecimatePro> decimate = vtkSmartPointer<vtkDecimatePro>::New();
+    decimate->SetInputData(triangles);
+    decimate->SetTargetReduction(0.75);
+    decimate->PreserveTopologyOn();
+    decimate->Update();
+    vtkPolyData* decimated = decimate->GetOutput();
+
+    vtkSmartPointer<vtkPointLocator> locator = vtkSmartPointer<vtkPointLocator>::New();
+    locator->SetDataSet(triangles);
+    locator->BuildLocator();
+
+    mesh.Polys = vtkSmartPointer<vtkCellArray>::New();
+    std::map<vtkIdType, vtkIdType> compactIds;
+    std::vector<vtkIdType> ids;
+    vtkIdType npts;
+    vtkIdType* pts(nullptr);
+    vtkCellArray* polys = decimated->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell(npts, pts);)
+    {
+      ids.resize(npts);
+      for (vtkIdType i = 0; i < npts; ++i)
+      {
+        auto iter = compactIds.find(pts[i]);
+        if (iter == compactIds.end())
+        {
+          iter = compactIds.insert(std::make_pair(pts[i], static_cast<vtkIdType>(mesh.PointIds.size()))).first;
+          mesh.PointIds.push_back(locator->FindClosestPoint(decimated->GetPoint(pts[i])));
+        }
+        ids[i] = iter->second;
+      }
+      mesh.Polys->InsertNextCell(npts, ids.data());
+    }
+
+    if (mesh.Polys->GetNumberOfCells() > 0)
+      return mesh;
+
+    MITK_WARN << "Decimation of the ODF glyph mesh failed, using the full mesh for small glyphs.";
+    mesh.PointIds.clear();
+  }
+
+  mesh.Polys = vtkSmartPointer<vtkCellArray>::New();
+  mesh.Polys->DeepCopy(baseMesh->GetPolys());
+  mesh.PointIds.resize(baseMesh->GetNumberOfPoints());
+  std::iota(mesh.PointIds.begin(), mesh.PointIds.end(), 0);
+  return mesh;
+}
+
+template<class T, int N>
+void mitk::OdfVtkMapper2D<T,N>
+::UpdateGlyphCacheKey()
+{
+  GlyphCacheKey key;
+  key.ImageTime = this->GetDataNode()->GetData()->GetMTime();
+  key.Scaling = m_Scaling;
+  key.Normalization = m_Normalization;
+  key.ScaleBy = m_ScaleBy;
+  key.IndexParam1 = m_IndexParam1;
+  key.IndexParam2 = m_IndexParam2;
+  key.TensorEllipsoidView = m_ToggleTensorEllipsoidView;
+  key.ColourisationMode = m_ToggleColourisationMode;
+
+  if (!(key == m_GlyphCacheKey))
+  {
+    m_GlyphCache.clear();
+    m_GlyphCacheKey = key;
+  }
+}
+
+template<class T, int N>
+const typename mitk::OdfVtkMapper2D<T,N>::CachedGlyph& mitk::OdfVtkMapper2D<T,N>
+::GetCachedGlyph(vtkIdType voxel)
+{
+  auto iter = m_GlyphCache.find(voxel);
+  if (iter != m_GlyphCache.end())
+    return iter->second;
+
+  // a glyph takes a few kilobytes, start over instead of growing without bounds
+  if (m_GlyphCache.size() >= 20000)
+    m_GlyphCache.clear();
+
+  CachedGlyph& glyph = m_GlyphCache[voxel];
+  const vtkIdType numberOfPoints = itk::OrientationDistributionFunction<float,N>::GetBaseMesh()->GetNumberOfPoints();
+  glyph.Points.assign(3 * numberOfPoints, 0.0f);
+  glyph.Normals.assign(3 * numberOfPoints, 0.0f);
+  glyph.Colors.assign(4 * numberOfPoints, 0);
+
+  try
+  {
+    SetOdfSourceToVoxel(m_VtkImage->GetPointData()->GetArray("vector"), voxel);
+    m_OdfSource->SetAdditionalScale(1.0);
+    m_GlyphNormals->Update();
+  }
+  catch( itk::ExceptionObject& err )
+  {
+    std::cout << err << std::endl;
+    return glyph;
+  }
+
+  vtkPolyData* source = m_GlyphNormals->GetOutput();
+  vtkDataArray* normals = source->GetPointData()->GetNormals();
+  vtkDataArray* colors = source->GetPointData()->GetArray("ODF_COLORS");
+  if (source->GetNumberOfPoints() != numberOfPoints || normals == nullptr || colors == nullptr)
+    return glyph;
+
+  for (vtkIdType j = 0; j < numberOfPoints; ++j)
+  {
+    double p[3];
+    source->GetPoint(j, p);
+    double* n = normals->GetTuple3(j);
+    for (int i = 0; i < 3; ++i)
+    {
+      glyph.Points[3 * j + i] = static_cast<float>(p[i]);
+      glyph.Normals[3 * j + i] = static_cast<float>(n[i]);
+    }
+    for (int i = 0; i < 4; ++i)
+    {
+      glyph.Colors[4 * j + i] = static_cast<unsigned char>(colors->GetComponent(j, i));
+    }
+  }
+  return glyph;
+}
+
 template<class T, int N>
 typename mitk::OdfVtkMapper2D<T,N>::OdfDisplayGeometry mitk::OdfVtkMapper2D<T,N>
 ::MeasureDisplayedGeometry(mitk::BaseRenderer* renderer)
@@ -611,6 +745,8 @@ void  mitk::OdfVtkMapper2D<T,N>
     cuttedPlane->SetPolys(polys);
   }
 
+  localStorage->m_OdfsPlanes[index] = vtkSmartPointer<vtkPolyData>::New();
+
   if(cuttedPlane->GetNumberOfPoints())
   {
     //  WINDOWING HERE
@@ -658,43 +794,102 @@ void  mitk::OdfVtkMapper2D<T,N>
 
     if(cuttedPlane->GetNumberOfPoints())
     {
-      localStorage->m_OdfsPlanes[index]->RemoveAllInputs();
-
-      vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
-      normals->SetInputConnection( m_OdfSource->GetOutputPort() );
-      normals->SplittingOff();
-      normals->ConsistencyOff();
-      normals->AutoOrientNormalsOff();
-      normals->ComputePointNormalsOn();
-      normals->ComputeCellNormalsOff();
-      normals->FlipNormalsOff();
-      normals->NonManifoldTraversalOff();
-
-      vtkSmartPointer<vtkTransformPolyDataFilter> trans = vtkSmartPointer<vtkTransformPolyDataFilter>::New();
-      trans->SetInputConnection( normals->GetOutputPort() );
-      trans->SetTransform(m_OdfTransform);
-
-      vtkSmartPointer<vtkMaskedProgrammableGlyphFilter> glyphGenerator = vtkSmartPointer<vtkMaskedProgrammableGlyphFilter>::New();
-      glyphGenerator->SetMaximumNumberOfPoints(std::min(m_ShowMaxNumber,(int)cuttedPlane->GetNumberOfPoints()));
-      glyphGenerator->SetRandomMode( m_ToggleGlyphPlacementMode );
-      glyphGenerator->SetUseMaskPoints(1);
-      glyphGenerator->SetSourceConnection(trans->GetOutputPort() );
-      glyphGenerator->SetInput(cuttedPlane);
-      glyphGenerator->SetColorModeToColorBySource();
-      glyphGenerator->SetGeometry(this->GetDataNode()->GetData()->GetGeometry());
-      glyphGenerator->SetGlyphMethod(&(GlyphMethod),(void *)glyphGenerator);
-
-      try
+      vtkSmartPointer<vtkMaskPoints> maskPoints = vtkSmartPointer<vtkMaskPoints>::New();
+      maskPoints->SetInputData(cuttedPlane);
+      maskPoints->SetMaximumNumberOfPoints(std::max(1, std::min(m_ShowMaxNumber,(int)cuttedPlane->GetNumberOfPoints())));
+      maskPoints->SetOnRatio(cuttedPlane->GetNumberOfPoints() / maskPoints->GetMaximumNumberOfPoints());
+      maskPoints->SetRandomMode( m_ToggleGlyphPlacementMode );
+      maskPoints->Update();
+      vtkPoints* glyphCenters = maskPoints->GetOutput()->GetPoints();
+      const vtkIdType numberOfGlyphs = glyphCenters ? glyphCenters->GetNumberOfPoints() : 0;
+
+      // coarse glyphs if a voxel covers only a few display units
+      const double additionalScale = GetMinImageSpacing(index);
+      const bool lowDetail = additionalScale / renderer->GetScaleFactorMMPerDisplayUnit() < m_LowDetailGlyphSize;
+      const GlyphMesh& mesh = GetGlyphMesh(lowDetail);
+      const vtkIdType pointsPerGlyph = mesh.PointIds.size();
+
+      vtkSmartPointer<vtkFloatArray> glyphPoints = vtkSmartPointer<vtkFloatArray>::New();
+      glyphPoints->SetNumberOfComponents(3);
+      glyphPoints->SetNumberOfTuples(numberOfGlyphs * pointsPerGlyph);
+      vtkSmartPointer<vtkFloatArray> glyphNormals = vtkSmartPointer<vtkFloatArray>::New();
+      glyphNormals->SetName("Normals");
+      glyphNormals->SetNumberOfComponents(3);
+      glyphNormals->SetNumberOfTuples(numberOfGlyphs * pointsPerGlyph);
+      vtkSmartPointer<vtkUnsignedCharArray> glyphColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
+      glyphColors->SetName("ODF_COLORS");
+      glyphColors->SetNumberOfComponents(4);
+      glyphColors->SetNumberOfTuples(numberOfGlyphs * pointsPerGlyph);
+
+      float* pointsOut = glyphPoints->GetPointer(0);
+      float* normalsOut = glyphNormals->GetPointer(0);
+      unsigned char* colorsOut = glyphColors->GetPointer(0);
+
+      mitk::BaseGeometry* geometry = this->GetDataNode()->GetData()->GetGeometry();
+      for (vtkIdType g = 0; g < numberOfGlyphs; ++g)
       {
-        glyphGenerator->Update();
+        // glyphs are drawn at the voxel centers of the slice
+        double point[3];
+        glyphCenters->GetPoint(g, point);
+        itk::Index<3> voxelIndex;
+        for (int i = 0; i < 3; ++i)
+        {
+          voxelIndex[i] = std::max(0, std::min(dims[i] - 1, static_cast<int>(std::floor(point[i] / spac[i] + 0.5))));
+        }
+        mitk::Point3D center;
+        geometry->IndexToWorld(voxelIndex, center);
+
+        const CachedGlyph& glyph = GetCachedGlyph(voxelIndex[0] + dims[0] * (voxelIndex[1] + dims[1] * voxelIndex[2]));
+        for (vtkIdType id : mesh.PointIds)
+        {
+          for (int i = 0; i < 3; ++i)
+          {
+            *pointsOut++ = static_cast<float>(center[i] + additionalScale * glyph.Points[3 * id + i]);
+            *normalsOut++ = glyph.Normals[3 * id + i];
+          }
+          for (int i = 0; i < 4; ++i)
+          {
+            *colorsOut++ = glyph.Colors[4 * id + i];
+          }
+        }
       }
-      catch( itk::ExceptionObject& err )
+
+      // the connectivity only depends on the number of glyphs
+      if (localStorage->m_GlyphPolys[index].GetPointer() == nullptr ||
+          localStorage->m_GlyphPolysLowDetail[index] != lowDetail ||
+          localStorage->m_GlyphPolysCount[index] != numberOfGlyphs)
       {
-        std::cout << err << std::endl;
+        vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+        polys->Allocate(numberOfGlyphs * mesh.Polys->GetNumberOfConnectivityEntries());
+        std::vector<vtkIdType> offsetPts;
+        for (vtkIdType g = 0; g < numberOfGlyphs; ++g)
+        {
+          vtkIdType npts;
+          vtkIdType* pts(nullptr);
+          for (mesh.Polys->InitTraversal(); mesh.Polys->GetNextCell(npts, pts);)
+          {
+            offsetPts.resize(npts);
+            for (vtkIdType i = 0; i < npts; ++i)
+            {
+              offsetPts[i] = pts[i] + g * pointsPerGlyph;
+            }
+            polys->InsertNextCell(npts, offsetPts.data());
+          }
+        }
+        localStorage->m_GlyphPolys[index] = polys;
+        localStorage->m_GlyphPolysLowDetail[index] = lowDetail;
+        localStorage->m_GlyphPolysCount[index] = numberOfGlyphs;
       }
 
-      localStorage->m_OdfsPlanes[index]->AddInputConnection(glyphGenerator->GetOutputPort());
-      localStorage->m_OdfsPlanes[index]->Update();
+      vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+      points->SetData(glyphPoints);
+
+      vtkSmartPointer<vtkPolyData> glyphs = vtkSmartPointer<vtkPolyData>::New();
+      glyphs->SetPoints(points);
+      glyphs->SetPolys(localStorage->m_GlyphPolys[index]);
+      glyphs->GetPointData()->SetNormals(glyphNormals);
+      glyphs->GetPointData()->AddArray(glyphColors);
+      localStorage->m_OdfsPlanes[index] = glyphs;
     }
   }
   localStorage->m_OdfsMappers[index]->ScalarVisibilityOn();
@@ -706,7 +901,7 @@ void  mitk::OdfVtkMapper2D<T,N>
   {
     localStorage->m_PropAssemblies[index]->RemovePart(localStorage->m_OdfsActors[index]);
   }
-  localStorage->m_OdfsMappers[index]->SetInputData(localStorage->m_OdfsPlanes[index]->GetOutput());
+  localStorage->m_OdfsMappers[index]->SetInputData(localStorage->m_OdfsPlanes[index]);
   localStorage->m_PropAssemblies[index]->AddPart(localStorage->m_OdfsActors[index]);
 }
 
@@ -858,8 +1053,8 @@ void  mitk::OdfVtkMapper2D<T,N>
     localStorage->m_OdfsActors[1]->VisibilityOn();
     localStorage->m_OdfsActors[2]->VisibilityOn();
 
-    m_OdfSource->SetAdditionalScale(GetMinImageSpacing(GetIndex(renderer)));
     ApplyPropertySettings();
+    UpdateGlyphCacheKey();
     Slice(renderer, dispGeo);
     m_LastDisplayGeometry[GetIndex(renderer)] = dispGeo;
   }
@@ -896,6 +1091,7 @@ void  mitk::OdfVtkMapper2D<T,N>
 {
   this->GetDataNode()->GetFloatProperty( "Scaling", m_Scaling );
   this->GetDataNode()->GetIntProperty( "ShowMaxNumber", m_ShowMaxNumber );
+  this->GetDataNode()->GetIntProperty( "DiffusionCore.Rendering.OdfVtkMapper.LowDetailGlyphSize", m_LowDetailGlyphSize );
 
   OdfNormalizationMethodProperty* nmp = dynamic_cast<OdfNormalizationMethodProperty*>(this->GetDataNode()->GetProperty( "Normalization" ));
   if(nmp)
@@ -978,6 +1174,7 @@ void  mitk::OdfVtkMapper2D<T,N>
   node->SetProperty( "DoRefresh", mitk::BoolProperty::New( true ) );
   node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.SwitchTensorView", mitk::BoolProperty::New( true) );
   node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.RandomModeBit", mitk::BoolProperty::New( true ) );
+  node->AddProperty( "DiffusionCore.Rendering.OdfVtkMapper.LowDetailGlyphSize", mitk::IntProperty::New( 20 ) );
 }
 
 #endif // __mitkOdfVtkMapper2D_txx__
@@ -20,6 +20,8 @@ set(CPP_FILES
 
   mitkFiberBundleDicomReader.cpp
   mitkFiberBundleDicomWriter.cpp
+  mitkFiberBundleCompactReader.cpp
+  mitkFiberBundleCompactWriter.cpp
   mitkFiberBundleTckReader.cpp
   mitkFiberBundleTrackVisReader.cpp
   mitkFiberBundleTrackVisWriter.cpp
@@ -38,6 +38,7 @@ std::vector<CustomMimeType*> DiffusionIOMimeTypes::Get()
   mimeTypes.push_back(FIBERBUNDLE_TRK_MIMETYPE().Clone());
   mimeTypes.push_back(FIBERBUNDLE_TCK_MIMETYPE().Clone());
   mimeTypes.push_back(FIBERBUNDLE_DICOM_MIMETYPE().Clone());
+  mimeTypes.push_back(FIBERBUNDLE_CFB_MIMETYPE().Clone());
 
   mimeTypes.push_back(CONNECTOMICS_MIMETYPE().Clone());
   mimeTypes.push_back(TRACTOGRAPHYFOREST_MIMETYPE().Clone());
@@ -90,6 +91,16 @@ CustomMimeType DiffusionIOMimeTypes::FIBERBUNDLE_TCK_MIMETYPE()
   return mimeType;
 }
 
+CustomMimeType DiffusionIOMimeTypes::FIBERBUNDLE_CFB_MIMETYPE()
+{
+  CustomMimeType mimeType(FIBERBUNDLE_CFB_MIMETYPE_NAME());
+  std::string category = "Compact Fibers";
+  mimeType.SetComment("Compact Fibers (memory mapped)");
+  mimeType.SetCategory(category);
+  mimeType.AddExtension("cfb");
+  return mimeType;
+}
+
 CustomMimeType DiffusionIOMimeTypes::FIBERBUNDLE_TRK_MIMETYPE()
 {
   CustomMimeType mimeType(FIBERBUNDLE_TRK_MIMETYPE_NAME());
@@ -221,6 +232,12 @@ std::string DiffusionIOMimeTypes::FIBERBUNDLE_TCK_MIMETYPE_NAME()
   return name;
 }
 
+std::string DiffusionIOMimeTypes::FIBERBUNDLE_CFB_MIMETYPE_NAME()
+{
+  static std::string name = IOMimeTypes::DEFAULT_BASE_NAME() + ".FiberBundle.cfb";
+  return name;
+}
+
 std::string DiffusionIOMimeTypes::FIBERBUNDLE_TRK_MIMETYPE_NAME()
 {
   static std::string name = IOMimeTypes::DEFAULT_BASE_NAME() + ".FiberBundle.trk";
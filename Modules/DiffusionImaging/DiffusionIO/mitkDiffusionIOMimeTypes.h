@@ -57,6 +57,11 @@ public:
   static CustomMimeType FIBERBUNDLE_TCK_MIMETYPE();
   static std::string FIBERBUNDLE_TCK_MIMETYPE_NAME();
 
+  // ------------------------------ Compact fiber format ----------------------------------
+
+  static CustomMimeType FIBERBUNDLE_CFB_MIMETYPE();
+  static std::string FIBERBUNDLE_CFB_MIMETYPE_NAME();
+
   // ------------------------------ TrackVis formats ----------------------------------
 
   static CustomMimeType FIBERBUNDLE_TRK_MIMETYPE();
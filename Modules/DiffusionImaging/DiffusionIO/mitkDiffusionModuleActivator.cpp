@@ -23,10 +23,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPlanarFigureCompositeReader.h>
 #include <mitkTractographyForestReader.h>
 #include <mitkFiberBundleDicomReader.h>
+#include <mitkFiberBundleCompactReader.h>
 
 #include <mitkFiberBundleVtkWriter.h>
 #include <mitkFiberBundleTrackVisWriter.h>
 #include <mitkFiberBundleDicomWriter.h>
+#include <mitkFiberBundleCompactWriter.h>
 #include <mitkConnectomicsNetworkWriter.h>
 #include <mitkConnectomicsNetworkCSVWriter.h>
 #include <mitkConnectomicsNetworkMatrixWriter.h>
@@ -64,6 +66,8 @@ namespace mitk
           props[ us::ServiceConstants::SERVICE_RANKING() ] = -3;
         else if (mt->GetName()==mitk::DiffusionIOMimeTypes::FIBERBUNDLE_DICOM_MIMETYPE_NAME())
           props[ us::ServiceConstants::SERVICE_RANKING() ] = -4;
+        else if (mt->GetName()==mitk::DiffusionIOMimeTypes::FIBERBUNDLE_CFB_MIMETYPE_NAME())
+          props[ us::ServiceConstants::SERVICE_RANKING() ] = -5;
         else
           props[ us::ServiceConstants::SERVICE_RANKING() ] = 10;
 
@@ -74,6 +78,7 @@ namespace mitk
       m_FiberBundleTrackVisReader = new FiberBundleTrackVisReader();
       m_FiberBundleTckReader = new FiberBundleTckReader();
       m_FiberBundleDicomReader = new FiberBundleDicomReader();
+      m_FiberBundleCompactReader = new FiberBundleCompactReader();
       m_ConnectomicsNetworkReader = new ConnectomicsNetworkReader();
       m_PlanarFigureCompositeReader = new PlanarFigureCompositeReader();
       m_TractographyForestReader = new TractographyForestReader();
@@ -81,6 +86,7 @@ namespace mitk
       m_FiberBundleVtkWriter = new FiberBundleVtkWriter();
       m_FiberBundleTrackVisWriter = new FiberBundleTrackVisWriter();
       m_FiberBundleDicomWriter = new FiberBundleDicomWriter();
+      m_FiberBundleCompactWriter = new FiberBundleCompactWriter();
       m_ConnectomicsNetworkWriter = new ConnectomicsNetworkWriter();
       m_ConnectomicsNetworkCSVWriter = new ConnectomicsNetworkCSVWriter();
       m_ConnectomicsNetworkMatrixWriter = new ConnectomicsNetworkMatrixWriter();
@@ -102,8 +108,10 @@ namespace mitk
       delete m_PlanarFigureCompositeReader;
       delete m_TractographyForestReader;
       delete m_FiberBundleDicomReader;
+      delete m_FiberBundleCompactReader;
 
       delete m_FiberBundleDicomWriter;
+      delete m_FiberBundleCompactWriter;
       delete m_FiberBundleVtkWriter;
       delete m_FiberBundleTrackVisWriter;
       delete m_ConnectomicsNetworkWriter;
@@ -119,11 +127,13 @@ namespace mitk
     FiberBundleTckReader * m_FiberBundleTckReader;
     FiberBundleTrackVisReader * m_FiberBundleTrackVisReader;
     FiberBundleDicomReader * m_FiberBundleDicomReader;
+    FiberBundleCompactReader * m_FiberBundleCompactReader;
     ConnectomicsNetworkReader * m_ConnectomicsNetworkReader;
     PlanarFigureCompositeReader* m_PlanarFigureCompositeReader;
     TractographyForestReader* m_TractographyForestReader;
 
     FiberBundleDicomWriter * m_FiberBundleDicomWriter;
+    FiberBundleCompactWriter * m_FiberBundleCompactWriter;
     FiberBundleVtkWriter * m_FiberBundleVtkWriter;
     FiberBundleTrackVisWriter * m_FiberBundleTrackVisWriter;
     ConnectomicsNetworkWriter * m_ConnectomicsNetworkWriter;
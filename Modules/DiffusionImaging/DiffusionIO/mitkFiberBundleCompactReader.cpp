@@ -0,0 +1,54 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberBundleCompactReader.h"
+#include <mitkCompactFiberContainer.h>
+#include <mitkCustomMimeType.h>
+#include "mitkDiffusionIOMimeTypes.h"
+#include <itksys/SystemTools.hxx>
+
+
+mitk::FiberBundleCompactReader::FiberBundleCompactReader()
+  : mitk::AbstractFileReader( mitk::DiffusionIOMimeTypes::FIBERBUNDLE_CFB_MIMETYPE_NAME(), "Compact Fiber Bundle Reader (memory mapped)" )
+{
+  m_ServiceReg = this->RegisterService();
+}
+
+mitk::FiberBundleCompactReader::FiberBundleCompactReader(const FiberBundleCompactReader &other)
+  :mitk::AbstractFileReader(other)
+{
+}
+
+mitk::FiberBundleCompactReader * mitk::FiberBundleCompactReader::Clone() const
+{
+  return new FiberBundleCompactReader(*this);
+}
+
+std::vector<itk::SmartPointer<mitk::BaseData> > mitk::FiberBundleCompactReader::Read()
+{
+  std::vector<itk::SmartPointer<mitk::BaseData> > result;
+
+  std::string filename = this->GetInputLocation();
+  MITK_INFO << "Mapping compact tractogram: " << itksys::SystemTools::GetFilenameName(filename);
+
+  // the container is kept alive by the fiber bundle, so the file stays mapped as long as the bundle exists
+  mitk::CompactFiberContainer::Pointer container = mitk::CompactFiberContainer::Load(filename);
+  mitk::FiberBundle::Pointer fib = container->CreateFiberBundle();
+  result.push_back(fib.GetPointer());
+
+  MITK_INFO << "Fiber bundle read";
+  return result;
+}
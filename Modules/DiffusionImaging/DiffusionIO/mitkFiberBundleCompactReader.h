@@ -0,0 +1,51 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkFiberBundleCompactReader_h
+#define __mitkFiberBundleCompactReader_h
+
+#include <mitkCommon.h>
+#include <mitkFiberBundle.h>
+
+#include <mitkAbstractFileReader.h>
+
+namespace mitk
+{
+
+  /** \brief Memory maps compact fiber files (see mitk::CompactFiberContainer). The fiber bundle is a view on the mapped
+   * file, its vtkPolyData is only created when it is accessed.
+  */
+
+  class FiberBundleCompactReader : public AbstractFileReader
+  {
+  public:
+
+    FiberBundleCompactReader();
+    ~FiberBundleCompactReader() override{}
+    FiberBundleCompactReader(const FiberBundleCompactReader& other);
+    FiberBundleCompactReader * Clone() const override;
+
+    using mitk::AbstractFileReader::Read;
+    std::vector<itk::SmartPointer<BaseData> > Read() override;
+
+  private:
+
+    us::ServiceRegistration<mitk::IFileReader> m_ServiceReg;
+  };
+
+} //namespace MITK
+
+#endif // __mitkFiberBundleCompactReader_h
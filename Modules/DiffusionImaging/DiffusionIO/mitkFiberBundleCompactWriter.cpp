@@ -0,0 +1,74 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberBundleCompactWriter.h"
+#include <mitkCompactFiberContainer.h>
+#include <mitkCustomMimeType.h>
+#include "mitkDiffusionIOMimeTypes.h"
+
+const char* mitk::FiberBundleCompactWriter::POINT_ENCODING = "Point encoding";
+const char* mitk::FiberBundleCompactWriter::POINT_ENCODING_ENUM = "Point encoding.enum";
+
+mitk::FiberBundleCompactWriter::FiberBundleCompactWriter()
+  : mitk::AbstractFileWriter(mitk::FiberBundle::GetStaticNameOfClass(), mitk::DiffusionIOMimeTypes::FIBERBUNDLE_CFB_MIMETYPE_NAME(), "Compact Fiber Bundle Writer")
+{
+  Options defaultOptions;
+  defaultOptions[POINT_ENCODING] = std::string("float32");
+  std::vector<std::string> encodings;
+  encodings.push_back("float32");
+  encodings.push_back("float16");
+  encodings.push_back("quantized16");
+  defaultOptions[POINT_ENCODING_ENUM] = encodings;
+  this->SetDefaultOptions(defaultOptions);
+  RegisterService();
+}
+
+mitk::FiberBundleCompactWriter::FiberBundleCompactWriter(const mitk::FiberBundleCompactWriter & other)
+  :mitk::AbstractFileWriter(other)
+{}
+
+mitk::FiberBundleCompactWriter::~FiberBundleCompactWriter()
+{}
+
+mitk::FiberBundleCompactWriter * mitk::FiberBundleCompactWriter::Clone() const
+{
+  return new mitk::FiberBundleCompactWriter(*this);
+}
+
+void mitk::FiberBundleCompactWriter::Write()
+{
+  if (this->GetOutputStream())
+    mitkThrow() << "Compact fiber files can only be written to a file.";
+
+  mitk::FiberBundle::ConstPointer input = dynamic_cast<const mitk::FiberBundle*>(this->GetInput());
+  if (input.IsNull())
+    mitkThrow() << "Input is not a fiber bundle.";
+
+  std::string encodingName = this->GetOptions()[POINT_ENCODING].ToString();
+  mitk::CompactFiberContainer::PointEncoding encoding = mitk::CompactFiberContainer::FLOAT32;
+  if (encodingName=="float16")
+    encoding = mitk::CompactFiberContainer::FLOAT16;
+  else if (encodingName=="quantized16")
+    encoding = mitk::CompactFiberContainer::QUANTIZED16;
+  else if (encodingName!="float32")
+    mitkThrow() << "Unknown point encoding " << encodingName;
+
+  MITK_INFO << "Writing fiber bundle as compact fiber file (" << encodingName << ")";
+  mitk::CompactFiberContainer::Pointer container = mitk::CompactFiberContainer::New();
+  container->Initialize(input, encoding);
+  container->Save(this->GetOutputLocation());
+  MITK_INFO << "Compact fiber bundle written to " << this->GetOutputLocation();
+}
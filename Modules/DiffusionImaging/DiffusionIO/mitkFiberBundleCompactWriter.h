@@ -0,0 +1,50 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkFiberBundleCompactWriter_h
+#define __mitkFiberBundleCompactWriter_h
+
+#include <mitkAbstractFileWriter.h>
+
+#include "mitkFiberBundle.h"
+
+namespace mitk
+{
+
+/**
+ * Writes fiber bundles as compact fiber files that are memory mapped on loading (see mitk::CompactFiberContainer).
+ * Views on compact fibers are written without creating their vtkPolyData.
+ * @ingroup Process
+ */
+class FiberBundleCompactWriter : public mitk::AbstractFileWriter
+{
+public:
+
+    FiberBundleCompactWriter();
+    FiberBundleCompactWriter(const FiberBundleCompactWriter & other);
+    FiberBundleCompactWriter * Clone() const override;
+    ~FiberBundleCompactWriter() override;
+
+    using mitk::AbstractFileWriter::Write;
+    void Write() override;
+
+    static const char* POINT_ENCODING;
+    static const char* POINT_ENCODING_ENUM;
+};
+
+} // end of namespace mitk
+
+#endif //__mitkFiberBundleCompactWriter_h
@@ -15,6 +15,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include "mitkTrackingDataHandler.h"
+#include <omp.h>
+#include <ctime>
+#include <cstdlib>
 
 namespace mitk
 {
@@ -26,9 +29,52 @@ TrackingDataHandler::TrackingDataHandler()
   , m_FlipZ(false)
   , m_Mode(MODE::DETERMINISTIC)
   , m_RngItk(ItkRngType::New())
+  , m_RandomSeed(0)
+  , m_UseRandomStreams(false)
   , m_NeedsDataInit(true)
   , m_Random(true)
 {
+  SetRandomSeed(0);
+}
+
+void TrackingDataHandler::SetRandom( bool random )
+{
+  m_Random = random;
+  if (!random)
+  {
+    std::srand(0);
+    SetRandomSeed(0);
+  }
+  else
+  {
+    std::srand(std::time(nullptr));
+    SetRandomSeed(static_cast<unsigned int>(std::time(nullptr)));
+  }
+}
+
+void TrackingDataHandler::SetRandomSeed( unsigned int seed )
+{
+  m_RandomSeed = seed;
+  m_RngItk->SetSeed(static_cast<ItkRngType::IntegerType>(seed));
+  int num_threads = std::max(omp_get_max_threads(), omp_get_num_procs());
+  m_Rngs.resize(static_cast<std::size_t>(num_threads));
+  for (int i=0; i<num_threads; ++i)
+    m_Rngs[static_cast<std::size_t>(i)].seed(static_cast<BoostRngType::result_type>(seed + 0x9E3779B9u*static_cast<unsigned int>(i)));
+}
+
+void TrackingDataHandler::InitRandomStream( unsigned long long stream_id )
+{
+  // splitmix64 finalizer: decorrelates the generator states of neighbouring stream ids
+  unsigned long long z = (static_cast<unsigned long long>(m_RandomSeed) << 32) ^ (stream_id + 0x9E3779B97F4A7C15ull);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+  z = z ^ (z >> 31);
+  GetRng().seed(static_cast<BoostRngType::result_type>(z ^ (z >> 32)));
+}
 
+TrackingDataHandler::BoostRngType& TrackingDataHandler::GetRng()
+{
+  return m_Rngs[static_cast<std::size_t>(omp_get_thread_num()) % m_Rngs.size()];
 }
+
 }
@@ -21,10 +21,14 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkPoint.h>
 #include <itkImage.h>
 #include <deque>
+#include <vector>
 #include <MitkFiberTrackingExports.h>
 #include <boost/random/discrete_distribution.hpp>
 #include <boost/random/variate_generator.hpp>
 #include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <itkMersenneTwisterRandomVariateGenerator.h>
 #include <mitkDiffusionFunctionCollection.h>
 #include <itkLinearInterpolateImageFunction.h>
 
@@ -73,27 +77,71 @@ public:
   void SetFlipX( bool f ){ m_FlipX = f; }
   void SetFlipY( bool f ){ m_FlipY = f; }
   void SetFlipZ( bool f ){ m_FlipZ = f; }
-  void SetRandom( bool random )
+  void SetRandom( bool random );   ///< If false, all random numbers are derived from seed 0, otherwise from a time based seed
+  void SetRandomSeed( unsigned int seed );  ///< Explicitly set the base seed of all random numbers
+  unsigned int GetRandomSeed() const { return m_RandomSeed; }
+
+  /**
+  * \brief If true, every thread draws from its own generator that is re-seeded per seed point (see InitRandomStream).
+  *
+  * Otherwise all threads share one ITK and one boost generator, as they did before per seed point streams were
+  * introduced. The shared generators reproduce the former random sequences, e.g. of the seed point jitter, but
+  * the result depends on the order in which the threads draw from them.
+  */
+  void SetUseRandomStreams( bool use ){ m_UseRandomStreams = use; }
+  bool GetUseRandomStreams() const { return m_UseRandomStreams; }
+
+  /**
+  * \brief Re-seed the random generator of the calling thread with a stream derived from (base seed, stream_id).
+  *
+  * Each OpenMP thread draws from its own generator, so no locking is necessary. The streamline tracking filter
+  * starts a new stream for every seed point, which makes the result independent of the number of threads.
+  */
+  void InitRandomStream( unsigned long long stream_id );
+
+  BoostRngType& GetRng();   ///< Random generator of the calling thread
+
+  /** \brief Draw a sample of the boost distribution from the generator of the calling thread or the shared one */
+  template< class DistributionType >
+  typename DistributionType::result_type Sample(DistributionType& dist)
   {
-    m_Random = random;
-    if (!random)
-    {
-      m_Rng.seed(0);
-      std::srand(0);
-      m_RngItk->SetSeed(0);
-    }
-    else
+    if (m_UseRandomStreams)
+      return dist(GetRng());
+
+    typename DistributionType::result_type sample;
+#pragma omp critical
+    sample = dist(m_Rngs.front());
+    return sample;
+  }
+
+  double GetRandDouble(const double & a, const double & b)
+  {
+    if (m_UseRandomStreams)
     {
-      m_Rng.seed();
-      m_RngItk->SetSeed();
-      std::srand(std::time(nullptr));
+      boost::random::uniform_real_distribution<double> dist(a, b);
+      return dist(GetRng());
     }
+
+    double sample = 0;
+#pragma omp critical
+    sample = m_RngItk->GetUniformVariate(a, b);
+    return sample;
   }
 
-  double GetRandDouble(const double & a, const double & b)
+  int GetRandInt(const int & max)  ///< uniform integer in [0, max]
   {
-    return m_RngItk->GetUniformVariate(a, b);
+    if (m_UseRandomStreams)
+    {
+      boost::random::uniform_int_distribution<int> dist(0, max);
+      return dist(GetRng());
+    }
+
+    int sample = 0;
+#pragma omp critical
+    sample = static_cast<int>(m_RngItk->GetIntegerVariate(static_cast<ItkRngType::IntegerType>(max)));
+    return sample;
   }
+
   bool GetFlipX() const { return m_FlipX; }
   bool GetFlipY() const { return m_FlipY; }
   bool GetFlipZ() const { return m_FlipZ; }
@@ -106,8 +154,10 @@ protected:
   bool                m_FlipY;
   bool                m_FlipZ;
   MODE                m_Mode;
-  BoostRngType        m_Rng;
+  std::vector< BoostRngType > m_Rngs;   ///< one generator per thread, the first one is shared if random streams are not used
   ItkRngType::Pointer m_RngItk;
+  unsigned int        m_RandomSeed;
+  bool                m_UseRandomStreams;
   bool                m_NeedsDataInit;
   bool                m_Random;
 
@@ -317,11 +317,7 @@ vnl_vector_fixed<float,3> TrackingHandlerRandomForest< ShOrder, NumberOfSignalFe
 
     for (int i=0; i<50; i++)  // we allow 50 trials to exceed m_AngularThreshold
     {
-  #pragma omp critical
-      {
-        boost::random::variate_generator<boost::random::mt19937&, boost::random::discrete_distribution<int,float>> sampler(m_Rng, dist);
-        sampled_idx = sampler();
-      }
+      sampled_idx = Sample(dist);
 
       if ( probs2[sampled_idx]>0.1 && (!check_last_dir || (check_last_dir && fabs(angles[sampled_idx])>=m_AngularThreshold)) )
         break;
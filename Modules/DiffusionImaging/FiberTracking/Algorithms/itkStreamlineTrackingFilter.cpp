@@ -32,6 +32,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <TrackingHandlers/mitkTrackingHandlerTensor.h>
 #include <TrackingHandlers/mitkTrackingHandlerRandomForest.h>
 #include <mitkDiffusionFunctionCollection.h>
+#include <mitkTrackvis.h>
+#include <mitkGeometry3D.h>
+#include <vtkIdTypeArray.h>
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <random>
 
 namespace itk {
 
@@ -42,6 +49,7 @@ StreamlineTrackingFilter
   , m_AbortTracking(false)
   , m_BuildFibersFinished(false)
   , m_BuildFibersReady(0)
+  , m_Stop(false)
   , m_FiberPolyData(nullptr)
   , m_Points(nullptr)
   , m_Cells(nullptr)
@@ -78,6 +86,10 @@ StreamlineTrackingFilter
   , m_CurrentTracts(0)
   , m_Progress(0)
   , m_StopTracking(false)
+  , m_RandomSeed(-1)
+  , m_UseRandomStreams(false)
+  , m_StreamingOutputFile("")
+  , m_StreamedTracts(0)
   , m_InterpolateMasks(true)
   , m_TrialsPerSeed(10)
   , m_EndpointConstraint(EndpointConstraints::NONE)
@@ -91,13 +103,15 @@ StreamlineTrackingFilter
 
 std::string StreamlineTrackingFilter::GetStatusText()
 {
-  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(m_Progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
+  unsigned int progress = m_Progress;
+  unsigned int current_tracts = m_CurrentTracts;
+  std::string status = "Seedpoints processed: " + boost::lexical_cast<std::string>(progress) + "/" + boost::lexical_cast<std::string>(m_SeedPoints.size());
   if (m_SeedPoints.size()>0)
-    status += " (" + boost::lexical_cast<std::string>(100*m_Progress/m_SeedPoints.size()) + "%)";
+    status += " (" + boost::lexical_cast<std::string>(100*progress/m_SeedPoints.size()) + "%)";
   if (m_MaxNumTracts>0)
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts) + "/" + boost::lexical_cast<std::string>(m_MaxNumTracts);
   else
-    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(m_CurrentTracts);
+    status += "\nFibers accepted: " + boost::lexical_cast<std::string>(current_tracts);
 
   return status;
 }
@@ -106,6 +120,10 @@ void StreamlineTrackingFilter::BeforeTracking()
 {
   m_StopTracking = false;
   m_TrackingHandler->SetRandom(m_Random);
+  if (m_RandomSeed>=0)
+    m_TrackingHandler->SetRandomSeed(static_cast<unsigned int>(m_RandomSeed));
+  // the seed points are jittered with the shared ITK generator, as before random streams were introduced
+  m_TrackingHandler->SetUseRandomStreams(false);
   m_TrackingHandler->InitForTracking();
   m_FiberPolyData = PolyDataType::New();
   m_Points = vtkSmartPointer< vtkPoints >::New();
@@ -139,6 +157,8 @@ void StreamlineTrackingFilter::BeforeTracking()
   if (m_TrackingPriorHandler!=nullptr)
   {
     m_TrackingPriorHandler->SetRandom(m_Random);
+    m_TrackingPriorHandler->SetRandomSeed(m_TrackingHandler->GetRandomSeed());
+    m_TrackingPriorHandler->SetUseRandomStreams(false);
     m_TrackingPriorHandler->InitForTracking();
     m_TrackingPriorHandler->SetAngularThreshold(m_AngularThreshold);
   }
@@ -688,109 +708,245 @@ void StreamlineTrackingFilter::GenerateData()
 {
   this->BeforeTracking();
   if (m_Random)
-    std::random_shuffle(m_SeedPoints.begin(), m_SeedPoints.end());
+  {
+    std::mt19937 rng(m_TrackingHandler->GetRandomSeed());
+    std::shuffle(m_SeedPoints.begin(), m_SeedPoints.end(), rng);
+  }
+
+  // Without random seed and randomization, all threads share one generator, which reproduces the random sequences
+  // of former versions for a single thread.
+  m_UseRandomStreams = m_Random || m_RandomSeed>=0;
+  m_TrackingHandler->SetUseRandomStreams(m_UseRandomStreams);
+  if (m_TrackingPriorHandler!=nullptr)
+    m_TrackingPriorHandler->SetUseRandomStreams(m_UseRandomStreams);
 
   m_CurrentTracts = 0;
-  int num_seeds = static_cast<int>(m_SeedPoints.size());
-  itk::Index<3> zeroIndex; zeroIndex.Fill(0);
+  m_StreamedTracts = 0;
   m_Progress = 0;
-  int i = 0;
+  const int num_seeds = static_cast<int>(m_SeedPoints.size());
+  const int num_threads = omp_get_max_threads();
   int print_interval = num_seeds/100;
   if (print_interval<100)
     m_Verbose=false;
 
-#pragma omp parallel
-  while (i<num_seeds && !m_StopTracking)
+  // In demo mode and for probability maps the fibers are processed immediately, otherwise they are collected in
+  // thread local buffers that are merged in seed order after each block of seeds.
+  const bool buffered = !m_DemoMode && !m_UseOutputProbabilityMap;
+  std::unique_ptr< TrackVisFiberReader > stream;
+  if (buffered && !m_StreamingOutputFile.empty())
+    stream.reset(CreateStreamingOutput());
+  std::vector< std::vector< SeedFiberType > > thread_buffers(static_cast<std::size_t>(num_threads));
+
+  int block_start = 0;
+  while (block_start<num_seeds && !m_StopTracking)
   {
-    int temp_i = 0;
-#pragma omp critical
-    {
-      temp_i = i;
-      i++;
-    }
+    const int block_end = std::min(num_seeds, block_start + static_cast<int>(GetSeedBlockSize(static_cast<unsigned int>(block_start), m_CurrentTracts)));
+    const int batch_size = std::max(1, std::min(64, (block_end-block_start)/(16*num_threads)));
 
-    if (temp_i>=num_seeds || m_StopTracking)
-      continue;
-    else if (m_Verbose && i%print_interval==0)
-#pragma omp critical
+#pragma omp parallel for schedule(dynamic, batch_size)
+    for (int s=block_start; s<block_end; ++s)
     {
-      m_Progress += static_cast<unsigned int>(print_interval);
-      std::cout << "                                                                                                     \r";
-      if (m_MaxNumTracts>0)
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_MaxNumTracts << '\r';
-      else
-        std::cout << "Tried: " << m_Progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
-      cout.flush();
-    }
-
-    const itk::Point<float> worldPos = m_SeedPoints.at(static_cast<unsigned int>(temp_i));
+      if (m_StopTracking)
+        continue;
 
-    for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
-    {
       FiberType fib;
-      DirectionContainer direction_container;
-      float tractLength = 0;
-      unsigned long counter = 0;
-
-      // get starting direction
-      vnl_vector_fixed<float,3> dir; dir.fill(0.0);
-      std::deque< vnl_vector_fixed<float,3> > olddirs;
-      dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
-
-      bool exclude = false;
-      if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
-        exclude = true;
-
-      bool success = false;
-      if (dir.magnitude()>0.0001f && !exclude)
+      if (TrackSeed(static_cast<unsigned int>(s), fib))
       {
-        // forward tracking
-        tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
-        fib.push_front(worldPos);
-
-        // backward tracking
-        if (!exclude)
-          tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
-
-        counter = fib.size();
-
-        if (tractLength>=m_MinTractLength && counter>=2 && !exclude)
+        if (buffered)
+        {
+          thread_buffers[static_cast<std::size_t>(omp_get_thread_num())].push_back(SeedFiberType(static_cast<unsigned int>(s), std::move(fib)));
+          ++m_CurrentTracts;
+        }
+        else
         {
 #pragma omp critical
-          if ( IsValidFiber(&fib) )
+          if (!m_StopTracking)
           {
-            if (!m_StopTracking)
-            {
-              if (!m_UseOutputProbabilityMap)
-                m_Tractogram.push_back(fib);
-              else
-                FiberToProbmap(&fib);
-              m_CurrentTracts++;
-              success = true;
-            }
+            if (!m_UseOutputProbabilityMap)
+              m_Tractogram.push_back(fib);
+            else
+              FiberToProbmap(&fib);
+            ++m_CurrentTracts;
+
             if (m_MaxNumTracts > 0 && m_CurrentTracts>=static_cast<unsigned int>(m_MaxNumTracts))
             {
-              if (!m_StopTracking)
-              {
-                std::cout << "                                                                                                     \r";
-                MITK_INFO << "Reconstructed maximum number of tracts (" << m_CurrentTracts << "). Stopping tractography.";
-              }
+              std::cout << "                                                                                                     \r";
+              MITK_INFO << "Reconstructed maximum number of tracts (" << m_CurrentTracts << "). Stopping tractography.";
               m_StopTracking = true;
             }
           }
         }
       }
 
-      if (success || m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
-        break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+      unsigned int progress = ++m_Progress;
+      if (m_Verbose && progress%static_cast<unsigned int>(print_interval)==0)
+      {
+#pragma omp critical
+        {
+          std::cout << "                                                                                                     \r";
+          if (m_MaxNumTracts>0)
+            std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << "/" << m_MaxNumTracts << '\r';
+          else
+            std::cout << "Tried: " << progress << "/" << num_seeds << " | Accepted: " << m_CurrentTracts << '\r';
+          cout.flush();
+        }
+      }
+    }// seed points
 
-    }// trials per seed
+    if (buffered)
+      MergeThreadBuffers(thread_buffers, stream.get());
+    block_start = block_end;
+  }
 
-  }// seed points
+  if (stream)
+  {
+    stream->updateTotal(static_cast<int>(m_StreamedTracts));
+    stream->close();
+  }
 
   this->AfterTracking();
 }
 
+bool StreamlineTrackingFilter::TrackSeed(unsigned int seed_index, FiberType& fib)
+{
+  // the random stream only depends on the seed point, not on the thread that processes it
+  if (m_UseRandomStreams)
+  {
+    m_TrackingHandler->InitRandomStream(seed_index);
+    if (m_TrackingPriorHandler!=nullptr)
+      m_TrackingPriorHandler->InitRandomStream(seed_index);
+  }
+
+  const itk::Point<float> worldPos = m_SeedPoints.at(seed_index);
+  itk::Index<3> zeroIndex; zeroIndex.Fill(0);
+
+  for (unsigned int trials=0; trials<m_TrialsPerSeed; ++trials)
+  {
+    fib.clear();
+    DirectionContainer direction_container;
+    float tractLength = 0;
+
+    // get starting direction
+    vnl_vector_fixed<float,3> dir; dir.fill(0.0);
+    std::deque< vnl_vector_fixed<float,3> > olddirs;
+    dir = GetNewDirection(worldPos, olddirs, zeroIndex) * 0.5f;
+
+    bool exclude = false;
+    if (m_ExclusionRegions.IsNotNull() && mitk::imv::IsInsideMask<float>(worldPos, m_InterpolateMasks, m_ExclusionInterpolator))
+      exclude = true;
+
+    if (dir.magnitude()>0.0001f && !exclude)
+    {
+      // forward tracking
+      tractLength = FollowStreamline(worldPos, dir, &fib, &direction_container, 0, false, exclude);
+      fib.push_front(worldPos);
+
+      // backward tracking
+      if (!exclude)
+        tractLength = FollowStreamline(worldPos, -dir, &fib, &direction_container, tractLength, true, exclude);
+
+      if (tractLength>=m_MinTractLength && fib.size()>=2 && !exclude && IsValidFiber(&fib))
+        return true;
+    }
+
+    if (m_TrackingHandler->GetMode()!=mitk::TrackingDataHandler::PROBABILISTIC)
+      break;  // we only try one seed point multiple times if we use a probabilistic tracker and have not found a valid streamline yet
+  }
+  return false;
+}
+
+unsigned int StreamlineTrackingFilter::GetSeedBlockSize(unsigned int tried, unsigned int accepted) const
+{
+  // The block size must not depend on the number of threads, otherwise MaxNumTracts would select different fibers.
+  const unsigned int max_block_size = 16384;
+  const unsigned int min_block_size = 256;
+  if (m_MaxNumTracts<=0 || m_DemoMode || m_UseOutputProbabilityMap)
+    return max_block_size;
+
+  // Estimate the number of seeds that are still needed from the acceptance rate of the previous blocks.
+  unsigned int remaining = static_cast<unsigned int>(m_MaxNumTracts) - std::min(accepted, static_cast<unsigned int>(m_MaxNumTracts));
+  if (tried==0 || accepted==0)
+    return std::max(min_block_size, std::min(max_block_size, remaining));
+  double needed = 1.1 * remaining * tried / accepted;
+  return static_cast<unsigned int>(std::max(static_cast<double>(min_block_size), std::min(static_cast<double>(max_block_size), needed)));
+}
+
+void StreamlineTrackingFilter::MergeThreadBuffers(std::vector< std::vector< SeedFiberType > >& buffers, TrackVisFiberReader* stream)
+{
+  std::vector< SeedFiberType > block;
+  for (auto& buffer : buffers)
+  {
+    std::move(buffer.begin(), buffer.end(), std::back_inserter(block));
+    buffer.clear();
+  }
+  std::sort(block.begin(), block.end(), [](const SeedFiberType& a, const SeedFiberType& b){ return a.first<b.first; });
+
+  unsigned int accepted = stream!=nullptr ? m_StreamedTracts : static_cast<unsigned int>(m_Tractogram.size());
+  if (m_MaxNumTracts>0 && accepted+block.size()>=static_cast<unsigned int>(m_MaxNumTracts))
+  {
+    block.erase(block.begin() + (static_cast<unsigned int>(m_MaxNumTracts)-accepted), block.end());
+    if (m_Verbose)
+      std::cout << "                                                                                                     \r";
+    MITK_INFO << "Reconstructed maximum number of tracts (" << m_MaxNumTracts << "). Stopping tractography.";
+    m_StopTracking = true;
+  }
+
+  if (stream!=nullptr)
+  {
+    std::vector< float > points;
+    for (const SeedFiberType& f : block)
+    {
+      points.clear();
+      for (const itk::Point<float>& p : f.second)
+      {
+        points.push_back(p[0]);
+        points.push_back(p[1]);
+        points.push_back(p[2]);
+      }
+      stream->appendFiber(points.data(), static_cast<int>(f.second.size()));
+    }
+    m_StreamedTracts += static_cast<unsigned int>(block.size());
+    m_CurrentTracts = m_StreamedTracts;
+  }
+  else
+  {
+    m_Tractogram.reserve(m_Tractogram.size() + block.size());
+    for (SeedFiberType& f : block)
+      m_Tractogram.push_back(std::move(f.second));
+    m_CurrentTracts = static_cast<unsigned int>(m_Tractogram.size());
+  }
+}
+
+TrackVisFiberReader* StreamlineTrackingFilter::CreateStreamingOutput()
+{
+  // the TrackVis header is filled from the geometry of the tracking data
+  mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
+  mitk::Point3D origin;
+  mitk::Vector3D spacing;
+  mitk::BaseGeometry::BoundsArrayType bounds; bounds.Fill(0);
+  for (int i=0; i<3; ++i)
+  {
+    origin[i] = m_TrackingHandler->GetOrigin()[i];
+    spacing[i] = m_TrackingHandler->GetSpacing()[i];
+    bounds[2*i+1] = m_TrackingHandler->GetLargestPossibleRegion().GetSize(i);
+  }
+  geometry->SetOrigin(origin);
+  geometry->SetSpacing(spacing);
+  geometry->SetBounds(bounds);
+
+  mitk::FiberBundle::Pointer header_fib = mitk::FiberBundle::New();
+  header_fib->SetReferenceGeometry(geometry.GetPointer());
+
+  TrackVisFiberReader* stream = new TrackVisFiberReader();
+  if (stream->create(m_StreamingOutputFile, header_fib.GetPointer(), true)==0)
+  {
+    delete stream;
+    mitkThrow() << "Unable to create streaming output file " << m_StreamingOutputFile;
+  }
+  MITK_INFO << "StreamlineTracking - Streaming fibers to " << m_StreamingOutputFile;
+  return stream;
+}
+
 bool StreamlineTrackingFilter::IsValidFiber(FiberType* fib)
 {
   if (m_EndpointConstraint==EndpointConstraints::NONE)
@@ -903,20 +1059,36 @@ void StreamlineTrackingFilter::BuildFibers(bool check)
     return;
 
   m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
-  vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
+
+  // allocate points and connectivity once instead of inserting point by point
+  vtkIdType num_points = 0;
+  for (const FiberType& fib : m_Tractogram)
+    num_points += static_cast<vtkIdType>(fib.size());
+  vtkIdType num_fibers = static_cast<vtkIdType>(m_Tractogram.size());
+
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
+  vNewPoints->SetDataTypeToFloat();
+  vNewPoints->SetNumberOfPoints(num_points);
+  float* point_data = static_cast<float*>(vNewPoints->GetVoidPointer(0));
+
+  vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+  connectivity->SetNumberOfValues(num_points + num_fibers);
+  vtkIdType* ids = connectivity->GetPointer(0);
 
-  for (unsigned int i=0; i<m_Tractogram.size(); i++)
+  vtkIdType point_id = 0;
+  for (const FiberType& fib : m_Tractogram)
   {
-    vtkSmartPointer<vtkPolyLine> container = vtkSmartPointer<vtkPolyLine>::New();
-    FiberType fib = m_Tractogram.at(i);
-    for (FiberType::iterator it = fib.begin(); it!=fib.end(); ++it)
+    *ids++ = static_cast<vtkIdType>(fib.size());
+    for (const itk::Point<float>& p : fib)
     {
-      vtkIdType id = vNewPoints->InsertNextPoint((*it).GetDataPointer());
-      container->GetPointIds()->InsertNextId(id);
+      point_data[3*point_id] = p[0];
+      point_data[3*point_id+1] = p[1];
+      point_data[3*point_id+2] = p[2];
+      *ids++ = point_id++;
     }
-    vNewLines->InsertNextCell(container);
   }
+  vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
+  vNewLines->SetCells(num_fibers, connectivity);
 
   if (check)
     for (int i=0; i<m_BuildFibersReady; i++)
@@ -934,7 +1106,10 @@ void StreamlineTrackingFilter::AfterTracking()
     std::cout << "                                                                                                     \r";
   if (!m_UseOutputProbabilityMap)
   {
-    MITK_INFO << "Reconstructed " << m_Tractogram.size() << " fibers.";
+    if (!m_StreamingOutputFile.empty() && !m_DemoMode)
+      MITK_INFO << "Reconstructed " << m_StreamedTracts << " fibers (written to " << m_StreamingOutputFile << ").";
+    else
+      MITK_INFO << "Reconstructed " << m_Tractogram.size() << " fibers.";
     MITK_INFO << "Generating polydata ";
     BuildFibers(false);
   }
@@ -33,15 +33,26 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkDiffusionPropertyHelper.h>
 #include <mitkPointSet.h>
 #include <chrono>
+#include <atomic>
 #include <TrackingHandlers/mitkTrackingDataHandler.h>
 #include <MitkFiberTrackingExports.h>
 #include <mitkFiberBundle.h>
 #include <mitkPeakImage.h>
 
+class TrackVisFiberReader;
+
 namespace itk{
 
 /**
-* \brief Performs streamline tracking on the input image. Depending on the tracking handler this can be a tensor, peak or machine learning based tracking. */
+* \brief Performs streamline tracking on the input image. Depending on the tracking handler this can be a tensor, peak or machine learning based tracking.
+*
+* Seed points are processed in blocks. Inside of a block, threads claim batches of seeds dynamically and collect
+* the accepted fibers in thread local buffers that are merged in seed order at the end of the block. If a random seed
+* is set or Random is true, random numbers are drawn from a stream that is re-seeded for every seed point (see
+* mitk::TrackingDataHandler::InitRandomStream), so for a fixed random seed the tractogram does not depend on the number
+* of threads. Otherwise the threads share one generator seeded with 0, which gives the same random sequences as former
+* versions. The seed points of a seed image are always jittered with the shared ITK generator. Optionally, the merged
+* blocks are streamed to a TrackVis file instead of being kept in memory. */
 
 class MITKFIBERTRACKING_EXPORT StreamlineTrackingFilter : public ProcessObject
 {
@@ -80,11 +91,11 @@ public:
   typedef std::deque< itk::Point<float> > FiberType;
   typedef std::vector< FiberType > BundleType;
 
-  volatile bool    m_PauseTracking;
+  std::atomic<bool>    m_PauseTracking;
   bool    m_AbortTracking;
   bool    m_BuildFibersFinished;
   int     m_BuildFibersReady;
-  volatile bool m_Stop;
+  std::atomic<bool> m_Stop;
   mitk::PointSet::Pointer             m_SamplingPointset;
   mitk::PointSet::Pointer             m_StopVotePointset;
   mitk::PointSet::Pointer             m_AlternativePointset;
@@ -133,6 +144,8 @@ public:
   itkSetMacro( TrackingPriorWeight, float)            ///< Weight between prior and data [0-1]. One mean tracking only on the prior peaks, zero only on the data.
   itkSetMacro( TrackingPriorAsMask, bool)             ///< If true, data directions in voxels where prior directions are invalid are set to zero
   itkSetMacro( IntroduceDirectionsFromPrior, bool)    ///< If false, prior voxels with invalid data voxel are ignored
+  itkSetMacro( RandomSeed, int )                      ///< Base seed of the random streams. If negative, a time based seed is used (or 0 if Random is false).
+  itkSetMacro( StreamingOutputFile, std::string )     ///< If set, accepted fibers are appended block-wise to this TrackVis file instead of being kept in memory. The output polydata stays empty in this case.
 
   ///< Use manually defined points in physical space as seed points instead of seed image
   void SetSeedPoints( const std::vector< itk::Point<float> >& sP) {
@@ -171,6 +184,13 @@ protected:
   void BeforeTracking();
   void AfterTracking();
 
+  typedef std::pair< unsigned int, FiberType > SeedFiberType;  ///< accepted fiber and index of its seed point
+
+  bool TrackSeed(unsigned int seed_index, FiberType& fib);   ///< Try to track a valid fiber from the given seed point.
+  unsigned int GetSeedBlockSize(unsigned int tried, unsigned int accepted) const;
+  void MergeThreadBuffers(std::vector< std::vector< SeedFiberType > >& buffers, TrackVisFiberReader* stream);
+  TrackVisFiberReader* CreateStreamingOutput();
+
   PolyDataType                        m_FiberPolyData;
   vtkSmartPointer<vtkPoints>          m_Points;
   vtkSmartPointer<vtkCellArray>       m_Cells;
@@ -212,9 +232,13 @@ protected:
   bool                                m_Random;
   bool                                m_UseOutputProbabilityMap;
   std::vector< itk::Point<float> >    m_SeedPoints;
-  unsigned int                        m_CurrentTracts;
-  unsigned int                        m_Progress;
-  bool                                m_StopTracking;
+  std::atomic<unsigned int>           m_CurrentTracts;
+  std::atomic<unsigned int>           m_Progress;
+  std::atomic<bool>                   m_StopTracking;
+  int                                 m_RandomSeed;
+  bool                                m_UseRandomStreams;
+  std::string                         m_StreamingOutputFile;
+  unsigned int                        m_StreamedTracts;
   bool                                m_InterpolateMasks;
   unsigned int                        m_TrialsPerSeed;
   EndpointConstraints                 m_EndpointConstraint;
@@ -2,7 +2,7 @@
 
 The Medical Imaging Interaction Toolkit (MITK)
 
-Coindex[1]right (c) German Cancer Research Center,
+Copyright (c) German Cancer Research Center,
 Division of Medical and Biological Informatics.
 All rights reserved.
 
@@ -15,17 +15,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractDensityImageFilter.h"
 
-// VTK
-#include <vtkPolyLine.h>
-#include <vtkCellArray.h>
-#include <vtkCellData.h>
-#include <vtkCell.h>
-
 // misc
 #include <cmath>
 #include <boost/progress.hpp>
-#include <vtkBox.h>
-#include <mitkDiffusionFunctionCollection.h>
+#include <mitkTractDensityEngine.h>
 
 namespace itk{
 
@@ -111,50 +104,40 @@ void TractDensityImageFilter< OutputImageType >::GenerateData()
   OutPixelType* outImageBufferPointer = (OutPixelType*)outImage->GetBufferPointer();
 
   MITK_INFO << "TractDensityImageFilter: starting image generation";
-  vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
+  mitk::TractDensityEngine engine(m_FiberBundle);
+  engine.SetReferenceGeometry(outImage);
 
-  int numFibers = m_FiberBundle->GetNumFibers();
-  boost::progress_display disp(numFibers);
+  int numFibers = engine.GetNumFibers();
+  boost::progress_display disp((numFibers+99)/100);
+#pragma omp parallel for schedule(dynamic, 64)
   for( int i=0; i<numFibers; i++ )
   {
-    ++disp;
-    vtkCell* cell = fiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
+    if (i%100==0)
+    {
+#pragma omp critical
+      ++disp;
+    }
 
     float weight = m_FiberBundle->GetFiberWeight(i);
-
-    // fill output image
-    for( int j=0; j<numPoints-1; j++)
+    auto accumulate = [&](long long offset, double length, const mitk::TractDensityEngine::VectorType&)
     {
-      itk::Point<float, 3> startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
-      itk::Index<3> startIndex;
-      itk::ContinuousIndex<float, 3> startIndexCont;
-      outImage->TransformPhysicalPointToIndex(startVertex, startIndex);
-      outImage->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
-
-      itk::Point<float, 3> endVertex = mitk::imv::GetItkPoint(points->GetPoint(j + 1));
-      itk::Index<3> endIndex;
-      itk::ContinuousIndex<float, 3> endIndexCont;
-      outImage->TransformPhysicalPointToIndex(endVertex, endIndex);
-      outImage->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
-
-      std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(newSpacing, startIndex, endIndex, startIndexCont, endIndexCont);
-      for (std::pair< itk::Index<3>, double > segment : segments)
+      if (m_BinaryOutput)
+        outImageBufferPointer[offset] = 1;  // all threads write the same value
+      else
       {
-        if (!outImage->GetLargestPossibleRegion().IsInside(segment.first))
-          continue;
-        if (outImage->GetPixel(segment.first)==0)
-          m_NumCoveredVoxels++;
-
-        if (m_BinaryOutput)
-          outImage->SetPixel(segment.first, 1);
-        else
-          outImage->SetPixel(segment.first, outImage->GetPixel(segment.first)+segment.second * weight);
+        OutPixelType val = static_cast<OutPixelType>(length * weight);
+#pragma omp atomic
+        outImageBufferPointer[offset] += val;
       }
-    }
+    };
+    engine.TraverseFiber(i, accumulate);
   }
 
+  m_NumCoveredVoxels = 0;
+  for (int i=0; i<w*h*d; i++)
+    if (outImageBufferPointer[i]>0)
+      m_NumCoveredVoxels++;
+
   m_MaxDensity = 0;
   for (int i=0; i<w*h*d; i++)
     if (m_MaxDensity < outImageBufferPointer[i])
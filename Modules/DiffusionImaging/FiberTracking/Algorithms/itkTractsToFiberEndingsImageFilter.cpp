@@ -15,12 +15,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractsToFiberEndingsImageFilter.h"
 
-// VTK
-#include <vtkPolyLine.h>
-#include <vtkCellArray.h>
-#include <vtkCellData.h>
 #include <boost/progress.hpp>
-#include <mitkDiffusionFunctionCollection.h>
+#include <mitkTractDensityEngine.h>
 
 namespace itk{
 
@@ -98,54 +94,31 @@ namespace itk{
     for (int i=0; i<w*h*d; i++)
       outImageBufferPointer[i] = 0;
 
-    // resample fiber bundle
-    vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
+    mitk::TractDensityEngine engine(m_FiberBundle);
+    engine.SetReferenceGeometry(outImage);
 
-    int numFibers = m_FiberBundle->GetNumFibers();
-    boost::progress_display disp(numFibers);
+    int numFibers = engine.GetNumFibers();
+    boost::progress_display disp((numFibers+99)/100);
+#pragma omp parallel for schedule(dynamic, 256)
     for( int i=0; i<numFibers; i++ )
     {
-        ++disp;
-      vtkCell* cell = fiberPolyData->GetCell(i);
-      int numPoints = cell->GetNumberOfPoints();
-      vtkPoints* points = cell->GetPoints();
-
-      // fill output image
-      if (numPoints>0)
+      if (i%100==0)
       {
-        itk::Point<float, 3> vertex = mitk::imv::GetItkPoint(points->GetPoint(0));
-        itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (upsampledRegion.IsInside(index))
-        {
-          if (m_BinaryOutput)
-          {
-            outImage->SetPixel(index, 1);
-          }
-          else
-          {
-            outImage->SetPixel(index, outImage->GetPixel(index)+1);
-          }
-        }
+#pragma omp critical
+        ++disp;
       }
 
-      if (numPoints>=2)
+      auto accumulate = [&](long long offset)
       {
-        itk::Point<float, 3> vertex = mitk::imv::GetItkPoint(points->GetPoint(numPoints-1));
-        itk::Index<3> index;
-        outImage->TransformPhysicalPointToIndex(vertex, index);
-        if (upsampledRegion.IsInside(index))
+        if (m_BinaryOutput)
+          outImageBufferPointer[offset] = 1;  // all threads write the same value
+        else
         {
-          if (m_BinaryOutput)
-          {
-              outImage->SetPixel(index, 1);
-          }
-          else
-          {
-              outImage->SetPixel(index, outImage->GetPixel(index)+1);
-          }
+#pragma omp atomic
+          outImageBufferPointer[offset] += 1;
         }
-      }
+      };
+      engine.TraverseEndpoints(i, accumulate);
     }
 
     if (m_InvertImage)
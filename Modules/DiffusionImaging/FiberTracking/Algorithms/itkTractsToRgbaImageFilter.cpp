@@ -15,15 +15,10 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 #include "itkTractsToRgbaImageFilter.h"
 
-// VTK
-#include <vtkPolyLine.h>
-#include <vtkCellArray.h>
-#include <vtkCellData.h>
-
 // misc
 #include <math.h>
 #include <boost/progress.hpp>
-#include <mitkDiffusionFunctionCollection.h>
+#include <mitkTractDensityEngine.h>
 
 namespace itk{
 
@@ -102,86 +97,71 @@ void TractsToRgbaImageFilter< OutputImageType >::GenerateData()
   double_out->Allocate();
   double_out->FillBuffer(0.0);
 
-  vtkSmartPointer<vtkPolyData> fiberPolyData = m_FiberBundle->GetFiberPolyData();
-  int numFibers = m_FiberBundle->GetNumFibers();
+  mitk::TractDensityEngine engine(m_FiberBundle);
+  engine.SetReferenceGeometry(double_out);
+  int numFibers = engine.GetNumFibers();
 
+  double* buffer = (double*)double_out->GetBufferPointer();
   float scale = 100 * pow((float)m_UpsamplingFactor,3);
-  boost::progress_display disp(numFibers);
+  boost::progress_display disp((numFibers+99)/100);
+#pragma omp parallel for schedule(dynamic, 64)
   for( int i=0; i<numFibers; ++i )
   {
-    ++disp;
-    vtkCell* cell = fiberPolyData->GetCell(i);
-    int numPoints = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-
-    for( int j=0; j<numPoints-1; ++j)
+    if (i%100==0)
     {
-      Point<float, 3> startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
-      Index<3> startIndex;
-      ContinuousIndex<float, 3> startIndexCont;
-      double_out->TransformPhysicalPointToIndex(startVertex, startIndex);
-      double_out->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
-
-      Point<float, 3> endVertex = mitk::imv::GetItkPoint(points->GetPoint(j + 1));
-      Index<3> endIndex;
-      ContinuousIndex<float, 3> endIndexCont;
-      double_out->TransformPhysicalPointToIndex(endVertex, endIndex);
-      double_out->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
-
-      Vector<float, 3> dir;
-      dir[0] = fabs(endVertex[0]-startVertex[0]);
-      dir[1] = fabs(endVertex[1]-startVertex[1]);
-      dir[2] = fabs(endVertex[2]-startVertex[2]);
-      dir.Normalize();
-
-      std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(newSpacing, startIndex, endIndex, startIndexCont, endIndexCont);
-      for (std::pair< itk::Index<3>, double > segment : segments)
-      {
-        if (!double_out->GetLargestPossibleRegion().IsInside(segment.first))
-          continue;
-
-        itk::RGBAPixel<double> pix = double_out->GetPixel(segment.first);
-        pix[0] += dir[0] * scale;
-        pix[1] += dir[1] * scale;
-        pix[2] += dir[2] * scale;
-        pix[3] += segment.second * scale;
-
-        double_out->SetPixel(segment.first, pix);
-      }
+#pragma omp critical
+      ++disp;
     }
 
-    float maxRgb = 0.000000001;
-    float maxInt = 0.000000001;
-    int w = upsampledSize[0];
-    int h = upsampledSize[1];
-    int d = upsampledSize[2];
-    int numPix = w*h*d*4;
+    auto accumulate = [&](long long offset, double length, const mitk::TractDensityEngine::VectorType& dir)
+    {
+      double* pix = buffer + 4*offset;
+      double r = std::fabs(dir[0]) * scale;
+      double g = std::fabs(dir[1]) * scale;
+      double b = std::fabs(dir[2]) * scale;
+      double a = length * scale;
+#pragma omp atomic
+      pix[0] += r;
+#pragma omp atomic
+      pix[1] += g;
+#pragma omp atomic
+      pix[2] += b;
+#pragma omp atomic
+      pix[3] += a;
+    };
+    engine.TraverseFiber(i, accumulate);
+  }
+
+  float maxRgb = 0.000000001;
+  float maxInt = 0.000000001;
+  int w = upsampledSize[0];
+  int h = upsampledSize[1];
+  int d = upsampledSize[2];
+  int numPix = w*h*d*4;
 
-    double* buffer = (double*)double_out->GetBufferPointer();
-    // calc maxima
-    for(int i=0; i<numPix; i++)
+  // calc maxima
+  for(int i=0; i<numPix; i++)
+  {
+    if((i-3)%4 != 0)
     {
-      if((i-3)%4 != 0)
-      {
-        if(buffer[i] > maxRgb)
-          maxRgb = buffer[i];
-      }
-      else
-      {
-        if(buffer[i] > maxInt)
-          maxInt = buffer[i];
-      }
+      if(buffer[i] > maxRgb)
+        maxRgb = buffer[i];
     }
-
-    // write output, normalized uchar 0..255
-    unsigned char* outImageBufferPointer = (unsigned char*)outImage->GetBufferPointer();
-    for(int i=0; i<numPix; i++)
+    else
     {
-      if((i-3)%4 != 0)
-        outImageBufferPointer[i] = (unsigned char) (255.0 * buffer[i] / maxRgb);
-      else
-        outImageBufferPointer[i] = (unsigned char) (255.0 * buffer[i] / maxInt);
+      if(buffer[i] > maxInt)
+        maxInt = buffer[i];
     }
   }
+
+  // write output, normalized uchar 0..255
+  unsigned char* outImageBufferPointer = (unsigned char*)outImage->GetBufferPointer();
+  for(int i=0; i<numPix; i++)
+  {
+    if((i-3)%4 != 0)
+      outImageBufferPointer[i] = (unsigned char) (255.0 * buffer[i] / maxRgb);
+    else
+      outImageBufferPointer[i] = (unsigned char) (255.0 * buffer[i] / maxInt);
+  }
 }
 }
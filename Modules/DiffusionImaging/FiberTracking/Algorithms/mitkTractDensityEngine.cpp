@@ -0,0 +1,112 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTractDensityEngine.h"
+#include <vnl/vnl_inverse.h>
+
+mitk::TractDensityEngine::TractDensityEngine(const FiberBundle* fib)
+  : m_FloatPoints(nullptr)
+  , m_Connectivity(nullptr)
+  , m_NumberOfVoxels(0)
+{
+  m_WorldToIndex.set_identity();
+  m_IndexToWorld.set_identity();
+  m_Origin.fill(0);
+  m_Spacing.fill(1);
+  for (int i=0; i<3; ++i)
+  {
+    m_Size[i] = 0;
+    m_StartIndex[i] = 0;
+  }
+
+  vtkSmartPointer<vtkPolyData> polyData = fib->GetFiberPolyData();
+  m_Points = polyData->GetPoints();
+  m_Lines = polyData->GetLines();
+
+  if (m_Points!=nullptr && m_Points->GetDataType()==VTK_FLOAT)
+    m_FloatPoints = static_cast<const float*>(m_Points->GetVoidPointer(0));
+
+  if (m_Lines==nullptr)
+    return;
+
+  // build the fiber offset table once so that fibers can be accessed randomly and in parallel
+  m_Connectivity = m_Lines->GetPointer();
+  vtkIdType numEntries = m_Lines->GetNumberOfConnectivityEntries();
+  m_FiberOffsets.reserve(static_cast<std::size_t>(m_Lines->GetNumberOfCells()));
+  for (vtkIdType pos=0; pos<numEntries; pos += m_Connectivity[pos]+1)
+    m_FiberOffsets.push_back(pos+1);
+}
+
+mitk::TractDensityEngine::~TractDensityEngine()
+{
+}
+
+void mitk::TractDensityEngine::SetReferenceGeometry(const itk::ImageBase<3>* image)
+{
+  itk::ImageBase<3>::RegionType region = image->GetLargestPossibleRegion();
+  m_NumberOfVoxels = 1;
+  for (int i=0; i<3; ++i)
+  {
+    m_Origin[i] = image->GetOrigin()[i];
+    m_Spacing[i] = image->GetSpacing()[i];
+    m_Size[i] = static_cast<long long>(region.GetSize(i));
+    m_StartIndex[i] = static_cast<long long>(region.GetIndex(i));
+    m_NumberOfVoxels *= region.GetSize(i);
+  }
+
+  for (int r=0; r<3; ++r)
+    for (int c=0; c<3; ++c)
+      m_IndexToWorld[r][c] = image->GetDirection()[r][c] * m_Spacing[c];
+  m_WorldToIndex = vnl_inverse(m_IndexToWorld);
+}
+
+mitk::TractDensityEngine::VectorType mitk::TractDensityEngine::GetContinuousIndex(unsigned int fiber, unsigned int j) const
+{
+  vtkIdType id = m_Connectivity[m_FiberOffsets[fiber] + j];
+
+  VectorType p;
+  if (m_FloatPoints!=nullptr)
+  {
+    const float* fp = m_FloatPoints + 3*id;
+    p[0] = fp[0]; p[1] = fp[1]; p[2] = fp[2];
+  }
+  else
+  {
+    double dp[3];
+    m_Points->GetPoint(id, dp);
+    p[0] = dp[0]; p[1] = dp[1]; p[2] = dp[2];
+  }
+
+  return m_WorldToIndex * (p - m_Origin);
+}
+
+long long mitk::TractDensityEngine::GetOffset(const VectorType& cidx) const
+{
+  long long v[3];
+  for (int i=0; i<3; ++i)
+    v[i] = static_cast<long long>(std::floor(cidx[i] + 0.5));
+  return GetOffset(v);
+}
+
+long long mitk::TractDensityEngine::GetOffset(const long long* v) const
+{
+  long long x = v[0] - m_StartIndex[0];
+  long long y = v[1] - m_StartIndex[1];
+  long long z = v[2] - m_StartIndex[2];
+  if (x<0 || y<0 || z<0 || x>=m_Size[0] || y>=m_Size[1] || z>=m_Size[2])
+    return -1;
+  return x + m_Size[0]*(y + m_Size[1]*z);
+}
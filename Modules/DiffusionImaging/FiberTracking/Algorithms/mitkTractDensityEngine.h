@@ -0,0 +1,201 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_TractDensityEngine_H
+#define _MITK_TractDensityEngine_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkFiberBundle.h>
+#include <itkImageBase.h>
+#include <vnl/vnl_matrix_fixed.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vtkCellArray.h>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+namespace mitk
+{
+
+/**
+* \brief Voxelizes fiber bundles for tract density, fiber ending and directional color maps.
+*
+* The engine reads fiber points directly from the vtkPoints buffer of the bundle using a fiber offset table
+* that is built once on construction, so no vtkCell objects are created during voxelization. Each fiber segment
+* is traversed with a 3D-DDA in continuous index space which visits exactly the voxels intersected by the segment
+* and reports the intersection length in mm. All traversal methods are const and thread safe, so callers can
+* process fibers in parallel (e.g. with OpenMP) and accumulate into the output image atomically.
+*/
+class MITKFIBERTRACKING_EXPORT TractDensityEngine
+{
+public:
+
+  typedef vnl_vector_fixed< double, 3 > VectorType;
+
+  TractDensityEngine(const FiberBundle* fib);
+  ~TractDensityEngine();
+
+  /** Set output image geometry used to convert fiber points to voxel indices. */
+  void SetReferenceGeometry(const itk::ImageBase<3>* image);
+
+  unsigned int GetNumFibers() const { return static_cast<unsigned int>(m_FiberOffsets.size()); }
+  unsigned int GetNumPoints(unsigned int fiber) const { return static_cast<unsigned int>(m_Connectivity[m_FiberOffsets[fiber]-1]); }
+  unsigned long long GetNumberOfVoxels() const { return m_NumberOfVoxels; }
+
+  /** Continuous voxel index of the j-th point of the specified fiber. */
+  VectorType GetContinuousIndex(unsigned int fiber, unsigned int j) const;
+
+  /** Linear buffer offset of the voxel containing the continuous index. Returns -1 if outside of the image. */
+  long long GetOffset(const VectorType& cidx) const;
+
+  /**
+  * \brief Calls functor(offset, length, segmentDirection) for every image voxel intersected by the fiber.
+  *
+  * offset is the linear buffer offset of the voxel, length is the intersection length in mm and segmentDirection
+  * is the normalized world direction of the current segment. Voxels outside of the image are skipped.
+  */
+  template< class Functor >
+  void TraverseFiber(unsigned int fiber, Functor& functor) const
+  {
+    unsigned int numPoints = GetNumPoints(fiber);
+    if (numPoints<2)
+      return;
+
+    VectorType start = GetContinuousIndex(fiber, 0);
+    for (unsigned int j=1; j<numPoints; ++j)
+    {
+      VectorType end = GetContinuousIndex(fiber, j);
+      TraverseSegment(start, end, functor);
+      start = end;
+    }
+  }
+
+  template< class Functor >
+  void TraverseSegment(const VectorType& a, const VectorType& b, Functor& functor) const
+  {
+    VectorType d = b - a;
+
+    VectorType world_dir;
+    double len = 0;
+    for (int i=0; i<3; ++i)
+    {
+      double mm = d[i]*m_Spacing[i];
+      len += mm*mm;
+    }
+    len = std::sqrt(len);
+    world_dir = m_IndexToWorld * d;
+    if (world_dir.magnitude()>0)
+      world_dir.normalize();
+
+    long long v[3];
+    long long e[3];
+    int step[3];
+    double t_max[3];
+    double t_delta[3];
+    unsigned long long num_steps = 0;
+    for (int i=0; i<3; ++i)
+    {
+      // voxel k covers the continuous index range [k-0.5, k+0.5), analogous to itk::Math::RoundHalfIntegerUp
+      v[i] = static_cast<long long>(std::floor(a[i] + 0.5));
+      e[i] = static_cast<long long>(std::floor(b[i] + 0.5));
+      num_steps += static_cast<unsigned long long>(std::abs(e[i]-v[i]));
+      if (e[i]>v[i])
+      {
+        step[i] = 1;
+        t_delta[i] = 1.0/d[i];
+        t_max[i] = (static_cast<double>(v[i]) + 0.5 - a[i])/d[i];
+      }
+      else if (e[i]<v[i])
+      {
+        step[i] = -1;
+        t_delta[i] = -1.0/d[i];
+        t_max[i] = (static_cast<double>(v[i]) - 0.5 - a[i])/d[i];
+      }
+      else
+      {
+        step[i] = 0;
+        t_delta[i] = 0;
+        t_max[i] = std::numeric_limits<double>::max();
+      }
+    }
+
+    double t = 0;
+    for (unsigned long long s=0; s<=num_steps; ++s)
+    {
+      // only axes that still have voxels to go are considered so that the walk always terminates in the end voxel
+      int axis = -1;
+      double t_next = 1.0;
+      if (s<num_steps)
+        for (int i=0; i<3; ++i)
+          if (v[i]!=e[i] && (axis<0 || t_max[i]<t_max[axis]))
+            axis = i;
+      if (axis>=0)
+        t_next = std::max(t, std::min(t_max[axis], 1.0));
+
+      long long offset = GetOffset(v);
+      if (offset>=0)
+        functor(offset, (t_next-t)*len, world_dir);
+
+      if (axis<0)
+        break;
+      t = t_next;
+      v[axis] += step[axis];
+      t_max[axis] += t_delta[axis];
+    }
+  }
+
+  /** Calls functor(offset) for the voxels containing the first and the last point of the fiber. */
+  template< class Functor >
+  void TraverseEndpoints(unsigned int fiber, Functor& functor) const
+  {
+    unsigned int numPoints = GetNumPoints(fiber);
+    if (numPoints>0)
+    {
+      long long offset = GetOffset(GetContinuousIndex(fiber, 0));
+      if (offset>=0)
+        functor(offset);
+    }
+    if (numPoints>=2)
+    {
+      long long offset = GetOffset(GetContinuousIndex(fiber, numPoints-1));
+      if (offset>=0)
+        functor(offset);
+    }
+  }
+
+protected:
+
+  long long GetOffset(const long long* v) const;
+
+  vtkSmartPointer< vtkPoints >      m_Points;
+  const float*                      m_FloatPoints;      ///< direct pointer to the point buffer if the points are stored as float
+  vtkSmartPointer< vtkCellArray >   m_Lines;
+  const vtkIdType*                  m_Connectivity;     ///< legacy cell array layout (n, id_0, ..., id_n-1, n, ...)
+  std::vector< vtkIdType >          m_FiberOffsets;     ///< position of the first point id of each fiber in m_Connectivity
+
+  vnl_matrix_fixed< double, 3, 3 >  m_WorldToIndex;
+  vnl_matrix_fixed< double, 3, 3 >  m_IndexToWorld;
+  VectorType                        m_Origin;
+  VectorType                        m_Spacing;
+  long long                         m_Size[3];
+  long long                         m_StartIndex[3];
+  unsigned long long                m_NumberOfVoxels;
+};
+
+}
+
+#endif
@@ -0,0 +1,508 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkCompactFiberContainer.h"
+#include <mitkFiberBundle.h>
+#include <mitkExceptionMacro.h>
+#include <vtkCellArray.h>
+#include <vtkIdTypeArray.h>
+#include <fstream>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <limits>
+
+#if defined(_WIN32) && !defined(__CYGWIN__)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const char FILE_MAGIC[8] = { 'M', 'I', 'T', 'K', 'C', 'F', 'B', '1' };
+
+  struct FileHeader
+  {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t encoding;
+    std::uint64_t numFibers;
+    std::uint64_t numPoints;
+    float         quantizationOrigin[3];
+    float         quantizationScale[3];
+  };
+
+  std::uint64_t Align8(std::uint64_t pos)
+  {
+    return (pos + 7) & ~static_cast<std::uint64_t>(7);
+  }
+
+  std::size_t GetBytesPerPoint(mitk::CompactFiberContainer::PointEncoding encoding)
+  {
+    return encoding==mitk::CompactFiberContainer::FLOAT32 ? 3*sizeof(float) : 3*sizeof(std::uint16_t);
+  }
+
+  std::uint16_t FloatToHalf(float value)
+  {
+    std::uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    std::uint32_t sign = (f >> 16) & 0x8000;
+    std::int32_t exponent = static_cast<std::int32_t>((f >> 23) & 0xff) - 127 + 15;
+    std::uint32_t mantissa = f & 0x007fffff;
+
+    if (exponent <= 0)
+    {
+      if (exponent < -10)
+        return static_cast<std::uint16_t>(sign);
+      mantissa = (mantissa | 0x00800000) >> (1 - exponent);
+      return static_cast<std::uint16_t>(sign | ((mantissa + 0x00001000) >> 13));
+    }
+    if (exponent >= 31)
+      return static_cast<std::uint16_t>(sign | 0x7c00);
+
+    // round to nearest, carry into the exponent is intended
+    return static_cast<std::uint16_t>(sign | ((static_cast<std::uint32_t>(exponent) << 10) + ((mantissa + 0x00001000) >> 13)));
+  }
+
+  float HalfToFloat(std::uint16_t h)
+  {
+    std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000) << 16;
+    std::uint32_t exponent = (h >> 10) & 0x1f;
+    std::uint32_t mantissa = h & 0x03ff;
+    std::uint32_t f;
+
+    if (exponent == 0)
+    {
+      if (mantissa == 0)
+        f = sign;
+      else
+      {
+        // subnormal half -> normalized float
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x0400) == 0)
+        {
+          mantissa <<= 1;
+          --exponent;
+        }
+        mantissa &= 0x03ff;
+        f = sign | (exponent << 23) | (mantissa << 13);
+      }
+    }
+    else if (exponent == 31)
+      f = sign | 0x7f800000 | (mantissa << 13);
+    else
+      f = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+
+    float value;
+    std::memcpy(&value, &f, sizeof(value));
+    return value;
+  }
+}
+
+/** Read-only memory mapping of a complete file. */
+class mitk::CompactFiberContainer::MappedFile
+{
+public:
+
+  MappedFile(const std::string& filename)
+    : m_Data(nullptr)
+    , m_Size(0)
+  {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    m_File = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_File == INVALID_HANDLE_VALUE)
+      mitkThrow() << "Could not open " << filename;
+    LARGE_INTEGER size;
+    GetFileSizeEx(m_File, &size);
+    m_Size = static_cast<std::uint64_t>(size.QuadPart);
+    m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_Mapping == nullptr)
+    {
+      CloseHandle(m_File);
+      mitkThrow() << "Could not map " << filename;
+    }
+    m_Data = static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+    m_File = open(filename.c_str(), O_RDONLY);
+    if (m_File < 0)
+      mitkThrow() << "Could not open " << filename;
+    struct stat st;
+    fstat(m_File, &st);
+    m_Size = static_cast<std::uint64_t>(st.st_size);
+    void* data = mmap(nullptr, static_cast<std::size_t>(m_Size), PROT_READ, MAP_SHARED, m_File, 0);
+    if (data == MAP_FAILED)
+    {
+      close(m_File);
+      mitkThrow() << "Could not map " << filename;
+    }
+    m_Data = static_cast<const char*>(data);
+#endif
+  }
+
+  ~MappedFile()
+  {
+#if defined(_WIN32) && !defined(__CYGWIN__)
+    UnmapViewOfFile(m_Data);
+    CloseHandle(m_Mapping);
+    CloseHandle(m_File);
+#else
+    munmap(const_cast<char*>(m_Data), static_cast<std::size_t>(m_Size));
+    close(m_File);
+#endif
+  }
+
+  const char* GetData() const { return m_Data; }
+  std::uint64_t GetSize() const { return m_Size; }
+
+private:
+
+  const char*   m_Data;
+  std::uint64_t m_Size;
+#if defined(_WIN32) && !defined(__CYGWIN__)
+  HANDLE        m_File;
+  HANDLE        m_Mapping;
+#else
+  int           m_File;
+#endif
+};
+
+mitk::CompactFiberContainer::CompactFiberContainer()
+  : m_NumFibers(0)
+  , m_NumPoints(0)
+  , m_Encoding(FLOAT32)
+  , m_Offsets(nullptr)
+  , m_Weights(nullptr)
+  , m_Points(nullptr)
+{
+  for (int i=0; i<3; ++i)
+  {
+    m_QuantizationOrigin[i] = 0;
+    m_QuantizationScale[i] = 1;
+  }
+  m_OffsetBuffer.push_back(0);
+  m_Offsets = m_OffsetBuffer.data();
+}
+
+mitk::CompactFiberContainer::~CompactFiberContainer()
+{
+}
+
+bool mitk::CompactFiberContainer::IsMemoryMapped() const
+{
+  return m_MappedFile != nullptr;
+}
+
+std::uint64_t mitk::CompactFiberContainer::GetMemorySize() const
+{
+  return (m_NumFibers+1)*sizeof(std::uint64_t) + m_NumFibers*sizeof(float) + m_NumPoints*GetBytesPerPoint(m_Encoding);
+}
+
+void mitk::CompactFiberContainer::Initialize(const FiberBundle* fib, PointEncoding encoding)
+{
+  m_MappedFile = nullptr;
+  m_Encoding = encoding;
+  m_NumFibers = fib->GetNumFibers();
+
+  // views are copied from their container, other bundles from their polydata
+  const CompactFiberContainer* base = fib->GetCompactFibers();
+  const std::vector<unsigned int>& baseIds = fib->GetCompactFiberIds();
+  vtkSmartPointer<vtkPolyData> polyData;
+  if (base==nullptr)
+    polyData = fib->GetFiberPolyData();
+
+  // offsets and number of points
+  m_OffsetBuffer.resize(m_NumFibers+1);
+  m_OffsetBuffer[0] = 0;
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+  {
+    std::uint64_t n = base!=nullptr ? base->GetNumPoints(baseIds[i]) : static_cast<std::uint64_t>(polyData->GetCell(i)->GetNumberOfPoints());
+    m_OffsetBuffer[i+1] = m_OffsetBuffer[i] + n;
+  }
+  m_NumPoints = m_OffsetBuffer[m_NumFibers];
+
+  m_WeightBuffer.resize(m_NumFibers);
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+    m_WeightBuffer[i] = fib->GetFiberWeight(i);
+
+  // quantization range is the bounding box of the points
+  if (encoding==QUANTIZED16 && m_NumPoints>0)
+  {
+    const BaseGeometry::BoundsArrayType bounds = fib->GetGeometry()->GetBounds();
+    for (int k=0; k<3; ++k)
+    {
+      m_QuantizationOrigin[k] = static_cast<float>(bounds[2*k]);
+      double extent = bounds[2*k+1]-bounds[2*k];
+      m_QuantizationScale[k] = extent>0 ? static_cast<float>(extent/std::numeric_limits<std::uint16_t>::max()) : 1.0f;
+    }
+  }
+
+  m_PointBuffer.resize(static_cast<std::size_t>(m_NumPoints*GetBytesPerPoint(encoding)));
+  std::uint64_t p = 0;
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+  {
+    if (base!=nullptr)
+    {
+      for (unsigned int j=0; j<base->GetNumPoints(baseIds[i]); ++j, ++p)
+      {
+        PointType point = base->GetPoint(baseIds[i], j);
+        double x[3] = { point[0], point[1], point[2] };
+        EncodePoint(p, x);
+      }
+    }
+    else
+    {
+      vtkPoints* points = polyData->GetCell(i)->GetPoints();
+      for (vtkIdType j=0; j<points->GetNumberOfPoints(); ++j, ++p)
+        EncodePoint(p, points->GetPoint(j));
+    }
+  }
+
+  m_Offsets = m_OffsetBuffer.data();
+  m_Weights = m_WeightBuffer.data();
+  m_Points = m_PointBuffer.data();
+  this->Modified();
+}
+
+void mitk::CompactFiberContainer::EncodePoint(std::uint64_t p, const double x[3])
+{
+  float* fp = reinterpret_cast<float*>(m_PointBuffer.data());
+  std::uint16_t* hp = reinterpret_cast<std::uint16_t*>(m_PointBuffer.data());
+  for (int k=0; k<3; ++k)
+  {
+    switch (m_Encoding)
+    {
+    case FLOAT32:
+      fp[3*p+k] = static_cast<float>(x[k]);
+      break;
+    case FLOAT16:
+      hp[3*p+k] = FloatToHalf(static_cast<float>(x[k]));
+      break;
+    case QUANTIZED16:
+      hp[3*p+k] = static_cast<std::uint16_t>(std::min(65535.0, std::max(0.0, std::round((x[k]-m_QuantizationOrigin[k])/m_QuantizationScale[k]))));
+      break;
+    }
+  }
+}
+
+void mitk::CompactFiberContainer::Save(const std::string& filename) const
+{
+  std::ofstream out(filename.c_str(), std::ios::binary);
+  if (!out.is_open())
+    mitkThrow() << "Could not open " << filename << " for writing";
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.version = 1;
+  header.encoding = static_cast<std::uint32_t>(m_Encoding);
+  header.numFibers = m_NumFibers;
+  header.numPoints = m_NumPoints;
+  for (int k=0; k<3; ++k)
+  {
+    header.quantizationOrigin[k] = m_QuantizationOrigin[k];
+    header.quantizationScale[k] = m_QuantizationScale[k];
+  }
+
+  // every section starts 8 byte aligned so that it can be accessed in place after mapping
+  const char padding[8] = { 0 };
+  std::uint64_t pos = sizeof(FileHeader);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(FileHeader));
+  out.write(padding, static_cast<std::streamsize>(Align8(pos)-pos));
+  pos = Align8(pos);
+
+  out.write(reinterpret_cast<const char*>(m_Offsets), static_cast<std::streamsize>((m_NumFibers+1)*sizeof(std::uint64_t)));
+  pos += (m_NumFibers+1)*sizeof(std::uint64_t);
+
+  out.write(reinterpret_cast<const char*>(m_Weights), static_cast<std::streamsize>(m_NumFibers*sizeof(float)));
+  pos += m_NumFibers*sizeof(float);
+  out.write(padding, static_cast<std::streamsize>(Align8(pos)-pos));
+
+  out.write(static_cast<const char*>(m_Points), static_cast<std::streamsize>(m_NumPoints*GetBytesPerPoint(m_Encoding)));
+  if (!out.good())
+    mitkThrow() << "Error writing " << filename;
+}
+
+mitk::CompactFiberContainer::Pointer mitk::CompactFiberContainer::Load(const std::string& filename)
+{
+  std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>(filename);
+  if (file->GetSize() < sizeof(FileHeader))
+    mitkThrow() << filename << " is not a compact fiber file";
+
+  FileHeader header;
+  std::memcpy(&header, file->GetData(), sizeof(FileHeader));
+  if (std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC))!=0 || header.version!=1 || header.encoding>QUANTIZED16)
+    mitkThrow() << filename << " is not a compact fiber file";
+
+  Pointer container = New();
+  container->m_Encoding = static_cast<PointEncoding>(header.encoding);
+  container->m_NumFibers = static_cast<unsigned int>(header.numFibers);
+  container->m_NumPoints = header.numPoints;
+  for (int k=0; k<3; ++k)
+  {
+    container->m_QuantizationOrigin[k] = header.quantizationOrigin[k];
+    container->m_QuantizationScale[k] = header.quantizationScale[k];
+  }
+
+  // sizes are checked before they are multiplied, so a corrupt header can not overflow the offset computation
+  const std::uint64_t fileSize = file->GetSize();
+  if (header.numFibers>=std::numeric_limits<unsigned int>::max() || header.numFibers>=fileSize/sizeof(std::uint64_t) || header.numPoints>fileSize/GetBytesPerPoint(container->m_Encoding))
+    mitkThrow() << filename << " is truncated";
+  std::uint64_t offsetsPos = Align8(sizeof(FileHeader));
+  std::uint64_t weightsPos = offsetsPos + (header.numFibers+1)*sizeof(std::uint64_t);
+  std::uint64_t pointsPos = Align8(weightsPos + header.numFibers*sizeof(float));
+  if (pointsPos + header.numPoints*GetBytesPerPoint(container->m_Encoding) > fileSize)
+    mitkThrow() << filename << " is truncated";
+
+  const std::uint64_t* offsets = reinterpret_cast<const std::uint64_t*>(file->GetData() + offsetsPos);
+  if (offsets[0]!=0 || offsets[header.numFibers]!=header.numPoints)
+    mitkThrow() << filename << " contains invalid fiber offsets";
+  for (std::uint64_t i=0; i<header.numFibers; ++i)
+    if (offsets[i+1]<offsets[i] || offsets[i+1]-offsets[i]>std::numeric_limits<unsigned int>::max())
+      mitkThrow() << filename << " contains invalid fiber offsets";
+
+  container->m_Offsets = offsets;
+  container->m_Weights = reinterpret_cast<const float*>(file->GetData() + weightsPos);
+  container->m_Points = file->GetData() + pointsPos;
+  container->m_OffsetBuffer.clear();
+  container->m_MappedFile = file;
+  return container;
+}
+
+mitk::CompactFiberContainer::PointType mitk::CompactFiberContainer::DecodePoint(std::uint64_t p) const
+{
+  PointType point;
+  switch (m_Encoding)
+  {
+  case FLOAT32:
+  {
+    const float* fp = static_cast<const float*>(m_Points) + 3*p;
+    point[0] = fp[0]; point[1] = fp[1]; point[2] = fp[2];
+    break;
+  }
+  case FLOAT16:
+  {
+    const std::uint16_t* hp = static_cast<const std::uint16_t*>(m_Points) + 3*p;
+    for (int k=0; k<3; ++k)
+      point[k] = HalfToFloat(hp[k]);
+    break;
+  }
+  case QUANTIZED16:
+  {
+    const std::uint16_t* hp = static_cast<const std::uint16_t*>(m_Points) + 3*p;
+    for (int k=0; k<3; ++k)
+      point[k] = m_QuantizationOrigin[k] + m_QuantizationScale[k]*hp[k];
+    break;
+  }
+  }
+  return point;
+}
+
+mitk::CompactFiberContainer::PointType mitk::CompactFiberContainer::GetPoint(unsigned int fiber, unsigned int j) const
+{
+  return DecodePoint(m_Offsets[fiber] + j);
+}
+
+void mitk::CompactFiberContainer::ComputeFiberGeometry(const std::vector<unsigned int>& ids, std::vector<float>& lengths, double bounds[6]) const
+{
+  for (int k=0; k<3; ++k)
+  {
+    bounds[2*k] = std::numeric_limits<double>::max();
+    bounds[2*k+1] = -std::numeric_limits<double>::max();
+  }
+
+  lengths.resize(ids.size());
+  for (std::size_t i=0; i<ids.size(); ++i)
+  {
+    float length = 0;
+    unsigned int n = GetNumPoints(ids[i]);
+    PointType last;
+    for (unsigned int j=0; j<n; ++j)
+    {
+      PointType p = GetPoint(ids[i], j);
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] = std::min(bounds[2*k], static_cast<double>(p[k]));
+        bounds[2*k+1] = std::max(bounds[2*k+1], static_cast<double>(p[k]));
+      }
+      if (j>0)
+        length += (p-last).magnitude();
+      last = p;
+    }
+    lengths[i] = length;
+  }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::CompactFiberContainer::CreatePolyData(const std::vector<unsigned int>& ids) const
+{
+  std::uint64_t numPoints = 0;
+  for (unsigned int id : ids)
+    numPoints += GetNumPoints(id);
+
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  points->SetDataTypeToFloat();
+  points->SetNumberOfPoints(static_cast<vtkIdType>(numPoints));
+  float* pointBuffer = static_cast<float*>(points->GetVoidPointer(0));
+
+  // cells are written directly in the legacy vtkCellArray layout (n, id_0, ..., id_n-1)
+  vtkSmartPointer<vtkIdTypeArray> cells = vtkSmartPointer<vtkIdTypeArray>::New();
+  cells->SetNumberOfValues(static_cast<vtkIdType>(numPoints + ids.size()));
+  vtkIdType* cellBuffer = cells->GetPointer(0);
+
+  vtkIdType pointId = 0;
+  vtkIdType cellPos = 0;
+  for (unsigned int id : ids)
+  {
+    unsigned int n = GetNumPoints(id);
+    cellBuffer[cellPos++] = n;
+    for (unsigned int j=0; j<n; ++j)
+    {
+      PointType p = GetPoint(id, j);
+      pointBuffer[3*pointId] = p[0];
+      pointBuffer[3*pointId+1] = p[1];
+      pointBuffer[3*pointId+2] = p[2];
+      cellBuffer[cellPos++] = pointId++;
+    }
+  }
+
+  vtkSmartPointer<vtkCellArray> lines = vtkSmartPointer<vtkCellArray>::New();
+  lines->SetCells(static_cast<vtkIdType>(ids.size()), cells);
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetLines(lines);
+  return polyData;
+}
+
+mitk::FiberBundle::Pointer mitk::CompactFiberContainer::CreateFiberBundle(const std::vector<unsigned int>& ids) const
+{
+  std::vector<unsigned int> fibers = ids;
+  if (fibers.empty())
+  {
+    fibers.resize(m_NumFibers);
+    for (unsigned int i=0; i<m_NumFibers; ++i)
+      fibers[i] = i;
+  }
+
+  mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New();
+  fib->SetCompactFibers(this, fibers);
+  return fib;
+}
@@ -0,0 +1,121 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_CompactFiberContainer_H
+#define _MITK_CompactFiberContainer_H
+
+#include <MitkFiberTrackingExports.h>
+#include <mitkCommon.h>
+#include <itkObject.h>
+#include <vnl/vnl_vector_fixed.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+namespace mitk {
+
+class FiberBundle;
+
+/**
+* \brief Compact streamline storage independent of vtkPolyData.
+*
+* Fibers are stored as one contiguous coordinate buffer plus an offset array (fiber i consists of the points
+* offsets[i] ... offsets[i+1]-1). Coordinates are kept as float32, fp16 or as 16 bit values quantized to the
+* bounding box of the bundle. The container can be written to a flat binary file that is memory mapped on
+* loading, so points are only paged in when they are accessed.
+*
+* mitk::FiberBundle can use the container as storage: CreateFiberBundle() returns a bundle that is a view on a list of
+* fiber ids. Subsets of such a bundle (ExtractFiberSubset(), SubsampleFibers(), FilterByWeights()) are again views on
+* the same container. The vtkPolyData of a view is only created when it is accessed, e.g. for rendering.
+*/
+class MITKFIBERTRACKING_EXPORT CompactFiberContainer : public itk::Object
+{
+public:
+
+  enum PointEncoding
+  {
+    FLOAT32 = 0,    ///< 12 byte per point, lossless w.r.t. the float vtkPoints of mitk::FiberBundle
+    FLOAT16 = 1,    ///< 6 byte per point, IEEE half precision
+    QUANTIZED16 = 2 ///< 6 byte per point, uniformly quantized to the bounding box (error <= extent/131070)
+  };
+
+  typedef vnl_vector_fixed< float, 3 > PointType;
+
+  mitkClassMacroItkParent( CompactFiberContainer, itk::Object )
+  itkFactorylessNewMacro(Self)
+
+  /** Copy the fibers and weights of the bundle into the compact representation. Views on a container are copied without creating their vtkPolyData. */
+  void Initialize(const FiberBundle* fib, PointEncoding encoding = FLOAT32);
+
+  /** Write container to a flat binary file that can be memory mapped by Load(). */
+  void Save(const std::string& filename) const;
+
+  /** Memory map a file written by Save(). Points are read lazily by the operating system. */
+  static Pointer Load(const std::string& filename);
+
+  unsigned int GetNumFibers() const { return m_NumFibers; }
+  std::uint64_t GetNumPoints() const { return m_NumPoints; }
+  unsigned int GetNumPoints(unsigned int fiber) const { return static_cast<unsigned int>(m_Offsets[fiber+1]-m_Offsets[fiber]); }
+  PointEncoding GetEncoding() const { return m_Encoding; }
+  bool IsMemoryMapped() const;
+
+  /** Memory occupied by points, offsets and weights in byte. */
+  std::uint64_t GetMemorySize() const;
+
+  PointType GetPoint(unsigned int fiber, unsigned int j) const;
+  float GetFiberWeight(unsigned int fiber) const { return m_Weights[fiber]; }
+
+  /** Length of the fibers and bounding box of their points. */
+  void ComputeFiberGeometry(const std::vector< unsigned int >& ids, std::vector< float >& lengths, double bounds[6]) const;
+
+  /** Create the vtkPolyData of the specified fibers, used to materialize views. */
+  vtkSmartPointer<vtkPolyData> CreatePolyData(const std::vector< unsigned int >& ids) const;
+
+  /** Create a fiber bundle that is a view on the specified fibers (all fibers if ids is empty). */
+  itk::SmartPointer<FiberBundle> CreateFiberBundle(const std::vector< unsigned int >& ids = std::vector< unsigned int >()) const;
+
+protected:
+
+  CompactFiberContainer();
+  ~CompactFiberContainer() override;
+
+  PointType DecodePoint(std::uint64_t p) const;
+  void EncodePoint(std::uint64_t p, const double x[3]);
+
+  class MappedFile;
+
+  unsigned int              m_NumFibers;
+  std::uint64_t             m_NumPoints;
+  PointEncoding             m_Encoding;
+  float                     m_QuantizationOrigin[3];
+  float                     m_QuantizationScale[3];
+
+  // either point into the owned buffers below or into the mapped file
+  const std::uint64_t*      m_Offsets;
+  const float*              m_Weights;
+  const void*               m_Points;
+
+  std::vector< std::uint64_t >  m_OffsetBuffer;
+  std::vector< float >          m_WeightBuffer;
+  std::vector< char >           m_PointBuffer;
+  std::shared_ptr< MappedFile > m_MappedFile;
+};
+
+}
+
+#endif
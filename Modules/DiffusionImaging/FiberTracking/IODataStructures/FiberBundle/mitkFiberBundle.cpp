@@ -50,6 +50,7 @@ const char* mitk::FiberBundle::FIBER_ID_ARRAY = "Fiber_IDs";
 
 mitk::FiberBundle::FiberBundle( vtkPolyData* fiberPolyData )
   : m_NumFibers(0)
+  , m_RoiCacheCounter(0)
 {
   m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
   m_FiberWeights->SetName("FIBER_WEIGHTS");
@@ -75,6 +76,14 @@ mitk::FiberBundle::~FiberBundle()
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 {
+  if (m_FiberPolyData==nullptr)
+  {
+    std::vector<unsigned int> ids;
+    for (unsigned int i=0; i<m_NumFibers; ++i)
+      ids.push_back(i);
+    return this->CreateCompactSubset(ids);
+  }
+
   mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New(m_FiberPolyData);
   newFib->SetFiberColors(this->m_FiberColors);
   newFib->SetFiberWeights(this->m_FiberWeights);
@@ -83,6 +92,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::GetDeepCopy()
 
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vector<unsigned int> fiberIds, vtkSmartPointer<vtkFloatArray> weights)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPolyData> newFiberPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> newLineSet = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> newPointSet = vtkSmartPointer<vtkPoints>::New();
@@ -122,6 +132,7 @@ vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GeneratePolyDataByIds(std::vecto
 // merge two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::FiberBundle::Pointer > fibs)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
@@ -192,6 +203,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundles(std::vector< mitk::Fibe
 // merge two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
 {
+  this->InitializeFiberPolyData();
   if (fib==nullptr)
     return this->GetDeepCopy();
 
@@ -260,6 +272,15 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::AddBundle(mitk::FiberBundle* fib)
 // Only retain fibers with a weight larger than the specified threshold
 mitk::FiberBundle::Pointer mitk::FiberBundle::FilterByWeights(float weight_thr, bool invert)
 {
+  if (m_CompactFibers.IsNotNull())
+  {
+    std::vector<unsigned int> ids;
+    for (unsigned int i=0; i<this->GetNumFibers(); i++)
+      if ( !((invert && this->GetFiberWeight(i)>weight_thr) || (!invert && this->GetFiberWeight(i)<=weight_thr)) )
+        ids.push_back(i);
+    return this->CreateCompactSubset(ids);
+  }
+
   vtkSmartPointer<vtkPolyData> vNewPolyData = vtkSmartPointer<vtkPolyData>::New();
   vtkSmartPointer<vtkCellArray> vNewLines = vtkSmartPointer<vtkCellArray>::New();
   vtkSmartPointer<vtkPoints> vNewPoints = vtkSmartPointer<vtkPoints>::New();
@@ -322,6 +343,13 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool
     std::srand(0);
   std::random_shuffle(ids.begin(), ids.end());
 
+  if (m_CompactFibers.IsNotNull())
+  {
+    ids.resize(new_num_fibs);
+    return this->CreateCompactSubset(ids);
+  }
+
+  this->InitializeFiberPolyData();
   unsigned int counter = 0;
   for (unsigned int i=0; i<new_num_fibs; i++)
   {
@@ -356,6 +384,7 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubsampleFibers(float factor, bool
 // subtract two fiber bundles
 mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle* fib)
 {
+  this->InitializeFiberPolyData();
   if (fib==nullptr)
     return this->GetDeepCopy();
 
@@ -485,10 +514,18 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::SubtractBundle(mitk::FiberBundle*
  */
 void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, bool updateGeometry)
 {
+  // the fibers do not correspond to the compact container anymore
+  m_CompactFibers = nullptr;
+  m_CompactFiberIds.clear();
+
   if (fiberPD == nullptr)
     this->m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
   else
+  {
+    if (m_FiberPolyData == nullptr)
+      m_FiberPolyData = vtkSmartPointer<vtkPolyData>::New();
     m_FiberPolyData->DeepCopy(fiberPD);
+  }
 
   m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfLines());
 
@@ -503,11 +540,69 @@ void mitk::FiberBundle::SetFiberPolyData(vtkSmartPointer<vtkPolyData> fiberPD, b
  */
 vtkSmartPointer<vtkPolyData> mitk::FiberBundle::GetFiberPolyData() const
 {
+  const_cast<FiberBundle*>(this)->InitializeFiberPolyData();
   return m_FiberPolyData;
 }
 
+vtkSmartPointer<vtkUnsignedCharArray> mitk::FiberBundle::GetFiberColors() const
+{
+  const_cast<FiberBundle*>(this)->InitializeFiberPolyData();
+  return m_FiberColors;
+}
+
+void mitk::FiberBundle::SetCompactFibers(const CompactFiberContainer* fibers, const std::vector<unsigned int>& fiberIds)
+{
+  m_CompactFibers = fibers;
+  m_CompactFiberIds = fiberIds;
+  m_FiberPolyData = nullptr;
+  m_FiberIdDataSet = nullptr;
+  m_FiberColors = nullptr;
+
+  m_NumFibers = static_cast<unsigned int>(fiberIds.size());
+  m_FiberWeights = vtkSmartPointer<vtkFloatArray>::New();
+  m_FiberWeights->SetName("FIBER_WEIGHTS");
+  m_FiberWeights->SetNumberOfValues(m_NumFibers);
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+    m_FiberWeights->SetValue(i, fibers->GetFiberWeight(fiberIds[i]));
+
+  this->UpdateFiberGeometry();
+  this->Modified();
+}
+
+/*
+ * create the vtkPolyData of a view on compact fibers
+ */
+void mitk::FiberBundle::InitializeFiberPolyData()
+{
+  if (m_FiberPolyData != nullptr)
+    return;
+
+  MITK_INFO << "Creating polydata of " << m_NumFibers << " compactly stored fibers";
+  m_FiberPolyData = m_CompactFibers->CreatePolyData(m_CompactFiberIds);
+  this->GenerateFiberIds();
+  this->ColorFibersByOrientation();
+}
+
+/*
+ * view on the same compact fibers, fiberIds are indices of this bundle
+ */
+mitk::FiberBundle::Pointer mitk::FiberBundle::CreateCompactSubset(const std::vector<unsigned int>& fiberIds)
+{
+  std::vector<unsigned int> containerIds;
+  containerIds.reserve(fiberIds.size());
+  for (unsigned int id : fiberIds)
+    containerIds.push_back(m_CompactFiberIds.at(id));
+
+  mitk::FiberBundle::Pointer newFib = mitk::FiberBundle::New();
+  newFib->SetCompactFibers(m_CompactFibers, containerIds);
+  for (unsigned int i=0; i<fiberIds.size(); ++i)
+    newFib->SetFiberWeight(i, this->GetFiberWeight(fiberIds[i]));
+  return newFib;
+}
+
 void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
 {
+  this->InitializeFiberPolyData();
   if (m_MaxFiberLength<=0)
     return;
 
@@ -566,6 +661,7 @@ void mitk::FiberBundle::ColorFibersByLength(bool opacity, bool normalize)
 
 void mitk::FiberBundle::ColorFibersByOrientation()
 {
+  this->InitializeFiberPolyData();
   //===== FOR WRITING A TEST ========================
   //  colorT size == tupelComponents * tupelElements
   //  compare color results
@@ -679,6 +775,7 @@ void mitk::FiberBundle::ColorFibersByOrientation()
 
 void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
 {
+  this->InitializeFiberPolyData();
   double window = 5;
 
   //colors and alpha value for each single point, RGBA = 4 components
@@ -802,6 +899,7 @@ void mitk::FiberBundle::ColorFibersByCurvature(bool, bool normalize)
 
 void mitk::FiberBundle::SetFiberOpacity(vtkDoubleArray* FAValArray)
 {
+  this->InitializeFiberPolyData();
   for(long i=0; i<m_FiberColors->GetNumberOfTuples(); i++)
   {
     double faValue = FAValArray->GetValue(i);
@@ -814,6 +912,7 @@ void mitk::FiberBundle::SetFiberOpacity(vtkDoubleArray* FAValArray)
 
 void mitk::FiberBundle::ResetFiberOpacity()
 {
+  this->InitializeFiberPolyData();
   for(long i=0; i<m_FiberColors->GetNumberOfTuples(); i++)
     m_FiberColors->SetComponent(i,3, 255.0 );
   m_UpdateTime3D.Modified();
@@ -830,6 +929,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(mitk::Image::Pointer FAimage, boo
 template <typename TPixel>
 void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Image::Pointer image, bool opacity, bool normalize)
 {
+  this->InitializeFiberPolyData();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
   m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
@@ -894,6 +994,7 @@ void mitk::FiberBundle::ColorFibersByScalarMap(const mitk::PixelType, mitk::Imag
 
 void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 {
+  this->InitializeFiberPolyData();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
   m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
@@ -960,6 +1061,7 @@ void mitk::FiberBundle::ColorFibersByFiberWeights(bool opacity, bool normalize)
 
 void mitk::FiberBundle::SetFiberColors(float r, float g, float b, float alpha)
 {
+  this->InitializeFiberPolyData();
   m_FiberColors = vtkSmartPointer<vtkUnsignedCharArray>::New();
   m_FiberColors->Allocate(m_FiberPolyData->GetNumberOfPoints() * 4);
   m_FiberColors->SetNumberOfComponents(4);
@@ -997,6 +1099,7 @@ void mitk::FiberBundle::GenerateFiberIds()
 
 float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool different_label)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
 
   MITK_INFO << "Calculating EP-Fraction";
@@ -1039,6 +1142,7 @@ float mitk::FiberBundle::GetNumEpFractionInMask(ItkUcharImgType* mask, bool diff
 
 std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgType* mask, mitk::PeakImage::ItkPeakImageType* peak_image)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
 
   MITK_INFO << "Calculating overlap";
@@ -1115,6 +1219,7 @@ std::tuple<float, float> mitk::FiberBundle::GetDirectionalOverlap(ItkUcharImgTyp
 
 float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPolyData> PolyData = m_FiberPolyData;
 
   MITK_INFO << "Calculating overlap";
@@ -1163,6 +1268,7 @@ float mitk::FiberBundle::GetOverlap(ItkUcharImgType* mask)
 
 mitk::FiberBundle::Pointer mitk::FiberBundle::RemoveFibersOutside(ItkUcharImgType* mask, bool invert)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
@@ -1270,6 +1376,8 @@ mitk::FiberBundle::Pointer mitk::FiberBundle::ExtractFiberSubset(DataNode* roi,
 
   if (tmp.size()<=0)
     return mitk::FiberBundle::New();
+  if (m_CompactFibers.IsNotNull())
+    return this->CreateCompactSubset(tmp);
   vtkSmartPointer<vtkFloatArray> weights = vtkSmartPointer<vtkFloatArray>::New();
   vtkSmartPointer<vtkPolyData> pTmp = GeneratePolyDataByIds(tmp, weights);
   mitk::FiberBundle::Pointer fib = mitk::FiberBundle::New(pTmp);
@@ -1348,55 +1456,74 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
   }
   else if ( dynamic_cast<mitk::PlanarFigure*>(roi->GetData()) )  // actual extraction
   {
+    mitk::PlanarFigure::Pointer planarFigure = dynamic_cast<mitk::PlanarFigure*>(roi->GetData());
+
+    // leaf results are cached until the planar figure or the fibers are modified
+    // the index has to be requested first, rebuilding it invalidates the cache
+    const FiberSegmentIndex* index = this->GetSegmentIndex();
+
+    std::vector<double> fingerprint;
     if ( dynamic_cast<mitk::PlanarPolygon*>(roi->GetData()) )
+      fingerprint.push_back(1);
+    else if ( dynamic_cast<mitk::PlanarCircle*>(roi->GetData()) )
+      fingerprint.push_back(2);
+    else
+      fingerprint.push_back(0);
+    for (unsigned int i=0; i<planarFigure->GetNumberOfControlPoints(); ++i)
     {
-      mitk::PlanarFigure::Pointer planarPoly = dynamic_cast<mitk::PlanarFigure*>(roi->GetData());
+      itk::Point<double,3> p = planarFigure->GetWorldControlPoint(i);
+      fingerprint.insert(fingerprint.end(), p.Begin(), p.End());
+    }
+    Vector3D normal = planarFigure->GetPlaneGeometry()->GetNormal();
+    fingerprint.insert(fingerprint.end(), normal.Begin(), normal.End());
 
+    auto cached = m_RoiCache.find(planarFigure.GetPointer());
+    if (cached!=m_RoiCache.end() && cached->second.fingerprint==fingerprint)
+    {
+      cached->second.lastUse = ++m_RoiCacheCounter;
+      return cached->second.fiberIds;
+    }
+
+    if ( dynamic_cast<mitk::PlanarPolygon*>(roi->GetData()) )
+    {
       //create vtkPolygon using controlpoints from planarFigure polygon
       vtkSmartPointer<vtkPolygon> polygonVtk = vtkSmartPointer<vtkPolygon>::New();
-      for (unsigned int i=0; i<planarPoly->GetNumberOfControlPoints(); ++i)
+      double bounds[6] = { itk::NumericTraits<double>::max(), itk::NumericTraits<double>::NonpositiveMin(),
+                           itk::NumericTraits<double>::max(), itk::NumericTraits<double>::NonpositiveMin(),
+                           itk::NumericTraits<double>::max(), itk::NumericTraits<double>::NonpositiveMin() };
+      for (unsigned int i=0; i<planarFigure->GetNumberOfControlPoints(); ++i)
       {
-        itk::Point<double,3> p = planarPoly->GetWorldControlPoint(i);
+        itk::Point<double,3> p = planarFigure->GetWorldControlPoint(i);
         vtkIdType id = polygonVtk->GetPoints()->InsertNextPoint(p[0], p[1], p[2] );
         polygonVtk->GetPointIds()->InsertNextId(id);
+        for (int k=0; k<3; ++k)
+        {
+          bounds[2*k] = std::min(bounds[2*k], p[k]);
+          bounds[2*k+1] = std::max(bounds[2*k+1], p[k]);
+        }
+      }
+      // vtkPolygon accepts intersections within tolerance*diagonal of the polygon bounds
+      double tolerance = 0.001;
+      double diagonal = std::sqrt( (bounds[1]-bounds[0])*(bounds[1]-bounds[0]) + (bounds[3]-bounds[2])*(bounds[3]-bounds[2]) + (bounds[5]-bounds[4])*(bounds[5]-bounds[4]) );
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] -= tolerance*(diagonal+1);
+        bounds[2*k+1] += tolerance*(diagonal+1);
       }
 
       MITK_INFO << "Extracting with polygon";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      result = index->Query(bounds, [&](double* p1, double* p2)
       {
-        ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        for (int j=0; j<numPoints-1; j++)
-        {
-          // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
-          double tolerance = 0.001;
-
-          // Outputs
-          double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
-          double x[3] = {0,0,0}; // The coordinate of the intersection
-          double pcoords[3] = {0,0,0};
-          int subId = 0;
-
-          int iD = polygonVtk->IntersectWithLine(p1, p2, tolerance, t, x, pcoords, subId);
-          if (iD!=0)
-          {
-            result.push_back(i);
-            break;
-          }
-        }
-      }
+        // Outputs
+        double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
+        double x[3] = {0,0,0}; // The coordinate of the intersection
+        double pcoords[3] = {0,0,0};
+        int subId = 0;
+        return polygonVtk->IntersectWithLine(p1, p2, tolerance, t, x, pcoords, subId)!=0;
+      });
     }
     else if ( dynamic_cast<mitk::PlanarCircle*>(roi->GetData()) )
     {
-      mitk::PlanarFigure::Pointer planarFigure = dynamic_cast<mitk::PlanarFigure*>(roi->GetData());
       Vector3D planeNormal = planarFigure->GetPlaneGeometry()->GetNormal();
       planeNormal.Normalize();
 
@@ -1405,65 +1532,88 @@ std::vector<unsigned int> mitk::FiberBundle::ExtractFiberIdSubset(DataNode *roi,
       mitk::Point3D V2w  = planarFigure->GetWorldControlPoint(1); //radiusPoint
 
       double radius = V1w.EuclideanDistanceTo(V2w);
+      double bounds[6];
+      for (int k=0; k<3; ++k)
+      {
+        bounds[2*k] = V1w[k] - radius;
+        bounds[2*k+1] = V1w[k] + radius;
+      }
       radius *= radius;
 
       MITK_INFO << "Extracting with circle";
-      boost::progress_display disp(m_NumFibers);
-      for (unsigned int i=0; i<m_NumFibers; i++)
+      result = index->Query(bounds, [&](double* p1, double* p2)
       {
-        ++disp ;
-        vtkCell* cell = m_FiberPolyData->GetCell(i);
-        auto numPoints = cell->GetNumberOfPoints();
-        vtkPoints* points = cell->GetPoints();
-
-        for (int j=0; j<numPoints-1; j++)
-        {
-          // Inputs
-          double p1[3] = {0,0,0};
-          points->GetPoint(j, p1);
-          double p2[3] = {0,0,0};
-          points->GetPoint(j+1, p2);
-
-          // Outputs
-          double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
-          double x[3] = {0,0,0}; // The coordinate of the intersection
-
-          int iD = vtkPlane::IntersectWithLine(p1,p2,planeNormal.GetDataPointer(),V1w.GetDataPointer(),t,x);
+        // Outputs
+        double t = 0; // Parametric coordinate of intersection (0 (corresponding to p1) to 1 (corresponding to p2))
+        double x[3] = {0,0,0}; // The coordinate of the intersection
+
+        if (vtkPlane::IntersectWithLine(p1,p2,planeNormal.GetDataPointer(),V1w.GetDataPointer(),t,x)==0)
+          return false;
+        double dist = (x[0]-V1w[0])*(x[0]-V1w[0])+(x[1]-V1w[1])*(x[1]-V1w[1])+(x[2]-V1w[2])*(x[2]-V1w[2]);
+        return dist <= radius;
+      });
+    }
 
-          if (iD!=0)
-          {
-            double dist = (x[0]-V1w[0])*(x[0]-V1w[0])+(x[1]-V1w[1])*(x[1]-V1w[1])+(x[2]-V1w[2])*(x[2]-V1w[2]);
-            if( dist <= radius)
-            {
-              result.push_back(i);
-              break;
-            }
-          }
-        }
-      }
+    if (cached==m_RoiCache.end() && m_RoiCache.size()>=MaxRoiCacheSize)
+    {
+      auto oldest = m_RoiCache.begin();
+      for (auto it = m_RoiCache.begin(); it!=m_RoiCache.end(); ++it)
+        if (it->second.lastUse < oldest->second.lastUse)
+          oldest = it;
+      m_RoiCache.erase(oldest);
     }
+
+    RoiCacheEntry& entry = m_RoiCache[planarFigure.GetPointer()];
+    entry.figure = planarFigure.GetPointer();
+    entry.fingerprint = fingerprint;
+    entry.fiberIds = result;
+    entry.lastUse = ++m_RoiCacheCounter;
     return result;
   }
 
   return result;
 }
 
+const mitk::FiberSegmentIndex* mitk::FiberBundle::GetSegmentIndex()
+{
+  this->InitializeFiberPolyData();
+  if (m_SegmentIndex==nullptr || m_SegmentIndex->GetGeometryMTime()!=FiberSegmentIndex::GetGeometryMTime(m_FiberPolyData))
+  {
+    MITK_INFO << "Building fiber segment index";
+    m_SegmentIndex = std::make_shared<FiberSegmentIndex>(m_FiberPolyData);
+    m_RoiCache.clear();
+  }
+  return m_SegmentIndex.get();
+}
+
 void mitk::FiberBundle::UpdateFiberGeometry()
 {
-  vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
-  cleaner->SetInputData(m_FiberPolyData);
-  cleaner->PointMergingOff();
-  cleaner->Update();
-  m_FiberPolyData = cleaner->GetOutput();
+  m_SegmentIndex = nullptr;
+  m_RoiCache.clear();
 
   m_FiberLengths.clear();
   m_MeanFiberLength = 0;
   m_MedianFiberLength = 0;
   m_LengthStDev = 0;
-  m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfCells());
 
-  if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPolyData->GetNumberOfPoints())
-    this->ColorFibersByOrientation();
+  double bounds[6];
+  if (m_FiberPolyData == nullptr) // view on compact fibers, lengths and bounds are computed without creating the polydata
+  {
+    m_NumFibers = static_cast<unsigned int>(m_CompactFiberIds.size());
+    m_CompactFibers->ComputeFiberGeometry(m_CompactFiberIds, m_FiberLengths, bounds);
+  }
+  else
+  {
+    vtkSmartPointer<vtkCleanPolyData> cleaner = vtkSmartPointer<vtkCleanPolyData>::New();
+    cleaner->SetInputData(m_FiberPolyData);
+    cleaner->PointMergingOff();
+    cleaner->Update();
+    m_FiberPolyData = cleaner->GetOutput();
+    m_NumFibers = static_cast<unsigned int>(m_FiberPolyData->GetNumberOfCells());
+
+    if (m_FiberColors==nullptr || m_FiberColors->GetNumberOfTuples()!=m_FiberPolyData->GetNumberOfPoints())
+      this->ColorFibersByOrientation();
+  }
 
   if (m_FiberWeights->GetNumberOfValues()!=m_NumFibers)
   {
@@ -1484,27 +1634,33 @@ void mitk::FiberBundle::UpdateFiberGeometry()
     SetGeometry(geometry);
     return;
   }
-  double b[6];
-  m_FiberPolyData->GetBounds(b);
-
-  // calculate statistics
-  for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
+  if (m_FiberPolyData != nullptr)
   {
-    vtkCell* cell = m_FiberPolyData->GetCell(i);
-    auto p = cell->GetNumberOfPoints();
-    vtkPoints* points = cell->GetPoints();
-    float length = 0;
-    for (int j=0; j<p-1; j++)
+    m_FiberPolyData->GetBounds(bounds);
+    for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
     {
-      double p1[3];
-      points->GetPoint(j, p1);
-      double p2[3];
-      points->GetPoint(j+1, p2);
+      vtkCell* cell = m_FiberPolyData->GetCell(i);
+      auto p = cell->GetNumberOfPoints();
+      vtkPoints* points = cell->GetPoints();
+      float length = 0;
+      for (int j=0; j<p-1; j++)
+      {
+        double p1[3];
+        points->GetPoint(j, p1);
+        double p2[3];
+        points->GetPoint(j+1, p2);
 
-      double dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
-      length += dist;
+        double dist = std::sqrt((p1[0]-p2[0])*(p1[0]-p2[0])+(p1[1]-p2[1])*(p1[1]-p2[1])+(p1[2]-p2[2])*(p1[2]-p2[2]));
+        length += dist;
+      }
+      m_FiberLengths.push_back(length);
     }
-    m_FiberLengths.push_back(length);
+  }
+
+  // calculate statistics
+  for (unsigned int i=0; i<m_NumFibers; i++)
+  {
+    float length = m_FiberLengths.at(i);
     m_MeanFiberLength += length;
     if (i==0)
     {
@@ -1533,7 +1689,7 @@ void mitk::FiberBundle::UpdateFiberGeometry()
   m_MedianFiberLength = sortedLengths.at(m_NumFibers/2);
 
   mitk::Geometry3D::Pointer geometry = mitk::Geometry3D::New();
-  geometry->SetFloatBounds(b);
+  geometry->SetFloatBounds(bounds);
   this->SetGeometry(geometry);
 
   m_UpdateTime3D.Modified();
@@ -1572,6 +1728,7 @@ void mitk::FiberBundle::SetFiberWeight(unsigned int fiber, float weight)
 
 void mitk::FiberBundle::SetFiberColors(vtkSmartPointer<vtkUnsignedCharArray> fiberColors)
 {
+  this->InitializeFiberPolyData();
   for(long i=0; i<m_FiberPolyData->GetNumberOfPoints(); ++i)
   {
     unsigned char source[4] = {0,0,0,0};
@@ -1662,6 +1819,7 @@ itk::Point<float, 3> mitk::FiberBundle::TransformPoint(vnl_vector_fixed< double,
 
 void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::ScalarType >::Pointer transform)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
@@ -1690,6 +1848,7 @@ void mitk::FiberBundle::TransformFibers(itk::ScalableAffineTransform< mitk::Scal
 
 void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double tx, double ty, double tz)
 {
+  this->InitializeFiberPolyData();
   rx = rx*itk::Math::pi/180;
   ry = ry*itk::Math::pi/180;
   rz = rz*itk::Math::pi/180;
@@ -1752,6 +1911,7 @@ void mitk::FiberBundle::TransformFibers(double rx, double ry, double rz, double
 
 void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
 {
+  this->InitializeFiberPolyData();
   x = x*itk::Math::pi/180;
   y = y*itk::Math::pi/180;
   z = z*itk::Math::pi/180;
@@ -1812,6 +1972,7 @@ void mitk::FiberBundle::RotateAroundAxis(double x, double y, double z)
 
 void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractCenter)
 {
+  this->InitializeFiberPolyData();
   MITK_INFO << "Scaling fibers";
   boost::progress_display disp(m_NumFibers);
 
@@ -1857,6 +2018,7 @@ void mitk::FiberBundle::ScaleFibers(double x, double y, double z, bool subtractC
 
 void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
@@ -1887,6 +2049,7 @@ void mitk::FiberBundle::TranslateFibers(double x, double y, double z)
 
 void mitk::FiberBundle::MirrorFibers(unsigned int axis)
 {
+  this->InitializeFiberPolyData();
   if (axis>2)
     return;
 
@@ -1922,6 +2085,7 @@ void mitk::FiberBundle::MirrorFibers(unsigned int axis)
 
 void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double threshold)
 {
+  this->InitializeFiberPolyData();
   dir.normalize();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
@@ -1985,6 +2149,7 @@ void mitk::FiberBundle::RemoveDir(vnl_vector_fixed<double,3> dir, double thresho
 
 bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibers)
 {
+  this->InitializeFiberPolyData();
   if (minRadius<0)
     return true;
 
@@ -2065,6 +2230,7 @@ bool mitk::FiberBundle::ApplyCurvatureThreshold(float minRadius, bool deleteFibe
 
 bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
 {
+  this->InitializeFiberPolyData();
   MITK_INFO << "Removing short fibers";
   if (lengthInMM<=0 || lengthInMM<m_MinFiberLength)
   {
@@ -2117,6 +2283,7 @@ bool mitk::FiberBundle::RemoveShortFibers(float lengthInMM)
 
 bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
 {
+  this->InitializeFiberPolyData();
   if (lengthInMM<=0 || lengthInMM>m_MaxFiberLength)
     return true;
 
@@ -2160,6 +2327,7 @@ bool mitk::FiberBundle::RemoveLongFibers(float lengthInMM)
 
 void mitk::FiberBundle::ResampleSpline(float pointDistance, double tension, double continuity, double bias )
 {
+  this->InitializeFiberPolyData();
   if (pointDistance<=0)
     return;
 
@@ -2251,6 +2419,12 @@ void mitk::FiberBundle::ResampleSpline(float pointDistance)
 unsigned int mitk::FiberBundle::GetNumberOfPoints() const
 {
   unsigned int points = 0;
+  if (m_FiberPolyData==nullptr)
+  {
+    for (unsigned int id : m_CompactFiberIds)
+      points += m_CompactFibers->GetNumPoints(id);
+    return points;
+  }
   for (int i=0; i<m_FiberPolyData->GetNumberOfCells(); i++)
   {
     vtkCell* cell = m_FiberPolyData->GetCell(i);
@@ -2261,6 +2435,7 @@ unsigned int mitk::FiberBundle::GetNumberOfPoints() const
 
 void mitk::FiberBundle::Compress(float error)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
@@ -2394,6 +2569,7 @@ void mitk::FiberBundle::Compress(float error)
 
 void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 {
+  this->InitializeFiberPolyData();
   if (targetPoints<2)
     mitkThrow() << "Minimum two points required for resampling!";
 
@@ -2520,6 +2696,7 @@ void mitk::FiberBundle::ResampleToNumPoints(unsigned int targetPoints)
 
 void mitk::FiberBundle::ResampleLinear(double pointDistance)
 {
+  this->InitializeFiberPolyData();
   vtkSmartPointer<vtkPoints> vtkNewPoints = vtkSmartPointer<vtkPoints>::New();
   vtkSmartPointer<vtkCellArray> vtkNewCells = vtkSmartPointer<vtkCellArray>::New();
 
@@ -2639,6 +2816,7 @@ void mitk::FiberBundle::ResampleLinear(double pointDistance)
 // reapply selected colorcoding in case PolyData structure has changed
 bool mitk::FiberBundle::Equals(mitk::FiberBundle* fib, double eps)
 {
+  this->InitializeFiberPolyData();
   if (fib==nullptr)
   {
     MITK_INFO << "Reference bundle is nullptr!";
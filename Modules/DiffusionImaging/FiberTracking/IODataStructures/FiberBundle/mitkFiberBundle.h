@@ -27,6 +27,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkPixelTypeTraits.h>
 #include <mitkPlanarFigureComposite.h>
 #include <mitkPeakImage.h>
+#include <mitkFiberSegmentIndex.h>
+#include <mitkCompactFiberContainer.h>
 
 //includes storing fiberdata
 #include <vtkSmartPointer.h>
@@ -36,6 +38,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <vtkTransform.h>
 #include <vtkFloatArray.h>
 #include <itkScalableAffineTransform.h>
+#include <memory>
+#include <map>
 
 namespace mitk {
 
@@ -73,7 +77,7 @@ public:
     void ResetFiberOpacity();
     void SetFiberColors(vtkSmartPointer<vtkUnsignedCharArray> fiberColors);
     void SetFiberColors(float r, float g, float b, float alpha=255);
-    vtkSmartPointer<vtkUnsignedCharArray> GetFiberColors() const { return m_FiberColors; }
+    vtkSmartPointer<vtkUnsignedCharArray> GetFiberColors() const;
 
     // fiber compression
     void Compress(float error = 0.0);
@@ -121,6 +125,16 @@ public:
     void SetFiberWeights(vtkSmartPointer<vtkFloatArray> weights);
     void SetFiberPolyData(vtkSmartPointer<vtkPolyData>, bool updateGeometry = true);
     vtkSmartPointer<vtkPolyData> GetFiberPolyData() const;
+
+    /**
+     * Use the specified fibers of a compact container as storage. The bundle is a view on the container: its vtkPolyData
+     * and colors are only created when they are accessed, e.g. for rendering. Subsets extracted from a view are views
+     * on the same container. Operations that change the fiber points detach the bundle from the container.
+     */
+    void SetCompactFibers(const CompactFiberContainer* fibers, const std::vector<unsigned int>& fiberIds);
+    const CompactFiberContainer* GetCompactFibers() const { return m_CompactFibers; }
+    const std::vector<unsigned int>& GetCompactFiberIds() const { return m_CompactFiberIds; }
+    bool IsFiberPolyDataInitialized() const { return m_FiberPolyData!=nullptr; }
     itkGetConstMacro( NumFibers, unsigned int)
     //itkGetMacro( FiberSampling, int)
     itkGetConstMacro( MinFiberLength, float )
@@ -147,6 +161,9 @@ public:
 
     vtkSmartPointer<vtkPolyData>    GeneratePolyDataByIds(std::vector<unsigned int> fiberIds, vtkSmartPointer<vtkFloatArray> weights);
 
+    /** Spatial index over the fiber segments used for ROI based extraction. Built on first use after each geometry change. */
+    const FiberSegmentIndex*        GetSegmentIndex();
+
 protected:
 
     FiberBundle( vtkPolyData* fiberPolyData = nullptr );
@@ -154,13 +171,19 @@ protected:
 
     void                            GenerateFiberIds();
     void                            UpdateFiberGeometry();
+    void                            InitializeFiberPolyData();
+    FiberBundle::Pointer            CreateCompactSubset(const std::vector<unsigned int>& fiberIds);
     void                    PrintSelf(std::ostream &os, itk::Indent indent) const override;
 
 private:
 
-    // actual fiber container
+    // actual fiber container, nullptr for views on compact fibers until it is accessed
     vtkSmartPointer<vtkPolyData>  m_FiberPolyData;
 
+    // compact storage of views, m_CompactFiberIds[i] is the container id of fiber i
+    CompactFiberContainer::ConstPointer m_CompactFibers;
+    std::vector<unsigned int>     m_CompactFiberIds;
+
     // contains fiber ids
     vtkSmartPointer<vtkDataSet>   m_FiberIdDataSet;
 
@@ -177,6 +200,20 @@ private:
     itk::TimeStamp m_UpdateTime2D;
     itk::TimeStamp m_UpdateTime3D;
     mitk::BaseGeometry::Pointer m_ReferenceGeometry;
+
+    /** Extraction result of a single planar figure. The entry holds a reference to the figure, so its address can not be reused by another figure while it is cached. */
+    struct RoiCacheEntry
+    {
+      PlanarFigure::ConstPointer    figure;
+      std::vector< double >         fingerprint;  ///< figure type, control points and plane normal
+      std::vector< unsigned int >   fiberIds;
+      unsigned long                 lastUse;
+    };
+    static const unsigned int MaxRoiCacheSize = 64;
+
+    std::shared_ptr< FiberSegmentIndex > m_SegmentIndex;
+    std::map< const PlanarFigure*, RoiCacheEntry > m_RoiCache;  ///< least recently used entries are removed beyond MaxRoiCacheSize
+    unsigned long m_RoiCacheCounter;
 };
 
 } // namespace mitk
@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkFiberSegmentIndex.h"
+#include <cmath>
+#include <limits>
+
+mitk::FiberSegmentIndex::FiberSegmentIndex(vtkPolyData* fibers)
+  : m_Connectivity(nullptr)
+  , m_GeometryMTime(GetGeometryMTime(fibers))
+  , m_NumFibers(0)
+{
+  for (int k=0; k<3; ++k)
+  {
+    m_Origin[k] = 0;
+    m_CellSize[k] = 1;
+    m_Dims[k] = 1;
+  }
+
+  m_Points = fibers->GetPoints();
+  m_Lines = fibers->GetLines();
+  if (m_Points==nullptr || m_Lines==nullptr || m_Lines->GetNumberOfCells()==0)
+    return;
+
+  m_NumFibers = static_cast<unsigned int>(m_Lines->GetNumberOfCells());
+  m_Connectivity = m_Lines->GetPointer();
+
+  // split fibers into chunks of consecutive segments and compute their bounding boxes
+  vtkIdType pos = 0;
+  for (unsigned int i=0; i<m_NumFibers; ++i)
+  {
+    vtkIdType numPoints = m_Connectivity[pos];
+    for (vtkIdType j=0; j+1<numPoints; j+=CHUNK_SEGMENTS)
+    {
+      Chunk chunk;
+      chunk.fiber = i;
+      chunk.start = pos+1+j;
+      chunk.numSegments = static_cast<unsigned int>(std::min(static_cast<vtkIdType>(CHUNK_SEGMENTS), numPoints-1-j));
+      for (int k=0; k<3; ++k)
+      {
+        chunk.bounds[2*k] = std::numeric_limits<float>::max();
+        chunk.bounds[2*k+1] = std::numeric_limits<float>::lowest();
+      }
+      for (unsigned int s=0; s<=chunk.numSegments; ++s)
+      {
+        double p[3];
+        m_Points->GetPoint(m_Connectivity[chunk.start+s], p);
+        for (int k=0; k<3; ++k)
+        {
+          chunk.bounds[2*k] = std::min(chunk.bounds[2*k], static_cast<float>(p[k]));
+          chunk.bounds[2*k+1] = std::max(chunk.bounds[2*k+1], static_cast<float>(p[k]));
+        }
+      }
+      m_Chunks.push_back(chunk);
+    }
+    pos += numPoints+1;
+  }
+  if (m_Chunks.empty())
+    return;
+
+  // grid resolution: roughly four chunks per cell, at most 256 cells per axis
+  double b[6];
+  m_Points->GetBounds(b);
+  double extent[3];
+  double volume = 1;
+  for (int k=0; k<3; ++k)
+  {
+    extent[k] = std::max(b[2*k+1]-b[2*k], 1.0);
+    volume *= extent[k];
+  }
+  double targetCells = std::max(1.0, static_cast<double>(m_Chunks.size())/4.0);
+  double cellSize = std::cbrt(volume/targetCells);
+  for (int k=0; k<3; ++k)
+  {
+    m_Dims[k] = std::max(1, std::min(256, static_cast<int>(std::ceil(extent[k]/cellSize))));
+    m_CellSize[k] = extent[k]/m_Dims[k];
+    m_Origin[k] = b[2*k];
+  }
+
+  // two pass CSR construction: count entries per cell, then fill
+  std::size_t numCells = static_cast<std::size_t>(m_Dims[0])*m_Dims[1]*m_Dims[2];
+  m_CellStart.assign(numCells+1, 0);
+  for (int pass=0; pass<2; ++pass)
+  {
+    std::vector< std::uint64_t > fill;
+    if (pass==1)
+    {
+      for (std::size_t c=0; c<numCells; ++c)
+        m_CellStart[c+1] += m_CellStart[c];
+      m_CellEntries.resize(static_cast<std::size_t>(m_CellStart[numCells]));
+      fill.assign(m_CellStart.begin(), m_CellStart.end()-1);
+    }
+
+    for (std::size_t c=0; c<m_Chunks.size(); ++c)
+    {
+      const Chunk& chunk = m_Chunks[c];
+      int cmin[3];
+      int cmax[3];
+      for (int k=0; k<3; ++k)
+      {
+        cmin[k] = GetCell(chunk.bounds[2*k], k);
+        cmax[k] = GetCell(chunk.bounds[2*k+1], k);
+      }
+      for (int z=cmin[2]; z<=cmax[2]; ++z)
+        for (int y=cmin[1]; y<=cmax[1]; ++y)
+          for (int x=cmin[0]; x<=cmax[0]; ++x)
+          {
+            std::size_t cell = static_cast<std::size_t>(x + m_Dims[0]*(y + m_Dims[1]*z));
+            if (pass==0)
+              ++m_CellStart[cell+1];
+            else
+              m_CellEntries[static_cast<std::size_t>(fill[cell]++)] = static_cast<unsigned int>(c);
+          }
+    }
+  }
+}
+
+mitk::FiberSegmentIndex::~FiberSegmentIndex()
+{
+}
+
+vtkMTimeType mitk::FiberSegmentIndex::GetGeometryMTime(vtkPolyData* fibers)
+{
+  vtkMTimeType mtime = 0;
+  if (fibers->GetPoints()!=nullptr)
+    mtime = std::max(mtime, fibers->GetPoints()->GetMTime());
+  if (fibers->GetLines()!=nullptr)
+    mtime = std::max(mtime, fibers->GetLines()->GetMTime());
+  return mtime;
+}
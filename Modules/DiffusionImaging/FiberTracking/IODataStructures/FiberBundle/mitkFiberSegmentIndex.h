@@ -0,0 +1,152 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef _MITK_FiberSegmentIndex_H
+#define _MITK_FiberSegmentIndex_H
+
+#include <MitkFiberTrackingExports.h>
+#include <vtkSmartPointer.h>
+#include <vtkPolyData.h>
+#include <vtkCellArray.h>
+#include <vtkPoints.h>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+namespace mitk {
+
+/**
+* \brief Uniform grid over the segments of a tractogram for fast spatial ROI queries.
+*
+* Consecutive segments of each fiber are grouped into chunks of at most CHUNK_SEGMENTS segments. The bounding box
+* of each chunk is registered in all grid cells it overlaps; cell contents are stored in a compressed (CSR) layout.
+* A query with a bounding box only visits the chunks registered in the overlapping cells and calls the exact
+* segment test for these candidates, so the cost of a query depends on the ROI size instead of the tractogram size.
+*
+* The index is built once per fiber geometry (see mitk::FiberBundle::GetSegmentIndex) and is immutable afterwards.
+*/
+class MITKFIBERTRACKING_EXPORT FiberSegmentIndex
+{
+public:
+
+  static const unsigned int CHUNK_SEGMENTS = 8;
+
+  FiberSegmentIndex(vtkPolyData* fibers);
+  ~FiberSegmentIndex();
+
+  unsigned int GetNumFibers() const { return m_NumFibers; }
+  vtkMTimeType GetGeometryMTime() const { return m_GeometryMTime; }
+
+  /** Modification time of the points and lines of the polydata (point and cell data such as colors are ignored). */
+  static vtkMTimeType GetGeometryMTime(vtkPolyData* fibers);
+
+  /**
+  * \brief Returns the sorted ids of all fibers with at least one segment for which test(p1, p2) returns true.
+  *
+  * Only segments of chunks overlapping the query bounds (xmin, xmax, ymin, ymax, zmin, zmax) are tested.
+  */
+  template< class SegmentTest >
+  std::vector< unsigned int > Query(const double bounds[6], SegmentTest test) const
+  {
+    std::vector< unsigned int > result;
+    if (m_Chunks.empty())
+      return result;
+
+    int cmin[3];
+    int cmax[3];
+    for (int k=0; k<3; ++k)
+    {
+      cmin[k] = GetCell(bounds[2*k], k);
+      cmax[k] = GetCell(bounds[2*k+1], k);
+      if (bounds[2*k+1] < m_Origin[k] || bounds[2*k] > m_Origin[k] + m_Dims[k]*m_CellSize[k])
+        return result;
+    }
+
+    std::vector< bool > accepted(m_NumFibers, false);
+    for (int z=cmin[2]; z<=cmax[2]; ++z)
+      for (int y=cmin[1]; y<=cmax[1]; ++y)
+        for (int x=cmin[0]; x<=cmax[0]; ++x)
+        {
+          std::size_t cell = static_cast<std::size_t>(x + m_Dims[0]*(y + m_Dims[1]*z));
+          for (std::uint64_t e=m_CellStart[cell]; e<m_CellStart[cell+1]; ++e)
+          {
+            const Chunk& chunk = m_Chunks[m_CellEntries[e]];
+            if (accepted[chunk.fiber] || !Overlaps(chunk, bounds))
+              continue;
+
+            double p1[3];
+            double p2[3];
+            m_Points->GetPoint(m_Connectivity[chunk.start], p1);
+            for (unsigned int s=1; s<=chunk.numSegments; ++s)
+            {
+              m_Points->GetPoint(m_Connectivity[chunk.start+s], p2);
+              if (test(p1, p2))
+              {
+                accepted[chunk.fiber] = true;
+                result.push_back(chunk.fiber);
+                break;
+              }
+              std::copy(p2, p2+3, p1);
+            }
+          }
+        }
+
+    std::sort(result.begin(), result.end());
+    return result;
+  }
+
+protected:
+
+  struct Chunk
+  {
+    unsigned int  fiber;
+    unsigned int  numSegments;
+    vtkIdType     start;      ///< position of the first point id in m_Connectivity
+    float         bounds[6];
+  };
+
+  int GetCell(double x, int axis) const
+  {
+    int c = static_cast<int>((x - m_Origin[axis]) / m_CellSize[axis]);
+    return std::max(0, std::min(m_Dims[axis]-1, c));
+  }
+
+  static bool Overlaps(const Chunk& chunk, const double bounds[6])
+  {
+    for (int k=0; k<3; ++k)
+      if (chunk.bounds[2*k+1] < bounds[2*k] || chunk.bounds[2*k] > bounds[2*k+1])
+        return false;
+    return true;
+  }
+
+  vtkSmartPointer< vtkPoints >    m_Points;
+  vtkSmartPointer< vtkCellArray > m_Lines;
+  const vtkIdType*                m_Connectivity;
+  vtkMTimeType                    m_GeometryMTime;
+  unsigned int                    m_NumFibers;
+
+  double                          m_Origin[3];
+  double                          m_CellSize[3];
+  int                             m_Dims[3];
+
+  std::vector< Chunk >            m_Chunks;
+  std::vector< std::uint64_t >    m_CellStart;    ///< size number of cells + 1
+  std::vector< unsigned int >     m_CellEntries;  ///< chunk indices, grouped by cell
+};
+
+}
+
+#endif
@@ -87,48 +87,53 @@ short TrackVisFiberReader::open( std::string filename )
 
 
 
-// Append a fiber to the file
-// --------------------------
+// Append the fibers of a bundle to the file
+// ------------------------------------------
 short TrackVisFiberReader::append(const mitk::FiberBundle *fib)
 {
   vtkPolyData* poly = fib->GetFiberPolyData();
+  std::vector< float > tmp;
   for (unsigned int i=0; i<fib->GetNumFibers(); i++)
   {
     vtkCell* cell = poly->GetCell(i);
     int numPoints = cell->GetNumberOfPoints();
     vtkPoints* points = cell->GetPoints();
 
-    unsigned int     numSaved, pos = 0;
-    //float* tmp = new float[3*maxSteps];
-    std::vector< float > tmp;
-    tmp.reserve(3*numPoints);
-
-    numSaved = numPoints;
-    for(unsigned int i=0; i<numSaved ;i++)
+    tmp.resize(3*static_cast<std::size_t>(numPoints));
+    for(int j=0; j<numPoints ;j++)
     {
-      double* p = points->GetPoint(i);
-
-      tmp[pos++] = p[0];
-      tmp[pos++] = p[1];
-      tmp[pos++] = p[2];
+      double* p = points->GetPoint(j);
+      tmp[3*j] = static_cast<float>(p[0]);
+      tmp[3*j+1] = static_cast<float>(p[1]);
+      tmp[3*j+2] = static_cast<float>(p[2]);
     }
 
-    // write the coordinates to the file
-    if ( fwrite((char*)&numSaved, 1, 4, m_FilePointer) != 4 )
-    {
-      printf( "[ERROR] Problems saving the fiber!\n" );
-      return 1;
-    }
-    if ( fwrite((char*)&(tmp.front()), 1, 4*pos, m_FilePointer) != 4*pos )
-    {
-      printf( "[ERROR] Problems saving the fiber!\n" );
+    if (appendFiber(tmp.data(), numPoints) != 0)
       return 1;
-    }
   }
 
   return 0;
 }
 
+
+// Append a single fiber (numPoints consecutive xyz triplets) to the file
+// ----------------------------------------------------------------------
+short TrackVisFiberReader::appendFiber(const float* points, int numPoints)
+{
+  if ( fwrite((char*)&numPoints, 1, 4, m_FilePointer) != 4 )
+  {
+    printf( "[ERROR] Problems saving the fiber!\n" );
+    return 1;
+  }
+  std::size_t numBytes = 12*static_cast<std::size_t>(numPoints);
+  if ( fwrite((const char*)points, 1, numBytes, m_FilePointer) != numBytes )
+  {
+    printf( "[ERROR] Problems saving the fiber!\n" );
+    return 1;
+  }
+  return 0;
+}
+
 //// Read one fiber from the file
 //// ----------------------------
 short TrackVisFiberReader::read( mitk::FiberBundle* fib )
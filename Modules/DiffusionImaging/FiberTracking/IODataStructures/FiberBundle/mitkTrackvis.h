@@ -68,6 +68,7 @@ public:
     short   open(std::string m_Filename );
     short   read( mitk::FiberBundle* fib );
     short   append(const mitk::FiberBundle* fib );
+    short   appendFiber(const float* points, int numPoints );
     void    writeHdr();
     void    updateTotal( int totFibers );
     void    close();
@@ -11,6 +11,7 @@ SET(MODULE_CUSTOM_TESTS
   mitkFiberFitTest.cpp
   mitkFiberMapper3DTest.cpp
   mitkPeakShImageReaderTest.cpp
+  mitkCompactFiberContainerTest.cpp
 )
 
 
@@ -0,0 +1,159 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkFiberBundle.h>
+#include <mitkCompactFiberContainer.h>
+#include <mitkTestingConfig.h>
+#include <mitkIOUtil.h>
+#include <fstream>
+
+#include "mitkTestFixture.h"
+
+class mitkCompactFiberContainerTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkCompactFiberContainerTestSuite);
+  MITK_TEST(Equal_Float32SaveLoad_ReturnsTrue);
+  MITK_TEST(Equal_ReducedPrecision_ReturnsTrue);
+  MITK_TEST(Equal_Subset_ReturnsTrue);
+  MITK_TEST(Equal_ReaderWriter_ReturnsTrue);
+  MITK_TEST(Load_CorruptFile_Throws);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  /** Members used inside the different (sub-)tests. All members are initialized via setUp().*/
+  mitk::FiberBundle::Pointer original;
+
+public:
+
+  void setUp() override
+  {
+    original = mitk::IOUtil::Load<mitk::FiberBundle>(GetTestDataFilePath("DiffusionImaging/FiberProcessing/original.fib"));
+  }
+
+  void tearDown() override
+  {
+    original = nullptr;
+  }
+
+  void Equal_Float32SaveLoad_ReturnsTrue()
+  {
+    mitk::CompactFiberContainer::Pointer container = mitk::CompactFiberContainer::New();
+    container->Initialize(original);
+    CPPUNIT_ASSERT_MESSAGE("Number of fibers", container->GetNumFibers()==original->GetNumFibers());
+    CPPUNIT_ASSERT_MESSAGE("Number of points", container->GetNumPoints()==original->GetNumberOfPoints());
+
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/compactFiberTest.cfb";
+    container->Save(filename);
+    mitk::CompactFiberContainer::Pointer loaded = mitk::CompactFiberContainer::Load(filename);
+    CPPUNIT_ASSERT_MESSAGE("Memory mapped", loaded->IsMemoryMapped());
+
+    mitk::FiberBundle::Pointer fib = loaded->CreateFiberBundle();
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->Equals(fib));
+    for (unsigned int i=0; i<original->GetNumFibers(); ++i)
+      CPPUNIT_ASSERT_MESSAGE("Fiber weights", original->GetFiberWeight(i)==fib->GetFiberWeight(i));
+  }
+
+  void Equal_ReducedPrecision_ReturnsTrue()
+  {
+    mitk::CompactFiberContainer::Pointer half = mitk::CompactFiberContainer::New();
+    half->Initialize(original, mitk::CompactFiberContainer::FLOAT16);
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->Equals(half->CreateFiberBundle(), 0.1));
+
+    mitk::CompactFiberContainer::Pointer quantized = mitk::CompactFiberContainer::New();
+    quantized->Initialize(original, mitk::CompactFiberContainer::QUANTIZED16);
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->Equals(quantized->CreateFiberBundle(), 0.01));
+
+    mitk::CompactFiberContainer::Pointer full = mitk::CompactFiberContainer::New();
+    full->Initialize(original);
+    CPPUNIT_ASSERT_MESSAGE("Memory size", quantized->GetMemorySize() < full->GetMemorySize());
+  }
+
+  void Equal_Subset_ReturnsTrue()
+  {
+    mitk::CompactFiberContainer::Pointer container = mitk::CompactFiberContainer::New();
+    container->Initialize(original);
+
+    mitk::FiberBundle::Pointer view = container->CreateFiberBundle();
+    CPPUNIT_ASSERT_MESSAGE("View without polydata", !view->IsFiberPolyDataInitialized());
+    CPPUNIT_ASSERT_MESSAGE("Number of fibers", view->GetNumFibers()==original->GetNumFibers());
+    CPPUNIT_ASSERT_MESSAGE("Number of points", view->GetNumberOfPoints()==original->GetNumberOfPoints());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(original->GetMeanFiberLength(), view->GetMeanFiberLength(), 0.01);
+
+    // subsets of views are views on the same container, with the same fibers as the subsets of the polydata
+    mitk::FiberBundle::Pointer subset = view->SubsampleFibers(0.5, false);
+    CPPUNIT_ASSERT_MESSAGE("Subset is a view on the same container", subset->GetCompactFibers()==container.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Subset without polydata", !subset->IsFiberPolyDataInitialized());
+    CPPUNIT_ASSERT_MESSAGE("Parent without polydata", !view->IsFiberPolyDataInitialized());
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->SubsampleFibers(0.5, false)->Equals(subset));
+    CPPUNIT_ASSERT_MESSAGE("Subset with polydata", subset->IsFiberPolyDataInitialized());
+
+    view->SetFiberWeights(1);
+    view->SetFiberWeight(0, 0.25);
+    mitk::FiberBundle::Pointer filtered = view->FilterByWeights(0.5);
+    CPPUNIT_ASSERT_MESSAGE("Filtered is a view on the same container", filtered->GetCompactFibers()==container.GetPointer());
+    CPPUNIT_ASSERT_MESSAGE("Filtered fibers", filtered->GetNumFibers()==original->GetNumFibers()-1);
+    CPPUNIT_ASSERT_MESSAGE("Filtered ids", filtered->GetCompactFiberIds().front()==1);
+
+    // changing the points detaches the bundle from the container
+    mitk::FiberBundle::Pointer copy = view->GetDeepCopy();
+    copy->TranslateFibers(1, 0, 0);
+    CPPUNIT_ASSERT_MESSAGE("Detached from container", copy->GetCompactFibers()==nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Translated", !copy->Equals(original));
+    CPPUNIT_ASSERT_MESSAGE("View unchanged", view->Equals(original));
+  }
+
+  void Equal_ReaderWriter_ReturnsTrue()
+  {
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/compactFiberReaderWriterTest.cfb";
+    mitk::IOUtil::Save(original.GetPointer(), filename);
+
+    mitk::FiberBundle::Pointer loaded = mitk::IOUtil::Load<mitk::FiberBundle>(filename);
+    CPPUNIT_ASSERT_MESSAGE("View on the mapped file", loaded->GetCompactFibers()!=nullptr && loaded->GetCompactFibers()->IsMemoryMapped());
+    CPPUNIT_ASSERT_MESSAGE("Loaded without polydata", !loaded->IsFiberPolyDataInitialized());
+    CPPUNIT_ASSERT_MESSAGE("Number of fibers", loaded->GetNumFibers()==original->GetNumFibers());
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->Equals(loaded));
+
+    // a view is written without creating its polydata
+    mitk::FiberBundle::Pointer view = mitk::IOUtil::Load<mitk::FiberBundle>(filename)->SubsampleFibers(0.3, false);
+    std::string subsetFilename = std::string(MITK_TEST_OUTPUT_DIR)+"/compactFiberReaderWriterTestSubset.cfb";
+    mitk::IOUtil::Save(view.GetPointer(), subsetFilename);
+    CPPUNIT_ASSERT_MESSAGE("Written without polydata", !view->IsFiberPolyDataInitialized());
+    CPPUNIT_ASSERT_MESSAGE("Should be equal", original->SubsampleFibers(0.3, false)->Equals(mitk::IOUtil::Load<mitk::FiberBundle>(subsetFilename)));
+  }
+
+  void Load_CorruptFile_Throws()
+  {
+    mitk::CompactFiberContainer::Pointer container = mitk::CompactFiberContainer::New();
+    container->Initialize(original);
+    std::string filename = std::string(MITK_TEST_OUTPUT_DIR)+"/compactFiberCorruptTest.cfb";
+    container->Save(filename);
+
+    std::ifstream in(filename.c_str(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+
+    std::ofstream truncated(filename.c_str(), std::ios::binary);
+    truncated.write(content.data(), static_cast<std::streamsize>(content.size()/2));
+    truncated.close();
+    CPPUNIT_ASSERT_THROW(mitk::CompactFiberContainer::Load(filename), mitk::Exception);
+  }
+
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkCompactFiberContainer)
@@ -83,6 +83,10 @@ int mitkFiberExtractionTest(int argc, char* argv[])
     MITK_INFO << "TEST2";
     MITK_TEST_CONDITION_REQUIRED(extractedFibs->Equals(testFibs),"check planar figure extraction");
 
+    // second extraction is answered from the segment index and the cached ROI results
+    extractedFibs = groundTruthFibs->ExtractFiberSubset(pfcNode2, storage);
+    MITK_TEST_CONDITION_REQUIRED(extractedFibs->Equals(testFibs),"check repeated planar figure extraction");
+
     MITK_INFO << "TEST3";
     // test subtraction and addition
     mitk::FiberBundle::Pointer notExtractedFibs = groundTruthFibs->SubtractBundle(extractedFibs);
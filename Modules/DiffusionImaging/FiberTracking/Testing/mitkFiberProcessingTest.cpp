@@ -21,6 +21,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkTestingConfig.h>
 #include <mitkIOUtil.h>
 #include <itkFiberCurvatureFilter.h>
+#include <itkTractDensityImageFilter.h>
+#include <mitkDiffusionFunctionCollection.h>
+#include <vtkCell.h>
 #include <omp.h>
 #include "mitkTestFixture.h"
 
@@ -46,6 +49,7 @@ class mitkFiberProcessingTestSuite : public mitk::TestFixture
     MITK_TEST(Test16);
     MITK_TEST(Test17);
     MITK_TEST(Test18);
+    MITK_TEST(Test19);
     CPPUNIT_TEST_SUITE_END();
 
     typedef itk::Image<unsigned char, 3> ItkUcharImgType;
@@ -299,6 +303,65 @@ public:
         CPPUNIT_ASSERT_MESSAGE("Should be equal", ref->Equals(fib));
     }
 
+    void Test19()
+    {
+        MITK_INFO << "TEST 19: Tract density image";
+
+        typedef itk::Image<float, 3> ItkFloatImgType;
+        omp_set_num_threads(4);
+
+        itk::TractDensityImageFilter< ItkFloatImgType >::Pointer generator = itk::TractDensityImageFilter< ItkFloatImgType >::New();
+        generator->SetFiberBundle(original);
+        generator->SetUpsamplingFactor(2);
+        generator->SetOutputAbsoluteValues(true);
+        generator->Update();
+        ItkFloatImgType::Pointer tdi = generator->GetOutput();
+
+        // reference: serial voxel intersection of every fiber segment
+        ItkFloatImgType::Pointer ref = ItkFloatImgType::New();
+        ref->CopyInformation(tdi);
+        ref->SetRegions(tdi->GetLargestPossibleRegion());
+        ref->Allocate();
+        ref->FillBuffer(0.0);
+        vtkSmartPointer<vtkPolyData> polyData = original->GetFiberPolyData();
+        for (unsigned int i=0; i<original->GetNumFibers(); ++i)
+        {
+            vtkCell* cell = polyData->GetCell(i);
+            vtkPoints* points = cell->GetPoints();
+            for (int j=0; j<cell->GetNumberOfPoints()-1; ++j)
+            {
+                itk::Point<float, 3> startVertex = mitk::imv::GetItkPoint(points->GetPoint(j));
+                itk::Index<3> startIndex;
+                itk::ContinuousIndex<float, 3> startIndexCont;
+                ref->TransformPhysicalPointToIndex(startVertex, startIndex);
+                ref->TransformPhysicalPointToContinuousIndex(startVertex, startIndexCont);
+
+                itk::Point<float, 3> endVertex = mitk::imv::GetItkPoint(points->GetPoint(j + 1));
+                itk::Index<3> endIndex;
+                itk::ContinuousIndex<float, 3> endIndexCont;
+                ref->TransformPhysicalPointToIndex(endVertex, endIndex);
+                ref->TransformPhysicalPointToContinuousIndex(endVertex, endIndexCont);
+
+                std::vector< std::pair< itk::Index<3>, double > > segments = mitk::imv::IntersectImage(ref->GetSpacing(), startIndex, endIndex, startIndexCont, endIndexCont);
+                for (std::pair< itk::Index<3>, double > segment : segments)
+                    if (ref->GetLargestPossibleRegion().IsInside(segment.first))
+                        ref->SetPixel(segment.first, ref->GetPixel(segment.first) + segment.second * original->GetFiberWeight(i));
+            }
+        }
+
+        float* tdiBuffer = tdi->GetBufferPointer();
+        float* refBuffer = ref->GetBufferPointer();
+        unsigned int numCovered = 0;
+        for (unsigned long i=0; i<tdi->GetLargestPossibleRegion().GetNumberOfPixels(); ++i)
+        {
+            CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Tract density", refBuffer[i], tdiBuffer[i], 0.01);
+            if (tdiBuffer[i]>0)
+                ++numCovered;
+        }
+        CPPUNIT_ASSERT_MESSAGE("Number of covered voxels", numCovered==generator->GetNumCoveredVoxels());
+        omp_set_num_threads(1);
+    }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkFiberProcessing)
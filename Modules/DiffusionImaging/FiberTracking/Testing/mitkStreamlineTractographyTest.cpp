@@ -48,6 +48,8 @@ class mitkStreamlineTractographyTestSuite : public mitk::TestFixture
   MITK_TEST(Test_Odf4);
   MITK_TEST(Test_Odf5);
   MITK_TEST(Test_Odf6);
+  MITK_TEST(Test_ThreadIndependence);
+  MITK_TEST(Test_StreamingOutput);
   CPPUNIT_TEST_SUITE_END();
 
   typedef itk::VectorImage< short, 3>   ItkDwiType;
@@ -421,6 +423,48 @@ public:
     delete handler;
   }
 
+  mitk::FiberBundle::Pointer TrackProbabilistic(int num_threads, std::string streaming_file)
+  {
+    mitk::TrackingHandlerOdf* handler = new mitk::TrackingHandlerOdf();
+    handler->SetOdfImage(itk_odf_image);
+    handler->SetGfaThreshold(gfa_threshold);
+    handler->SetOdfThreshold(0);
+    handler->SetSharpenOdfs(true);
+    handler->SetMode(mitk::TrackingDataHandler::MODE::PROBABILISTIC);
+
+    omp_set_num_threads(num_threads);
+    SetupTracker(handler);
+    tracker->SetRandom(true);
+    tracker->SetRandomSeed(42);
+    tracker->SetSeedsPerVoxel(3);
+    tracker->SetStreamingOutputFile(streaming_file);
+    tracker->Update();
+    omp_set_num_threads(1);
+
+    mitk::FiberBundle::Pointer outFib = mitk::FiberBundle::New(tracker->GetFiberPolyData());
+    delete handler;
+    return outFib;
+  }
+
+  void Test_ThreadIndependence()
+  {
+    mitk::FiberBundle::Pointer fib1 = TrackProbabilistic(1, "");
+    mitk::FiberBundle::Pointer fib4 = TrackProbabilistic(4, "");
+    CPPUNIT_ASSERT_MESSAGE("Tractogram should not be empty", fib1->GetNumFibers()>0);
+    CPPUNIT_ASSERT_MESSAGE("Tractograms tracked with 1 and 4 threads should be equal", fib1->Equals(fib4));
+  }
+
+  void Test_StreamingOutput()
+  {
+    std::string filename = mitk::IOUtil::GetTempPath() + "Test_StreamingOutput.trk";
+    mitk::FiberBundle::Pointer fib = TrackProbabilistic(4, "");
+    mitk::FiberBundle::Pointer streamed = TrackProbabilistic(4, filename);
+    CPPUNIT_ASSERT_MESSAGE("In-memory output should be empty when streaming", streamed->GetNumFibers()==0);
+
+    mitk::FiberBundle::Pointer loaded = mitk::IOUtil::Load<mitk::FiberBundle>(filename);
+    CPPUNIT_ASSERT_MESSAGE("Streamed tractogram should equal the in-memory tractogram", fib->Equals(loaded));
+  }
+
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkStreamlineTractography)
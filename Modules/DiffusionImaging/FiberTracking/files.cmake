@@ -5,6 +5,8 @@ set(CPP_FILES
   ## IO datastructures
   IODataStructures/FiberBundle/mitkFiberBundle.cpp
   IODataStructures/FiberBundle/mitkTrackvis.cpp
+  IODataStructures/FiberBundle/mitkCompactFiberContainer.cpp
+  IODataStructures/FiberBundle/mitkFiberSegmentIndex.cpp
   IODataStructures/PlanarFigureComposite/mitkPlanarFigureComposite.cpp
   IODataStructures/mitkTractographyForest.cpp
   IODataStructures/mitkFiberfoxParameters.cpp
@@ -20,6 +22,7 @@ set(CPP_FILES
   Algorithms/GibbsTracking/mitkSphereInterpolator.cpp
 
   Algorithms/itkStreamlineTrackingFilter.cpp
+  Algorithms/mitkTractDensityEngine.cpp
   Algorithms/TrackingHandlers/mitkTrackingDataHandler.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerTensor.cpp
   Algorithms/TrackingHandlers/mitkTrackingHandlerPeaks.cpp
@@ -30,11 +33,14 @@ set(H_FILES
   # DataStructures -> FiberBundle
   IODataStructures/FiberBundle/mitkFiberBundle.h
   IODataStructures/FiberBundle/mitkTrackvis.h
+  IODataStructures/FiberBundle/mitkCompactFiberContainer.h
+  IODataStructures/FiberBundle/mitkFiberSegmentIndex.h
   IODataStructures/mitkFiberfoxParameters.h
   IODataStructures/mitkTractographyForest.h
 
   # Algorithms
   Algorithms/itkTractDensityImageFilter.h
+  Algorithms/mitkTractDensityEngine.h
   Algorithms/itkTractsToFiberEndingsImageFilter.h
   Algorithms/itkTractsToRgbaImageFilter.h
   Algorithms/itkTractsToVectorImageFilter.h
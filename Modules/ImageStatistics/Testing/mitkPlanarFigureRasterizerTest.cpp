@@ -0,0 +1,210 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include "mitkTestFixture.h"
+
+#include <mitkPlanarFigureRasterizer.h>
+
+#include <cmath>
+#include <set>
+
+class mitkPlanarFigureRasterizerTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkPlanarFigureRasterizerTestSuite);
+  MITK_TEST(TestSingleVoxel);
+  MITK_TEST(TestRunsMatchVoxelCenters);
+  MITK_TEST(TestHoleIsSubtracted);
+  MITK_TEST(TestCoverageSumsToArea);
+  MITK_TEST(TestPolyLine);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  static mitk::Point2D MakePoint(double x, double y)
+  {
+    mitk::Point2D point;
+    point[0] = x;
+    point[1] = y;
+    return point;
+  }
+
+  /** Even-odd point in polygon test */
+  static bool IsInside(const mitk::PlanarFigureRasterizer::PolygonType &polygon, double x, double y)
+  {
+    bool inside = false;
+    for (std::size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++)
+    {
+      if ((polygon[i][1] > y) != (polygon[j][1] > y) &&
+          x < (polygon[j][0] - polygon[i][0]) * (y - polygon[i][1]) / (polygon[j][1] - polygon[i][1]) + polygon[i][0])
+      {
+        inside = !inside;
+      }
+    }
+    return inside;
+  }
+
+  static double GetWeightedSum(const mitk::PlanarFigureRasterizer::RunListType &runs)
+  {
+    double sum = 0.0;
+    for (const auto &run : runs)
+    {
+      sum += run.Weight * (run.XEnd - run.XBegin);
+    }
+    return sum;
+  }
+
+public:
+  void TestSingleVoxel()
+  {
+    mitk::PlanarFigureRasterizer rasterizer;
+    rasterizer.SetSize(10, 10);
+    rasterizer.AddPolygon({MakePoint(2.5, 2.5), MakePoint(3.5, 2.5), MakePoint(3.5, 3.5), MakePoint(2.5, 3.5)});
+
+    mitk::PlanarFigureRasterizer::RunListType runs;
+    rasterizer.ComputeRuns(runs);
+    CPPUNIT_ASSERT_MESSAGE("Square around one voxel gives one run",
+                           runs.size() == 1 && runs[0].Y == 3 && runs[0].XBegin == 3 && runs[0].XEnd == 4);
+
+    rasterizer.ComputeCoverage(runs);
+    CPPUNIT_ASSERT_MESSAGE("Square around one voxel covers it completely",
+                           runs.size() == 1 && runs[0].XBegin == 3 && runs[0].Weight == 1.0);
+  }
+
+  void TestRunsMatchVoxelCenters()
+  {
+    // concave outline, no vertex on a voxel center row
+    mitk::PlanarFigureRasterizer::PolygonType polygon = {MakePoint(2.2, 1.3),
+                                                         MakePoint(17.6, 4.1),
+                                                         MakePoint(9.3, 8.7),
+                                                         MakePoint(16.4, 15.2),
+                                                         MakePoint(3.1, 17.9),
+                                                         MakePoint(6.7, 9.4)};
+
+    mitk::PlanarFigureRasterizer rasterizer;
+    rasterizer.SetSize(20, 20);
+    rasterizer.AddPolygon(polygon);
+
+    mitk::PlanarFigureRasterizer::RunListType runs;
+    rasterizer.ComputeRuns(runs);
+
+    std::set<std::pair<int, int>> voxels;
+    for (const auto &run : runs)
+    {
+      for (int x = run.XBegin; x < run.XEnd; ++x)
+      {
+        voxels.insert(std::make_pair(x, run.Y));
+      }
+    }
+    CPPUNIT_ASSERT_MESSAGE("Runs overlap", voxels.size() == mitk::PlanarFigureRasterizer::GetNumberOfVoxels(runs));
+
+    for (int y = 0; y < 20; ++y)
+    {
+      for (int x = 0; x < 20; ++x)
+      {
+        CPPUNIT_ASSERT_MESSAGE("Voxel selection differs from the voxel centers inside the outline",
+                               IsInside(polygon, x, y) == (voxels.count(std::make_pair(x, y)) == 1));
+      }
+    }
+  }
+
+  void TestHoleIsSubtracted()
+  {
+    mitk::PlanarFigureRasterizer rasterizer;
+    rasterizer.SetSize(10, 10);
+    rasterizer.AddPolygon({MakePoint(0.5, 0.5), MakePoint(6.5, 0.5), MakePoint(6.5, 6.5), MakePoint(0.5, 6.5)});
+    rasterizer.AddPolygon({MakePoint(2.5, 2.5), MakePoint(2.5, 4.5), MakePoint(4.5, 4.5), MakePoint(4.5, 2.5)});
+
+    mitk::PlanarFigureRasterizer::RunListType runs;
+    rasterizer.ComputeRuns(runs);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Hole of 2x2 voxels in a 6x6 square", 32ul,
+                                 mitk::PlanarFigureRasterizer::GetNumberOfVoxels(runs));
+
+    for (const auto &run : runs)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Run inside of the hole",
+                             run.Y < 3 || run.Y > 4 || run.XEnd <= 3 || run.XBegin >= 5);
+    }
+
+    rasterizer.ComputeCoverage(runs);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Covered area of the square with the hole", 32.0, GetWeightedSum(runs), 1e-9);
+  }
+
+  void TestCoverageSumsToArea()
+  {
+    // regular polygons with arbitrary center, clockwise and counter clockwise, with a hole
+    for (int orientation = -1; orientation <= 1; orientation += 2)
+    {
+      mitk::PlanarFigureRasterizer::PolygonType outline;
+      mitk::PlanarFigureRasterizer::PolygonType hole;
+      const int numberOfVertices = 11;
+      const double step = 2.0 * 3.14159265358979323846 / numberOfVertices;
+      for (int i = 0; i < numberOfVertices; ++i)
+      {
+        const double angle = orientation * step * i;
+        outline.push_back(MakePoint(15.3 + 9.7 * std::cos(angle), 14.8 + 9.7 * std::sin(angle)));
+        hole.push_back(MakePoint(15.3 + 2.1 * std::cos(angle), 14.8 + 2.1 * std::sin(angle)));
+      }
+
+      const double outlineArea = 0.5 * numberOfVertices * 9.7 * 9.7 * std::sin(step);
+      const double holeArea = 0.5 * numberOfVertices * 2.1 * 2.1 * std::sin(step);
+
+      mitk::PlanarFigureRasterizer rasterizer;
+      rasterizer.SetSize(32, 32);
+      rasterizer.AddPolygon(outline);
+
+      mitk::PlanarFigureRasterizer::RunListType runs;
+      rasterizer.ComputeCoverage(runs);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Covered area of the outline", outlineArea, GetWeightedSum(runs), 1e-9);
+
+      for (const auto &run : runs)
+      {
+        CPPUNIT_ASSERT_MESSAGE("Weight outside of (0, 1]", run.Weight > 0.0 && run.Weight <= 1.0);
+        CPPUNIT_ASSERT_MESSAGE("Partially covered voxels are single runs",
+                               run.Weight == 1.0 || run.XEnd == run.XBegin + 1);
+      }
+
+      rasterizer.AddPolygon(hole);
+      rasterizer.ComputeCoverage(runs);
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(
+        "Covered area of the outline with the hole", outlineArea - holeArea, GetWeightedSum(runs), 1e-9);
+    }
+  }
+
+  void TestPolyLine()
+  {
+    mitk::PlanarFigureRasterizer rasterizer;
+    rasterizer.SetSize(20, 20);
+
+    std::vector<itk::Index<2>> indices(3);
+    indices[0][0] = 2;
+    indices[0][1] = 3;
+    indices[1][0] = 12;
+    indices[1][1] = 3;
+    indices[2][0] = 12;
+    indices[2][1] = 9;
+
+    mitk::PlanarFigureRasterizer::RunListType runs;
+    rasterizer.RasterizePolyLine(indices, runs);
+
+    // the corner voxel is visited by both segments
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(
+      "Voxels of an L shaped poly line", 17ul, mitk::PlanarFigureRasterizer::GetNumberOfVoxels(runs));
+    CPPUNIT_ASSERT_MESSAGE("Horizontal segment is one run",
+                           runs.front().Y == 3 && runs.front().XBegin == 2 && runs.front().XEnd == 13);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkPlanarFigureRasterizer)
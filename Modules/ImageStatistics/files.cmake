@@ -7,6 +7,7 @@ set(CPP_FILES
   mitkHotspotMaskGenerator.cpp
   mitkMaskGenerator.cpp
   mitkPlanarFigureMaskGenerator.cpp
+  mitkPlanarFigureRasterizer.cpp
   mitkMultiLabelMaskGenerator.cpp
   mitkImageMaskGenerator.cpp
   mitkHistogramStatisticsCalculator.cpp
@@ -30,6 +31,7 @@ set(H_FILES
   mitkHotspotMaskGenerator.h
   mitkMaskGenerator.h
   mitkPlanarFigureMaskGenerator.h
+  mitkPlanarFigureRasterizer.h
   mitkMultiLabelMaskGenerator.h
   mitkImageMaskGenerator.h
   mitkHistogramStatisticsCalculator.h
@@ -26,8 +26,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkMaskUtilities.h>
 #include <mitkMinMaxImageFilterWithIndex.h>
 #include <mitkMinMaxLabelmageFilterWithIndex.h>
+#include <mitkPlanarFigureMaskGenerator.h>
 #include <mitkitkMaskImageFilter.h>
 
+#include <algorithm>
+
 namespace mitk
 {
   void ImageStatisticsCalculator::SetInputImage(mitk::Image::ConstPointer image)
@@ -114,12 +117,21 @@ namespace mitk
       // always compute statistics on all timesteps
       for (unsigned int timeStep = 0; timeStep < m_Image->GetTimeSteps(); timeStep++)
       {
+        m_PlanarFigureRuns.clear();
         if (m_MaskGenerator.IsNotNull())
         {
           m_MaskGenerator->SetTimeStep(timeStep);
           //See T25625: otherwise, the mask is not computed again after setting a different time step
           m_MaskGenerator->Modified();
-          m_InternalMask = m_MaskGenerator->GetMask();
+
+          // planar figure masks are consumed as runs, unless they have to be combined with a secondary mask
+          auto *planarFigureMaskGenerator = dynamic_cast<PlanarFigureMaskGenerator *>(m_MaskGenerator.GetPointer());
+          if (planarFigureMaskGenerator != nullptr && m_SecondaryMaskGenerator.IsNull())
+          {
+            m_PlanarFigureRuns = planarFigureMaskGenerator->GetRuns();
+          }
+
+          m_InternalMask = m_PlanarFigureRuns.empty() ? m_MaskGenerator->GetMask() : nullptr;
           if (m_MaskGenerator->GetReferenceImage().IsNotNull())
           {
             m_InternalImageForStatistics = m_MaskGenerator->GetReferenceImage();
@@ -302,6 +314,82 @@ namespace mitk
     return voxelVolume;
   }
 
+  template <typename TPixel, unsigned int VImageDimension>
+  void ImageStatisticsCalculator::GatherPlanarFigureRuns(
+    const itk::Image<TPixel, VImageDimension> *image,
+    typename itk::Image<TPixel, VImageDimension>::Pointer &voxels,
+    typename itk::Image<MaskPixelType, VImageDimension>::Pointer &mask) const
+  {
+    typedef itk::Image<TPixel, VImageDimension> ImageType;
+    typedef itk::Image<MaskPixelType, VImageDimension> MaskType;
+
+    // the runs are given in the first two dimensions of the slice of the planar figure
+    const typename ImageType::RegionType &bufferedRegion = image->GetBufferedRegion();
+    for (unsigned int d = 2; d < VImageDimension; ++d)
+    {
+      if (bufferedRegion.GetSize(d) != 1)
+      {
+        mitkThrow() << "Planar figure runs can only be used with an image slice.";
+      }
+    }
+
+    typename ImageType::RegionType region;
+    region.SetSize(0, PlanarFigureRasterizer::GetNumberOfVoxels(m_PlanarFigureRuns));
+    for (unsigned int d = 1; d < VImageDimension; ++d)
+    {
+      region.SetSize(d, 1);
+    }
+
+    voxels = ImageType::New();
+    voxels->SetRegions(region);
+    voxels->SetSpacing(image->GetSpacing());
+    voxels->Allocate();
+
+    mask = MaskType::New();
+    mask->SetRegions(region);
+    mask->SetSpacing(image->GetSpacing());
+    mask->Allocate();
+    mask->FillBuffer(1);
+
+    const TPixel *buffer = image->GetBufferPointer();
+    const itk::OffsetValueType rowLength = bufferedRegion.GetSize(0);
+    const itk::OffsetValueType numberOfRows = bufferedRegion.GetSize(1);
+    TPixel *target = voxels->GetBufferPointer();
+    for (const auto &run : m_PlanarFigureRuns)
+    {
+      const itk::OffsetValueType y = run.Y - bufferedRegion.GetIndex(1);
+      const itk::OffsetValueType xBegin = run.XBegin - bufferedRegion.GetIndex(0);
+      const itk::OffsetValueType xEnd = run.XEnd - bufferedRegion.GetIndex(0);
+      if (y < 0 || y >= numberOfRows || xBegin < 0 || xEnd > rowLength)
+      {
+        mitkThrow() << "Planar figure runs are outside of the image.";
+      }
+
+      target = std::copy(buffer + y * rowLength + xBegin, buffer + y * rowLength + xEnd, target);
+    }
+  }
+
+  template <typename TPixel, unsigned int VImageDimension>
+  typename itk::Image<TPixel, VImageDimension>::IndexType ImageStatisticsCalculator::GetIndexOfGatheredVoxel(
+    const itk::Image<TPixel, VImageDimension> *image,
+    const typename itk::Image<TPixel, VImageDimension>::IndexType &gatheredIndex) const
+  {
+    typename itk::Image<TPixel, VImageDimension>::IndexType index = image->GetBufferedRegion().GetIndex();
+
+    itk::OffsetValueType remaining = gatheredIndex[0];
+    for (const auto &run : m_PlanarFigureRuns)
+    {
+      if (remaining < run.XEnd - run.XBegin)
+      {
+        index[0] = run.XBegin + remaining;
+        index[1] = run.Y;
+        break;
+      }
+      remaining -= run.XEnd - run.XBegin;
+    }
+    return index;
+  }
+
   template <typename TPixel, unsigned int VImageDimension>
   void ImageStatisticsCalculator::InternalCalculateStatisticsMasked(typename itk::Image<TPixel, VImageDimension> *image,
                                                                     const TimeGeometry *timeGeometry,
@@ -315,73 +403,81 @@ namespace mitk
     typedef typename itk::MinMaxLabelImageFilterWithIndex<ImageType, MaskType> MinMaxLabelFilterType;
     typedef typename ImageType::PixelType InputImgPixelType;
 
-    // workaround: if m_SecondaryMaskGenerator ist not null but m_MaskGenerator is! (this is the case if we request a
-    // 'ignore zuero valued pixels' mask in the gui but do not define a primary mask)
     bool swapMasks = false;
-    if (m_SecondaryMask.IsNotNull() && m_InternalMask.IsNull())
-    {
-      m_InternalMask = m_SecondaryMask;
-      m_SecondaryMask = nullptr;
-      swapMasks = true;
-    }
-
-    // maskImage has to have the same dimension as image
     typename MaskType::Pointer maskImage = MaskType::New();
-    try
-    {
-      // try to access the pixel values directly (no copying or casting). Only works if mask pixels are of pixelType
-      // unsigned short
-      maskImage = ImageToItkImage<MaskPixelType, VImageDimension>(m_InternalMask);
-    }
-    catch (const itk::ExceptionObject &)
+    typename ImageType::Pointer adaptedImage = ImageType::New();
 
+    if (!m_PlanarFigureRuns.empty())
     {
-      // if the pixel type of the mask is not short, then we have to make a copy of m_InternalMask (and cast the values)
-      CastToItkImage(m_InternalMask, maskImage);
+      // the voxels of a planar figure are gathered from its runs, the statistics filters only see these voxels
+      this->GatherPlanarFigureRuns<TPixel, VImageDimension>(image, adaptedImage, maskImage);
     }
-
-    // if we have a secondary mask (say a ignoreZeroPixelMask) we need to combine the masks (corresponds to AND)
-    if (m_SecondaryMask.IsNotNull())
+    else
     {
-      // dirty workaround for a bug when pf mask + any other mask is used in conjunction. We need a proper fix for this
-      // (Fabian Isensee is responsible and probably working on it!)
-      if (m_InternalMask->GetDimension() == 2 &&
-          (m_SecondaryMask->GetDimension() == 3 || m_SecondaryMask->GetDimension() == 4))
+      // workaround: if m_SecondaryMaskGenerator ist not null but m_MaskGenerator is! (this is the case if we request a
+      // 'ignore zuero valued pixels' mask in the gui but do not define a primary mask)
+      if (m_SecondaryMask.IsNotNull() && m_InternalMask.IsNull())
       {
-        mitk::Image::ConstPointer old_img = m_SecondaryMaskGenerator->GetReferenceImage();
-        m_SecondaryMaskGenerator->SetInputImage(m_MaskGenerator->GetReferenceImage());
-        m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
-        m_SecondaryMaskGenerator->SetInputImage(old_img);
+        m_InternalMask = m_SecondaryMask;
+        m_SecondaryMask = nullptr;
+        swapMasks = true;
       }
-      typename MaskType::Pointer secondaryMaskImage = MaskType::New();
-      secondaryMaskImage = ImageToItkImage<MaskPixelType, VImageDimension>(m_SecondaryMask);
-
-      // secondary mask should be a ignore zero value pixel mask derived from image. it has to be cropped to the mask
-      // region (which may be planar or simply smaller)
-      typename MaskUtilities<MaskPixelType, VImageDimension>::Pointer secondaryMaskMaskUtil =
-        MaskUtilities<MaskPixelType, VImageDimension>::New();
-      secondaryMaskMaskUtil->SetImage(secondaryMaskImage.GetPointer());
-      secondaryMaskMaskUtil->SetMask(maskImage.GetPointer());
-      typename MaskType::Pointer adaptedSecondaryMaskImage = secondaryMaskMaskUtil->ExtractMaskImageRegion();
-
-      typename itk::MaskImageFilter2<MaskType, MaskType, MaskType>::Pointer maskFilter =
-        itk::MaskImageFilter2<MaskType, MaskType, MaskType>::New();
-      maskFilter->SetInput1(maskImage);
-      maskFilter->SetInput2(adaptedSecondaryMaskImage);
-      maskFilter->SetMaskingValue(
-        1); // all pixels of maskImage where secondaryMaskImage==1 will be kept, all the others are set to 0
-      maskFilter->UpdateLargestPossibleRegion();
-      maskImage = maskFilter->GetOutput();
-    }
-
-    typename MaskUtilType::Pointer maskUtil = MaskUtilType::New();
-    maskUtil->SetImage(image);
-    maskUtil->SetMask(maskImage.GetPointer());
-
-    // if mask is smaller than image, extract the image region where the mask is
-    typename ImageType::Pointer adaptedImage = ImageType::New();
 
-    adaptedImage = maskUtil->ExtractMaskImageRegion(); // this also checks mask sanity
+      // maskImage has to have the same dimension as image
+      try
+      {
+        // try to access the pixel values directly (no copying or casting). Only works if mask pixels are of pixelType
+        // unsigned short
+        maskImage = ImageToItkImage<MaskPixelType, VImageDimension>(m_InternalMask);
+      }
+      catch (const itk::ExceptionObject &)
+
+      {
+        // if the pixel type of the mask is not short, then we have to make a copy of m_InternalMask (and cast the values)
+        CastToItkImage(m_InternalMask, maskImage);
+      }
+
+      // if we have a secondary mask (say a ignoreZeroPixelMask) we need to combine the masks (corresponds to AND)
+      if (m_SecondaryMask.IsNotNull())
+      {
+        // dirty workaround for a bug when pf mask + any other mask is used in conjunction. We need a proper fix for this
+        // (Fabian Isensee is responsible and probably working on it!)
+        if (m_InternalMask->GetDimension() == 2 &&
+            (m_SecondaryMask->GetDimension() == 3 || m_SecondaryMask->GetDimension() == 4))
+        {
+          mitk::Image::ConstPointer old_img = m_SecondaryMaskGenerator->GetReferenceImage();
+          m_SecondaryMaskGenerator->SetInputImage(m_MaskGenerator->GetReferenceImage());
+          m_SecondaryMask = m_SecondaryMaskGenerator->GetMask();
+          m_SecondaryMaskGenerator->SetInputImage(old_img);
+        }
+        typename MaskType::Pointer secondaryMaskImage = MaskType::New();
+        secondaryMaskImage = ImageToItkImage<MaskPixelType, VImageDimension>(m_SecondaryMask);
+
+        // secondary mask should be a ignore zero value pixel mask derived from image. it has to be cropped to the mask
+        // region (which may be planar or simply smaller)
+        typename MaskUtilities<MaskPixelType, VImageDimension>::Pointer secondaryMaskMaskUtil =
+          MaskUtilities<MaskPixelType, VImageDimension>::New();
+        secondaryMaskMaskUtil->SetImage(secondaryMaskImage.GetPointer());
+        secondaryMaskMaskUtil->SetMask(maskImage.GetPointer());
+        typename MaskType::Pointer adaptedSecondaryMaskImage = secondaryMaskMaskUtil->ExtractMaskImageRegion();
+
+        typename itk::MaskImageFilter2<MaskType, MaskType, MaskType>::Pointer maskFilter =
+          itk::MaskImageFilter2<MaskType, MaskType, MaskType>::New();
+        maskFilter->SetInput1(maskImage);
+        maskFilter->SetInput2(adaptedSecondaryMaskImage);
+        maskFilter->SetMaskingValue(
+          1); // all pixels of maskImage where secondaryMaskImage==1 will be kept, all the others are set to 0
+        maskFilter->UpdateLargestPossibleRegion();
+        maskImage = maskFilter->GetOutput();
+      }
+
+      typename MaskUtilType::Pointer maskUtil = MaskUtilType::New();
+      maskUtil->SetImage(image);
+      maskUtil->SetMask(maskImage.GetPointer());
+
+      // if mask is smaller than image, extract the image region where the mask is
+      adaptedImage = maskUtil->ExtractMaskImageRegion(); // this also checks mask sanity
+    }
 
     // find min, max, minindex and maxindex
     typename MinMaxLabelFilterType::Pointer minMaxFilter = MinMaxLabelFilterType::New();
@@ -460,8 +556,15 @@ namespace mitk
       mitk::Point3D worldCoordinateMax;
       mitk::Point3D indexCoordinateMin;
       mitk::Point3D indexCoordinateMax;
-      m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMinIndex(*it), worldCoordinateMin);
-      m_InternalImageForStatistics->GetGeometry()->IndexToWorld(minMaxFilter->GetMaxIndex(*it), worldCoordinateMax);
+      typename ImageType::IndexType tmpMinIndex = minMaxFilter->GetMinIndex(*it);
+      typename ImageType::IndexType tmpMaxIndex = minMaxFilter->GetMaxIndex(*it);
+      if (!m_PlanarFigureRuns.empty())
+      {
+        tmpMinIndex = this->GetIndexOfGatheredVoxel<TPixel, VImageDimension>(image, tmpMinIndex);
+        tmpMaxIndex = this->GetIndexOfGatheredVoxel<TPixel, VImageDimension>(image, tmpMaxIndex);
+      }
+      m_InternalImageForStatistics->GetGeometry()->IndexToWorld(tmpMinIndex, worldCoordinateMin);
+      m_InternalImageForStatistics->GetGeometry()->IndexToWorld(tmpMaxIndex, worldCoordinateMax);
       m_Image->GetGeometry()->WorldToIndex(worldCoordinateMin, indexCoordinateMin);
       m_Image->GetGeometry()->WorldToIndex(worldCoordinateMax, indexCoordinateMax);
 
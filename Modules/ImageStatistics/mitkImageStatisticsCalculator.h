@@ -21,6 +21,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkImage.h>
 #include <mitkMaskGenerator.h>
 #include <mitkImageStatisticsContainer.h>
+#include <mitkPlanarFigureRasterizer.h>
 #include <itkImage.h>
 #include <itkObject.h>
 
@@ -101,6 +102,18 @@ namespace mitk
                 typename itk::Image< TPixel, VImageDimension >* image, const TimeGeometry* timeGeometry,
                 unsigned int timeStep);
 
+        /** Copies the voxels of m_PlanarFigureRuns into a line image and creates a mask of ones for it */
+        template < typename TPixel, unsigned int VImageDimension >
+        void GatherPlanarFigureRuns(const itk::Image< TPixel, VImageDimension >* image,
+                typename itk::Image< TPixel, VImageDimension >::Pointer& voxels,
+                typename itk::Image< MaskPixelType, VImageDimension >::Pointer& mask) const;
+
+        /** Index in the image of a voxel gathered by GatherPlanarFigureRuns() */
+        template < typename TPixel, unsigned int VImageDimension >
+        typename itk::Image< TPixel, VImageDimension >::IndexType GetIndexOfGatheredVoxel(
+                const itk::Image< TPixel, VImageDimension >* image,
+                const typename itk::Image< TPixel, VImageDimension >::IndexType& gatheredIndex) const;
+
         template < typename TPixel, unsigned int VImageDimension >
         double GetVoxelVolume(typename itk::Image<TPixel, VImageDimension>* image) const;
 
@@ -116,6 +129,9 @@ namespace mitk
         mitk::MaskGenerator::Pointer m_SecondaryMaskGenerator;
         mitk::Image::Pointer m_SecondaryMask;
 
+        // runs of a planar figure mask, used instead of m_InternalMask if not empty
+        PlanarFigureRasterizer::RunListType m_PlanarFigureRuns;
+
         unsigned int m_nBinsForHistogramStatistics;
         double m_binSizeForHistogramStatistics;
         bool m_UseBinSizeOverNBins;
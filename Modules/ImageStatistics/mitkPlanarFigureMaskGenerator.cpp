@@ -7,19 +7,9 @@
 #include <mitkImageTimeSelector.h>
 #include <mitkIOUtil.h>
 
-#include <itkCastImageFilter.h>
-#include <itkVTKImageExport.h>
-#include <itkVTKImageImport.h>
-#include <itkImageDuplicator.h>
 #include <itkExceptionObject.h>
-#include <itkLineIterator.h>
 
-#include <vtkPoints.h>
-#include <vtkImageStencil.h>
-#include <vtkImageImport.h>
-#include <vtkImageExport.h>
-#include <vtkLassoStencilSource.h>
-#include <vtkSmartPointer.h>
+#include <algorithm>
 
 
 
@@ -63,34 +53,10 @@ mitk::Image::ConstPointer PlanarFigureMaskGenerator::GetReferenceImage()
     return m_ReferenceImage;
 }
 
-template < typename TPixel, unsigned int VImageDimension >
-void PlanarFigureMaskGenerator::InternalCalculateMaskFromPlanarFigure(
-  const itk::Image< TPixel, VImageDimension > *image, unsigned int axis )
+void PlanarFigureMaskGenerator::CalculateRuns(const mitk::Image *slice, unsigned int axis)
 {
-  typedef itk::Image< unsigned short, 2 > MaskImage2DType;
-
-  typename MaskImage2DType::Pointer maskImage = MaskImage2DType::New();
-  maskImage->SetOrigin(image->GetOrigin());
-  maskImage->SetSpacing(image->GetSpacing());
-  maskImage->SetLargestPossibleRegion(image->GetLargestPossibleRegion());
-  maskImage->SetBufferedRegion(image->GetBufferedRegion());
-  maskImage->SetDirection(image->GetDirection());
-  maskImage->SetNumberOfComponentsPerPixel(image->GetNumberOfComponentsPerPixel());
-  maskImage->Allocate();
-  maskImage->FillBuffer(1);
-
-  // all PolylinePoints of the PlanarFigure are stored in a vtkPoints object.
-  // These points are used by the vtkLassoStencilSource to create
-  // a vtkImageStencil.
   const mitk::PlaneGeometry *planarFigurePlaneGeometry = m_PlanarFigure->GetPlaneGeometry();
-  const typename PlanarFigure::PolyLineType planarFigurePolyline = m_PlanarFigure->GetPolyLine( 0 );
   const mitk::BaseGeometry *imageGeometry3D = m_inputImage->GetGeometry( 0 );
-  // If there is a second poly line in a closed planar figure, treat it as a hole.
-  PlanarFigure::PolyLineType planarFigureHolePolyline;
-
-  if (m_PlanarFigure->GetPolyLinesSize() == 2)
-    planarFigureHolePolyline = m_PlanarFigure->GetPolyLine(1);
-
 
   // Determine x- and y-dimensions depending on principal axis
   // TODO use plane geometry normal to determine that automatically, then check whether the PF is aligned with one of the three principal axis
@@ -114,64 +80,76 @@ void PlanarFigureMaskGenerator::InternalCalculateMaskFromPlanarFigure(
     break;
   }
 
-  // store the polyline contour as vtkPoints object
-  bool outOfBounds = false;
-  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
-  typename PlanarFigure::PolyLineType::const_iterator it;
-  for ( it = planarFigurePolyline.begin();
-    it != planarFigurePolyline.end();
-    ++it )
-  {
-    Point3D point3D;
-
-    // Convert 2D point back to the local index coordinates of the selected
-    // image
-    // Fabian: From PlaneGeometry documentation:
-    // Converts a 2D point given in mm (pt2d_mm) relative to the upper-left corner of the geometry into the corresponding world-coordinate (a 3D point in mm, pt3d_mm).
-    // To convert a 2D point given in units (e.g., pixels in case of an image) into a 2D point given in mm (as required by this method), use IndexToWorld.
-    planarFigurePlaneGeometry->Map( *it, point3D );
-
-    // Polygons (partially) outside of the image bounds can not be processed
-    // further due to a bug in vtkPolyDataToImageStencil
-    if ( !imageGeometry3D->IsInside( point3D ) )
+  // Convert the 2D points of a poly line back to the index coordinates of the slice.
+  // Fabian: From PlaneGeometry documentation:
+  // Converts a 2D point given in mm (pt2d_mm) relative to the upper-left corner of the geometry into the corresponding world-coordinate (a 3D point in mm, pt3d_mm).
+  // To convert a 2D point given in units (e.g., pixels in case of an image) into a 2D point given in mm (as required by this method), use IndexToWorld.
+  auto toSliceIndex = [&](const PlanarFigure::PolyLineType &polyLine, bool &outOfBounds) {
+    PlanarFigureRasterizer::PolygonType polygon;
+    polygon.reserve(polyLine.size());
+    for (const auto &point2D : polyLine)
     {
-      outOfBounds = true;
-    }
+      Point3D point3D;
+      planarFigurePlaneGeometry->Map( point2D, point3D );
 
-    imageGeometry3D->WorldToIndex( point3D, point3D );
+      if ( !imageGeometry3D->IsInside( point3D ) )
+      {
+        outOfBounds = true;
+      }
 
-    points->InsertNextPoint( point3D[i0], point3D[i1], 0 );
-  }
+      imageGeometry3D->WorldToIndex( point3D, point3D );
 
-  vtkSmartPointer<vtkPoints> holePoints = nullptr;
+      Point2D index2D;
+      index2D[0] = point3D[i0];
+      index2D[1] = point3D[i1];
+      polygon.push_back( index2D );
+    }
+    return polygon;
+  };
 
-  if (!planarFigureHolePolyline.empty())
-  {
-    holePoints = vtkSmartPointer<vtkPoints>::New();
+  m_Rasterizer.ClearPolygons();
+  m_Rasterizer.SetSize(slice->GetDimension(0), slice->GetDimension(1));
 
-    Point3D point3D;
-    PlanarFigure::PolyLineType::const_iterator end = planarFigureHolePolyline.end();
+  bool outOfBounds = false;
+  const PlanarFigureRasterizer::PolygonType outline = toSliceIndex( m_PlanarFigure->GetPolyLine( 0 ), outOfBounds );
 
-    for (it = planarFigureHolePolyline.begin(); it != end; ++it)
+  // rastering for open planar figure:
+  if ( !m_PlanarFigure->IsClosed() )
+  {
+    if ( outOfBounds )
     {
-      // Fabian: same as above
-      planarFigurePlaneGeometry->Map(*it, point3D);
-      imageGeometry3D->WorldToIndex(point3D, point3D);
-      holePoints->InsertNextPoint(point3D[i0], point3D[i1], 0);
+      throw std::runtime_error( "Figure at least partially outside of image bounds!" );
     }
+
+    std::vector< itk::Index< 2 > > pointIndices( outline.size() );
+    for ( std::size_t i = 0; i < outline.size(); ++i )
+    {
+      pointIndices[i][0] = outline[i][0];
+      pointIndices[i][1] = outline[i][1];
+    }
+
+    m_Rasterizer.RasterizePolyLine( pointIndices, m_Runs );
+    return;
   }
 
   // mark a malformed 2D planar figure ( i.e. area = 0 ) as out of bounds
   // this can happen when all control points of a rectangle lie on the same line = two of the three extents are zero
-  double bounds[6] = {0, 0, 0, 0, 0, 0};
-  points->GetBounds( bounds );
-  bool extent_x = (fabs(bounds[0] - bounds[1])) < mitk::eps;
-  bool extent_y = (fabs(bounds[2] - bounds[3])) < mitk::eps;
-  bool extent_z = (fabs(bounds[4] - bounds[5])) < mitk::eps;
+  double bounds[4] = {0, 0, 0, 0};
+  if ( !outline.empty() )
+  {
+    bounds[0] = bounds[1] = outline.front()[0];
+    bounds[2] = bounds[3] = outline.front()[1];
+  }
+  for ( const auto &point : outline )
+  {
+    bounds[0] = std::min( bounds[0], point[0] );
+    bounds[1] = std::max( bounds[1], point[0] );
+    bounds[2] = std::min( bounds[2], point[1] );
+    bounds[3] = std::max( bounds[3], point[1] );
+  }
 
   // throw an exception if a closed planar figure is deformed, i.e. has only one non-zero extent
-  if ( m_PlanarFigure->IsClosed() &&
-    ((extent_x && extent_y) || (extent_x && extent_z)  || (extent_y && extent_z)))
+  if ( fabs( bounds[0] - bounds[1] ) < mitk::eps || fabs( bounds[2] - bounds[3] ) < mitk::eps )
   {
     mitkThrow() << "Figure has a zero area and cannot be used for masking.";
   }
@@ -181,79 +159,23 @@ void PlanarFigureMaskGenerator::InternalCalculateMaskFromPlanarFigure(
     throw std::runtime_error( "Figure at least partially outside of image bounds!" );
   }
 
-  // create a vtkLassoStencilSource and set the points of the Polygon
-  vtkSmartPointer<vtkLassoStencilSource> lassoStencil = vtkSmartPointer<vtkLassoStencilSource>::New();
-  lassoStencil->SetShapeToPolygon();
-  lassoStencil->SetPoints( points );
+  m_Rasterizer.AddPolygon( outline );
 
-  vtkSmartPointer<vtkLassoStencilSource> holeLassoStencil = nullptr;
-
-  if (holePoints.GetPointer() != nullptr)
-  {
-    holeLassoStencil = vtkSmartPointer<vtkLassoStencilSource>::New();
-    holeLassoStencil->SetShapeToPolygon();
-    holeLassoStencil->SetPoints(holePoints);
-  }
-
-  // Export from ITK to VTK (to use a VTK filter)
-  typedef itk::VTKImageImport< MaskImage2DType > ImageImportType;
-  typedef itk::VTKImageExport< MaskImage2DType > ImageExportType;
-
-  typename ImageExportType::Pointer itkExporter = ImageExportType::New();
-  itkExporter->SetInput( maskImage );
-//  itkExporter->SetInput( castFilter->GetOutput() );
-
-  vtkSmartPointer<vtkImageImport> vtkImporter = vtkSmartPointer<vtkImageImport>::New();
-  this->ConnectPipelines( itkExporter, vtkImporter );
-
-  // Apply the generated image stencil to the input image
-  vtkSmartPointer<vtkImageStencil> imageStencilFilter = vtkSmartPointer<vtkImageStencil>::New();
-  imageStencilFilter->SetInputConnection( vtkImporter->GetOutputPort() );
-  imageStencilFilter->SetStencilConnection(lassoStencil->GetOutputPort());
-  imageStencilFilter->ReverseStencilOff();
-  imageStencilFilter->SetBackgroundValue( 0 );
-  imageStencilFilter->Update();
-
-  vtkSmartPointer<vtkImageStencil> holeStencilFilter = nullptr;
-
-  if (holeLassoStencil.GetPointer() != nullptr)
+  // If there is a second poly line in a closed planar figure, treat it as a hole.
+  if ( m_PlanarFigure->GetPolyLinesSize() == 2 )
   {
-    holeStencilFilter = vtkSmartPointer<vtkImageStencil>::New();
-    holeStencilFilter->SetInputConnection(imageStencilFilter->GetOutputPort());
-    holeStencilFilter->SetStencilConnection(holeLassoStencil->GetOutputPort());
-    holeStencilFilter->ReverseStencilOn();
-    holeStencilFilter->SetBackgroundValue(0);
-    holeStencilFilter->Update();
+    bool holeOutOfBounds = false;
+    m_Rasterizer.AddPolygon( toSliceIndex( m_PlanarFigure->GetPolyLine( 1 ), holeOutOfBounds ) );
   }
 
-  // Export from VTK back to ITK
-  vtkSmartPointer<vtkImageExport> vtkExporter = vtkSmartPointer<vtkImageExport>::New();
-  vtkExporter->SetInputConnection( holeStencilFilter.GetPointer() == nullptr
-    ? imageStencilFilter->GetOutputPort()
-    : holeStencilFilter->GetOutputPort());
-  vtkExporter->Update();
-
-  typename ImageImportType::Pointer itkImporter = ImageImportType::New();
-  this->ConnectPipelines( vtkExporter, itkImporter );
-  itkImporter->Update();
-
-  typedef itk::ImageDuplicator< ImageImportType::OutputImageType > DuplicatorType;
-  DuplicatorType::Pointer duplicator = DuplicatorType::New();
-  duplicator->SetInputImage( itkImporter->GetOutput() );
-  duplicator->Update();
-
-  // Store mask
-  m_InternalITKImageMask2D = duplicator->GetOutput();
+  m_Rasterizer.ComputeRuns( m_Runs );
 }
 
 template < typename TPixel, unsigned int VImageDimension >
-void PlanarFigureMaskGenerator::InternalCalculateMaskFromOpenPlanarFigure(
-  const itk::Image< TPixel, VImageDimension > *image, unsigned int axis )
+void PlanarFigureMaskGenerator::InternalCalculateMaskFromRuns(
+  const itk::Image< TPixel, VImageDimension > *image )
 {
-  typedef itk::Image< unsigned short, 2 >       MaskImage2DType;
-  typedef itk::LineIterator< MaskImage2DType >  LineIteratorType;
-  typedef MaskImage2DType::IndexType            IndexType2D;
-  typedef std::vector< IndexType2D >            IndexVecType;
+  typedef itk::Image< unsigned short, 2 > MaskImage2DType;
 
   typename MaskImage2DType::Pointer maskImage = MaskImage2DType::New();
   maskImage->SetOrigin(image->GetOrigin());
@@ -265,79 +187,12 @@ void PlanarFigureMaskGenerator::InternalCalculateMaskFromOpenPlanarFigure(
   maskImage->Allocate();
   maskImage->FillBuffer(0);
 
-  // all PolylinePoints of the PlanarFigure are stored in a vtkPoints object.
-  const mitk::PlaneGeometry *planarFigurePlaneGeometry = m_PlanarFigure->GetPlaneGeometry();
-  const typename PlanarFigure::PolyLineType planarFigurePolyline = m_PlanarFigure->GetPolyLine( 0 );
-  const mitk::BaseGeometry *imageGeometry3D = m_inputImage->GetGeometry( 0 );
-
-  // Determine x- and y-dimensions depending on principal axis
-  // TODO use plane geometry normal to determine that automatically, then check whether the PF is aligned with one of the three principal axis
-  int i0, i1;
-  switch ( axis )
+  const MaskImage2DType::RegionType &region = maskImage->GetBufferedRegion();
+  unsigned short *buffer = maskImage->GetBufferPointer();
+  for (const auto &run : m_Runs)
   {
-  case 0:
-    i0 = 1;
-    i1 = 2;
-    break;
-
-  case 1:
-    i0 = 0;
-    i1 = 2;
-    break;
-
-  case 2:
-  default:
-    i0 = 0;
-    i1 = 1;
-    break;
-  }
-
-  int numPolyLines = m_PlanarFigure->GetPolyLinesSize();
-  for ( int lineId = 0; lineId < numPolyLines; ++lineId )
-  {
-    // store the polyline contour as vtkPoints object
-    bool outOfBounds = false;
-    IndexVecType pointIndices;
-    typename PlanarFigure::PolyLineType::const_iterator it;
-    for ( it = planarFigurePolyline.begin();
-      it != planarFigurePolyline.end();
-      ++it )
-    {
-      Point3D point3D;
-
-      planarFigurePlaneGeometry->Map( *it, point3D );
-
-      if ( !imageGeometry3D->IsInside( point3D ) )
-      {
-        outOfBounds = true;
-      }
-
-      imageGeometry3D->WorldToIndex( point3D, point3D );
-
-      IndexType2D index2D;
-      index2D[0] = point3D[i0];
-      index2D[1] = point3D[i1];
-
-      pointIndices.push_back( index2D );
-    }
-
-    if ( outOfBounds )
-    {
-      throw std::runtime_error( "Figure at least partially outside of image bounds!" );
-    }
-
-    for ( IndexVecType::const_iterator it = pointIndices.begin(); it != pointIndices.end()-1; ++it )
-    {
-      IndexType2D ind1 = *it;
-      IndexType2D ind2 = *(it+1);
-
-      LineIteratorType lineIt( maskImage, ind1, ind2 );
-      while ( !lineIt.IsAtEnd() )
-      {
-        lineIt.Set( 1 );
-        ++lineIt;
-      }
-    }
+    unsigned short *row = buffer + (run.Y - region.GetIndex(1)) * region.GetSize(0) - region.GetIndex(0);
+    std::fill(row + run.XBegin, row + run.XEnd, 1);
   }
 
   // Store mask
@@ -423,35 +278,16 @@ void PlanarFigureMaskGenerator::CalculateMask()
 
     // extract image slice which corresponds to the planarFigure and store it in m_InternalImageSlice
     mitk::Image::ConstPointer inputImageSlice = extract2DImageSlice(axis, slice);
-    //mitk::IOUtil::Save(inputImageSlice, "/home/fabian/inputSliceImage.nrrd");
-    // Compute mask from PlanarFigure
-    // rastering for open planar figure:
-    if ( !m_PlanarFigure->IsClosed() )
-    {
-      AccessFixedDimensionByItk_1(inputImageSlice,
-        InternalCalculateMaskFromOpenPlanarFigure,
-        2, axis)
-    }
-    else//for closed planar figure
+    if (inputImageSlice.IsNull())
     {
-      AccessFixedDimensionByItk_1(inputImageSlice,
-                                  InternalCalculateMaskFromPlanarFigure,
-                                  2, axis)
+      mitkThrow() << "Could not extract the image slice of the planar figure.";
     }
 
-    //convert itk mask to mitk::Image::Pointer and return it
-    mitk::Image::Pointer planarFigureMaskImage;
-    planarFigureMaskImage = mitk::GrabItkImageMemory(m_InternalITKImageMask2D);
-    //mitk::IOUtil::Save(planarFigureMaskImage, "/home/fabian/planarFigureMaskImage.nrrd");
-
-    //Convert2Dto3DImageFilter::Pointer sliceTo3DImageConverter = Convert2Dto3DImageFilter::New();
-    //sliceTo3DImageConverter->SetInput(planarFigureMaskImage);
-    //sliceTo3DImageConverter->Update();
-    //mitk::IOUtil::Save(sliceTo3DImageConverter->GetOutput(), "/home/fabian/3DsliceImage.nrrd");
+    // Compute the runs of the PlanarFigure, the mask image is created from them on request
+    this->CalculateRuns(inputImageSlice, axis);
 
     m_ReferenceImage = inputImageSlice;
-    //mitk::IOUtil::Save(m_ReferenceImage, "/home/fabian/referenceImage.nrrd");
-    m_InternalMask = planarFigureMaskImage;
+    m_InternalMaskOutdated = true;
 }
 
 void PlanarFigureMaskGenerator::SetTimeStep(unsigned int timeStep)
@@ -464,9 +300,25 @@ void PlanarFigureMaskGenerator::SetTimeStep(unsigned int timeStep)
 
 mitk::Image::Pointer PlanarFigureMaskGenerator::GetMask()
 {
+    bool updated = false;
     if (IsUpdateRequired())
     {
         this->CalculateMask();
+        updated = true;
+    }
+
+    if (m_InternalMaskOutdated)
+    {
+        //convert itk mask to mitk::Image::Pointer and return it
+        AccessFixedDimensionByItk(m_ReferenceImage, InternalCalculateMaskFromRuns, 2);
+        m_InternalMask = mitk::GrabItkImageMemory(m_InternalITKImageMask2D);
+        m_InternalMaskOutdated = false;
+        updated = true;
+    }
+
+    // the mask is created before, so it does not look modified outside of this class
+    if (updated)
+    {
         this->Modified();
     }
 
@@ -474,6 +326,31 @@ mitk::Image::Pointer PlanarFigureMaskGenerator::GetMask()
     return m_InternalMask;
 }
 
+const PlanarFigureRasterizer::RunListType &PlanarFigureMaskGenerator::GetRuns()
+{
+    if (IsUpdateRequired())
+    {
+        this->CalculateMask();
+        this->Modified();
+        m_InternalMaskUpdateTime = this->GetMTime();
+    }
+
+    return m_Runs;
+}
+
+void PlanarFigureMaskGenerator::GetCoverage(PlanarFigureRasterizer::RunListType &runs)
+{
+    if (m_PlanarFigure.IsNotNull() && m_PlanarFigure->IsClosed())
+    {
+        this->GetRuns();
+        m_Rasterizer.ComputeCoverage(runs);
+    }
+    else
+    {
+        runs = this->GetRuns();
+    }
+}
+
 mitk::Image::ConstPointer PlanarFigureMaskGenerator::extract2DImageSlice(unsigned int axis, unsigned int slice)
 {
     // Extract slice with given position and direction from image
@@ -3,20 +3,20 @@
 
 #include <MitkImageStatisticsExports.h>
 #include <itkImage.h>
-#include <itkVTKImageExport.h>
-#include <itkVTKImageImport.h>
 #include <mitkImage.h>
 #include <mitkMaskGenerator.h>
 #include <mitkPlanarFigure.h>
-#include <vtkImageExport.h>
-#include <vtkImageImport.h>
-#include <vtkSmartPointer.h>
+#include <mitkPlanarFigureRasterizer.h>
 
 namespace mitk
 {
   /**
    * \class PlanarFigureMaskGenerator
    * \brief Derived from MaskGenerator. This class is used to convert a mitk::PlanarFigure into a binary image mask
+   *
+   * The figure is scan converted into runs of the 2D slice it lies in (see PlanarFigureRasterizer). Consumers that
+   * can work on the runs directly (like ImageStatisticsCalculator) should use GetRuns(), the mask image is only
+   * created by GetMask().
    */
   class MITKIMAGESTATISTICS_EXPORT PlanarFigureMaskGenerator : public MaskGenerator
   {
@@ -49,6 +49,18 @@ namespace mitk
      */
     void SetTimeStep(unsigned int timeStep) override;
 
+    /**
+     * @brief Voxels of the mask as runs in index coordinates of the reference image (the slice of the figure).
+     * Same voxels as GetMask(), but without creating the mask image.
+     */
+    const PlanarFigureRasterizer::RunListType &GetRuns();
+
+    /**
+     * @brief Voxels covered by a closed figure, weighted with the covered fraction of their area.
+     * For open figures these are the runs of GetRuns().
+     */
+    void GetCoverage(PlanarFigureRasterizer::RunListType &runs);
+
     itkGetConstMacro(PlanarFigureAxis, unsigned int);
     itkGetConstMacro(PlanarFigureSlice, unsigned int);
 
@@ -58,7 +70,8 @@ namespace mitk
         m_ReferenceImage(nullptr),
         m_PlanarFigureAxis(0),
         m_InternalMaskUpdateTime(0),
-        m_PlanarFigureSlice(0)
+        m_PlanarFigureSlice(0),
+        m_InternalMaskOutdated(false)
     {
       m_InternalMask = mitk::Image::New();
     }
@@ -66,58 +79,16 @@ namespace mitk
   private:
     void CalculateMask();
 
-    template <typename TPixel, unsigned int VImageDimension>
-    void InternalCalculateMaskFromPlanarFigure(const itk::Image<TPixel, VImageDimension> *image, unsigned int axis);
+    /** Scan converts the figure into m_Runs, in index coordinates of the given slice */
+    void CalculateRuns(const mitk::Image *slice, unsigned int axis);
 
     template <typename TPixel, unsigned int VImageDimension>
-    void InternalCalculateMaskFromOpenPlanarFigure(const itk::Image<TPixel, VImageDimension> *image, unsigned int axis);
+    void InternalCalculateMaskFromRuns(const itk::Image<TPixel, VImageDimension> *image);
 
     mitk::Image::ConstPointer extract2DImageSlice(unsigned int axis, unsigned int slice);
 
     bool GetPrincipalAxis(const BaseGeometry *geometry, Vector3D vector, unsigned int &axis);
 
-    /** Connection from ITK to VTK */
-    template <typename ITK_Exporter, typename VTK_Importer>
-    void ConnectPipelines(ITK_Exporter exporter, vtkSmartPointer<VTK_Importer> importer)
-    {
-      importer->SetUpdateInformationCallback(exporter->GetUpdateInformationCallback());
-
-      importer->SetPipelineModifiedCallback(exporter->GetPipelineModifiedCallback());
-      importer->SetWholeExtentCallback(exporter->GetWholeExtentCallback());
-      importer->SetSpacingCallback(exporter->GetSpacingCallback());
-      importer->SetOriginCallback(exporter->GetOriginCallback());
-      importer->SetScalarTypeCallback(exporter->GetScalarTypeCallback());
-
-      importer->SetNumberOfComponentsCallback(exporter->GetNumberOfComponentsCallback());
-
-      importer->SetPropagateUpdateExtentCallback(exporter->GetPropagateUpdateExtentCallback());
-      importer->SetUpdateDataCallback(exporter->GetUpdateDataCallback());
-      importer->SetDataExtentCallback(exporter->GetDataExtentCallback());
-      importer->SetBufferPointerCallback(exporter->GetBufferPointerCallback());
-      importer->SetCallbackUserData(exporter->GetCallbackUserData());
-    }
-
-    /** Connection from VTK to ITK */
-    template <typename VTK_Exporter, typename ITK_Importer>
-    void ConnectPipelines(vtkSmartPointer<VTK_Exporter> exporter, ITK_Importer importer)
-    {
-      importer->SetUpdateInformationCallback(exporter->GetUpdateInformationCallback());
-
-      importer->SetPipelineModifiedCallback(exporter->GetPipelineModifiedCallback());
-      importer->SetWholeExtentCallback(exporter->GetWholeExtentCallback());
-      importer->SetSpacingCallback(exporter->GetSpacingCallback());
-      importer->SetOriginCallback(exporter->GetOriginCallback());
-      importer->SetScalarTypeCallback(exporter->GetScalarTypeCallback());
-
-      importer->SetNumberOfComponentsCallback(exporter->GetNumberOfComponentsCallback());
-
-      importer->SetPropagateUpdateExtentCallback(exporter->GetPropagateUpdateExtentCallback());
-      importer->SetUpdateDataCallback(exporter->GetUpdateDataCallback());
-      importer->SetDataExtentCallback(exporter->GetDataExtentCallback());
-      importer->SetBufferPointerCallback(exporter->GetBufferPointerCallback());
-      importer->SetCallbackUserData(exporter->GetCallbackUserData());
-    }
-
     bool IsUpdateRequired() const;
 
     mitk::PlanarFigure::Pointer m_PlanarFigure;
@@ -127,6 +98,10 @@ namespace mitk
     unsigned int m_PlanarFigureAxis;
     unsigned long m_InternalMaskUpdateTime;
     unsigned int m_PlanarFigureSlice;
+
+    PlanarFigureRasterizer m_Rasterizer;
+    PlanarFigureRasterizer::RunListType m_Runs;
+    bool m_InternalMaskOutdated;
   };
 } // namespace mitk
 
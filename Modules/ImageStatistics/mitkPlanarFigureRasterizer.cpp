@@ -0,0 +1,454 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkPlanarFigureRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace
+{
+  // tolerance of vtkImageStencilRaster, voxel centers on the outline are inside
+  const double RasterTolerance = 1e-6;
+
+  // coverage closer to 0 or 1 is treated as empty or full voxel
+  const double CoverageEpsilon = 1e-9;
+
+  // twice the signed area, positive for counter clockwise polygons
+  double SignedArea(const mitk::PlanarFigureRasterizer::PolygonType &polygon)
+  {
+    double area = 0.0;
+    for (std::size_t i = 0; i < polygon.size(); ++i)
+    {
+      const mitk::Point2D &p1 = polygon[i];
+      const mitk::Point2D &p2 = polygon[(i + 1) % polygon.size()];
+      area += p1[0] * p2[1] - p2[0] * p1[1];
+    }
+    return area;
+  }
+
+  void AppendRun(mitk::PlanarFigureRasterizer::RunListType &runs, int y, int xBegin, int xEnd, double weight)
+  {
+    if (weight == 1.0 && !runs.empty() && runs.back().Y == y && runs.back().XEnd == xBegin &&
+        runs.back().Weight == 1.0)
+    {
+      runs.back().XEnd = xEnd;
+      return;
+    }
+
+    mitk::PlanarFigureRasterizer::Run run;
+    run.Y = y;
+    run.XBegin = xBegin;
+    run.XEnd = xEnd;
+    run.Weight = weight;
+    runs.push_back(run);
+  }
+}
+
+mitk::PlanarFigureRasterizer::PlanarFigureRasterizer() : m_Width(0), m_Height(0)
+{
+}
+
+void mitk::PlanarFigureRasterizer::SetSize(int width, int height)
+{
+  m_Width = width;
+  m_Height = height;
+}
+
+void mitk::PlanarFigureRasterizer::AddPolygon(const PolygonType &polygon)
+{
+  m_Polygons.push_back(polygon);
+}
+
+void mitk::PlanarFigureRasterizer::ClearPolygons()
+{
+  m_Polygons.clear();
+}
+
+unsigned long mitk::PlanarFigureRasterizer::GetNumberOfVoxels(const RunListType &runs)
+{
+  unsigned long numberOfVoxels = 0;
+  for (const Run &run : runs)
+  {
+    numberOfVoxels += run.XEnd - run.XBegin;
+  }
+  return numberOfVoxels;
+}
+
+bool mitk::PlanarFigureRasterizer::GetRowRange(int &firstRow, int &lastRow) const
+{
+  if (m_Polygons.empty() || m_Polygons.front().size() < 3 || m_Width <= 0 || m_Height <= 0)
+    return false;
+
+  double minimum = m_Polygons.front().front()[1];
+  double maximum = minimum;
+  for (const mitk::Point2D &point : m_Polygons.front())
+  {
+    minimum = std::min(minimum, point[1]);
+    maximum = std::max(maximum, point[1]);
+  }
+
+  // one row of margin on both sides covers the tolerance of the scan conversion and the voxel extent
+  firstRow = std::max(0, static_cast<int>(std::floor(minimum)) - 1);
+  lastRow = std::min(m_Height - 1, static_cast<int>(std::floor(maximum)) + 1);
+  return firstRow <= lastRow;
+}
+
+void mitk::PlanarFigureRasterizer::CollectCrossings(const PolygonType &polygon,
+                                                    int firstRow,
+                                                    std::vector<std::vector<double>> &rows) const
+{
+  const int n = static_cast<int>(polygon.size());
+  if (n < 3)
+    return;
+
+  for (int i = 0; i < n; ++i)
+  {
+    const mitk::Point2D &p1 = polygon[i];
+    const mitk::Point2D &p2 = polygon[(i + 1) % n];
+
+    double x1 = p1[0];
+    double y1 = p1[1];
+    double x2 = p2[0];
+    double y2 = p2[1];
+
+    if (y1 == y2)
+      continue;
+
+    // the neighbors are searched past horizontal edges, so that a horizontal step of a monotone outline is not
+    // taken for an extremum (which would give an odd number of crossings in its row)
+    int previous = (i + n - 1) % n;
+    while (polygon[previous][1] == y1 && previous != i)
+      previous = (previous + n - 1) % n;
+    int next = (i + 2) % n;
+    while (polygon[next][1] == y2 && next != i)
+      next = (next + 1) % n;
+
+    // the ends of an edge at a local extremum in y are extended by the tolerance
+    bool inflection1 = (y1 - polygon[previous][1]) * (y2 - y1) <= 0;
+    bool inflection2 = (y2 - y1) * (polygon[next][1] - y2) <= 0;
+
+    if (y1 > y2)
+    {
+      std::swap(x1, x2);
+      std::swap(y1, y2);
+      std::swap(inflection1, inflection2);
+    }
+
+    const double xmin = std::min(x1, x2);
+    const double xmax = std::max(x1, x2);
+    const double ymin = y1 - (inflection1 ? RasterTolerance : 0.0);
+    const double ymax = y2 + (inflection2 ? RasterTolerance : 0.0);
+
+    // rows in (ymin, ymax], clipped to the slice
+    int iy1 = 0;
+    int iy2 = m_Height - 1;
+    if (ymax < iy1 || ymin >= iy2)
+      continue;
+    if (ymin >= iy1)
+      iy1 = static_cast<int>(std::floor(ymin)) + 1;
+    if (ymax < iy2)
+      iy2 = static_cast<int>(std::floor(ymax));
+
+    const double gradient = (x2 - x1) / (y2 - y1);
+    double delta = (iy1 - y1) * gradient;
+    for (int y = iy1; y <= iy2; ++y)
+    {
+      double x = x1 + delta;
+      delta += gradient;
+      x = std::min(std::max(x, xmin), xmax);
+
+      const int row = y - firstRow;
+      if (row >= 0 && row < static_cast<int>(rows.size()))
+        rows[row].push_back(x);
+    }
+  }
+}
+
+void mitk::PlanarFigureRasterizer::CrossingsToIntervals(std::vector<double> &crossings,
+                                                        std::vector<std::pair<int, int>> &intervals) const
+{
+  intervals.clear();
+  std::sort(crossings.begin(), crossings.end());
+
+  const int xmin = 0;
+  const int xmax = m_Width - 1;
+  int lastColumn = xmin - 1;
+  for (std::size_t k = 0; k + 1 < crossings.size(); k += 2)
+  {
+    const double x1 = crossings[k] - RasterTolerance;
+    const double x2 = crossings[k + 1] + RasterTolerance;
+    if (x2 < xmin || x1 >= xmax)
+      continue;
+
+    int r1 = xmin;
+    int r2 = xmax;
+    if (x1 >= xmin)
+      r1 = static_cast<int>(std::floor(x1)) + 1;
+    if (x2 < xmax)
+      r2 = static_cast<int>(std::floor(x2));
+    if (r1 <= lastColumn)
+      r1 = lastColumn + 1;
+
+    if (r2 >= r1)
+    {
+      intervals.emplace_back(r1, r2 + 1);
+      lastColumn = r2;
+    }
+  }
+}
+
+void mitk::PlanarFigureRasterizer::ComputeRuns(RunListType &runs) const
+{
+  runs.clear();
+
+  int firstRow, lastRow;
+  if (!this->GetRowRange(firstRow, lastRow))
+    return;
+
+  const std::size_t numberOfRows = lastRow - firstRow + 1;
+  std::vector<std::vector<double>> outlineRows(numberOfRows);
+  this->CollectCrossings(m_Polygons.front(), firstRow, outlineRows);
+
+  // every hole is scan converted on its own and subtracted, like a reversed stencil
+  std::vector<std::vector<std::vector<double>>> holeRows(m_Polygons.size() - 1);
+  for (std::size_t h = 1; h < m_Polygons.size(); ++h)
+  {
+    holeRows[h - 1].resize(numberOfRows);
+    this->CollectCrossings(m_Polygons[h], firstRow, holeRows[h - 1]);
+  }
+
+  std::vector<std::pair<int, int>> intervals;
+  std::vector<std::pair<int, int>> holeIntervals;
+  std::vector<std::pair<int, int>> remaining;
+  for (std::size_t row = 0; row < numberOfRows; ++row)
+  {
+    this->CrossingsToIntervals(outlineRows[row], intervals);
+
+    for (auto &hole : holeRows)
+    {
+      if (intervals.empty())
+        break;
+
+      this->CrossingsToIntervals(hole[row], holeIntervals);
+      if (holeIntervals.empty())
+        continue;
+
+      // both interval lists are sorted and disjoint
+      remaining.clear();
+      std::size_t h = 0;
+      for (auto interval : intervals)
+      {
+        while (h < holeIntervals.size() && holeIntervals[h].second <= interval.first)
+          ++h;
+        for (std::size_t k = h; k < holeIntervals.size() && holeIntervals[k].first < interval.second; ++k)
+        {
+          if (holeIntervals[k].first > interval.first)
+            remaining.emplace_back(interval.first, holeIntervals[k].first);
+          interval.first = std::max(interval.first, holeIntervals[k].second);
+        }
+        if (interval.first < interval.second)
+          remaining.push_back(interval);
+      }
+      intervals.swap(remaining);
+    }
+
+    for (const auto &interval : intervals)
+    {
+      AppendRun(runs, firstRow + static_cast<int>(row), interval.first, interval.second, 1.0);
+    }
+  }
+}
+
+void mitk::PlanarFigureRasterizer::ComputeCoverage(RunListType &runs) const
+{
+  runs.clear();
+  if (m_Polygons.empty() || m_Polygons.front().size() < 3 || m_Width <= 0 || m_Height <= 0)
+    return;
+
+  double bounds[4] = {m_Polygons.front().front()[0], m_Polygons.front().front()[0],
+                      m_Polygons.front().front()[1], m_Polygons.front().front()[1]};
+  for (const mitk::Point2D &point : m_Polygons.front())
+  {
+    bounds[0] = std::min(bounds[0], point[0]);
+    bounds[1] = std::max(bounds[1], point[0]);
+    bounds[2] = std::min(bounds[2], point[1]);
+    bounds[3] = std::max(bounds[3], point[1]);
+  }
+
+  const int firstColumn = std::max(0, static_cast<int>(std::floor(bounds[0] + 0.5)));
+  const int lastColumn = std::min(m_Width - 1, static_cast<int>(std::floor(bounds[1] + 0.5)));
+  const int firstRow = std::max(0, static_cast<int>(std::floor(bounds[2] + 0.5)));
+  const int lastRow = std::min(m_Height - 1, static_cast<int>(std::floor(bounds[3] + 0.5)));
+  if (firstColumn > lastColumn || firstRow > lastRow)
+    return;
+
+  // The area of the figure left of x = X inside a row strip is A(X) = sum over the edges of the integral of
+  // min(x, X) dy (Green's theorem), the coverage of a voxel is the difference of A at its left and right border.
+  // The outline is oriented counter clockwise and the holes clockwise, so the areas of holes are subtracted.
+  std::vector<double> orientation(m_Polygons.size());
+  for (std::size_t p = 0; p < m_Polygons.size(); ++p)
+  {
+    const double sign = SignedArea(m_Polygons[p]) < 0.0 ? -1.0 : 1.0;
+    orientation[p] = p == 0 ? sign : -sign;
+  }
+
+  // border k lies at X = firstColumn - 0.5 + k
+  const int numberOfBorders = lastColumn - firstColumn + 2;
+  std::vector<double> slope(numberOfBorders + 1);    // difference array of the dy of edges right of the border
+  std::vector<double> constant(numberOfBorders + 1); // difference array of the integrals of edges left of the border
+  std::vector<double> area(numberOfBorders);         // exact terms for borders crossing an edge
+
+  const double x0 = firstColumn - 0.5;
+
+  for (int row = firstRow; row <= lastRow; ++row)
+  {
+    std::fill(slope.begin(), slope.end(), 0.0);
+    std::fill(constant.begin(), constant.end(), 0.0);
+    std::fill(area.begin(), area.end(), 0.0);
+
+    const double stripBottom = row - 0.5;
+    const double stripTop = row + 0.5;
+    bool touched = false;
+
+    for (std::size_t p = 0; p < m_Polygons.size(); ++p)
+    {
+      const PolygonType &polygon = m_Polygons[p];
+      const std::size_t n = polygon.size();
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        const mitk::Point2D &a = polygon[i];
+        const mitk::Point2D &b = polygon[(i + 1) % n];
+        if (a[1] == b[1] || std::max(a[1], b[1]) <= stripBottom || std::min(a[1], b[1]) >= stripTop)
+          continue;
+
+        // clip the edge to the strip
+        const double t0 = std::max(0.0, std::min(1.0, ((a[1] < b[1] ? stripBottom : stripTop) - a[1]) / (b[1] - a[1])));
+        const double t1 = std::max(0.0, std::min(1.0, ((a[1] < b[1] ? stripTop : stripBottom) - a[1]) / (b[1] - a[1])));
+        const double xa = a[0] + t0 * (b[0] - a[0]);
+        const double xb = a[0] + t1 * (b[0] - a[0]);
+        const double dy = orientation[p] * (t1 - t0) * (b[1] - a[1]);
+        if (dy == 0.0)
+          continue;
+        touched = true;
+
+        const double xl = std::min(xa, xb);
+        const double xr = std::max(xa, xb);
+
+        // borders left of the edge see X * dy, borders right of it the full integral of x dy
+        const int kl = std::min(numberOfBorders - 1, static_cast<int>(std::floor(xl - x0))); // last X <= xl
+        const int kr = std::max(kl + 1, static_cast<int>(std::ceil(xr - x0)));                // first X >= xr
+        if (kl >= 0)
+        {
+          slope[0] += dy;
+          slope[kl + 1] -= dy;
+        }
+        if (kr < numberOfBorders)
+        {
+          constant[std::max(0, kr)] += dy * 0.5 * (xa + xb);
+        }
+
+        // borders strictly inside the x range of the edge split it
+        for (int k = std::max(0, kl + 1); k < std::min(numberOfBorders, kr); ++k)
+        {
+          const double X = x0 + k;
+          const double s = (X - xa) / (xb - xa); // parameter of the split, xa != xb here
+          if (xa < xb)
+            area[k] += dy * (s * (xa + 0.5 * s * (xb - xa)) + X * (1.0 - s));
+          else
+            area[k] += dy * ((1.0 - s) * (xa + 0.5 * (1.0 + s) * (xb - xa)) + X * s);
+        }
+      }
+    }
+
+    if (!touched)
+      continue;
+
+    double slopeSum = 0.0;
+    double constantSum = 0.0;
+    double previous = 0.0;
+    for (int k = 0; k < numberOfBorders; ++k)
+    {
+      slopeSum += slope[k];
+      constantSum += constant[k];
+      const double current = (x0 + k) * slopeSum + constantSum + area[k];
+
+      if (k > 0)
+      {
+        const double coverage = current - previous;
+        const int column = firstColumn + k - 1;
+        if (coverage >= 1.0 - CoverageEpsilon)
+          AppendRun(runs, row, column, column + 1, 1.0);
+        else if (coverage > CoverageEpsilon)
+          AppendRun(runs, row, column, column + 1, coverage);
+      }
+      previous = current;
+    }
+  }
+}
+
+void mitk::PlanarFigureRasterizer::RasterizePolyLine(const std::vector<itk::Index<2>> &indices,
+                                                     RunListType &runs) const
+{
+  runs.clear();
+
+  // (y, x) of all visited voxels, a voxel can be visited by several segments
+  std::vector<std::pair<int, int>> voxels;
+
+  for (std::size_t i = 0; i + 1 < indices.size(); ++i)
+  {
+    const itk::Index<2> &start = indices[i];
+    const itk::Index<2> &end = indices[i + 1];
+    if (start[0] < 0 || start[1] < 0 || start[0] >= m_Width || start[1] >= m_Height)
+      continue;
+
+    // Bresenham along the main direction, the way itk::LineConstIterator does it
+    long difference[2] = {end[0] - start[0], end[1] - start[1]};
+    long step[2] = {difference[0] < 0 ? -1 : 1, difference[1] < 0 ? -1 : 1};
+    const int mainDirection = std::labs(difference[1]) > std::labs(difference[0]) ? 1 : 0;
+    const int otherDirection = 1 - mainDirection;
+    const long maximalError = std::labs(difference[mainDirection]);
+    const long incrementError = 2 * std::labs(difference[otherDirection]);
+    const long lastMain = end[mainDirection] + step[mainDirection];
+
+    long current[2] = {start[0], start[1]};
+    long accumulatedError = 0;
+    while (true)
+    {
+      voxels.emplace_back(static_cast<int>(current[1]), static_cast<int>(current[0]));
+
+      current[mainDirection] += step[mainDirection];
+      accumulatedError += incrementError;
+      if (accumulatedError >= maximalError)
+      {
+        current[otherDirection] += step[otherDirection];
+        accumulatedError -= 2 * maximalError;
+      }
+
+      if (current[mainDirection] == lastMain || current[0] < 0 || current[1] < 0 || current[0] >= m_Width ||
+          current[1] >= m_Height)
+        break;
+    }
+  }
+
+  std::sort(voxels.begin(), voxels.end());
+  voxels.erase(std::unique(voxels.begin(), voxels.end()), voxels.end());
+  for (const auto &voxel : voxels)
+  {
+    AppendRun(runs, voxel.first, voxel.second, voxel.second + 1, 1.0);
+  }
+}
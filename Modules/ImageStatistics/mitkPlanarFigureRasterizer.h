@@ -0,0 +1,103 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef MITKPLANARFIGURERASTERIZER
+#define MITKPLANARFIGURERASTERIZER
+
+#include <MitkImageStatisticsExports.h>
+#include <mitkNumericTypes.h>
+
+#include <itkIndex.h>
+
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+   * @brief Scanline rasterization of planar figure outlines into run lists of a 2D image slice.
+   *
+   * All coordinates are continuous index coordinates of the slice, i.e. the voxel (x, y) is centered at (x, y) and
+   * covers [x - 0.5, x + 0.5] x [y - 0.5, y + 0.5]. The first polygon added is the outline of the figure, all
+   * further polygons are holes. The polygons are closed implicitly.
+   *
+   * ComputeRuns() selects the voxels whose centers lie inside the outline and outside of all holes, with the same
+   * rules as vtkLassoStencilSource (which was used to create planar figure masks before), except that horizontal edges
+   * on a voxel row are not taken for extrema of the outline. ComputeCoverage() computes the exact area of every voxel
+   * covered by the figure instead.
+   *
+   * Runs are sorted by row and column and do not overlap. The cost is linear in the number of rows and edges of
+   * the figure plus the number of runs, no mask image of the slice is allocated.
+   */
+  class MITKIMAGESTATISTICS_EXPORT PlanarFigureRasterizer
+  {
+  public:
+    /** Voxels XBegin ... XEnd - 1 of row Y, all with the same weight (the covered fraction of a voxel) */
+    struct Run
+    {
+      int Y;
+      int XBegin;
+      int XEnd;
+      double Weight;
+    };
+
+    typedef std::vector<Run> RunListType;
+    typedef std::vector<mitk::Point2D> PolygonType;
+
+    PlanarFigureRasterizer();
+
+    /** Size of the slice in voxels, runs are clipped to it */
+    void SetSize(int width, int height);
+
+    /** Adds the outline (first call) or a hole (further calls) */
+    void AddPolygon(const PolygonType &polygon);
+
+    void ClearPolygons();
+
+    /** Voxels with their center inside the figure, all runs have weight 1 */
+    void ComputeRuns(RunListType &runs) const;
+
+    /**
+     * @brief Voxels covered by the figure with the covered fraction of their area as weight.
+     * Completely covered voxels are merged into runs of weight 1, every partially covered voxel is a run of its own.
+     */
+    void ComputeCoverage(RunListType &runs) const;
+
+    /**
+     * @brief Voxels on the open poly line through the given voxel indices, like itk::LineIterator visits them
+     * for every segment. Indices outside of the slice end a segment.
+     */
+    void RasterizePolyLine(const std::vector<itk::Index<2>> &indices, RunListType &runs) const;
+
+    /** Number of voxels in a run list */
+    static unsigned long GetNumberOfVoxels(const RunListType &runs);
+
+  private:
+    // x positions where the edges of a polygon cross the integer rows firstRow ... firstRow + rows.size() - 1
+    void CollectCrossings(const PolygonType &polygon, int firstRow, std::vector<std::vector<double>> &rows) const;
+
+    // column intervals of one row, in the way vtkImageStencilRaster converts crossings to extents
+    void CrossingsToIntervals(std::vector<double> &crossings, std::vector<std::pair<int, int>> &intervals) const;
+
+    bool GetRowRange(int &firstRow, int &lastRow) const;
+
+    int m_Width;
+    int m_Height;
+    std::vector<PolygonType> m_Polygons;
+  };
+}
+
+#endif // MITKPLANARFIGURERASTERIZER
@@ -15,7 +15,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 ===================================================================*/
 
 #include <mitkIOUtil.h>
+#include <mitkImageReadAccessor.h>
 #include <mitkImageStatisticsHolder.h>
+#include <mitkImageWriteAccessor.h>
 #include <mitkLabelSetImage.h>
 #include <mitkTestFixture.h>
 #include <mitkTestingMacros.h>
@@ -38,6 +40,7 @@ class mitkLabelSetImageTestSuite : public mitk::TestFixture
   MITK_TEST(TestRemoveLayer);
   MITK_TEST(TestRemoveLabels);
   MITK_TEST(TestMergeLabel);
+  MITK_TEST(TestSparseLayerStorage);
   // TODO check it these functionalities can be moved into a process object
   //  MITK_TEST(TestMergeLabels);
   //  MITK_TEST(TestConcatenate);
@@ -443,6 +446,70 @@ public:
     // Check if merge label has 507 + 823 = 1330 pixels
     CPPUNIT_ASSERT_MESSAGE("Label with value 7 was not remove from the image", m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 1330);
   }
+
+  void TestSparseLayerStorage()
+  {
+    typedef mitk::LabelSetImage::PixelType PixelType;
+
+    m_LabelSetImage = mitk::LabelSetImage::New();
+    mitk::Image::Pointer regularImage = mitk::Image::New();
+    unsigned int dimensions[3] = {32, 24, 16};
+    regularImage->Initialize(mitk::MakeScalarPixelType<int>(), 3, dimensions);
+    m_LabelSetImage->Initialize(regularImage);
+    m_LabelSetImage->SetSparseLayerStorage(true);
+
+    // label 1 fills the box [2,9]x[3,5]x[4,4], label 2 a single row of [10,19]x[7]x[8]
+    std::vector<PixelType> expected(32 * 24 * 16, 0);
+    for (unsigned int y = 3; y <= 5; ++y)
+      for (unsigned int x = 2; x <= 9; ++x)
+        expected[(4 * 24 + y) * 32 + x] = 1;
+    for (unsigned int x = 10; x <= 19; ++x)
+      expected[(8 * 24 + 7) * 32 + x] = 2;
+    {
+      mitk::ImageWriteAccessor accessor(static_cast<mitk::Image *>(m_LabelSetImage));
+      std::copy(expected.begin(), expected.end(), static_cast<PixelType *>(accessor.GetData()));
+    }
+    m_LabelSetImage->Modified();
+
+    const mitk::LabelSetImageSparseLayer::LabelStatisticsMapType &statistics =
+      m_LabelSetImage->GetActiveLayerLabelStatistics();
+    CPPUNIT_ASSERT_MESSAGE("Wrong number of labels in statistics", statistics.size() == 2);
+    CPPUNIT_ASSERT_MESSAGE("Wrong voxel count of label 1", statistics.at(1).VoxelCount == 24);
+    CPPUNIT_ASSERT_MESSAGE("Wrong bounding box of label 1",
+                           statistics.at(1).BoundingBoxMin[0] == 2 && statistics.at(1).BoundingBoxMax[0] == 9 &&
+                             statistics.at(1).BoundingBoxMin[1] == 3 && statistics.at(1).BoundingBoxMax[1] == 5 &&
+                             statistics.at(1).BoundingBoxMin[2] == 4 && statistics.at(1).BoundingBoxMax[2] == 4);
+
+    // switching layers has to restore the working image of the previous layer
+    m_LabelSetImage->AddLayer();
+    CPPUNIT_ASSERT_MESSAGE("New sparse layer is not empty", m_LabelSetImage->GetActiveLayerLabelStatistics().empty());
+    m_LabelSetImage->SetActiveLayer(0);
+    {
+      mitk::ImageReadAccessor accessor(static_cast<mitk::Image *>(m_LabelSetImage));
+      auto data = static_cast<const PixelType *>(accessor.GetData());
+      CPPUNIT_ASSERT_MESSAGE("Working image differs after layer switch",
+                             std::equal(expected.begin(), expected.end(), data));
+    }
+
+    // inactive layers are turned into dense images on request
+    const mitk::Image *layerImage = m_LabelSetImage->GetLayerImage(1);
+    CPPUNIT_ASSERT_MESSAGE("Sparse layer could not be converted to an image", layerImage != nullptr);
+    CPPUNIT_ASSERT_MESSAGE("Converted sparse layer is not empty",
+                           layerImage->GetStatistics()->GetScalarValueMax() == 0);
+
+    m_LabelSetImage->MergeLabel(1, 2);
+    CPPUNIT_ASSERT_MESSAGE("Label 2 was not merged into label 1",
+                           m_LabelSetImage->GetActiveLayerLabelStatistics().size() == 1 &&
+                             m_LabelSetImage->GetActiveLayerLabelStatistics().at(1).VoxelCount == 34);
+    CPPUNIT_ASSERT_MESSAGE("Label 2 was not merged into label 1 in the image",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 1 &&
+                             m_LabelSetImage->GetStatistics()->GetCountOfMaxValuedVoxels() == 34);
+
+    m_LabelSetImage->EraseLabel(1);
+    CPPUNIT_ASSERT_MESSAGE("Label 1 was not erased", m_LabelSetImage->GetActiveLayerLabelStatistics().empty());
+    CPPUNIT_ASSERT_MESSAGE("Label 1 was not erased from the image",
+                           m_LabelSetImage->GetStatistics()->GetScalarValueMax() == 0);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImage)
@@ -0,0 +1,153 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkITKImageImport.h>
+#include <mitkLabelSetImageToSurfaceFilter.h>
+#include <mitkTestFixture.h>
+#include <mitkTestingMacros.h>
+
+#include <itkImage.h>
+
+#include <vtkCellArray.h>
+
+#include <map>
+#include <utility>
+
+class mitkLabelSetImageToSurfaceFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkLabelSetImageToSurfaceFilterTestSuite);
+  MITK_TEST(TestOneSurfacePerLabel);
+  MITK_TEST(TestSurfacesAreClosed);
+  MITK_TEST(TestDecimation);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<mitk::LabelSetImageToSurfaceFilter::LabelType, 3> LabelImageType;
+
+  mitk::Image::Pointer m_Image;
+
+  static void FillBox(LabelImageType *image, const int minimum[3], const int maximum[3], unsigned short label)
+  {
+    LabelImageType::IndexType index;
+    for (index[2] = minimum[2]; index[2] <= maximum[2]; ++index[2])
+      for (index[1] = minimum[1]; index[1] <= maximum[1]; ++index[1])
+        for (index[0] = minimum[0]; index[0] <= maximum[0]; ++index[0])
+          image->SetPixel(index, label);
+  }
+
+  static bool IsClosed(vtkPolyData *polyData)
+  {
+    // every directed edge of a closed, consistently oriented surface has exactly one reversed twin
+    std::map<std::pair<vtkIdType, vtkIdType>, int> edges;
+    vtkIdType numberOfPoints;
+    vtkIdType *ids(nullptr);
+    vtkCellArray *polys = polyData->GetPolys();
+    for (polys->InitTraversal(); polys->GetNextCell(numberOfPoints, ids);)
+    {
+      for (vtkIdType i = 0; i < numberOfPoints; ++i)
+      {
+        ++edges[std::make_pair(ids[i], ids[(i + 1) % numberOfPoints])];
+      }
+    }
+
+    for (const auto &edge : edges)
+    {
+      auto twin = edges.find(std::make_pair(edge.first.second, edge.first.first));
+      if (twin == edges.end() || twin->second != edge.second)
+        return false;
+    }
+    return !edges.empty();
+  }
+
+public:
+  void setUp() override
+  {
+    LabelImageType::Pointer image = LabelImageType::New();
+    LabelImageType::SizeType size;
+    size.Fill(32);
+    image->SetRegions(size);
+    image->Allocate();
+    image->FillBuffer(0);
+
+    const int box1Minimum[3] = {2, 3, 4};
+    const int box1Maximum[3] = {9, 8, 12};
+    FillBox(image, box1Minimum, box1Maximum, 1);
+
+    const int box2Minimum[3] = {15, 20, 10};
+    const int box2Maximum[3] = {28, 27, 19};
+    FillBox(image, box2Minimum, box2Maximum, 3);
+
+    m_Image = mitk::GrabItkImageMemory(image);
+  }
+
+  void tearDown() override { m_Image = nullptr; }
+
+  void TestOneSurfacePerLabel()
+  {
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Number of labels found", std::size_t(2), filter->GetAvailableLabels().size());
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Voxels of label 1", 8ul * 6ul * 9ul, filter->GetAvailableLabels().at(1));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Label of the first output", 1, static_cast<int>(filter->GetLabelOfOutput(0)));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE("Label of the second output", 3, static_cast<int>(filter->GetLabelOfOutput(1)));
+
+    // the surface of a box lies on the boundary of its voxels
+    double bounds[6];
+    filter->GetOutput(1)->GetVtkPolyData()->GetBounds(bounds);
+    const double expected[6] = {14.5, 28.5, 19.5, 27.5, 9.5, 19.5};
+    for (int i = 0; i < 6; ++i)
+    {
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE("Bounds of the surface of label 3", expected[i], bounds[i], mitk::eps);
+    }
+  }
+
+  void TestSurfacesAreClosed()
+  {
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->SetUseSmoothing(1);
+    filter->Update();
+
+    for (unsigned int i = 0; i < 2; ++i)
+    {
+      CPPUNIT_ASSERT_MESSAGE("Surface of a label is not closed", IsClosed(filter->GetOutput(i)->GetVtkPolyData()));
+    }
+  }
+
+  void TestDecimation()
+  {
+    auto filter = mitk::LabelSetImageToSurfaceFilter::New();
+    filter->SetInput(m_Image);
+    filter->GenerateAllLabelsOn();
+    filter->Update();
+    const vtkIdType fullNumberOfPolys = filter->GetOutput(1)->GetVtkPolyData()->GetNumberOfPolys();
+
+    auto decimatingFilter = mitk::LabelSetImageToSurfaceFilter::New();
+    decimatingFilter->SetInput(m_Image);
+    decimatingFilter->GenerateAllLabelsOn();
+    decimatingFilter->SetTargetReduction(0.5);
+    decimatingFilter->Update();
+
+    CPPUNIT_ASSERT_MESSAGE("Decimation did not reduce the number of triangles",
+                           decimatingFilter->GetOutput(1)->GetVtkPolyData()->GetNumberOfPolys() < fullNumberOfPolys);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkLabelSetImageToSurfaceFilter)
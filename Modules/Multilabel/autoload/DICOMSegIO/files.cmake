@@ -2,3 +2,7 @@ set(CPP_FILES
   mitkDICOMSegmentationIO.cpp
   mitkDICOMQIIOActivator.cpp
 )
+
+set(RESOURCE_FILES
+  manifest.json
+)
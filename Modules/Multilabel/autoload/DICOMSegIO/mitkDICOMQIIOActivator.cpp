@@ -23,6 +23,9 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkDICOMSegmentationIO.h"
 
 #include <mitkDICOMQIIOMimeTypes.h>
+#include <mitkLazyFileIORegistration.h>
+
+#include <memory>
 
 namespace mitk
 {
@@ -32,6 +35,7 @@ namespace mitk
   class DICOMQIIOActivator : public us::ModuleActivator
   {
     std::vector<AbstractFileIO *> m_FileIOs;
+    std::unique_ptr<LazyFileIORegistration> m_FileIORegistration;
 
   public:
     void Load(us::ModuleContext * context) override
@@ -48,10 +52,13 @@ namespace mitk
         context->RegisterService(*mimeTypeIter, props);
       }
 
-      m_FileIOs.push_back(new DICOMSegmentationIO());
+      // see resource/manifest.json
+      m_FileIORegistration.reset(
+        new LazyFileIORegistration(context, "dicomseg", [this]() { m_FileIOs.push_back(new DICOMSegmentationIO()); }));
     }
     void Unload(us::ModuleContext *) override
     {
+      m_FileIORegistration.reset();
       for (auto &elem : m_FileIOs)
       {
         delete elem;
@@ -6,3 +6,6 @@ set(CPP_FILES
   mitkMultilabelActivator.cpp
 )
 
+set(RESOURCE_FILES
+  manifest.json
+)
@@ -19,8 +19,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <usModuleActivator.h>
 #include <usModuleContext.h>
 
+#include <mitkLazyFileIORegistration.h>
+
 #include "mitkLabelSetImageIO.h"
 
+#include <memory>
+
 namespace mitk
 {
   /**
@@ -29,14 +33,18 @@ namespace mitk
   class MultilabelIOModuleActivator : public us::ModuleActivator
   {
     std::vector<AbstractFileIO *> m_FileIOs;
+    std::unique_ptr<LazyFileIORegistration> m_FileIORegistration;
 
   public:
-    void Load(us::ModuleContext * /*context*/) override
+    void Load(us::ModuleContext *context) override
     {
-      m_FileIOs.push_back(new LabelSetImageIO());
+      // see resource/manifest.json
+      m_FileIORegistration.reset(
+        new LazyFileIORegistration(context, "multilabel", [this]() { m_FileIOs.push_back(new LabelSetImageIO()); }));
     }
     void Unload(us::ModuleContext *) override
     {
+      m_FileIORegistration.reset();
       for (auto &elem : m_FileIOs)
       {
         delete elem;
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkImageAccessByItk.h"
 #include "mitkImageCast.h"
 #include "mitkImageReadAccessor.h"
+#include "mitkImageWriteAccessor.h"
 #include "mitkInteractionConst.h"
 #include "mitkLookupTableProperty.h"
 #include "mitkPadImageFilter.h"
@@ -43,8 +44,38 @@ void SetToZero(itk::Image<TPixel, VDimensions> *source)
   source->FillBuffer(0);
 }
 
+static void ReplaceLabelInBoundingBox(mitk::LabelSetImage::PixelType *buffer,
+                                      const unsigned int *dimensions,
+                                      const unsigned int *boundingBoxMin,
+                                      const unsigned int *boundingBoxMax,
+                                      mitk::LabelSetImage::PixelType sourcePixelValue,
+                                      mitk::LabelSetImage::PixelType pixelValue)
+{
+  for (unsigned int t = boundingBoxMin[3]; t <= boundingBoxMax[3]; ++t)
+  {
+    for (unsigned int z = boundingBoxMin[2]; z <= boundingBoxMax[2]; ++z)
+    {
+      for (unsigned int y = boundingBoxMin[1]; y <= boundingBoxMax[1]; ++y)
+      {
+        mitk::LabelSetImage::PixelType *row =
+          buffer + ((static_cast<size_t>(t) * dimensions[2] + z) * dimensions[1] + y) * dimensions[0];
+        for (unsigned int x = boundingBoxMin[0]; x <= boundingBoxMax[0]; ++x)
+        {
+          if (row[x] == sourcePixelValue)
+            row[x] = pixelValue;
+        }
+      }
+    }
+  }
+}
+
 mitk::LabelSetImage::LabelSetImage()
-  : mitk::Image(), m_ActiveLayer(0), m_activeLayerInvalid(false), m_ExteriorLabel(nullptr)
+  : mitk::Image(),
+    m_SparseLayerStorage(false),
+    m_ActiveLayerLabelStatisticsTime(0),
+    m_ActiveLayer(0),
+    m_activeLayerInvalid(false),
+    m_ExteriorLabel(nullptr)
 {
   // Iniitlaize Background Label
   mitk::Color color;
@@ -62,6 +93,9 @@ mitk::LabelSetImage::LabelSetImage()
 
 mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
   : Image(other),
+    m_SparseLayerContainer(other.m_SparseLayerContainer),
+    m_SparseLayerStorage(other.m_SparseLayerStorage),
+    m_ActiveLayerLabelStatisticsTime(0),
     m_ActiveLayer(other.GetActiveLayer()),
     m_activeLayerInvalid(false),
     m_ExteriorLabel(other.GetExteriorLabel()->Clone())
@@ -76,8 +110,9 @@ mitk::LabelSetImage::LabelSetImage(const mitk::LabelSetImage &other)
     lsClone->AddObserver(itk::ModifiedEvent(), command);
     m_LabelSetContainer.push_back(lsClone);
 
-    // clone layer Image data
-    mitk::Image::Pointer liClone = other.GetLayerImage(i)->Clone();
+    // clone layer Image data, sparse layers have already been copied above
+    mitk::Image::Pointer liClone =
+      other.m_LayerContainer[i].IsNotNull() ? other.m_LayerContainer[i]->Clone() : mitk::Image::Pointer();
     m_LayerContainer.push_back(liClone);
   }
 }
@@ -142,12 +177,148 @@ mitk::LabelSetImage::~LabelSetImage()
 
 mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer)
 {
+  if (m_LayerContainer[layer].IsNull())
+    this->MaterializeLayer(layer);
   return m_LayerContainer[layer];
 }
 
 const mitk::Image *mitk::LabelSetImage::GetLayerImage(unsigned int layer) const
 {
-  return m_LayerContainer[layer];
+  // decoding a sparse layer does not change the content of the label set image
+  return const_cast<Self *>(this)->GetLayerImage(layer);
+}
+
+void mitk::LabelSetImage::SetSparseLayerStorage(bool sparse)
+{
+  if (sparse == m_SparseLayerStorage)
+    return;
+
+  m_SparseLayerStorage = sparse;
+
+  const mitk::PixelType pixelType(mitk::MakeScalarPixelType<PixelType>());
+  unsigned int dimensions[4];
+  this->GetLayerDimensions(dimensions);
+
+  for (unsigned int layer = 0; layer < m_LayerContainer.size(); ++layer)
+  {
+    if (!sparse && m_LayerContainer[layer].IsNull())
+    {
+      this->MaterializeLayer(layer);
+    }
+    else if (sparse && m_LayerContainer[layer].IsNotNull() && m_LayerContainer[layer]->GetPixelType() == pixelType)
+    {
+      mitk::ImageReadAccessor accessor(m_LayerContainer[layer].GetPointer());
+      m_SparseLayerContainer[layer].Encode(static_cast<const PixelType *>(accessor.GetData()), dimensions);
+      m_LayerContainer[layer] = nullptr;
+    }
+  }
+}
+
+bool mitk::LabelSetImage::GetSparseLayerStorage() const
+{
+  return m_SparseLayerStorage;
+}
+
+const mitk::LabelSetImageSparseLayer::LabelStatisticsMapType &mitk::LabelSetImage::GetActiveLayerLabelStatistics()
+{
+  this->UpdateActiveLayerLabelStatistics();
+  return m_ActiveLayerLabelStatistics;
+}
+
+void mitk::LabelSetImage::GetLayerDimensions(unsigned int *dimensions) const
+{
+  for (unsigned int dim = 0; dim < 4; ++dim)
+  {
+    dimensions[dim] = dim < this->GetDimension() ? this->GetDimension(dim) : 1;
+  }
+}
+
+void mitk::LabelSetImage::EncodeActiveLayer()
+{
+  unsigned int dimensions[4];
+  this->GetLayerDimensions(dimensions);
+
+  mitk::ImageReadAccessor accessor(this);
+  m_SparseLayerContainer[GetActiveLayer()].Encode(static_cast<const PixelType *>(accessor.GetData()), dimensions);
+  m_LayerContainer[GetActiveLayer()] = nullptr;
+}
+
+void mitk::LabelSetImage::DecodeActiveLayer()
+{
+  const LabelSetImageSparseLayer &sparseLayer = m_SparseLayerContainer[GetActiveLayer()];
+  {
+    mitk::ImageWriteAccessor accessor(this);
+    sparseLayer.Decode(static_cast<PixelType *>(accessor.GetData()));
+  }
+  // the statistics become valid with the Modified() call at the end of SetActiveLayer
+  m_ActiveLayerLabelStatistics = sparseLayer.GetLabelStatistics();
+}
+
+void mitk::LabelSetImage::MaterializeLayer(unsigned int layer)
+{
+  mitk::Image::Pointer layerImage = mitk::Image::New();
+  layerImage->Initialize(this->GetPixelType(),
+                         this->GetDimension(),
+                         this->GetDimensions(),
+                         this->GetImageDescriptor()->GetNumberOfChannels());
+  layerImage->SetTimeGeometry(this->GetTimeGeometry()->Clone());
+  {
+    mitk::ImageWriteAccessor accessor(layerImage);
+    m_SparseLayerContainer[layer].Decode(static_cast<PixelType *>(accessor.GetData()));
+  }
+  m_LayerContainer[layer] = layerImage;
+  m_SparseLayerContainer[layer] = LabelSetImageSparseLayer();
+}
+
+void mitk::LabelSetImage::UpdateActiveLayerLabelStatistics()
+{
+  if (m_ActiveLayerLabelStatisticsTime == this->GetMTime())
+    return;
+
+  unsigned int dimensions[4];
+  this->GetLayerDimensions(dimensions);
+
+  mitk::ImageReadAccessor accessor(this);
+  LabelSetImageSparseLayer::ComputeLabelStatistics(
+    static_cast<const PixelType *>(accessor.GetData()), dimensions, m_ActiveLayerLabelStatistics);
+  m_ActiveLayerLabelStatisticsTime = this->GetMTime();
+}
+
+void mitk::LabelSetImage::ReplaceLabelInActiveLayer(PixelType sourcePixelValue, PixelType pixelValue)
+{
+  if (sourcePixelValue == pixelValue)
+    return;
+
+  unsigned int dimensions[4];
+  this->GetLayerDimensions(dimensions);
+
+  mitk::ImageWriteAccessor accessor(this);
+  auto *buffer = static_cast<PixelType *>(accessor.GetData());
+
+  if (sourcePixelValue == 0)
+  {
+    // the exterior is not tracked, so it has to be replaced in the whole volume
+    const unsigned int boundingBoxMin[4] = {0, 0, 0, 0};
+    const unsigned int boundingBoxMax[4] = {dimensions[0] - 1, dimensions[1] - 1, dimensions[2] - 1, dimensions[3] - 1};
+    ReplaceLabelInBoundingBox(buffer, dimensions, boundingBoxMin, boundingBoxMax, sourcePixelValue, pixelValue);
+    LabelSetImageSparseLayer::ComputeLabelStatistics(buffer, dimensions, m_ActiveLayerLabelStatistics);
+    return;
+  }
+
+  auto sourceStatistics = m_ActiveLayerLabelStatistics.find(sourcePixelValue);
+  if (sourceStatistics == m_ActiveLayerLabelStatistics.end())
+    return;
+
+  ReplaceLabelInBoundingBox(buffer,
+                            dimensions,
+                            sourceStatistics->second.BoundingBoxMin,
+                            sourceStatistics->second.BoundingBoxMax,
+                            sourcePixelValue,
+                            pixelValue);
+
+  if (pixelValue != 0)
+    m_ActiveLayerLabelStatistics[pixelValue].Merge(sourceStatistics->second);
+  m_ActiveLayerLabelStatistics.erase(sourceStatistics);
 }
 
 unsigned int mitk::LabelSetImage::GetActiveLayer() const
@@ -180,6 +351,7 @@ void mitk::LabelSetImage::RemoveLayer()
   // remove labelset and image data
   m_LabelSetContainer.erase(m_LabelSetContainer.begin() + layerToDelete);
   m_LayerContainer.erase(m_LayerContainer.begin() + layerToDelete);
+  m_SparseLayerContainer.erase(m_SparseLayerContainer.begin() + layerToDelete);
 
   if (layerToDelete == 0)
   {
@@ -191,6 +363,12 @@ void mitk::LabelSetImage::RemoveLayer()
 
 unsigned int mitk::LabelSetImage::AddLayer(mitk::LabelSet::Pointer lset)
 {
+  if (m_SparseLayerStorage)
+  {
+    // an empty sparse layer, nothing has to be allocated until the layer is activated
+    return this->AddLayer(mitk::Image::Pointer(), lset);
+  }
+
   mitk::Image::Pointer newImage = mitk::Image::New();
   newImage->Initialize(this->GetPixelType(),
                        this->GetDimension(),
@@ -214,6 +392,11 @@ unsigned int mitk::LabelSetImage::AddLayer(mitk::LabelSet::Pointer lset)
 
 unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk::LabelSet::Pointer lset)
 {
+  if (layerImage.IsNull() && !m_SparseLayerStorage)
+  {
+    mitkThrow() << "Trying to add an invalid layer image.";
+  }
+
   unsigned int newLabelSetId = m_LayerContainer.size();
 
   // Add labelset to layer
@@ -235,6 +418,16 @@ unsigned int mitk::LabelSetImage::AddLayer(mitk::Image::Pointer layerImage, mitk
 
   // push a new working image for the new layer
   m_LayerContainer.push_back(layerImage);
+  if (layerImage.IsNull())
+  {
+    unsigned int dimensions[4];
+    this->GetLayerDimensions(dimensions);
+    m_SparseLayerContainer.push_back(LabelSetImageSparseLayer(dimensions));
+  }
+  else
+  {
+    m_SparseLayerContainer.push_back(LabelSetImageSparseLayer());
+  }
 
   // push a new labelset for the new layer
   m_LabelSetContainer.push_back(ls);
@@ -277,6 +470,7 @@ void mitk::LabelSetImage::AddLabelSetToLayer(const unsigned int layerIdx, const
 
 void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
 {
+  bool decodedFromSparseLayer = false;
   try
   {
     if (4 == this->GetDimension())
@@ -290,12 +484,24 @@ void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
           // We should not write the invalid layer back to the vector
           m_activeLayerInvalid = false;
         }
+        else if (m_SparseLayerStorage)
+        {
+          this->EncodeActiveLayer();
+        }
         else
         {
           AccessFixedDimensionByItk_n(this, ImageToLayerContainerProcessing, 4, (GetActiveLayer()));
         }
         m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessFixedDimensionByItk_n(this, LayerContainerToImageProcessing, 4, (GetActiveLayer()));
+        if (m_LayerContainer[GetActiveLayer()].IsNull())
+        {
+          this->DecodeActiveLayer();
+          decodedFromSparseLayer = true;
+        }
+        else
+        {
+          AccessFixedDimensionByItk_n(this, LayerContainerToImageProcessing, 4, (GetActiveLayer()));
+        }
 
         AfterChangeLayerEvent.Send();
       }
@@ -311,12 +517,24 @@ void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
           // We should not write the invalid layer back to the vector
           m_activeLayerInvalid = false;
         }
+        else if (m_SparseLayerStorage)
+        {
+          this->EncodeActiveLayer();
+        }
         else
         {
           AccessByItk_1(this, ImageToLayerContainerProcessing, GetActiveLayer());
         }
         m_ActiveLayer = layer; // only at this place m_ActiveLayer should be manipulated!!! Use Getter and Setter
-        AccessByItk_1(this, LayerContainerToImageProcessing, GetActiveLayer());
+        if (m_LayerContainer[GetActiveLayer()].IsNull())
+        {
+          this->DecodeActiveLayer();
+          decodedFromSparseLayer = true;
+        }
+        else
+        {
+          AccessByItk_1(this, LayerContainerToImageProcessing, GetActiveLayer());
+        }
 
         AfterChangeLayerEvent.Send();
       }
@@ -327,6 +545,11 @@ void mitk::LabelSetImage::SetActiveLayer(unsigned int layer)
     mitkThrow() << e.GetDescription();
   }
   this->Modified();
+
+  if (decodedFromSparseLayer)
+  {
+    m_ActiveLayerLabelStatisticsTime = this->GetMTime();
+  }
 }
 
 void mitk::LabelSetImage::Concatenate(mitk::LabelSetImage *other)
@@ -396,6 +619,16 @@ bool mitk::LabelSetImage::ExistLabelSet(unsigned int layer) const
 
 void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixelValue, unsigned int layer)
 {
+  if (m_SparseLayerStorage)
+  {
+    this->UpdateActiveLayerLabelStatistics();
+    this->ReplaceLabelInActiveLayer(sourcePixelValue, pixelValue);
+    GetLabelSet(layer)->SetActiveLabel(pixelValue);
+    Modified();
+    m_ActiveLayerLabelStatisticsTime = this->GetMTime();
+    return;
+  }
+
   try
   {
     AccessByItk_2(this, MergeLabelProcessing, pixelValue, sourcePixelValue);
@@ -410,6 +643,19 @@ void mitk::LabelSetImage::MergeLabel(PixelType pixelValue, PixelType sourcePixel
 
 void mitk::LabelSetImage::MergeLabels(PixelType pixelValue, std::vector<PixelType>& vectorOfSourcePixelValues, unsigned int layer)
 {
+  if (m_SparseLayerStorage)
+  {
+    this->UpdateActiveLayerLabelStatistics();
+    for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
+    {
+      this->ReplaceLabelInActiveLayer(vectorOfSourcePixelValues[idx], pixelValue);
+    }
+    GetLabelSet(layer)->SetActiveLabel(pixelValue);
+    Modified();
+    m_ActiveLayerLabelStatisticsTime = this->GetMTime();
+    return;
+  }
+
   try
   {
     for (unsigned int idx = 0; idx < vectorOfSourcePixelValues.size(); idx++)
@@ -444,6 +690,15 @@ void mitk::LabelSetImage::EraseLabels(std::vector<PixelType> &VectorOfLabelPixel
 
 void mitk::LabelSetImage::EraseLabel(PixelType pixelValue, unsigned int layer)
 {
+  if (m_SparseLayerStorage)
+  {
+    this->UpdateActiveLayerLabelStatistics();
+    this->ReplaceLabelInActiveLayer(pixelValue, 0);
+    Modified();
+    m_ActiveLayerLabelStatisticsTime = this->GetMTime();
+    return;
+  }
+
   try
   {
     AccessByItk_2(this, EraseLabelProcessing, pixelValue, layer);
@@ -497,6 +752,57 @@ mitk::LabelSet *mitk::LabelSetImage::GetActiveLabelSet()
 
 void mitk::LabelSetImage::UpdateCenterOfMass(PixelType pixelValue, unsigned int layer)
 {
+  if (m_SparseLayerStorage && pixelValue != 0)
+  {
+    // same result as CalculateCenterOfMassProcessing: the middle voxel of the label in raster order, which is
+    // found by walking through the bounding box of the label only
+    this->UpdateActiveLayerLabelStatistics();
+
+    mitk::Point3D pos;
+    pos.Fill(0.0);
+
+    auto statistics = m_ActiveLayerLabelStatistics.find(pixelValue);
+    if (statistics != m_ActiveLayerLabelStatistics.end())
+    {
+      if (3 != this->GetDimension())
+        return;
+
+      unsigned int dimensions[4];
+      this->GetLayerDimensions(dimensions);
+      const unsigned int *boundingBoxMin = statistics->second.BoundingBoxMin;
+      const unsigned int *boundingBoxMax = statistics->second.BoundingBoxMax;
+
+      mitk::ImageReadAccessor accessor(this);
+      const auto *buffer = static_cast<const PixelType *>(accessor.GetData());
+
+      unsigned long remaining = statistics->second.VoxelCount / 2;
+      bool found = false;
+      for (unsigned int z = boundingBoxMin[2]; z <= boundingBoxMax[2] && !found; ++z)
+      {
+        for (unsigned int y = boundingBoxMin[1]; y <= boundingBoxMax[1] && !found; ++y)
+        {
+          const PixelType *row = buffer + (static_cast<size_t>(z) * dimensions[1] + y) * dimensions[0];
+          for (unsigned int x = boundingBoxMin[0]; x <= boundingBoxMax[0]; ++x)
+          {
+            if (row[x] == pixelValue && remaining-- == 0)
+            {
+              pos[0] = x;
+              pos[1] = y;
+              pos[2] = z;
+              found = true;
+              break;
+            }
+          }
+        }
+      }
+    }
+
+    GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassIndex(pos);
+    this->GetSlicedGeometry()->IndexToWorld(pos, pos); // TODO: TimeGeometry?
+    GetLabelSet(layer)->GetLabel(pixelValue)->SetCenterOfMassCoordinates(pos);
+    return;
+  }
+
   if (4 == this->GetDimension())
   {
     AccessFixedDimensionByItk_2(this, CalculateCenterOfMassProcessing, 4, pixelValue, layer);
@@ -19,6 +19,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkImage.h>
 #include <mitkLabelSet.h>
+#include <mitkLabelSetImageSparseLayer.h>
 
 #include <MitkMultilabelExports.h>
 
@@ -250,6 +251,30 @@ namespace mitk
 
     const mitk::Image *GetLayerImage(unsigned int layer) const;
 
+    /**
+    * \brief Enables or disables the sparse layer storage (disabled by default)
+    *
+    * In sparse mode all layers but the active one are kept run-length encoded (see mitk::LabelSetImageSparseLayer)
+    * instead of as dense images, and SetActiveLayer() encodes and decodes the working image directly instead of
+    * copying it through ITK iterators. In addition EraseLabel(), MergeLabel(), MergeLabels() and UpdateCenterOfMass()
+    * only visit the bounding box of the affected labels, see GetActiveLayerLabelStatistics().
+    *
+    * GetLayerImage() turns a sparse layer back into a dense image, which is encoded again the next time the layer
+    * is activated and left. Disabling the sparse mode converts all layers back into dense images.
+    */
+    void SetSparseLayerStorage(bool sparse);
+
+    bool GetSparseLayerStorage() const;
+
+    /**
+    * \brief Voxel count and index bounding box of every non-zero label of the working image
+    *
+    * The statistics are maintained incrementally by the label operations of this class and rebuilt by a single
+    * scan of the working image whenever the modification time of the image changed in between. Code writing
+    * label values into the image therefore has to call Modified() afterwards.
+    */
+    const LabelSetImageSparseLayer::LabelStatisticsMapType &GetActiveLayerLabelStatistics();
+
     void OnLabelSetModified();
 
     /**
@@ -309,8 +334,34 @@ namespace mitk
     template <typename LabelSetImageType, typename ImageType>
     void InitializeByLabeledImageProcessing(LabelSetImageType *input, ImageType *other);
 
+    /** Size of the label buffer in x, y, z and t, unused dimensions are 1 */
+    void GetLayerDimensions(unsigned int *dimensions) const;
+
+    /** Encodes the working image into the sparse container of the active layer and releases its dense copy */
+    void EncodeActiveLayer();
+
+    /** Decodes the sparse representation of the active layer into the working image */
+    void DecodeActiveLayer();
+
+    /** Replaces the sparse representation of a layer by a dense image */
+    void MaterializeLayer(unsigned int layer);
+
+    /** Rescans the working image if it was modified since the label statistics were updated last */
+    void UpdateActiveLayerLabelStatistics();
+
+    /** Replaces sourcePixelValue by pixelValue within the working image, using and updating the label statistics */
+    void ReplaceLabelInActiveLayer(PixelType sourcePixelValue, PixelType pixelValue);
+
     std::vector<LabelSet::Pointer> m_LabelSetContainer;
+
+    // a layer whose image pointer is null is stored in the sparse container at the same position
     std::vector<Image::Pointer> m_LayerContainer;
+    std::vector<LabelSetImageSparseLayer> m_SparseLayerContainer;
+
+    bool m_SparseLayerStorage;
+
+    LabelSetImageSparseLayer::LabelStatisticsMapType m_ActiveLayerLabelStatistics;
+    itk::ModifiedTimeType m_ActiveLayerLabelStatisticsTime;
 
     int m_ActiveLayer;
 
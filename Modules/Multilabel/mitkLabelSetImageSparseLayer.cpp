@@ -0,0 +1,189 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkLabelSetImageSparseLayer.h"
+
+#include <algorithm>
+#include <limits>
+
+mitk::LabelSetImageSparseLayer::LabelStatistics::LabelStatistics() : VoxelCount(0)
+{
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    BoundingBoxMin[i] = std::numeric_limits<unsigned int>::max();
+    BoundingBoxMax[i] = 0;
+  }
+}
+
+void mitk::LabelSetImageSparseLayer::LabelStatistics::AddRun(
+  unsigned int x, unsigned int length, unsigned int y, unsigned int z, unsigned int t)
+{
+  const unsigned int first[4] = {x, y, z, t};
+  const unsigned int last[4] = {x + length - 1, y, z, t};
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    BoundingBoxMin[i] = std::min(BoundingBoxMin[i], first[i]);
+    BoundingBoxMax[i] = std::max(BoundingBoxMax[i], last[i]);
+  }
+  VoxelCount += length;
+}
+
+void mitk::LabelSetImageSparseLayer::LabelStatistics::Merge(const LabelStatistics &other)
+{
+  if (other.VoxelCount == 0)
+    return;
+
+  for (unsigned int i = 0; i < 4; ++i)
+  {
+    BoundingBoxMin[i] = std::min(BoundingBoxMin[i], other.BoundingBoxMin[i]);
+    BoundingBoxMax[i] = std::max(BoundingBoxMax[i], other.BoundingBoxMax[i]);
+  }
+  VoxelCount += other.VoxelCount;
+}
+
+mitk::LabelSetImageSparseLayer::LabelSetImageSparseLayer()
+{
+  for (unsigned int i = 0; i < 4; ++i)
+    m_Dimensions[i] = 0;
+  m_SliceRunStart.push_back(0);
+}
+
+mitk::LabelSetImageSparseLayer::LabelSetImageSparseLayer(const unsigned int *dimensions)
+{
+  for (unsigned int i = 0; i < 4; ++i)
+    m_Dimensions[i] = dimensions[i];
+  m_SliceRunStart.assign(static_cast<unsigned long>(m_Dimensions[2]) * m_Dimensions[3] + 1, 0);
+}
+
+void mitk::LabelSetImageSparseLayer::Encode(const PixelType *buffer, const unsigned int *dimensions)
+{
+  for (unsigned int i = 0; i < 4; ++i)
+    m_Dimensions[i] = dimensions[i];
+
+  const unsigned int numberOfSlices = m_Dimensions[2] * m_Dimensions[3];
+
+  m_Runs.clear();
+  m_SliceRunStart.resize(numberOfSlices + 1);
+  m_LabelStatistics.clear();
+
+  // statistics are looked up once per run; consecutive runs of the same label skip the map lookup
+  LabelStatistics *lastStatistics = nullptr;
+  PixelType lastValue = 0;
+
+  const PixelType *row = buffer;
+  for (unsigned int slice = 0; slice < numberOfSlices; ++slice)
+  {
+    m_SliceRunStart[slice] = m_Runs.size();
+    const unsigned int z = slice % m_Dimensions[2];
+    const unsigned int t = slice / m_Dimensions[2];
+
+    for (unsigned int y = 0; y < m_Dimensions[1]; ++y, row += m_Dimensions[0])
+    {
+      unsigned int x = 0;
+      while (x < m_Dimensions[0])
+      {
+        const PixelType value = row[x];
+        unsigned int end = x + 1;
+        while (end < m_Dimensions[0] && row[end] == value)
+          ++end;
+
+        if (value != 0)
+        {
+          Run run;
+          run.Offset = y * m_Dimensions[0] + x;
+          run.Length = end - x;
+          run.Value = value;
+          m_Runs.push_back(run);
+
+          if (lastStatistics == nullptr || lastValue != value)
+          {
+            lastStatistics = &m_LabelStatistics[value];
+            lastValue = value;
+          }
+          lastStatistics->AddRun(x, end - x, y, z, t);
+        }
+        x = end;
+      }
+    }
+  }
+  m_SliceRunStart[numberOfSlices] = m_Runs.size();
+
+  // drop the slack of previous encodings, inactive layers may be kept for a long time
+  std::vector<Run>(m_Runs).swap(m_Runs);
+}
+
+void mitk::LabelSetImageSparseLayer::Decode(PixelType *buffer) const
+{
+  const unsigned long sliceSize = static_cast<unsigned long>(m_Dimensions[0]) * m_Dimensions[1];
+  const unsigned long numberOfSlices = static_cast<unsigned long>(m_Dimensions[2]) * m_Dimensions[3];
+
+  std::fill_n(buffer, sliceSize * numberOfSlices, PixelType(0));
+
+  for (unsigned long slice = 0; slice < numberOfSlices; ++slice)
+  {
+    PixelType *sliceBuffer = buffer + slice * sliceSize;
+    for (unsigned long r = m_SliceRunStart[slice]; r < m_SliceRunStart[slice + 1]; ++r)
+    {
+      const Run &run = m_Runs[r];
+      std::fill_n(sliceBuffer + run.Offset, run.Length, run.Value);
+    }
+  }
+}
+
+unsigned long mitk::LabelSetImageSparseLayer::GetMemorySize() const
+{
+  return m_Runs.capacity() * sizeof(Run) + m_SliceRunStart.capacity() * sizeof(unsigned long);
+}
+
+void mitk::LabelSetImageSparseLayer::ComputeLabelStatistics(const PixelType *buffer,
+                                                             const unsigned int *dimensions,
+                                                             LabelStatisticsMapType &statistics)
+{
+  statistics.clear();
+
+  LabelStatistics *lastStatistics = nullptr;
+  PixelType lastValue = 0;
+
+  const PixelType *row = buffer;
+  for (unsigned int t = 0; t < dimensions[3]; ++t)
+  {
+    for (unsigned int z = 0; z < dimensions[2]; ++z)
+    {
+      for (unsigned int y = 0; y < dimensions[1]; ++y, row += dimensions[0])
+      {
+        unsigned int x = 0;
+        while (x < dimensions[0])
+        {
+          const PixelType value = row[x];
+          unsigned int end = x + 1;
+          while (end < dimensions[0] && row[end] == value)
+            ++end;
+
+          if (value != 0)
+          {
+            if (lastStatistics == nullptr || lastValue != value)
+            {
+              lastStatistics = &statistics[value];
+              lastValue = value;
+            }
+            lastStatistics->AddRun(x, end - x, y, z, t);
+          }
+          x = end;
+        }
+      }
+    }
+  }
+}
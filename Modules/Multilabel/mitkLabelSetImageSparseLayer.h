@@ -0,0 +1,109 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef __mitkLabelSetImageSparseLayer_H_
+#define __mitkLabelSetImageSparseLayer_H_
+
+#include <mitkLabel.h>
+
+#include <MitkMultilabelExports.h>
+
+#include <map>
+#include <vector>
+
+namespace mitk
+{
+  //##Documentation
+  //## @brief Run-length encoded storage of one layer of a LabelSetImage.
+  //##
+  //## The layer is stored slice by slice. Every slice (one xy-plane of one time step) holds the runs of
+  //## non-zero label values of its image rows, so an empty slice costs nothing but its entry in the slice
+  //## table. Along with the runs, the number of voxels and the index bounding box of every label are kept,
+  //## which allows label operations to be restricted to the occupied part of the volume.
+  //##
+  //## Buffers passed to Encode() and Decode() are raw label buffers in the memory layout of mitk::Image,
+  //## i.e. x running fastest, followed by y, z and t. Unused dimensions have to be set to 1.
+  //## @ingroup Data
+  class MITKMULTILABEL_EXPORT LabelSetImageSparseLayer
+  {
+  public:
+    typedef mitk::Label::PixelType PixelType;
+
+    /** One run of equal, non-zero label values inside one image row */
+    struct Run
+    {
+      unsigned int Offset; // offset of the first voxel within the slice
+      unsigned int Length;
+      PixelType Value;
+    };
+
+    /** Number of voxels and inclusive index bounding box (x, y, z, t) of one label */
+    struct LabelStatistics
+    {
+      LabelStatistics();
+
+      void AddRun(unsigned int x, unsigned int length, unsigned int y, unsigned int z, unsigned int t);
+      void Merge(const LabelStatistics &other);
+
+      unsigned long VoxelCount;
+      unsigned int BoundingBoxMin[4];
+      unsigned int BoundingBoxMax[4];
+    };
+
+    typedef std::map<PixelType, LabelStatistics> LabelStatisticsMapType;
+
+    LabelSetImageSparseLayer();
+
+    /** Creates an empty (all exterior) layer of the given size */
+    explicit LabelSetImageSparseLayer(const unsigned int *dimensions);
+
+    /** Replaces the content of the layer by the run-length encoding of buffer */
+    void Encode(const PixelType *buffer, const unsigned int *dimensions);
+
+    /** Writes the complete layer to buffer, which has to be large enough for the encoded dimensions */
+    void Decode(PixelType *buffer) const;
+
+    const unsigned int *GetDimensions() const { return m_Dimensions; }
+    unsigned long GetNumberOfRuns() const { return m_Runs.size(); }
+    bool IsEmpty() const { return m_Runs.empty(); }
+
+    /** Memory used by the run and slice tables in bytes */
+    unsigned long GetMemorySize() const;
+
+    /** Statistics of all non-zero labels present in the layer */
+    const LabelStatisticsMapType &GetLabelStatistics() const { return m_LabelStatistics; }
+
+    /** \brief Collects the statistics of all non-zero labels in a raw label buffer
+    *
+    * The buffer is scanned row by row and the statistics are updated once per run, not once per voxel.
+    */
+    static void ComputeLabelStatistics(const PixelType *buffer,
+                                       const unsigned int *dimensions,
+                                       LabelStatisticsMapType &statistics);
+
+  protected:
+    unsigned int m_Dimensions[4];
+
+    // runs of slice s are stored at m_Runs[m_SliceRunStart[s]] ... m_Runs[m_SliceRunStart[s + 1] - 1]
+    std::vector<unsigned long> m_SliceRunStart;
+    std::vector<Run> m_Runs;
+
+    LabelStatisticsMapType m_LabelStatistics;
+  };
+
+} // namespace mitk
+
+#endif // __mitkLabelSetImageSparseLayer_H_
@@ -16,9 +16,12 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include <mitkLabelSetImageToSurfaceFilter.h>
 
+#include <mitkExceptionMacro.h>
 #include <mitkImageAccessByItk.h>
 #include <mitkImageCast.h>
 
+#include <algorithm>
+
 // itk
 #include <itkAntiAliasBinaryImageFilter.h>
 #include <itkAutoCropLabelMapFilter.h>
@@ -31,15 +34,36 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkSmoothingRecursiveGaussianImageFilter.h>
 
 // vtk
+#include <vtkCellArray.h>
 #include <vtkCleanPolyData.h>
 #include <vtkImageChangeInformation.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
 #include <vtkMarchingCubes.h>
+#include <vtkPoints.h>
+#include <vtkPolyDataNormals.h>
+#include <vtkQuadricDecimation.h>
 #include <vtkSmartPointer.h>
+#include <vtkWindowedSincPolyDataFilter.h>
+
+namespace
+{
+  // bounding box in buffer coordinates and number of voxels of a label
+  struct LabelBounds
+  {
+    int Minimum[3];
+    int Maximum[3];
+    unsigned long NumberOfVoxels;
+  };
+}
 
 mitk::LabelSetImageToSurfaceFilter::LabelSetImageToSurfaceFilter()
-  : m_GenerateAllLabels(false), m_RequestedLabel(1), m_BackgroundLabel(0), m_UseSmoothing(0), m_Sigma(0.1)
+  : m_GenerateAllLabels(false),
+    m_RequestedLabel(1),
+    m_BackgroundLabel(0),
+    m_UseSmoothing(0),
+    m_Sigma(0.1),
+    m_TargetReduction(0.0)
 {
 }
 
@@ -83,7 +107,302 @@ void mitk::LabelSetImageToSurfaceFilter::GenerateData()
   if (!outputSurface)
     return;
 
-  AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+  if (m_GenerateAllLabels)
+  {
+    AccessFixedDimensionByItk(inputImage, InternalProcessingAllLabels, 3);
+  }
+  else
+  {
+    AccessFixedDimensionByItk_1(inputImage, InternalProcessing, 3, outputSurface);
+  }
+}
+
+mitk::LabelSetImageToSurfaceFilter::LabelType mitk::LabelSetImageToSurfaceFilter::GetLabelOfOutput(
+  unsigned int index) const
+{
+  auto iter = m_IndexToLabels.find(index);
+  if (iter == m_IndexToLabels.end())
+  {
+    mitkThrow() << "No label surface at output " << index << ".";
+  }
+  return iter->second;
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::LabelSetImageToSurfaceFilter::InternalProcessingAllLabels(const itk::Image<TPixel, VDimension> *input)
+{
+  typedef itk::Image<TPixel, VDimension> ImageType;
+
+  const typename ImageType::RegionType &region = input->GetBufferedRegion();
+  const int size[3] = {static_cast<int>(region.GetSize(0)),
+                       static_cast<int>(region.GetSize(1)),
+                       static_cast<int>(region.GetSize(2))};
+  const TPixel *buffer = input->GetBufferPointer();
+
+  // a single pass over the image finds the bounding boxes of all labels
+  std::map<LabelType, LabelBounds> bounds;
+  auto current = bounds.end();
+  const TPixel *value = buffer;
+  for (int z = 0; z < size[2]; ++z)
+  {
+    for (int y = 0; y < size[1]; ++y)
+    {
+      for (int x = 0; x < size[0]; ++x, ++value)
+      {
+        if (*value == static_cast<TPixel>(m_BackgroundLabel))
+          continue;
+
+        const auto label = static_cast<LabelType>(*value);
+        if (current == bounds.end() || current->first != label)
+        {
+          current = bounds.find(label);
+          if (current == bounds.end())
+          {
+            const LabelBounds newBounds = {{x, y, z}, {x, y, z}, 0};
+            current = bounds.insert(std::make_pair(label, newBounds)).first;
+          }
+        }
+
+        LabelBounds &labelBounds = current->second;
+        const int index[3] = {x, y, z};
+        for (int d = 0; d < 3; ++d)
+        {
+          labelBounds.Minimum[d] = std::min(labelBounds.Minimum[d], index[d]);
+          labelBounds.Maximum[d] = std::max(labelBounds.Maximum[d], index[d]);
+        }
+        ++labelBounds.NumberOfVoxels;
+      }
+    }
+  }
+
+  m_AvailableLabels.clear();
+  m_IndexToLabels.clear();
+  std::vector<LabelType> labels;
+  std::vector<LabelBounds> labelBounds;
+  for (const auto &entry : bounds)
+  {
+    m_IndexToLabels[labels.size()] = entry.first;
+    m_AvailableLabels[entry.first] = entry.second.NumberOfVoxels;
+    labels.push_back(entry.first);
+    labelBounds.push_back(entry.second);
+  }
+
+  // surface nets give voxel coordinates, the geometry maps them to world coordinates
+  vtkSmartPointer<vtkMatrix4x4> indexToWorld = vtkSmartPointer<vtkMatrix4x4>::New();
+  this->GetInput()->GetGeometry()->GetVtkTransform()->GetMatrix(indexToWorld);
+  double(*matrix)[4] = indexToWorld->Element;
+
+  std::vector<vtkSmartPointer<vtkPolyData>> surfaces(labels.size());
+  const int numberOfLabels = static_cast<int>(labels.size());
+
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < numberOfLabels; ++i)
+  {
+    const LabelBounds &labelBox = labelBounds[i];
+    const auto label = static_cast<TPixel>(labels[i]);
+
+    // mask of the bounding box with a border of one voxel on each side
+    int dimensions[3];
+    for (int d = 0; d < 3; ++d)
+    {
+      dimensions[d] = labelBox.Maximum[d] - labelBox.Minimum[d] + 3;
+    }
+
+    std::vector<unsigned char> mask(static_cast<std::size_t>(dimensions[0]) * dimensions[1] * dimensions[2], 0);
+    for (int z = 1; z < dimensions[2] - 1; ++z)
+    {
+      for (int y = 1; y < dimensions[1] - 1; ++y)
+      {
+        const std::size_t rowIndex =
+          static_cast<std::size_t>(labelBox.Minimum[2] + z - 1) * size[1] + labelBox.Minimum[1] + y - 1;
+        const TPixel *row = buffer + rowIndex * size[0] + labelBox.Minimum[0] - 1;
+        unsigned char *maskRow = &mask[(static_cast<std::size_t>(z) * dimensions[1] + y) * dimensions[0]];
+        for (int x = 1; x < dimensions[0] - 1; ++x)
+        {
+          maskRow[x] = row[x] == label;
+        }
+      }
+    }
+
+    vtkSmartPointer<vtkPolyData> surface = GenerateSurfaceNet(mask, dimensions);
+
+    vtkPoints *points = surface->GetPoints();
+    double point[3];
+    for (vtkIdType p = 0; p < points->GetNumberOfPoints(); ++p)
+    {
+      points->GetPoint(p, point);
+      for (int d = 0; d < 3; ++d)
+      {
+        point[d] += labelBox.Minimum[d] - 1 + region.GetIndex(d);
+      }
+      mitkVtkLinearTransformPoint(matrix, point, point);
+      points->SetPoint(p, point);
+    }
+
+    surfaces[i] = this->PostProcessSurface(surface);
+  }
+
+  // the primary output stays, even if there is no label at all
+  this->SetNumberOfIndexedOutputs(std::max<std::size_t>(1, surfaces.size()));
+  for (unsigned int i = 0; i < surfaces.size(); ++i)
+  {
+    if (this->GetOutput(i) == nullptr)
+    {
+      this->SetNthOutput(i, this->MakeOutput(i));
+    }
+    this->GetOutput(i)->SetVtkPolyData(surfaces[i], 0);
+  }
+  if (surfaces.empty())
+  {
+    this->GetOutput(0)->SetVtkPolyData(vtkSmartPointer<vtkPolyData>::New(), 0);
+  }
+}
+
+vtkSmartPointer<vtkPolyData> mitk::LabelSetImageToSurfaceFilter::GenerateSurfaceNet(
+  const std::vector<unsigned char> &mask, const int dimensions[3])
+{
+  // corners and edges of a cell, i.e. of the cube between the centers of 2x2x2 voxels
+  static const int corners[8][3] = {
+    {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}, {0, 0, 1}, {1, 0, 1}, {0, 1, 1}, {1, 1, 1}};
+  static const int edges[12][2] = {
+    {0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7}, {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+  const std::size_t strides[3] = {1, static_cast<std::size_t>(dimensions[0]),
+                                  static_cast<std::size_t>(dimensions[0]) * dimensions[1]};
+  const int cellDimensions[3] = {dimensions[0] - 1, dimensions[1] - 1, dimensions[2] - 1};
+  const std::size_t cellStrides[3] = {1, static_cast<std::size_t>(cellDimensions[0]),
+                                      static_cast<std::size_t>(cellDimensions[0]) * cellDimensions[1]};
+
+  std::size_t cornerOffsets[8];
+  for (int c = 0; c < 8; ++c)
+  {
+    cornerOffsets[c] = corners[c][0] * strides[0] + corners[c][1] * strides[1] + corners[c][2] * strides[2];
+  }
+
+  // one vertex per cell on the surface, at the mean of the midpoints of its crossed edges
+  std::vector<vtkIdType> cellVertices(cellStrides[2] * cellDimensions[2], -1);
+  vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+  for (int z = 0; z < cellDimensions[2]; ++z)
+  {
+    for (int y = 0; y < cellDimensions[1]; ++y)
+    {
+      for (int x = 0; x < cellDimensions[0]; ++x)
+      {
+        const std::size_t base = x * strides[0] + y * strides[1] + z * strides[2];
+        unsigned char inside[8];
+        int numberOfInsideCorners = 0;
+        for (int c = 0; c < 8; ++c)
+        {
+          inside[c] = mask[base + cornerOffsets[c]];
+          numberOfInsideCorners += inside[c];
+        }
+        if (numberOfInsideCorners == 0 || numberOfInsideCorners == 8)
+          continue;
+
+        double vertex[3] = {0.0, 0.0, 0.0};
+        int numberOfCrossings = 0;
+        for (const auto &edge : edges)
+        {
+          if (inside[edge[0]] == inside[edge[1]])
+            continue;
+          for (int d = 0; d < 3; ++d)
+          {
+            vertex[d] += 0.5 * (corners[edge[0]][d] + corners[edge[1]][d]);
+          }
+          ++numberOfCrossings;
+        }
+
+        cellVertices[x * cellStrides[0] + y * cellStrides[1] + z * cellStrides[2]] =
+          points->InsertNextPoint(x + vertex[0] / numberOfCrossings,
+                                  y + vertex[1] / numberOfCrossings,
+                                  z + vertex[2] / numberOfCrossings);
+      }
+    }
+  }
+
+  // two triangles for every pair of face neighbors with different values, between the four cells around their edge
+  vtkSmartPointer<vtkCellArray> polys = vtkSmartPointer<vtkCellArray>::New();
+  int voxel[3];
+  for (voxel[2] = 0; voxel[2] < dimensions[2]; ++voxel[2])
+  {
+    for (voxel[1] = 0; voxel[1] < dimensions[1]; ++voxel[1])
+    {
+      for (voxel[0] = 0; voxel[0] < dimensions[0]; ++voxel[0])
+      {
+        const std::size_t offset = voxel[0] * strides[0] + voxel[1] * strides[1] + voxel[2] * strides[2];
+        for (int d = 0; d < 3; ++d)
+        {
+          // the border voxels are outside, so the cells around an edge with a crossing exist
+          const int u = (d + 1) % 3;
+          const int v = (d + 2) % 3;
+          if (voxel[d] + 1 >= dimensions[d] || voxel[u] == 0 || voxel[v] == 0 ||
+              mask[offset] == mask[offset + strides[d]])
+            continue;
+
+          const std::size_t cell = voxel[d] * cellStrides[d] + voxel[u] * cellStrides[u] + voxel[v] * cellStrides[v];
+          vtkIdType quad[4] = {cellVertices[cell - cellStrides[u] - cellStrides[v]],
+                               cellVertices[cell - cellStrides[v]],
+                               cellVertices[cell],
+                               cellVertices[cell - cellStrides[u]]};
+
+          // counter clockwise in (u, v) gives a normal along +d, which points outside if the lower voxel is inside
+          if (!mask[offset])
+          {
+            std::swap(quad[1], quad[3]);
+          }
+
+          const vtkIdType triangle1[3] = {quad[0], quad[1], quad[2]};
+          const vtkIdType triangle2[3] = {quad[0], quad[2], quad[3]};
+          polys->InsertNextCell(3, triangle1);
+          polys->InsertNextCell(3, triangle2);
+        }
+      }
+    }
+  }
+
+  vtkSmartPointer<vtkPolyData> polyData = vtkSmartPointer<vtkPolyData>::New();
+  polyData->SetPoints(points);
+  polyData->SetPolys(polys);
+  return polyData;
+}
+
+vtkSmartPointer<vtkPolyData> mitk::LabelSetImageToSurfaceFilter::PostProcessSurface(vtkPolyData *polyData) const
+{
+  vtkSmartPointer<vtkPolyData> result = polyData;
+
+  if (m_UseSmoothing && result->GetNumberOfPolys() > 0)
+  {
+    vtkSmartPointer<vtkWindowedSincPolyDataFilter> smoother = vtkSmartPointer<vtkWindowedSincPolyDataFilter>::New();
+    smoother->SetInputData(result);
+    smoother->SetNumberOfIterations(20);
+    smoother->SetPassBand(0.1);
+    smoother->NormalizeCoordinatesOn();
+    smoother->NonManifoldSmoothingOn();
+    smoother->BoundarySmoothingOff();
+    smoother->FeatureEdgeSmoothingOff();
+    smoother->Update();
+    result = smoother->GetOutput();
+  }
+
+  if (m_TargetReduction > 0.0 && result->GetNumberOfPolys() > 0)
+  {
+    vtkSmartPointer<vtkQuadricDecimation> decimation = vtkSmartPointer<vtkQuadricDecimation>::New();
+    decimation->SetInputData(result);
+    decimation->SetTargetReduction(m_TargetReduction);
+    decimation->Update();
+    result = decimation->GetOutput();
+  }
+
+  vtkSmartPointer<vtkPolyDataNormals> normals = vtkSmartPointer<vtkPolyDataNormals>::New();
+  normals->SetInputData(result);
+  normals->SplittingOff();
+  normals->ConsistencyOff();
+  normals->ComputePointNormalsOn();
+  normals->Update();
+
+  vtkSmartPointer<vtkPolyData> output = vtkSmartPointer<vtkPolyData>::New();
+  output->ShallowCopy(normals->GetOutput());
+  return output;
 }
 
 template <typename TPixel, unsigned int VDimension>
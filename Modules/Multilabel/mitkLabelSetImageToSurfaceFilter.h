@@ -23,10 +23,13 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkSurfaceSource.h>
 
 #include <vtkMatrix4x4.h>
+#include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include <itkImage.h>
 
 #include <map>
+#include <vector>
 
 namespace mitk
 {
@@ -34,6 +37,10 @@ namespace mitk
    * Generates surface meshes from a labelset image.
    * If you want to calculate a surface representation for all available labels,
    * you may call GenerateAllLabelsOn().
+   *
+   * All labels are extracted together: one pass over the image finds the bounding box of every label, then the
+   * labels are meshed in parallel with surface nets, each inside of its bounding box only. Smoothing and decimation
+   * are done per label in the same parallel loop. The filter has one output per label then, see GetLabelOfOutput().
    */
   class MITKMULTILABEL_EXPORT LabelSetImageToSurfaceFilter : public SurfaceSource
   {
@@ -109,6 +116,22 @@ namespace mitk
      */
     itkSetMacro(Sigma, float);
 
+    /**
+     * Sets the fraction of triangles removed by decimation when all labels are extracted, by default 0 (no decimation)
+     */
+    itkSetMacro(TargetReduction, double);
+    itkGetMacro(TargetReduction, double);
+
+    /**
+     * Returns the label whose surface is the output with the given index, after all labels were extracted.
+     */
+    LabelType GetLabelOfOutput(unsigned int index) const;
+
+    /**
+     * Returns the number of voxels of every label found during the extraction of all labels.
+     */
+    const LabelMapType &GetAvailableLabels() const { return m_AvailableLabels; }
+
   protected:
     LabelSetImageToSurfaceFilter();
 
@@ -133,6 +156,18 @@ namespace mitk
     template <typename TPixel, unsigned int VImageDimension>
     void InternalProcessing(const itk::Image<TPixel, VImageDimension> *input, mitk::Surface *surface);
 
+    template <typename TPixel, unsigned int VImageDimension>
+    void InternalProcessingAllLabels(const itk::Image<TPixel, VImageDimension> *input);
+
+    /**
+     * Surface nets of a binary mask with a border of zeros. The vertices are given in voxel coordinates of the mask.
+     */
+    static vtkSmartPointer<vtkPolyData> GenerateSurfaceNet(const std::vector<unsigned char> &mask,
+                                                           const int dimensions[3]);
+
+    /** Smoothing, decimation and normals of the surface of one label */
+    vtkSmartPointer<vtkPolyData> PostProcessSurface(vtkPolyData *polyData) const;
+
     bool m_GenerateAllLabels;
 
     int m_RequestedLabel;
@@ -143,6 +178,8 @@ namespace mitk
 
     float m_Sigma;
 
+    double m_TargetReduction;
+
     LabelMapType m_AvailableLabels;
 
     IndexToLabelMapType m_IndexToLabels;
@@ -21,7 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 namespace mitk
 {
-  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter() : m_RequestedLabel(1), m_Result(nullptr)
+  LabelSetImageToSurfaceThreadedFilter::LabelSetImageToSurfaceThreadedFilter()
+    : m_RequestedLabel(1), m_Result(nullptr), m_GenerateAllLabels(false)
   {
   }
 
@@ -74,10 +75,20 @@ namespace mitk
       MITK_WARN << "\"RequestedLabel\" parameter was not set: will use the default value (" << m_RequestedLabel << ").";
     }
 
+    m_GenerateAllLabels = false;
+    try
+    {
+      this->GetParameter("GenerateAllLabels", m_GenerateAllLabels);
+    }
+    catch (std::invalid_argument &)
+    {
+      // optional, a single label is extracted by default
+    }
+
     mitk::LabelSetImageToSurfaceFilter::Pointer filter = mitk::LabelSetImageToSurfaceFilter::New();
     filter->SetInput(image);
     //  filter->SetObserver(obsv);
-    filter->SetGenerateAllLabels(false);
+    filter->SetGenerateAllLabels(m_GenerateAllLabels);
     filter->SetRequestedLabel(m_RequestedLabel);
     filter->SetUseSmoothing(useSmoothing);
 
@@ -101,6 +112,18 @@ namespace mitk
       return false;
     }
 
+    m_LabelResults.clear();
+    if (m_GenerateAllLabels)
+    {
+      for (unsigned int i = 0; i < filter->GetAvailableLabels().size(); ++i)
+      {
+        Surface::Pointer surface = filter->GetOutput(i);
+        surface->DisconnectPipeline();
+        m_LabelResults[filter->GetLabelOfOutput(i)] = surface;
+      }
+      return !m_LabelResults.empty();
+    }
+
     m_Result = filter->GetOutput();
 
     if (m_Result.IsNull() || !m_Result->GetVtkPolyData())
@@ -116,6 +139,33 @@ namespace mitk
     LabelSetImage::Pointer image;
     this->GetPointerParameter("Input", image);
 
+    if (m_GenerateAllLabels)
+    {
+      for (const auto &labelResult : m_LabelResults)
+      {
+        mitk::Label *label = image->GetLabel(labelResult.first, image->GetActiveLayer());
+
+        std::string name = this->GetGroupNode()->GetName();
+        name.append("-");
+        name.append(label != nullptr ? label->GetName() : std::to_string(labelResult.first));
+        name.append("-surf");
+
+        mitk::DataNode::Pointer node = mitk::DataNode::New();
+        node->SetData(labelResult.second);
+        node->SetName(name);
+        if (label != nullptr)
+        {
+          node->SetColor(label->GetColor());
+        }
+
+        this->InsertBelowGroupNode(node);
+      }
+
+      m_LabelResults.clear();
+      Superclass::ThreadedUpdateSuccessful();
+      return;
+    }
+
     std::string name = this->GetGroupNode()->GetName();
     name.append("-surf");
 
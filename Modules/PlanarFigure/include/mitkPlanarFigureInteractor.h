@@ -69,6 +69,12 @@ namespace mitk
     /** \brief Sets the minimal distance between two control points. */
     void SetMinimumPointDistance(ScalarType minimumDistance);
 
+    /**
+     * \brief While waiting for the mouse to hover over a placed figure, only positions on the slice of the figure are of
+     * interest, i.e. within the plane thickness from the plane geometry (which is the frame of the control points).
+     */
+    ScalarType GetInteractionDistance() const override;
+
   protected:
     PlanarFigureInteractor();
     ~PlanarFigureInteractor() override;
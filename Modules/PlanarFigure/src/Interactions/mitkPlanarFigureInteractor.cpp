@@ -30,6 +30,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 #include "mitkAbstractTransformGeometry.h"
 #include "mitkPlaneGeometry.h"
+#include "mitkStateMachineState.h"
 
 mitk::PlanarFigureInteractor::PlanarFigureInteractor()
   : DataInteractor(), m_Precision(6.5), m_MinimumPointDistance(25.0), m_IsHovering(false), m_LastPointWasValid(false)
@@ -696,6 +697,25 @@ void mitk::PlanarFigureInteractor::SetMinimumPointDistance(ScalarType minimumDis
   m_MinimumPointDistance = minimumDistance;
 }
 
+mitk::ScalarType mitk::PlanarFigureInteractor::GetInteractionDistance() const
+{
+  // all transitions of the other states may be triggered anywhere
+  if (this->GetCurrentState() == nullptr || this->GetCurrentState()->GetName() != "EditFigure")
+    return Superclass::GetInteractionDistance();
+
+  const DataNode *dataNode = this->GetDataNode();
+  const auto *planarFigure = dataNode != nullptr ? dynamic_cast<const PlanarFigure *>(dataNode->GetData()) : nullptr;
+  if (planarFigure == nullptr)
+    return Superclass::GetInteractionDistance();
+
+  const auto *planarFigureGeometry = dynamic_cast<const PlaneGeometry *>(planarFigure->GetGeometry(0));
+  if (planarFigureGeometry == nullptr || dynamic_cast<const AbstractTransformGeometry *>(planarFigureGeometry) != nullptr)
+    return Superclass::GetInteractionDistance();
+
+  // see CheckFigureOnRenderingGeometry()
+  return planarFigureGeometry->GetExtentInMM(2);
+}
+
 bool mitk::PlanarFigureInteractor::TransformPositionEventToPoint2D(const InteractionPositionEvent *positionEvent,
                                                                    const PlaneGeometry *planarFigureGeometry,
                                                                    Point2D &point2D)
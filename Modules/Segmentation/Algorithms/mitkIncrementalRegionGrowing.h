@@ -0,0 +1,143 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkIncrementalRegionGrowing_h_Included
+#define mitkIncrementalRegionGrowing_h_Included
+
+#include <mitkCommon.h>
+
+#include <itkImage.h>
+#include <itkObject.h>
+#include <itkObjectFactory.h>
+
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace mitk
+{
+  /**
+    \brief Region growing from a fixed seed that answers threshold changes without growing from scratch.
+
+    The result of ComputeRegion(lower, upper) is the region itk::ConnectedThresholdImageFilter produces for the
+    same seed and thresholds (face connectivity, thresholds converted to the pixel type of the image).
+
+    Every voxel gets the deviation of its value from a center value (by default the value of the seed voxel),
+    scaled separately below and above the center. Starting at the seed, a priority flood visits the voxels in
+    the order of their minimax path cost, i.e. the smallest possible maximum deviation along any path from the
+    seed. This is the threshold at which a voxel joins the region, so every window [center - t * lowerScale,
+    center + t * upperScale] selects a prefix of the flood order. Arbitrary windows are answered from the
+    prefix of the smallest enclosing window: if the values of that prefix already lie inside the window, the prefix
+    is the result, otherwise a breadth first search restricted to the prefix is done.
+
+    The flood order is extended lazily, so only the voxels up to the largest window requested so far are visited.
+    Interactive tools should keep one instance per seed and call ComputeRegion() for every threshold change.
+
+    \ingroup Segmentation
+  */
+  template <typename TPixel, unsigned int VDimension>
+  class IncrementalRegionGrowing : public itk::Object
+  {
+  public:
+    mitkClassMacroItkParent(IncrementalRegionGrowing, itk::Object);
+    itkFactorylessNewMacro(Self);
+
+    typedef itk::Image<TPixel, VDimension> ImageType;
+    typedef typename ImageType::IndexType IndexType;
+    typedef itk::OffsetValueType OffsetValueType;
+    typedef std::vector<OffsetValueType> RegionType;
+
+    /**
+     * @brief Sets the image and the seed and discards the flood order of a previous seed.
+     * The image has to stay unmodified as long as this object is used.
+     */
+    void Initialize(const ImageType *image, const IndexType &seed);
+
+    /**
+     * @brief Like Initialize(image, seed), with the center and the scales of the window family the flood order
+     * is computed for. Windows of this family are answered by a prefix selection only.
+     */
+    void Initialize(const ImageType *image,
+                    const IndexType &seed,
+                    double center,
+                    double lowerScale,
+                    double upperScale);
+
+    /**
+     * @brief Computes the region connected to the seed with all values in [lower, upper].
+     * @param region receives the offsets of the region voxels, relative to the buffer of the image
+     * @return the number of region voxels
+     */
+    unsigned long ComputeRegion(double lower, double upper, RegionType &region);
+
+    /** Number of voxels ordered by the priority flood so far */
+    unsigned long GetNumberOfOrderedVoxels() const { return m_Order.size(); }
+
+    const ImageType *GetImage() const { return m_Image; }
+    const IndexType &GetSeed() const { return m_Seed; }
+
+  protected:
+    IncrementalRegionGrowing();
+    ~IncrementalRegionGrowing() override {}
+
+    typedef std::pair<double, OffsetValueType> QueueEntryType;
+    typedef std::priority_queue<QueueEntryType, std::vector<QueueEntryType>, std::greater<QueueEntryType>>
+      QueueType;
+
+    static const unsigned int NotVisited;
+    static const unsigned int Queued;
+
+    double GetDeviation(TPixel value) const;
+
+    /** Converts a threshold to the pixel type, like the threshold setters of ConnectedThresholdImageFilter */
+    static TPixel ConvertThreshold(double threshold);
+
+    /** Pops voxels from the flood queue until every voxel with a join level <= level is ordered */
+    void ExtendOrder(double level);
+
+    /** Breadth first search inside the first numberOfCandidates ordered voxels */
+    void SearchInCandidates(unsigned long numberOfCandidates, TPixel lower, TPixel upper, RegionType &region);
+
+    typename ImageType::ConstPointer m_Image;
+    IndexType m_Seed;
+    OffsetValueType m_SeedOffset;
+
+    double m_Center;
+    double m_LowerScale;
+    double m_UpperScale;
+
+    OffsetValueType m_Size[VDimension];
+    OffsetValueType m_Stride[VDimension];
+
+    // flood order, join level and running value range of the ordered voxels
+    std::vector<OffsetValueType> m_Order;
+    std::vector<double> m_Levels;
+    std::vector<TPixel> m_PrefixMinimum;
+    std::vector<TPixel> m_PrefixMaximum;
+
+    // position of every voxel in m_Order, or NotVisited / Queued
+    std::vector<unsigned int> m_Rank;
+    QueueType m_Queue;
+
+    // marks of SearchInCandidates(), reset after every search
+    std::vector<bool> m_Marks;
+  };
+} // namespace mitk
+
+#include "mitkIncrementalRegionGrowing.txx"
+
+#endif
@@ -0,0 +1,248 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#ifndef mitkIncrementalRegionGrowing_txx_Included
+#define mitkIncrementalRegionGrowing_txx_Included
+
+#include <mitkExceptionMacro.h>
+
+#include <algorithm>
+#include <limits>
+
+template <typename TPixel, unsigned int VDimension>
+const unsigned int mitk::IncrementalRegionGrowing<TPixel, VDimension>::NotVisited =
+  std::numeric_limits<unsigned int>::max();
+
+template <typename TPixel, unsigned int VDimension>
+const unsigned int mitk::IncrementalRegionGrowing<TPixel, VDimension>::Queued =
+  std::numeric_limits<unsigned int>::max() - 1;
+
+template <typename TPixel, unsigned int VDimension>
+mitk::IncrementalRegionGrowing<TPixel, VDimension>::IncrementalRegionGrowing()
+  : m_SeedOffset(0), m_Center(0.0), m_LowerScale(1.0), m_UpperScale(1.0)
+{
+  m_Seed.Fill(0);
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    m_Size[d] = 0;
+    m_Stride[d] = 0;
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::IncrementalRegionGrowing<TPixel, VDimension>::Initialize(const ImageType *image, const IndexType &seed)
+{
+  if (image == nullptr || !image->GetBufferedRegion().IsInside(seed))
+  {
+    mitkThrow() << "Region growing needs an image and a seed inside of it.";
+  }
+
+  this->Initialize(image, seed, static_cast<double>(image->GetPixel(seed)), 1.0, 1.0);
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::IncrementalRegionGrowing<TPixel, VDimension>::Initialize(
+  const ImageType *image, const IndexType &seed, double center, double lowerScale, double upperScale)
+{
+  if (image == nullptr || !image->GetBufferedRegion().IsInside(seed))
+  {
+    mitkThrow() << "Region growing needs an image and a seed inside of it.";
+  }
+  if (!(lowerScale > 0.0) || !(upperScale > 0.0))
+  {
+    mitkThrow() << "The scales of the threshold window have to be positive.";
+  }
+
+  m_Image = image;
+  m_Seed = seed;
+  m_Center = center;
+  m_LowerScale = lowerScale;
+  m_UpperScale = upperScale;
+
+  const typename ImageType::RegionType &bufferedRegion = image->GetBufferedRegion();
+  OffsetValueType numberOfVoxels = 1;
+  m_SeedOffset = 0;
+  for (unsigned int d = 0; d < VDimension; ++d)
+  {
+    m_Size[d] = bufferedRegion.GetSize(d);
+    m_Stride[d] = numberOfVoxels;
+    m_SeedOffset += (seed[d] - bufferedRegion.GetIndex(d)) * numberOfVoxels;
+    numberOfVoxels *= m_Size[d];
+  }
+
+  m_Order.clear();
+  m_Levels.clear();
+  m_PrefixMinimum.clear();
+  m_PrefixMaximum.clear();
+  m_Rank.assign(numberOfVoxels, NotVisited);
+  m_Marks.assign(numberOfVoxels, false);
+  m_Queue = QueueType();
+
+  m_Rank[m_SeedOffset] = Queued;
+  m_Queue.push(QueueEntryType(this->GetDeviation(image->GetBufferPointer()[m_SeedOffset]), m_SeedOffset));
+
+  this->Modified();
+}
+
+template <typename TPixel, unsigned int VDimension>
+double mitk::IncrementalRegionGrowing<TPixel, VDimension>::GetDeviation(TPixel value) const
+{
+  const auto v = static_cast<double>(value);
+  return v >= m_Center ? (v - m_Center) / m_UpperScale : (m_Center - v) / m_LowerScale;
+}
+
+template <typename TPixel, unsigned int VDimension>
+TPixel mitk::IncrementalRegionGrowing<TPixel, VDimension>::ConvertThreshold(double threshold)
+{
+  if (std::numeric_limits<TPixel>::is_integer)
+  {
+    // clamp first, converting an out of range value to an integer type is undefined
+    threshold = std::max<double>(threshold, std::numeric_limits<TPixel>::lowest());
+    threshold = std::min<double>(threshold, std::numeric_limits<TPixel>::max());
+  }
+  return static_cast<TPixel>(threshold);
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::IncrementalRegionGrowing<TPixel, VDimension>::ExtendOrder(double level)
+{
+  const TPixel *buffer = m_Image->GetBufferPointer();
+
+  while (!m_Queue.empty() && m_Queue.top().first <= level)
+  {
+    const QueueEntryType entry = m_Queue.top();
+    m_Queue.pop();
+
+    const OffsetValueType offset = entry.second;
+    const TPixel value = buffer[offset];
+
+    m_Rank[offset] = static_cast<unsigned int>(m_Order.size());
+    m_PrefixMinimum.push_back(m_Order.empty() ? value : std::min(value, m_PrefixMinimum.back()));
+    m_PrefixMaximum.push_back(m_Order.empty() ? value : std::max(value, m_PrefixMaximum.back()));
+    m_Order.push_back(offset);
+    m_Levels.push_back(entry.first);
+
+    // the join level of a neighbor is known when it is queued for the first time, as the levels of the voxels
+    // taken from the queue never decrease
+    OffsetValueType remainder = offset;
+    for (int d = VDimension - 1; d >= 0; --d)
+    {
+      const OffsetValueType coordinate = remainder / m_Stride[d];
+      remainder -= coordinate * m_Stride[d];
+
+      const OffsetValueType neighbors[2] = {coordinate > 0 ? offset - m_Stride[d] : -1,
+                                            coordinate + 1 < m_Size[d] ? offset + m_Stride[d] : -1};
+      for (const OffsetValueType neighbor : neighbors)
+      {
+        if (neighbor >= 0 && m_Rank[neighbor] == NotVisited)
+        {
+          m_Rank[neighbor] = Queued;
+          m_Queue.push(QueueEntryType(std::max(entry.first, this->GetDeviation(buffer[neighbor])), neighbor));
+        }
+      }
+    }
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+void mitk::IncrementalRegionGrowing<TPixel, VDimension>::SearchInCandidates(unsigned long numberOfCandidates,
+                                                                              TPixel lower,
+                                                                              TPixel upper,
+                                                                              RegionType &region)
+{
+  const TPixel *buffer = m_Image->GetBufferPointer();
+
+  region.push_back(m_SeedOffset);
+  m_Marks[m_SeedOffset] = true;
+
+  for (std::size_t front = 0; front < region.size(); ++front)
+  {
+    const OffsetValueType offset = region[front];
+
+    OffsetValueType remainder = offset;
+    for (int d = VDimension - 1; d >= 0; --d)
+    {
+      const OffsetValueType coordinate = remainder / m_Stride[d];
+      remainder -= coordinate * m_Stride[d];
+
+      const OffsetValueType neighbors[2] = {coordinate > 0 ? offset - m_Stride[d] : -1,
+                                            coordinate + 1 < m_Size[d] ? offset + m_Stride[d] : -1};
+      for (const OffsetValueType neighbor : neighbors)
+      {
+        // NotVisited and Queued are larger than any number of candidates
+        if (neighbor >= 0 && m_Rank[neighbor] < numberOfCandidates && !m_Marks[neighbor] &&
+            buffer[neighbor] >= lower && buffer[neighbor] <= upper)
+        {
+          m_Marks[neighbor] = true;
+          region.push_back(neighbor);
+        }
+      }
+    }
+  }
+
+  for (const OffsetValueType offset : region)
+  {
+    m_Marks[offset] = false;
+  }
+}
+
+template <typename TPixel, unsigned int VDimension>
+unsigned long mitk::IncrementalRegionGrowing<TPixel, VDimension>::ComputeRegion(double lower,
+                                                                                 double upper,
+                                                                                 RegionType &region)
+{
+  region.clear();
+  if (m_Image.IsNull())
+  {
+    mitkThrow() << "Region growing has not been initialized.";
+  }
+
+  const TPixel lowerThreshold = ConvertThreshold(lower);
+  const TPixel upperThreshold = ConvertThreshold(upper);
+
+  const TPixel seedValue = m_Image->GetBufferPointer()[m_SeedOffset];
+  if (seedValue < lowerThreshold || seedValue > upperThreshold)
+  {
+    return 0;
+  }
+
+  // the smallest window of the flood family enclosing [lowerThreshold, upperThreshold]; every voxel of the region
+  // is connected to the seed inside this window, so the region is a subset of the prefix up to this level
+  const double level = std::max(std::max(0.0, (m_Center - static_cast<double>(lowerThreshold)) / m_LowerScale),
+                                std::max(0.0, (static_cast<double>(upperThreshold) - m_Center) / m_UpperScale));
+  this->ExtendOrder(level);
+
+  const unsigned long numberOfCandidates = std::upper_bound(m_Levels.begin(), m_Levels.end(), level) - m_Levels.begin();
+  if (numberOfCandidates == 0)
+  {
+    return 0;
+  }
+
+  // a connected prefix whose values all lie inside the thresholds is the region itself
+  if (m_PrefixMinimum[numberOfCandidates - 1] >= lowerThreshold &&
+      m_PrefixMaximum[numberOfCandidates - 1] <= upperThreshold)
+  {
+    region.assign(m_Order.begin(), m_Order.begin() + numberOfCandidates);
+  }
+  else
+  {
+    this->SearchInCandidates(numberOfCandidates, lowerThreshold, upperThreshold, region);
+  }
+
+  return region.size();
+}
+
+#endif
@@ -97,6 +97,7 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
 {
   // clear old information (remove all time steps
   m_SegmentationCountInSlice.clear();
+  m_SegmentedSlices.clear();
 
   // delete this from the list of interpolators
   auto iter = s_InterpolatorForImage.find(segmentation);
@@ -124,14 +125,17 @@ void mitk::SegmentationInterpolationController::SetSegmentationVolume(const Imag
   m_Segmentation = segmentation;
 
   m_SegmentationCountInSlice.resize(m_Segmentation->GetTimeSteps());
+  m_SegmentedSlices.resize(m_Segmentation->GetTimeSteps());
   for (unsigned int timeStep = 0; timeStep < m_Segmentation->GetTimeSteps(); ++timeStep)
   {
     m_SegmentationCountInSlice[timeStep].resize(3);
+    m_SegmentedSlices[timeStep].resize(3);
     for (unsigned int dim = 0; dim < 3; ++dim)
     {
       m_SegmentationCountInSlice[timeStep][dim].clear();
       m_SegmentationCountInSlice[timeStep][dim].resize(m_Segmentation->GetDimension(dim));
       m_SegmentationCountInSlice[timeStep][dim].assign(m_Segmentation->GetDimension(dim), 0);
+      m_SegmentedSlices[timeStep][dim].clear();
     }
   }
 
@@ -191,6 +195,8 @@ void mitk::SegmentationInterpolationController::SetChangedVolume(const Image *sl
     return;
   if (sliceDiff->GetDimension() != 3)
     return;
+  if (timeStep >= m_SegmentationCountInSlice.size())
+    return;
 
   AccessFixedDimensionByItk_1(sliceDiff, ScanChangedVolume, 3, timeStep);
 
@@ -275,22 +281,17 @@ void mitk::SegmentationInterpolationController::ScanChangedSlice(const itk::Imag
     for (unsigned int u = 0; u < dim0max; ++u)
     {
       DATATYPE value = *(pixelData + u + v * dim0max);
+      if (value == 0)
+        continue; // most pixels of a segmentation or a difference image are empty
 
-      assert((signed)m_SegmentationCountInSlice[timeStep][dim0][u] + (signed)value >=
-             0); // just for debugging. This must always be true, otherwise some counting is going wrong
-      assert((signed)m_SegmentationCountInSlice[timeStep][dim1][v] + (signed)value >= 0);
-
-      m_SegmentationCountInSlice[timeStep][dim0][u] =
-        static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim0][u] + value);
-      m_SegmentationCountInSlice[timeStep][dim1][v] =
-        static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][dim1][v] + value);
+      UpdateSliceCount(timeStep, dim0, u, static_cast<int>(value));
+      UpdateSliceCount(timeStep, dim1, v, static_cast<int>(value));
       numberOfPixels += static_cast<int>(value);
     }
   }
 
   // flag for the dimension of the slice itself
-  assert((signed)m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] + numberOfPixels >= 0);
-  m_SegmentationCountInSlice[timeStep][sliceDimension][sliceIndex] += numberOfPixels;
+  UpdateSliceCount(timeStep, sliceDimension, sliceIndex, numberOfPixels);
 
   // MITK_INFO << "scan t=" << timeStep << " from (0,0) to (" << dim0max << "," << dim1max << ") (" << pixelData << "-"
   // << pixelData+dim0max*dim1max-1 <<  ") in slice " << sliceIndex << " found " << numberOfPixels << " pixels" <<
@@ -328,24 +329,19 @@ void mitk::SegmentationInterpolationController::ScanChangedVolume(const itk::Ima
         z = index[2];
 
         TPixel value = iter.Get();
+        ++iter;
 
-        assert((signed)m_SegmentationCountInSlice[timeStep][0][x] + (signed)value >=
-               0); // just for debugging. This must always be true, otherwise some counting is going wrong
-        assert((signed)m_SegmentationCountInSlice[timeStep][1][y] + (signed)value >= 0);
+        if (value == 0)
+          continue;
 
-        m_SegmentationCountInSlice[timeStep][0][x] =
-          static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][0][x] + value);
-        m_SegmentationCountInSlice[timeStep][1][y] =
-          static_cast<unsigned int>(m_SegmentationCountInSlice[timeStep][1][y] + value);
+        UpdateSliceCount(timeStep, 0, x, static_cast<int>(value));
+        UpdateSliceCount(timeStep, 1, y, static_cast<int>(value));
 
         numberOfPixels += static_cast<int>(value);
-
-        ++iter;
       }
       iter.NextLine();
     }
-    assert((signed)m_SegmentationCountInSlice[timeStep][2][z] + numberOfPixels >= 0);
-    m_SegmentationCountInSlice[timeStep][2][z] += numberOfPixels;
+    UpdateSliceCount(timeStep, 2, z, numberOfPixels);
     numberOfPixels = 0;
 
     iter.NextSlice();
@@ -374,6 +370,56 @@ void mitk::SegmentationInterpolationController::ScanWholeVolume(const itk::Image
   }
 }
 
+void mitk::SegmentationInterpolationController::UpdateSliceCount(unsigned int timeStep,
+                                                                 unsigned int dimension,
+                                                                 unsigned int sliceIndex,
+                                                                 int difference)
+{
+  if (difference == 0)
+    return;
+
+  unsigned int &count = m_SegmentationCountInSlice[timeStep][dimension][sliceIndex];
+  const unsigned int oldCount = count;
+
+  // just for debugging. This must always be true, otherwise some counting is going wrong
+  assert((signed)oldCount + difference >= 0);
+  count = static_cast<unsigned int>(oldCount + difference);
+
+  if (oldCount == 0 && count > 0)
+  {
+    m_SegmentedSlices[timeStep][dimension].insert(sliceIndex);
+  }
+  else if (oldCount > 0 && count == 0)
+  {
+    m_SegmentedSlices[timeStep][dimension].erase(sliceIndex);
+  }
+}
+
+bool mitk::SegmentationInterpolationController::GetNeighboringSegmentedSlices(unsigned int sliceDimension,
+                                                                              unsigned int sliceIndex,
+                                                                              unsigned int timeStep,
+                                                                              unsigned int &lowerSliceIndex,
+                                                                              unsigned int &upperSliceIndex) const
+{
+  if (timeStep >= m_SegmentedSlices.size() || sliceDimension > 2)
+    return false;
+
+  const std::set<unsigned int> &segmentedSlices = m_SegmentedSlices[timeStep][sliceDimension];
+
+  auto upper = segmentedSlices.upper_bound(sliceIndex);
+  if (upper == segmentedSlices.end())
+    return false;
+
+  auto lower = segmentedSlices.lower_bound(sliceIndex);
+  if (lower == segmentedSlices.begin())
+    return false;
+  --lower;
+
+  lowerSliceIndex = *lower;
+  upperSliceIndex = *upper;
+  return true;
+}
+
 void mitk::SegmentationInterpolationController::PrintStatus()
 {
   unsigned int timeStep(0); // if needed, put a loop over time steps around everyting, but beware, output will be long
@@ -461,34 +507,7 @@ mitk::Image::Pointer mitk::SegmentationInterpolationController::Interpolate(unsi
 
   unsigned int lowerBound(0);
   unsigned int upperBound(0);
-  bool bounds(false);
-
-  for (lowerBound = sliceIndex - 1; /*lowerBound >= 0*/; --lowerBound)
-  {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][lowerBound] > 0)
-    {
-      bounds = true;
-      break;
-    }
-
-    if (lowerBound == 0)
-      break; // otherwise overflow and start at something like 4294967295
-  }
-
-  if (!bounds)
-    return nullptr;
-
-  bounds = false;
-  for (upperBound = sliceIndex + 1; upperBound < upperLimit; ++upperBound)
-  {
-    if (m_SegmentationCountInSlice[timeStep][sliceDimension][upperBound] > 0)
-    {
-      bounds = true;
-      break;
-    }
-  }
-
-  if (!bounds)
+  if (!GetNeighboringSegmentedSlices(sliceDimension, sliceIndex, timeStep, lowerBound, upperBound))
     return nullptr;
 
   // ok, we have found two neighboring slices with segmentations (and we made sure that the current slice does NOT
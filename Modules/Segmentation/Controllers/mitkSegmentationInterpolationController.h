@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <itkObjectFactory.h>
 
 #include <map>
+#include <set>
 #include <vector>
 
 namespace mitk
@@ -69,6 +70,10 @@ namespace mitk
 
     \image html slice_based_segmentation_interpolator.png
 
+    In addition to the counts, the set of non-empty slices and a bounding box of the segmentation in every slice
+    are kept for each dimension. Both are updated together with the counts from the difference images, so finding the
+    two segmented neighbors of a slice is a logarithmic lookup instead of a walk over all slices of the volume.
+
     $Author$
   */
   class MITKSEGMENTATION_EXPORT SegmentationInterpolationController : public itk::Object
@@ -148,6 +153,17 @@ namespace mitk
                                const mitk::PlaneGeometry *currentPlane,
                                unsigned int timeStep);
 
+    /**
+      \brief Find the closest slices below and above the given slice that contain segmentation pixels.
+
+      \return false if there is no such slice on one of the two sides.
+    */
+    bool GetNeighboringSegmentedSlices(unsigned int sliceDimension,
+                                       unsigned int sliceIndex,
+                                       unsigned int timeStep,
+                                       unsigned int &lowerSliceIndex,
+                                       unsigned int &upperSliceIndex) const;
+
     void OnImageModified(const itk::EventObject &);
 
     /**
@@ -187,6 +203,8 @@ namespace mitk
     typedef std::vector<std::vector<DirtyVectorType>> TimeResolvedDirtyVectorType;
     typedef std::map<const Image *, SegmentationInterpolationController *> InterpolatorMapType;
 
+    typedef std::vector<std::vector<std::set<unsigned int>>> TimeResolvedSegmentedSlicesType;
+
     SegmentationInterpolationController(); // purposely hidden
     ~SegmentationInterpolationController() override;
 
@@ -200,6 +218,9 @@ namespace mitk
     template <typename DATATYPE>
     void ScanWholeVolume(const itk::Image<DATATYPE, 3> *, const Image *volume, unsigned int timeStep);
 
+    /// adds difference to the count of a slice and keeps the set of segmented slices up to date
+    void UpdateSliceCount(unsigned int timeStep, unsigned int dimension, unsigned int sliceIndex, int difference);
+
     void PrintStatus();
 
     /**
@@ -213,6 +234,9 @@ namespace mitk
     */
     TimeResolvedDirtyVectorType m_SegmentationCountInSlice;
 
+    /// indices of the slices with a count > 0, m_SegmentedSlices[timeStep][dimension]
+    TimeResolvedSegmentedSlicesType m_SegmentedSlices;
+
     static InterpolatorMapType s_InterpolatorForImage;
 
     Image::ConstPointer m_Segmentation;
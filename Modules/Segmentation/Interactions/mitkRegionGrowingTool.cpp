@@ -25,6 +25,7 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkToolManager.h"
 
 #include "mitkExtractDirectedPlaneImageFilterNew.h"
+#include "mitkIncrementalRegionGrowing.h"
 #include "mitkLabelSetImage.h"
 #include "mitkOverwriteDirectedPlaneImageFilter.h"
 
@@ -37,8 +38,6 @@ See LICENSE.txt or http://www.mitk.org for details.
 // ITK
 #include "mitkITKImageImport.h"
 #include "mitkImageAccessByItk.h"
-#include <itkConnectedComponentImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
 #include <itkImageRegionIteratorWithIndex.h>
 #include <itkNeighborhoodIterator.h>
 
@@ -186,7 +185,7 @@ void mitk::RegionGrowingTool::IsInsideSegmentation(itk::Image<TPixel, imageDimen
   }
 }
 
-// Do the region growing (i.e. call an ITK filter that does it)
+// Do the region growing (incrementally, the flood order is kept until the next click)
 template <typename TPixel, unsigned int imageDimension>
 void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimension> *inputImage,
                                                  itk::Index<imageDimension> seedIndex,
@@ -198,28 +197,64 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
 
   typedef itk::Image<TPixel, imageDimension> InputImageType;
   typedef itk::Image<DefaultSegmentationDataType, imageDimension> OutputImageType;
+  typedef mitk::IncrementalRegionGrowing<TPixel, imageDimension> RegionGrowingType;
 
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, OutputImageType> RegionGrowingFilterType;
-  typename RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
+  auto *regionGrowing = dynamic_cast<RegionGrowingType *>(m_RegionGrowing.GetPointer());
+  if (regionGrowing == nullptr)
+  {
+    // the flood order outlives this call, so it gets its own copy of the slice instead of the image passed in,
+    // which keeps the reference slice locked as long as it exists
+    typedef itk::ImageDuplicator<InputImageType> InputDuplicatorType;
+    typename InputDuplicatorType::Pointer inputDuplicator = InputDuplicatorType::New();
+    inputDuplicator->SetInputImage(inputImage);
+    inputDuplicator->Update();
+
+    typename RegionGrowingType::Pointer newRegionGrowing = RegionGrowingType::New();
+    try
+    {
+      // the window family of the flood order is the one of moving the mouse up and down
+      newRegionGrowing->Initialize(inputDuplicator->GetOutput(), seedIndex, m_SeedValue, 1.0, 1.0);
+    }
+    catch (const mitk::Exception &)
+    {
+      return; // Should we do something?
+    }
+    m_RegionGrowing = newRegionGrowing;
+    regionGrowing = newRegionGrowing;
+  }
 
-  // perform region growing in desired segmented region
-  regionGrower->SetInput(inputImage);
-  regionGrower->AddSeed(seedIndex);
+  typename RegionGrowingType::RegionType region;
+  regionGrowing->ComputeRegion(thresholds[0], thresholds[1], region);
 
-  regionGrower->SetLower(thresholds[0]);
-  regionGrower->SetUpper(thresholds[1]);
+  typename OutputImageType::Pointer resultImage = OutputImageType::New();
+  resultImage->CopyInformation(inputImage);
+  resultImage->SetRegions(inputImage->GetLargestPossibleRegion());
+  resultImage->Allocate();
+  resultImage->FillBuffer(0);
 
-  try
+  if (region.empty())
   {
-    regionGrower->Update();
+    MITK_DEBUG << "Region growing result is empty.";
+    m_ConnectedComponentValue = 0;
+    outputImage = mitk::GrabItkImageMemory(resultImage);
+    return;
   }
-  catch (...)
+
+  // Write the region and determine its bounding box, nothing outside of it (and the smoothing radius) changes below
+  DefaultSegmentationDataType *resultBuffer = resultImage->GetBufferPointer();
+  typename OutputImageType::IndexType minimumIndex = seedIndex;
+  typename OutputImageType::IndexType maximumIndex = seedIndex;
+  for (const auto offset : region)
   {
-    return; // Should we do something?
+    resultBuffer[offset] = 1;
+    const typename OutputImageType::IndexType index = resultImage->ComputeIndex(offset);
+    for (unsigned int d = 0; d < imageDimension; ++d)
+    {
+      minimumIndex[d] = std::min(minimumIndex[d], index[d]);
+      maximumIndex[d] = std::max(maximumIndex[d], index[d]);
+    }
   }
 
-  typename OutputImageType::Pointer resultImage = regionGrower->GetOutput();
-
   // Smooth result: Every pixel is replaced by the majority of the neighborhood
   typedef itk::NeighborhoodIterator<OutputImageType> NeighborhoodIteratorType;
   typedef itk::ImageRegionIterator<OutputImageType> ImageIteratorType;
@@ -227,6 +262,15 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
   typename NeighborhoodIteratorType::RadiusType radius;
   radius.Fill(2); // for now, maybe make this something the user can adjust in the preferences?
 
+  typename OutputImageType::RegionType smoothingRegion;
+  smoothingRegion.SetIndex(minimumIndex);
+  for (unsigned int d = 0; d < imageDimension; ++d)
+  {
+    smoothingRegion.SetSize(d, maximumIndex[d] - minimumIndex[d] + 1);
+  }
+  smoothingRegion.PadByRadius(radius);
+  smoothingRegion.Crop(resultImage->GetLargestPossibleRegion());
+
   typedef itk::ImageDuplicator< OutputImageType > DuplicatorType;
   typename DuplicatorType::Pointer duplicator = DuplicatorType::New();
   duplicator->SetInputImage(resultImage);
@@ -234,8 +278,8 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
 
   typename OutputImageType::Pointer resultDup = duplicator->GetOutput();
 
-  NeighborhoodIteratorType neighborhoodIterator(radius, resultDup, resultDup->GetRequestedRegion());
-  ImageIteratorType imageIterator(resultImage, resultImage->GetRequestedRegion());
+  NeighborhoodIteratorType neighborhoodIterator(radius, resultDup, smoothingRegion);
+  ImageIteratorType imageIterator(resultImage, smoothingRegion);
 
   for (neighborhoodIterator.GoToBegin(), imageIterator.GoToBegin(); !neighborhoodIterator.IsAtEnd();
        ++neighborhoodIterator, ++imageIterator)
@@ -265,21 +309,37 @@ void mitk::RegionGrowingTool::StartRegionGrowing(itk::Image<TPixel, imageDimensi
     }
   }
 
-  if (resultImage.IsNull())
+  // Smoothing can split the region, keep only the component of the seed (face connected, marked with 2 first)
+  m_ConnectedComponentValue = 0;
+  if (resultImage->GetPixel(seedIndex) > 0)
   {
-    MITK_DEBUG << "Region growing result is empty.";
+    std::vector<typename OutputImageType::IndexType> component(1, seedIndex);
+    resultImage->SetPixel(seedIndex, 2);
+    for (std::size_t front = 0; front < component.size(); ++front)
+    {
+      for (unsigned int d = 0; d < imageDimension; ++d)
+      {
+        for (int step = -1; step <= 1; step += 2)
+        {
+          typename OutputImageType::IndexType neighbor = component[front];
+          neighbor[d] += step;
+          if (smoothingRegion.IsInside(neighbor) && resultImage->GetPixel(neighbor) == 1)
+          {
+            resultImage->SetPixel(neighbor, 2);
+            component.push_back(neighbor);
+          }
+        }
+      }
+    }
+    m_ConnectedComponentValue = 1;
   }
 
-  // Can potentially have multiple regions, use connected component image filter to label disjunct regions
-  typedef itk::ConnectedComponentImageFilter<OutputImageType, OutputImageType> ConnectedComponentImageFilterType;
-  typename ConnectedComponentImageFilterType::Pointer connectedComponentFilter =
-    ConnectedComponentImageFilterType::New();
-  connectedComponentFilter->SetInput(resultImage);
-  connectedComponentFilter->Update();
-  typename OutputImageType::Pointer resultImageCC = connectedComponentFilter->GetOutput();
-  m_ConnectedComponentValue = resultImageCC->GetPixel(seedIndex);
+  for (imageIterator.GoToBegin(); !imageIterator.IsAtEnd(); ++imageIterator)
+  {
+    imageIterator.Set(imageIterator.Get() == 2 ? 1 : 0);
+  }
 
-  outputImage = mitk::GrabItkImageMemory(resultImageCC);
+  outputImage = mitk::GrabItkImageMemory(resultImage);
 }
 
 void mitk::RegionGrowingTool::OnMousePressed(StateMachineAction *, InteractionEvent *interactionEvent)
@@ -294,6 +354,9 @@ void mitk::RegionGrowingTool::OnMousePressed(StateMachineAction *, InteractionEv
   m_LastEventSlice = m_LastEventSender->GetSlice();
   m_LastScreenPosition = positionEvent->GetPointerPositionOnScreen();
 
+  // a new seed needs a new flood order
+  m_RegionGrowing = nullptr;
+
   // ReferenceSlice is from the underlying image, WorkingSlice from the active segmentation (can be empty)
   m_ReferenceSlice = FeedbackContourTool::GetAffectedReferenceSlice(positionEvent);
   m_WorkingSlice = FeedbackContourTool::GetAffectedWorkingSlice(positionEvent);
@@ -578,6 +641,9 @@ void mitk::RegionGrowingTool::OnMouseMoved(StateMachineAction *, InteractionEven
 
 void mitk::RegionGrowingTool::OnMouseReleased(StateMachineAction *, InteractionEvent *interactionEvent)
 {
+  // the flood order is not needed any more after the threshold has been chosen
+  m_RegionGrowing = nullptr;
+
   // Until OnMousePressedInside() implements a behaviour, we're just returning here whenever m_PaintingPixelValue is 0,
   // i.e. when the user clicked inside the segmentation
   if (m_PaintingPixelValue == 0)
@@ -125,7 +125,11 @@ namespace mitk
                               bool *result);
 
     /**
-     * @brief Template that calls an ITK filter to do the region growing.
+     * @brief Template that does the region growing, smoothes the result and keeps the component of the seed.
+     *
+     * The flood order of mitk::IncrementalRegionGrowing is kept in m_RegionGrowing until the next click, so
+     * changing the thresholds while the mouse is moved only selects a different part of it. Smoothing and
+     * connected component search are restricted to the bounding box of the grown region.
      */
     template <typename TPixel, unsigned int imageDimension>
     void StartRegionGrowing(itk::Image<TPixel, imageDimension> *itkImage,
@@ -144,6 +148,9 @@ namespace mitk
     int m_ScreenYDifference;
     int m_ScreenXDifference;
 
+    // mitk::IncrementalRegionGrowing for the pixel type of the reference slice, reset on every click
+    itk::Object::Pointer m_RegionGrowing;
+
   private:
     ScalarType m_MouseDistanceScaleFactor;
     int m_PaintingPixelValue;
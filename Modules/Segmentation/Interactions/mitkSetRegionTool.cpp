@@ -23,11 +23,11 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkLabelSetImage.h"
 
 #include <mitkITKImageImport.h>
+#include <mitkIncrementalRegionGrowing.h>
 #include <mitkImagePixelReadAccessor.h>
 #include <mitkImageToContourModelFilter.h>
 
 #include <itkBinaryFillholeImageFilter.h>
-#include <itkConnectedThresholdImageFilter.h>
 
 mitk::SetRegionTool::SetRegionTool(int paintingPixelValue)
   : FeedbackContourTool("PressMoveRelease"), m_PaintingPixelValue(paintingPixelValue)
@@ -81,8 +81,7 @@ void mitk::SetRegionTool::OnMousePressed(StateMachineAction *, InteractionEvent
 
   typedef itk::Image<DefaultSegmentationDataType, 2> InputImageType;
   typedef InputImageType::IndexType IndexType;
-  typedef itk::ConnectedThresholdImageFilter<InputImageType, InputImageType> RegionGrowingFilterType;
-  RegionGrowingFilterType::Pointer regionGrower = RegionGrowingFilterType::New();
+  typedef mitk::IncrementalRegionGrowing<DefaultSegmentationDataType, 2> RegionGrowingType;
 
   // convert world coordinates to image indices
   IndexType seedIndex;
@@ -91,19 +90,29 @@ void mitk::SetRegionTool::OnMousePressed(StateMachineAction *, InteractionEvent
   // perform region growing in desired segmented region
   InputImageType::Pointer itkImage = InputImageType::New();
   CastToItkImage(workingSlice, itkImage);
-  regionGrower->SetInput(itkImage);
-  regionGrower->AddSeed(seedIndex);
 
   InputImageType::PixelType bound = itkImage->GetPixel(seedIndex);
 
-  regionGrower->SetLower(bound);
-  regionGrower->SetUpper(bound);
-  regionGrower->SetReplaceValue(1);
+  // the flood stops at the border of the clicked region, nothing else of the slice is visited
+  RegionGrowingType::Pointer regionGrowing = RegionGrowingType::New();
+  regionGrowing->Initialize(itkImage, seedIndex);
+  RegionGrowingType::RegionType region;
+  regionGrowing->ComputeRegion(bound, bound, region);
+
+  InputImageType::Pointer regionImage = InputImageType::New();
+  regionImage->CopyInformation(itkImage);
+  regionImage->SetRegions(itkImage->GetLargestPossibleRegion());
+  regionImage->Allocate();
+  regionImage->FillBuffer(0);
+  for (const auto offset : region)
+  {
+    regionImage->GetBufferPointer()[offset] = 1;
+  }
 
   itk::BinaryFillholeImageFilter<InputImageType>::Pointer fillHolesFilter =
     itk::BinaryFillholeImageFilter<InputImageType>::New();
 
-  fillHolesFilter->SetInput(regionGrower->GetOutput());
+  fillHolesFilter->SetInput(regionImage);
   fillHolesFilter->SetForegroundValue(1);
 
   // Store result and preview
@@ -5,6 +5,7 @@ set(MODULE_TESTS
   mitkDataNodeSegmentationTest.cpp
   mitkFeatureBasedEdgeDetectionFilterTest.cpp
   mitkImageToContourFilterTest.cpp
+  mitkIncrementalRegionGrowingTest.cpp
   mitkSegmentationInterpolationTest.cpp
   mitkOverwriteSliceFilterTest.cpp
   mitkOverwriteSliceFilterObliquePlaneTest.cpp
@@ -0,0 +1,140 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include "mitkTestingMacros.h"
+#include <mitkIncrementalRegionGrowing.h>
+#include <mitkTestFixture.h>
+
+#include <itkConnectedThresholdImageFilter.h>
+#include <itkImageRegionIterator.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+class mitkIncrementalRegionGrowingTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(mitkIncrementalRegionGrowingTestSuite);
+  MITK_TEST(TestRegionMatchesConnectedThreshold2D);
+  MITK_TEST(TestRegionMatchesConnectedThreshold3D);
+  MITK_TEST(TestSeedOutsideThresholds);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  template <typename TPixel, unsigned int VDimension>
+  typename itk::Image<TPixel, VDimension>::Pointer CreateNoiseImage(unsigned int size)
+  {
+    typedef itk::Image<TPixel, VDimension> ImageType;
+    typename ImageType::Pointer image = ImageType::New();
+    typename ImageType::SizeType imageSize;
+    imageSize.Fill(size);
+    image->SetRegions(imageSize);
+    image->Allocate();
+
+    std::srand(42);
+    itk::ImageRegionIterator<ImageType> iter(image, image->GetLargestPossibleRegion());
+    for (iter.GoToBegin(); !iter.IsAtEnd(); ++iter)
+    {
+      iter.Set(static_cast<TPixel>(std::rand() % 100));
+    }
+    return image;
+  }
+
+  /** Compares the region of every window with the output of itk::ConnectedThresholdImageFilter */
+  template <typename TPixel, unsigned int VDimension>
+  void CompareWithConnectedThreshold(itk::Image<TPixel, VDimension> *image, double center)
+  {
+    typedef itk::Image<TPixel, VDimension> ImageType;
+    typedef itk::Image<unsigned char, VDimension> MaskType;
+    typedef mitk::IncrementalRegionGrowing<TPixel, VDimension> RegionGrowingType;
+
+    typename ImageType::IndexType seed;
+    seed.Fill(image->GetLargestPossibleRegion().GetSize(0) / 2);
+
+    typename RegionGrowingType::Pointer regionGrowing = RegionGrowingType::New();
+    regionGrowing->Initialize(image, seed, center, 1.0, 1.0);
+
+    // symmetric windows (prefix selection) and shifted windows (search inside the prefix), growing and shrinking
+    const double windows[][2] = {{-10, 10}, {-30, 30}, {-20, 20}, {-45, 5}, {-5, 45}, {-35, 35}, {-2.5, 1.5}, {-50, 50}};
+    for (const auto &window : windows)
+    {
+      const double lower = center + window[0];
+      const double upper = center + window[1];
+
+      typename RegionGrowingType::RegionType region;
+      regionGrowing->ComputeRegion(lower, upper, region);
+
+      typedef itk::ConnectedThresholdImageFilter<ImageType, MaskType> ConnectedThresholdType;
+      typename ConnectedThresholdType::Pointer connectedThreshold = ConnectedThresholdType::New();
+      connectedThreshold->SetInput(image);
+      connectedThreshold->AddSeed(seed);
+      connectedThreshold->SetLower(lower);
+      connectedThreshold->SetUpper(upper);
+      connectedThreshold->SetReplaceValue(1);
+      connectedThreshold->Update();
+
+      const unsigned char *expected = connectedThreshold->GetOutput()->GetBufferPointer();
+      const std::size_t numberOfVoxels = connectedThreshold->GetOutput()->GetLargestPossibleRegion().GetNumberOfPixels();
+
+      std::vector<unsigned char> mask(numberOfVoxels, 0);
+      for (const auto offset : region)
+      {
+        CPPUNIT_ASSERT_MESSAGE("Voxel occurs twice in the region", mask[offset] == 0);
+        mask[offset] = 1;
+      }
+      CPPUNIT_ASSERT_MESSAGE("Region differs from itk::ConnectedThresholdImageFilter",
+                             std::equal(mask.begin(), mask.end(), expected));
+    }
+
+    CPPUNIT_ASSERT_MESSAGE("Flood order visited more voxels than the image has",
+                           regionGrowing->GetNumberOfOrderedVoxels() <=
+                             image->GetLargestPossibleRegion().GetNumberOfPixels());
+  }
+
+public:
+  void TestRegionMatchesConnectedThreshold2D()
+  {
+    auto image = CreateNoiseImage<short, 2>(64);
+    CompareWithConnectedThreshold<short, 2>(image, 50.0);
+    CompareWithConnectedThreshold<short, 2>(image, 47.3);
+  }
+
+  void TestRegionMatchesConnectedThreshold3D()
+  {
+    auto image = CreateNoiseImage<float, 3>(24);
+    CompareWithConnectedThreshold<float, 3>(image, 50.0);
+  }
+
+  void TestSeedOutsideThresholds()
+  {
+    typedef itk::Image<short, 2> ImageType;
+    auto image = CreateNoiseImage<short, 2>(16);
+    ImageType::IndexType seed;
+    seed.Fill(8);
+
+    auto regionGrowing = mitk::IncrementalRegionGrowing<short, 2>::New();
+    regionGrowing->Initialize(image, seed);
+
+    const double seedValue = image->GetPixel(seed);
+    mitk::IncrementalRegionGrowing<short, 2>::RegionType region;
+    CPPUNIT_ASSERT_MESSAGE("Region not empty although the seed is above the window",
+                           regionGrowing->ComputeRegion(seedValue - 10, seedValue - 1, region) == 0);
+    CPPUNIT_ASSERT_MESSAGE("Region does not contain the seed",
+                           regionGrowing->ComputeRegion(seedValue, seedValue, region) >= 1 &&
+                             region[0] == 8 * 16 + 8);
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkIncrementalRegionGrowing)
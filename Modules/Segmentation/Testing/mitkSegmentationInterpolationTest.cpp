@@ -35,6 +35,7 @@ class mitkSegmentationInterpolationTestSuite : public mitk::TestFixture
   MITK_TEST(Equal_Axial_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Frontal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
   MITK_TEST(Equal_Sagittal_TestInterpolationAndReferenceInterpolation_ReturnsTrue);
+  MITK_TEST(SegmentedSlices_FollowDifferenceImages);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -203,6 +204,63 @@ public:
     mitk::SliceNavigationController::ViewDirection viewDirection = mitk::SliceNavigationController::Sagittal;
     testRoutine(viewDirection);
   }
+
+  void SegmentedSlices_FollowDifferenceImages()
+  {
+    // three pixels in a row in two axial slices
+    {
+      mitk::ImagePixelWriteAccessor<mitk::Tool::DefaultSegmentationDataType, 3> writeAccessor(m_SegmentationImage);
+      for (itk::IndexValueType z = 10; z <= 20; z += 10)
+      {
+        for (itk::IndexValueType x = 100; x <= 102; ++x)
+        {
+          writeAccessor.SetPixelByIndexSafe({{x, 50, z}}, 1);
+        }
+      }
+    }
+    m_InterpolationController->SetSegmentationVolume(m_SegmentationImage);
+
+    unsigned int lower(0);
+    unsigned int upper(0);
+    CPPUNIT_ASSERT_MESSAGE("Segmented neighbors of axial slice 15",
+                           m_InterpolationController->GetNeighboringSegmentedSlices(2, 15, 0, lower, upper) &&
+                             lower == 10 && upper == 20);
+    CPPUNIT_ASSERT_MESSAGE("Segmented neighbors of segmented axial slice 10",
+                           !m_InterpolationController->GetNeighboringSegmentedSlices(2, 10, 0, lower, upper));
+
+    // remove the pixels of slice 20 with a difference image, like mitk::DiffImageApplier does
+    mitk::Image::Pointer diffImage = mitk::Image::New();
+    diffImage->Initialize(mitk::MakeScalarPixelType<short>(), 2, m_SegmentationImage->GetDimensions());
+    {
+      mitk::ImageWriteAccessor imageAccessor(diffImage);
+      memset(imageAccessor.GetData(), 0, sizeof(short) * diffImage->GetDimension(0) * diffImage->GetDimension(1));
+    }
+    {
+      mitk::ImagePixelWriteAccessor<short, 2> writeAccessor(diffImage);
+      for (itk::IndexValueType x = 100; x <= 102; ++x)
+      {
+        writeAccessor.SetPixelByIndex({{x, 50}}, -1);
+      }
+    }
+    m_InterpolationController->SetChangedSlice(diffImage, 2, 20, 0);
+
+    CPPUNIT_ASSERT_MESSAGE("Removed slice is still a neighbor",
+                           !m_InterpolationController->GetNeighboringSegmentedSlices(2, 15, 0, lower, upper));
+
+    // add the pixels to slice 30
+    {
+      mitk::ImagePixelWriteAccessor<short, 2> writeAccessor(diffImage);
+      for (itk::IndexValueType x = 100; x <= 102; ++x)
+      {
+        writeAccessor.SetPixelByIndex({{x, 50}}, 1);
+      }
+    }
+    m_InterpolationController->SetChangedSlice(diffImage, 2, 30, 0);
+
+    CPPUNIT_ASSERT_MESSAGE("Segmented neighbors of axial slice 15 after adding slice 30",
+                           m_InterpolationController->GetNeighboringSegmentedSlices(2, 15, 0, lower, upper) &&
+                             lower == 10 && upper == 30);
+  }
 };
 
 MITK_TEST_SUITE_REGISTRATION(mitkSegmentationInterpolation)
@@ -9,6 +9,7 @@ set(MODULE_TESTS
   #mitkToFImageRecorderFilterTest.cpp
   mitkToFImageWriterTest.cpp
   mitkToFNrrdImageWriterTest.cpp
+  mitkToFNrrdFrameReaderTest.cpp
   mitkToFOpenCVImageGrabberTest.cpp
 )
 
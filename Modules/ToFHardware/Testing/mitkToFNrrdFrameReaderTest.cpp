@@ -0,0 +1,148 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+
+#include <mitkImage.h>
+#include <mitkTestingMacros.h>
+#include <mitkTestFixture.h>
+#include <mitkToFCameraMITKPlayerController.h>
+#include <mitkToFNrrdFrameReader.h>
+#include <mitkToFNrrdImageWriter.h>
+#include <mitkImageGenerator.h>
+#include <mitkImageReadAccessor.h>
+
+#include <cstdio>
+#include <cstring>
+
+class mitkToFNrrdFrameReaderTestSuite : public mitk::TestFixture
+{
+
+  CPPUNIT_TEST_SUITE(mitkToFNrrdFrameReaderTestSuite);
+  MITK_TEST(ReadFrame_WrittenRecording_FramesAreEqualToInput);
+  MITK_TEST(ReadFrame_RecordingNotClosed_WrittenChunksAreReadable);
+  MITK_TEST(UpdateCamera_StreamingPlayback_FramesAreEqualToInput);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+
+  mitk::ToFNrrdImageWriter::Pointer m_ToFNrrdImageWriter;
+  std::string m_DistanceImageName;
+  mitk::Image::Pointer m_GroundTruthDepthImage;
+
+  unsigned int m_DimX;
+  unsigned int m_DimY;
+  unsigned int m_NumberOfFrames;
+
+  void WriteFrames(unsigned int numberOfFrames)
+  {
+    m_ToFNrrdImageWriter->Open();
+    for(unsigned int i = 0; i < numberOfFrames ; ++i)
+    {
+      mitk::ImageReadAccessor distAcc(m_GroundTruthDepthImage, m_GroundTruthDepthImage->GetSliceData(i % m_NumberOfFrames, 0, 0));
+      m_ToFNrrdImageWriter->Add((float*)distAcc.GetData(), nullptr, nullptr);
+    }
+  }
+
+  bool IsEqualToGroundTruth(unsigned int frame, const float* data)
+  {
+    mitk::ImageReadAccessor distAcc(m_GroundTruthDepthImage, m_GroundTruthDepthImage->GetSliceData(frame, 0, 0));
+    return memcmp(distAcc.GetData(), data, m_DimX * m_DimY * sizeof(float)) == 0;
+  }
+
+public:
+
+  void setUp() override
+  {
+    m_DimX = 64;
+    m_DimY = 48;
+    m_NumberOfFrames = 23;
+    m_GroundTruthDepthImage = mitk::ImageGenerator::GenerateRandomImage<float>(m_DimX, m_DimY, m_NumberOfFrames, 1.0, 1.0f, 1.0f);
+
+    m_ToFNrrdImageWriter = mitk::ToFNrrdImageWriter::New();
+    m_ToFNrrdImageWriter->SetToFImageType(mitk::ToFNrrdImageWriter::ToFImageType3D);
+    m_ToFNrrdImageWriter->SetToFCaptureWidth(m_DimX);
+    m_ToFNrrdImageWriter->SetToFCaptureHeight(m_DimY);
+
+    m_DistanceImageName = "test_StreamedDistanceImage.nrrd";
+    m_ToFNrrdImageWriter->SetDistanceImageFileName(m_DistanceImageName);
+  }
+
+  void tearDown() override
+  {
+    remove( m_DistanceImageName.c_str() );
+  }
+
+  void ReadFrame_WrittenRecording_FramesAreEqualToInput()
+  {
+    this->WriteFrames(m_NumberOfFrames);
+    m_ToFNrrdImageWriter->Close();
+
+    mitk::ToFNrrdFrameReader::Pointer reader = mitk::ToFNrrdFrameReader::New();
+    CPPUNIT_ASSERT_MESSAGE("Written recording can not be streamed", reader->Open(m_DistanceImageName));
+    CPPUNIT_ASSERT_EQUAL(3u, reader->GetDimension());
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(m_DimX), reader->GetWidth());
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(m_DimY), reader->GetHeight());
+    CPPUNIT_ASSERT_EQUAL(static_cast<int>(m_NumberOfFrames), reader->GetNumberOfFrames());
+
+    std::vector<float> frame(m_DimX * m_DimY);
+    // backwards, frames are read independently of each other
+    for (int i = m_NumberOfFrames - 1; i >= 0; --i)
+    {
+      reader->ReadFrame(i, frame.data());
+      CPPUNIT_ASSERT_MESSAGE("Streamed frame is not equal to the test data", this->IsEqualToGroundTruth(i, frame.data()));
+    }
+  }
+
+  void ReadFrame_RecordingNotClosed_WrittenChunksAreReadable()
+  {
+    // the header is updated every 100 frames
+    this->WriteFrames(250);
+
+    mitk::ToFNrrdFrameReader::Pointer reader = mitk::ToFNrrdFrameReader::New();
+    CPPUNIT_ASSERT(reader->Open(m_DistanceImageName));
+    CPPUNIT_ASSERT_EQUAL(200, reader->GetNumberOfFrames());
+
+    std::vector<float> frame(m_DimX * m_DimY);
+    reader->ReadFrame(199, frame.data());
+    CPPUNIT_ASSERT(this->IsEqualToGroundTruth(199 % m_NumberOfFrames, frame.data()));
+
+    reader->Close();
+    m_ToFNrrdImageWriter->Close();
+  }
+
+  void UpdateCamera_StreamingPlayback_FramesAreEqualToInput()
+  {
+    this->WriteFrames(m_NumberOfFrames);
+    m_ToFNrrdImageWriter->Close();
+
+    mitk::ToFCameraMITKPlayerController::Pointer controller = mitk::ToFCameraMITKPlayerController::New();
+    controller->SetRingBufferSize(4);
+    controller->SetDistanceImageFileName(m_DistanceImageName);
+    CPPUNIT_ASSERT(controller->OpenCameraConnection());
+
+    std::vector<float> frame(m_DimX * m_DimY);
+    // plays the recording twice, the prefetching wraps around at the end
+    for (unsigned int i = 0; i < 2 * m_NumberOfFrames; ++i)
+    {
+      controller->UpdateCamera();
+      controller->GetDistances(frame.data());
+      CPPUNIT_ASSERT_MESSAGE("Played frame is not equal to the test data",
+                             this->IsEqualToGroundTruth(i % m_NumberOfFrames, frame.data()));
+    }
+    CPPUNIT_ASSERT(controller->CloseCameraConnection());
+  }
+};
+
+MITK_TEST_SUITE_REGISTRATION(mitkToFNrrdFrameReader)
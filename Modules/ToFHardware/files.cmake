@@ -3,6 +3,7 @@ SET(CPP_FILES
   mitkToFImageRecorderFilter.cpp
   mitkToFImageWriter.cpp
   mitkToFNrrdImageWriter.cpp
+  mitkToFNrrdFrameReader.cpp
   mitkToFImageCsvWriter.cpp
   mitkIToFDeviceFactory.cpp
   mitkAbstractToFDeviceFactory.cpp
@@ -21,6 +21,8 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include <mitkIpPic.h>
 #include "mitkImageReadAccessor.h"
 
+#include <algorithm>
+
 namespace mitk
 {
 
@@ -54,7 +56,14 @@ ToFCameraMITKPlayerController::ToFCameraMITKPlayerController() :
   m_RGBImageFileName(""),
   m_PixelStartInFile(0),
   m_CurrentFrame(-1),
-  m_NumOfFrames(0)
+  m_NumOfFrames(0),
+  m_StreamingPlayback(true),
+  m_RingBufferSize(8),
+  m_FrameReaders(4),
+  m_RingBufferStart(0),
+  m_RingBufferCount(0),
+  m_NextPrefetchFrame(0),
+  m_StopPrefetching(false)
 {
   m_ImageStatus = std::vector<bool>(4,true);
 }
@@ -66,6 +75,9 @@ ToFCameraMITKPlayerController::~ToFCameraMITKPlayerController()
 
 void ToFCameraMITKPlayerController::CleanUp()
 {
+  this->StopPrefetching();
+  m_FrameReaders = std::vector<ToFNrrdFrameReader::Pointer>(4);
+
   if(m_DistanceImage.IsNotNull())
   {
     m_DistanceImage->ReleaseData();
@@ -118,108 +130,145 @@ bool ToFCameraMITKPlayerController::OpenCameraConnection()
         throw std::logic_error("No image data file names set");
       }
 
-      if (!this->m_DistanceImageFileName.empty())
-      {
-        m_DistanceImage = mitk::IOUtil::Load<mitk::Image>(this->m_DistanceImageFileName);
-      }
-      else
-      {
-        MITK_ERROR << "ToF distance image data file empty";
-      }
-      if (!this->m_AmplitudeImageFileName.empty())
-      {
-        m_AmplitudeImage = mitk::IOUtil::Load<mitk::Image>(this->m_AmplitudeImageFileName);
-      }
-      else
-      {
-        MITK_WARN << "ToF amplitude image data file empty";
-      }
-      if (!this->m_IntensityImageFileName.empty())
-      {
-        m_IntensityImage = mitk::IOUtil::Load<mitk::Image>(this->m_IntensityImageFileName);
-      }
-      else
-      {
-        MITK_WARN << "ToF intensity image data file empty";
-      }
-      if (!this->m_RGBImageFileName.empty())
+      const bool streaming = m_StreamingPlayback && this->OpenFrameReaders();
+      if (streaming)
       {
-        m_RGBImage = mitk::IOUtil::Load<mitk::Image>(this->m_RGBImageFileName);
+        // only the headers were read, see StartPrefetching()
+        ToFNrrdFrameReader::Pointer infoReader = nullptr;
+        this->m_NumOfFrames = 0;
+        for (unsigned int i = 0; i < m_FrameReaders.size(); ++i)
+        {
+          m_ImageStatus.at(i) = m_FrameReaders[i].IsNotNull();
+          if (m_ImageStatus.at(i))
+          {
+            if (infoReader.IsNull())
+            {
+              infoReader = m_FrameReaders[i];
+              this->m_NumOfFrames = m_FrameReaders[i]->GetNumberOfFrames();
+            }
+            this->m_NumOfFrames = std::min(this->m_NumOfFrames, m_FrameReaders[i]->GetNumberOfFrames());
+          }
+        }
+
+        this->m_ToFImageType = infoReader->GetDimension() == 3 ? ToFImageType3D : ToFImageType2DPlusT;
+        this->m_CaptureWidth = infoReader->GetWidth();
+        this->m_CaptureHeight = infoReader->GetHeight();
+        this->m_PixelNumber = this->m_CaptureWidth*this->m_CaptureHeight;
+        this->m_NumberOfBytes = this->m_PixelNumber * sizeof(float);
+
+        if (m_ImageStatus.at(3))
+        {
+          m_RGBCaptureWidth = m_FrameReaders[3]->GetWidth();
+          m_RGBCaptureHeight = m_FrameReaders[3]->GetHeight();
+          m_RGBPixelNumber = m_RGBCaptureWidth * m_RGBCaptureHeight;
+          m_NumberOfRGBBytes = m_RGBPixelNumber * 3;
+        }
       }
       else
       {
-        MITK_WARN << "ToF RGB image data file empty";
-      }
-
-      // check if the opened files contained data
-      if(m_DistanceImage.IsNull())
-      {
-        m_ImageStatus.at(0) = false;
-      }
-      if(m_AmplitudeImage.IsNull())
-      {
-        m_ImageStatus.at(1) = false;
-      }
-      if(m_IntensityImage.IsNull())
-      {
-        m_ImageStatus.at(2) = false;
-      }
-      if(m_RGBImage.IsNull())
-      {
-        m_ImageStatus.at(3) = false;
-      }
-
-      // Check for dimension type
-      mitk::Image::Pointer infoImage = nullptr;
-      if(m_ImageStatus.at(0))
-      {
-        infoImage = m_DistanceImage;
-      }
-      else if (m_ImageStatus.at(1))
-      {
-        infoImage = m_AmplitudeImage;
-      }
-      else if(m_ImageStatus.at(2))
-      {
-        infoImage = m_IntensityImage;
-      }
-      else if(m_ImageStatus.at(3))
-      {
-        infoImage = m_RGBImage;
-      }
-
-      if (infoImage->GetDimension() == 2)
-        this->m_ToFImageType = ToFImageType2DPlusT;
-
-      else if (infoImage->GetDimension() == 3)
-        this->m_ToFImageType = ToFImageType3D;
-
-      else if (infoImage->GetDimension() == 4)
-        this->m_ToFImageType = ToFImageType2DPlusT;
-
-      else
-        throw std::logic_error("Error opening ToF data file: Invalid dimension.");
-
-      this->m_CaptureWidth = infoImage->GetDimension(0);
-      this->m_CaptureHeight = infoImage->GetDimension(1);
-      this->m_PixelNumber = this->m_CaptureWidth*this->m_CaptureHeight;
-      this->m_NumberOfBytes = this->m_PixelNumber * sizeof(float);
-
-      if(m_RGBImage)
-      {
-        m_RGBCaptureWidth = m_RGBImage->GetDimension(0);
-        m_RGBCaptureHeight = m_RGBImage->GetDimension(1);
-        m_RGBPixelNumber = m_RGBCaptureWidth * m_RGBCaptureHeight;
-        m_NumberOfRGBBytes = m_RGBPixelNumber * 3;
-      }
-
-      if (this->m_ToFImageType == ToFImageType2DPlusT)
-      {
-        this->m_NumOfFrames = infoImage->GetDimension(3);
-      }
-      else
-      {
-        this->m_NumOfFrames = infoImage->GetDimension(2);
+        if (!this->m_DistanceImageFileName.empty())
+        {
+          m_DistanceImage = mitk::IOUtil::Load<mitk::Image>(this->m_DistanceImageFileName);
+        }
+        else
+        {
+          MITK_ERROR << "ToF distance image data file empty";
+        }
+        if (!this->m_AmplitudeImageFileName.empty())
+        {
+          m_AmplitudeImage = mitk::IOUtil::Load<mitk::Image>(this->m_AmplitudeImageFileName);
+        }
+        else
+        {
+          MITK_WARN << "ToF amplitude image data file empty";
+        }
+        if (!this->m_IntensityImageFileName.empty())
+        {
+          m_IntensityImage = mitk::IOUtil::Load<mitk::Image>(this->m_IntensityImageFileName);
+        }
+        else
+        {
+          MITK_WARN << "ToF intensity image data file empty";
+        }
+        if (!this->m_RGBImageFileName.empty())
+        {
+          m_RGBImage = mitk::IOUtil::Load<mitk::Image>(this->m_RGBImageFileName);
+        }
+        else
+        {
+          MITK_WARN << "ToF RGB image data file empty";
+        }
+
+        // check if the opened files contained data
+        if(m_DistanceImage.IsNull())
+        {
+          m_ImageStatus.at(0) = false;
+        }
+        if(m_AmplitudeImage.IsNull())
+        {
+          m_ImageStatus.at(1) = false;
+        }
+        if(m_IntensityImage.IsNull())
+        {
+          m_ImageStatus.at(2) = false;
+        }
+        if(m_RGBImage.IsNull())
+        {
+          m_ImageStatus.at(3) = false;
+        }
+
+        // Check for dimension type
+        mitk::Image::Pointer infoImage = nullptr;
+        if(m_ImageStatus.at(0))
+        {
+          infoImage = m_DistanceImage;
+        }
+        else if (m_ImageStatus.at(1))
+        {
+          infoImage = m_AmplitudeImage;
+        }
+        else if(m_ImageStatus.at(2))
+        {
+          infoImage = m_IntensityImage;
+        }
+        else if(m_ImageStatus.at(3))
+        {
+          infoImage = m_RGBImage;
+        }
+
+        if (infoImage->GetDimension() == 2)
+          this->m_ToFImageType = ToFImageType2DPlusT;
+
+        else if (infoImage->GetDimension() == 3)
+          this->m_ToFImageType = ToFImageType3D;
+
+        else if (infoImage->GetDimension() == 4)
+          this->m_ToFImageType = ToFImageType2DPlusT;
+
+        else
+          throw std::logic_error("Error opening ToF data file: Invalid dimension.");
+
+        this->m_CaptureWidth = infoImage->GetDimension(0);
+        this->m_CaptureHeight = infoImage->GetDimension(1);
+        this->m_PixelNumber = this->m_CaptureWidth*this->m_CaptureHeight;
+        this->m_NumberOfBytes = this->m_PixelNumber * sizeof(float);
+
+        if(m_RGBImage)
+        {
+          m_RGBCaptureWidth = m_RGBImage->GetDimension(0);
+          m_RGBCaptureHeight = m_RGBImage->GetDimension(1);
+          m_RGBPixelNumber = m_RGBCaptureWidth * m_RGBCaptureHeight;
+          m_NumberOfRGBBytes = m_RGBPixelNumber * 3;
+        }
+
+        if (this->m_ToFImageType == ToFImageType2DPlusT)
+        {
+          this->m_NumOfFrames = infoImage->GetDimension(3);
+        }
+        else
+        {
+          this->m_NumOfFrames = infoImage->GetDimension(2);
+        }
       }
 
       // allocate buffer
@@ -234,6 +283,11 @@ bool ToFCameraMITKPlayerController::OpenCameraConnection()
 
       MITK_INFO << "NumOfFrames: " << this->m_NumOfFrames;
 
+      if (streaming)
+      {
+        this->StartPrefetching();
+      }
+
       this->m_ConnectionCheck = true;
       return this->m_ConnectionCheck;
     }
@@ -261,6 +315,13 @@ bool ToFCameraMITKPlayerController::CloseCameraConnection()
 
 void ToFCameraMITKPlayerController::UpdateCamera()
 {
+  if (!m_RingBuffer.empty())
+  {
+    this->TakePrefetchedFrame();
+    itksys::SystemTools::Delay(50);
+    return;
+  }
+
   this->m_CurrentFrame++;
   if(this->m_CurrentFrame >= this->m_NumOfFrames)
   {
@@ -309,6 +370,161 @@ void ToFCameraMITKPlayerController::AccessData(int frame, Image::Pointer image,
   }
 }
 
+bool ToFCameraMITKPlayerController::OpenFrameReaders()
+{
+  const std::string fileNames[] = { m_DistanceImageFileName, m_AmplitudeImageFileName, m_IntensityImageFileName, m_RGBImageFileName };
+
+  std::vector<ToFNrrdFrameReader::Pointer> frameReaders(4);
+  for (unsigned int i = 0; i < frameReaders.size(); ++i)
+  {
+    if (fileNames[i].empty())
+    {
+      continue;
+    }
+
+    ToFNrrdFrameReader::Pointer frameReader = ToFNrrdFrameReader::New();
+    if (!frameReader->Open(fileNames[i]))
+    {
+      return false;
+    }
+
+    // the ToF data is played as float, the RGB data as unsigned char triples
+    const bool isRGB = i == 3;
+    if (frameReader->GetComponentType() != (isRGB ? "unsigned char" : "float") ||
+        frameReader->GetNumberOfComponents() != (isRGB ? 3 : 1))
+    {
+      return false;
+    }
+    frameReaders[i] = frameReader;
+  }
+
+  MITK_INFO << "Streaming ToF data from file";
+  m_FrameReaders = frameReaders;
+  return true;
+}
+
+void ToFCameraMITKPlayerController::StartPrefetching()
+{
+  m_RingBuffer = std::vector<PrefetchedFrame>(std::max(m_RingBufferSize, 1));
+  for (auto &prefetchedFrame : m_RingBuffer)
+  {
+    prefetchedFrame.Frame = -1;
+    prefetchedFrame.Data.resize(m_FrameReaders.size());
+    for (unsigned int i = 0; i < m_FrameReaders.size(); ++i)
+    {
+      if (m_FrameReaders[i].IsNotNull())
+      {
+        prefetchedFrame.Data[i].resize(m_FrameReaders[i]->GetFrameSizeInBytes());
+      }
+    }
+  }
+
+  m_RingBufferStart = 0;
+  m_RingBufferCount = 0;
+  m_NextPrefetchFrame = 0;
+  m_StopPrefetching = false;
+  m_PrefetchThread = std::thread(&ToFCameraMITKPlayerController::PrefetchFrames, this);
+}
+
+void ToFCameraMITKPlayerController::StopPrefetching()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_RingBufferMutex);
+    m_StopPrefetching = true;
+  }
+  m_RingBufferCondition.notify_all();
+
+  if (m_PrefetchThread.joinable())
+  {
+    m_PrefetchThread.join();
+  }
+  m_RingBuffer.clear();
+}
+
+void ToFCameraMITKPlayerController::PrefetchFrames()
+{
+  while (true)
+  {
+    int slot = 0;
+    {
+      std::unique_lock<std::mutex> lock(m_RingBufferMutex);
+      m_RingBufferCondition.wait(lock, [this]() {
+        return m_StopPrefetching || m_RingBufferCount < static_cast<int>(m_RingBuffer.size());
+      });
+      if (m_StopPrefetching)
+      {
+        return;
+      }
+      slot = (m_RingBufferStart + m_RingBufferCount) % m_RingBuffer.size();
+    }
+
+    // the slot is free until it is counted, so the file is read without holding the lock
+    PrefetchedFrame &prefetchedFrame = m_RingBuffer[slot];
+    try
+    {
+      for (unsigned int i = 0; i < m_FrameReaders.size(); ++i)
+      {
+        if (m_FrameReaders[i].IsNotNull())
+        {
+          m_FrameReaders[i]->ReadFrame(m_NextPrefetchFrame, prefetchedFrame.Data[i].data());
+        }
+      }
+    }
+    catch (std::exception &e)
+    {
+      MITK_ERROR << "Error reading ToF frame " << m_NextPrefetchFrame << ": " << e.what();
+      {
+        std::lock_guard<std::mutex> lock(m_RingBufferMutex);
+        m_StopPrefetching = true;
+      }
+      m_RingBufferCondition.notify_all();
+      return;
+    }
+    prefetchedFrame.Frame = m_NextPrefetchFrame;
+    m_NextPrefetchFrame = (m_NextPrefetchFrame + 1) % m_NumOfFrames;
+
+    {
+      std::lock_guard<std::mutex> lock(m_RingBufferMutex);
+      ++m_RingBufferCount;
+    }
+    m_RingBufferCondition.notify_all();
+  }
+}
+
+void ToFCameraMITKPlayerController::TakePrefetchedFrame()
+{
+  std::unique_lock<std::mutex> lock(m_RingBufferMutex);
+  m_RingBufferCondition.wait(lock, [this]() { return m_StopPrefetching || m_RingBufferCount > 0; });
+  if (m_RingBufferCount == 0)
+  {
+    // reading failed, keep the last frame
+    return;
+  }
+  lock.unlock();
+
+  // the prefetch thread does not touch the slot until it is released below
+  const PrefetchedFrame &prefetchedFrame = m_RingBuffer[m_RingBufferStart];
+  float* const arrays[] = { m_DistanceArray, m_AmplitudeArray, m_IntensityArray };
+  for (unsigned int i = 0; i < 3; ++i)
+  {
+    if (m_ImageStatus.at(i))
+    {
+      memcpy(arrays[i], prefetchedFrame.Data[i].data(), m_NumberOfBytes);
+    }
+  }
+  if (m_ImageStatus.at(3))
+  {
+    memcpy(m_RGBArray, prefetchedFrame.Data[3].data(), m_NumberOfRGBBytes);
+  }
+  m_CurrentFrame = prefetchedFrame.Frame;
+
+  lock.lock();
+  m_RingBufferStart = (m_RingBufferStart + 1) % m_RingBuffer.size();
+  --m_RingBufferCount;
+  lock.unlock();
+  m_RingBufferCondition.notify_all();
+}
+
 void ToFCameraMITKPlayerController::GetAmplitudes(float* amplitudeArray)
 {
   memcpy(amplitudeArray, this->m_AmplitudeArray, this->m_NumberOfBytes);
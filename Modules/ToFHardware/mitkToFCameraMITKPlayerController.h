@@ -20,16 +20,25 @@ See LICENSE.txt or http://www.mitk.org for details.
 #include "mitkCommon.h"
 #include "mitkFileReader.h"
 #include "mitkImage.h"
+#include "mitkToFNrrdFrameReader.h"
 
 #include "itkObject.h"
 #include "itkObjectFactory.h"
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
 
 namespace mitk
 {
   /**
   * @brief Controller for playing ToF images saved in MITK (.pic) format
   *
+  * Uncompressed nrrd recordings as written by ToFNrrdImageWriter are streamed: only their headers are read on
+  * connection and a background thread reads the next frames into a ring buffer during playback. All other files
+  * are loaded completely on connection.
+  *
   * @ingroup ToFHardware
   */
   class MITKTOFHARDWARE_EXPORT ToFCameraMITKPlayerController : public itk::Object
@@ -90,6 +99,18 @@ namespace mitk
     itkSetMacro( AmplitudeImageFileName, std::string );
     itkSetMacro( IntensityImageFileName, std::string );
     itkSetMacro( RGBImageFileName, std::string );
+
+    /*!
+    \brief Stream nrrd recordings from file during playback instead of loading them on connection (default: true)
+    */
+    itkGetMacro( StreamingPlayback, bool );
+    itkSetMacro( StreamingPlayback, bool );
+    /*!
+    \brief Number of frames which are read ahead of the playback when streaming (default: 8)
+    */
+    itkGetMacro( RingBufferSize, int );
+    itkSetMacro( RingBufferSize, int );
+
     enum ToFImageType{ ToFImageType3D, ToFImageType2DPlusT };
 
   protected:
@@ -136,10 +157,48 @@ namespace mitk
     int m_CurrentFrame;
     int m_NumOfFrames;
 
+    bool m_StreamingPlayback; ///< flag showing whether nrrd recordings are streamed (true) or loaded completely (false)
+    int m_RingBufferSize; ///< number of frames read ahead of the playback when streaming
+    std::vector<ToFNrrdFrameReader::Pointer> m_FrameReaders; ///< readers of the distance, amplitude, intensity and rgb data when streaming
+
   private:
 
+    /*!
+    \brief Frame of all streamed recordings, read by the prefetch thread
+    */
+    struct PrefetchedFrame
+    {
+      int Frame;
+      std::vector<std::vector<char>> Data; ///< frame data in the order of m_FrameReaders
+    };
+
     void AccessData(int frame, Image::Pointer image, float* &data);
     void CleanUp();
+
+    /*!
+    \brief Opens all recordings for streaming
+    \return Returns 'false' if any of the recordings cannot be streamed
+    */
+    bool OpenFrameReaders();
+    void StartPrefetching();
+    void StopPrefetching();
+    /*!
+    \brief Method of the prefetch thread, fills the ring buffer with the frames following the last prefetched one
+    */
+    void PrefetchFrames();
+    /*!
+    \brief Copies the next prefetched frame into the frame arrays, waits if the prefetch thread lags behind
+    */
+    void TakePrefetchedFrame();
+
+    std::vector<PrefetchedFrame> m_RingBuffer; ///< frames read ahead of the playback
+    int m_RingBufferStart; ///< slot of the next frame to be played
+    int m_RingBufferCount; ///< number of prefetched frames which were not played yet
+    int m_NextPrefetchFrame; ///< frame to be read next by the prefetch thread
+    bool m_StopPrefetching; ///< flag telling the prefetch thread to finish
+    std::thread m_PrefetchThread;
+    std::mutex m_RingBufferMutex; ///< guards the ring buffer state
+    std::condition_variable m_RingBufferCondition; ///< signals changes of the ring buffer state
   };
 } //END mitk namespace
 #endif
@@ -0,0 +1,261 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#include <mitkToFNrrdFrameReader.h>
+
+// itk includes
+#include "itkByteSwapper.h"
+#include "itksys/SystemTools.hxx"
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  std::string Trim(const std::string &value)
+  {
+    const std::string whitespace(" \t\r");
+    std::string::size_type begin = value.find_first_not_of(whitespace);
+    if (begin == std::string::npos)
+    {
+      return std::string();
+    }
+    return value.substr(begin, value.find_last_not_of(whitespace) - begin + 1);
+  }
+
+  template <typename T>
+  std::vector<T> Split(const std::string &value)
+  {
+    std::vector<T> result;
+    std::istringstream stream(value);
+    T item;
+    while (stream >> item)
+    {
+      result.push_back(item);
+    }
+    return result;
+  }
+
+  // nrrd type names of the types supported by the player, see http://teem.sourceforge.net/nrrd/format.html#type
+  bool ParseNrrdType(const std::string &nrrdType, std::string &componentType, long &componentSize)
+  {
+    if (nrrdType == "float")
+    {
+      componentType = "float";
+      componentSize = sizeof(float);
+      return true;
+    }
+    if (nrrdType == "uchar" || nrrdType == "unsigned char" || nrrdType == "uint8" || nrrdType == "uint8_t")
+    {
+      componentType = "unsigned char";
+      componentSize = sizeof(unsigned char);
+      return true;
+    }
+    return false;
+  }
+}
+
+namespace mitk
+{
+  ToFNrrdFrameReader::ToFNrrdFrameReader() :
+    m_DataFile(),
+    m_DataOffset(0),
+    m_Dimension(0),
+    m_Width(0),
+    m_Height(0),
+    m_NumberOfFrames(0),
+    m_NumberOfComponents(1),
+    m_ComponentType(""),
+    m_FrameSizeInBytes(0)
+  {
+  }
+
+  ToFNrrdFrameReader::~ToFNrrdFrameReader()
+  {
+    this->Close();
+  }
+
+  bool ToFNrrdFrameReader::Open(const std::string &fileName)
+  {
+    this->Close();
+
+    std::ifstream header(fileName.c_str(), std::ifstream::binary);
+    if (!header.is_open())
+    {
+      MITK_ERROR << "Error opening ToF data file: " << fileName;
+      throw std::logic_error("Error opening ToF data file.");
+    }
+
+    std::string line;
+    std::getline(header, line);
+    if (line.compare(0, 7, "NRRD000") != 0)
+    {
+      // not a nrrd file, e.g. a legacy .pic recording
+      return false;
+    }
+
+    // the header ends with an empty line (or with the end of a detached header)
+    std::map<std::string, std::string> fields;
+    while (std::getline(header, line))
+    {
+      line = Trim(line);
+      if (line.empty())
+      {
+        break;
+      }
+      std::string::size_type separator = line.find(": ");
+      if (line[0] == '#' || separator == std::string::npos)
+      {
+        continue;
+      }
+      fields[line.substr(0, separator)] = Trim(line.substr(separator + 2));
+    }
+    std::streamoff headerSize = header.good() ? std::streamoff(header.tellg()) : std::streamoff(0);
+    header.close();
+
+    long componentSize = 0;
+    if (!ParseNrrdType(fields["type"], m_ComponentType, componentSize))
+    {
+      MITK_INFO << "Nrrd type " << fields["type"] << " of " << fileName << " is not supported for streaming";
+      return false;
+    }
+    if (fields["encoding"] != "raw")
+    {
+      MITK_INFO << "Nrrd encoding " << fields["encoding"] << " of " << fileName << " is not supported for streaming";
+      return false;
+    }
+    if (componentSize > 1 && fields.count("endian") != 0 &&
+        (fields["endian"] == "big") != itk::ByteSwapper<int>::SystemIsBigEndian())
+    {
+      MITK_INFO << "Byte order of " << fileName << " is not supported for streaming";
+      return false;
+    }
+    if (fields.count("line skip") != 0 && fields["line skip"] != "0")
+    {
+      return false;
+    }
+
+    std::vector<long> sizes = Split<long>(fields["sizes"]);
+    std::vector<std::string> kinds = Split<std::string>(fields["kinds"]);
+    std::vector<unsigned int> dimension = Split<unsigned int>(fields["dimension"]);
+    if (sizes.empty() || dimension.size() != 1 || sizes.size() != dimension.front())
+    {
+      MITK_ERROR << "Invalid nrrd header in " << fileName;
+      throw std::logic_error("Error opening ToF data file: Invalid nrrd header.");
+    }
+
+    // a leading axis which is not a domain axis holds the components of the pixels
+    m_NumberOfComponents = 1;
+    if (!kinds.empty() && kinds.front() != "domain" && kinds.front() != "space" && kinds.front() != "time")
+    {
+      m_NumberOfComponents = sizes.front();
+      sizes.erase(sizes.begin());
+    }
+    m_Dimension = sizes.size();
+    if (m_Dimension < 2 || m_Dimension > 4)
+    {
+      throw std::logic_error("Error opening ToF data file: Invalid dimension.");
+    }
+
+    m_Width = sizes[0];
+    m_Height = sizes[1];
+    m_FrameSizeInBytes = m_Width * m_Height * m_NumberOfComponents * componentSize;
+    long numberOfFrames = 1;
+    for (unsigned int i = 2; i < m_Dimension; ++i)
+    {
+      numberOfFrames *= sizes[i];
+    }
+
+    std::string dataFileName = fileName;
+    m_DataOffset = headerSize;
+    std::string dataFileField = fields.count("data file") != 0 ? fields["data file"] : fields["datafile"];
+    if (!dataFileField.empty())
+    {
+      if (dataFileField.compare(0, 4, "LIST") == 0 || dataFileField.find(' ') != std::string::npos)
+      {
+        // multiple data files
+        return false;
+      }
+      dataFileName = itksys::SystemTools::CollapseFullPath(dataFileField, itksys::SystemTools::GetFilenamePath(fileName));
+      m_DataOffset = 0;
+    }
+    if (fields.count("byte skip") != 0)
+    {
+      long byteSkip = std::stol(fields["byte skip"]);
+      if (byteSkip < 0)
+      {
+        return false;
+      }
+      m_DataOffset += byteSkip;
+    }
+
+    m_DataFile.open(dataFileName.c_str(), std::ifstream::binary);
+    if (!m_DataFile.is_open())
+    {
+      MITK_ERROR << "Error opening ToF data file: " << dataFileName;
+      throw std::logic_error("Error opening ToF data file.");
+    }
+
+    // a recording which was not closed properly holds fewer frames than its header announces
+    m_DataFile.seekg(0, std::ifstream::end);
+    std::streamoff availableFrames = (std::streamoff(m_DataFile.tellg()) - m_DataOffset) / m_FrameSizeInBytes;
+    if (availableFrames < numberOfFrames)
+    {
+      MITK_WARN << fileName << " holds only " << availableFrames << " of " << numberOfFrames << " frames";
+      numberOfFrames = availableFrames;
+    }
+    m_NumberOfFrames = numberOfFrames;
+    if (m_NumberOfFrames <= 0)
+    {
+      this->Close();
+      throw std::logic_error("Error opening ToF data file: File is empty.");
+    }
+
+    return true;
+  }
+
+  void ToFNrrdFrameReader::Close()
+  {
+    if (m_DataFile.is_open())
+    {
+      m_DataFile.close();
+    }
+    m_DataFile.clear();
+    m_NumberOfFrames = 0;
+  }
+
+  bool ToFNrrdFrameReader::IsOpen() const
+  {
+    return m_DataFile.is_open();
+  }
+
+  void ToFNrrdFrameReader::ReadFrame(int frame, void* data)
+  {
+    if (frame < 0 || frame >= m_NumberOfFrames)
+    {
+      throw std::out_of_range("Invalid ToF frame index.");
+    }
+
+    m_DataFile.seekg(m_DataOffset + std::streamoff(frame) * m_FrameSizeInBytes);
+    m_DataFile.read(static_cast<char*>(data), m_FrameSizeInBytes);
+    if (!m_DataFile)
+    {
+      m_DataFile.clear();
+      throw std::logic_error("Error reading ToF data file.");
+    }
+  }
+
+} // end namespace mitk
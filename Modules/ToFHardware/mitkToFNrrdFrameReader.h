@@ -0,0 +1,87 @@
+/*===================================================================
+
+The Medical Imaging Interaction Toolkit (MITK)
+
+Copyright (c) German Cancer Research Center,
+Division of Medical and Biological Informatics.
+All rights reserved.
+
+This software is distributed WITHOUT ANY WARRANTY; without
+even the implied warranty of MERCHANTABILITY or FITNESS FOR
+A PARTICULAR PURPOSE.
+
+See LICENSE.txt or http://www.mitk.org for details.
+
+===================================================================*/
+#ifndef __mitkToFNrrdFrameReader_h
+#define __mitkToFNrrdFrameReader_h
+
+#include <MitkToFHardwareExports.h>
+#include "mitkCommon.h"
+
+#include "itkObject.h"
+#include "itkObjectFactory.h"
+
+#include <fstream>
+
+namespace mitk
+{
+  /**
+  * @brief Reads single frames of a ToF recording saved as nrrd file
+  *
+  * Only the nrrd header is parsed on Open(), the frames are read from the file on demand. This allows to play
+  * recordings which do not fit into memory and avoids loading a whole recording before the first frame is shown.
+  * Recordings have to be stored uncompressed (encoding raw) in the byte order of this machine, either in the
+  * nrrd file itself or in one detached data file. This is how ToFNrrdImageWriter stores them.
+  *
+  * A frame is a 2D slice of a 3D recording (ToFImageType3D) or a time step of a 2D+t recording (ToFImageType2DPlusT).
+  *
+  * @ingroup ToFHardware
+  */
+  class MITKTOFHARDWARE_EXPORT ToFNrrdFrameReader : public itk::Object
+  {
+  public:
+
+    mitkClassMacroItkParent( ToFNrrdFrameReader , itk::Object );
+
+    itkFactorylessNewMacro(Self)
+
+    /*!
+    \brief Parses the header of the file and opens the data for reading
+    \return Returns 'false' if the data of the file cannot be read frame by frame. Throws if the file is invalid.
+    */
+    bool Open(const std::string &fileName);
+    void Close();
+    bool IsOpen() const;
+
+    /*!
+    \brief Copies the frame with the given index into data, which has to hold GetFrameSizeInBytes() bytes
+    */
+    void ReadFrame(int frame, void* data);
+
+    itkGetConstMacro(Dimension, unsigned int);
+    itkGetConstMacro(Width, int);
+    itkGetConstMacro(Height, int);
+    itkGetConstMacro(NumberOfFrames, int);
+    itkGetConstMacro(NumberOfComponents, int);
+    itkGetConstMacro(ComponentType, std::string);
+    itkGetConstMacro(FrameSizeInBytes, long);
+
+  protected:
+
+    ToFNrrdFrameReader();
+    ~ToFNrrdFrameReader() override;
+
+    std::ifstream m_DataFile; ///< file holding the frames
+    std::streamoff m_DataOffset; ///< position of the first frame in m_DataFile
+
+    unsigned int m_Dimension; ///< dimension of the image without the component axis
+    int m_Width; ///< width (x-dimension) of a frame
+    int m_Height; ///< height (y-dimension) of a frame
+    int m_NumberOfFrames; ///< number of complete frames in the file
+    int m_NumberOfComponents; ///< number of components per pixel, e.g. 3 for RGB
+    std::string m_ComponentType; ///< "float" or "unsigned char"
+    long m_FrameSizeInBytes; ///< size of one frame in bytes
+  };
+} //END mitk namespace
+#endif // __mitkToFNrrdFrameReader_h
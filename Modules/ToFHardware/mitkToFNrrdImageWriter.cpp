@@ -18,7 +18,19 @@ See LICENSE.txt or http://www.mitk.org for details.
 
 // itk includes
 #include "itksys/SystemTools.hxx"
-#include "itkNrrdImageIO.h"
+#include "itkByteSwapper.h"
+
+#include <sstream>
+#include <vector>
+
+namespace
+{
+  // digits of the largest frame count
+  const std::string::size_type NumberOfFrameCountDigits = 10;
+
+  // the header is rewritten after every chunk of frames, recordings which are not closed properly stay readable
+  const int NumberOfFramesPerChunk = 100;
+}
 
 namespace mitk
 {
@@ -62,6 +74,9 @@ namespace mitk
       this->OpenStreamFile(this->m_RGBOutfile, this->m_RGBImageFileName);
     }
     this->m_NumOfFrames = 0;
+
+    // the frames are appended to the header as they come
+    this->WriteNrrdHeaders();
   }
 
   void ToFNrrdImageWriter::Close()
@@ -103,6 +118,31 @@ namespace mitk
       this->m_RGBOutfile.write(( char* )rgbData, this->m_RGBImageSizeInBytes);
     }
     this->m_NumOfFrames++;
+
+    if (this->m_NumOfFrames % NumberOfFramesPerChunk == 0)
+    {
+      this->WriteNrrdHeaders();
+    }
+  }
+
+  void ToFNrrdImageWriter::WriteNrrdHeaders()
+  {
+    if (this->m_DistanceImageSelected)
+    {
+      this->WriteNrrdHeader(this->m_DistanceOutfile, false);
+    }
+    if (this->m_AmplitudeImageSelected)
+    {
+      this->WriteNrrdHeader(this->m_AmplitudeOutfile, false);
+    }
+    if (this->m_IntensityImageSelected)
+    {
+      this->WriteNrrdHeader(this->m_IntensityOutfile, false);
+    }
+    if (this->m_RGBImageSelected)
+    {
+      this->WriteNrrdHeader(this->m_RGBOutfile, true);
+    }
   }
 
   void ToFNrrdImageWriter::OpenStreamFile( std::ofstream &outfile, std::string outfileName )
@@ -125,155 +165,96 @@ namespace mitk
       return;
     }
 
-    // flush the last data to the file and convert the stream data to nrrd file
-    outfile.flush();
-    this->ConvertStreamToNrrdFormat( fileName );
+    // the frames are already in the file, only the final frame count is missing
+    this->WriteNrrdHeader( outfile, fileName == this->m_RGBImageFileName );
     outfile.close();
   }
 
-  void ToFNrrdImageWriter::ConvertStreamToNrrdFormat( std::string fileName )
+  void ToFNrrdImageWriter::WriteNrrdHeader( std::ofstream &outfile, bool isRGB )
   {
-    int CaptureWidth = 0;
-    int CaptureHeight = 0;
-    int PixelNumber = 0;
+    int captureWidth = isRGB ? this->m_RGBCaptureWidth : this->m_ToFCaptureWidth;
+    int captureHeight = isRGB ? this->m_RGBCaptureHeight : this->m_ToFCaptureHeight;
 
-    if (fileName==this->m_RGBImageFileName)
+    // sizes of the image axes, the same image as written by itk::NrrdImageIO for an mitk::Image with default geometry
+    std::vector<int> sizes;
+    sizes.push_back(captureWidth);
+    sizes.push_back(captureHeight);
+    if (m_ToFImageType == ToFImageType2DPlusT)
     {
-        CaptureWidth = this->m_RGBCaptureWidth;
-        CaptureHeight = this->m_RGBCaptureHeight;
-        PixelNumber = this->m_RGBPixelNumber;
+      sizes.push_back(1);
     }
-    else
-    {
-        CaptureWidth = this->m_ToFCaptureWidth;
-        CaptureHeight = this->m_ToFCaptureHeight;
-        PixelNumber = this->m_ToFPixelNumber;
-    }
-    Image::Pointer imageTemplate = Image::New();
-    unsigned int dimension;
-    unsigned int* dimensions;
-    if(m_ToFImageType == ToFImageType2DPlusT)
-    {
-      dimension = 4;
-      dimensions = new unsigned int[dimension];
-      dimensions[0] = CaptureWidth;
-      dimensions[1] = CaptureHeight;
-      dimensions[2] = 1;
-      dimensions[3] = this->m_NumOfFrames;
-    }
-    else if( m_ToFImageType == ToFImageType3D)
-    {
-      dimension = 3;
-      dimensions = new unsigned int[dimension];
-      dimensions[0] = CaptureWidth;
-      dimensions[1] = CaptureHeight;
-      dimensions[2] = this->m_NumOfFrames;
-    }
-    else
+    else if (m_ToFImageType != ToFImageType3D)
     {
       throw std::logic_error("No image type set, please choose between 2D+t and 3D!");
     }
-    float* floatData = nullptr;
-    unsigned char* rgbData = nullptr;
-    if (fileName==this->m_RGBImageFileName)
+    sizes.push_back(this->m_NumOfFrames);
+    const unsigned int spaceDimension = sizes.size();
+
+    std::ostringstream header;
+    header << "NRRD0004\n";
+    header << "# Complete NRRD file format specification at:\n";
+    header << "# http://teem.sourceforge.net/nrrd/format.html\n";
+    header << "type: " << (isRGB ? "unsigned char" : "float") << "\n";
+    header << "dimension: " << spaceDimension + (isRGB ? 1 : 0) << "\n";
+    if (spaceDimension == 3)
     {
-      rgbData = new unsigned char[PixelNumber*3];
-      for(int i=0; i<PixelNumber*3; i++)
-      {
-        rgbData[i] = i + 0.0;
-      }
-      mitk::PixelType RGBType = MakePixelType<unsigned char, itk::RGBPixel<unsigned char>, 3>();
-      imageTemplate->Initialize( RGBType,dimension, dimensions, 1);
-      imageTemplate->SetSlice(rgbData, 0, 0, 0);
+      header << "space: left-posterior-superior\n";
     }
     else
     {
-      floatData = new float[PixelNumber];
-      for(int i=0; i<PixelNumber; i++)
-      {
-        floatData[i] = i + 0.0;
-      }
-      mitk::PixelType FloatType = MakeScalarPixelType<float>();
-      imageTemplate->Initialize( FloatType,dimension, dimensions, 1);
-      imageTemplate->SetSlice(floatData, 0, 0, 0);
+      header << "space dimension: " << spaceDimension << "\n";
     }
 
-    itk::NrrdImageIO::Pointer nrrdWriter = itk::NrrdImageIO::New();
-    nrrdWriter->SetNumberOfDimensions(dimension);
-    nrrdWriter->SetPixelType( imageTemplate->GetPixelType().GetPixelType());
-    nrrdWriter->SetComponentType( (itk::ImageIOBase::IOComponentType) imageTemplate->GetPixelType().GetComponentType());
-    if(imageTemplate->GetPixelType().GetNumberOfComponents() > 1)
+    std::ostringstream numberOfFrames;
+    numberOfFrames << this->m_NumOfFrames;
+    header << "sizes:" << (isRGB ? " 3" : "");
+    for (auto size : sizes)
     {
-      nrrdWriter->SetNumberOfComponents(imageTemplate->GetPixelType().GetNumberOfComponents());
+      header << " " << size;
     }
+    header << "\n";
+    // pads the header to the same size for every frame count, so it can be rewritten in front of the frames
+    header << "#" << std::string(NumberOfFrameCountDigits - numberOfFrames.str().size(), ' ') << "\n";
 
-    itk::ImageIORegion ioRegion( dimension );
-    mitk::Vector3D spacing = imageTemplate->GetGeometry()->GetSpacing();
-    mitk::Point3D origin = imageTemplate->GetGeometry()->GetOrigin();
-
-    for(unsigned int i = 0; i < dimension; i++)
+    header << "space directions:" << (isRGB ? " none" : "");
+    for (unsigned int i = 0; i < spaceDimension; ++i)
     {
-      nrrdWriter->SetDimensions(i,dimensions[i]);
-      nrrdWriter->SetSpacing(i,spacing[i]);
-      nrrdWriter->SetOrigin(i,origin[i]);
-
-      mitk::Vector3D direction;
-      direction.SetVnlVector(imageTemplate->GetGeometry()->GetIndexToWorldTransform()->GetMatrix().GetVnlMatrix().get_column(i));
-      vnl_vector< double > axisDirection(dimension);
-
-      for(unsigned int j = 0; j < dimension; j++)
+      header << " (";
+      for (unsigned int j = 0; j < spaceDimension; ++j)
       {
-        axisDirection[j] = direction[j]/spacing[i];
+        header << (j == 0 ? "" : ",") << (i == j ? 1 : 0);
       }
-      nrrdWriter->SetDirection( i, axisDirection );
-
-      ioRegion.SetSize(i, imageTemplate->GetLargestPossibleRegion().GetSize(i) );
-      ioRegion.SetIndex(i, imageTemplate->GetLargestPossibleRegion().GetIndex(i) );
+      header << ")";
     }
-
-    nrrdWriter->SetIORegion(ioRegion);
-    nrrdWriter->SetFileName(fileName);
-    nrrdWriter->SetUseStreamedWriting(true);
-
-    std::ifstream stream(fileName.c_str(), std::ifstream::binary);
-    if (fileName==m_RGBImageFileName)
+    header << "\n";
+    header << "kinds:" << (isRGB ? " RGB-color" : "");
+    for (unsigned int i = 0; i < spaceDimension; ++i)
     {
-      unsigned int size = PixelNumber*3 * this->m_NumOfFrames;
-      unsigned int sizeInBytes = size * sizeof(unsigned char);
-      unsigned char* data = new unsigned char[size];
-      stream.read((char*)data, sizeInBytes);
-      nrrdWriter->Write(data);
-      stream.close();
-      delete[] data;
+      header << " domain";
     }
-    else
+    header << "\n";
+    header << "endian: " << (itk::ByteSwapper<float>::SystemIsBigEndian() ? "big" : "little") << "\n";
+    header << "encoding: raw\n";
+    header << "space origin: (";
+    for (unsigned int i = 0; i < spaceDimension; ++i)
     {
-      unsigned int size = PixelNumber * this->m_NumOfFrames;
-      unsigned int sizeInBytes = size * sizeof(float);
-      float* data = new float[size];
-      stream.read((char*)data, sizeInBytes);
-      try
-      {
-        nrrdWriter->Write(data);
-      }
-      catch (itk::ExceptionObject* e)
-      {
-        MITK_ERROR<< e->what();
-        return;
-      }
-
-      stream.close();
-      delete[] data;
+      header << (i == 0 ? "" : ",") << 0;
     }
+    header << ")\n\n";
 
-    delete[] dimensions;
-    if (fileName==m_RGBImageFileName)
+    const std::string headerString = header.str();
+    std::ofstream::pos_type end = outfile.tellp();
+    outfile.seekp(0);
+    outfile.write(headerString.c_str(), headerString.size());
+    if (end > std::ofstream::pos_type(headerString.size()))
     {
-      delete[] rgbData;
+      outfile.seekp(end);
     }
-    else
+    outfile.flush();
+    if (!outfile)
     {
-      delete[] floatData;
+      MITK_ERROR << "Error writing nrrd header";
+      throw std::logic_error("Error writing nrrd header.");
     }
   }
 
@@ -26,7 +26,10 @@ namespace mitk
   /**
   * @brief Writer class for ToF nrrd images
   *
-  * This writer class allows streaming of ToF data into a nrrd file. This class uses the itkNrrdImageIO class
+  * This writer class allows streaming of ToF data into a nrrd file. The frames are appended to the file as they
+  * are added, so memory usage does not grow with the length of a recording. The nrrd header in front of the frames
+  * is rewritten with the current frame count after every chunk of frames and on Close().
+  * The files are written uncompressed and can be streamed by ToFNrrdFrameReader.
   * Writer can simultaneously save "distance", "intensity" and "amplitude" image.
   * Images can be written as 3D volume (ToFImageType::ToFImageType3D) or temporal image stack (ToFImageType::ToFImageType2DPlusT)
   *
@@ -73,9 +76,13 @@ namespace mitk
     */
     void CloseStreamFile(std::ofstream &outfile, std::string fileName);
     /*!
-    \brief Write image information to the NrrdFile.
+    \brief Writes the nrrd header with the current number of frames to all open files.
     */
-    void ConvertStreamToNrrdFormat( std::string fileName );
+    void WriteNrrdHeaders();
+    /*!
+    \brief Writes the nrrd header with the current number of frames to the beginning of the file.
+    */
+    void WriteNrrdHeader( std::ofstream &outfile, bool isRGB );
   };
 } //END mitk namespace
 #endif // __mitkToFNrrdImageWriter_h
@@ -10,6 +10,12 @@
 #include "itkImageRegionIterator.h"
 #include "itkObjectFactory.h"
 #include <itkImageRegionConstIteratorWithIndex.h>
+#include "itkMultiThreader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <queue>
 // Vector Fields
 #include "itkVectorImage.h"
 #include <vnl/vnl_vector.h>
@@ -166,7 +172,8 @@ namespace itk
                   if (seed->GetPixel(medianIt.GetIndex(j)) != 0) // inside seed region
                     samples.push_back(medianIt.GetPixel(j));
                 }
-                std::sort(samples.begin(), samples.end());
+                // only the median has to be in place
+                std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
 
                 output->SetPixel(seedIt.GetIndex(), samples.at(samples.size() / 2));
               }
@@ -184,6 +191,26 @@ namespace itk
       ++outIt;
       ++seedIt;
     }
+
+    // The eigenvalues of each tensor are needed for all paths through it, compute them only once
+    m_NormalizedTensors.clear();
+    if (m_Mode != FeatureSimilarity && m_TensorImage.IsNotNull())
+    {
+      m_NormalizedTensors.reserve(m_TensorImage->GetBufferedRegion().GetNumberOfPixels());
+      itk::ImageRegionConstIterator<TTensorImage> tensorIt(m_TensorImage, m_TensorImage->GetBufferedRegion());
+      for (tensorIt.GoToBegin(); !tensorIt.IsAtEnd(); ++tensorIt)
+      {
+        m_NormalizedTensors.push_back(NormalizeTensor(tensorIt.Get()));
+      }
+    }
+
+    if (m_UsePriorityQueue)
+    {
+      this->PropagateWithPriorityQueue(fifo, mask, output, untouchedValue);
+      m_NormalizedTensors.clear();
+      return;
+    }
+
     //
     // Now iterate over items in fifo and check all possible paths starting from these indices
     // to their neighbors and mark those with lowest cost
@@ -240,6 +267,7 @@ namespace itk
         }
       }
     }
+    m_NormalizedTensors.clear();
   }
 
   template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
@@ -252,7 +280,7 @@ namespace itk
     {
       case (FeatureSimilarity):
       {
-        cost = (-1 + exp(std::fabs(m_InputImage->GetPixel(idxStart) - m_InputImage->GetPixel(idxEnd))));
+        cost = GetFeatureSimilarityCost(m_InputImage->GetPixel(idxStart), m_InputImage->GetPixel(idxEnd));
         break;
       }
       case (VectorAgreement):
@@ -293,36 +321,8 @@ namespace itk
 
         direction = direction.normalize();
 
-        TensorPixelType tensorEnd = m_TensorImage->GetPixel(tensorIdxEnd);
-        TensorPixelType tensorStart = m_TensorImage->GetPixel(tensorIdx);
-
-        typename TensorPixelType::EigenValuesArrayType eigenvalues;
-
-        tensorEnd.ComputeEigenValues(eigenvalues);
-        double maxEVEnd = std::fabs(eigenvalues[2]);
-
-        tensorStart.ComputeEigenValues(eigenvalues);
-        double maxEVStart = std::fabs(eigenvalues[2]);
-
-        if (maxEVEnd == 0.0)
-          maxEVEnd = 1; // no change then ..
-        // Normalize by largest EV
-        tensorEnd[0] /= maxEVEnd;
-        tensorEnd[1] /= maxEVEnd;
-        tensorEnd[2] /= maxEVEnd;
-        tensorEnd[3] /= maxEVEnd;
-        tensorEnd[4] /= maxEVEnd;
-        tensorEnd[5] /= maxEVEnd;
-
-        if (maxEVStart == 0.0)
-          maxEVStart = 1; // no change then ..
-        // Normalize by largest EV
-        tensorStart[0] /= maxEVStart;
-        tensorStart[1] /= maxEVStart;
-        tensorStart[2] /= maxEVStart;
-        tensorStart[3] /= maxEVStart;
-        tensorStart[4] /= maxEVStart;
-        tensorStart[5] /= maxEVStart;
+        TensorPixelType tensorEnd = GetNormalizedTensor(tensorIdxEnd);
+        TensorPixelType tensorStart = GetNormalizedTensor(tensorIdx);
 
         /* Matrix Style
       *       | 0  1  2  |
@@ -394,36 +394,8 @@ namespace itk
 
         direction = direction.normalize();
 
-        TensorPixelType tensorEnd = m_TensorImage->GetPixel(tensorIdxEnd);
-        TensorPixelType tensorStart = m_TensorImage->GetPixel(tensorIdx);
-
-        typename TensorPixelType::EigenValuesArrayType eigenvalues;
-
-        tensorEnd.ComputeEigenValues(eigenvalues);
-        double maxEVEnd = std::fabs(eigenvalues[2]);
-
-        tensorStart.ComputeEigenValues(eigenvalues);
-        double maxEVStart = std::fabs(eigenvalues[2]);
-
-        if (maxEVEnd == 0.0)
-          maxEVEnd = 1; // no change then ..
-        // Normalize by largest EV
-        tensorEnd[0] /= maxEVEnd;
-        tensorEnd[1] /= maxEVEnd;
-        tensorEnd[2] /= maxEVEnd;
-        tensorEnd[3] /= maxEVEnd;
-        tensorEnd[4] /= maxEVEnd;
-        tensorEnd[5] /= maxEVEnd;
-
-        if (maxEVStart == 0.0)
-          maxEVStart = 1; // no change then ..
-        // Normalize by largest EV
-        tensorStart[0] /= maxEVStart;
-        tensorStart[1] /= maxEVStart;
-        tensorStart[2] /= maxEVStart;
-        tensorStart[3] /= maxEVStart;
-        tensorStart[4] /= maxEVStart;
-        tensorStart[5] /= maxEVStart;
+        TensorPixelType tensorEnd = GetNormalizedTensor(tensorIdxEnd);
+        TensorPixelType tensorStart = GetNormalizedTensor(tensorIdx);
 
         /* Matrix Style
       *       | 0  1  2  |
@@ -462,6 +434,286 @@ namespace itk
     return cost;
   }
 
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  typename ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::FeaturePixelType
+    ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::GetFeatureSimilarityCost(FeaturePixelType valueStart,
+                                                                                           FeaturePixelType valueEnd)
+  {
+    return (-1 + exp(std::fabs(valueStart - valueEnd)));
+  }
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  typename ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::TensorPixelType
+    ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::NormalizeTensor(TensorPixelType tensor)
+  {
+    typename TensorPixelType::EigenValuesArrayType eigenvalues;
+    tensor.ComputeEigenValues(eigenvalues);
+    double maxEV = std::fabs(eigenvalues[2]);
+
+    if (maxEV == 0.0)
+      maxEV = 1; // no change then ..
+    // Normalize by largest EV
+    tensor[0] /= maxEV;
+    tensor[1] /= maxEV;
+    tensor[2] /= maxEV;
+    tensor[3] /= maxEV;
+    tensor[4] /= maxEV;
+    tensor[5] /= maxEV;
+    return tensor;
+  }
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  typename ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::TensorPixelType
+    ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::GetNormalizedTensor(
+      const IndexTensorType &index) const
+  {
+    if (m_NormalizedTensors.empty())
+      return NormalizeTensor(m_TensorImage->GetPixel(index));
+    return m_NormalizedTensors[m_TensorImage->ComputeOffset(index)];
+  }
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  struct ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::Propagation
+  {
+    Self *Filter;
+    FeaturePixelType UntouchedValue;
+    SizeValueType Size[3];
+    IndexType Start;
+
+    const FeaturePixelType *Input;
+    const SeedPixelType *Mask;
+    FeaturePixelType *Output;
+    FeaturePixelType *Distance;
+    FeaturePixelType *EuclideanDistance;
+
+    // 26-neighborhood in the order of the neighborhood iterator used by the FIFO propagation
+    std::vector<Offset<3>> NeighborOffsets;
+    std::vector<OffsetValueType> NeighborBufferOffsets;
+    std::vector<FeaturePixelType> NeighborEuclideanDistances;
+
+    // Seeds of the regions of the mask which are not connected to each other, largest region first
+    std::vector<std::vector<OffsetValueType>> RegionSeeds;
+    std::atomic<std::size_t> NextRegion;
+  };
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  void ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::PropagateWithPriorityQueue(
+    const std::list<IndexType> &seeds, const TSeedImage *mask, TFeatureImage *output, FeaturePixelType untouchedValue)
+  {
+    const typename TFeatureImage::RegionType region = m_InputImage->GetLargestPossibleRegion();
+    const typename TFeatureImage::SpacingType spacing = m_InputImage->GetSpacing();
+
+    Propagation propagation;
+    propagation.Filter = this;
+    propagation.UntouchedValue = untouchedValue;
+    for (unsigned int i = 0; i < 3; ++i)
+      propagation.Size[i] = region.GetSize(i);
+    propagation.Start = region.GetIndex();
+    propagation.Input = m_InputImage->GetBufferPointer();
+    propagation.Mask = mask->GetBufferPointer();
+    propagation.Output = output->GetBufferPointer();
+    propagation.Distance = m_DistanceImage->GetBufferPointer();
+    propagation.EuclideanDistance = m_EuclideanDistance->GetBufferPointer();
+
+    for (int z = -1; z <= 1; ++z)
+    {
+      for (int y = -1; y <= 1; ++y)
+      {
+        for (int x = -1; x <= 1; ++x)
+        {
+          if (x == 0 && y == 0 && z == 0) // skip center voxel
+            continue;
+
+          Offset<3> offset = {{x, y, z}};
+          propagation.NeighborOffsets.push_back(offset);
+          propagation.NeighborBufferOffsets.push_back(
+            x + static_cast<OffsetValueType>(propagation.Size[0]) * (y + static_cast<OffsetValueType>(propagation.Size[1]) * z));
+
+          // Compute Euclidean distance between indices, as done by the FIFO propagation
+          IndexType index = region.GetIndex();
+          IndexType neighbor = index + offset;
+          FeaturePixelType eDist = sqrt(std::pow(index[0] - neighbor[0], 2) * spacing[0] +
+                                        std::pow(index[1] - neighbor[1], 2) * spacing[1] +
+                                        std::pow(index[2] - neighbor[2], 2) * spacing[2]);
+          propagation.NeighborEuclideanDistances.push_back(eDist);
+        }
+      }
+    }
+
+    // Paths never leave the mask, so the regions of the mask which are not connected to each other are independent.
+    // Find the regions reached from the seeds by a flood fill.
+    std::vector<int> regionLabels(region.GetNumberOfPixels(), -1);
+    std::vector<std::size_t> regionSizes;
+    for (const IndexType &seed : seeds)
+    {
+      const OffsetValueType seedOffset = m_InputImage->ComputeOffset(seed);
+      // seeds outside the mask are not expanded
+      if (propagation.Mask[seedOffset] == 0)
+        continue;
+
+      if (regionLabels[seedOffset] == -1)
+      {
+        const int label = static_cast<int>(regionSizes.size());
+        std::vector<OffsetValueType> stack(1, seedOffset);
+        regionLabels[seedOffset] = label;
+        std::size_t regionSize = 0;
+        while (!stack.empty())
+        {
+          const OffsetValueType voxel = stack.back();
+          stack.pop_back();
+          ++regionSize;
+
+          const OffsetValueType position[3] = {
+            voxel % static_cast<OffsetValueType>(propagation.Size[0]),
+            (voxel / static_cast<OffsetValueType>(propagation.Size[0])) % static_cast<OffsetValueType>(propagation.Size[1]),
+            voxel / static_cast<OffsetValueType>(propagation.Size[0] * propagation.Size[1])};
+          for (unsigned int i = 0; i < propagation.NeighborOffsets.size(); ++i)
+          {
+            bool isInside = true;
+            for (unsigned int j = 0; j < 3; ++j)
+            {
+              const OffsetValueType coordinate = position[j] + propagation.NeighborOffsets[i][j];
+              isInside = isInside && coordinate >= 0 && coordinate < static_cast<OffsetValueType>(propagation.Size[j]);
+            }
+            const OffsetValueType neighbor = voxel + propagation.NeighborBufferOffsets[i];
+            if (isInside && propagation.Mask[neighbor] != 0 && regionLabels[neighbor] == -1)
+            {
+              regionLabels[neighbor] = label;
+              stack.push_back(neighbor);
+            }
+          }
+        }
+        regionSizes.push_back(regionSize);
+        propagation.RegionSeeds.push_back(std::vector<OffsetValueType>());
+      }
+      propagation.RegionSeeds[regionLabels[seedOffset]].push_back(seedOffset);
+    }
+    regionLabels.clear();
+    regionLabels.shrink_to_fit();
+
+    // largest regions first for a better balance between the threads
+    std::vector<std::size_t> order(regionSizes.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+      order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&regionSizes](std::size_t a, std::size_t b) {
+      return regionSizes[a] > regionSizes[b];
+    });
+    std::vector<std::vector<OffsetValueType>> regionSeeds(order.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+      regionSeeds[i].swap(propagation.RegionSeeds[order[i]]);
+    propagation.RegionSeeds.swap(regionSeeds);
+    propagation.NextRegion = 0;
+
+    const ThreadIdType numberOfThreads =
+      std::min<ThreadIdType>(this->GetNumberOfThreads(), static_cast<ThreadIdType>(propagation.RegionSeeds.size()));
+    if (numberOfThreads <= 1)
+    {
+      for (const auto &seedsOfRegion : propagation.RegionSeeds)
+        this->PropagateRegion(propagation, seedsOfRegion);
+      return;
+    }
+
+    this->GetMultiThreader()->SetNumberOfThreads(numberOfThreads);
+    this->GetMultiThreader()->SetSingleMethod(PropagateRegionsThreaderCallback, &propagation);
+    this->GetMultiThreader()->SingleMethodExecute();
+  }
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  ITK_THREAD_RETURN_TYPE
+    ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::PropagateRegionsThreaderCallback(void *arg)
+  {
+    auto *threadInfo = static_cast<MultiThreader::ThreadInfoStruct *>(arg);
+    auto *propagation = static_cast<Propagation *>(threadInfo->UserData);
+
+    for (std::size_t region = propagation->NextRegion++; region < propagation->RegionSeeds.size();
+         region = propagation->NextRegion++)
+    {
+      propagation->Filter->PropagateRegion(*propagation, propagation->RegionSeeds[region]);
+    }
+    return ITK_THREAD_RETURN_VALUE;
+  }
+
+  template <typename TFeatureImage, typename TSeedImage, typename TTensorImage>
+  void ConnectednessFilter<TFeatureImage, TSeedImage, TTensorImage>::PropagateRegion(
+    const Propagation &propagation, const std::vector<OffsetValueType> &seeds)
+  {
+    // Voxels in the queue, ordered by distance and then by the order in which they were added. A voxel is added
+    // again when a shorter path to it is found, the outdated entries are skipped.
+    struct QueueItem
+    {
+      FeaturePixelType Distance;
+      std::size_t Order;
+      OffsetValueType Voxel;
+
+      bool operator>(const QueueItem &other) const
+      {
+        return Distance > other.Distance || (Distance == other.Distance && Order > other.Order);
+      }
+    };
+    std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+    std::size_t order = 0;
+
+    FeaturePixelType *distance = propagation.Distance;
+    for (OffsetValueType seed : seeds)
+    {
+      QueueItem item = {distance[seed], order++, seed};
+      queue.push(item);
+    }
+
+    while (!queue.empty())
+    {
+      const QueueItem item = queue.top();
+      queue.pop();
+      const OffsetValueType voxel = item.Voxel;
+      if (item.Distance != distance[voxel])
+        continue;
+
+      // Costs are never negative, the distance of the voxel is final and it is expanded only once
+      const FeaturePixelType currDistance = distance[voxel];
+      const FeaturePixelType currEuclidDistance = propagation.EuclideanDistance[voxel];
+      const FeaturePixelType propagateValue = propagation.Output[voxel];
+
+      const OffsetValueType position[3] = {voxel % static_cast<OffsetValueType>(propagation.Size[0]),
+                                           (voxel / static_cast<OffsetValueType>(propagation.Size[0])) %
+                                             static_cast<OffsetValueType>(propagation.Size[1]),
+                                           voxel / static_cast<OffsetValueType>(propagation.Size[0] * propagation.Size[1])};
+      IndexType index;
+      for (unsigned int j = 0; j < 3; ++j)
+        index[j] = propagation.Start[j] + position[j];
+
+      for (unsigned int i = 0; i < propagation.NeighborOffsets.size(); ++i)
+      {
+        const Offset<3> &offset = propagation.NeighborOffsets[i];
+        if (position[0] + offset[0] < 0 || position[0] + offset[0] >= static_cast<OffsetValueType>(propagation.Size[0]) ||
+            position[1] + offset[1] < 0 || position[1] + offset[1] >= static_cast<OffsetValueType>(propagation.Size[1]) ||
+            position[2] + offset[2] < 0 || position[2] + offset[2] >= static_cast<OffsetValueType>(propagation.Size[2]))
+          continue;
+
+        const OffsetValueType neighbor = voxel + propagation.NeighborBufferOffsets[i];
+        if (propagation.Mask[neighbor] == 0)
+          continue;
+
+        FeaturePixelType cost = 0;
+        if (m_Mode == FeatureSimilarity)
+          cost = GetFeatureSimilarityCost(propagation.Input[voxel], propagation.Input[neighbor]);
+        else
+          cost = GetDistanceValue(index, index + offset);
+        if (cost == -1)
+          continue;
+
+        if (currDistance + cost < distance[neighbor] || distance[neighbor] == propagation.UntouchedValue)
+        {
+          distance[neighbor] = currDistance + cost;
+          propagation.EuclideanDistance[neighbor] = currEuclidDistance + propagation.NeighborEuclideanDistances[i];
+          propagation.Output[neighbor] = propagateValue;
+
+          QueueItem neighborItem = {distance[neighbor], order++, neighbor};
+          queue.push(neighborItem);
+        }
+      }
+    }
+  }
+
 } // end itk namespace
 
 #endif
@@ -5,6 +5,9 @@
 #include "itkImageToImageFilter.h"
 #include <itkDiffusionTensor3D.h>
 
+#include <list>
+#include <vector>
+
 namespace itk
 {
   /** ConnectednessFilter - Propagate the border voxels of seed region, also calculates distance maps
@@ -17,6 +20,9 @@ namespace itk
    * VectorAgreement - cost is determined by path agreement with supplied vector field
    * FeatureVectorAgreement - cost is a combination of vector agreement and feature similarity
    *
+   * By default the shortest paths are found with a priority queue (Dijkstra), which expands every voxel once.
+   * Regions of the mask which are not connected to each other are processed in parallel.
+   *
    */
 
   template <class TFeatureImage, class TSeedImage, typename TTensorImagePixelType = double>
@@ -110,8 +116,20 @@ namespace itk
      * @param applyFilter
      */
     void SetApplyRankFilter(bool applyFilter) { m_ApplyRankFilter = applyFilter; }
+    /**
+     * @brief SetUsePriorityQueue - if true (default) voxels are expanded in the order of their distance, each voxel
+     * once. Otherwise voxels are kept in a FIFO and expanded again whenever a shorter path to them is found.
+     * Both give the same distance map. If several paths to a voxel have exactly the same cost, the propagated value
+     * and the Euclidean distance may be taken from a different one of these paths.
+     * @param usePriorityQueue
+     */
+    void SetUsePriorityQueue(bool usePriorityQueue) { m_UsePriorityQueue = usePriorityQueue; }
   protected:
-    ConnectednessFilter() { m_ApplyRankFilter = false; }
+    ConnectednessFilter()
+    {
+      m_ApplyRankFilter = false;
+      m_UsePriorityQueue = true;
+    }
     ~ConnectednessFilter() {}
     /** Does the real work. */
     virtual void GenerateData();
@@ -122,6 +140,27 @@ namespace itk
     ConnectednessFilter(const Self &); // purposely not implemented
     void operator=(const Self &);      // purposely not implemented
 
+    typedef typename TFeatureImage::OffsetValueType OffsetValueType;
+
+    // Buffers and neighborhood shared by all threads of the priority queue propagation
+    struct Propagation;
+
+    void PropagateWithPriorityQueue(const std::list<IndexType> &seeds,
+                                    const TSeedImage *mask,
+                                    TFeatureImage *output,
+                                    FeaturePixelType untouchedValue);
+
+    void PropagateRegion(const Propagation &propagation, const std::vector<OffsetValueType> &seeds);
+
+    static ITK_THREAD_RETURN_TYPE PropagateRegionsThreaderCallback(void *arg);
+
+    static FeaturePixelType GetFeatureSimilarityCost(FeaturePixelType valueStart, FeaturePixelType valueEnd);
+
+    // Divides the tensor by the magnitude of its largest eigenvalue
+    static TensorPixelType NormalizeTensor(TensorPixelType tensor);
+
+    TensorPixelType GetNormalizedTensor(const IndexTensorType &index) const;
+
     typename TFeatureImage::Pointer m_InputImage;
     typename TTensorImage::Pointer m_TensorImage;
     typename TFeatureImage::Pointer m_ConfidenceImage;
@@ -133,6 +172,11 @@ namespace itk
     DistanceMode m_Mode;
 
     bool m_ApplyRankFilter;
+
+    bool m_UsePriorityQueue;
+
+    // Normalized tensors of m_TensorImage in buffer order, computed once per filter update
+    std::vector<TensorPixelType> m_NormalizedTensors;
   };
 } // namespace ITK
 
@@ -1,3 +1,7 @@
+set(MODULE_TESTS
+  itkConnectednessFilterTest.cpp
+)
+
 set(MODULE_CUSTOM_TESTS
   ## Testing the basic classification funtionality
   mitkClassificationTest.cpp
@@ -0,0 +1,181 @@
+/*===================================================================
+
+ The Medical Imaging Interaction Toolkit (MITK)
+
+ Copyright (c) German Cancer Research Center,
+ Division of Medical and Biological Informatics.
+ All rights reserved.
+
+ This software is distributed WITHOUT ANY WARRANTY; without
+ even the implied warranty of MERCHANTABILITY or FITNESS FOR
+ A PARTICULAR PURPOSE.
+
+ See LICENSE.txt or http://www.mitk.org for details.
+
+ ===================================================================*/
+
+#include "mitkTestFixture.h"
+#include "mitkTestingMacros.h"
+
+#include <itkConnectednessFilter.h>
+#include <itkImageRegionIteratorWithIndex.h>
+
+#include <cmath>
+#include <random>
+#include <sstream>
+
+/**
+ * @brief itkConnectednessFilterTestSuite
+ *
+ * Compares the propagation with a priority queue to the FIFO propagation. Features, tensors and confidences are
+ * random, so no two paths have exactly the same cost and all three output images have to be identical.
+ */
+class itkConnectednessFilterTestSuite : public mitk::TestFixture
+{
+  CPPUNIT_TEST_SUITE(itkConnectednessFilterTestSuite);
+  MITK_TEST(TestFeatureSimilarity);
+  MITK_TEST(TestVectorAgreement);
+  MITK_TEST(TestFeatureVectorAgreement);
+  MITK_TEST(TestRankFilter);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  typedef itk::Image<double, 3> FeatureImageType;
+  typedef itk::Image<unsigned char, 3> SeedImageType;
+  typedef itk::ConnectednessFilter<FeatureImageType, SeedImageType, double> FilterType;
+  typedef FilterType::TTensorImage TensorImageType;
+
+  FeatureImageType::Pointer m_Features;
+  FeatureImageType::Pointer m_Confidence;
+  TensorImageType::Pointer m_Tensors;
+  SeedImageType::Pointer m_Seeds;
+  SeedImageType::Pointer m_Mask;
+
+  template <class TImage>
+  static typename TImage::Pointer CreateImage()
+  {
+    typename TImage::SizeType size = {{24, 20, 12}};
+    typename TImage::SpacingType spacing;
+    spacing[0] = 1.0;
+    spacing[1] = 1.5;
+    spacing[2] = 2.0;
+
+    typename TImage::Pointer image = TImage::New();
+    image->SetRegions(size);
+    image->SetSpacing(spacing);
+    image->Allocate();
+    return image;
+  }
+
+  static bool IsInBox(const SeedImageType::IndexType &index, int x0, int x1, int y0, int y1, int z0, int z1)
+  {
+    return index[0] >= x0 && index[0] <= x1 && index[1] >= y0 && index[1] <= y1 && index[2] >= z0 && index[2] <= z1;
+  }
+
+  FilterType::Pointer CreateFilter(FilterType::DistanceMode mode, bool usePriorityQueue, unsigned int numberOfThreads)
+  {
+    FilterType::Pointer filter = FilterType::New();
+    filter->SetInputImage(m_Features);
+    filter->SetInputSeed(m_Seeds);
+    filter->SetInputMask(m_Mask);
+    if (mode != FilterType::FeatureSimilarity)
+    {
+      filter->SetInputVectorField(m_Tensors);
+      filter->SetInputVectorFieldConfidenceMap(m_Confidence);
+    }
+    filter->SetMode(mode);
+    filter->SetUsePriorityQueue(usePriorityQueue);
+    filter->SetNumberOfThreads(numberOfThreads);
+    return filter;
+  }
+
+  static void AssertEqualImages(const std::string &name, FeatureImageType *expected, FeatureImageType *actual)
+  {
+    itk::ImageRegionIteratorWithIndex<FeatureImageType> expectedIt(expected, expected->GetLargestPossibleRegion());
+    itk::ImageRegionIteratorWithIndex<FeatureImageType> actualIt(actual, actual->GetLargestPossibleRegion());
+    for (; !expectedIt.IsAtEnd(); ++expectedIt, ++actualIt)
+    {
+      std::stringstream message;
+      message << name << " differs at " << expectedIt.GetIndex();
+      CPPUNIT_ASSERT_DOUBLES_EQUAL_MESSAGE(
+        message.str(), expectedIt.Get(), actualIt.Get(), 1e-9 * (1.0 + std::fabs(expectedIt.Get())));
+    }
+  }
+
+  void AssertPriorityQueueEqualsFifo(FilterType::DistanceMode mode, bool applyRankFilter = false)
+  {
+    FilterType::Pointer fifo = this->CreateFilter(mode, false, 1);
+    fifo->SetApplyRankFilter(applyRankFilter);
+    fifo->Update();
+
+    for (unsigned int numberOfThreads : {1u, 4u})
+    {
+      FilterType::Pointer queue = this->CreateFilter(mode, true, numberOfThreads);
+      queue->SetApplyRankFilter(applyRankFilter);
+      queue->Update();
+
+      AssertEqualImages("Distance", fifo->GetDistanceImage(), queue->GetDistanceImage());
+      AssertEqualImages("Euclidean distance", fifo->GetEuclideanDistanceImage(), queue->GetEuclideanDistanceImage());
+      AssertEqualImages("Output", fifo->GetOutput(), queue->GetOutput());
+    }
+  }
+
+public:
+  void setUp() override
+  {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> features(0.0, 1.0);
+    std::uniform_real_distribution<double> confidences(0.2, 1.0);
+    std::uniform_real_distribution<double> coefficients(-1.0, 1.0);
+
+    m_Features = CreateImage<FeatureImageType>();
+    m_Confidence = CreateImage<FeatureImageType>();
+    m_Tensors = CreateImage<TensorImageType>();
+    m_Seeds = CreateImage<SeedImageType>();
+    m_Mask = CreateImage<SeedImageType>();
+
+    itk::ImageRegionIteratorWithIndex<SeedImageType> maskIt(m_Mask, m_Mask->GetLargestPossibleRegion());
+    for (; !maskIt.IsAtEnd(); ++maskIt)
+    {
+      const SeedImageType::IndexType index = maskIt.GetIndex();
+      m_Features->SetPixel(index, features(generator));
+      m_Confidence->SetPixel(index, confidences(generator));
+
+      // symmetric positive definite tensor A^T A + 0.1 I
+      double a[3][3];
+      for (auto &row : a)
+        for (double &value : row)
+          value = coefficients(generator);
+      TensorImageType::PixelType tensor;
+      for (unsigned int i = 0; i < 3; ++i)
+        for (unsigned int j = i; j < 3; ++j)
+          tensor(i, j) = a[0][i] * a[0][j] + a[1][i] * a[1][j] + a[2][i] * a[2][j] + (i == j ? 0.1 : 0.0);
+      m_Tensors->SetPixel(index, tensor);
+
+      // three regions of the mask which are not connected to each other: walls at x = 11 and at y = 13 for x > 11
+      const bool wall = index[0] == 11 || (index[0] > 11 && index[1] == 13);
+      maskIt.Set(wall ? 0 : 1);
+
+      // one seed region per part of the mask and one seed voxel in the wall, which is not expanded
+      const bool seed = IsInBox(index, 3, 5, 4, 7, 4, 6) || IsInBox(index, 15, 17, 3, 5, 5, 7) ||
+                        IsInBox(index, 20, 21, 16, 17, 2, 3) || IsInBox(index, 11, 11, 10, 10, 6, 6);
+      m_Seeds->SetPixel(index, seed ? 1 : 0);
+    }
+  }
+
+  void tearDown() override
+  {
+    m_Features = nullptr;
+    m_Confidence = nullptr;
+    m_Tensors = nullptr;
+    m_Seeds = nullptr;
+    m_Mask = nullptr;
+  }
+
+  void TestFeatureSimilarity() { this->AssertPriorityQueueEqualsFifo(FilterType::FeatureSimilarity); }
+  void TestVectorAgreement() { this->AssertPriorityQueueEqualsFifo(FilterType::VectorAgreement); }
+  void TestFeatureVectorAgreement() { this->AssertPriorityQueueEqualsFifo(FilterType::FeatureVectorAgreement); }
+  void TestRankFilter() { this->AssertPriorityQueueEqualsFifo(FilterType::FeatureSimilarity, true); }
+};
+
+MITK_TEST_SUITE_REGISTRATION(itkConnectednessFilter)